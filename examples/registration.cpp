@@ -13,6 +13,8 @@
  *  \note loads the point clouds in `../data/pc_1.bin` and `../data/pc_2.bin`
  *  \note `./bin/icp_registration`
  *  \note loads the point clouds in `../data/kg_pc8d_1.bin` and `../data/kg_pc8d_2.bin`
+ *  \note If the first file holds a recorded sequence (`kinect_frame_grabber -n`), 
+ *        streaming (`S`) steps through its frames.
  *  \author Nick Lamprianidis
  *  \version 1.1.0
  *  \date 2015
@@ -73,7 +75,12 @@ GLuint glPC4DBuffer, glRGBABuffer;
 static const int width = 640;
 static const int height = 480;
 static const int n = width * height;
-std::vector<cl_float8> pc8d1 (n), pc8d2 (n);
+cl_algo::ICP::PCFile *pc8d1, *pc8d2;
+unsigned int frame = 0;
+
+// Visualization parameters
+unsigned int visMode = 0;
+const char *visModes[] = { "every update", "rate limited", "keyframes" };
 
 // OpenCL paramaters
 const cl_algo::ICP::ICPStepConfigT RC = cl_algo::ICP::ICPStepConfigT::POWER_METHOD;
@@ -84,6 +91,8 @@ ICPReg<RC, WC> *icp;
 /*! \brief Display callback for the window. */
 void drawGLScene ()
 {
+    icp->syncVis ();  // Wait for the last update of the buffers
+
     glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     // glPointSize(2.f);
@@ -165,7 +174,22 @@ void keyPressed (unsigned char key, int x, int y)
             break;
         case 'R':
         case 'r':
-            icp->init (pc8d1, pc8d2);
+            icp->init (*pc8d1, 0, *pc8d2, 0);
+            break;
+        case 'S':
+        case 's':
+            // Stream a recorded sequence, or else the two point clouds in turns
+            if (pc8d1->frames () > 1)
+                icp->stream (*pc8d1, frame++ % pc8d1->frames ());
+            else
+                icp->stream ((frame++ % 2) ? *pc8d2 : *pc8d1, 0);
+            break;
+        case 'V':
+        case 'v':
+            // Cycle through the visualization update policies
+            visMode = (visMode + 1) % 3;
+            icp->setVisMode ((ICPVisMode) visMode);
+            std::cout << "Visualization: " << visModes[visMode] << std::endl;
             break;
     }
 }
@@ -270,26 +294,14 @@ void printInfo ()
     std::cout << "===================\n";
     std::cout << " Perform ICP Registration :  T\n";
     std::cout << " Reset Transformation     :  R\n";
+    std::cout << " Stream Next Frame        :  S\n";
+    std::cout << " Visualization Policy     :  V\n";
     std::cout << " Rotate                   :  Mouse Left Button\n";
     std::cout << " Zoom In/Out              :  Mouse Wheel\n";
     std::cout << " Quit                     :  Q or Esc\n\n";
 }
 
 
-/*! \brief Reads in a binary file.
- *  
- *  \param[in] path path to the file.
- *  \param[out] data array that receives the data.
- *  \param[in] n number of bytes to read.
- */
-void fread (const char *path, char *data, size_t n)
-{
-    std::ifstream f (path, std::ios::binary);
-    f.read (data, n);
-    f.close ();
-}
-
-
 /*! \brief Configures parameters.
  *  
  *  \param[in] argc command line argument count
@@ -331,10 +343,10 @@ void configure (int argc, char **argv)
     }
 
     
-    std::cout << "Loading 1st point cloud from " << filename1 << std::endl;
-    fread (filename1.c_str (), (char *) pc8d1.data (), n * sizeof (cl_float8));
-    std::cout << "Loading 2nd point cloud from " << filename2 << std::endl;
-    fread (filename2.c_str (), (char *) pc8d2.data (), n * sizeof (cl_float8));
+    std::cout << "Mapping 1st point cloud from " << filename1 << std::endl;
+    pc8d1 = new cl_algo::ICP::PCFile (filename1);
+    std::cout << "Mapping 2nd point cloud from " << filename2 << std::endl;
+    pc8d2 = new cl_algo::ICP::PCFile (filename2);
 }
 
 
@@ -351,11 +363,13 @@ int main (int argc, char **argv)
         // The OpenCL environment must be created after the OpenGL environment 
         // has been initialized and before OpenGL starts rendering
         icp = new ICPReg<RC, WC> (&glPC4DBuffer, &glRGBABuffer);
-        icp->init (pc8d1, pc8d2);
+        icp->init (*pc8d1, 0, *pc8d2, 0);
 
         glutMainLoop ();
 
         delete icp;
+        delete pc8d1;
+        delete pc8d2;
 
         return 0;
     }
@@ -365,5 +379,9 @@ int main (int argc, char **argv)
                   << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
                   << ")"  << std::endl;
     }
+    catch (const char *error)
+    {
+        std::cerr << "Error[registration]: " << error << std::endl;
+    }
     exit (EXIT_FAILURE);
 }
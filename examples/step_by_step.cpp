@@ -84,6 +84,8 @@ ICPSBS<RC, WC> *icp;
 /*! \brief Display callback for the window. */
 void drawGLScene ()
 {
+    icp->syncVis ();  // Wait for the last update of the buffers
+
     glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     // glPointSize(2.f);
@@ -32,8 +32,11 @@
 #ifndef ICP_ALGORITHMS_HPP
 #define ICP_ALGORITHMS_HPP
 
+#include <memory>
 #include <CLUtils.hpp>
 #include <ICP/common.hpp>
+#include <ICP/staging_pool.hpp>
+#include <ICP/trace.hpp>
 #include <RBC/data_types.hpp>
 #include <RBC/algorithms.hpp>
 #include <eigen3/Eigen/Dense>
@@ -77,6 +80,13 @@ namespace ICP
      *        | D_IN   | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$columns*rows*sizeof\ (T)\f$ |
      *        | D_OUT  | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$        rows*sizeof\ (T)\f$ |
      *  
+     *  \note When a row spans more than one work-group, call `setSinglePass (true)` to 
+     *        perform the reduction in a single launch of the `reduce_*_SP` kernels, where 
+     *        the last work-group to finish on each row reduces the results of the other 
+     *        blocks. It's off by default. The blocks are published with `mem_fence`, which 
+     *        doesn't order memory across work-groups in OpenCL 1.x, so verify it on the 
+     *        target device first.
+     *  
      *  \tparam C configures the class for different types of reduction.
      *  \tparam T configures the class to work with different types of data.
      */
@@ -98,11 +108,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (Reduce::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _cols, unsigned int _rows, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _cols);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (Reduce::Memory mem = Reduce::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -111,6 +123,10 @@ namespace ICP
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
         void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets whether the reduction is performed in a single launch. */
+        bool getSinglePass ();
+        /*! \brief Sets whether the reduction is performed in a single launch. */
+        void setSinglePass (bool _singlePass);
 
         T *hPtrIn;  /*!< Mapping of the input staging buffer. */
         T *hPtrOut;  /*!< Mapping of the output staging buffer. */
@@ -118,16 +134,19 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
-        cl::Kernel recKernel, groupRecKernel;
+        cl::Kernel recKernel, groupRecKernel, spKernel;
         cl::NDRange globalR, globalGR, local;
         Staging staging;
         size_t wgMultiple, wgXdim;
-        unsigned int cols, rows;
+        unsigned int cols, colsMax, rows;
         unsigned int bufferInSize, bufferGRSize, bufferOutSize;
+        bool singlePass;
         cl::Buffer hBufferIn, hBufferOut;
-        cl::Buffer dBufferIn, dBufferR, dBufferOut;
+        cl::Buffer dBufferIn, dBufferR, dBufferCount, dBufferOut;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -148,6 +167,12 @@ namespace ICP
                 queue.flush (); timer.wait ();
                 pTime = timer.duration ();
             }
+            else if (singlePass)
+            {
+                queue.enqueueNDRangeKernel (spKernel, cl::NullRange, globalR, local, events, &timer.event ());
+                queue.flush (); timer.wait ();
+                pTime = timer.duration ();
+            }
             else
             {
                 queue.enqueueNDRangeKernel (recKernel, cl::NullRange, globalR, local, events, &timer.event ());
@@ -193,6 +218,15 @@ namespace ICP
      *        | D_IN | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$width*height*sizeof\ (cl\_int)\f$ |
      *        | D_OUT| Buffer | Device | O | Processing  | CL_MEM_READ_WRITE | \f$width*height*sizeof\ (cl\_int)\f$ |
      *  
+     *  \note In single-pass mode, a row that spans more than one work-group is scanned 
+     *        in a single launch of the `*Scan_i_DLB` kernels (decoupled look-back), 
+     *        instead of the scan, scan of the group sums, and addition of the group sums. 
+     *        That mode also lifts the limit on the number of columns. It's off by default. 
+     *        The work-groups publish their prefixes with `mem_fence`, which doesn't order 
+     *        memory across work-groups in OpenCL 1.x, and wait on their predecessors, 
+     *        which assumes that the work-groups make progress concurrently. So, verify 
+     *        it on the target device first.
+     *  
      *  \tparam C configures the class to perform either `inclusive` or `exclusive` scan.
      *  \tparam T configures the class to work with different types of data.
      */
@@ -209,16 +243,18 @@ namespace ICP
             H_IN,    /*!< Input staging buffer. */
             H_OUT,   /*!< Output staging buffer. */
             D_IN,    /*!< Input buffer. */
-            D_SUMS,  /*!< Output buffer of partial group sums. */
+            D_SUMS,  /*!< Output buffer of partial group sums. In single-pass mode, 
+                      *   the group sums and inclusive prefixes of the blocks. */
             D_OUT    /*!< Output buffer. */
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        Scan (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        Scan (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (Scan::Memory mem);
         /*! \brief Configures kernel execution parameters. */
-        void init (unsigned int _cols, unsigned int _rows, Staging _staging = Staging::IO);
+        void init (unsigned int _cols, unsigned int _rows, Staging _staging = Staging::IO, 
+                   bool _singlePass = false);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (Scan::Memory mem = Scan::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -234,16 +270,22 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
-        cl::Kernel kernelScan, kernelSumsScan, kernelAddSums;
+        cl::Kernel kernelScan, kernelSumsScan, kernelAddSums, kernelDLB;
         cl::NDRange globalScan, globalSumsScan, localScan;
         cl::NDRange globalAddSums, localAddSums, offsetAddSums;
         Staging staging;
+        bool singlePass;
+        cl_uint epoch;
         size_t wgMultiple, wgXdim;
         unsigned int cols, rows, bufferSize, bufferSumsSize;
         cl::Buffer hBufferIn, hBufferOut;
         cl::Buffer dBufferIn, dBufferOut, dBufferSums;
+        cl::Buffer dBufferStatus, dBufferTickets;
+        unsigned int statusSize, ticketsSize;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -265,6 +307,16 @@ namespace ICP
                 queue.flush (); timer.wait ();
                 pTime = timer.duration ();
             }
+            else if (singlePass)
+            {
+                epoch = epoch % 0x3FFFFFFF + 1;
+                kernelDLB.setArg (7, epoch);
+
+                queue.enqueueNDRangeKernel (
+                    kernelDLB, cl::NullRange, globalScan, localScan, events, &timer.event ());
+                queue.flush (); timer.wait ();
+                pTime = timer.duration ();
+            }
             else
             {
                 queue.enqueueNDRangeKernel (
@@ -289,6 +341,356 @@ namespace ICP
     };
 
 
+    /*! \brief Interface class for the `icpBackProject` kernel.
+     *  \details `icpBackProject` builds an 8-D point cloud from raw depth and RGB frames. 
+     *           For more details, look at the kernel's documentation.
+     *  \note The `icpBackProject` kernel is available in `kernels/icp_kernels.cl`.
+     *  \note It's meant for point cloud files with the `PCFileLayout::RGBD` layout, 
+     *        which keep the frames as they are captured, and are a fraction of the 
+     *        size of the back-projected point clouds.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a `ICPBackProject` instance:<br>
+     *        |   Name   | Type | Placement | I/O | Use | Properties | Size |
+     *        |   ---    |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_D   | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_ushort)\f$  |
+     *        | H_IN_RGB | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$3*n*sizeof\ (cl\_uchar)\f$ |
+     *        | H_OUT    | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$  |
+     *        | D_IN_D   | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_ushort)\f$  |
+     *        | D_IN_RGB | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$3*n*sizeof\ (cl\_uchar)\f$ |
+     *        | D_OUT    | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$n*sizeof\ (cl\_float8)\f$  |
+     */
+    class ICPBackProject
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_D,    /*!< Input staging buffer for the depth frame. */
+            H_IN_RGB,  /*!< Input staging buffer for the RGB frame. */
+            H_OUT,     /*!< Output staging buffer for the point cloud. */
+            D_IN_D,    /*!< Input buffer for the depth frame. */
+            D_IN_RGB,  /*!< Input buffer for the RGB frame. */
+            D_OUT      /*!< Output buffer for the point cloud. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPBackProject (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPBackProject::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _width = 640, unsigned int _height = 480, 
+                   float _fx = 595.f, float _fy = 595.f, Staging _staging = Staging::IO);
+        /*! \brief Updates the camera parameters. */
+        void setIntrinsics (float _fx, float _fy, float _cx, float _cy);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPBackProject::Memory mem = ICPBackProject::Memory::D_IN_D, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPBackProject::Memory mem = ICPBackProject::Memory::H_OUT, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+
+        cl_ushort *hPtrInD;   /*!< Mapping of the input staging buffer for the depth frame. */
+        cl_uchar *hPtrInRGB;  /*!< Mapping of the input staging buffer for the RGB frame. */
+        cl_float *hPtrOut;    /*!< Mapping of the output staging buffer. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::NDRange global;
+        Staging staging;
+        unsigned int width, height, n;
+        cl_float4 intrinsics;
+        unsigned int bufferInDSize, bufferInRGBSize, bufferOutSize;
+        cl::Buffer hBufferInD, hBufferInRGB, hBufferOut;
+        cl::Buffer dBufferInD, dBufferInRGB, dBufferOut;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Interface class for the `icpNormals` kernel.
+     *  \details `icpNormals` estimates the surface normals of an organized point cloud,
+     *           like the one produced by `ICPBackProject`, from the central differences
+     *           on the grid. For more details, look at the kernel's documentation.
+     *  \note The `icpNormals` kernel is available in `kernels/icp_kernels.cl`.
+     *  \note The normal map of the fixed frame is needed by the point-to-plane
+     *        configuration of `ICPStep`. It has to be computed on the full point
+     *        cloud, before the cloud gets sampled for landmarks.
+     *  \note None of the front ends (`ICPOdometry`, `ICPPyramid`, `ICPTiled`, `ICPScheduler`)
+     *        runs `ICPNormals`, and none of them is available in the point-to-plane
+     *        configuration. The caller runs `ICPNormals` on the fixed frame before sampling
+     *        it with `ICPLMs`, and assigns `D_OUT` to the `D_IN_N` buffer of an
+     *        `ICP<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>` instance.
+     *  \note The class creates its own buffers. If you would like to provide
+     *        your own buffers, call `get` to get references to the placeholders
+     *        within the class and assign them to your buffers. You will have to
+     *        do this strictly before the call to `init`. You can also call `get`
+     *        (after the call to `init`) to get a reference to a buffer within
+     *        the class and assign it to another kernel class instance further
+     *        down in your task pipeline.
+     *
+     *        The following input/output `OpenCL` memory objects are created by a `ICPNormals` instance:<br>
+     *        | Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---  |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN  | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | H_OUT | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN  | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | D_OUT | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$n*sizeof\ (cl\_float4)\f$ |
+     */
+    class ICPNormals
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN,   /*!< Input staging buffer for the point cloud. */
+            H_OUT,  /*!< Output staging buffer for the normal map. */
+            D_IN,   /*!< Input buffer for the point cloud. */
+            D_OUT   /*!< Output buffer for the normal map. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPNormals (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPNormals::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _width = 640, unsigned int _height = 480,
+                   float _max_dz = 0.05f, Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPNormals::Memory mem = ICPNormals::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE,
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPNormals::Memory mem = ICPNormals::Memory::H_OUT, bool block = CL_TRUE,
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets the threshold for the depth discontinuities. */
+        float getDepthThreshold ();
+        /*! \brief Sets the threshold for the depth discontinuities. */
+        void setDepthThreshold (float _max_dz);
+
+        cl_float *hPtrIn;   /*!< Mapping of the input staging buffer. */
+        cl_float *hPtrOut;  /*!< Mapping of the output staging buffer. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::NDRange global;
+        Staging staging;
+        unsigned int width, height, n;
+        float max_dz;
+        unsigned int bufferInSize, bufferOutSize;
+        cl::Buffer hBufferIn, hBufferOut;
+        cl::Buffer dBufferIn, dBufferOut;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Interface class for the stream compaction of `float8` points.
+     *  \details Moves the points that satisfy a predicate to the front of an
+     *           array, retaining their relative order. The points are flagged 
+     *           by `compactFlag`, the flags are scanned by a `Scan<ScanConfig::EXCLUSIVE>`, 
+     *           and the points are moved by `compactScatter`. 
+     *           For more details, look at the kernels' documentation.
+     *  \note The kernels are available in `kernels/scan_kernels.cl`. By default, 
+     *        the points with a finite non-zero depth are kept. A different 
+     *        predicate can be given with the `COMPACT_PREDICATE` build option.
+     *  \note The flags are scanned as a single row, so the number of points is limited 
+     *        by the three-pass `Scan`. Call `setSinglePass (true)` to scan them with the 
+     *        single-pass `Scan` instead, which has no such limit. It's off by default, 
+     *        for the reasons given in `Scan`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a `Compact` instance:<br>
+     *        |  Name   | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---    |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN    | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | H_OUT   | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | H_COUNT | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$  sizeof\ (cl\_uint)  \f$ |
+     *        | D_IN    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | D_OUT   | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | D_COUNT | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$  sizeof\ (cl\_uint)  \f$ |
+     */
+    class Compact
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN,     /*!< Input staging buffer. */
+            H_OUT,    /*!< Output staging buffer. */
+            H_COUNT,  /*!< Output staging buffer with the number of kept points. */
+            D_IN,     /*!< Input buffer. */
+            D_FLAGS,  /*!< Buffer of point flags. */
+            D_SCAN,   /*!< Buffer of the scanned point flags, i.e. the positions of the kept points. */
+            D_OUT,    /*!< Output buffer. The first `count` points are the kept points. */
+            D_COUNT   /*!< Output buffer with the number of kept points. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        Compact (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (Compact::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _n, Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (Compact::Memory mem = Compact::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (Compact::Memory mem = Compact::Memory::H_OUT, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets the flag for the single-pass scan of the flags. */
+        bool getSinglePass ();
+        /*! \brief Sets the flag for the single-pass scan of the flags. */
+        void setSinglePass (bool _singlePass);
+
+        cl_float *hPtrIn;  /*!< Mapping of the input staging buffer. */
+        cl_float *hPtrOut;  /*!< Mapping of the output staging buffer. */
+        cl_uint *hPtrCount;  /*!< Mapping of the output staging buffer with the number of kept points. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel flagKernel, scatterKernel;
+        Scan<ScanConfig::EXCLUSIVE, cl_int> scan;
+        cl::NDRange globalF, globalS;
+        Staging staging;
+        bool singlePass;
+        unsigned int n, nPad, d;
+        unsigned int bufferInSize, bufferFlagsSize;
+        cl::Buffer hBufferIn, hBufferOut, hBufferCount;
+        cl::Buffer dBufferIn, dBufferFlags, dBufferOut, dBufferCount;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            double pTime;
+
+            queue.enqueueNDRangeKernel (flagKernel, cl::NullRange, globalF, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime = timer.duration ();
+
+            pTime += scan.run (timer);
+
+            queue.enqueueNDRangeKernel (scatterKernel, cl::NullRange, globalS, cl::NullRange, nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            return pTime;
+        }
+
+    };
+
+
+    /*! \brief Enumerates the memory layouts of a set of points. */
+    enum class ICPLayout : uint8_t
+    {
+        AOS,  /*!< Identifies the case where the points are stored as interleaved `cl_float8` 
+               *   elements, \f$ \left[ \begin{matrix} x & y & z & w & r & g & b & a 
+               *   \end{matrix} \right] \f$. */
+        SOA   /*!< Identifies the case where the points are split into a geometry stream of 
+               *   `cl_float4` elements and a packed color stream. 
+               *   Look at `ICPLMs`, `ICPSplit` and `ICPMerge`. */
+    };
+
+
+    /*! \brief Enumerates the storage formats of a packed color stream.
+     *  \note The formats only apply to the storage and the transfers of the stream. 
+     *        `ICPLMs` and `ICPMerge` convert the colors back to `float` when they produce 
+     *        the `cl_float8` points, and the `RBC` search reads `cl_float8` points in 
+     *        either case. So, `ICPColor::HALF` reduces the upload of a frame, but it 
+     *        doesn't reduce the memory traffic of the search.
+     */
+    enum class ICPColor : uint8_t
+    {
+        UCHAR,  /*!< Normalized `cl_uchar4` elements, 4 bytes per point. 
+                 *   Lossless for colors that come from 8-bit camera data. */
+        HALF    /*!< `half4` elements, 8 bytes per point. For colors that are no 
+                 *   longer on the 8-bit grid, e.g. after filtering. */
+    };
+
+
     /*! \brief Interface class for the `getLMs` kernel.
      *  \details `getLMs` samples a point cloud for landmarks.
      *           For more details, look at the kernel's documentation.
@@ -304,10 +706,28 @@ namespace ICP
      *        The following input/output `OpenCL` memory objects are created by a `ICPLMs` instance:<br>
      *        | Name | Type | Placement | I/O | Use | Properties | Size |
      *        | ---  |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
-     *        | H_IN  | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$640*480*sizeof\ (cl\_float8)\f$ |
-     *        | H_OUT | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$128*128*sizeof\ (cl\_float8)\f$ |
-     *        | D_IN  | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$640*480*sizeof\ (cl\_float8)\f$ |
-     *        | D_OUT | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$128*128*sizeof\ (cl\_float8)\f$ |
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN   | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$ or \f$n*sizeof\ (cl\_float4)\f$ |
+     *        | H_IN_C | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_uchar4)\f$ or \f$n*sizeof\ (cl\_half)*4\f$ |
+     *        | H_OUT  | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN   | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ or \f$n*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_C | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_uchar4)\f$ or \f$n*sizeof\ (cl\_half)*4\f$ |
+     *        | D_OUT  | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$m*sizeof\ (cl\_float8)\f$ |
+     *
+     *  \note When compaction is enabled, the landmarks are sampled only among the 
+     *        valid (non-zero depth) points, by the `icpFlagValid`, `icpGetRowTotals` 
+     *        and `getLMs_Compact` kernels and two `Scan<ScanConfig::INCLUSIVE>` 
+     *        instances. In that case, the program should also include 
+     *        `kernels/scan_kernels.cl`. Call `setSinglePass (true)` to scan the rows 
+     *        of flags with the single-pass `Scan`. It's off by default, for the 
+     *        reasons given in `Scan`.
+     *  \note With `ICPLayout::SOA`, the point cloud is given as a `cl_float4` geometry 
+     *        stream in `D_IN` and a packed color stream in `D_IN_C`, and the landmarks 
+     *        are gathered by `getLMs_SoA` (or `getLMs_SoA_Half`). The frame upload drops 
+     *        from 32 to 20 (or 24) bytes per point. The landmarks are still `cl_float8` 
+     *        elements, since the `RBC` search works on interleaved 8-D points. The 
+     *        `H_IN_C` and `D_IN_C` buffers are only created for `ICPLayout::SOA`.
      */
     class ICPLMs
     {
@@ -318,18 +738,26 @@ namespace ICP
          */
         enum class Memory : uint8_t
         {
-            H_IN,   /*!< Input staging buffer. */
-            H_OUT,  /*!< Output staging buffer. */
-            D_IN,   /*!< Input buffer. */
-            D_OUT   /*!< Output buffer. */
+            H_IN,    /*!< Input staging buffer (geometry stream, for `ICPLayout::SOA`). */
+            H_IN_C,  /*!< Input staging buffer for the color stream (for `ICPLayout::SOA`). */
+            H_OUT,   /*!< Output staging buffer. */
+            D_IN,    /*!< Input buffer (geometry stream, for `ICPLayout::SOA`). */
+            D_IN_C,  /*!< Input buffer for the color stream (for `ICPLayout::SOA`). */
+            D_OUT    /*!< Output buffer. */
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPLMs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPLMs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPLMs::Memory mem);
         /*! \brief Configures kernel execution parameters. */
-        void init (Staging _staging = Staging::IO);
+        void init (unsigned int _width = 640, unsigned int _height = 480, unsigned int _m = 16384, 
+                   bool _compact = false, Staging _staging = Staging::IO);
+        /*! \brief Configures kernel execution parameters for a specific memory layout of the point cloud. */
+        void init (unsigned int _width, unsigned int _height, unsigned int _m, bool _compact, 
+                   ICPLayout _layout, ICPColor _color = ICPColor::UCHAR, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPLMs::Memory mem = ICPLMs::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -338,21 +766,35 @@ namespace ICP
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
         void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets the flag for the single-pass scan of the valid flags. */
+        bool getSinglePass ();
+        /*! \brief Sets the flag for the single-pass scan of the valid flags. */
+        void setSinglePass (bool _singlePass);
 
         cl_float *hPtrIn;  /*!< Mapping of the input staging buffer. */
+        cl_uchar *hPtrInC;  /*!< Mapping of the input staging buffer for the color stream. 
+                             *   For `ICPColor::HALF`, it holds `cl_half` values. */
         cl_float *hPtrOut;  /*!< Mapping of the output staging buffer. */
 
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
-        cl::Kernel kernel;
-        cl::NDRange global;
+        cl::Kernel kernel, flagKernel, totalsKernel, compactKernel;
+        std::unique_ptr< Scan<ScanConfig::INCLUSIVE, cl_int> > scanFlags, scanTotals;
+        cl::NDRange global, globalF, globalT, globalC;
         Staging staging;
-        unsigned int n, m, d;
-        unsigned int bufferInSize, bufferOutSize;
-        cl::Buffer hBufferIn, hBufferOut, dBufferIn, dBufferOut;
+        ICPLayout layout;
+        ICPColor color;
+        bool compact, singlePass;
+        unsigned int width, height, n, m, mMax, lx, ly, d;
+        cl_uint4 area;
+        unsigned int bufferInSize, bufferInCSize, bufferOutSize, bufferTotalsSize;
+        cl::Buffer hBufferIn, hBufferInC, hBufferOut, dBufferIn, dBufferInC, dBufferOut;
+        cl::Buffer dBufferFlags, dBufferTotals;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -365,17 +807,40 @@ namespace ICP
         template <typename period>
         double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
         {
-            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            if (!compact)
+            {
+                queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+                queue.flush (); timer.wait ();
+
+                return timer.duration ();
+            }
+
+            double pTime;
+
+            queue.enqueueNDRangeKernel (flagKernel, cl::NullRange, globalF, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime = timer.duration ();
+
+            pTime += scanFlags->run (timer);
+
+            queue.enqueueNDRangeKernel (totalsKernel, cl::NullRange, globalT, cl::NullRange, nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            pTime += scanTotals->run (timer);
+
+            queue.enqueueNDRangeKernel (compactKernel, cl::NullRange, globalC, cl::NullRange, nullptr, &timer.event ());
             queue.flush (); timer.wait ();
+            pTime += timer.duration ();
             
-            return timer.duration ();
+            return pTime;
         }
 
     };
 
 
     /*! \brief Interface class for the `getReps` kernel.
-     *  \details `getReps` samples a set of landmarks `(|LM|=16384)` for representatives.
+     *  \details `getReps` samples a set of landmarks `(e.g. |LM|=16384)` for representatives.
      *           For more details, look at the kernel's documentation.
      *  \note The `getReps` kernel is available in `kernels/icp_kernels.cl`.
      *  \note The class creates its own buffers. If you would like to provide 
@@ -389,9 +854,9 @@ namespace ICP
      *        The following input/output `OpenCL` memory objects are created by a `ICPReps` instance:<br>
      *        | Name | Type | Placement | I/O | Use | Properties | Size |
      *        | ---  |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
-     *        | H_IN  | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$16384*sizeof\ (cl\_float8)\f$ |
+     *        | H_IN  | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m    *sizeof\ (cl\_float8)\f$ |
      *        | H_OUT | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$n_r  *sizeof\ (cl\_float8)\f$ |
-     *        | D_IN  | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$16384*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN  | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m    *sizeof\ (cl\_float8)\f$ |
      *        | D_OUT | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$n_r  *sizeof\ (cl\_float8)\f$ |
      */
     class ICPReps
@@ -410,11 +875,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPReps (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPReps (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPReps::Memory mem);
         /*! \brief Configures kernel execution parameters. */
-        void init (unsigned int _nr, Staging _staging = Staging::IO);
+        void init (unsigned int _nr, unsigned int _m = 16384, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _nr, unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPReps::Memory mem = ICPReps::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -430,12 +897,14 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
         cl::NDRange global;
         Staging staging;
-        unsigned int m, nr, nrx, nry, d;
+        unsigned int m, mMax, nr, nrMax, nrx, nry, lx, ly, d;
         unsigned int bufferInSize, bufferOutSize;
         cl::Buffer hBufferIn, hBufferOut, dBufferIn, dBufferOut;
 
@@ -503,11 +972,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPWeights (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPWeights (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPWeights::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _n, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _n);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPWeights::Memory mem = ICPWeights::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -524,13 +995,15 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel weightKernel, groupWeightKernel;
         cl::NDRange globalW, globalGW, local;
         Staging staging;
         size_t wgMultiple, wgXdim;
-        unsigned int n;
+        unsigned int n, nMax;
         unsigned int bufferInSize, bufferOutWSize, bufferGWSize, bufferOutSWSize;
         cl::Buffer hBufferIn, hBufferOutW, hBufferOutSW;
         cl::Buffer dBufferIn, dBufferOutW, dBufferOutSW;
@@ -620,6 +1093,11 @@ namespace ICP
      *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ |
      *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ |
      *        | D_OUT  | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$2*sizeof\ (cl\_float4)\f$ |
+     *  
+     *  \note When the sets span more than one work-group, call `setSinglePass (true)` to 
+     *        compute the means in a single launch of the `icpMean_SP` kernel, instead of 
+     *        the `icpMean` and `icpGMean` kernels. It's off by default, for the same 
+     *        reason as in `Reduce`.
      */
     template <>
     class ICPMean<ICPMeanConfig::REGULAR>
@@ -643,11 +1121,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPMean::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _n, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _n);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPMean::Memory mem = ICPMean::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -656,6 +1136,10 @@ namespace ICP
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
         void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets whether the means are computed in a single launch. */
+        bool getSinglePass ();
+        /*! \brief Sets whether the means are computed in a single launch. */
+        void setSinglePass (bool _singlePass);
 
         cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set. */
         cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set. */
@@ -664,16 +1148,19 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
-        cl::Kernel meanKernel, groupMeanKernel;
+        cl::Kernel meanKernel, groupMeanKernel, spKernel;
         cl::NDRange globalM, globalGM, local;
         Staging staging;
         size_t wgMultiple, wgXdim;
-        unsigned int n, d;
+        unsigned int n, nMax, d;
         unsigned int bufferInSize, bufferGMSize, bufferOutSize;
+        bool singlePass;
         cl::Buffer hBufferInF, hBufferInM, hBufferOut;
-        cl::Buffer dBufferInF, dBufferInM, dBufferGM, dBufferOut;
+        cl::Buffer dBufferInF, dBufferInM, dBufferGM, dBufferCount, dBufferOut;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -694,6 +1181,12 @@ namespace ICP
                 queue.flush (); timer.wait ();
                 pTime = timer.duration ();
             }
+            else if (singlePass)
+            {
+                queue.enqueueNDRangeKernel (spKernel, cl::NullRange, globalM, local, events, &timer.event ());
+                queue.flush (); timer.wait ();
+                pTime = timer.duration ();
+            }
             else
             {
                 queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events, &timer.event ());
@@ -766,11 +1259,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPMean::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _n, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _n);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPMean::Memory mem = ICPMean::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -789,13 +1284,15 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel meanKernel, groupMeanKernel;
         cl::NDRange globalM, globalGM, local;
         Staging staging;
         size_t wgMultiple, wgXdim;
-        unsigned int n, d;
+        unsigned int n, nMax, d;
         unsigned int bufferInFMSize, bufferInWSize, bufferInSWSize, bufferGMSize, bufferOutSize;
         cl::Buffer hBufferInF, hBufferInM, hBufferInW, hBufferInSW, hBufferOut;
         cl::Buffer dBufferInF, dBufferInM, dBufferInW, dBufferInSW, dBufferOut;
@@ -886,11 +1383,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPDevs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPDevs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPDevs::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _n, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _n);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPDevs::Memory mem = ICPDevs::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -909,12 +1408,14 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
         cl::NDRange global;
         Staging staging;
-        unsigned int n, d;
+        unsigned int n, nMax, d;
         unsigned int bufferInFMSize, bufferInMeanSize, bufferOutSize;
         cl::Buffer hBufferInF, hBufferInM, hBufferInMean, hBufferOutDF, hBufferOutDM;
         cl::Buffer dBufferInF, dBufferInM, dBufferInMean, dBufferOutDF, dBufferOutDM;
@@ -942,8 +1443,10 @@ namespace ICP
     /*! \brief Enumerates configurations for the `ICPS` class. */
     enum class ICPSConfig : uint8_t
     { 
-        REGULAR,  /*!< Identifies the case of regular sums of products. */
-        WEIGHTED  /*!< Identifies the case of weighted sums of products. */
+        REGULAR,   /*!< Identifies the case of regular sums of products. */
+        WEIGHTED,  /*!< Identifies the case of weighted sums of products. */
+        FUSED      /*!< Identifies the case of weighted sums of products, 
+                    *   computed together with the weighted means in one pass. */
     };
 
 
@@ -1009,11 +1512,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPS::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, float _c, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPS::Memory mem = ICPS::Memory::D_IN_DEV_M, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -1034,6 +1539,8 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
@@ -1041,7 +1548,7 @@ namespace ICP
         Reduce<ReduceConfig::SUM, cl_float> reduceSij;
         Staging staging;
         float c;
-        unsigned int m, d;
+        unsigned int m, mMax, d;
         unsigned int bufferInSize, bufferSijSize, bufferOutSize;
         cl::Buffer hBufferInDM, hBufferInDF, hBufferSij, hBufferOut;
         cl::Buffer dBufferInDM, dBufferInDF, dBufferSij, dBufferOut;
@@ -1122,11 +1629,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPS::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, float _c, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPS::Memory mem = ICPS::Memory::D_IN_DEV_M, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -1148,14 +1657,16 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
-        cl::NDRange global;
+        cl::NDRange global, local;
         Reduce<ReduceConfig::SUM, cl_float> reduceSij;
         Staging staging;
         float c;
-        unsigned int m, d;
+        unsigned int m, mMax, d, ept, wgSize;
         unsigned int bufferInFMSize, bufferInWSize, bufferSijSize, bufferOutSize;
         cl::Buffer hBufferInDM, hBufferInDF, hBufferInW, hBufferSij, hBufferOut;
         cl::Buffer dBufferInDM, dBufferInDF, dBufferInW, dBufferSij, dBufferOut;
@@ -1173,7 +1684,7 @@ namespace ICP
         {
             double pTime;
 
-            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, local, events, &timer.event ());
             queue.flush (); timer.wait ();
             pTime = timer.duration ();
             
@@ -1185,17 +1696,144 @@ namespace ICP
     };
 
 
-    /*! \brief Enumerates configurations for the `ICPTransform` class. */
-    enum class ICPTransformConfig : uint8_t
-    { 
-        QUATERNION, /*!< Identifies the case where the homogeneous transformation 
-                     *   is characterized by a quaternion and a translation vector, 
-                     *   \f$\ p' = s\dot{q}\dot{p}\dot{q}^*+t \f$. */
-        MATRIX  /*!< Identifies the case where the homogeneous transformation 
-                 *   is characterized by a transformation matrix, 
-                 *   \f$ p' = Tp = \left[ \begin{matrix} sR & t \\ 0 & 1 \end{matrix} \right]
-                 *   \left[ \begin{matrix} p \\ 1 \end{matrix} \right] = sRp+t \f$. */
-    };
+    /*! \brief Interface class for calculating the S matrix, the s scale factor constituents, 
+     *         and the means, while considering weighted residual errors.
+     *  \details The class uses the `icpSijProducts_Fused` kernel to produce, in one pass over 
+     *           the sets, the weighted sums of products and the weighted sums of the points. 
+     *           It reduces them with the `reduce_sum` kernel, and then recovers the S matrix 
+     *           and the means with the `icpSijFinalize_Fused` kernel. It replaces the sequence 
+     *           of `ICPMean<ICPMeanConfig::WEIGHTED>`, `ICPDevs` and `ICPS<ICPSConfig::WEIGHTED>`, 
+     *           without the intermediate deviation buffers. For more details, look at the 
+     *           kernels' documentation.
+     *  \note The `icpSijProducts_Fused` and `icpSijFinalize_Fused` kernels are available in 
+     *        `kernels/icp_kernels.cl`, and the `reduce_sum` kernel is available in 
+     *        `kernels/reduce_kernels.cl`.
+     *  \note The `D_OUT_MEAN` buffer holds the reference points for the shifted sums, and 
+     *        gets overwritten with the means on every run. It is zeroed in `init`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a `ICPS` instance:<br>
+     *        | Name | Type | Placement | I/O | Use | Properties | Size |
+     *        | ---  |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_OUT      | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$11*sizeof\ (cl\_float) \f$ |
+     *        | H_OUT_MEAN | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_F     | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_M     | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_W     | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float) \f$ |
+     *        | D_IN_SUM_W | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$sizeof\ (cl\_double)  \f$ |
+     *        | D_OUT      | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$11*sizeof\ (cl\_float) \f$ |
+     *        | D_OUT_MEAN | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     */
+    template <>
+    class ICPS<ICPSConfig::FUSED>
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_OUT,       /*!< Output staging buffer with the `S` matrix (first 9 floats) and 
+                          *   the constituents of the scale factor `s` (last 2 floats). */
+            H_OUT_MEAN,  /*!< Output staging buffer with the means of the fixed and moving sets. */
+            D_IN_F,      /*!< Input buffer for the fixed set. */
+            D_IN_M,      /*!< Input buffer for the moving set. */
+            D_IN_W,      /*!< Input buffer for the weights. */
+            D_IN_SUM_W,  /*!< Input buffer for the sum of the weights. */
+            D_SIJ,       /*!< Buffer for the partial sums. */
+            D_SUMS,      /*!< Buffer for the reduced sums. */
+            D_OUT,       /*!< Output buffer with the `S` matrix (first 9 floats) and 
+                          *   the constituents of the scale factor `s` (last 2 floats). */
+            D_OUT_MEAN   /*!< Output buffer with the means of the fixed and moving sets. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPS::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, float _c, Staging _staging = Staging::O);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPS::Memory mem = ICPS::Memory::H_OUT, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets the scaling factor c. */
+        float getScaling ();
+        /*! \brief Sets the scaling factor c. */
+        void setScaling (float _c);
+
+        cl_float *hPtrOut;  /*!< Mapping of the output staging buffer with the S matrix and scale factor s. */
+        cl_float *hPtrOutMean;  /*!< Mapping of the output staging buffer with the means. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel, finalKernel;
+        cl::NDRange global;
+        Reduce<ReduceConfig::SUM, cl_float> reduceSij;
+        Staging staging;
+        float c;
+        unsigned int m, mMax;
+        unsigned int bufferInFMSize, bufferInWSize, bufferSijSize, bufferSumsSize, bufferOutSize, bufferMeanSize;
+        cl::Buffer hBufferOut, hBufferMean;
+        cl::Buffer dBufferInF, dBufferInM, dBufferInW, dBufferInSumW;
+        cl::Buffer dBufferSij, dBufferSums, dBufferOut, dBufferMean;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            double pTime;
+
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime = timer.duration ();
+            
+            pTime += reduceSij.run (timer);
+
+            queue.enqueueNDRangeKernel (finalKernel, cl::NullRange, cl::NDRange (1), cl::NullRange, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            return pTime;
+        }
+
+    };
+
+
+    /*! \brief Enumerates configurations for the `ICPTransform` class. */
+    enum class ICPTransformConfig : uint8_t
+    { 
+        QUATERNION, /*!< Identifies the case where the homogeneous transformation 
+                     *   is characterized by a quaternion and a translation vector, 
+                     *   \f$\ p' = s\dot{q}\dot{p}\dot{q}^*+t \f$. */
+        MATRIX  /*!< Identifies the case where the homogeneous transformation 
+                 *   is characterized by a transformation matrix, 
+                 *   \f$ p' = Tp = \left[ \begin{matrix} sR & t \\ 0 & 1 \end{matrix} \right]
+                 *   \left[ \begin{matrix} p \\ 1 \end{matrix} \right] = sRp+t \f$. */
+    };
 
 
     /*! \brief Interface class for the `icpTransform` kernels.
@@ -1206,8 +1844,9 @@ namespace ICP
      *        for specific instantiations of the class.
      *        
      *  \tparam C configures the class for different types of transformation parameters.
+     *  \tparam L configures the class for different memory layouts of the set of points.
      */
-    template <ICPTransformConfig C>
+    template <ICPTransformConfig C, ICPLayout L = ICPLayout::AOS>
     class ICPTransform;
 
 
@@ -1269,11 +1908,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPTransform::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPTransform::Memory mem = ICPTransform::Memory::D_IN_M, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -1290,12 +1931,14 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
         cl::NDRange global;
         Staging staging;
-        unsigned int m, d;
+        unsigned int m, mMax, d;
         unsigned int bufferInMSize, bufferInTSize, bufferOutSize;
         cl::Buffer hBufferInM, hBufferInT, hBufferOut;
         cl::Buffer dBufferInM, dBufferInT, dBufferOut;
@@ -1373,11 +2016,13 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPTransform::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPTransform::Memory mem = ICPTransform::Memory::D_IN_M, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -1394,12 +2039,14 @@ namespace ICP
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
         cl::NDRange global;
         Staging staging;
-        unsigned int m, d;
+        unsigned int m, mMax, d;
         unsigned int bufferInMSize, bufferInTSize, bufferOutSize;
         cl::Buffer hBufferInM, hBufferInT, hBufferOut;
         cl::Buffer dBufferInM, dBufferInT, dBufferOut;
@@ -1424,11 +2071,12 @@ namespace ICP
     };
 
 
-    /*! \brief Interface class for the `icpTransform_Matrix` kernel.
-     *  \details The `icpTransform_Matrix` kernel performs a homogeneous 
-     *           transformation on a set of points using a transformation matrix. 
-     *           For more details, look at the kernel's documentation.
-     *  \note The `icpTransform_Matrix` kernel is available in `kernels/icp_kernels.cl`.
+    /*! \brief Interface class for the `icpTransform_Quaternion_SoA` kernel.
+     *  \details The `icpTransform_Quaternion_SoA` kernel performs a homogeneous 
+     *           transformation on the geometry stream of a set of points using a 
+     *           quaternion and a translation vector. The color stream is not touched. 
+     *           For more details, look at the kernels' documentation.
+     *  \note The `icpTransform_Quaternion_SoA` kernel is available in `kernels/icp_kernels.cl`.
      *  \note The class creates its own buffers. If you would like to provide 
      *        your own buffers, call `get` to get references to the placeholders 
      *        within the class and assign them to your buffers. You will have to 
@@ -1438,17 +2086,18 @@ namespace ICP
      *        down in your task pipeline.
      *  
      *        The following input/output `OpenCL` memory objects are created by a 
-     *        `ICPTransform<ICPTransformConfig::MATRIX>` instance:<br>
+     *        `ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>` instance:<br>
      *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
      *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
-     *        | H_IN_S    | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$11*sizeof\ (cl\_float)\f$ |
-     *        | H_IN_MEAN | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
-     *        | H_OUT_T_K | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
-     *        | D_IN_S    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$11*sizeof\ (cl\_float)\f$ |
-     *        | D_IN_MEAN | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*sizeof\ (cl\_float4)\f$ |
-     *        | D_OUT_T_K | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | H_IN_T | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_OUT  | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_T | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_OUT  | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$m*sizeof\ (cl\_float4)\f$ |
      */
-    class ICPPowerMethod
+    template <>
+    class ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>
     {
     public:
         /*! \brief Enumerates the memory objects handled by the class.
@@ -1456,66 +2105,64 @@ namespace ICP
          *  \note `D_*` names refer to buffers on the device.
          */
         enum class Memory : uint8_t
-        {
-            H_IN_S,     /*!< Input staging buffer for the sums of products. The first `9 cl_float` 
-                         *   elements (in row major order) are the \f$S_k\f$ matrix, and the next 
-                         *   `2 cl_float` are the numerator and denominator of the scale \f$s_k\f$. */
-            H_IN_MEAN,  /*!< Input staging buffer for the set means. The first `cl_float4` is 
-                         *   the fixed set mean, and the second one is the moving set mean. */
-            H_OUT_T_K,  /*!< Output staging buffer for the parameters that represent the incremental 
-                         *   development in the transformation estimation. The first `float4` 
-                         *   is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
-                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
-                         *   and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
-                         *   t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
-                         *   in the last element of the translation vector. That is, \f$ t_k = 
-                         *   \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$. */
-            D_IN_S,     /*!< Input buffer for the sums of products. The first `9 cl_float` elements 
-                         *   (in row major order) are the \f$S_k\f$ matrix, and the next `2 cl_float` 
-                         *   are the numerator and denominator of the scale \f$s_k\f$. */
-            D_IN_MEAN,  /*!< Input buffer for the set means. The first `cl_float4` is the 
-                         *   fixed set mean, and the second one is the moving set mean. */
-            D_OUT_T_K   /*!< Output buffer for the parameters that represent the incremental 
-                         *   development in the transformation estimation. The first `float4` 
-                         *   is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
-                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
-                         *   and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
-                         *   t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
-                         *   in the last element of the translation vector. That is, \f$ t_k = 
-                         *   \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$. */
+        { 
+            H_IN_M,  /*!< Input staging buffer for the geometry stream of the set of points. */
+            H_IN_T,  /*!< Input staging buffer for the quaternion and the translation vector. 
+                      *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
+                      *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                      *   and the second `cl_float4` element contains the translation vector, 
+                      *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. 
+                      *   If scaling is desired, the factor should be placed in the last element 
+                      *   of the translation vector, \f$ t = \left[ \begin{matrix} t_x & t_y 
+                      *   & t_z & s \end{matrix} \right]^T \f$. */
+            H_OUT,   /*!< Output staging buffer for the transformed geometry stream. */
+            D_IN_M,  /*!< Input buffer for the geometry stream of the set of points. */
+            D_IN_T,  /*!< Input buffer for the quaternion and the translation vector. 
+                      *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
+                      *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                      *   and the second `cl_float4` element contains the translation vector, 
+                      *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. 
+                      *   If scaling is desired, the factor should be placed in the last element 
+                      *   of the translation vector, \f$ t = \left[ \begin{matrix} t_x & t_y 
+                      *   & t_z & s \end{matrix} \right]^T \f$. */
+            D_OUT    /*!< Output buffer for the transformed geometry stream. */
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPPowerMethod (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info);
+        ICPTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
-        cl::Memory& get (ICPPowerMethod::Memory mem);
+        cl::Memory& get (ICPTransform::Memory mem);
         /*! \brief Configures kernel execution parameters. */
-        void init (Staging _staging = Staging::IO);
+        void init (unsigned int _m, Staging _staging = Staging::IO);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
         /*! \brief Performs a data transfer to a device buffer. */
-        void write (ICPPowerMethod::Memory mem = ICPPowerMethod::Memory::D_IN_S, 
-                    void *ptr = nullptr, bool block = CL_FALSE, 
+        void write (ICPTransform::Memory mem = ICPTransform::Memory::D_IN_M, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Performs a data transfer to a staging buffer. */
-        void* read (ICPPowerMethod::Memory mem = ICPPowerMethod::Memory::H_OUT_T_K, bool block = CL_TRUE, 
+        void* read (ICPTransform::Memory mem = ICPTransform::Memory::H_OUT, bool block = CL_TRUE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
         void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
 
-        cl_float *hPtrInS;     /*!< Mapping of the input staging buffer for the sums of products. */
-        cl_float *hPtrInMean;  /*!< Mapping of the input staging buffer for the fixed and moving set means. */
-        cl_float *hPtrOutTk;   /*!< Mapping of the output staging buffer for the incremental parameters. */
+        cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the geometry stream. */
+        cl_float *hPtrInT;  /*!< Mapping of the input staging buffer for the quaternion and the translation vector. */
+        cl_float *hPtrOut;  /*!< Mapping of the output staging buffer. */
 
     private:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         cl::Kernel kernel;
         cl::NDRange global;
         Staging staging;
-        unsigned int bufferInSSize, bufferInMeanSize, bufferOutTkSize;
-        cl::Buffer hBufferInS, hBufferInMean, hBufferOutTk;
-        cl::Buffer dBufferInS, dBufferInMean, dBufferOutTk;
+        unsigned int m, mMax, d;
+        unsigned int bufferInMSize, bufferInTSize, bufferOutSize;
+        cl::Buffer hBufferInM, hBufferInT, hBufferOut;
+        cl::Buffer dBufferInM, dBufferInT, dBufferOut;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -1528,7 +2175,7 @@ namespace ICP
         template <typename period>
         double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
         {
-            queue.enqueueTask (kernel, events, &timer.event ());
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
             queue.flush (); timer.wait ();
 
             return timer.duration ();
@@ -1537,60 +2184,16 @@ namespace ICP
     };
 
 
-    /*! \brief Enumerates configurations for the `ICPStep` class.
-     *  \details All computation is done on the `GPU`. The only point of divergence 
-     *           in the `%ICP` data flow is the rotation computation.
-     */
-    enum class ICPStepConfigT : uint8_t
-    { 
-        EIGEN, /*!< [**CPU**] Identifies the case where the **JacobiSVD** in **Eigen3** 
-                *   is used to compute the singular value decomposition of matrix \f$S\f$. 
-                *   Given \f$ S=USV^T \f$, the rotation matrix is then built as \f$R=VU^T\f$. */
-        POWER_METHOD,  /*!< [**GPU**] Identifies the case where the **Power Method** is used to 
-                        *   find the unit quaternion \f$\dot{q}\f$ that describes the rotation.
-                        *   It computes the eigenvector \f$\mathcal{v}=\dot{q}\f$ that corresponds 
-                        *   to the maximum eigenvalue of matrix \f$N\f$. */
-        JACOBI  /*!< \todo [**GPU**] Identifies the case where one of the **Jacobi methods** 
-                 *         is used to compute the unit quaternion \f$\dot{q}\f$ that describes 
-                 *         the rotation. */
-    };
-
-
-    /*! \brief Enumerates configurations for the `ICPStep` class. */
-    enum class ICPStepConfigW : uint8_t
-    { 
-        REGULAR,  /*!< Identifies the case of regular sum of errors. */
-        WEIGHTED  /*!< Identifies the case of weighted sum of errors. */
-    };
-
-
-    /*! \brief Interface class for the `%ICP` pipeline.
-     *  \details Performs one `%ICP` iteration. It accepts two sets (fixed and moving) of 
-     *           landmarks, estimates the relative homogeneous transformation \f$ T_k \f$ 
-     *           between them, and transforms the moving set according to this transformation.
-     *  \note The implemented algorithms are described by `Horn` in 
-     *        [Closed-Form Solution of Absolute Orientation Using Unit Quaternions][1] and 
-     *        by `Arun` et al. in [Least-Squares Fitting of Two 3-D Point Sets][2].
-     *        [1]: http://people.csail.mit.edu/bkph/papers/Absolute_Orientation.pdf
-     *        [2]: http://bmi214.stanford.edu/bmiarc/bmi214-2008/articles/arun.pdf
-     *  \note This is just a declaration. Look at the explicit template specializations
-     *        for specific instantiations of the class.
-     *        
-     *  \tparam CR configures the class with different methods of rotation computation.
-     *  \tparam CW configures the class for performing either regular or weighted computation.
-     */
-    template <ICPStepConfigT CR, ICPStepConfigW CW>
-    class ICPStep;
-
-
-    /*! \brief Interface class for the `%ICP` pipeline using the Eigen library 
-     *         to estimate the rotation and considering regular residual errors.
-     *  \details Performs one `%ICP` iteration. It accepts two sets (fixed and moving) 
-     *           of landmarks, estimates the relative homogeneous transformation 
-     *           \f$ (\dot{q}_k,t_k) \f$ between them, and transforms the moving set 
-     *           according to this transformation.
-     *  \note All computation is done on the `GPU`, except from the rotation 
-     *        computation which is solved on the `CPU` with `Eigen::JacobiSVD`.
+    /*! \brief Interface class for the `icpSplit_SoA` kernel.
+     *  \details The `icpSplit_SoA` kernel splits a set of interleaved `cl_float8` 
+     *           points into a `cl_float4` geometry stream and a normalized `cl_uchar4` 
+     *           color stream. The kernels that only need the geometry, like 
+     *           `icpTransform_Quaternion_SoA`, then touch 16 bytes per point instead 
+     *           of 32, and the set occupies 20 bytes per point on the device. 
+     *           With `ICPColor::HALF`, the `icpSplit_SoA_Half` kernel is used instead, 
+     *           and the color stream holds `half4` elements (24 bytes per point).
+     *           For more details, look at the kernels' documentation.
+     *  \note The `icpSplit_SoA` kernels are available in `kernels/icp_kernels.cl`.
      *  \note The class creates its own buffers. If you would like to provide 
      *        your own buffers, call `get` to get references to the placeholders 
      *        within the class and assign them to your buffers. You will have to 
@@ -1599,19 +2202,17 @@ namespace ICP
      *        the class and assign it to another kernel class instance further 
      *        down in your task pipeline.
      *  
-     *        The following input/output `OpenCL` memory objects are created 
-     *        by an `ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>` instance:<br>
-     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
-     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
-     *        | H_IN_F | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
-     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
-     *        | H_IO_T | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
-     *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
-     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
-     *        | D_IO_T | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        The following input/output `OpenCL` memory objects are created by a `ICPSplit` instance:<br>
+     *        |  Name   | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---    |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN    | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | H_OUT_G | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | H_OUT_C | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_uchar4)\f$ or \f$m*sizeof\ (cl\_half)*4\f$ |
+     *        | D_IN    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_OUT_G | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | D_OUT_C | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$m*sizeof\ (cl\_uchar4)\f$ or \f$m*sizeof\ (cl\_half)*4\f$ |
      */
-    template <>
-    class ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>
+    class ICPSplit
     {
     public:
         /*! \brief Enumerates the memory objects handled by the class.
@@ -1620,23 +2221,782 @@ namespace ICP
          */
         enum class Memory : uint8_t
         {
-            H_IN_F,    /*!< Input staging buffer for the fixed set of landmarks. */
-            H_IN_M,    /*!< Input staging buffer for the moving set of landmarks. */
-            H_IO_T,    /*!< Input-output staging buffer for the quaternion and the translation vector. 
-                        *   It is loaded with an initial estimation of the transformation 
-                        *   and gets refined with every %ICP iteration.
-                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
-                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
-                        *   and the second `cl_float4` element contains the translation vector, 
-                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. 
-                        *   If scaling is desired, the factor should be placed in the last element 
-                        *   of the translation vector, \f$ t = \left[ \begin{matrix} t_x & t_y 
-                        *   & t_z & s \end{matrix} \right]^T \f$. */
-            D_IN_F,    /*!< Input buffer for the fixed set of landmarks. */
-            D_IN_M,    /*!< Input buffer for the moving set of landmarks. */
-            D_IO_T,    /*!< Input-output buffer for the quaternion and the translation vector. 
-                        *   It is loaded with an initial estimation of the transformation 
-                        *   and gets refined with every %ICP iteration.
+            H_IN,     /*!< Input staging buffer for the set of interleaved points. */
+            H_OUT_G,  /*!< Output staging buffer for the geometry stream. */
+            H_OUT_C,  /*!< Output staging buffer for the color stream. */
+            D_IN,     /*!< Input buffer for the set of interleaved points. */
+            D_OUT_G,  /*!< Output buffer for the geometry stream. */
+            D_OUT_C   /*!< Output buffer for the color stream. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPSplit (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPSplit::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, ICPColor _color = ICPColor::UCHAR, Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPSplit::Memory mem = ICPSplit::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPSplit::Memory mem = ICPSplit::Memory::H_OUT_G, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+
+        cl_float *hPtrIn;  /*!< Mapping of the input staging buffer. */
+        cl_float *hPtrOutG;  /*!< Mapping of the output staging buffer for the geometry stream. */
+        cl_uchar *hPtrOutC;  /*!< Mapping of the output staging buffer for the color stream. 
+                              *   For `ICPColor::HALF`, it holds `cl_half` values. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::NDRange global;
+        Staging staging;
+        ICPColor color;
+        unsigned int m;
+        unsigned int bufferInSize, bufferOutGSize, bufferOutCSize;
+        cl::Buffer hBufferIn, hBufferOutG, hBufferOutC;
+        cl::Buffer dBufferIn, dBufferOutG, dBufferOutC;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Interface class for the `icpMerge_SoA` kernel.
+     *  \details The `icpMerge_SoA` kernel merges a `cl_float4` geometry stream 
+     *           and a normalized `cl_uchar4` color stream into a set of interleaved 
+     *           `cl_float8` points. It's the inverse of `ICPSplit`, and it's meant 
+     *           for feeding the stages that need the full 8-D points, like the 
+     *           RBC search on the photogeometric distance. With `ICPColor::HALF`, 
+     *           the `icpMerge_SoA_Half` kernel is used instead.
+     *           For more details, look at the kernels' documentation.
+     *  \note The `icpMerge_SoA` kernels are available in `kernels/icp_kernels.cl`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a `ICPMerge` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_G | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | H_IN_C | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_uchar4)\f$ or \f$m*sizeof\ (cl\_half)*4\f$ |
+     *        | H_OUT  | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_G | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_C | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_uchar4)\f$ or \f$m*sizeof\ (cl\_half)*4\f$ |
+     *        | D_OUT  | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$m*sizeof\ (cl\_float8)\f$ |
+     */
+    class ICPMerge
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_G,  /*!< Input staging buffer for the geometry stream. */
+            H_IN_C,  /*!< Input staging buffer for the color stream. */
+            H_OUT,   /*!< Output staging buffer for the set of interleaved points. */
+            D_IN_G,  /*!< Input buffer for the geometry stream. */
+            D_IN_C,  /*!< Input buffer for the color stream. */
+            D_OUT    /*!< Output buffer for the set of interleaved points. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPMerge (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPMerge::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, ICPColor _color = ICPColor::UCHAR, Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPMerge::Memory mem = ICPMerge::Memory::D_IN_G, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPMerge::Memory mem = ICPMerge::Memory::H_OUT, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+
+        cl_float *hPtrInG;  /*!< Mapping of the input staging buffer for the geometry stream. */
+        cl_uchar *hPtrInC;  /*!< Mapping of the input staging buffer for the color stream. 
+                             *   For `ICPColor::HALF`, it holds `cl_half` values. */
+        cl_float *hPtrOut;  /*!< Mapping of the output staging buffer. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::NDRange global;
+        Staging staging;
+        ICPColor color;
+        unsigned int m;
+        unsigned int bufferInGSize, bufferInCSize, bufferOutSize;
+        cl::Buffer hBufferInG, hBufferInC, hBufferOut;
+        cl::Buffer dBufferInG, dBufferInC, dBufferOut;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Interface class for the `icpTransform_Matrix` kernel.
+     *  \details The `icpTransform_Matrix` kernel performs a homogeneous 
+     *           transformation on a set of points using a transformation matrix. 
+     *           For more details, look at the kernel's documentation.
+     *  \note The `icpTransform_Matrix` kernel is available in `kernels/icp_kernels.cl`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  \note `D_OUT_T_K` is also read by the kernel when warm starting, 
+     *        so it holds the previous \f$ q_k \f$ between calls.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a 
+     *        `ICPTransform<ICPTransformConfig::MATRIX>` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_S    | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$11*sizeof\ (cl\_float)\f$ |
+     *        | H_IN_MEAN | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_OUT_T_K | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_OUT_ITER| Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$sizeof\ (cl\_uint)\f$ |
+     *        | D_IN_S    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$11*sizeof\ (cl\_float)\f$ |
+     *        | D_IN_MEAN | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_OUT_T_K | Buffer | Device | O | Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_OUT_ITER| Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$sizeof\ (cl\_uint)\f$ |
+     */
+    class ICPPowerMethod
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_S,     /*!< Input staging buffer for the sums of products. The first `9 cl_float` 
+                         *   elements (in row major order) are the \f$S_k\f$ matrix, and the next 
+                         *   `2 cl_float` are the numerator and denominator of the scale \f$s_k\f$. */
+            H_IN_MEAN,  /*!< Input staging buffer for the set means. The first `cl_float4` is 
+                         *   the fixed set mean, and the second one is the moving set mean. */
+            H_OUT_T_K,  /*!< Output staging buffer for the parameters that represent the incremental 
+                         *   development in the transformation estimation. The first `float4` 
+                         *   is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
+                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                         *   and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
+                         *   t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
+                         *   in the last element of the translation vector. That is, \f$ t_k = 
+                         *   \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$. */
+            H_OUT_ITER, /*!< Output staging buffer for the number of Power Method iterations. */
+            D_IN_S,     /*!< Input buffer for the sums of products. The first `9 cl_float` elements 
+                         *   (in row major order) are the \f$S_k\f$ matrix, and the next `2 cl_float` 
+                         *   are the numerator and denominator of the scale \f$s_k\f$. */
+            D_IN_MEAN,  /*!< Input buffer for the set means. The first `cl_float4` is the 
+                         *   fixed set mean, and the second one is the moving set mean. */
+            D_OUT_T_K,  /*!< Output buffer for the parameters that represent the incremental 
+                         *   development in the transformation estimation. The first `float4` 
+                         *   is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
+                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                         *   and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
+                         *   t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
+                         *   in the last element of the translation vector. That is, \f$ t_k = 
+                         *   \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$. */
+            D_OUT_ITER  /*!< Output buffer for the number of Power Method iterations. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPPowerMethod (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPPowerMethod::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPPowerMethod::Memory mem = ICPPowerMethod::Memory::D_IN_S, 
+                    void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPPowerMethod::Memory mem = ICPPowerMethod::Memory::H_OUT_T_K, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets the convergence tolerance of the Power Method. */
+        float getTolerance ();
+        /*! \brief Sets the convergence tolerance of the Power Method. */
+        void setTolerance (float _tolerance);
+        /*! \brief Gets the maximum number of Power Method iterations. */
+        unsigned int getMaxIterations ();
+        /*! \brief Sets the maximum number of Power Method iterations. */
+        void setMaxIterations (unsigned int _max_iterations);
+        /*! \brief Gets the flag for warm starting the Power Method. */
+        bool getWarmStart ();
+        /*! \brief Sets the flag for warm starting the Power Method. */
+        void setWarmStart (bool _warm_start);
+
+        cl_float *hPtrInS;     /*!< Mapping of the input staging buffer for the sums of products. */
+        cl_float *hPtrInMean;  /*!< Mapping of the input staging buffer for the fixed and moving set means. */
+        cl_float *hPtrOutTk;   /*!< Mapping of the output staging buffer for the incremental parameters. */
+        cl_uint *hPtrOutIter;  /*!< Mapping of the output staging buffer for the number of iterations. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::NDRange global;
+        Staging staging;
+        float tolerance;
+        unsigned int max_iterations;
+        bool warm_start;
+        unsigned int bufferInSSize, bufferInMeanSize, bufferOutTkSize, bufferOutIterSize;
+        cl::Buffer hBufferInS, hBufferInMean, hBufferOutTk, hBufferOutIter;
+        cl::Buffer dBufferInS, dBufferInMean, dBufferOutTk, dBufferOutIter;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueTask (kernel, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Interface class for the `icpSVD` kernel.
+     *  \details The `icpSVD` kernel computes the incremental transformation 
+     *           \f$ (\dot{q}_k,t_k,s_k) \f$ from the `S` matrix and the set means, 
+     *           by solving for the rotation with a closed-form 3x3 SVD on the device. 
+     *           Its output has the same layout as that of `ICPPowerMethod`, so it 
+     *           can feed an `ICPUpdateTransform` instance in the same way.
+     *           For more details, look at the kernel's documentation.
+     *  \note The `icpSVD` kernel is available in `kernels/icp_kernels.cl`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a `ICPSVD` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_S    | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$11*sizeof\ (cl\_float)\f$ |
+     *        | H_IN_MEAN | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_OUT_T_K | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_S    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$11*sizeof\ (cl\_float)\f$ |
+     *        | D_IN_MEAN | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_OUT_T_K | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$2*sizeof\ (cl\_float4)\f$ |
+     */
+    class ICPSVD
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_S,     /*!< Input staging buffer for the sums of products. The first `9 cl_float` 
+                         *   elements (in row major order) are the \f$S_k\f$ matrix, and the next 
+                         *   `2 cl_float` are the numerator and denominator of the scale \f$s_k\f$. */
+            H_IN_MEAN,  /*!< Input staging buffer for the set means. The first `cl_float4` is 
+                         *   the fixed set mean, and the second one is the moving set mean. */
+            H_OUT_T_K,  /*!< Output staging buffer for the parameters that represent the incremental 
+                         *   development in the transformation estimation. The first `float4` 
+                         *   is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
+                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                         *   and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
+                         *   t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
+                         *   in the last element of the translation vector. That is, \f$ t_k = 
+                         *   \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$. */
+            D_IN_S,     /*!< Input buffer for the sums of products. The first `9 cl_float` elements 
+                         *   (in row major order) are the \f$S_k\f$ matrix, and the next `2 cl_float` 
+                         *   are the numerator and denominator of the scale \f$s_k\f$. */
+            D_IN_MEAN,  /*!< Input buffer for the set means. The first `cl_float4` is the 
+                         *   fixed set mean, and the second one is the moving set mean. */
+            D_OUT_T_K   /*!< Output buffer for the parameters that represent the incremental 
+                         *   development in the transformation estimation. The first `float4` 
+                         *   is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
+                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                         *   and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
+                         *   t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
+                         *   in the last element of the translation vector. That is, \f$ t_k = 
+                         *   \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPSVD (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPSVD::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPSVD::Memory mem = ICPSVD::Memory::D_IN_S, 
+                    void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPSVD::Memory mem = ICPSVD::Memory::H_OUT_T_K, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+
+        cl_float *hPtrInS;     /*!< Mapping of the input staging buffer for the sums of products. */
+        cl_float *hPtrInMean;  /*!< Mapping of the input staging buffer for the fixed and moving set means. */
+        cl_float *hPtrOutTk;   /*!< Mapping of the output staging buffer for the incremental parameters. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::NDRange global;
+        Staging staging;
+        unsigned int bufferInSSize, bufferInMeanSize, bufferOutTkSize;
+        cl::Buffer hBufferInS, hBufferInMean, hBufferOutTk;
+        cl::Buffer dBufferInS, dBufferInMean, dBufferOutTk;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueTask (kernel, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Interface class for estimating the incremental transformation
+     *         that minimizes the point-to-plane error.
+     *  \details The class uses the `icpPlaneProducts` kernel to produce, in one pass over
+     *           the sets, the sums for the normal equations of the linearized point-to-plane
+     *           error. It reduces them with the `reduce_sum` kernel, and then solves the
+     *           \f$ 6 \times 6 \f$ system with the `icpPlaneSolve` kernel. Only the incremental
+     *           transformation \f$ (\dot{q}_k,t_k) \f$ leaves the device. For more details,
+     *           look at the kernels' documentation.
+     *  \note The `icpPlaneProducts` and `icpPlaneSolve` kernels are available in
+     *        `kernels/icp_kernels.cl`, and the `reduce_sum` kernel is available in
+     *        `kernels/reduce_kernels.cl`.
+     *  \note The normals of the fixed points are looked up in the normal map of the
+     *        fixed frame (`ICPNormals`), by projecting the points with the camera
+     *        parameters. So, the fixed set needs to be sampled from that frame.
+     *  \note The `D_PIVOT` buffer holds the point about which the rotation is linearized,
+     *        and gets overwritten with the transformed mean of the moving set on every run.
+     *        It is zeroed in `init`.
+     *  \note The class creates its own buffers. If you would like to provide
+     *        your own buffers, call `get` to get references to the placeholders
+     *        within the class and assign them to your buffers. You will have to
+     *        do this strictly before the call to `init`. You can also call `get`
+     *        (after the call to `init`) to get a reference to a buffer within
+     *        the class and assign it to another kernel class instance further
+     *        down in your task pipeline.
+     *
+     *        The following input/output `OpenCL` memory objects are created by a `ICPPlane` instance:<br>
+     *        |   Name    | Type | Placement | I/O | Use | Properties | Size |
+     *        |   ---     |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_OUT_T_K | Buffer | Host   | O | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_F    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_M    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_N    | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$w*h*sizeof\ (cl\_float4)\f$ |
+     *        | D_OUT_T_K | Buffer | Device | O | Processing  | CL_MEM_WRITE_ONLY | \f$2*sizeof\ (cl\_float4)\f$ |
+     */
+    class ICPPlane
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_OUT_T_K,  /*!< Output staging buffer for the parameters that represent the incremental
+                         *   development in the transformation estimation. It has the same layout
+                         *   as the output of `ICPSVD`, with a scale of `1`. */
+            D_IN_F,     /*!< Input buffer for the fixed set. */
+            D_IN_M,     /*!< Input buffer for the moving set. */
+            D_IN_N,     /*!< Input buffer for the normal map of the fixed frame. */
+            D_SUMS_P,   /*!< Buffer for the partial sums. */
+            D_SUMS,     /*!< Buffer for the reduced sums. */
+            D_PIVOT,    /*!< Buffer for the pivot of the linearization. */
+            D_OUT_T_K   /*!< Output buffer for the parameters that represent the incremental
+                         *   development in the transformation estimation. It has the same layout
+                         *   as the output of `ICPSVD`, with a scale of `1`. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPPlane (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPPlane::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, unsigned int _width, unsigned int _height,
+                   float _c, Staging _staging = Staging::O);
+        /*! \brief Updates kernel execution parameters, without reallocating memory. */
+        void resize (unsigned int _m);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPPlane::Memory mem = ICPPlane::Memory::H_OUT_T_K, bool block = CL_TRUE,
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Updates the camera parameters of the fixed frame. */
+        void setIntrinsics (float _fx, float _fy, float _cx, float _cy);
+        /*! \brief Gets the scaling factor c. */
+        float getScaling ();
+        /*! \brief Sets the scaling factor c. */
+        void setScaling (float _c);
+
+        cl_float *hPtrOutTk;  /*!< Mapping of the output staging buffer for the incremental parameters. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel, solveKernel;
+        cl::NDRange global;
+        Reduce<ReduceConfig::SUM, cl_float> reduceSums;
+        Staging staging;
+        float c;
+        cl_float4 intrinsics;
+        unsigned int m, mMax, width, height;
+        unsigned int bufferInFMSize, bufferInNSize, bufferSumsPSize, bufferSumsSize, bufferTkSize;
+        cl::Buffer hBufferOutTk;
+        cl::Buffer dBufferInF, dBufferInM, dBufferInN;
+        cl::Buffer dBufferSumsP, dBufferSums, dBufferPivot, dBufferOutTk;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            double pTime;
+
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime = timer.duration ();
+
+            pTime += reduceSums.run (timer);
+
+            queue.enqueueTask (solveKernel, nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            return pTime;
+        }
+
+    };
+
+
+    /*! \brief Interface class for the `icpUpdateTransform` kernel.
+     *  \details The `icpUpdateTransform` kernel composes the incremental development 
+     *           in the transformation estimation with the current estimation, and 
+     *           checks for convergence. It allows the %ICP iterations to proceed 
+     *           on the device without any intervention from the host.
+     *           For more details, look at the kernel's documentation.
+     *  \note The `icpUpdateTransform` kernel is available in `kernels/icp_kernels.cl`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created by a 
+     *        `ICPUpdateTransform` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_T_K | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_IO_T   | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | H_IO_C   | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_uint)\f$   |
+     *        | D_IN_T_K | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IO_T   | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IO_C   | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_uint)\f$   |
+     */
+    class ICPUpdateTransform
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_T_K,  /*!< Input staging buffer for the parameters that represent the incremental 
+                        *   development in the transformation estimation. The first `float4` 
+                        *   is the **unit quaternion** \f$ \dot{q_k} \f$, and the second one is 
+                        *   the **translation vector** \f$ t_k = \left[ \begin{matrix} t_x & t_y 
+                        *   & t_z & s_k \end{matrix} \right]^T \f$. */
+            H_IO_T,    /*!< Input-output staging buffer for the quaternion and the translation vector. 
+                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
+                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                        *   and the second `cl_float4` element contains the translation vector, 
+                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & s \end{matrix} \right]^T \f$. */
+            H_IO_C,    /*!< Input-output staging buffer for the convergence state. The first `cl_uint` 
+                        *   is the convergence flag, and the second one is the number of iterations. */
+            D_IN_T_K,  /*!< Input buffer for the parameters that represent the incremental 
+                        *   development in the transformation estimation. The first `float4` 
+                        *   is the **unit quaternion** \f$ \dot{q_k} \f$, and the second one is 
+                        *   the **translation vector** \f$ t_k = \left[ \begin{matrix} t_x & t_y 
+                        *   & t_z & s_k \end{matrix} \right]^T \f$. */
+            D_IO_T,    /*!< Input-output buffer for the quaternion and the translation vector. 
+                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
+                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                        *   and the second `cl_float4` element contains the translation vector, 
+                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & s \end{matrix} \right]^T \f$. */
+            D_IO_C     /*!< Input-output buffer for the convergence state. The first `cl_uint` 
+                        *   is the convergence flag, and the second one is the number of iterations. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPUpdateTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPUpdateTransform::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (float _angle_threshold = 0.001f, float _translation_threshold = 0.01f, 
+                   Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPUpdateTransform::Memory mem = ICPUpdateTransform::Memory::D_IO_C, 
+                    void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPUpdateTransform::Memory mem = ICPUpdateTransform::Memory::H_IO_C, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Gets the threshold for the change in angle. */
+        float getAngleThreshold ();
+        /*! \brief Sets the threshold for the change in angle. */
+        void setAngleThreshold (float _angle_threshold);
+        /*! \brief Gets the threshold for the change in translation. */
+        float getTranslationThreshold ();
+        /*! \brief Sets the threshold for the change in translation. */
+        void setTranslationThreshold (float _translation_threshold);
+
+        cl_float *hPtrInTk;  /*!< Mapping of the input staging buffer for the incremental parameters. */
+        cl_float *hPtrIOT;   /*!< Mapping of the input-output staging buffer for the transformation. */
+        cl_uint *hPtrIOC;    /*!< Mapping of the input-output staging buffer for the convergence state. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> info;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        Staging staging;
+        float angle_threshold, translation_threshold;
+        unsigned int bufferTSize, bufferCSize;
+        cl::Buffer hBufferInTk, hBufferIOT, hBufferIOC;
+        cl::Buffer dBufferInTk, dBufferIOT, dBufferIOC;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, const std::vector<cl::Event> *events = nullptr)
+        {
+            queue.enqueueTask (kernel, events, &timer.event ());
+            queue.flush (); timer.wait ();
+
+            return timer.duration ();
+        }
+
+    };
+
+
+    /*! \brief Enumerates configurations for the `ICPStep` class.
+     *  \details All computation is done on the `GPU`. The only point of divergence 
+     *           in the `%ICP` data flow is the rotation computation.
+     */
+    enum class ICPStepConfigT : uint8_t
+    { 
+        EIGEN, /*!< [**CPU**] Identifies the case where the **JacobiSVD** in **Eigen3** 
+                *   is used to compute the singular value decomposition of matrix \f$S\f$. 
+                *   Given \f$ S=USV^T \f$, the rotation matrix is then built as \f$R=VU^T\f$. */
+        POWER_METHOD,  /*!< [**GPU**] Identifies the case where the **Power Method** is used to 
+                        *   find the unit quaternion \f$\dot{q}\f$ that describes the rotation.
+                        *   It computes the eigenvector \f$\mathcal{v}=\dot{q}\f$ that corresponds 
+                        *   to the maximum eigenvalue of matrix \f$N\f$. */
+        JACOBI,  /*!< \todo [**GPU**] Identifies the case where one of the **Jacobi methods** 
+                  *         is used to compute the unit quaternion \f$\dot{q}\f$ that describes 
+                  *         the rotation. */
+        POINT_TO_PLANE  /*!< [**GPU**] Identifies the case where the point-to-plane error is 
+                         *   minimized. The error is linearized for a small rotation, and the 
+                         *   resulting \f$ 6 \times 6 \f$ system is solved on the device 
+                         *   for the whole incremental transformation (`ICPPlane`). */
+    };
+
+
+    /*! \brief Enumerates configurations for the `ICPStep` class. */
+    enum class ICPStepConfigW : uint8_t
+    { 
+        REGULAR,  /*!< Identifies the case of regular sum of errors. */
+        WEIGHTED  /*!< Identifies the case of weighted sum of errors. */
+    };
+
+
+    /*! \brief Interface class for the `%ICP` pipeline.
+     *  \details Performs one `%ICP` iteration. It accepts two sets (fixed and moving) of 
+     *           landmarks, estimates the relative homogeneous transformation \f$ T_k \f$ 
+     *           between them, and transforms the moving set according to this transformation.
+     *  \note The implemented algorithms are described by `Horn` in 
+     *        [Closed-Form Solution of Absolute Orientation Using Unit Quaternions][1] and 
+     *        by `Arun` et al. in [Least-Squares Fitting of Two 3-D Point Sets][2].
+     *        [1]: http://people.csail.mit.edu/bkph/papers/Absolute_Orientation.pdf
+     *        [2]: http://bmi214.stanford.edu/bmiarc/bmi214-2008/articles/arun.pdf
+     *  \note This is just a declaration. Look at the explicit template specializations
+     *        for specific instantiations of the class.
+     *        
+     *  \tparam CR configures the class with different methods of rotation computation.
+     *  \tparam CW configures the class for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPStep;
+
+
+    /*! \brief Interface class for the `%ICP` pipeline using the Eigen library 
+     *         to estimate the rotation and considering regular residual errors.
+     *  \details Performs one `%ICP` iteration. It accepts two sets (fixed and moving) 
+     *           of landmarks, estimates the relative homogeneous transformation 
+     *           \f$ (\dot{q}_k,t_k) \f$ between them, and transforms the moving set 
+     *           according to this transformation.
+     *  \note All computation is done on the `GPU`, except from the rotation 
+     *        computation which is solved on the `CPU` with `Eigen::JacobiSVD`.
+     *        If `setDeviceSolve` is set, the rotation is solved on the `GPU` 
+     *        by `ICPSVD` instead, and only \f$ (\dot{q}_k,t_k,s_k) \f$ is read back.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created 
+     *        by an `ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_F | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | H_IO_T | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IO_T | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$ |
+     */
+    template <>
+    class ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_F,    /*!< Input staging buffer for the fixed set of landmarks. */
+            H_IN_M,    /*!< Input staging buffer for the moving set of landmarks. */
+            H_IO_T,    /*!< Input-output staging buffer for the quaternion and the translation vector. 
+                        *   It is loaded with an initial estimation of the transformation 
+                        *   and gets refined with every %ICP iteration.
+                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
+                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                        *   and the second `cl_float4` element contains the translation vector, 
+                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. 
+                        *   If scaling is desired, the factor should be placed in the last element 
+                        *   of the translation vector, \f$ t = \left[ \begin{matrix} t_x & t_y 
+                        *   & t_z & s \end{matrix} \right]^T \f$. */
+            D_IN_F,    /*!< Input buffer for the fixed set of landmarks. */
+            D_IN_M,    /*!< Input buffer for the moving set of landmarks. */
+            D_IO_T,    /*!< Input-output buffer for the quaternion and the translation vector. 
+                        *   It is loaded with an initial estimation of the transformation 
+                        *   and gets refined with every %ICP iteration.
                         *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
                         *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
                         *   and the second `cl_float4` element contains the translation vector, 
@@ -1647,12 +3007,15 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP);
+        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                 StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPStep::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, unsigned int _nr, 
             float _a = 1e2f, float _c = 1e-6f, Staging _staging = Staging::IO);
+        /*! \brief Reconfigures the pipeline for fewer points, without reallocating memory. */
+        void resize (unsigned int _m, unsigned int _nr);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPStep::Memory mem = ICPStep::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -1662,7 +3025,8 @@ namespace ICP
         /*! \brief Builds the RBC data structure. */
         void buildRBC (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
-        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, bool config = false);
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, 
+                  bool config = false, bool reuse = false);
         /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in 
          *         the distance calculations of the `RBC` data structure. */
         float getAlpha ();
@@ -1673,6 +3037,14 @@ namespace ICP
         float getScaling ();
         /*! \brief Sets the scaling factor c used when computing the `S` matrix. */
         void setScaling (float _c);
+        /*! \brief Gets the flag for solving for the incremental transformation on the device. */
+        bool getDeviceSolve ();
+        /*! \brief Sets the flag for solving for the incremental transformation on the device. */
+        void setDeviceSolve (bool _deviceSolve);
+        /*! \brief Gets the attached timing trace. */
+        ICPTrace* getTrace ();
+        /*! \brief Attaches a timing trace. */
+        void setTrace (ICPTrace *_trace);
 
         cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
         cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
@@ -1702,29 +3074,35 @@ namespace ICP
     protected:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         Staging staging;
+        ICPTrace *trace;
         ICPReps fReps;
         RBC::RBCConstruct
             <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC> rbcC;
         ICPTransform<ICPTransformConfig::QUATERNION> transform;
+        ICPTransform<ICPTransformConfig::QUATERNION> retransform;
         RBC::RBCSearch
             <RBC::KernelTypeC::KINECT_R, 
                 RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT> rbcS;
         ICPMean<ICPMeanConfig::REGULAR> means;
         ICPDevs devs;
         ICPS<ICPSConfig::REGULAR> matrixS;
+        ICPSVD procrustes;
+        bool deviceSolve;
 
-        cl_float *mean, *Sij;
+        cl_float *mean, *Sij, *Tk, *hPtrTk;
         Eigen::Vector3f mf, mm;
         Eigen::Matrix3f S;
 
         float a, c;
-        unsigned int m, nr, d;
+        unsigned int m, mMax, nr, nrMax, d;
         unsigned int bufferFMSize, bufferTSize;
-        cl::Buffer hBufferInF, hBufferInM, hBufferIOT;
-        cl::Buffer dBufferInF, dBufferInM, dBufferIOT;
+        cl::Buffer hBufferInF, hBufferInM, hBufferIOT, hBufferTk;
+        cl::Buffer dBufferInF, dBufferInM, dBufferIOT, dBufferTk;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -1748,30 +3126,44 @@ namespace ICP
             pTime += means.run (timer);
             pTime += devs.run (timer);
             pTime += matrixS.run (timer);
+            if (deviceSolve)
+                pTime += procrustes.run (timer);
 
             cTimer.start ();
 
-            mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::REGULAR>::Memory::H_OUT, CL_FALSE);
-            Sij = (cl_float *) matrixS.read (ICPS<ICPSConfig::REGULAR>::Memory::H_OUT);
-            sk = std::sqrt (Sij[9] / Sij[10]);
-
-            mf = Eigen::Map<Eigen::Vector3f> (mean);
-            mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
-            S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
-            
-            Eigen::JacobiSVD<Eigen::MatrixXf, Eigen::NoQRPreconditioner> 
-                svd (S, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            if (deviceSolve)
+            {
+                Tk = (cl_float *) procrustes.read (ICPSVD::Memory::H_OUT_T_K);
 
-            Rk = svd.matrixV () * svd.matrixU ().transpose ();
-            if (Rk.determinant () < 0)
+                qk = Eigen::Quaternionf (Tk);
+                Rk = Eigen::Matrix3f (qk);
+                tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+                sk = Tk[7];
+            }
+            else
             {
-                Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
-                B (2, 2) = Rk.determinant ();
-                Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+                mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::REGULAR>::Memory::H_OUT, CL_FALSE);
+                Sij = (cl_float *) matrixS.read (ICPS<ICPSConfig::REGULAR>::Memory::H_OUT);
+                sk = std::sqrt (Sij[9] / Sij[10]);
+
+                mf = Eigen::Map<Eigen::Vector3f> (mean);
+                mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
+                S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
+
+                Eigen::JacobiSVD<Eigen::Matrix3f, Eigen::NoQRPreconditioner> 
+                    svd (S, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+                Rk = svd.matrixV () * svd.matrixU ().transpose ();
+                if (Rk.determinant () < 0)
+                {
+                    Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
+                    B (2, 2) = Rk.determinant ();
+                    Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+                }
+                qk = Eigen::Quaternionf (Rk);
+
+                tk = mf - sk * Rk * mm;
             }
-            qk = Eigen::Quaternionf (Rk);
-
-            tk = mf - sk * Rk * mm;
 
             R = Rk * R;
             q = Eigen::Quaternionf (R);
@@ -1802,6 +3194,8 @@ namespace ICP
      *           according to this transformation.
      *  \note All computation is done on the `GPU`, except from the rotation 
      *        computation which is solved on the `CPU` with `Eigen::JacobiSVD`.
+     *        If `setDeviceSolve` is set, the rotation is solved on the `GPU` 
+     *        by `ICPSVD` instead, and only \f$ (\dot{q}_k,t_k,s_k) \f$ is read back.
      *  \note The class creates its own buffers. If you would like to provide 
      *        your own buffers, call `get` to get references to the placeholders 
      *        within the class and assign them to your buffers. You will have to 
@@ -1858,12 +3252,15 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP);
+        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                 StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPStep::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, unsigned int _nr, 
             float _a = 1e2f, float _c = 1e-6f, Staging _staging = Staging::IO);
+        /*! \brief Reconfigures the pipeline for fewer points, without reallocating memory. */
+        void resize (unsigned int _m, unsigned int _nr);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPStep::Memory mem = ICPStep::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -1873,7 +3270,8 @@ namespace ICP
         /*! \brief Builds the RBC data structure. */
         void buildRBC (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
-        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, bool config = false);
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, 
+                  bool config = false, bool reuse = false);
         /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in 
          *         the distance calculations of the `RBC` data structure. */
         float getAlpha ();
@@ -1884,6 +3282,18 @@ namespace ICP
         float getScaling ();
         /*! \brief Sets the scaling factor c used when computing the `S` matrix. */
         void setScaling (float _c);
+        /*! \brief Gets the flag for the fused computation of the means and the `S` matrix. */
+        bool getFusion ();
+        /*! \brief Sets the flag for the fused computation of the means and the `S` matrix. */
+        void setFusion (bool _fused);
+        /*! \brief Gets the flag for solving for the incremental transformation on the device. */
+        bool getDeviceSolve ();
+        /*! \brief Sets the flag for solving for the incremental transformation on the device. */
+        void setDeviceSolve (bool _deviceSolve);
+        /*! \brief Gets the attached timing trace. */
+        ICPTrace* getTrace ();
+        /*! \brief Attaches a timing trace. */
+        void setTrace (ICPTrace *_trace);
 
         cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
         cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
@@ -1913,13 +3323,17 @@ namespace ICP
     protected:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         Staging staging;
+        ICPTrace *trace;
         ICPReps fReps;
         RBC::RBCConstruct
             <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC> rbcC;
         ICPTransform<ICPTransformConfig::QUATERNION> transform;
+        ICPTransform<ICPTransformConfig::QUATERNION> retransform;
         RBC::RBCSearch
             <RBC::KernelTypeC::KINECT_R, 
                 RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT> rbcS;
@@ -1927,16 +3341,20 @@ namespace ICP
         ICPMean<ICPMeanConfig::WEIGHTED> means;
         ICPDevs devs;
         ICPS<ICPSConfig::WEIGHTED> matrixS;
+        ICPS<ICPSConfig::FUSED> matrixF;
+        bool fused;
+        ICPSVD procrustes;
+        bool deviceSolve;
 
-        cl_float *mean, *Sij;
+        cl_float *mean, *Sij, *Tk, *hPtrTk;
         Eigen::Vector3f mf, mm;
         Eigen::Matrix3f S;
 
         float a, c;
-        unsigned int m, nr, d;
+        unsigned int m, mMax, nr, nrMax, d;
         unsigned int bufferFMSize, bufferTSize;
-        cl::Buffer hBufferInF, hBufferInM, hBufferIOT;
-        cl::Buffer dBufferInF, dBufferInM, dBufferIOT;
+        cl::Buffer hBufferInF, hBufferInM, hBufferIOT, hBufferTk;
+        cl::Buffer dBufferInF, dBufferInM, dBufferIOT, dBufferTk;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -1958,33 +3376,52 @@ namespace ICP
             pTime += transform.run (timer, events);
             pTime += rbcS.run (timer, nullptr, config);
             pTime += weights.run (timer);
-            pTime += means.run (timer);
-            pTime += devs.run (timer);
-            pTime += matrixS.run (timer);
+            if (fused)
+                pTime += matrixF.run (timer);
+            else
+            {
+                pTime += means.run (timer);
+                pTime += devs.run (timer);
+                pTime += matrixS.run (timer);
+            }
+            if (deviceSolve)
+                pTime += procrustes.run (timer);
 
             cTimer.start ();
 
-            mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::WEIGHTED>::Memory::H_OUT, CL_FALSE);
-            Sij = (cl_float *) matrixS.read (ICPS<ICPSConfig::WEIGHTED>::Memory::H_OUT);
-            sk = std::sqrt (Sij[9] / Sij[10]);
-
-            mf = Eigen::Map<Eigen::Vector3f> (mean);
-            mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
-            S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
-            
-            Eigen::JacobiSVD<Eigen::MatrixXf, Eigen::NoQRPreconditioner> 
-                svd (S, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            if (deviceSolve)
+            {
+                Tk = (cl_float *) procrustes.read (ICPSVD::Memory::H_OUT_T_K);
 
-            Rk = svd.matrixV () * svd.matrixU ().transpose ();
-            if (Rk.determinant () < 0)
+                qk = Eigen::Quaternionf (Tk);
+                Rk = Eigen::Matrix3f (qk);
+                tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+                sk = Tk[7];
+            }
+            else
             {
-                Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
-                B (2, 2) = Rk.determinant ();
-                Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+                mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::WEIGHTED>::Memory::H_OUT, CL_FALSE);
+                Sij = (cl_float *) matrixS.read (ICPS<ICPSConfig::WEIGHTED>::Memory::H_OUT);
+                sk = std::sqrt (Sij[9] / Sij[10]);
+
+                mf = Eigen::Map<Eigen::Vector3f> (mean);
+                mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
+                S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
+
+                Eigen::JacobiSVD<Eigen::Matrix3f, Eigen::NoQRPreconditioner> 
+                    svd (S, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+                Rk = svd.matrixV () * svd.matrixU ().transpose ();
+                if (Rk.determinant () < 0)
+                {
+                    Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
+                    B (2, 2) = Rk.determinant ();
+                    Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+                }
+                qk = Eigen::Quaternionf (Rk);
+
+                tk = mf - sk * Rk * mm;
             }
-            qk = Eigen::Quaternionf (Rk);
-
-            tk = mf - sk * Rk * mm;
 
             R = Rk * R;
             q = Eigen::Quaternionf (R);
@@ -2071,12 +3508,15 @@ namespace ICP
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP);
+        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                 StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPStep::Memory mem);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, unsigned int _nr, 
             float _a = 1e2f, float _c = 1e-6f, Staging _staging = Staging::IO);
+        /*! \brief Reconfigures the pipeline for fewer points, without reallocating memory. */
+        void resize (unsigned int _m, unsigned int _nr);
         /*! \brief Performs a data transfer to a device buffer. */
         void write (ICPStep::Memory mem = ICPStep::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
@@ -2086,7 +3526,12 @@ namespace ICP
         /*! \brief Builds the RBC data structure. */
         void buildRBC (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
-        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, bool config = false);
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, 
+                  bool config = false, bool reuse = false);
+        /*! \brief Executes a batch of iterations, with the transformation update 
+         *         and the convergence check performed on the device. */
+        void runBatch (unsigned int iterations, const std::vector<cl::Event> *events = nullptr, 
+                       cl::Event *event = nullptr, bool config = false, bool reuse = false);
         /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in 
          *         the distance calculations of the `RBC` data structure. */
         float getAlpha ();
@@ -2097,6 +3542,24 @@ namespace ICP
         float getScaling ();
         /*! \brief Sets the scaling factor c used when computing the `S` matrix. */
         void setScaling (float _c);
+        /*! \brief Gets the attached timing trace. */
+        ICPTrace* getTrace ();
+        /*! \brief Attaches a timing trace. */
+        void setTrace (ICPTrace *_trace);
+        /*! \brief Gets the convergence tolerance of the Power Method. */
+        float getPowerTolerance ();
+        /*! \brief Sets the convergence tolerance of the Power Method. */
+        void setPowerTolerance (float _tolerance);
+        /*! \brief Gets the maximum number of Power Method iterations. */
+        unsigned int getPowerMaxIterations ();
+        /*! \brief Sets the maximum number of Power Method iterations. */
+        void setPowerMaxIterations (unsigned int _max_iterations);
+        /*! \brief Gets the flag for warm starting the Power Method. */
+        bool getPowerWarmStart ();
+        /*! \brief Sets the flag for warm starting the Power Method. */
+        void setPowerWarmStart (bool _warm_start);
+        /*! \brief Gets the number of Power Method iterations of the last %ICP iteration. */
+        unsigned int getPowerIterations ();
 
         cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
         cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
@@ -2126,13 +3589,17 @@ namespace ICP
     protected:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         Staging staging;
+        ICPTrace *trace;
         ICPReps fReps;
         RBC::RBCConstruct
             <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC> rbcC;
         ICPTransform<ICPTransformConfig::QUATERNION> transform;
+        ICPTransform<ICPTransformConfig::QUATERNION> retransform;
         RBC::RBCSearch
             <RBC::KernelTypeC::KINECT_R, 
                 RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT> rbcS;
@@ -2140,14 +3607,15 @@ namespace ICP
         ICPDevs devs;
         ICPS<ICPSConfig::REGULAR> matrixS;
         ICPPowerMethod powMethod;
+        ICPUpdateTransform update;
 
         cl_float *Tk;
 
         float a, c;
-        unsigned int m, nr, d;
+        unsigned int m, mMax, nr, nrMax, d;
         unsigned int bufferFMSize, bufferTSize;
         cl::Buffer hBufferInF, hBufferInM, hBufferIOT;
-        cl::Buffer dBufferInF, dBufferInM, dBufferIOT;
+        cl::Buffer dBufferInF, dBufferInM, dBufferIOT, dBufferTk;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -2257,107 +3725,366 @@ namespace ICP
             D_IO_T,    /*!< Input-output buffer for the quaternion and the translation vector. 
                         *   It is loaded with an initial estimation of the transformation 
                         *   and gets refined with every %ICP iteration.
-                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
-                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
-                        *   and the second `cl_float4` element contains the translation vector, 
-                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. 
-                        *   If scaling is desired, the factor should be placed in the last element 
-                        *   of the translation vector, \f$ t = \left[ \begin{matrix} t_x & t_y 
-                        *   & t_z & s \end{matrix} \right]^T \f$. */
+                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} = 
+                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+                        *   and the second `cl_float4` element contains the translation vector, 
+                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. 
+                        *   If scaling is desired, the factor should be placed in the last element 
+                        *   of the translation vector, \f$ t = \left[ \begin{matrix} t_x & t_y 
+                        *   & t_z & s \end{matrix} \right]^T \f$. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                 StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPStep::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, unsigned int _nr, 
+            float _a = 1e2f, float _c = 1e-6f, Staging _staging = Staging::IO);
+        /*! \brief Reconfigures the pipeline for fewer points, without reallocating memory. */
+        void resize (unsigned int _m, unsigned int _nr);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPStep::Memory mem = ICPStep::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPStep::Memory mem = ICPStep::Memory::H_IO_T, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Builds the RBC data structure. */
+        void buildRBC (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, 
+                  bool config = false, bool reuse = false);
+        /*! \brief Executes a batch of iterations, with the transformation update 
+         *         and the convergence check performed on the device. */
+        void runBatch (unsigned int iterations, const std::vector<cl::Event> *events = nullptr, 
+                       cl::Event *event = nullptr, bool config = false, bool reuse = false);
+        /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in 
+         *         the distance calculations of the `RBC` data structure. */
+        float getAlpha ();
+        /*! \brief Sets the scaling parameter \f$ \alpha \f$ involved in 
+         *         the distance calculations of the `RBC` data structure. */
+        void setAlpha (float _a);
+        /*! \brief Gets the scaling factor c used when computing the `S` matrix. */
+        float getScaling ();
+        /*! \brief Sets the scaling factor c used when computing the `S` matrix. */
+        void setScaling (float _c);
+        /*! \brief Gets the flag for the fused computation of the means and the `S` matrix. */
+        bool getFusion ();
+        /*! \brief Sets the flag for the fused computation of the means and the `S` matrix. */
+        void setFusion (bool _fused);
+        /*! \brief Gets the attached timing trace. */
+        ICPTrace* getTrace ();
+        /*! \brief Attaches a timing trace. */
+        void setTrace (ICPTrace *_trace);
+        /*! \brief Gets the convergence tolerance of the Power Method. */
+        float getPowerTolerance ();
+        /*! \brief Sets the convergence tolerance of the Power Method. */
+        void setPowerTolerance (float _tolerance);
+        /*! \brief Gets the maximum number of Power Method iterations. */
+        unsigned int getPowerMaxIterations ();
+        /*! \brief Sets the maximum number of Power Method iterations. */
+        void setPowerMaxIterations (unsigned int _max_iterations);
+        /*! \brief Gets the flag for warm starting the Power Method. */
+        bool getPowerWarmStart ();
+        /*! \brief Sets the flag for warm starting the Power Method. */
+        void setPowerWarmStart (bool _warm_start);
+        /*! \brief Gets the number of Power Method iterations of the last %ICP iteration. */
+        unsigned int getPowerIterations ();
+
+        cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
+        cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
+        cl_float *hPtrIOT;  /*!< Mapping of the input-output staging buffer for the estimated 
+                             *   quaternion and translation vector. */
+        
+        Eigen::Matrix3f Rk;     /*!< Represents the incremental development in the rotation estimation in 
+                                 *   iteration `k`, given in rotation matrix representation, \f$ R_k \f$. */
+        Eigen::Quaternionf qk;  /*!< Represents the incremental development in the rotation estimation in 
+                                 *   iteration `k`, given in quaternion representation, \f$ \dot{q}_k = \left[ 
+                                 *   \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$. */
+        Eigen::Vector3f tk;     /*!< Represents the incremental development in the translation estimation 
+                                 *   in iteration `k`, given as a vector in 3-D, \f$ t_k \f$. */
+        cl_float sk;            /*!< Represents the incremental development in the scale estimation 
+                                 *   in iteration `k`, given as a scalar, \f$ s_k \f$. */
+
+        Eigen::Matrix3f R;     /*!< Represents the rotation estimation up to iteration `k`, 
+                                *   given in rotation matrix representation, \f$ R \f$. */
+        Eigen::Quaternionf q;  /*!< Represents the rotation estimation up to iteration `k`, 
+                                *   given in quaternion representation, \f$ \dot{q} = \left[ 
+                                *   \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$. */
+        Eigen::Vector3f t;     /*!< Represents the translation estimation up to iteration `k`, 
+                                *   given as a vector in 3-D, \f$ t \f$. */
+        cl_float s;            /*!< Represents the scale estimation up to iteration `k`,
+                                *   given as a scalar, \f$ s \f$. */
+
+    protected:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        Staging staging;
+        ICPTrace *trace;
+        ICPReps fReps;
+        RBC::RBCConstruct
+            <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC> rbcC;
+        ICPTransform<ICPTransformConfig::QUATERNION> transform;
+        ICPTransform<ICPTransformConfig::QUATERNION> retransform;
+        RBC::RBCSearch
+            <RBC::KernelTypeC::KINECT_R, 
+                RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT> rbcS;
+        ICPWeights weights;
+        ICPMean<ICPMeanConfig::WEIGHTED> means;
+        ICPDevs devs;
+        ICPS<ICPSConfig::WEIGHTED> matrixS;
+        ICPS<ICPSConfig::FUSED> matrixF;
+        bool fused;
+        ICPPowerMethod powMethod;
+        ICPUpdateTransform update;
+
+        cl_float *Tk;
+
+        float a, c;
+        unsigned int m, mMax, nr, nrMax, d;
+        unsigned int bufferFMSize, bufferTSize;
+        cl::Buffer hBufferInF, hBufferInM, hBufferIOT;
+        cl::Buffer dBufferInF, dBufferInM, dBufferIOT, dBufferTk;
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] events a wait-list of events.
+         *  \param[in] config flag. If true, configures the `RBC search` process. 
+         *                    Set to true once, when the `RBC` data structure is reset.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, 
+            const std::vector<cl::Event> *events = nullptr, bool config = false)
+        {
+            clutils::CPUTimer<double, std::milli> cTimer;
+            double pTime = 0.0;
+
+            pTime += transform.run (timer, events);
+            pTime += rbcS.run (timer, nullptr, config);
+            pTime += weights.run (timer);
+            if (fused)
+                pTime += matrixF.run (timer);
+            else
+            {
+                pTime += means.run (timer);
+                pTime += devs.run (timer);
+                pTime += matrixS.run (timer);
+            }
+            pTime += powMethod.run (timer);
+            
+            cTimer.start ();
+
+            Tk = (cl_float *) powMethod.read (ICPPowerMethod::Memory::H_OUT_T_K);
+
+            qk = Eigen::Quaternionf (Tk);
+            Rk = Eigen::Matrix3f (qk);
+            tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+            sk = Tk[7];
+
+            R = Rk * R;
+            q = Eigen::Quaternionf (R);
+            t = sk * Rk * t + tk;
+            s = sk * s;
+            
+            Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+            Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+            hPtrIOT[7] = s;  // Scale
+
+            pTime += cTimer.stop ();
+
+            queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            return pTime;
+        }
+
+    };
+
+
+    /*! \brief Interface class for the `%ICP` pipeline minimizing
+     *         the point-to-plane error and considering regular residual errors.
+     *  \details Performs one `%ICP` iteration. It accepts two sets (fixed and moving)
+     *           of landmarks and the normal map of the fixed frame, estimates the
+     *           relative homogeneous transformation \f$ (\dot{q}_k,t_k) \f$ between
+     *           them, and transforms the moving set according to this transformation.
+     *  \note The error is linearized for a small rotation, as described by `Low` in
+     *        [Linear Least-Squares Optimization for Point-to-Plane ICP Surface Registration][1].
+     *        The normal equations are reduced and solved on the `GPU` by `ICPPlane`,
+     *        and only the incremental transformation is read back. The scale is fixed at `1`.
+     *        [1]: https://www.comp.nus.edu.sg/~lowkl/publications/lowk_point-to-plane_icp_techrep.pdf
+     *  \note The normals of the fixed points are looked up in the normal map (`ICPNormals`)
+     *        at the pixels the points project to. So, the fixed set has to be sampled from
+     *        the frame of the normal map, and the camera parameters have to be set with
+     *        `setIntrinsics`. Fixed points without a valid normal are ignored.
+     *  \note The class creates its own buffers. If you would like to provide
+     *        your own buffers, call `get` to get references to the placeholders
+     *        within the class and assign them to your buffers. You will have to
+     *        do this strictly before the call to `init`. You can also call `get`
+     *        (after the call to `init`) to get a reference to a buffer within
+     *        the class and assign it to another kernel class instance further
+     *        down in your task pipeline.
+     *
+     *        The following input/output `OpenCL` memory objects are created
+     *        by an `ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_F | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$   |
+     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$   |
+     *        | H_IN_N | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$w*h*sizeof\ (cl\_float4)\f$ |
+     *        | H_IO_T | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$   |
+     *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$   |
+     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$m*sizeof\ (cl\_float8)\f$   |
+     *        | D_IN_N | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$w*h*sizeof\ (cl\_float4)\f$ |
+     *        | D_IO_T | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$   |
+     */
+    template <>
+    class ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_F,    /*!< Input staging buffer for the fixed set of landmarks. */
+            H_IN_M,    /*!< Input staging buffer for the moving set of landmarks. */
+            H_IN_N,    /*!< Input staging buffer for the normal map of the fixed frame. */
+            H_IO_T,    /*!< Input-output staging buffer for the quaternion and the translation vector.
+                        *   It is loaded with an initial estimation of the transformation
+                        *   and gets refined with every %ICP iteration.
+                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} =
+                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$,
+                        *   and the second `cl_float4` element contains the translation vector,
+                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. */
+            D_IN_F,    /*!< Input buffer for the fixed set of landmarks. */
+            D_IN_M,    /*!< Input buffer for the moving set of landmarks. */
+            D_IN_N,    /*!< Input buffer for the normal map of the fixed frame. */
+            D_IO_T,    /*!< Input-output buffer for the quaternion and the translation vector.
+                        *   It is loaded with an initial estimation of the transformation
+                        *   and gets refined with every %ICP iteration.
+                        *   The first `cl_float4` element contains the quaternion, \f$ \dot{q} =
+                        *   \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$,
+                        *   and the second `cl_float4` element contains the translation vector,
+                        *   \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. */
         };
 
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP);
+        ICPStep (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP,
+                 StagingPool *_pool = nullptr);
         /*! \brief Returns a reference to an internal memory object. */
         cl::Memory& get (ICPStep::Memory mem);
         /*! \brief Configures kernel execution parameters. */
-        void init (unsigned int _m, unsigned int _nr, 
+        void init (unsigned int _m, unsigned int _nr,
             float _a = 1e2f, float _c = 1e-6f, Staging _staging = Staging::IO);
+        /*! \brief Reconfigures the pipeline for fewer points, without reallocating memory. */
+        void resize (unsigned int _m, unsigned int _nr);
         /*! \brief Performs a data transfer to a device buffer. */
-        void write (ICPStep::Memory mem = ICPStep::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
+        void write (ICPStep::Memory mem = ICPStep::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE,
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Performs a data transfer to a staging buffer. */
-        void* read (ICPStep::Memory mem = ICPStep::Memory::H_IO_T, bool block = CL_TRUE, 
+        void* read (ICPStep::Memory mem = ICPStep::Memory::H_IO_T, bool block = CL_TRUE,
                     const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Builds the RBC data structure. */
         void buildRBC (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
         /*! \brief Executes the necessary kernels. */
-        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr, bool config = false);
-        /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in 
+        void run (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr,
+                  bool config = false, bool reuse = false);
+        /*! \brief Sets the dimensions of the normal map. */
+        void setFrameSize (unsigned int _width, unsigned int _height);
+        /*! \brief Updates the camera parameters of the fixed frame. */
+        void setIntrinsics (float _fx, float _fy, float _cx, float _cy);
+        /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in
          *         the distance calculations of the `RBC` data structure. */
         float getAlpha ();
-        /*! \brief Sets the scaling parameter \f$ \alpha \f$ involved in 
+        /*! \brief Sets the scaling parameter \f$ \alpha \f$ involved in
          *         the distance calculations of the `RBC` data structure. */
         void setAlpha (float _a);
-        /*! \brief Gets the scaling factor c used when computing the `S` matrix. */
+        /*! \brief Gets the scaling factor c used when computing the normal equations. */
         float getScaling ();
-        /*! \brief Sets the scaling factor c used when computing the `S` matrix. */
+        /*! \brief Sets the scaling factor c used when computing the normal equations. */
         void setScaling (float _c);
+        /*! \brief Gets the attached timing trace. */
+        ICPTrace* getTrace ();
+        /*! \brief Attaches a timing trace. */
+        void setTrace (ICPTrace *_trace);
 
         cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
         cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
-        cl_float *hPtrIOT;  /*!< Mapping of the input-output staging buffer for the estimated 
+        cl_float *hPtrInN;  /*!< Mapping of the input staging buffer for the normal map. */
+        cl_float *hPtrIOT;  /*!< Mapping of the input-output staging buffer for the estimated
                              *   quaternion and translation vector. */
-        
-        Eigen::Matrix3f Rk;     /*!< Represents the incremental development in the rotation estimation in 
+
+        Eigen::Matrix3f Rk;     /*!< Represents the incremental development in the rotation estimation in
                                  *   iteration `k`, given in rotation matrix representation, \f$ R_k \f$. */
-        Eigen::Quaternionf qk;  /*!< Represents the incremental development in the rotation estimation in 
-                                 *   iteration `k`, given in quaternion representation, \f$ \dot{q}_k = \left[ 
+        Eigen::Quaternionf qk;  /*!< Represents the incremental development in the rotation estimation in
+                                 *   iteration `k`, given in quaternion representation, \f$ \dot{q}_k = \left[
                                  *   \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$. */
-        Eigen::Vector3f tk;     /*!< Represents the incremental development in the translation estimation 
+        Eigen::Vector3f tk;     /*!< Represents the incremental development in the translation estimation
                                  *   in iteration `k`, given as a vector in 3-D, \f$ t_k \f$. */
-        cl_float sk;            /*!< Represents the incremental development in the scale estimation 
-                                 *   in iteration `k`, given as a scalar, \f$ s_k \f$. */
+        cl_float sk;            /*!< Represents the incremental development in the scale estimation
+                                 *   in iteration `k`. It is always `1`. */
 
-        Eigen::Matrix3f R;     /*!< Represents the rotation estimation up to iteration `k`, 
+        Eigen::Matrix3f R;     /*!< Represents the rotation estimation up to iteration `k`,
                                 *   given in rotation matrix representation, \f$ R \f$. */
-        Eigen::Quaternionf q;  /*!< Represents the rotation estimation up to iteration `k`, 
-                                *   given in quaternion representation, \f$ \dot{q} = \left[ 
+        Eigen::Quaternionf q;  /*!< Represents the rotation estimation up to iteration `k`,
+                                *   given in quaternion representation, \f$ \dot{q} = \left[
                                 *   \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$. */
-        Eigen::Vector3f t;     /*!< Represents the translation estimation up to iteration `k`, 
+        Eigen::Vector3f t;     /*!< Represents the translation estimation up to iteration `k`,
                                 *   given as a vector in 3-D, \f$ t \f$. */
-        cl_float s;            /*!< Represents the scale estimation up to iteration `k`,
-                                *   given as a scalar, \f$ s \f$. */
+        cl_float s;            /*!< Represents the scale estimation up to iteration `k`. It is always `1`. */
 
     protected:
         clutils::CLEnv &env;
         clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        StagingLease lease;
         cl::Context context;
         cl::CommandQueue queue;
         Staging staging;
+        ICPTrace *trace;
         ICPReps fReps;
         RBC::RBCConstruct
             <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC> rbcC;
         ICPTransform<ICPTransformConfig::QUATERNION> transform;
+        ICPTransform<ICPTransformConfig::QUATERNION> retransform;
         RBC::RBCSearch
-            <RBC::KernelTypeC::KINECT_R, 
+            <RBC::KernelTypeC::KINECT_R,
                 RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT> rbcS;
-        ICPWeights weights;
-        ICPMean<ICPMeanConfig::WEIGHTED> means;
-        ICPDevs devs;
-        ICPS<ICPSConfig::WEIGHTED> matrixS;
-        ICPPowerMethod powMethod;
+        ICPPlane plane;
 
-        cl_float *Tk;
+        cl_float *Tk, *hPtrTk;
 
         float a, c;
-        unsigned int m, nr, d;
-        unsigned int bufferFMSize, bufferTSize;
-        cl::Buffer hBufferInF, hBufferInM, hBufferIOT;
-        cl::Buffer dBufferInF, dBufferInM, dBufferIOT;
+        float fx, fy, cx, cy;
+        unsigned int width, height;
+        unsigned int m, mMax, nr, nrMax, d;
+        unsigned int bufferFMSize, bufferNSize, bufferTSize;
+        cl::Buffer hBufferInF, hBufferInM, hBufferInN, hBufferIOT, hBufferTk;
+        cl::Buffer dBufferInF, dBufferInM, dBufferInN, dBufferIOT, dBufferTk;
 
     public:
         /*! \brief Executes the necessary kernels.
          *  \details This `run` instance is used for profiling.
-         *  
+         *
          *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
          *  \param[in] events a wait-list of events.
-         *  \param[in] config flag. If true, configures the `RBC search` process. 
+         *  \param[in] config flag. If true, configures the `RBC search` process.
          *                    Set to true once, when the `RBC` data structure is reset.
          *  \return Τhe total execution time measured by the timer.
          */
         template <typename period>
-        double run (clutils::GPUTimer<period> &timer, 
+        double run (clutils::GPUTimer<period> &timer,
             const std::vector<cl::Event> *events = nullptr, bool config = false)
         {
             clutils::CPUTimer<double, std::milli> cTimer;
@@ -2365,29 +4092,22 @@ namespace ICP
 
             pTime += transform.run (timer, events);
             pTime += rbcS.run (timer, nullptr, config);
-            pTime += weights.run (timer);
-            pTime += means.run (timer);
-            pTime += devs.run (timer);
-            pTime += matrixS.run (timer);
-            pTime += powMethod.run (timer);
-            
+            pTime += plane.run (timer);
+
             cTimer.start ();
 
-            Tk = (cl_float *) powMethod.read (ICPPowerMethod::Memory::H_OUT_T_K);
+            Tk = (cl_float *) plane.read (ICPPlane::Memory::H_OUT_T_K);
 
             qk = Eigen::Quaternionf (Tk);
             Rk = Eigen::Matrix3f (qk);
             tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
-            sk = Tk[7];
 
             R = Rk * R;
             q = Eigen::Quaternionf (R);
-            t = sk * Rk * t + tk;
-            s = sk * s;
-            
+            t = Rk * t + tk;
+
             Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
             Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
-            hPtrIOT[7] = s;  // Scale
 
             pTime += cTimer.stop ();
 
@@ -2435,7 +4155,8 @@ namespace ICP
     {
     public:
         /*! \brief Configures an OpenCL environment as specified by `_info`. */
-        ICP (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP);
+        ICP (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+             StagingPool *_pool = nullptr);
         /*! \brief Configures kernel execution parameters. */
         void init (unsigned int _m, unsigned int _nr, float _a = 1e2f, float _c = 1e-6f, 
             unsigned int _max_iterations = 40, double _angle_threshold = 0.001,
@@ -2456,6 +4177,18 @@ namespace ICP
         double getTranslationThreshold ();
         /*! \brief Sets the threshold for the change in translation. */
         void setTranslationThreshold (double _translation_threshold);
+        /*! \brief Gets the number of iterations enqueued between convergence checks. */
+        unsigned int getBatchSize ();
+        /*! \brief Sets the number of iterations enqueued between convergence checks. */
+        void setBatchSize (unsigned int _batch_size);
+        /*! \brief Gets the bound on the change in angle for reusing the correspondences. */
+        double getReuseAngleThreshold ();
+        /*! \brief Sets the bound on the change in angle for reusing the correspondences. */
+        void setReuseAngleThreshold (double _reuse_angle_threshold);
+        /*! \brief Gets the bound on the change in translation for reusing the correspondences. */
+        double getReuseTranslationThreshold ();
+        /*! \brief Sets the bound on the change in translation for reusing the correspondences. */
+        void setReuseTranslationThreshold (double _reuse_translation_threshold);
 
         /*! \brief Current iteration number.
          *  \details Gets reset in `buildRBC` with every registration. */
@@ -2464,6 +4197,11 @@ namespace ICP
     protected:
         /*! \brief Performs the convergence check. */
         inline bool check ();
+        /*! \brief Checks whether the next iteration can reuse the correspondences. */
+        inline bool reusable ();
+        /*! \brief Performs the iterations in batches, with the convergence check on the device. */
+        template <ICPStepConfigT T = CR>
+        void runBatched ();
 
         /*! \brief Maximum number of iterations that a registration process is allowed to perform. */
         unsigned int max_iterations;
@@ -2471,6 +4209,16 @@ namespace ICP
         double angle_threshold;
         /*! \brief Threshold for the change in translation (in mm) in the transformation. */
         double translation_threshold;
+        /*! \brief Number of iterations enqueued at once, before the convergence flag gets read back.
+         *  \note It is only used by the `POWER_METHOD` configurations, which perform the 
+         *        convergence check on the device. */
+        unsigned int batch_size;
+        /*! \brief Bound on the change in angle (in degrees), below which the next 
+         *         iteration reuses the correspondences of the previous one. */
+        double reuse_angle_threshold;
+        /*! \brief Bound on the change in translation (in mm), below which the next 
+         *         iteration reuses the correspondences of the previous one. */
+        double reuse_translation_threshold;
 
     public:
         /*! \brief Executes the necessary kernels.
@@ -2495,6 +4243,471 @@ namespace ICP
 
     };
 
+
+    /*! \brief Executes the `%ICP` iterations in batches, with the convergence check on the device. */
+    template <>
+    void ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::run ();
+    /*! \brief Executes the `%ICP` iterations in batches, with the convergence check on the device. */
+    template <>
+    void ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::run ();
+
+
+    /*! \brief Interface class for a batch of `%ICP` pipelines using the Power Method 
+     *         to estimate the rotation and considering regular residual errors.
+     *  \details Registers `k` pairs of fixed and moving sets of landmarks at once. 
+     *           The sets are stored one after the other in strided buffers. The 
+     *           means, the deviations from the means, the `S` matrices, the power 
+     *           method, and the transformation updates are computed for all pairs 
+     *           in the same kernel launches. The convergence check is performed on 
+     *           the device, and each pair carries its own convergence flag, which 
+     *           masks any further updates on its transformation. The `k` estimated 
+     *           transformations are read back at once, at the end of the registration.
+     *  \note The `RBC` data structure construction and search are performed per pair, 
+     *        on sub-buffers of the strided buffers, since the `RBC` classes operate on 
+     *        a single set of points. The offsets of the sets, \f$ m*sizeof\ (cl\_float8) \f$, 
+     *        and of the representatives, \f$ nr*sizeof\ (cl\_float8) \f$, have to be 
+     *        multiples of the `CL_DEVICE_MEM_BASE_ADDR_ALIGN` of the device.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`. You can also call `get` 
+     *        (after the call to `init`) to get a reference to a buffer within 
+     *        the class and assign it to another kernel class instance further 
+     *        down in your task pipeline.
+     *  
+     *        The following input/output `OpenCL` memory objects are created 
+     *        by a `ICPBatch` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_F | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$k*m*sizeof\ (cl\_float8)\f$ |
+     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$k*m*sizeof\ (cl\_float8)\f$ |
+     *        | H_IO_T | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$k*2*sizeof\ (cl\_float4)\f$ |
+     *        | H_IO_C | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$k*2*sizeof\ (cl\_uint)\f$   |
+     *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$k*m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$k*m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IO_T | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$k*2*sizeof\ (cl\_float4)\f$ |
+     *        | D_IO_C | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$k*2*sizeof\ (cl\_uint)\f$   |
+     */
+    class ICPBatch
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_F,  /*!< Input staging buffer for the fixed sets of landmarks. */
+            H_IN_M,  /*!< Input staging buffer for the moving sets of landmarks. */
+            H_IO_T,  /*!< Input-output staging buffer for the quaternions and the translation vectors. 
+                      *   It holds one transformation, \f$ \left[ \begin{matrix} q_x & q_y & q_z & q_w 
+                      *   \end{matrix} \right]^T \f$ and \f$ \left[ \begin{matrix} t_x & t_y & t_z & s 
+                      *   \end{matrix} \right]^T \f$, per pair of sets. */
+            H_IO_C,  /*!< Input-output staging buffer for the convergence states. It holds, per pair 
+                      *   of sets, the convergence flag and the number of performed iterations. */
+            D_IN_F,  /*!< Input buffer for the fixed sets of landmarks. */
+            D_IN_M,  /*!< Input buffer for the moving sets of landmarks. */
+            D_IO_T,  /*!< Input-output buffer for the quaternions and the translation vectors. 
+                      *   It is loaded with initial estimations of the transformations 
+                      *   and gets refined with every %ICP iteration. */
+            D_IO_C,  /*!< Input-output buffer for the convergence states. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPBatch (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                  StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPBatch::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, unsigned int _nr, unsigned int _k, float _a = 1e2f, float _c = 1e-6f, 
+            unsigned int _max_iterations = 40, double _angle_threshold = 0.001,
+            double _translation_threshold = 0.01, Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPBatch::Memory mem = ICPBatch::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs a data transfer to a staging buffer. */
+        void* read (ICPBatch::Memory mem = ICPBatch::Memory::H_IO_T, bool block = CL_TRUE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Builds the RBC data structures. */
+        void buildRBC (const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Executes the necessary kernels. */
+        void run ();
+        /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in 
+         *         the distance calculations of the `RBC` data structures. */
+        float getAlpha ();
+        /*! \brief Sets the scaling parameter \f$ \alpha \f$ involved in 
+         *         the distance calculations of the `RBC` data structures. */
+        void setAlpha (float _a);
+        /*! \brief Gets the scaling factor c used when computing the `S` matrices. */
+        float getScaling ();
+        /*! \brief Sets the scaling factor c used when computing the `S` matrices. */
+        void setScaling (float _c);
+        /*! \brief Gets the maximum number of iterations. */
+        unsigned int getMaxIterations ();
+        /*! \brief Sets the maximum number of iterations. */
+        void setMaxIterations (unsigned int _max_iterations);
+        /*! \brief Gets the threshold for the change in angle. */
+        double getAngleThreshold ();
+        /*! \brief Sets the threshold for the change in angle. */
+        void setAngleThreshold (double _angle_threshold);
+        /*! \brief Gets the threshold for the change in translation. */
+        double getTranslationThreshold ();
+        /*! \brief Sets the threshold for the change in translation. */
+        void setTranslationThreshold (double _translation_threshold);
+        /*! \brief Gets the number of iterations enqueued between convergence checks. */
+        unsigned int getBatchSize ();
+        /*! \brief Sets the number of iterations enqueued between convergence checks. */
+        void setBatchSize (unsigned int _batch_size);
+        /*! \brief Gets the convergence tolerance of the Power Method. */
+        float getPowerTolerance ();
+        /*! \brief Sets the convergence tolerance of the Power Method. */
+        void setPowerTolerance (float _tolerance);
+        /*! \brief Gets the maximum number of Power Method iterations. */
+        unsigned int getPowerMaxIterations ();
+        /*! \brief Sets the maximum number of Power Method iterations. */
+        void setPowerMaxIterations (unsigned int _max_iterations);
+        /*! \brief Gets the flag for warm starting the Power Method. */
+        bool getPowerWarmStart ();
+        /*! \brief Sets the flag for warm starting the Power Method. */
+        void setPowerWarmStart (bool _warm_start);
+
+        cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed sets of points. */
+        cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving sets of points. */
+        cl_float *hPtrIOT;  /*!< Mapping of the input-output staging buffer for the estimated 
+                             *   quaternions and translation vectors. */
+        cl_uint *hPtrIOC;   /*!< Mapping of the input-output staging buffer for the convergence states. */
+
+    private:
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue;
+        cl::Kernel repsKernel, transformKernel, meanKernel, groupMeanKernel, 
+                   devsKernel, sijKernel, powMethodKernel, updateKernel;
+        Reduce<ReduceConfig::SUM, cl_float> reduceSij;
+        std::vector<RBC::RBCConstruct
+            <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC>> rbcC;
+        std::vector<RBC::RBCSearch
+            <RBC::KernelTypeC::KINECT_R, 
+                RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT>> rbcS;
+        cl::NDRange globalR, globalT, globalM, globalGM, localM, globalD, globalS, globalP;
+        Staging staging;
+        float a, c;
+        unsigned int m, nr, k, d, wgMultiple, wgXdim;
+        unsigned int max_iterations, batch_size;
+        double angle_threshold, translation_threshold;
+        float power_tolerance;
+        unsigned int power_max_iterations;
+        bool power_warm_start;
+        unsigned int bufferFMSize, bufferTSize, bufferCSize;
+        cl::Buffer hBufferInF, hBufferInM, hBufferIOT, hBufferIOC;
+        cl::Buffer dBufferInF, dBufferInM, dBufferIOT, dBufferIOC;
+        cl::Buffer dBufferR, dBufferTM, dBufferNN, dBufferQP, dBufferGM, dBufferMean, 
+                   dBufferDevF, dBufferDevM, dBufferSij, dBufferS, dBufferTk, dBufferIter;
+
+        /*! \brief Enqueues a number of iterations for all the pairs of sets. */
+        void runBatch (unsigned int iterations, bool config);
+
+    public:
+        /*! \brief Executes the necessary kernels.
+         *  \details This `run` instance is used for profiling. It performs 
+         *           one %ICP iteration for all the pairs of sets.
+         *  
+         *  \param[in] timer `GPUTimer` that does the profiling of the kernel executions.
+         *  \param[in] config flag. If true, configures the `RBC search` processes. 
+         *                    Set to true once, when the `RBC` data structures are reset.
+         *  \return Τhe total execution time measured by the timer.
+         */
+        template <typename period>
+        double run (clutils::GPUTimer<period> &timer, bool config = false)
+        {
+            double pTime = 0.0;
+
+            queue.enqueueNDRangeKernel (transformKernel, cl::NullRange, globalT, cl::NullRange, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            for (auto &search : rbcS)
+                pTime += search.run (timer, nullptr, config);
+
+            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, localM, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            if (wgXdim != 1)
+            {
+                queue.enqueueNDRangeKernel (groupMeanKernel, cl::NullRange, globalGM, localM, 
+                                            nullptr, &timer.event ());
+                queue.flush (); timer.wait ();
+                pTime += timer.duration ();
+            }
+
+            queue.enqueueNDRangeKernel (devsKernel, cl::NullRange, globalD, cl::NullRange, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            queue.enqueueNDRangeKernel (sijKernel, cl::NullRange, globalS, cl::NullRange, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            pTime += reduceSij.run (timer);
+
+            queue.enqueueNDRangeKernel (powMethodKernel, cl::NullRange, globalP, cl::NullRange, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            queue.enqueueNDRangeKernel (updateKernel, cl::NullRange, globalP, cl::NullRange, 
+                                        nullptr, &timer.event ());
+            queue.flush (); timer.wait ();
+            pTime += timer.duration ();
+
+            return pTime;
+        }
+
+    };
+
+
+    /*! \brief Interface class for frame-to-frame %ICP odometry.
+     *  \details Registers every new frame of a continuous sequence to the previous one, 
+     *           and accumulates the relative transformations into a global pose. The 
+     *           landmarks of each frame are extracted once. When a new frame arrives, the 
+     *           landmarks of the previous frame are promoted to the fixed set with a device 
+     *           copy, and the landmarks of the new frame take the place of the moving set.
+     *           The registration is warm-started with the previous relative motion.
+     *  \note The `RBC` data structure is built on the fixed set, so it still has 
+     *        to be rebuilt once per frame.
+     *  \note The class is available for the point-to-point configurations of `ICPStep`. 
+     *        It doesn't compute the normal maps that the point-to-plane configuration 
+     *        needs. Look at `ICPNormals`.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`.
+     *  
+     *        The following input/output `OpenCL` memory objects are created 
+     *        by a `ICPOdometry` instance:<br>
+     *        | Name | Type | Placement | I/O | Use | Properties | Size |
+     *        | ---  |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN   | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$640*480*sizeof\ (cl\_float8)\f$ or \f$640*480*sizeof\ (cl\_float4)\f$ |
+     *        | H_IN_C | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$640*480*sizeof\ (cl\_uchar4)\f$ or \f$640*480*sizeof\ (cl\_half)*4\f$ |
+     *        | D_IN   | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$640*480*sizeof\ (cl\_float8)\f$ or \f$640*480*sizeof\ (cl\_float4)\f$ |
+     *        | D_IN_C | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$640*480*sizeof\ (cl\_uchar4)\f$ or \f$640*480*sizeof\ (cl\_half)*4\f$ |
+     *        
+     *  \note With `ICPLayout::SOA`, every frame is uploaded as a geometry stream (`D_IN`) 
+     *        and a packed color stream (`D_IN_C`), 20 (or 24) bytes per point instead 
+     *        of 32. Look at `ICPLMs`. The `*_C` buffers exist only for `ICPLayout::SOA`.
+     *  
+     *  \tparam CR configures the class with different methods of rotation computation.
+     *  \tparam CW configures the class for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPOdometry
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN,    /*!< Input staging buffer for the new frame (geometry stream, for `ICPLayout::SOA`). */
+            H_IN_C,  /*!< Input staging buffer for the color stream of the new frame (for `ICPLayout::SOA`). */
+            D_IN,    /*!< Input buffer for the new frame (geometry stream, for `ICPLayout::SOA`). */
+            D_IN_C,  /*!< Input buffer for the color stream of the new frame (for `ICPLayout::SOA`). */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPOdometry (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                     StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPOdometry::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, unsigned int _nr, float _a = 1e2f, float _c = 1e-6f, 
+            unsigned int _max_iterations = 40, double _angle_threshold = 0.001,
+            double _translation_threshold = 0.01, bool _warm_start = true, 
+            ICPLayout _layout = ICPLayout::AOS, ICPColor _color = ICPColor::UCHAR, 
+            Staging _staging = Staging::I);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPOdometry::Memory mem = ICPOdometry::Memory::D_IN, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Registers the new frame to the previous one. */
+        void run (const std::vector<cl::Event> *events = nullptr);
+        /*! \brief Resets the sequence and the global pose. */
+        void reset ();
+        /*! \brief Gets the flag for the warm-start of the registrations. */
+        bool getWarmStart ();
+        /*! \brief Sets the flag for the warm-start of the registrations. */
+        void setWarmStart (bool _warm_start);
+
+        cl_float *hPtrIn;  /*!< Mapping of the input staging buffer for the new frame. */
+        cl_uchar *hPtrInC;  /*!< Mapping of the input staging buffer for the color stream of the new frame. */
+
+        Eigen::Matrix3f Rr;     /*!< Represents the rotation between the last two frames, 
+                                 *   given in rotation matrix representation. */
+        Eigen::Quaternionf qr;  /*!< Represents the rotation between the last two frames, 
+                                 *   given in quaternion representation. */
+        Eigen::Vector3f tr;     /*!< Represents the translation between the last two frames, 
+                                 *   given as a vector in 3-D. */
+        cl_float sr;            /*!< Represents the scale between the last two frames, 
+                                 *   given as a scalar. */
+
+        Eigen::Matrix3f R;     /*!< Represents the global rotation of the last frame, relative 
+                                *   to the first one, given in rotation matrix representation. */
+        Eigen::Quaternionf q;  /*!< Represents the global rotation of the last frame, relative 
+                                *   to the first one, given in quaternion representation. */
+        Eigen::Vector3f t;     /*!< Represents the global translation of the last frame, relative 
+                                *   to the first one, given as a vector in 3-D. */
+        cl_float s;            /*!< Represents the global scale of the last frame, relative 
+                                *   to the first one, given as a scalar. */
+
+        /*! \brief Number of frames processed since the last reset. */
+        unsigned int frames;
+        /*! \brief Number of iterations performed by the last registration. */
+        unsigned int k;
+
+    private:
+        /*! \brief Loads an initial estimation of the relative transformation. */
+        void load (const Eigen::Quaternionf &_q, const Eigen::Vector3f &_t, cl_float _s);
+
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        cl::Context context;
+        cl::CommandQueue queue;
+        ICPLMs lm;
+        ICP<CR, CW> reg;
+        bool warm_start;
+        unsigned int m;
+        cl::Buffer dBufferF, dBufferM;
+
+    };
+
+
+    /*! \brief Configuration of a single level of an `ICPPyramid`. */
+    struct ICPPyramidLevel
+    {
+        unsigned int m;                /*!< Number of landmarks. It has to be a power of 2. */
+        unsigned int nr;               /*!< Number of fixed set representatives. */
+        unsigned int max_iterations;   /*!< Maximum number of iterations at the level. */
+        double angle_threshold;        /*!< Threshold for the change in angle (in degrees). */
+        double translation_threshold;  /*!< Threshold for the change in translation (in mm). */
+    };
+
+
+    /*! \brief Interface class for coarse-to-fine %ICP registration.
+     *  \details Registers two point clouds over a sequence of levels of increasing density. 
+     *           Each level samples its own sets of landmarks from the point clouds, and runs 
+     *           an `ICP` pipeline with its own iteration cap and thresholds. The levels share 
+     *           the transformation buffer, so every level starts from the estimation of the 
+     *           previous one. The bulk of the iterations, which is spent on coarse alignment, 
+     *           can then be performed on a small number of landmarks, e.g. 
+     *           `{ 1024, 32 }, { 4096, 128 }, { 16384, 256 }`.
+     *  \note Like `ICP`, every registration starts from the last estimation. 
+     *        Call `reset` to start from the identity transformation.
+     *  \note The levels are instantiated for the point-to-point configurations only. 
+     *        There is no normal map of the fixed cloud for a point-to-plane level to use.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`.
+     *  
+     *        The following input/output `OpenCL` memory objects are created 
+     *        by a `ICPPyramid` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_F | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$n*sizeof\ (cl\_float8)\f$ |
+     *        
+     *  \tparam CR configures the class with different methods of rotation computation.
+     *  \tparam CW configures the class for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPPyramid
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_F,  /*!< Input staging buffer for the fixed point cloud. */
+            H_IN_M,  /*!< Input staging buffer for the moving point cloud. */
+            D_IN_F,  /*!< Input buffer for the fixed point cloud. */
+            D_IN_M   /*!< Input buffer for the moving point cloud. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPPyramid (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                    StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPPyramid::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (const std::vector<ICPPyramidLevel> &_levels, unsigned int _width = 640, 
+            unsigned int _height = 480, float _a = 1e2f, float _c = 1e-6f, Staging _staging = Staging::I);
+        /*! \brief Performs a data transfer to a device buffer. */
+        void write (ICPPyramid::Memory mem = ICPPyramid::Memory::D_IN_F, void *ptr = nullptr, bool block = CL_FALSE, 
+                    const std::vector<cl::Event> *events = nullptr, cl::Event *event = nullptr);
+        /*! \brief Performs the registration, level by level. */
+        void run (const std::vector<cl::Event> *events = nullptr);
+        /*! \brief Resets the estimation to the identity transformation. */
+        void reset ();
+        /*! \brief Gets the number of levels. */
+        unsigned int getLevels ();
+        /*! \brief Gets the maximum number of iterations at a level. */
+        unsigned int getMaxIterations (unsigned int level);
+        /*! \brief Sets the maximum number of iterations at a level. */
+        void setMaxIterations (unsigned int level, unsigned int _max_iterations);
+        /*! \brief Gets the threshold for the change in angle at a level. */
+        double getAngleThreshold (unsigned int level);
+        /*! \brief Sets the threshold for the change in angle at a level. */
+        void setAngleThreshold (unsigned int level, double _angle_threshold);
+        /*! \brief Gets the threshold for the change in translation at a level. */
+        double getTranslationThreshold (unsigned int level);
+        /*! \brief Sets the threshold for the change in translation at a level. */
+        void setTranslationThreshold (unsigned int level, double _translation_threshold);
+
+        cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed point cloud. */
+        cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving point cloud. */
+
+        Eigen::Matrix3f R;     /*!< Represents the rotation of the moving point cloud, 
+                                *   given in rotation matrix representation. */
+        Eigen::Quaternionf q;  /*!< Represents the rotation of the moving point cloud, 
+                                *   given in quaternion representation. */
+        Eigen::Vector3f t;     /*!< Represents the translation of the moving point cloud, 
+                                *   given as a vector in 3-D. */
+        cl_float s;            /*!< Represents the scale of the moving point cloud, 
+                                *   given as a scalar. */
+
+        /*! \brief Number of iterations performed at each level by the last registration. */
+        std::vector<unsigned int> k;
+
+    private:
+        /*! \brief Passes the host side estimation from one level to another. */
+        void handoff (ICP<CR, CW> &from, ICP<CR, CW> &to);
+
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> infoRBC, infoICP;
+        StagingPool *pool;
+        cl::Context context;
+        cl::CommandQueue queue;
+        std::vector<ICPLMs> lmF, lmM;
+        std::vector< ICP<CR, CW>, Eigen::aligned_allocator< ICP<CR, CW> > > regs;
+        unsigned int levels;
+
+    };
+
 }
 }
 
@@ -0,0 +1,231 @@
+/*! \file cpu.hpp
+ *  \brief Declares a multithreaded CPU backend for the %ICP pipeline.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_CPU_HPP
+#define ICP_CPU_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <ICP/common.hpp>
+#include <ICP/algorithms.hpp>
+#include <eigen3/Eigen/Dense>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief A fixed set of worker threads that split loops into contiguous chunks.
+     *  \details `run` divides a range of indices into one chunk per thread, and 
+     *           blocks until all chunks are done. The calling thread processes the 
+     *           first chunk, so a pool of size 1 starts no threads at all.
+     */
+    class ICPThreadPool
+    {
+    public:
+        /*! \brief The function processing a chunk, called with `(begin, end, chunk)`. */
+        typedef std::function<void (unsigned int, unsigned int, unsigned int)> Task;
+
+        /*! \brief Starts the worker threads. */
+        ICPThreadPool (unsigned int _threads = 0);
+        /*! \brief Stops the worker threads. */
+        ~ICPThreadPool ();
+        /*! \brief Processes the range `[0, n)` in parallel. */
+        void run (unsigned int n, const Task &_task);
+        /*! \brief Returns the number of threads, including the calling thread. */
+        unsigned int size () const;
+
+    private:
+        /*! \brief Waits for tasks, and processes one chunk of each. */
+        void work (unsigned int chunk);
+
+        std::vector<std::thread> workers;
+        const Task *task;
+        unsigned int n, generation, pending;
+        bool quit;
+        std::mutex mutex;
+        std::condition_variable cvTask, cvDone;
+
+    };
+
+
+    /*! \brief CPU implementation of the `%ICP` pipeline.
+     *  \details Offers the interface of `ICP<CR, CW>`, so it can replace it at runtime on 
+     *           hosts without a usable OpenCL device. The landmarks are kept in 
+     *           structure-of-arrays layout, so that the transformation, the distance 
+     *           calculations and the reductions vectorize (e.g., AVX2, NEON), and every 
+     *           stage is split across an `ICPThreadPool`. The nearest neighbor search 
+     *           uses a one-shot Random Ball Cover, like the `RBC` classes, with the same 
+     *           representatives as `ICPReps`. The partial sums are combined in a fixed 
+     *           order, so the results don't depend on the scheduling of the threads.
+     *  \note The `D_*` memory objects are host arrays, internal to the class. `write` 
+     *        converts the landmarks to the internal layout, just like it would upload 
+     *        them on the device. This way, code written for `ICP<CR, CW>` works unchanged.
+     *  \note The distance between two points is \f$ \|x_g-x'_g\|_2^2+a\|x_p-x'_p\|_2^2 \f$.
+     *        With the `WEIGHTED` configurations, a pair of points gets the weight 
+     *        \f$ w=100/(100+d) \f$, like in `ICPWeights`.
+     *  
+     *  \tparam CR configures the class with different methods of rotation computation.
+     *  \tparam CW configures the class for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPCPU
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers.
+         *  \note `D_*` names refer to the internal arrays, in the place of the device buffers.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_F,  /*!< Input staging buffer for the fixed set of landmarks. */
+            H_IN_M,  /*!< Input staging buffer for the moving set of landmarks. */
+            H_IO_T,  /*!< Input-output staging buffer for the quaternion and the translation vector. 
+                      *   The layout is the same as the one in `ICP<CR, CW>`. */
+            D_IN_F,  /*!< Internal array for the fixed set of landmarks. */
+            D_IN_M,  /*!< Internal array for the moving set of landmarks. */
+            D_IO_T   /*!< Internal copy of the quaternion and the translation vector. */
+        };
+
+        /*! \brief Starts the worker threads. */
+        ICPCPU (unsigned int _threads = 0);
+        /*! \brief Configures the pipeline parameters. */
+        void init (unsigned int _m, unsigned int _nr, float _a = 1e2f, float _c = 1e-6f, 
+            unsigned int _max_iterations = 40, double _angle_threshold = 0.001,
+            double _translation_threshold = 0.01, Staging _staging = Staging::IO);
+        /*! \brief Performs a data transfer to an internal array. */
+        void write (ICPCPU::Memory mem = ICPCPU::Memory::D_IN_F, void *ptr = nullptr);
+        /*! \brief Returns a staging buffer. */
+        void* read (ICPCPU::Memory mem = ICPCPU::Memory::H_IO_T);
+        /*! \brief Builds the RBC data structure. */
+        void buildRBC ();
+        /*! \brief Performs one %ICP iteration. */
+        void step ();
+        /*! \brief Executes the %ICP algorithm. */
+        void run ();
+        /*! \brief Gets the scaling parameter \f$ \alpha \f$ involved in the distance calculations. */
+        float getAlpha ();
+        /*! \brief Sets the scaling parameter \f$ \alpha \f$ involved in the distance calculations. */
+        void setAlpha (float _a);
+        /*! \brief Gets the maximum number of iterations. */
+        unsigned int getMaxIterations ();
+        /*! \brief Sets the maximum number of iterations. */
+        void setMaxIterations (unsigned int _max_iterations);
+        /*! \brief Gets the threshold for the change in angle. */
+        double getAngleThreshold ();
+        /*! \brief Sets the threshold for the change in angle. */
+        void setAngleThreshold (double _angle_threshold);
+        /*! \brief Gets the threshold for the change in translation. */
+        double getTranslationThreshold ();
+        /*! \brief Sets the threshold for the change in translation. */
+        void setTranslationThreshold (double _translation_threshold);
+        /*! \brief Gets the number of threads. */
+        unsigned int getThreads ();
+
+        cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
+        cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
+        cl_float *hPtrIOT;  /*!< Mapping of the input-output staging buffer for the estimated 
+                             *   quaternion and translation vector. */
+
+        Eigen::Matrix3f Rk;     /*!< Represents the incremental development in the rotation estimation in 
+                                 *   iteration `k`, given in rotation matrix representation, \f$ R_k \f$. */
+        Eigen::Quaternionf qk;  /*!< Represents the incremental development in the rotation estimation in 
+                                 *   iteration `k`, given in quaternion representation. */
+        Eigen::Vector3f tk;     /*!< Represents the incremental development in the translation estimation 
+                                 *   in iteration `k`, given as a vector in 3-D, \f$ t_k \f$. */
+        cl_float sk;            /*!< Represents the incremental development in the scale estimation 
+                                 *   in iteration `k`, given as a scalar, \f$ s_k \f$. */
+
+        Eigen::Matrix3f R;     /*!< Represents the rotation estimation up to iteration `k`, 
+                                *   given in rotation matrix representation, \f$ R \f$. */
+        Eigen::Quaternionf q;  /*!< Represents the rotation estimation up to iteration `k`, 
+                                *   given in quaternion representation. */
+        Eigen::Vector3f t;     /*!< Represents the translation estimation up to iteration `k`, 
+                                *   given as a vector in 3-D, \f$ t \f$. */
+        cl_float s;            /*!< Represents the scale estimation up to iteration `k`,
+                                *   given as a scalar, \f$ s \f$. */
+
+        /*! \brief Current iteration number.
+         *  \details Gets reset in `buildRBC` with every registration. */
+        unsigned int k;
+
+    private:
+        /*! \brief A set of points in structure-of-arrays layout. */
+        struct Points
+        {
+            std::vector<cl_float> x, y, z, r, g, b;
+
+            void resize (unsigned int n);
+            void load (const cl_float *in, unsigned int n);
+        };
+
+        /*! \brief Partial sums of a chunk of points. */
+        struct Sums
+        {
+            double w, f[3], m[3], mf[9], mm, ff;
+        };
+
+        /*! \brief Finds the nearest neighbors of the queries in `[begin, end)`. */
+        void search (unsigned int begin, unsigned int end, unsigned int chunk);
+        /*! \brief Accumulates the partial sums for the means of the pairs in `[begin, end)`. */
+        void means (unsigned int begin, unsigned int end, unsigned int chunk);
+        /*! \brief Accumulates the partial sums for the `S` matrix of the pairs in `[begin, end)`. */
+        void products (unsigned int begin, unsigned int end, unsigned int chunk);
+        /*! \brief Solves for the incremental transformation. */
+        void solve (const Eigen::Matrix3d &S, double Smm, double Sff);
+        /*! \brief Performs the convergence check. */
+        inline bool check ();
+
+        ICPThreadPool pool;
+        Staging staging;
+        float a, c;
+        unsigned int m, nr, d;
+        unsigned int max_iterations;
+        double angle_threshold, translation_threshold;
+
+        std::vector<cl_float> hInF, hInM, hIOT;
+        Points fixed, moving, tMoving;  // landmarks, and transformed moving landmarks
+        Points reps, lists;             // representatives, and fixed landmarks grouped by representative
+        Points matched;                 // nearest neighbor of every transformed moving landmark
+        std::vector<unsigned int> owner;    // representative of every fixed landmark
+        std::vector<unsigned int> offsets;  // start of the list of each representative
+        std::vector<cl_float> dist;         // distance to the nearest neighbor
+        std::vector<Sums> sums;             // partial sums per chunk
+        std::vector< std::vector<cl_float> > scratch;  // distances under evaluation, per chunk
+        Eigen::Vector3d mf, mm;             // fixed and moving set means
+
+    };
+
+}
+}
+
+#endif  // ICP_CPU_HPP
@@ -0,0 +1,198 @@
+/*! \file pc_file.hpp
+ *  \brief Declares a memory-mapped, chunked file format for point cloud sequences.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_PC_FILE_HPP
+#define ICP_PC_FILE_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <CLUtils.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Enumerates the layouts of the points in a point cloud file. */
+    enum class PCFileLayout : uint32_t
+    {
+        FLOAT8,  /*!< Interleaved `cl_float8` points, \f$ [x\ y\ z\ w\ r\ g\ b\ a] \f$. */
+        RGBD     /*!< Raw Kinect frames. A `uint16_t` depth plane (in mm), followed by 
+                  *   a `uint8_t` RGB plane, 3 channels per pixel. `ICPBackProject` 
+                  *   rebuilds the `cl_float8` points on the device. */
+    };
+
+
+    /*! \brief Enumerates the compression schemes of the depth planes in a point cloud file. */
+    enum class PCFileCompression : uint32_t
+    {
+        NONE,  /*!< The depth planes are stored as they are. */
+        RLE    /*!< The depth planes are run-length encoded. A `uint16_t` token with the 
+                *   high bit set is followed by a value, repeated `token & 0x7FFF` times. 
+                *   Otherwise, it's followed by `token` literal values. */
+    };
+
+
+    /*! \brief Alignment (in bytes) of the header and the chunks in a point cloud file.
+     *  \details It matches the page size, so that every frame of a mapped 
+     *           file starts on a page boundary, as `CL_MEM_USE_HOST_PTR` 
+     *           needs it for zero-copy access.
+     */
+    const uint64_t pcFileAlignment = 4096;
+
+    /*! \brief Current version of the point cloud file format.
+     *  \details Version 2 added the `RGBD` layout, and the compression 
+     *           of the depth planes. Version 1 files are still accepted. */
+    const uint32_t pcFileVersion = 2;
+
+
+    /*! \brief Header of a point cloud file.
+     *  \details The header is followed by `frames` chunks, starting at `dataOffset`. 
+     *           Each chunk holds a `PCChunkHeader`, padded to `pcFileAlignment`, 
+     *           and the frame, padded to `pcFileAlignment`.
+     */
+    struct PCFileHeader
+    {
+        char magic[4];          /*!< The characters `ICPC`. */
+        uint32_t version;       /*!< Version of the file format. */
+        uint32_t width;         /*!< Width (in pixels) of the frames. */
+        uint32_t height;        /*!< Height (in pixels) of the frames. */
+        PCFileLayout layout;    /*!< Layout of the points. */
+        float fx, fy;           /*!< Focal lengths (in pixels) of the camera. */
+        float cx, cy;           /*!< Principal point (in pixels) of the camera. */
+        uint32_t frames;        /*!< Number of frames in the file. */
+        uint64_t frameBytes;    /*!< Size (in bytes) of an uncompressed frame. */
+        uint64_t chunkBytes;    /*!< Size (in bytes) of a chunk, or `0` if the 
+                                 *   chunks vary in size (compressed frames). */
+        uint64_t dataOffset;    /*!< Offset (in bytes) of the first chunk. */
+        PCFileCompression compression;  /*!< Compression of the depth planes. */
+    };
+
+
+    /*! \brief Header of a chunk in a point cloud file. */
+    struct PCChunkHeader
+    {
+        uint64_t timestamp;   /*!< Capture time (in us) of the frame. */
+        uint32_t index;       /*!< Index of the frame in the sequence. */
+        uint32_t bytes;       /*!< Size (in bytes) of the stored frame. It's `0` 
+                               *   in version 1 files, which store `frameBytes`. */
+        uint32_t depthBytes;  /*!< Size (in bytes) of the stored depth plane (`RGBD` layout). */
+        uint32_t reserved;    /*!< Unused. */
+    };
+
+
+    /*! \brief Writes a sequence of point clouds, or of raw depth and RGB frames, in a point cloud file.
+     *  \details Frames are appended one at a time. The number of frames in the 
+     *           header is updated on `close`, or on destruction.
+     */
+    class PCFileWriter
+    {
+    public:
+        /*! \brief Creates the file and writes its header. */
+        PCFileWriter (const std::string &path, unsigned int _width = 640, unsigned int _height = 480, 
+                      float _fx = 595.f, float _fy = 595.f, PCFileLayout _layout = PCFileLayout::FLOAT8, 
+                      PCFileCompression _compression = PCFileCompression::NONE);
+        /*! \brief Closes the file. */
+        ~PCFileWriter ();
+        PCFileWriter (const PCFileWriter &) = delete;
+        PCFileWriter& operator= (const PCFileWriter &) = delete;
+        /*! \brief Appends a point cloud to a `FLOAT8` file. */
+        void append (const cl_float8 *pc8d, uint64_t timestamp);
+        /*! \brief Appends a pair of depth and RGB frames to an `RGBD` file. */
+        void append (const uint16_t *depth, const uint8_t *rgb, uint64_t timestamp);
+        /*! \brief Finalizes the header and closes the file. */
+        void close ();
+        /*! \brief Returns the number of frames written so far. */
+        unsigned int frames () const;
+
+    private:
+        /*! \brief Writes a chunk. */
+        void write (uint64_t timestamp, const char *data, uint32_t bytes, 
+                    const char *rgb = nullptr, uint32_t rgbBytes = 0);
+
+        std::ofstream file;
+        PCFileHeader header;
+        std::vector<uint16_t> encoded;
+
+    };
+
+
+    /*! \brief Memory-maps a point cloud file for reading.
+     *  \details The frames are accessed directly on the mapped pages. `buffer` 
+     *           wraps a frame in a `CL_MEM_USE_HOST_PTR` buffer, so that a frame 
+     *           can be copied to a device buffer with `enqueueCopyBuffer`, or 
+     *           read by a kernel, without an intermediate copy on the host.
+     *  \note Files with the `RGBD` layout are read with `readRGBD`, which decodes 
+     *        the frames into host buffers, e.g. the staging buffers of an 
+     *        `ICPBackProject` instance.
+     *  \note Raw dumps of `640x480` `cl_float8` frames, as written by earlier 
+     *        versions of `kinect_frame_grabber`, are accepted too. They are 
+     *        reported with a version of `0`, the default intrinsics, and zero 
+     *        timestamps.
+     */
+    class PCFile
+    {
+    public:
+        /*! \brief Opens and maps a point cloud file. */
+        PCFile (const std::string &path);
+        /*! \brief Unmaps and closes the file. */
+        ~PCFile ();
+        PCFile (const PCFile &) = delete;
+        PCFile& operator= (const PCFile &) = delete;
+        /*! \brief Returns the header of the file. */
+        const PCFileHeader& getHeader () const;
+        /*! \brief Returns the number of frames in the file. */
+        unsigned int frames () const;
+        /*! \brief Returns a pointer to a frame on the mapped pages. */
+        const cl_float8* frame (unsigned int idx) const;
+        /*! \brief Decodes a pair of depth and RGB frames. */
+        void readRGBD (unsigned int idx, uint16_t *depth, uint8_t *rgb) const;
+        /*! \brief Returns the capture time (in us) of a frame. */
+        uint64_t timestamp (unsigned int idx) const;
+        /*! \brief Wraps a frame in an OpenCL buffer. */
+        cl::Buffer buffer (const cl::Context &context, unsigned int idx) const;
+
+    private:
+        /*! \brief Returns the header of a chunk. */
+        PCChunkHeader chunk (unsigned int idx) const;
+
+        int fd;
+        unsigned char *base;
+        uint64_t bytes;
+        PCFileHeader header;
+        std::vector<uint64_t> offsets;
+
+    };
+
+}
+}
+
+#endif  // ICP_PC_FILE_HPP
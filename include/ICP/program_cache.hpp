@@ -0,0 +1,213 @@
+/*! \file program_cache.hpp
+ *  \brief Declares an on-disk cache of OpenCL program binaries and launch configurations.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_PROGRAM_CACHE_HPP
+#define ICP_PROGRAM_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <CLUtils.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Adds a program to an OpenCL environment, reusing previously built binaries.
+     *  \details Works like `clutils::CLEnv::addProgram`, but keeps an on-disk cache 
+     *           of program binaries. The cache key covers the name, version and 
+     *           driver version of every device in the context, the build options, 
+     *           and the contents of the kernel files and of the files they `#include`, 
+     *           looked up next to the including file and in the `-I` directories 
+     *           of the build options. On a hit, the program is created with 
+     *           `clCreateProgramWithBinary`, and the compilation from source 
+     *           is skipped. On a miss, or if the cached binaries are rejected 
+     *           by the driver, the program is compiled from source and its binaries 
+     *           are stored for the next run.
+     *  \note `clutils::CLEnv` doesn't accept external programs. So, on a hit, a 
+     *        trivial placeholder program (`<cacheDir>/placeholder.cl`, a single empty 
+     *        kernel) is built through `addProgram` to reserve the next program index. 
+     *        The program object is then assigned to the slot through the reference 
+     *        that `addProgram` returns, and the placeholder is released. This relies 
+     *        on `CLEnv` keeping its programs by value, and handing out references to 
+     *        them, as `getProgram` does. The cost of a hit is the build of the placeholder. 
+     *        Program indices are assigned in the same order as with `addProgram`. 
+     *        If the placeholder can't be written to `cacheDir`, the program is 
+     *        compiled from source instead.
+     *  \note The cache is best effort. Failures to read or write it are ignored.
+     *
+     *  \param[in] env the OpenCL environment.
+     *  \param[in] ctxIdx index of the context on which the program will be built.
+     *  \param[in] kernel_filenames names of the files holding the kernel sources.
+     *  \param[in] build_options options passed to the compiler.
+     *  \param[in] cacheDir directory holding the cached binaries. If empty, the 
+     *                      cache is disabled, and the call falls through to `addProgram`.
+     *  \return A reference to the program inside the environment.
+     */
+    cl::Program& addProgramCached (clutils::CLEnv &env, unsigned int ctxIdx, 
+                                   const std::vector<std::string> &kernel_filenames, 
+                                   const char *build_options = nullptr, 
+                                   const std::string &cacheDir = "kernels/cache");
+
+
+    /*! \brief Produces the build options that specialize the `%ICP` kernels.
+     *  \details The options define `ICP_M`, `ICP_C` and, if `wg` is not `0`, `ICP_WG`. 
+     *           Look at [kernels/icp_kernels.cl](kernels/icp_kernels.cl) for their effect.
+     *
+     *  \param[in] m number of points in the sets.
+     *  \param[in] c scaling factor of the `S` matrix kernels.
+     *  \param[in] wg local workspace size of the reductions. If `0`, it's left to the classes.
+     *  \return The build options.
+     */
+    std::string specializationOptions (unsigned int m, float c, unsigned int wg = 0);
+
+
+    /*! \brief Adds a program with the `%ICP` kernels specialized for a fixed pipeline.
+     *  \details Works like `addProgramCached`, with the options from `specializationOptions` 
+     *           appended to the build options. Each variant is cached separately.
+     *  \note The `%ICP` classes that are given the index of a specialized program can only 
+     *        be initialized, or resized, with the same number of points and scaling factor. 
+     *        Their local workspaces follow `wg`, when it's set.
+     *
+     *  \param[in] env the OpenCL environment.
+     *  \param[in] ctxIdx index of the context on which the program will be built.
+     *  \param[in] kernel_filenames names of the files holding the kernel sources.
+     *  \param[in] m number of points in the sets.
+     *  \param[in] c scaling factor of the `S` matrix kernels.
+     *  \param[in] wg local workspace size of the reductions. If `0`, it's left to the classes.
+     *  \param[in] build_options additional options passed to the compiler.
+     *  \param[in] cacheDir directory holding the cached binaries. If empty, the cache is disabled.
+     *  \return A reference to the program inside the environment.
+     */
+    cl::Program& addProgramSpecialized (clutils::CLEnv &env, unsigned int ctxIdx, 
+                                        const std::vector<std::string> &kernel_filenames, 
+                                        unsigned int m, float c, unsigned int wg = 0, 
+                                        const char *build_options = nullptr, 
+                                        const std::string &cacheDir = "kernels/cache");
+
+
+    /*! \brief Reads the constants that a program was specialized for.
+     *  \details Parses the program build options for `ICP_M` and `ICP_C`.
+     *
+     *  \param[in] program the program.
+     *  \param[in] device the device for which the program was built.
+     *  \param[out] m number of points in the sets, or `0` if it's not fixed.
+     *  \param[out] c scaling factor of the `S` matrix kernels, or `0` if it's not fixed.
+     */
+    void getSpecialization (const cl::Program &program, const cl::Device &device, unsigned int &m, float &c);
+
+
+    /*! \brief Returns the local workspace size to use with a kernel.
+     *  \details It's the size the kernel was compiled for, if it was built with 
+     *           `ICP_WG`, the tuned size, if `tuneWorkGroups` has stored one for 
+     *           the kernel on the device, or its preferred work-group size multiple otherwise.
+     *
+     *  \param[in] kernel the kernel.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \return The local workspace size.
+     */
+    size_t getWorkGroupMultiple (const cl::Kernel &kernel, const cl::Device &device);
+
+
+    /*! \brief Launch configuration of a kernel, as picked by `tuneWorkGroups`. */
+    struct WorkGroupConfig
+    {
+        size_t local;      /*!< Local workspace size. */
+        unsigned int ept;  /*!< Elements per work-item, or `0` if the kernel fixes it. */
+    };
+
+
+    /*! \brief Sets the directory that holds the tuned launch configurations.
+     *  \details There is a file per device, named after the hash of its name, version 
+     *           and driver version, `<tuneDir>/<hash>.txt`. It's loaded the first time 
+     *           a configuration is requested for the device. The default directory 
+     *           is `kernels/tuning`.
+     *  \note Every configuration that was loaded or set before the call is discarded.
+     *
+     *  \param[in] tuneDir the directory. If empty, nothing is loaded or stored.
+     */
+    void setTuningDir (const std::string &tuneDir);
+
+
+    /*! \brief Looks up the tuned launch configuration of a kernel on a device.
+     *
+     *  \param[in] kernelName name of the kernel function.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \param[out] config the configuration. It's left untouched if there is none.
+     *  \return True if there is a configuration.
+     */
+    bool getTunedConfig (const std::string &kernelName, const cl::Device &device, WorkGroupConfig &config);
+
+
+    /*! \brief Looks up the tuned launch configuration of a kernel on a device.
+     *
+     *  \param[in] kernel the kernel.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \param[out] config the configuration. It's left untouched if there is none.
+     *  \return True if there is a configuration.
+     */
+    bool getTunedConfig (const cl::Kernel &kernel, const cl::Device &device, WorkGroupConfig &config);
+
+
+    /*! \brief Sets the launch configuration of a kernel on a device.
+     *  \details The configuration applies to the instances constructed after the call. 
+     *           It's only kept in memory, until `storeTunedConfigs` is called.
+     *
+     *  \param[in] kernelName name of the kernel function.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \param[in] config the configuration.
+     */
+    void setTunedConfig (const std::string &kernelName, const cl::Device &device, const WorkGroupConfig &config);
+
+
+    /*! \brief Removes the launch configuration of a kernel on a device.
+     *
+     *  \param[in] kernelName name of the kernel function.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     */
+    void clearTunedConfig (const std::string &kernelName, const cl::Device &device);
+
+
+    /*! \brief Returns whether there are any tuned launch configurations for a device. */
+    bool hasTunedConfigs (const cl::Device &device);
+
+
+    /*! \brief Stores the launch configurations of a device in the tuning directory.
+     *  \note Like the program cache, the file is written under a temporary name and 
+     *        then renamed, so concurrent processes never see a partially written file.
+     *
+     *  \param[in] device the device.
+     *  \return True on success.
+     */
+    bool storeTunedConfigs (const cl::Device &device);
+
+}
+}
+
+#endif  // ICP_PROGRAM_CACHE_HPP
@@ -0,0 +1,138 @@
+/*! \file scheduler.hpp
+ *  \brief Declares a scheduler that distributes %ICP registrations across OpenCL devices.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_SCHEDULER_HPP
+#define ICP_SCHEDULER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <CLUtils.hpp>
+#include <ICP/algorithms.hpp>
+#include <ICP/staging_pool.hpp>
+#include <eigen3/Eigen/Dense>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief The outcome of a registration performed by an `ICPScheduler`. */
+    struct ICPSchedulerResult
+    {
+        Eigen::Quaternionf q;   /*!< Estimated rotation, given in quaternion representation. */
+        Eigen::Vector3f t;      /*!< Estimated translation, given as a vector in 3-D. */
+        cl_float s;             /*!< Estimated scale. */
+        unsigned int k;         /*!< Number of iterations performed. */
+        unsigned int pipeline;  /*!< Index of the pipeline that performed the registration. */
+        double time;            /*!< Duration (in ms) of the registration on its pipeline, from 
+                                 *   the upload of the landmarks to the readback of the result. */
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+
+    /*! \brief Distributes %ICP registrations across multiple devices, or queues.
+     *  \details Sets up one `ICP<CR, CW>` pipeline per pair of `CLEnvInfo` configurations, 
+     *           each with its own staging pool, and one worker thread per pipeline. 
+     *           `submit` copies a pair of landmark sets into a shared work queue, and 
+     *           returns immediately. Every worker takes the next pending pair, as soon 
+     *           as its pipeline is done with the previous one, so the pairs are balanced 
+     *           across the pipelines even when they don't converge in the same number 
+     *           of iterations. `collect` waits for the submitted pairs, and returns 
+     *           their results in submission order.
+     *  \note Every registration starts from the identity transformation.
+     *  \note A worker only touches its own pipeline, and every pipeline only uses the 
+     *        queues given in its `CLEnvInfo` configurations. For the pipelines to run 
+     *        concurrently, they should be given different queues, ideally on different 
+     *        devices. The programs have to be built for all the devices in use.
+     *  \note `submit` and `collect` should be called from a single thread.
+     *  
+     *  \tparam CR configures the pipelines with different methods of rotation computation.
+     *  \tparam CW configures the pipelines for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPScheduler
+    {
+    public:
+        /*! \brief Configures one OpenCL environment per pipeline, as specified by `_infoRBC` and `_infoICP`. */
+        ICPScheduler (clutils::CLEnv &_env, const std::vector< clutils::CLEnvInfo<1> > &_infoRBC, 
+                      const std::vector< clutils::CLEnvInfo<1> > &_infoICP);
+        /*! \brief Waits for the pending registrations, and stops the workers. */
+        ~ICPScheduler ();
+        /*! \brief Configures the pipelines, and starts the workers. */
+        void init (unsigned int _m, unsigned int _nr, float _a = 1e2f, float _c = 1e-6f, 
+            unsigned int _max_iterations = 40, double _angle_threshold = 0.001,
+            double _translation_threshold = 0.01);
+        /*! \brief Queues a pair of landmark sets for registration. */
+        size_t submit (const cl_float *fixed, const cl_float *moving);
+        /*! \brief Waits for the submitted registrations, and returns their results. */
+        std::vector< ICPSchedulerResult, Eigen::aligned_allocator<ICPSchedulerResult> > collect ();
+        /*! \brief Returns the number of pipelines. */
+        size_t pipelines ();
+        /*! \brief Gets the number of iterations enqueued between convergence checks. */
+        unsigned int getBatchSize ();
+        /*! \brief Sets the number of iterations enqueued between convergence checks, on every pipeline. */
+        void setBatchSize (unsigned int _batch_size);
+
+    private:
+        /*! \brief A pair of landmark sets waiting for registration. */
+        struct Job
+        {
+            size_t id;
+            std::vector<cl_float> fixed, moving;
+        };
+
+        /*! \brief Registers pairs of landmark sets on a pipeline, until the scheduler stops. */
+        void work (unsigned int p);
+
+        clutils::CLEnv &env;
+        std::vector< clutils::CLEnvInfo<1> > infoRBC, infoICP;
+        std::vector< std::unique_ptr<StagingPool> > pools;
+        std::vector< ICP<CR, CW>, Eigen::aligned_allocator< ICP<CR, CW> > > regs;
+        std::vector<std::thread> workers;
+
+        std::deque<Job> jobs;
+        std::vector< ICPSchedulerResult, Eigen::aligned_allocator<ICPSchedulerResult> > results;
+        size_t first, done;
+        bool quit;
+        std::mutex mutex;
+        std::condition_variable cvJobs, cvDone;
+
+        unsigned int m, d;
+
+    };
+
+}
+}
+
+#endif  // ICP_SCHEDULER_HPP
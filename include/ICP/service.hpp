@@ -0,0 +1,151 @@
+/*! \file service.hpp
+ *  \brief Declares a service that runs concurrent %ICP sessions on a shared OpenCL environment.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_SERVICE_HPP
+#define ICP_SERVICE_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <CLUtils.hpp>
+#include <ICP/algorithms.hpp>
+#include <ICP/scheduler.hpp>
+#include <ICP/staging_pool.hpp>
+#include <eigen3/Eigen/Dense>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPService;
+
+
+    /*! \brief A registration stream served by an `ICPService`.
+     *  \details Owns a command queue, a staging pool, an `ICP<CR, CW>` pipeline with 
+     *           all of its buffers, and a pose. Every registration starts from the pose, 
+     *           and updates it with its estimate, so consecutive pairs of a stream get 
+     *           the previous transformation as their initial guess.
+     *  \note The sessions of a service can be driven concurrently, from separate host 
+     *        threads. The calls on a single session are serialized.
+     *  \note A session has to be destroyed before its service.
+     *  
+     *  \tparam CR configures the pipeline with different methods of rotation computation.
+     *  \tparam CW configures the pipeline for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPSession
+    {
+    public:
+        /*! \brief Waits for the pending commands, and returns the queue to the service. */
+        ~ICPSession ();
+        /*! \brief Registers a pair of landmark sets. */
+        ICPSchedulerResult align (const cl_float *fixed, const cl_float *moving);
+        /*! \brief Resets the pose to the identity transformation. */
+        void reset ();
+        /*! \brief Gets the pose. */
+        ICPSchedulerResult getPose ();
+        /*! \brief Sets the pose. */
+        void setPose (const Eigen::Quaternionf &_q, const Eigen::Vector3f &_t, cl_float _s = 1.f);
+        /*! \brief Returns the index of the command queue of the session. */
+        unsigned int index ();
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        friend class ICPService<CR, CW>;
+
+        /*! \brief Sets up a pipeline on queue `_qIdx` of the service's context. */
+        ICPSession (ICPService<CR, CW> &_service, unsigned int _qIdx, unsigned int _m, unsigned int _nr, 
+                    float _a, float _c, unsigned int _max_iterations, double _angle_threshold, 
+                    double _translation_threshold);
+
+        ICPService<CR, CW> &service;
+        unsigned int qIdx;
+        cl::CommandQueue queue;
+        StagingPool pool;
+        ICP<CR, CW> reg;
+        Eigen::Quaternionf q;
+        Eigen::Vector3f t;
+        cl_float s;
+        double time;
+        unsigned int k, m, d;
+        std::mutex mutex;
+
+    };
+
+
+    /*! \brief Serves many concurrent %ICP registration streams from one OpenCL environment.
+     *  \details Creates a context on a device, and builds the `RBC` and `%ICP` programs once, 
+     *           through `addProgramCached`. Every session that `open` hands out shares them, 
+     *           but gets its own command queue, buffers and pose. So, one device can multiplex 
+     *           many low-rate streams, without a context and a compilation per stream. The 
+     *           queues of closed sessions are reused by the sessions opened after them.
+     *  \note `open` can be called from any thread. It's serialized with the other calls 
+     *        to `open` and with the destruction of the sessions, since they modify the environment.
+     *  
+     *  \tparam CR configures the sessions with different methods of rotation computation.
+     *  \tparam CW configures the sessions for performing either regular or weighted computation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    class ICPService
+    {
+    public:
+        /*! \brief Creates the context, and builds the programs. */
+        ICPService (const std::vector<std::string> &kernel_files_rbc, 
+                    const std::vector<std::string> &kernel_files_icp, unsigned int _dIdx = 0);
+        /*! \brief Opens a registration session. */
+        std::unique_ptr< ICPSession<CR, CW> > open (unsigned int _m, unsigned int _nr, float _a = 1e2f, 
+            float _c = 1e-6f, unsigned int _max_iterations = 40, double _angle_threshold = 0.001, 
+            double _translation_threshold = 0.01);
+        /*! \brief Returns the number of open sessions. */
+        size_t sessions ();
+        /*! \brief Returns a reference to the OpenCL environment. */
+        clutils::CLEnv& getEnv ();
+
+    private:
+        friend class ICPSession<CR, CW>;
+
+        /*! \brief Returns the queue of a closed session to the service. */
+        void release (unsigned int qIdx);
+
+        clutils::CLEnv env;
+        unsigned int dIdx;
+        unsigned int nQueues;
+        std::vector<unsigned int> freeQueues;
+        std::mutex mutex;
+
+    };
+
+}
+}
+
+#endif  // ICP_SERVICE_HPP
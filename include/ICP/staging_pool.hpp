@@ -0,0 +1,154 @@
+/*! \file staging_pool.hpp
+ *  \brief Declares a pool of pinned host memory for the staging buffers of the `cl_algo::ICP` classes.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_STAGING_POOL_HPP
+#define ICP_STAGING_POOL_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <CLUtils.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief A pool of pinned host memory for staging buffers.
+     *  \details The staging buffers are sub-buffers of a few large 
+     *           `CL_MEM_ALLOC_HOST_PTR` slabs, instead of separate pinned 
+     *           allocations. A class that is handed a pool, allocates its 
+     *           staging buffers from it in `init`. A repeated `init` with 
+     *           the same sizes keeps the same blocks, while a change in size 
+     *           returns the previous block to the pool and takes a new one. 
+     *           Freed blocks are reused, and merged with their free neighbors.
+     *  \note The pool has to outlive the classes that allocate from it. 
+     *        The slabs are freed along with the pool.
+     *  \note A block is returned to the pool by `release`, by a resizing 
+     *        `acquire`, or when the class that allocated it is destroyed. 
+     *        If the buffer is still shared with another class at that point, 
+     *        the two will alias the new owner's memory.
+     *  \note The calls are thread-safe.
+     */
+    class StagingPool
+    {
+    public:
+        /*! \brief Sets up an empty pool. */
+        StagingPool (const cl::Context &_context, const cl::Device &device, size_t _slabSize = 1 << 24);
+        /*! \brief Allocates a staging buffer. */
+        cl::Buffer allocate (size_t size);
+        /*! \brief Returns a staging buffer to the pool. */
+        void release (const cl::Buffer &buffer);
+        /*! \brief Makes sure that a buffer is a staging buffer of the given size. */
+        void acquire (cl::Buffer &buffer, size_t size);
+        /*! \brief Returns the number of slabs. */
+        size_t slabs ();
+        /*! \brief Returns the total size (in bytes) of the slabs. */
+        size_t capacity ();
+        /*! \brief Returns the size (in bytes) of the allocated blocks. */
+        size_t used ();
+
+    private:
+        /*! \brief Rounds a size up to a multiple of `alignment`. */
+        size_t align (size_t size) const;
+
+        /*! \brief A region of a slab. */
+        struct Block
+        {
+            size_t slab;
+            size_t offset;
+            size_t size;
+        };
+
+        cl::Context context;
+        size_t alignment, slabSize, total;
+        std::vector<cl::Buffer> slabBuffers;
+        std::vector<std::vector<Block>> freeBlocks;
+        std::map<cl_mem, Block> blocks;
+        std::mutex mutex;
+
+    };
+
+
+    /*! \brief Keeps track of the staging blocks that a class holds, 
+     *         and returns them to their pool on destruction.
+     *  \details Each class that allocates from a pool, has a lease as a member, 
+     *           so its blocks are released along with it. Copies of a class 
+     *           share the blocks, as they share the buffers, and the blocks 
+     *           are released along with the last of them. A move transfers them.
+     */
+    class StagingLease
+    {
+    public:
+        /*! \brief Records the block that a buffer holds, in place of a previous one. */
+        void track (StagingPool *pool, const cl::Buffer &buffer, cl_mem previous);
+
+    private:
+        /*! \brief The blocks of a lease, released on destruction. */
+        struct Blocks
+        {
+            ~Blocks ();
+            StagingPool *pool;
+            std::vector<cl::Buffer> buffers;
+        };
+
+        std::shared_ptr<Blocks> blocks;
+
+    };
+
+
+    /*! \brief Sets up a staging buffer of the given size.
+     *  \details Allocates the buffer from `pool`, and records it in `lease`. 
+     *           Without a pool, it keeps the previous behavior, and creates 
+     *           a separate pinned buffer, unless one is already assigned.
+     *
+     *  \param[in,out] buffer the staging buffer.
+     *  \param[in] size size (in bytes) of the buffer.
+     *  \param[in] context context in which to create the buffer, if there is no pool.
+     *  \param[in] pool pool to allocate the buffer from, or `nullptr`.
+     *  \param[in,out] lease the lease of the class that holds the buffer.
+     */
+    inline void allocStaging (cl::Buffer &buffer, size_t size, const cl::Context &context, 
+                              StagingPool *pool, StagingLease &lease)
+    {
+        if (pool != nullptr)
+        {
+            cl_mem previous = buffer ();
+            pool->acquire (buffer, size);
+            lease.track (pool, buffer, previous);
+        }
+        else if (buffer () == nullptr)
+            buffer = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, size);
+    }
+
+}
+}
+
+#endif  // ICP_STAGING_POOL_HPP
@@ -30,9 +30,12 @@
 #define ICP_HELPERFUNCS_HPP
 
 #include <cassert>
+#include <vector>
+#include <limits>
 #include <algorithm>
 #include <functional>
 #include <RBC/data_types.hpp>
+#include <CLUtils.hpp>
 
 #if defined(__APPLE__) || defined(__MACOSX)
 #include <OpenCL/cl.hpp>
@@ -209,59 +212,262 @@ namespace ICP
     }
 
 
-    /*! \brief Samples a point cloud for 16384 (128x128) landmarks.
+    /*! \brief Back-projects raw depth and RGB frames into an 8-D point cloud.
+     *  \details It is just a naive serial implementation.
+     *
+     *  \param[in] depth depth frame (in mm).
+     *  \param[in] rgb RGB frame, 3 channels per pixel.
+     *  \param[out] out output (point cloud) data.
+     *  \param[in] width number of pixels per row in the frames.
+     *  \param[in] height number of pixels per column in the frames.
+     *  \param[in] fx focal length along the x axis.
+     *  \param[in] fy focal length along the y axis.
+     *  \param[in] cx x coordinate of the principal point.
+     *  \param[in] cy y coordinate of the principal point.
+     */
+    inline void cpuICPBackProject (const cl_ushort *depth, const cl_uchar *rgb, cl_float *out, 
+                                   uint32_t width, uint32_t height, float fx, float fy, float cx, float cy)
+    {
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint32_t p = y * width + x;
+
+                float d = depth[p];
+                out[8 * p + 0] = (x - cx) * d / fx;
+                out[8 * p + 1] = (y - cy) * d / fy;
+                out[8 * p + 2] = d;
+                out[8 * p + 3] = 1.f;
+
+                for (uint32_t k = 0; k < 3; ++k)
+                    out[8 * p + 4 + k] = rgb[3 * p + k] / 255.f;
+                out[8 * p + 7] = 1.f;
+            }
+        }
+    }
+
+
+    /*! \brief Estimates the surface normals of an organized point cloud.
+     *  \details It is just a naive serial implementation.
+     *
+     *  \param[in] in input (point cloud) data.
+     *  \param[out] normals output (normal map) data.
+     *  \param[in] width number of points per row in the point cloud.
+     *  \param[in] height number of points per column in the point cloud.
+     *  \param[in] max_dz maximum difference in depth between the neighbors
+     *                    of a point, relative to its depth.
+     */
+    inline void cpuICPNormals (const cl_float *in, cl_float *normals, 
+                               uint32_t width, uint32_t height, float max_dz)
+    {
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint32_t p = y * width + x;
+                for (uint32_t k = 0; k < 4; ++k)
+                    normals[4 * p + k] = 0.f;
+
+                if (x == 0 || y == 0 || x == width - 1 || y == height - 1)
+                    continue;
+
+                const cl_float *c = in + 8 * p;
+                const cl_float *l = in + 8 * (p - 1), *r = in + 8 * (p + 1);
+                const cl_float *u = in + 8 * (p - width), *d = in + 8 * (p + width);
+
+                float dz = max_dz * c[2];
+                if (c[2] <= 0.f || l[2] <= 0.f || r[2] <= 0.f || u[2] <= 0.f || d[2] <= 0.f || 
+                    std::abs (r[2] - l[2]) >= dz || std::abs (d[2] - u[2]) >= dz)
+                    continue;
+
+                float dx[3], dy[3], n[3];
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    dx[k] = r[k] - l[k];
+                    dy[k] = d[k] - u[k];
+                }
+                n[0] = dx[1] * dy[2] - dx[2] * dy[1];
+                n[1] = dx[2] * dy[0] - dx[0] * dy[2];
+                n[2] = dx[0] * dy[1] - dx[1] * dy[0];
+
+                float len = std::sqrt (n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                if (len == 0.f)
+                    continue;
+
+                float sign = (n[0] * c[0] + n[1] * c[1] + n[2] * c[2] > 0.f) ? -1.f : 1.f;
+                for (uint32_t k = 0; k < 3; ++k)
+                    normals[4 * p + k] = sign * n[k] / len;
+            }
+        }
+    }
+
+
+    /*! \brief Produces a set of random 8-D points for the registration tests.
+     *  \details The coordinates are sampled in \f$[0, 1000)\f$, the homogeneous 
+     *           coordinate is set to `1`, and the color channels are sampled 
+     *           in \f$[0, 1)\f$.
+     *
+     *  \param[out] pc output points.
+     *  \param[in] n number of points.
+     */
+    void randomLMs (cl_float *pc, uint32_t n);
+
+
+    /*! \brief Moves a set of 8-D points by a rotation around the z axis and a translation.
+     *  \details The default motion is the one that the registration tests recover. 
+     *           The homogeneous coordinate and the color channels are copied.
+     *
+     *  \param[in] in input points.
+     *  \param[out] out output points.
+     *  \param[in] n number of points.
+     *  \param[in] angle rotation angle in radians.
+     *  \param[in] tx translation along the x axis.
+     *  \param[in] ty translation along the y axis.
+     *  \param[in] tz translation along the z axis.
+     */
+    void moveLMs (const cl_float *in, cl_float *out, uint32_t n, float angle = 0.02f, 
+                  float tx = 5.f, float ty = -3.f, float tz = 2.f);
+
+
+    /*! \brief Produces the pair of landmark sets that the registration tests align.
+     *  \details The fixed set comes from `randomLMs`, and the moving set 
+     *           is the fixed set moved by the default motion of `moveLMs`.
+     *
+     *  \param[out] fixed fixed set.
+     *  \param[out] moving moving set.
+     *  \param[in] n number of points in each set.
+     */
+    void registrationPair (std::vector<cl_float> &fixed, std::vector<cl_float> &moving, uint32_t n);
+
+
+    /*! \brief Sets up the OpenCL environment for the registration tests.
+     *  \details Adds context `0` with `queues` queues that have profiling enabled. 
+     *           Program `0` holds the `RBC` kernels, and program `1` holds 
+     *           the given `%ICP` kernels.
+     *
+     *  \param[in] clEnv OpenCL environment.
+     *  \param[in] kernels filenames of the `%ICP` kernels.
+     *  \param[in] queues number of queues to add.
+     */
+    inline void registrationEnv (clutils::CLEnv &clEnv, const std::vector<std::string> &kernels, 
+                                 unsigned int queues = 1)
+    {
+        clEnv.addContext (0);
+        for (unsigned int i = 0; i < queues; ++i)
+            clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, { "kernels/RBC/reduce_kernels.cl", 
+                               "kernels/RBC/scan_kernels.cl", 
+                               "kernels/RBC/rbc_kernels.cl" });
+        clEnv.addProgram (0, kernels);
+    }
+
+
+    /*! \brief Samples a point cloud for landmarks (e.g. 16384 (128x128) landmarks).
      *  \details It is just a naive serial implementation.
      *
      *  \tparam T type of the data to be handled.
      *  \param[in] in input data.
      *  \param[out] out output (LM) data.
+     *  \param[in] width number of points per row in the point cloud.
+     *  \param[in] height number of points per column in the point cloud.
+     *  \param[in] m number of landmarks. It has to be a power of 2.
      */
     template <typename T>
-    void cpuICPLMs (T *in, T *out)
+    void cpuICPLMs (T *in, T *out, uint32_t width = 640, uint32_t height = 480, uint32_t m = 16384)
     {
-        for (uint32_t gY = 0; gY < 128; ++gY)
+        int p = std::log2 (m);
+        uint32_t lx = std::pow (2, p - p / 2);
+        uint32_t ly = std::pow (2, p / 2);
+
+        uint32_t x0 = width / 10, y0 = height / 10;
+        uint32_t w = width - 2 * x0, h = height - 2 * y0;
+        uint32_t offsetX = ((w / lx) - 1) / 2;
+        uint32_t offsetY = ((h / ly) - 1) / 2;
+
+        for (uint32_t gY = 0; gY < ly; ++gY)
         {
-            uint32_t yi = gY * 3 + 1;
+            uint32_t yi = y0 + (gY * h) / ly + offsetY;
 
-            for (uint32_t gX = 0; gX < 128 * 8; gX += 8)
+            for (uint32_t gX = 0; gX < lx; ++gX)
             {
-                uint32_t xi = gX * 4 + 1 * 8;
+                uint32_t xi = x0 + (gX * w) / lx + offsetX;
 
                 for (uint32_t k = 0; k < 8; ++k)
-                    out[gY * (128 * 8) + gX + k] = in[(48 + yi) * (640 * 8) + ((64 * 8) + xi) + k];
+                    out[(gY * lx + gX) * 8 + k] = in[(yi * width + xi) * 8 + k];
+            }
+        }
+    }
+
+
+    /*! \brief Samples the valid (non-zero depth) points of a point cloud for landmarks.
+     *  \details It is just a naive serial implementation.
+     *
+     *  \tparam T type of the data to be handled.
+     *  \param[in] in input data.
+     *  \param[out] out output (LM) data.
+     *  \param[in] width number of points per row in the point cloud.
+     *  \param[in] height number of points per column in the point cloud.
+     *  \param[in] m number of landmarks.
+     */
+    template <typename T>
+    void cpuICPLMsCompact (T *in, T *out, uint32_t width = 640, uint32_t height = 480, uint32_t m = 16384)
+    {
+        uint32_t x0 = width / 10, y0 = height / 10;
+        uint32_t w = width - 2 * x0, h = height - 2 * y0;
+
+        std::vector<uint32_t> valid;
+        for (uint32_t y = y0; y < y0 + h; ++y)
+            for (uint32_t x = x0; x < x0 + w; ++x)
+                if (in[(y * width + x) * 8 + 2] != 0)
+                    valid.push_back (y * width + x);
+
+        uint64_t count = valid.size ();
+
+        for (uint32_t i = 0; i < m; ++i)
+        {
+            for (uint32_t k = 0; k < 8; ++k)
+            {
+                if (count == 0) out[i * 8 + k] = 0;
+                else out[i * 8 + k] = in[valid[(i * count) / m] * 8 + k];
             }
         }
     }
 
 
-    /*! \brief Samples a set of 16384 (128x128) landmarks for representatives.
+    /*! \brief Samples a set of landmarks (e.g. 16384 (128x128) landmarks) for representatives.
      *  \details It is just a naive serial implementation.
      *
      *  \tparam T type of the data to be handled.
      *  \param[in] in input data.
      *  \param[out] out output (LM) data.
      *  \param[in] nr number of representatives.
+     *  \param[in] m number of landmarks. It has to be a power of 2.
      */
     template <typename T>
-    void cpuICPReps (T *in, T *out, uint32_t nr)
+    void cpuICPReps (T *in, T *out, uint32_t nr, uint32_t m = 16384)
     {
         int p = std::log2 (nr);
         uint32_t nrx = std::pow (2, p - p / 2);
         uint32_t nry = std::pow (2, p / 2);
 
-        uint stepX = 128 / nrx;
-        uint stepY = 128 / nry;
+        p = std::log2 (m);
+        uint32_t lx = std::pow (2, p - p / 2);
+        uint32_t ly = std::pow (2, p / 2);
+
+        uint stepX = lx / nrx;
+        uint stepY = ly / nry;
 
         for (uint32_t gY = 0; gY < nry; ++gY)
         {
-            uint32_t yi = gY * stepY + (stepY >> 1) - 1;
+            uint32_t yi = gY * stepY + std::max (stepY >> 1, 1U) - 1;
 
             for (uint32_t gX = 0; gX < nrx * 8; gX += 8)
             {
-                uint32_t xi = gX * stepX + ((stepX >> 1) - 1) * 8;
+                uint32_t xi = gX * stepX + (std::max (stepX >> 1, 1U) - 1) * 8;
 
                 for (uint32_t k = 0; k < 8; ++k)
-                    out[gY * (nrx * 8) + gX + k] = in[yi * (128 * 8) + xi + k];
+                    out[gY * (nrx * 8) + gX + k] = in[yi * (lx * 8) + xi + k];
             }
         }
     }
@@ -509,6 +715,108 @@ namespace ICP
     }
 
 
+    /*! \brief Performs a homogeneous transformation on the geometry stream 
+     *         of a set of points using a quaternion and a translation vector.
+     *  \details It is just a naive serial implementation.
+     *
+     *  \tparam T type of the data to be handled.
+     *  \param[in] M input array (geometry stream) of 4-D elements.
+     *  \param[out] tM output array (transformed geometry stream) of 4-D elements.
+     *  \param[in] D transformation parameters.
+     *  \param[in] m number of points in the set.
+     */
+    template <typename T>
+    void cpuICPTransformQSoA (T *M, T *tM, T *D, uint32_t m)
+    {
+        std::vector<T> M8 (8 * m), tM8 (8 * m);
+        for (uint32_t i = 0; i < m; ++i)
+            std::copy (M + i * 4, M + (i + 1) * 4, M8.data () + i * 8);
+
+        cpuICPTransformQ (M8.data (), tM8.data (), D, m);
+
+        for (uint32_t i = 0; i < m; ++i)
+            std::copy (tM8.data () + i * 8, tM8.data () + i * 8 + 4, tM + i * 4);
+    }
+
+
+    /*! \brief Splits a set of 8-D points into a geometry stream and a normalized color stream.
+     *  \details It is just a naive serial implementation.
+     *
+     *  \param[in] in input array (set of points) of 8-D elements.
+     *  \param[out] geom output array (geometry stream) of 4-D elements.
+     *  \param[out] color output array (color stream) of 4-D elements.
+     *  \param[in] m number of points in the set.
+     */
+    inline void cpuICPSplit (cl_float *in, cl_float *geom, cl_uchar *color, uint32_t m)
+    {
+        for (uint32_t i = 0; i < m; ++i)
+        {
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                geom[i * 4 + k] = in[i * 8 + k];
+
+                float c = std::rint (in[i * 8 + 4 + k] * 255.f);
+                color[i * 4 + k] = (cl_uchar) std::min (std::max (c, 0.f), 255.f);
+            }
+        }
+    }
+
+
+    /*! \brief Computes the photogeometric distance between two 8-D points, 
+     *         \f$ \|x_g-x'_g\|_2^2+a\|x_p-x'_p\|_2^2 \f$.
+     *
+     *  \tparam T type of the data to be handled.
+     *  \param[in] x first point.
+     *  \param[in] y second point.
+     *  \param[in] a weight of the photometric dimensions.
+     *  \return The distance between the points.
+     */
+    template <typename T>
+    T cpuDistPhotogeometric (T *x, T *y, T a)
+    {
+        T dg = 0, dp = 0;
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            dg += (x[k] - y[k]) * (x[k] - y[k]);
+            dp += (x[4 + k] - y[4 + k]) * (x[4 + k] - y[4 + k]);
+        }
+
+        return dg + a * dp;
+    }
+
+
+    /*! \brief Finds the nearest neighbors of a set of queries under the photogeometric distance.
+     *  \details It is just a naive serial (brute force) implementation. The distance 
+     *           between two 8-D points is \f$ \|x_g-x'_g\|_2^2+a\|x_p-x'_p\|_2^2 \f$, 
+     *           where \f$ x_g \f$ are the xyz and \f$ x_p \f$ the rgb dimensions.
+     *
+     *  \tparam T type of the data to be handled.
+     *  \param[in] Q input array (queries) of 8-D elements.
+     *  \param[in] X input array (database) of 8-D elements.
+     *  \param[out] NN indices of the nearest neighbors in `X`.
+     *  \param[in] nq number of queries.
+     *  \param[in] nx number of database points.
+     *  \param[in] a weight of the photometric dimensions.
+     */
+    template <typename T>
+    void cpuNNPhotogeometric (T *Q, T *X, uint32_t *NN, uint32_t nq, uint32_t nx, T a)
+    {
+        for (uint32_t i = 0; i < nq; ++i)
+        {
+            T minDist = std::numeric_limits<T>::max ();
+            for (uint32_t j = 0; j < nx; ++j)
+            {
+                T dist = cpuDistPhotogeometric (Q + i * 8, X + j * 8, a);
+                if (dist < minDist)
+                {
+                    minDist = dist;
+                    NN[i] = j;
+                }
+            }
+        }
+    }
+
+
     /*! \brief Performs a homogeneous transformation on a set of points using 
      *         a quaternion and a translation vector.
      *  \details It is just a naive serial implementation.
@@ -763,6 +1071,55 @@ namespace ICP
         std::copy (tk, tk + 4, Tk + 4);
     }
 
+
+    /*! \brief Updates the transformation estimation with the incremental development 
+     *         of iteration `k`, and checks for convergence.
+     *  \details It is just a naive serial implementation.
+     *
+     *  \tparam T type of the data to be handled.
+     *  \param[in] Tk incremental transformation parameters, \f$ (\dot{q}_k,t_k,s_k) \f$.
+     *  \param[in,out] D transformation parameters, \f$ (\dot{q},t,s) \f$.
+     *  \param[in,out] C convergence flag and number of iterations.
+     *  \param[in] angle_threshold threshold for the change in angle (in degrees).
+     *  \param[in] translation_threshold threshold for the change in translation (in mm).
+     */
+    template <typename T>
+    void cpuICPUpdateTransform (T *Tk, T *D, cl_uint *C, T angle_threshold, T translation_threshold)
+    {
+        if (C[0]) return;
+
+        T qk[4] = { Tk[0], Tk[1], Tk[2], Tk[3] };
+        T q[4] = { D[0], D[1], D[2], D[3] };
+
+        // q = qk * q
+        T cp[3]; cross_product (qk, q, cp);
+        T q_new[4] = 
+        {
+            qk[3] * q[0] + q[3] * qk[0] + cp[0], 
+            qk[3] * q[1] + q[3] * qk[1] + cp[1], 
+            qk[3] * q[2] + q[3] * qk[2] + cp[2], 
+            qk[3] * q[3] - std::inner_product (qk, qk + 3, q, 0.f)
+        };
+        cpuNormalize (q_new);
+
+        // t = sk * Rk * t + tk
+        T tp[8] = { D[4], D[5], D[6], 1.f, 0.f, 0.f, 0.f, 0.f };
+        T ttp[8];
+        cpuICPTransformQ (tp, ttp, Tk, 1);
+
+        std::copy (q_new, q_new + 4, D);
+        D[4] = ttp[0]; D[5] = ttp[1]; D[6] = ttp[2];
+        D[7] = Tk[7] * D[7];
+
+        T delta_angle = 180.0 / M_PI * 2.0 * std::atan2 (
+            std::sqrt (qk[0] * qk[0] + qk[1] * qk[1] + qk[2] * qk[2]), qk[3]);
+        T delta_translation = std::sqrt (Tk[4] * Tk[4] + Tk[5] * Tk[5] + Tk[6] * Tk[6]);
+
+        C[1] += 1;
+        if (delta_angle < angle_threshold && delta_translation < translation_threshold)
+            C[0] = 1;
+    }
+
 }
 
 #endif  // ICP_HELPERFUNCS_HPP
@@ -0,0 +1,246 @@
+/*! \file tiled.hpp
+ *  \brief Declares an out-of-core %ICP pipeline for point clouds larger than device memory.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_TILED_HPP
+#define ICP_TILED_HPP
+
+#include <vector>
+#include <CLUtils.hpp>
+#include <ICP/algorithms.hpp>
+#include <ICP/staging_pool.hpp>
+#include <eigen3/Eigen/Dense>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Interface class for an out-of-core `%ICP` pipeline, for point 
+     *         clouds that don't fit in device memory.
+     *  \details Registers a moving set of `n` points to a fixed set of `N` points, 
+     *           while only ever holding `m` of them on the device. The fixed set is 
+     *           partitioned into tiles of at most `m` points with a kd-tree, that 
+     *           splits on the median of the longest axis. In every iteration, the 
+     *           moving points are transformed by the current estimate on the host, 
+     *           and are assigned to the tile whose cell contains them. Then, the tiles 
+     *           are streamed through the device one after the other, in chunks of at 
+     *           most `m` moving points. For each tile, the `RBC` data structure is built, 
+     *           the chunks are searched against it, and `ICPS<ICPSConfig::FUSED>` produces 
+     *           the `S` matrix and the means of every chunk. The partial results are 
+     *           combined on the host, in double precision, with the parallel-axis identity, 
+     *           \f$ S = \sum_t{S_t + n_t(\bar{m}_t-\bar{m})(\bar{f}_t-\bar{f})^T} \f$, 
+     *           and the rotation is solved with `Eigen::JacobiSVD`, like in 
+     *           `ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>`.
+     *  \note The uploads are double buffered. While a chunk gets processed, the next 
+     *        one is packed into the second half of the staging buffers and written 
+     *        to the device on the queue of `_infoIO`. For the transfers to overlap 
+     *        with the computation, that has to be a different queue than the one 
+     *        of `_infoICP`.
+     *  \note The correspondences are searched for only within a tile. A moving point 
+     *        close to the border of a cell may have its nearest neighbor in the next 
+     *        tile, and get matched to a worse one. With tiles much larger than the 
+     *        misalignment, the effect on the estimated transformation is small.
+     *  \note Only one tile resides on the device at a time. So, the `RBC` data structure 
+     *        of every tile is built again in every iteration, right after the tile gets 
+     *        uploaded. An iteration costs `tiles ()` builds, on top of the searches.
+     *  \note The tiles and the chunks that have fewer than `m` points get padded. 
+     *        The fixed tiles repeat their own points, and the moving chunks carry 
+     *        points with a zero homogeneous coordinate, which `icpValidWeights` 
+     *        excludes from the sums.
+     *  \note The point clouds stay on the host, in the arrays given to `setFixed` 
+     *        and `setMoving`. They are not copied, so they have to outlive the 
+     *        registration.
+     *  \note The class creates its own buffers. If you would like to provide 
+     *        your own buffers, call `get` to get references to the placeholders 
+     *        within the class and assign them to your buffers. You will have to 
+     *        do this strictly before the call to `init`.
+     *  
+     *        The following input/output `OpenCL` memory objects are created 
+     *        by an `ICPTiled` instance:<br>
+     *        |  Name  | Type | Placement | I/O | Use | Properties | Size |
+     *        |  ---   |:---: |   :---:   |:---:|:---:|   :---:    |:---: |
+     *        | H_IN_F | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*m*sizeof\ (cl\_float8)\f$ |
+     *        | H_IN_M | Buffer | Host   | I | Staging     | CL_MEM_READ_WRITE | \f$2*m*sizeof\ (cl\_float8)\f$ |
+     *        | H_IO_T | Buffer | Host   | IO| Staging     | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$   |
+     *        | D_UP_F | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*m*sizeof\ (cl\_float8)\f$ |
+     *        | D_UP_M | Buffer | Device | I | Processing  | CL_MEM_READ_ONLY  | \f$2*m*sizeof\ (cl\_float8)\f$ |
+     *        | D_IN_F | Buffer | Device | I | Processing  | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$   |
+     *        | D_IN_M | Buffer | Device | I | Processing  | CL_MEM_READ_WRITE | \f$m*sizeof\ (cl\_float8)\f$   |
+     *        | D_IO_T | Buffer | Device | IO| Processing  | CL_MEM_READ_WRITE | \f$2*sizeof\ (cl\_float4)\f$   |
+     */
+    class ICPTiled
+    {
+    public:
+        /*! \brief Enumerates the memory objects handled by the class.
+         *  \note `H_*` names refer to staging buffers on the host.
+         *  \note `D_*` names refer to buffers on the device.
+         */
+        enum class Memory : uint8_t
+        {
+            H_IN_F,  /*!< Input staging buffer for two tiles of the fixed set. */
+            H_IN_M,  /*!< Input staging buffer for two chunks of the moving set. */
+            H_IO_T,  /*!< Input-output staging buffer for the quaternion and the translation vector. 
+                      *   It has the same layout as in `ICPStep`. */
+            D_UP_F,  /*!< Input buffer for the uploads of two tiles of the fixed set. */
+            D_UP_M,  /*!< Input buffer for the uploads of two chunks of the moving set. */
+            D_IN_F,  /*!< Input buffer for the tile of the fixed set that gets processed. */
+            D_IN_M,  /*!< Input buffer for the chunk of the moving set that gets processed. */
+            D_IO_T   /*!< Input-output buffer for the quaternion and the translation vector. 
+                      *   It has the same layout as in `ICPStep`. */
+        };
+
+        /*! \brief Configures an OpenCL environment as specified by `_info`. */
+        ICPTiled (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                  clutils::CLEnvInfo<1> _infoIO, StagingPool *_pool = nullptr);
+        /*! \brief Returns a reference to an internal memory object. */
+        cl::Memory& get (ICPTiled::Memory mem);
+        /*! \brief Configures kernel execution parameters. */
+        void init (unsigned int _m, unsigned int _nr, float _a = 1e2f, float _c = 1e-6f, 
+            unsigned int _max_iterations = 40, double _angle_threshold = 0.001,
+            double _translation_threshold = 0.01);
+        /*! \brief Partitions the fixed set into tiles. */
+        void setFixed (const cl_float *ptr, size_t n);
+        /*! \brief Associates the moving set, and resets the transformation. */
+        void setMoving (const cl_float *ptr, size_t n);
+        /*! \brief Performs one %ICP iteration over all the tiles. */
+        void step ();
+        /*! \brief Executes the iterative %ICP algorithm. */
+        void run ();
+        /*! \brief Returns the number of tiles of the fixed set. */
+        size_t tiles ();
+        /*! \brief Returns the number of chunks processed in the last iteration. */
+        size_t chunks ();
+
+        cl_float *hPtrInF;  /*!< Mapping of the input staging buffer for the fixed set of points. */
+        cl_float *hPtrInM;  /*!< Mapping of the input staging buffer for the moving set of points. */
+        cl_float *hPtrIOT;  /*!< Mapping of the input-output staging buffer for the estimated 
+                             *   quaternion and translation vector. */
+
+        /*! \brief Current iteration number.
+         *  \details Gets reset in `setMoving` with every registration. */
+        unsigned int k;
+
+        Eigen::Matrix3f Rk;     /*!< Represents the incremental development in the rotation estimation in 
+                                 *   iteration `k`, given in rotation matrix representation, \f$ R_k \f$. */
+        Eigen::Quaternionf qk;  /*!< Represents the incremental development in the rotation estimation in 
+                                 *   iteration `k`, given in quaternion representation. */
+        Eigen::Vector3f tk;     /*!< Represents the incremental development in the translation estimation 
+                                 *   in iteration `k`, given as a vector in 3-D, \f$ t_k \f$. */
+        cl_float sk;            /*!< Represents the incremental development in the scale estimation 
+                                 *   in iteration `k`, given as a scalar, \f$ s_k \f$. */
+
+        Eigen::Matrix3f R;     /*!< Represents the rotation estimation up to iteration `k`, 
+                                *   given in rotation matrix representation, \f$ R \f$. */
+        Eigen::Quaternionf q;  /*!< Represents the rotation estimation up to iteration `k`, 
+                                *   given in quaternion representation. */
+        Eigen::Vector3f t;     /*!< Represents the translation estimation up to iteration `k`, 
+                                *   given as a vector in 3-D, \f$ t \f$. */
+        cl_float s;            /*!< Represents the scale estimation up to iteration `k`,
+                                *   given as a scalar, \f$ s \f$. */
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        /*! \brief A node of the kd-tree. A leaf has a negative axis. */
+        struct Node
+        {
+            int axis;
+            cl_float split;
+            unsigned int child[2];
+            unsigned int tile;
+        };
+
+        /*! \brief A tile of the fixed set, a range in the permutation `fOrder`. */
+        struct Tile
+        {
+            size_t begin, count;
+            cl_float centroid[3];
+        };
+
+        /*! \brief A chunk of moving points, a range in the permutation `mOrder`, and its tile. */
+        struct Chunk
+        {
+            unsigned int tile;
+            size_t begin, count;
+        };
+
+        /*! \brief Returns the tile whose cell contains a point. */
+        unsigned int locate (const cl_float *p) const;
+        /*! \brief Packs a chunk into a staging slot, and writes it to the device. */
+        void upload (const Chunk &chunk, unsigned int slot, bool withTile);
+        /*! \brief Enqueues the processing of a chunk. */
+        void process (const Chunk &chunk, unsigned int slot, bool withTile);
+        /*! \brief Performs the convergence check. */
+        bool check ();
+
+        clutils::CLEnv &env;
+        clutils::CLEnvInfo<1> infoRBC, infoICP, infoIO;
+        StagingPool *pool;
+        StagingLease lease;
+        cl::Context context;
+        cl::CommandQueue queue, ioQueue;
+        cl::Kernel weightsKernel;
+        ICPReps fReps;
+        RBC::RBCConstruct
+            <RBC::KernelTypeC::KINECT_R, RBC::RBCPermuteConfig::GENERIC> rbcC;
+        ICPTransform<ICPTransformConfig::QUATERNION> transform;
+        RBC::RBCSearch
+            <RBC::KernelTypeC::KINECT_R, 
+                RBC::RBCPermuteConfig::GENERIC, RBC::KernelTypeS::KINECT> rbcS;
+        ICPS<ICPSConfig::FUSED> matrixF;
+
+        const cl_float *fixed, *moving;
+        size_t nF, nM;
+        std::vector<Node> nodes;
+        std::vector<Tile> tiles_;
+        std::vector<Chunk> chunks_;
+        std::vector<size_t> fOrder, mOrder;
+        std::vector<unsigned int> mTile;
+
+        cl::Event upEvents[2][2];
+        cl_float hShift[2][8];
+        cl_double hSumW[2];
+        std::vector<cl_float> hSums;  // S (11 floats, padded to 12) and means (8 floats) per chunk
+        std::vector<cl::Event> sumEvents;
+
+        float a, c;
+        unsigned int m, nr, d;
+        unsigned int max_iterations;
+        double angle_threshold, translation_threshold;
+        unsigned int bufferFMSize, bufferTSize;
+        cl::Buffer hBufferInF, hBufferInM, hBufferIOT;
+        cl::Buffer dBufferUpF, dBufferUpM, dBufferInF, dBufferInM, dBufferIOT;
+        cl::Buffer dBufferW, dBufferSumW, dBufferShift;
+
+    };
+
+}
+}
+
+#endif  // ICP_TILED_HPP
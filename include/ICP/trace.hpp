@@ -0,0 +1,203 @@
+/*! \file trace.hpp
+ *  \brief Declares the per-stage timing instrumentation of the %ICP pipeline.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_TRACE_HPP
+#define ICP_TRACE_HPP
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <CLUtils.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Enumerates the stages of an %ICP iteration that can be traced. */
+    enum class ICPStage : uint8_t
+    {
+        TRANSFORM,  /*!< Transformation of the moving set (`ICPTransform`). */
+        SEARCH,     /*!< Nearest neighbor search (`RBCSearch`). */
+        WEIGHTS,    /*!< Computation of the weights (`ICPWeights`). */
+        MEANS,      /*!< Computation of the means (`ICPMean`, or `ICPS<ICPSConfig::FUSED>`). */
+        DEVS,       /*!< Computation of the deviations (`ICPDevs`). */
+        S,          /*!< Computation of the `S` matrix (`ICPS`). */
+        SOLVE,      /*!< Estimation of the incremental transformation on the device 
+                     *   (`ICPPowerMethod`, or `ICPSVD`). */
+        UPDATE,     /*!< Update of the transformation on the device (`ICPUpdateTransform`). */
+        READ,       /*!< Transfer of the iteration results to the host. */
+        WRITE       /*!< Transfer of the updated transformation to the device. */
+    };
+
+    /*! \brief Number of stages in `ICPStage`. */
+    const unsigned int nICPStages = 10;
+
+
+    /*! \brief Enumerates the profiling timestamps of an OpenCL command. */
+    enum class ICPStamp : uint8_t
+    {
+        QUEUED,  /*!< The command was enqueued by the host (`CL_PROFILING_COMMAND_QUEUED`). */
+        SUBMIT,  /*!< The command was submitted to the device (`CL_PROFILING_COMMAND_SUBMIT`). */
+        START,   /*!< The command started executing (`CL_PROFILING_COMMAND_START`). */
+        END      /*!< The command finished executing (`CL_PROFILING_COMMAND_END`). */
+    };
+
+
+    /*! \brief Enumerates the reasons for which a registration ended. */
+    enum class ICPConvergence : uint8_t
+    {
+        NONE,           /*!< No registration has ended yet. */
+        THRESHOLD,      /*!< The change in the transformation dropped below the thresholds. */
+        MAX_ITERATIONS  /*!< The maximum number of iterations was reached. */
+    };
+
+
+    /*! \brief The timestamps of one traced %ICP iteration. */
+    struct ICPTraceRecord
+    {
+        unsigned int registration;  /*!< Index of the registration the iteration belongs to. */
+        unsigned int iteration;     /*!< Index of the iteration within its registration. */
+        /*! \brief Number of iterations of the iterative solver (`ICPPowerMethod`), 
+         *         or `0` if the solver didn't report any. */
+        unsigned int solverIterations;
+        /*! \brief Flags indicating which stages were recorded. */
+        std::array<bool, nICPStages> recorded;
+        /*! \brief Device timestamps (in ns), indexed by `ICPStage` and `ICPStamp`. */
+        std::array<std::array<cl_ulong, 4>, nICPStages> stamps;
+    };
+
+
+    /*! \brief Aggregate statistics of the duration of a stage. */
+    struct ICPStageStats
+    {
+        unsigned int samples;  /*!< Number of iterations that recorded the stage. */
+        double mean;           /*!< Mean duration (in ms). */
+        double p50;            /*!< Median duration (in ms). */
+        double p99;            /*!< 99th percentile of the duration (in ms). */
+        double max;            /*!< Maximum duration (in ms). */
+    };
+
+
+    /*! \brief Records per-stage timestamps of the %ICP iterations in a ring buffer.
+     *  \details An `ICPTrace` is attached to an `ICPStep` (or `ICP`) instance with 
+     *           `setTrace`. Every stage then hands an event to its command, and once 
+     *           a registration is done, the profiling information of the events is 
+     *           collected into the ring buffer. The ring keeps the last `capacity` 
+     *           iterations, across registrations.
+     *  \note The command queue should be created with `CL_QUEUE_PROFILING_ENABLE`.
+     *  \note Without an attached trace, the pipeline requests no events, so there 
+     *        is no cost other than a pointer check per stage.
+     *  \note The stages that enqueue more than one command (`SEARCH`, `WEIGHTS`, `MEANS`, 
+     *        `S`, and `SOLVE` for `ICPPlane`) are started with a marker, so their 
+     *        durations cover all of their commands. Look at `traceEvent`.
+     */
+    class ICPTrace
+    {
+    public:
+        /*! \brief Allocates the ring buffer. */
+        ICPTrace (unsigned int _capacity = 1024);
+        /*! \brief Opens the record of a new iteration. */
+        void begin ();
+        /*! \brief Returns the event for a stage of the current iteration. */
+        cl::Event* event (ICPStage stage);
+        /*! \brief Returns the event that marks the start of a stage of the current iteration. */
+        cl::Event* startEvent (ICPStage stage);
+        /*! \brief Returns the slot for the number of solver iterations of the current iteration. */
+        cl_uint* solverIterations ();
+        /*! \brief Collects the timestamps of the pending iterations, and ends a registration. */
+        void end (ICPConvergence reason, unsigned int iterations);
+        /*! \brief Discards all records. */
+        void clear ();
+        /*! \brief Returns the number of records in the ring buffer. */
+        unsigned int size () const;
+        /*! \brief Returns the capacity of the ring buffer. */
+        unsigned int capacity () const;
+        /*! \brief Returns a record, with index `0` being the oldest one. */
+        const ICPTraceRecord& operator[] (unsigned int idx) const;
+        /*! \brief Computes statistics on the duration of a stage. */
+        ICPStageStats stats (ICPStage stage, 
+            ICPStamp from = ICPStamp::START, ICPStamp to = ICPStamp::END) const;
+        /*! \brief Returns the number of registrations that have ended. */
+        unsigned int getRegistrations () const;
+        /*! \brief Returns the number of iterations of the last registration. */
+        unsigned int getIterations () const;
+        /*! \brief Returns the reason the last registration ended. */
+        ICPConvergence getConvergence () const;
+
+    private:
+        std::vector<ICPTraceRecord> ring;
+        unsigned int head, count;
+        std::vector<std::array<cl::Event, nICPStages>> pending, pendingStart;
+        std::deque<cl_uint> pendingSolver;
+        unsigned int registrations, iterations;
+        ICPConvergence convergence;
+
+    };
+
+
+    /*! \brief Returns the event for a stage, or `nullptr` if tracing is disabled.
+     *  \details It's meant to be passed as the event argument of a command.
+     *
+     *  \param[in] trace the attached trace, or `nullptr`.
+     *  \param[in] stage the stage of the command.
+     *  \return A pointer to the event of the stage.
+     */
+    inline cl::Event* traceEvent (ICPTrace *trace, ICPStage stage)
+    {
+        return (trace == nullptr) ? nullptr : trace->event (stage);
+    }
+
+
+    /*! \brief Marks the start of a stage, and returns the event for the stage, 
+     *         or `nullptr` if tracing is disabled.
+     *  \details It's meant for the stages that enqueue more than one command, e.g. `RBCSearch` 
+     *           or `ICPMean`, whose event is associated with their last command only. A marker 
+     *           is enqueued first, and the `QUEUED`, `SUBMIT` and `START` timestamps of the 
+     *           stage are taken from it, so the duration covers all the commands of the stage.
+     *  \note It should not be used for a stage that waits on a list of events, 
+     *        since the marker doesn't wait on them.
+     *
+     *  \param[in] trace the attached trace, or `nullptr`.
+     *  \param[in] stage the stage of the commands.
+     *  \param[in] queue the command queue the stage enqueues its commands on.
+     *  \return A pointer to the event of the stage.
+     */
+    inline cl::Event* traceEvent (ICPTrace *trace, ICPStage stage, const cl::CommandQueue &queue)
+    {
+        if (trace == nullptr) return nullptr;
+
+        queue.enqueueMarkerWithWaitList (nullptr, trace->startEvent (stage));
+        return trace->event (stage);
+    }
+
+}
+}
+
+#endif  // ICP_TRACE_HPP
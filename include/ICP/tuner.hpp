@@ -0,0 +1,70 @@
+/*! \file tuner.hpp
+ *  \brief Declares an auto-tuner for the launch configurations of the %ICP and reduction kernels.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#ifndef ICP_TUNER_HPP
+#define ICP_TUNER_HPP
+
+#include <CLUtils.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Benchmarks the launch configurations of the `%ICP` and reduction kernels on a device.
+     *  \details For each of `reduce_sum_f`, `reduce_min_f`, `reduce_max_ui`, `inclusiveScan_i`, 
+     *           `exclusiveScan_i`, `icpComputeReduceWeights`, `icpMean` and `icpMean_Weighted`, 
+     *           the local workspace sizes from the preferred work-group size multiple up to 
+     *           the maximum work-group size of the kernel, in powers of 2, are timed on the 
+     *           associated class. `icpSijProducts_Weighted` is timed, along with its reduction, 
+     *           for every combination of local size and elements per work-item in `1, 2, ..., 32`. 
+     *           The fastest configurations are stored with `setTunedConfig` and `storeTunedConfigs`. 
+     *           From then on, the classes constructed on the device, in this or a later run, pick them up.
+     *  \note The queue in `info` has to have been created with `CL_QUEUE_PROFILING_ENABLE`, and 
+     *        the program has to hold the reduce, scan and `%ICP` kernels. If the program was built 
+     *        by `addProgramSpecialized`, the number of points it was specialized for is used 
+     *        instead of `m`, and the kernels compiled with `ICP_WG` are left as they are.
+     *  \note Sizes that a class doesn't support for `m` points are skipped. So are sizes that 
+     *        the device turns down, e.g. for lack of local memory.
+     *
+     *  \param[in] env the OpenCL environment.
+     *  \param[in] info the environment info that the classes will be given.
+     *  \param[in] m number of points to tune for.
+     *  \param[in] force flag to indicate whether or not to tune even if there are 
+     *                   stored configurations for the device already.
+     *  \param[in] nRepeat number of timed executions per configuration. The best one counts.
+     *  \return True if the kernels were tuned, false if stored configurations were found.
+     */
+    bool tuneWorkGroups (clutils::CLEnv &env, clutils::CLEnvInfo<1> info, unsigned int m = 16384, 
+                         bool force = false, unsigned int nRepeat = 10);
+
+}
+}
+
+#endif  // ICP_TUNER_HPP
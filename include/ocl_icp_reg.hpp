@@ -32,6 +32,7 @@
 #include <GL/glew.h>  // Add before CLUtils.hpp
 #include <CLUtils.hpp>
 #include <ICP/algorithms.hpp>
+#include <ICP/pc_file.hpp>
 #include <eigen3/Eigen/Dense>
 
 
@@ -40,7 +41,7 @@ class CLEnvGL : public clutils::CLEnv
 {
 public:
     /*! \brief Initializes the OpenCL environment. */
-    CLEnvGL (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, int width, int height);
+    CLEnvGL (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, int width, int height, unsigned int m);
 
 private:
     /*! \brief Initializes the OpenGL memory buffers. */
@@ -51,24 +52,65 @@ private:
 };
 
 
+/*! \brief Enumerates the update policies of the visualization in `ICPReg`. */
+enum class ICPVisMode : uint8_t
+{
+    EVERY,     /*!< Updates the OpenGL buffers after every registration. */
+    RATE,      /*!< Updates the OpenGL buffers at most at a given rate. */
+    KEYFRAMES  /*!< Updates the OpenGL buffers only when the motion since 
+                *   the last update exceeds the keyframe thresholds. */
+};
+
+
 /*! \brief Performs the %ICP iterations.
  *  \details Estimates, step by step, the homogeneous transformation between two point clouds, 
  *           and transforms the relevant point cloud according to that transformation.
+ *  \note In streaming mode, `stream` accepts a new frame on every call. The frame is 
+ *        uploaded and reduced to landmarks on a second command queue, while the previous 
+ *        pair of frames gets registered on the main queue. The frames rotate through 
+ *        `slots` frame slots, so the registration results lag one frame behind.
+ *  \note The OpenGL buffers get updated on a separate command queue, from the output of 
+ *        the transformation, under the policy set by `setVisMode`. The registration 
+ *        never waits on the visualization, so call `syncVis` before drawing the buffers.
  */
 template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
 class ICPReg
 {
 public:
-    ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer);
-    void init (std::vector<cl_float8> pc8d1, std::vector<cl_float8> pc8d2);
+    ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, unsigned int _width = 640, unsigned int _height = 480, 
+            unsigned int _m = 16384, unsigned int _r = 256, bool _compact = false);
+    void init (const std::vector<cl_float8> &pc8d1, const std::vector<cl_float8> &pc8d2);
+    void init (const cl_algo::ICP::PCFile &file1, unsigned int idx1, 
+               const cl_algo::ICP::PCFile &file2, unsigned int idx2);
     void registerPC ();
+    void stream (const std::vector<cl_float8> &pc8d);
+    void stream (const cl_algo::ICP::PCFile &file, unsigned int idx);
+    void setVisMode (ICPVisMode mode);
+    void setVisRate (double fps);
+    void setKeyframeThresholds (double angle, double translation);
+    void syncVis ();
+
+    /*! \brief Number of frame slots in streaming mode. */
+    static const unsigned int slots = 3;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
+    void initBuffers ();
+    void streamSlot ();
+    void upload (const cl_algo::ICP::PCFile &file, unsigned int idx, cl::Buffer &buffer, 
+                 cl::CommandQueue &q, cl_algo::ICP::ICPBackProject &backProject, 
+                 const std::vector<cl::Event> *events = nullptr);
+    bool visDue (bool pairwise);
+    void updateVis (cl_algo::ICP::ICPTransform<cl_algo::ICP::ICPTransformConfig::QUATERNION> &tr, 
+                    const cl::Memory *fixed = nullptr);
+    void print (double latency);
+
     unsigned int width, height, n, m, r;
     CLEnvGL env;
-    clutils::CLEnvInfo<1> infoRBC, infoICP;
+    clutils::CLEnvInfo<1> infoRBC, infoICP, infoLM, infoVis;
     cl::Context &context;
-    cl::CommandQueue &queue;
+    cl::CommandQueue &queue, &queueLM, &queueVis;
     
     GLuint *glPC4DBuffer, *glRGBABuffer;
     cl_float blue[4], green[4], dummy[4];
@@ -83,10 +125,25 @@ private:
     double angle_threshold;
     double translation_threshold;
 
+    cl_algo::ICP::StagingPool pool;
+    cl_algo::ICP::ICPBackProject bp, bpLM;
     cl_algo::ICP::ICPLMs fLM, mLM;
     cl_algo::ICP::ICP<RC, WC> reg;
     cl_algo::ICP::ICPTransform<cl_algo::ICP::ICPTransformConfig::QUATERNION> transform;
 
+    std::vector<cl_algo::ICP::ICPLMs> sLM;
+    std::vector<cl_algo::ICP::ICPTransform<cl_algo::ICP::ICPTransformConfig::QUATERNION>> sTransform;
+    std::vector<cl::Event> sEvents;
+    unsigned int frames;
+
+    ICPVisMode visMode;
+    double visRate, visAngle, visTranslation;
+    cl::Buffer dBufferVisT;
+    cl::Event visEvent;
+    clutils::CPUTimer<double, std::milli> visTimer;
+    Eigen::Quaternionf visQ, dispQ;
+    Eigen::Vector3f visT, dispT;
+
 };
 
 #endif  // OCL_ICP_SBS_HPP
@@ -54,6 +54,8 @@ private:
 /*! \brief Performs the %ICP iterations.
  *  \details Estimates, step by step, the homogeneous transformation between two point clouds, 
  *           and transforms the relevant point cloud according to that transformation.
+ *  \note The moving point cloud is transformed and copied to the OpenGL buffers on a 
+ *        separate command queue, so call `syncVis` before drawing the buffers.
  */
 template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
 class ICPSBS
@@ -62,13 +64,14 @@ public:
     ICPSBS (GLuint *glPC4DBuffer, GLuint *glRGBABuffer);
     void init (std::vector<cl_float8> pc8d1, std::vector<cl_float8> pc8d2);
     void step ();
+    void syncVis ();
 
 private:
     unsigned int width, height, n, m, r;
     CLEnvGL env;
-    clutils::CLEnvInfo<1> infoRBC, infoICP;
+    clutils::CLEnvInfo<1> infoRBC, infoICP, infoVis;
     cl::Context &context;
-    cl::CommandQueue &queue;
+    cl::CommandQueue &queue, &queueVis;
     
     GLuint *glPC4DBuffer, *glRGBABuffer;
     cl_float blue[4], green[4], dummy[4];
@@ -84,6 +87,9 @@ private:
     cl_algo::ICP::ICPStep<RC, WC> icpStep;
     cl_algo::ICP::ICPTransform<cl_algo::ICP::ICPTransformConfig::QUATERNION> transform;
 
+    cl::Buffer dBufferVisT;
+    cl::Event visEvent;
+
 };
 
 #endif  // OCL_ICP_SBS_HPP
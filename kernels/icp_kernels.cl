@@ -38,29 +38,334 @@ typedef struct
 } dist_id;
 
 
+/*! \brief Compile-time specialization of the kernels.
+ *  \details A program built with `-D ICP_M=<m>` treats the number of points in 
+ *           the sets as a constant, in the kernels that process whole sets. 
+ *           `-D ICP_C=<c>` does the same for the scaling factor of the `S` 
+ *           matrix kernels, and `-D ICP_WG=<size>` for the local workspace 
+ *           of the reductions, so that their loops can be unrolled. The 
+ *           corresponding kernel arguments are still accepted, but ignored.
+ *  \note Build such programs with `cl_algo::ICP::addProgramSpecialized`. 
+ *        The classes verify that they are initialized with the same values.
+ */
+#ifdef ICP_M
+    #define ICP_N(n) (ICP_M)
+#else
+    #define ICP_N(n) (n)
+#endif
+
+#ifdef ICP_C
+    #define ICP_SCALE(c) (ICP_C)
+#else
+    #define ICP_SCALE(c) (c)
+#endif
+
+#ifdef ICP_WG
+    #define ICP_WG_SIZE __attribute__ ((reqd_work_group_size (ICP_WG, 1, 1)))
+    #define ICP_LOCAL_SIZE (ICP_WG)
+#else
+    #define ICP_WG_SIZE
+    #define ICP_LOCAL_SIZE get_local_size (0)
+#endif
+
+
+/*! \brief Subgroup support.
+ *  \details When the device exposes `cl_khr_subgroups` (with OpenCL C 2.0), or 
+ *           `cl_intel_subgroups`, the work-group reductions of the single-pass 
+ *           kernels are performed with `sub_group_reduce_add`. Otherwise, they 
+ *           fall back to the local memory tree reductions.
+ */
+#if defined (cl_khr_subgroups) && __OPENCL_C_VERSION__ >= 200
+    #pragma OPENCL EXTENSION cl_khr_subgroups : enable
+    #define ICP_SUBGROUPS
+#elif defined (cl_intel_subgroups)
+    #pragma OPENCL EXTENSION cl_intel_subgroups : enable
+    #define ICP_SUBGROUPS
+#endif
+
+
+/*! \brief Reduces a vector per work-item to the sum in the work-group.
+ *  \note The number of work-items in a work-group should be a **power of 2**. 
+ *        With subgroups, the partials of the subgroups are combined in strides 
+ *        of the subgroup size, so there is no limit on the number of subgroups.
+ *
+ *  \param[in] x vector of the work-item.
+ *  \param[in] data local buffer of at least \f$ lXdim*(3*sizeof\ (float)) \f$.
+ *  \return The sum. It's valid only for the first work-item.
+ */
+inline
+float3 icpReduceSum3 (float3 x, local float *data)
+{
+    uint lX = get_local_id (0);
+    barrier (CLK_LOCAL_MEM_FENCE);  // data might be in use
+
+#ifdef ICP_SUBGROUPS
+    x = (float3) (sub_group_reduce_add (x.x), sub_group_reduce_add (x.y), sub_group_reduce_add (x.z));
+    if (get_num_sub_groups () == 1) return x;
+
+    if (get_sub_group_local_id () == 0) vstore3 (x, get_sub_group_id (), data);
+    barrier (CLK_LOCAL_MEM_FENCE);
+    // Every subgroup combines the partials, in strides of the subgroup size, 
+    // since there might be more subgroups than work-items in a subgroup
+    x = (float3) (0.f);
+    for (uint i = get_sub_group_local_id (); i < get_num_sub_groups (); i += get_sub_group_size ())
+        x += vload3 (i, data);
+    return (float3) (sub_group_reduce_add (x.x), sub_group_reduce_add (x.y), sub_group_reduce_add (x.z));
+#else
+    vstore3 (x, lX, data);
+    for (uint d = get_local_size (0) >> 1; d > 0; d >>= 1)
+    {
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (lX < d)
+            vstore3 (vload3 (lX, data) + vload3 (lX + d, data), lX, data);
+    }
+    return vload3 (0, data);
+#endif
+}
+
+
+/*! \brief Back-projects raw depth and RGB frames into an 8-D point cloud.
+ *  \details \f$ X=(u-c_x)d/f_x,\ Y=(v-c_y)d/f_y,\ Z=d \f$, where \f$ d \f$ is 
+ *           the depth (in mm) of the pixel \f$ (u,v) \f$. The color channels are 
+ *           scaled to the range \f$ [0,1] \f$. Pixels with zero depth produce 
+ *           invalid points (zero coordinates).
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        equal to the width of the frames, and the **y** dimension, \f$ gYdim \f$, 
+ *        equal to their height. There is no requirement for the local workspace.
+ *
+ *  \param[in] depth array (depth frame) of `ushort` elements.
+ *  \param[in] rgb array (RGB frame) of `uchar` elements, 3 channels per pixel.
+ *  \param[out] out array (point cloud) of `float8` elements.
+ *  \param[in] intrinsics camera parameters, \f$ intrinsics = \left[ 
+ *                        \begin{matrix} f_x & f_y & c_x & c_y \end{matrix} \right] \f$.
+ */
+kernel
+void icpBackProject (global ushort *depth, global uchar *rgb, global float8 *out, float4 intrinsics)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    uint idx = gY * gXdim + gX;
+
+    float d = depth[idx];
+    float2 xy = ((float2) (gX, gY) - intrinsics.zw) * d / intrinsics.xy;
+    float3 color = convert_float3 (vload3 (idx, rgb)) / 255.f;
+
+    out[idx] = (float8) (xy, d, 1.f, color, 1.f);
+}
+
+
+/*! \brief Estimates the surface normals of an organized point cloud.
+ *  \details The normal of a point is the cross product of the central differences 
+ *           of its neighbors along the rows and the columns of the grid, \f$ n = 
+ *           (p_{u+1,v}-p_{u-1,v}) \times (p_{u,v+1}-p_{u,v-1}) \f$, normalized and 
+ *           oriented towards the camera. Points on the border of the grid, points with 
+ *           an invalid (zero depth) neighbor, and points across a depth discontinuity 
+ *           get a zero normal.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        equal to the width of the point cloud, and the **y** dimension, \f$ gYdim \f$, 
+ *        equal to its height. There is no requirement for the local workspace.
+ *
+ *  \param[in] in array (point cloud) of `float8` elements.
+ *  \param[out] normals array of `float4` elements. The first 3 dimensions 
+ *                      contain the unit normals, and the last one is zero.
+ *  \param[in] max_dz maximum difference in depth between the neighbors of a point, 
+ *                    relative to its depth. Beyond it, the neighbors are considered 
+ *                    to be on different surfaces.
+ */
+kernel
+void icpNormals (global float8 *in, global float4 *normals, float max_dz)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint gYdim = get_global_size (1);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    uint idx = gY * gXdim + gX;
+
+    float4 n = (float4) (0.f);
+
+    if (gX > 0 && gY > 0 && gX < gXdim - 1 && gY < gYdim - 1)
+    {
+        float3 p = in[idx].s012;
+        float3 l = in[idx - 1].s012;
+        float3 r = in[idx + 1].s012;
+        float3 u = in[idx - gXdim].s012;
+        float3 d = in[idx + gXdim].s012;
+
+        float dz = max_dz * p.z;
+        bool valid = p.z > 0.f && l.z > 0.f && r.z > 0.f && u.z > 0.f && d.z > 0.f && 
+                     fabs (r.z - l.z) < dz && fabs (d.z - u.z) < dz;
+
+        float3 c = cross (r - l, d - u);
+        float len = length (c);
+
+        if (valid && len > 0.f)
+        {
+            c /= len;
+            n = (float4) ((dot (c, p) > 0.f) ? -c : c, 0.f);
+        }
+    }
+
+    normals[idx] = n;
+}
+
+
 /*! \brief Samples a point cloud for landmarks.
  *  \details Chooses landmarks at specific intervals in the x and y dimension.
- *  \note 16384 landmarks are extracted from the point cloud \f$ (640 \times 480) \f$. 
- *        These landmarks come from a center area. 10% of the points around the 
- *        cloud are ignored.
- *  \note From the center area \f$ (512 \times 384) \f$, points are sampled `1:4` 
- *        in the x dimension and `1:3` in the y dimension. There is also an offset 
- *        `1` in the x dimension and 1 in the y dimension. This creates an array 
- *        \f$ (128 \times 128) \f$ of landmarks.
+ *  \note The landmarks come from a center area of the point cloud. For the default 
+ *        configuration, 16384 landmarks are extracted from the point cloud 
+ *        \f$ (640 \times 480) \f$, and 10% of the points around the cloud are ignored.
+ *  \note From the center area \f$ (area_z \times area_w) \f$, points are sampled 
+ *        \f$ 1:s_x \f$, \f$ s_x = area_z/n_{lx} \f$, in the x dimension and \f$ 1:s_y \f$, 
+ *        \f$ s_y = area_w/n_{ly} \f$, in the y dimension. There is also an offset 
+ *        \f$ (s_x-1)/2 \f$ in the x dimension and \f$ (s_y-1)/2 \f$ in the y dimension. 
+ *        This creates an array \f$ (n_{lx} \times n_{ly}) \f$ of landmarks. For the 
+ *        default configuration, that is `1:4` and `1:3` sampling from the center area 
+ *        \f$ (512 \times 384) \f$, with an offset `1` in both dimensions.
  *  \note Invalid points (zero coordinates) are going to be picked. Further 
- *        processing is needed for those points to be discraded, if necessary.
+ *        processing is needed for those points to be discraded, if necessary. 
+ *        Alternatively, `getLMs_Compact` samples only the valid points.
  *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should 
  *        be equal to two times the number of landmarks per row (2 work-items 
- *        per landmark). That is, \f$ \ gXdim=256 \f$. The **y** dimension of 
+ *        per landmark). That is, \f$ \ gXdim=2n_{lx} \f$. The **y** dimension of 
  *        the global workspace, \f$ gYdim \f$, should be equal to the number of 
- *        landmarks per column. That is, \f$ \ gYdim=128 \f$. There is no 
+ *        landmarks per column. That is, \f$ \ gYdim=n_{ly} \f$. There is no 
  *        requirement for the local workspace.
  *
  *  \param[in] in array (point cloud) of `float8` elements.
  *  \param[out] out array (landmarks) of `float8` elements.
+ *  \param[in] width number of points per row in the point cloud.
+ *  \param[in] area center area of the point cloud. The first two elements are 
+ *                  the coordinates of its top left point, and the last two 
+ *                  elements are its dimensions. That is, \f$ area = \left[ 
+ *                  \begin{matrix} x_0 & y_0 & w & h \end{matrix} \right] \f$.
+ */
+kernel
+void getLMs (global float4 *in, global float4 *out, uint width, uint4 area)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint gYdim = get_global_size (1);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    uint lX = gXdim >> 1;
+    uint2 offset = ((area.zw / (uint2) (lX, gYdim)) - 1) >> 1;
+
+    uint xi = area.x + ((gX >> 1) * area.z) / lX + offset.x;
+    uint yi = area.y + (gY * area.w) / gYdim + offset.y;
+
+    out[gY * gXdim + gX] = in[((yi * width + xi) << 1) + gX % 2];
+}
+
+
+/*! \brief Samples a point cloud, given as separate geometry and color streams, for landmarks.
+ *  \details Same sampling as `getLMs`, but the point cloud is read from a `float4` 
+ *           geometry stream and a normalized `uchar4` color stream (as produced by 
+ *           `icpSplit_SoA`), which take 20 bytes per point instead of 32. The landmarks 
+ *           are gathered into interleaved `float8` elements, with the color channels 
+ *           restored in the range \f$ [0,1] \f$, so the rest of the pipeline is unaffected.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should 
+ *        be equal to the number of landmarks per row (1 work-item per landmark). 
+ *        That is, \f$ \ gXdim=n_{lx} \f$. The **y** dimension of the global 
+ *        workspace, \f$ gYdim \f$, should be equal to the number of landmarks 
+ *        per column. That is, \f$ \ gYdim=n_{ly} \f$. There is no requirement 
+ *        for the local workspace.
+ *
+ *  \param[in] geom array (point cloud geometry) of `float4` elements.
+ *  \param[in] color array (point cloud color) of `uchar4` elements.
+ *  \param[out] out array (landmarks) of `float8` elements.
+ *  \param[in] width number of points per row in the point cloud.
+ *  \param[in] area center area of the point cloud, \f$ area = \left[ 
+ *                  \begin{matrix} x_0 & y_0 & w & h \end{matrix} \right] \f$.
+ */
+kernel
+void getLMs_SoA (global float4 *geom, global uchar4 *color, global float8 *out, uint width, uint4 area)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint gYdim = get_global_size (1);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    uint2 offset = ((area.zw / (uint2) (gXdim, gYdim)) - 1) >> 1;
+
+    uint xi = area.x + (gX * area.z) / gXdim + offset.x;
+    uint yi = area.y + (gY * area.w) / gYdim + offset.y;
+    uint idx = yi * width + xi;
+
+    out[gY * gXdim + gX] = (float8) (geom[idx], convert_float4 (color[idx]) / 255.f);
+}
+
+
+/*! \brief Samples a point cloud, given as a geometry stream and a `half` color stream, for landmarks.
+ *  \details Same as `getLMs_SoA`, but the color stream holds `half4` elements 
+ *           (as produced by `icpSplit_SoA_Half`), 24 bytes per point. `vload_half` 
+ *           is a core function, so the `cl_khr_fp16` extension is not required.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should 
+ *        be equal to the number of landmarks per row. That is, \f$ \ gXdim=n_{lx} \f$. 
+ *        The **y** dimension of the global workspace, \f$ gYdim \f$, should be 
+ *        equal to the number of landmarks per column. That is, \f$ \ gYdim=n_{ly} \f$. 
+ *        There is no requirement for the local workspace.
+ *
+ *  \param[in] geom array (point cloud geometry) of `float4` elements.
+ *  \param[in] color array (point cloud color) of `half4` elements.
+ *  \param[out] out array (landmarks) of `float8` elements.
+ *  \param[in] width number of points per row in the point cloud.
+ *  \param[in] area center area of the point cloud, \f$ area = \left[ 
+ *                  \begin{matrix} x_0 & y_0 & w & h \end{matrix} \right] \f$.
+ */
+kernel
+void getLMs_SoA_Half (global float4 *geom, global half *color, global float8 *out, uint width, uint4 area)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint gYdim = get_global_size (1);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    uint2 offset = ((area.zw / (uint2) (gXdim, gYdim)) - 1) >> 1;
+
+    uint xi = area.x + (gX * area.z) / gXdim + offset.x;
+    uint yi = area.y + (gY * area.w) / gYdim + offset.y;
+    uint idx = yi * width + xi;
+
+    out[gY * gXdim + gX] = (float8) (geom[idx], vload_half4 (idx, color));
+}
+
+
+/*! \brief Flags the valid points in the center area of a point cloud.
+ *  \details A point is valid when its depth (z coordinate) is not zero. 
+ *           The flags are meant to be scanned, for `getLMs_Compact` to 
+ *           sample only valid points.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        equal to the number of points per row in the point cloud. The **y** 
+ *        dimension of the global workspace, \f$ gYdim \f$, should be equal to 
+ *        the number of points per column. There is no requirement for the local 
+ *        workspace.
+ *
+ *  \param[in] in array (point cloud) of `float8` elements.
+ *  \param[out] flags array of `int` elements. `1` for the valid points in the 
+ *                    center area and `0` otherwise.
+ *  \param[in] area center area of the point cloud, \f$ area = \left[ 
+ *                  \begin{matrix} x_0 & y_0 & w & h \end{matrix} \right] \f$.
  */
 kernel
-void getLMs (global float4 *in, global float4 *out)
+void icpFlagValid (global float4 *in, global int *flags, uint4 area)
 {
     // Workspace dimensions
     uint gXdim = get_global_size (0);
@@ -69,32 +374,131 @@ void getLMs (global float4 *in, global float4 *out)
     uint gX = get_global_id (0);
     uint gY = get_global_id (1);
 
-    uint xi = (((gX >> 1) << 1) << 2) + 2;
-    uint yi = gY * 3 + 1;
+    uint idx = gY * gXdim + gX;
+
+    bool inside = gX >= area.x && gX < area.x + area.z && 
+                  gY >= area.y && gY < area.y + area.w;
+
+    flags[idx] = inside && in[idx << 1].z != 0.f;
+}
+
+
+/*! \brief Gathers the last element of every row in an array of row-wise inclusive scans.
+ *  \details That is, the totals of the rows, which are meant 
+ *           to be scanned in turn, to get the row offsets.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        greater than or equal to the number of rows, and a multiple of 4. The 
+ *        extra elements are set to zero. There is no requirement for the local 
+ *        workspace.
+ *
+ *  \param[in] scan array of `int` elements (row-wise inclusive scans).
+ *  \param[out] totals array of `int` elements (row totals).
+ *  \param[in] width number of elements per row.
+ *  \param[in] height number of rows.
+ */
+kernel
+void icpGetRowTotals (global int *scan, global int *totals, uint width, uint height)
+{
+    uint gX = get_global_id (0);
+
+    totals[gX] = (gX < height) ? scan[gX * width + width - 1] : 0;
+}
+
+
+/*! \brief Samples the valid points of a point cloud for landmarks.
+ *  \details Chooses landmarks uniformly among the valid points, so no landmarks 
+ *           are spent on invalid (zero-depth) points. Landmark `i` is the valid 
+ *           point with rank \f$ \lfloor i*count/m \rfloor \f$, in scanline order. 
+ *           The point is located with a binary search on the scanned row totals, 
+ *           and a binary search on the scanned row flags.
+ *  \note The valid points are flagged by `icpFlagValid`. The flags should 
+ *        be scanned per row, and the row totals should be scanned as well 
+ *        (`inclusive` scans in both cases). If there are no valid points, 
+ *        the landmarks are set to zero.
+ *  \note The global workspace should be one dimensional. The **x** dimension 
+ *        of the global workspace, \f$ gXdim \f$, should be equal to the number 
+ *        of landmarks. That is, \f$ \ gXdim=m \f$. There is no requirement for 
+ *        the local workspace.
+ *
+ *  \param[in] in array (point cloud) of `float8` elements.
+ *  \param[in] scan array of `int` elements (row-wise inclusive scans of the flags).
+ *  \param[in] rowScan array of `int` elements (inclusive scan of the row totals).
+ *  \param[out] out array (landmarks) of `float8` elements.
+ *  \param[in] width number of points per row in the point cloud.
+ *  \param[in] height number of points per column in the point cloud.
+ */
+kernel
+void getLMs_Compact (global float8 *in, global int *scan, global int *rowScan, 
+                     global float8 *out, uint width, uint height)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+
+    uint count = rowScan[height - 1];
+    if (count == 0)
+    {
+        out[gX] = (float8) (0.f);
+        return;
+    }
+
+    // Rank (1-based) of the chosen point
+    uint r = (uint) (((ulong) gX * count) / gXdim) + 1;
+
+    // Find the row
+    uint lo = 0, hi = height - 1;
+    while (lo < hi)
+    {
+        uint mid = (lo + hi) >> 1;
+        if (rowScan[mid] >= r) hi = mid;
+        else lo = mid + 1;
+    }
+    uint yi = lo;
+    if (yi > 0) r -= rowScan[yi - 1];
+
+    // Find the column
+    global int *row = scan + yi * width;
+    lo = 0; hi = width - 1;
+    while (lo < hi)
+    {
+        uint mid = (lo + hi) >> 1;
+        if (row[mid] >= r) hi = mid;
+        else lo = mid + 1;
+    }
+    uint xi = lo;
 
-    out[gY * gXdim + gX] = in[(48 + yi) * 1280 + (128 + xi) + gX % 2];
+    out[gX] = in[yi * width + xi];
 }
 
 
 /*! \brief Samples a set of landmarks for representatives.
  *  \details Chooses representatives at specific intervals in the x and y dimension.
- *  \note Representatives are extracted from the set of landmarks \f$ (128 \times 128) \f$. 
- *  \note Representatives are sampled \f$ 1:(128/n_{rx}) \f$ in the x dimension
- *        and \f$ 1:(128/n_{ry}) \f$ in the y dimension. There is also an offset 
- *        \f$ (128/n_{rx})/2-1 \f$ in the x dimension and \f$ (128/n_{ry})/2-1 \f$ 
- *        in the y dimension. This creates an array \f$ (n_{rx} \times n_{ry}) \f$ 
+ *  \note Representatives are extracted from the set of landmarks \f$ (n_{lx} \times n_{ly}) \f$, 
+ *        e.g. \f$ (128 \times 128) \f$. 
+ *  \note Representatives are sampled \f$ 1:(n_{lx}/n_{rx}) \f$ in the x dimension
+ *        and \f$ 1:(n_{ly}/n_{ry}) \f$ in the y dimension. There is also an offset 
+ *        \f$ (n_{lx}/n_{rx})/2-1 \f$ in the x dimension and \f$ (n_{ly}/n_{ry})/2-1 \f$ 
+ *        in the y dimension, which is 0 when every landmark in a dimension is 
+ *        a representative. This creates an array \f$ (n_{rx} \times n_{ry}) \f$ 
  *        of representatives.
  *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
  *        equal to the number of representatives per row. That is, \f$ \ gXdim=n_{rx }\f$. 
  *        The **y** dimension of the global workspace, \f$ gYdim \f$, should be 
  *        equal to the number of representatives per column. That is, \f$ \ gYdim=n_{ry} \f$. 
  *        There is no requirement for the local workspace.
+ *  \note For a batch of landmark sets, stored one after the other, the **z** 
+ *        dimension of the global workspace should be equal to the number of sets. 
+ *        The representatives are stored in the same order.
  *
  *  \param[in] in array (landmarks) of `float8` elements.
  *  \param[out] out array (representatives) of `float8` elements.
+ *  \param[in] lx number of landmarks per row in the set, \f$ n_{lx} \f$.
+ *  \param[in] ly number of landmarks per column in the set, \f$ n_{ly} \f$.
  */
 kernel
-void getReps (global float8 *in, global float8 *out)
+void getReps (global float8 *in, global float8 *out, uint lx, uint ly)
 {
     // Workspace dimensions
     uint gXdim = get_global_size (0);
@@ -103,14 +507,15 @@ void getReps (global float8 *in, global float8 *out)
     // Workspace indices
     uint gX = get_global_id (0);
     uint gY = get_global_id (1);
+    uint gZ = get_global_id (2);
 
-    uint stepX = 128 / gXdim;
-    uint stepY = 128 / gYdim;
+    uint stepX = lx / gXdim;
+    uint stepY = ly / gYdim;
 
-    uint xi = gX * stepX + (stepX >> 1) - 1;
-    uint yi = gY * stepY + (stepY >> 1) - 1;
+    uint xi = gX * stepX + max (stepX >> 1, 1U) - 1;
+    uint yi = gY * stepY + max (stepY >> 1, 1U) - 1;
 
-    out[gY * gXdim + gX] = in[yi * 128 + xi];
+    out[(gZ * gYdim + gY) * gXdim + gX] = in[(gZ * ly + yi) * lx + xi];
 }
 
 
@@ -135,12 +540,14 @@ void getReps (global float8 *in, global float8 *out)
  *                  work-item in a work-group. That is \f$ 2*lXdim*sizeof\ (float) \f$.
  *  \param[in] n number of elements in the array.
  */
-kernel
+kernel ICP_WG_SIZE
 void icpComputeReduceWeights (global dist_id *in, global float *weights, global double *sums, 
                               local float *data, uint n)
 {
+    n = ICP_N (n);  // Constant in specialized programs
+
     // Workspace dimensions
-    uint lXdim = get_local_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
 
     // Workspace indices
     uint gX = get_global_id (0);
@@ -209,12 +616,14 @@ void icpComputeReduceWeights (global dist_id *in, global float *weights, global
  *                  work-item in a work-group. That is \f$ 2*lXdim*sizeof\ (float) \f$.
  *  \param[in] n number of elements in the array.
  */
-kernel
+kernel ICP_WG_SIZE
 void icpComputeReduceWeights_WG (global dist_id *in, global float *weights, global float *sums, 
                                  local float *data, uint n)
 {
+    n = ICP_N (n);  // Constant in specialized programs
+
     // Workspace dimensions
-    uint lXdim = get_local_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
 
     // Workspace indices
     uint gX = get_global_id (0);
@@ -291,11 +700,11 @@ void icpComputeReduceWeights_WG (global dist_id *in, global float *weights, glob
  *                  work-item in a work-group. That is \f$ 2*lXdim*sizeof\ (double) \f$.
  *  \param[in] n number of elements in a row of the array divided by 4.
  */
-kernel
+kernel ICP_WG_SIZE
 void reduce_sum_fd (global float4 *in, global double *out, local double *data, uint n)
 {
     // Workspace dimensions
-    uint lXdim = get_local_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
     uint wgXdim = get_num_groups (0);
 
     // Workspace indices
@@ -363,26 +772,33 @@ void reduce_sum_fd (global float4 *in, global double *out, local double *data, u
  *                   should be \f$ 2*(wgXdim*sizeof\ (float4)) \f$. The first row contains
  *                   the block means for the fixed set, and the second row contains the 
  *                   block means for the moving set.
+ *  \note For a batch of set pairs, stored one after the other, the **z** dimension 
+ *        of the global workspace should be equal to the number of pairs. The 
+ *        (block) means of each pair are stored in consecutive rows.
+ *
  *  \param[in] data local buffer. Its size should be `6 float` elements for each work-item 
  *                  in a work-group. That is \f$ lXdim*(2*(3*sizeof\ (float))) \f$.
  *  \param[in] n number of points in the sets.
  */
-kernel
+kernel ICP_WG_SIZE
 void icpMean (global float4 *F, global float4 *M, global float4 *mean, local float *data, uint n)
 {
+    n = ICP_N (n);  // Constant in specialized programs
+
     // Workspace dimensions
-    uint lXdim = get_local_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
     uint wgXdim = get_num_groups (0);
 
     // Workspace indices
     uint gX = get_global_id (0);
     uint gY = get_global_id (1);
+    uint gZ = get_global_id (2);
     uint lX = get_local_id (0);
     uint wgX = get_group_id (0);
 
     // Choose input
     global float4 *SET[2] = { F, M };
-    global float4 *in = SET[gY];
+    global float4 *in = SET[gY] + gZ * (n << 1);
 
     // Fetch and normalize 2 points per work-item
     // Hold the xyz coordinates of the points
@@ -407,7 +823,88 @@ void icpMean (global float4 *F, global float4 *M, global float4 *mean, local flo
     // One work-item per work-group 
     // stores the mean vector
     if (lX == 0) 
-        mean[gY * wgXdim + wgX] = (float4) (vload3 (0, data), 0.f);
+        mean[((gZ << 1) + gY) * wgXdim + wgX] = (float4) (vload3 (0, data), 0.f);
+}
+
+
+/*! \brief Performs reduce operations on arrays of 8-D points, in a single launch.
+ *  \details Computes the means \f$ \bar{x}_j = \sum^{n}_{i}{\frac{x_{ij}}{n}}, 
+ *           j=\{0,1,2\} \f$ on the xyz dimensions of the points in the 
+ *           fixed and moving sets. Every work-group reduces a block of a set, and 
+ *           stores its result. The last work-group to finish, on each set, reduces 
+ *           the results of the blocks, and stores the mean (last-block-done pattern).
+ *  \note The work-items stride over the sets, so there is no requirement on the 
+ *        **x** dimension of the global workspace, \f$ gXdim \f$. The **y** dimension 
+ *        of the global workspace, \f$ gYdim \f$, should be equal to 2. That is, 
+ *        \f$ \ gYdim = 2 \f$. The local workspace should be `1` in the **y** dimension, 
+ *        and a **power of 2** in the **x** dimension.
+ *
+ *  \param[in] F fixed set of `float8` elements. The first 3 dimensions 
+ *               should contain the xyz coordinates of the points.
+ *  \param[in] M moving set of `float8` elements. The first 3 dimensions 
+ *               should contain the xyz coordinates of the points.
+ *  \param[out] mean array of mean `float4` vectors. Its size should be \f$ 2*sizeof\ (float4) \f$. 
+ *                   The first `float4` is the mean for the fixed set, and the second 
+ *                   `float4` is the mean for the moving set.
+ *  \param[out] blocks array with the means of the blocks. Its size should be 
+ *                     \f$ 2*(wgXdim*sizeof\ (float4)) \f$.
+ *  \param[in,out] count array of 2 counters of finished work-groups, one per set. 
+ *                       It should be initialized to `0`. The kernel resets it 
+ *                       to `0` before it returns.
+ *  \param[in] data local buffer. Its size should be `3 float` elements for each work-item 
+ *                  in a work-group. That is \f$ lXdim*(3*sizeof\ (float)) \f$.
+ *  \param[in] n number of points in the sets.
+ */
+kernel ICP_WG_SIZE
+void icpMean_SP (global float4 *F, global float4 *M, global float4 *mean, volatile global float4 *blocks, 
+                 global uint *count, local float *data, uint n)
+{
+    n = ICP_N (n);  // Constant in specialized programs
+
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
+    uint wgXdim = get_num_groups (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+    uint lX = get_local_id (0);
+    uint wgX = get_group_id (0);
+
+    local uint last;
+
+    // Choose input
+    global float4 *SET[2] = { F, M };
+    global float4 *in = SET[gY];
+
+    float3 a = (float3) (0.f);
+    for (uint i = gX; i < n; i += gXdim)
+        a += in[i << 1].xyz;
+    a = icpReduceSum3 (a / (float3) (n), data);
+
+    // The last work-group reduces the blocks
+    if (lX == 0)
+    {
+        blocks[gY * wgXdim + wgX] = (float4) (a, 0.f);
+        mem_fence (CLK_GLOBAL_MEM_FENCE);
+        last = (atomic_inc (count + gY) == wgXdim - 1);
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    if (last)
+    {
+        a = (float3) (0.f);
+        for (uint i = lX; i < wgXdim; i += lXdim)
+            a += blocks[gY * wgXdim + i].xyz;
+        a = icpReduceSum3 (a, data);
+
+        if (lX == 0)
+        {
+            mean[gY] = (float4) (a, 0.f);
+            count[gY] = 0;
+        }
+    }
 }
 
 
@@ -451,12 +948,14 @@ void icpMean (global float4 *F, global float4 *M, global float4 *mean, local flo
  *                  in a work-group. That is \f$ lXdim*(2*(3*sizeof\ (float))) \f$.
  *  \param[in] n number of points in the sets.
  */
-kernel
+kernel ICP_WG_SIZE
 void icpMean_Weighted (global float4 *F, global float4 *M, global float4 *MEAN, 
                        global float *W, constant double *sum_w, local float *data, uint n)
 {
+    n = ICP_N (n);  // Constant in specialized programs
+
     // Workspace dimensions
-    uint lXdim = get_local_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
     uint wgXdim = get_num_groups (0);
 
     // Workspace indices
@@ -522,20 +1021,24 @@ void icpMean_Weighted (global float4 *F, global float4 *M, global float4 *MEAN,
  *                  dispatched with more than one work-group, the array contains 
  *                  the means from each block reduction, and its size should be 
  *                  \f$ wgXdim*sizeof\ (float4) \f$.
+ *  \note For a batch of set pairs, the **z** dimension of the global workspace 
+ *        should be equal to the number of pairs.
+ *
  *  \param[in] data local buffer. Its size should be `6 float` elements for each 
  *                  work-item in a work-group. That is \f$ lXdim*(2*(3*sizeof\ (float))) \f$.
  *  \param[in] n number of points in the array.
  */
-kernel
+kernel ICP_WG_SIZE
 void icpGMean (global float4 *in, global float4 *out, local float *data, uint n)
 {
     // Workspace dimensions
-    uint lXdim = get_local_size (0);
+    uint lXdim = ICP_LOCAL_SIZE;
+    uint gYdim = get_global_size (1);
     uint wgXdim = get_num_groups (0);
 
     // Workspace indices
     uint gX = get_global_id (0);
-    uint gY = get_global_id (1);
+    uint gY = get_global_id (1) + get_global_id (2) * gYdim;
     uint lX = get_local_id (0);
     uint wgX = get_group_id (0);
 
@@ -572,6 +1075,8 @@ void icpGMean (global float4 *in, global float4 *out, local float *data, uint n)
  *        to the number of points in the sets. That is, \f$ \ gXdim=n \f$. The **y** 
  *        dimension of the global workspace should be equal to 2. That is, \f$ \ gYdim=2 \f$. 
  *        There is no requirement for the local workspace.
+ *  \note For a batch of set pairs, stored one after the other, the **z** dimension 
+ *        of the global workspace should be equal to the number of pairs.
  *
  *  \param[in] F fixed set of `float8` elements. The first 3 dimensions 
  *               should contain the xyz coordinates of the points.
@@ -588,9 +1093,13 @@ kernel
 void icpSubtractMean (global float4 *F, global float4 *M, global float4 *DF, global float4 *DM, 
                       constant float4 *mean)
 {
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+
     // Workspace indices
     uint gX = get_global_id (0);
     uint gY = get_global_id (1);
+    uint gZ = get_global_id (2);
 
     global float4 *SET[2] = { F, M };
     global float4 *DEV[2] = { DF, DM };
@@ -598,7 +1107,8 @@ void icpSubtractMean (global float4 *F, global float4 *M, global float4 *DF, glo
     global float4 *out = DEV[gY];
 
     // Compute deviation from mean
-    out[gX] = in[gX * 2] - mean[gY];
+    uint idx = gZ * gXdim + gX;
+    out[idx] = in[idx * 2] - mean[(gZ << 1) + gY];
 }
 
 
@@ -618,6 +1128,9 @@ void icpSubtractMean (global float4 *F, global float4 *M, global float4 *DF, glo
  *        \f$ gXdim \f$, should be greater or equal to the number of points, `m`, 
  *        in the sets. That is, \f$ \ gXdim \geq m \f$. There is no requirement 
  *        for the local workspace.
+ *  \note For a batch of set pairs, stored one after the other, the **y** dimension 
+ *        of the global workspace should be equal to the number of pairs. The `11` 
+ *        rows of partial sums of each pair are stored one after the other.
  *
  *  \param[in] M array (moving set deviations) of `float4` elements. The first 
  *               3 dimensions should contain the xyz coordinates of the points.
@@ -632,11 +1145,20 @@ void icpSubtractMean (global float4 *F, global float4 *M, global float4 *DF, glo
 kernel
 void icpSijProducts (global float4 *M, global float4 *F, global float *Sij, uint m, float c)
 {
+    m = ICP_N (m);  // Constants in specialized programs
+    c = ICP_SCALE (c);
+
     // Workspace dimensions
     uint gXdim = get_global_size (0);
 
     // Workspace indices
     uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    // Choose pair
+    M += gY * m;
+    F += gY * m;
+    Sij += gY * 11 * gXdim;
 
     float3 A[4];
     A[0] = (float3) (0.f);  // mx * [fx fy fz]
@@ -703,6 +1225,9 @@ kernel
 void icpSijProducts_Weighted (global float4 *M, global float4 *F, global float *W, 
                               global float *Sij, uint m, float c)
 {
+    m = ICP_N (m);  // Constants in specialized programs
+    c = ICP_SCALE (c);
+
     // Workspace dimensions
     uint gXdim = get_global_size (0);
 
@@ -743,44 +1268,210 @@ void icpSijProducts_Weighted (global float4 *M, global float4 *F, global float *
 }
 
 
-/*! \brief Performs a homogeneous transformation on a set of points, \f$ p = 
- *         \left[ \begin{matrix} p_x & p_y & p_z & 1 \end{matrix} \right]^T \f$ 
- *         (or as a quaternion, \f$ \dot{p} = \left[ \begin{matrix} p_x & p_y & 
- *         p_z & 0 \end{matrix} \right]^T \f$), using unit quaternions \f$ \dot{q} 
- *         = (\omega, \mathcal{v}) = q_w + (q_x i + q_y j + q_z k) = \left[ 
- *         \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
- *         where \f$ \dot{q}\cdot\dot{q}=1 \f$.
- *  \details Transforms each point in a set, \f$\ p' = s\dot{q}\dot{p}\dot{q}^*+t = 
- *           s(p + 2\mathcal{v} \times (\mathcal{v} \times p + \omega p)) + t \f$. 
- *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
- *        equal to 2.  That is, \f$ \ gXdim = 2 \f$. The **y** dimension of the 
- *        global workspace should be equal to the number of points, `m`, in the 
- *        sets. That is, \f$ \ gYdim = m \f$. There is no requirement for the 
- *        local workspace.
+/*! \brief Produces the weighted sums of products for the S matrix and the means, in one pass.
+ *  \details Fuses `icpMean_Weighted`, `icpSubtractMean` and `icpSijProducts_Weighted`. 
+ *           The points are read once, and the deviations from the means are never 
+ *           materialized. Instead, the kernel accumulates the weighted products of 
+ *           the points, shifted by a reference point \f$ k \f$, together with the 
+ *           weighted sums of the shifted points. The S matrix is then recovered by 
+ *           `icpSijFinalize_Fused` with the shifted-covariance identity, 
+ *           \f$ \sum{w_i(m_i-\bar{m})(f_i-\bar{f})^T} = \sum{w_i(m_i-k_m)(f_i-k_f)^T} - 
+ *           W(\bar{m}-k_m)(\bar{f}-k_f)^T \f$, where \f$ W = \sum{w_i} \f$.
+ *  \note The shift keeps the sums well conditioned. The means from the previous 
+ *        %ICP iteration are a good choice, and any finite point gives correct results.
+ *  \note Each work-item processes up to 4 pairs of points. So, the output 
+ *        of each work-item is partial sums. On a next step, these results 
+ *        will have to be reduced, and then passed to `icpSijFinalize_Fused`.
+ *  \note The global workspace should be one dimensional and its **x** dimension, 
+ *        \f$ gXdim \f$, should be greater or equal to the number of points, `m`, 
+ *        in the sets divided by 4. That is, \f$ \ gXdim \geq m/4 \f$. There is no 
+ *        requirement for the local workspace.
  *
- *  \param[in] M array of `float8` elements. The first 4 dimensions should 
- *               contain the homogeneous coordinates of the points.
- *  \param[out] tM array of `float8` elements. The first 4 dimensions will 
- *                 contain the transformed homogeneous coordinates of the points.
- *  \param[in] data array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
- *                  is the **quaternion**, and the second is the **translation vector**. 
- *                  If there is a need to apply **scaling**, the factor should be available 
- *                  in the last element of the translation vector. That is, 
- *                  \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & s \end{matrix} \right]^T \f$.
+ *  \param[in] F array (fixed set) of `float8` elements. The first 
+ *               3 dimensions should contain the xyz coordinates of the points.
+ *  \param[in] M array (moving set) of `float8` elements. The first 
+ *               3 dimensions should contain the xyz coordinates of the points.
+ *  \param[in] W array (weights) of `float` elements.
+ *  \param[in] shift array of 2 `float4` elements, the reference points 
+ *                   \f$ k_f \f$ and \f$ k_m \f$ for the fixed and moving sets.
+ *  \param[out] Sij array (partial sums). Its number of rows is `17`. The first 
+ *                  `11` rows have the same layout as in `icpSijProducts_Weighted`, 
+ *                  and the last `6` contain the weighted sums of the shifted fixed 
+ *                  and moving points. Its number of columns is \f$ gXdim \f$. So, 
+ *                  its size should be \f$ 17 * gXdim * sizeof\ (float) \f$.
+ *  \param[in] m number of points in the sets.
+ *  \param[in] c scaling factor. 
  */
 kernel
-void icpTransform_Quaternion (global float4 *M, global float4 *tM, constant float4 *data)
+void icpSijProducts_Fused (global float4 *F, global float4 *M, global float *W, 
+                           global float4 *shift, global float *Sij, uint m, float c)
 {
+    m = ICP_N (m);  // Constants in specialized programs
+    c = ICP_SCALE (c);
+
     // Workspace dimensions
     uint gXdim = get_global_size (0);
-    uint gYdim = get_global_size (1);
 
     // Workspace indices
     uint gX = get_global_id (0);
-    uint gY = get_global_id (1);
 
-    // Flatten indices
-    uint idx = gY * gXdim + gX;
+    float3 kf = shift[0].xyz;
+    float3 km = shift[1].xyz;
+
+    float3 A[6];
+    A[0] = (float3) (0.f);  // mx * [fx fy fz]
+    A[1] = (float3) (0.f);  // my * [fx fy fz]
+    A[2] = (float3) (0.f);  // mz * [fx fy fz]
+    A[3] = (float3) (0.f);  // [fp'*fp mp'*mp 0], used for calculating scale s
+    A[4] = (float3) (0.f);  // [fx fy fz]
+    A[5] = (float3) (0.f);  // [mx my mz]
+
+    for (uint pi = gX; pi < m; pi += gXdim)
+    {
+        float3 Fp = (float3) c * (F[pi << 1].xyz - kf);
+        float3 Mp = (float3) c * (M[pi << 1].xyz - km);
+        float w = W[pi];
+
+        A[0] += (float3) w * (Mp.xxx * Fp);
+        A[1] += (float3) w * (Mp.yyy * Fp);
+        A[2] += (float3) w * (Mp.zzz * Fp);
+        A[3] += (float3) (w * dot (Fp, Fp), w * dot (Mp, Mp), 0.f);
+        A[4] += (float3) w * Fp;
+        A[5] += (float3) w * Mp;
+    }
+
+    uint idx = gX;
+    Sij[idx] = A[0].x; idx += gXdim;  // mx * fx
+    Sij[idx] = A[0].y; idx += gXdim;  // mx * fy
+    Sij[idx] = A[0].z; idx += gXdim;  // mx * fz
+    Sij[idx] = A[1].x; idx += gXdim;  // my * fx
+    Sij[idx] = A[1].y; idx += gXdim;  // my * fy
+    Sij[idx] = A[1].z; idx += gXdim;  // my * fz
+    Sij[idx] = A[2].x; idx += gXdim;  // mz * fx
+    Sij[idx] = A[2].y; idx += gXdim;  // mz * fy
+    Sij[idx] = A[2].z; idx += gXdim;  // mz * fz
+    Sij[idx] = A[3].x; idx += gXdim;  // fp' * fp
+    Sij[idx] = A[3].y; idx += gXdim;  // mp' * mp
+    Sij[idx] = A[4].x; idx += gXdim;  // fx
+    Sij[idx] = A[4].y; idx += gXdim;  // fy
+    Sij[idx] = A[4].z; idx += gXdim;  // fz
+    Sij[idx] = A[5].x; idx += gXdim;  // mx
+    Sij[idx] = A[5].y; idx += gXdim;  // my
+    Sij[idx] = A[5].z;                // mz
+}
+
+
+/*! \brief Recovers the S matrix and the means from the sums of `icpSijProducts_Fused`.
+ *  \details Applies the shifted-covariance identity on the reduced sums. The means 
+ *           are written in place of the reference points, so the next iteration 
+ *           uses them as its shift.
+ *  \note The global workspace should be one dimensional, with only one work-item.
+ *
+ *  \param[in] sums array of `17` `float` elements (the reduced sums).
+ *  \param[in] sum_w sum of the weights.
+ *  \param[in,out] mean array of 2 `float4` elements. On input, it holds the reference 
+ *                      points of `icpSijProducts_Fused`. On output, it holds the 
+ *                      weighted means of the fixed and moving sets.
+ *  \param[out] Sij array of `11` `float` elements, with the same layout as the output 
+ *                  of `ICPS<ICPSConfig::WEIGHTED>`, the `S` matrix (first 9 floats) and 
+ *                  the constituents of the scale factor `s` (last 2 floats).
+ *  \param[in] c scaling factor. 
+ */
+kernel
+void icpSijFinalize_Fused (global float *sums, constant double *sum_w, 
+                           global float4 *mean, global float *Sij, float c)
+{
+    c = ICP_SCALE (c);  // Constant in specialized programs
+
+    float w = (float) sum_w[0];
+
+    float3 dF = vload3 (0, sums + 11) / w;
+    float3 dM = vload3 (0, sums + 14) / w;
+
+    float df[3] = { dF.x, dF.y, dF.z };
+    float dm[3] = { dM.x, dM.y, dM.z };
+
+    for (uint i = 0; i < 3; ++i)
+        for (uint j = 0; j < 3; ++j)
+            Sij[i * 3 + j] = sums[i * 3 + j] - w * dm[i] * df[j];
+    Sij[9]  = sums[9]  - w * dot (dF, dF);
+    Sij[10] = sums[10] - w * dot (dM, dM);
+
+    mean[0] = (float4) (mean[0].xyz + dF / c, 0.f);
+    mean[1] = (float4) (mean[1].xyz + dM / c, 0.f);
+}
+
+
+/*! \brief Produces weights that mask the padding of a set of points.
+ *  \details Copies the homogeneous coordinate of every point to the weights. 
+ *           The valid points carry a `1` there, and the points that pad a set 
+ *           up to a fixed size carry a `0`. It's meant to feed `icpSijProducts_Fused` 
+ *           with a set whose valid points are not contiguous, e.g. after an `RBC search` 
+ *           has permuted it.
+ *  \note The global workspace should be one dimensional and its **x** dimension, 
+ *        \f$ gXdim \f$, should be equal to the number of points, `m`, in the set. 
+ *        There is no requirement for the local workspace.
+ *
+ *  \param[in] M array of `float8` elements. The first 4 dimensions should 
+ *               contain the homogeneous coordinates of the points.
+ *  \param[out] W array (weights) of `float` elements.
+ */
+kernel
+void icpValidWeights (global float4 *M, global float *W)
+{
+    uint gX = get_global_id (0);
+
+    W[gX] = M[gX << 1].w;
+}
+
+
+/*! \brief Performs a homogeneous transformation on a set of points, \f$ p = 
+ *         \left[ \begin{matrix} p_x & p_y & p_z & 1 \end{matrix} \right]^T \f$ 
+ *         (or as a quaternion, \f$ \dot{p} = \left[ \begin{matrix} p_x & p_y & 
+ *         p_z & 0 \end{matrix} \right]^T \f$), using unit quaternions \f$ \dot{q} 
+ *         = (\omega, \mathcal{v}) = q_w + (q_x i + q_y j + q_z k) = \left[ 
+ *         \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+ *         where \f$ \dot{q}\cdot\dot{q}=1 \f$.
+ *  \details Transforms each point in a set, \f$\ p' = s\dot{q}\dot{p}\dot{q}^*+t = 
+ *           s(p + 2\mathcal{v} \times (\mathcal{v} \times p + \omega p)) + t \f$. 
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        equal to 2.  That is, \f$ \ gXdim = 2 \f$. The **y** dimension of the 
+ *        global workspace should be equal to the number of points, `m`, in the 
+ *        sets. That is, \f$ \ gYdim = m \f$. There is no requirement for the 
+ *        local workspace.
+ *  \note For a batch of sets, stored one after the other, the **z** dimension 
+ *        of the global workspace should be equal to the number of sets. The 
+ *        `data` array should then hold one transformation per set.
+ *
+ *  \param[in] M array of `float8` elements. The first 4 dimensions should 
+ *               contain the homogeneous coordinates of the points.
+ *  \param[out] tM array of `float8` elements. The first 4 dimensions will 
+ *                 contain the transformed homogeneous coordinates of the points.
+ *  \param[in] data array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
+ *                  is the **quaternion**, and the second is the **translation vector**. 
+ *                  If there is a need to apply **scaling**, the factor should be available 
+ *                  in the last element of the translation vector. That is, 
+ *                  \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & s \end{matrix} \right]^T \f$.
+ */
+kernel
+void icpTransform_Quaternion (global float4 *M, global float4 *tM, constant float4 *data)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint gYdim = get_global_size (1);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+    uint gZ = get_global_id (2);
+
+    // Choose pair
+    M += gZ * gYdim * gXdim;
+    tM += gZ * gYdim * gXdim;
+    data += gZ << 1;
+
+    // Flatten indices
+    uint idx = gY * gXdim + gX;
 
     // Rearrange indices
     uint gX1 = idx / gYdim;
@@ -933,6 +1624,144 @@ void icpTransform_Matrix (global float4 *M, global float4 *tM, constant float4 *
 }
 
 
+/*! \brief Splits a set of interleaved points into separate geometry and color streams.
+ *  \details Each `float8` point, \f$ \left[ \begin{matrix} x & y & z & w & r & g 
+ *           & b & a \end{matrix} \right] \f$, is written as a `float4` geometry 
+ *           element, \f$ \left[ \begin{matrix} x & y & z & w \end{matrix} \right] \f$, 
+ *           and a normalized `uchar4` color element, \f$ \left[ \begin{matrix} 
+ *           255r & 255g & 255b & 255a \end{matrix} \right] \f$.
+ *  \note The color channels are expected to be in the range \f$ [0,1] \f$. 
+ *        Values outside of it are saturated.
+ *  \note The global workspace should be one dimensional and equal to the 
+ *        number of points, `m`, in the set. That is, \f$ \ gXdim = m \f$. 
+ *        There is no requirement for the local workspace.
+ *
+ *  \param[in] in array of `float8` elements.
+ *  \param[out] geom array of `float4` elements (geometry stream).
+ *  \param[out] color array of `uchar4` elements (color stream).
+ */
+kernel
+void icpSplit_SoA (global float8 *in, global float4 *geom, global uchar4 *color)
+{
+    uint gX = get_global_id (0);
+
+    float8 p = in[gX];
+
+    geom[gX] = p.lo;
+    color[gX] = convert_uchar4_sat_rte (p.hi * 255.f);
+}
+
+
+/*! \brief Merges separate geometry and color streams into a set of interleaved points.
+ *  \details Inverse operation of `icpSplit_SoA`. The color channels are 
+ *           restored in the range \f$ [0,1] \f$.
+ *  \note The global workspace should be one dimensional and equal to the 
+ *        number of points, `m`, in the set. That is, \f$ \ gXdim = m \f$. 
+ *        There is no requirement for the local workspace.
+ *
+ *  \param[in] geom array of `float4` elements (geometry stream).
+ *  \param[in] color array of `uchar4` elements (color stream).
+ *  \param[out] out array of `float8` elements.
+ */
+kernel
+void icpMerge_SoA (global float4 *geom, global uchar4 *color, global float8 *out)
+{
+    uint gX = get_global_id (0);
+
+    out[gX] = (float8) (geom[gX], convert_float4 (color[gX]) / 255.f);
+}
+
+
+/*! \brief Splits a set of interleaved points into a geometry stream and a `half` color stream.
+ *  \details Same as `icpSplit_SoA`, but the color channels are stored as 
+ *           `half` values, 8 bytes per point. `vstore_half` is a core function, 
+ *           so the `cl_khr_fp16` extension is not required.
+ *  \note The global workspace should be one dimensional and equal to the 
+ *        number of points, `m`, in the set. That is, \f$ \ gXdim = m \f$. 
+ *        There is no requirement for the local workspace.
+ *
+ *  \param[in] in array of `float8` elements.
+ *  \param[out] geom array of `float4` elements (geometry stream).
+ *  \param[out] color array of `half4` elements (color stream).
+ */
+kernel
+void icpSplit_SoA_Half (global float8 *in, global float4 *geom, global half *color)
+{
+    uint gX = get_global_id (0);
+
+    float8 p = in[gX];
+
+    geom[gX] = p.lo;
+    vstore_half4_rte (p.hi, gX, color);
+}
+
+
+/*! \brief Merges a geometry stream and a `half` color stream into a set of interleaved points.
+ *  \details Inverse operation of `icpSplit_SoA_Half`.
+ *  \note The global workspace should be one dimensional and equal to the 
+ *        number of points, `m`, in the set. That is, \f$ \ gXdim = m \f$. 
+ *        There is no requirement for the local workspace.
+ *
+ *  \param[in] geom array of `float4` elements (geometry stream).
+ *  \param[in] color array of `half4` elements (color stream).
+ *  \param[out] out array of `float8` elements.
+ */
+kernel
+void icpMerge_SoA_Half (global float4 *geom, global half *color, global float8 *out)
+{
+    uint gX = get_global_id (0);
+
+    out[gX] = (float8) (geom[gX], vload_half4 (gX, color));
+}
+
+
+/*! \brief Performs a homogeneous transformation on the geometry stream of a set of points.
+ *  \details Transforms each point in a set, \f$\ p' = s\dot{q}\dot{p}\dot{q}^*+t = 
+ *           s(p + 2\mathcal{v} \times (\mathcal{v} \times p + \omega p)) + t \f$. 
+ *           It's the structure-of-arrays counterpart of `icpTransform_Quaternion`. 
+ *           Only the geometry is read and written, 16 bytes per point instead of 32.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        equal to the number of points, `m`, in the sets. That is, \f$ \ gXdim = m \f$. 
+ *        There is no requirement for the local workspace.
+ *  \note For a batch of sets, stored one after the other, the **y** dimension 
+ *        of the global workspace should be equal to the number of sets. The 
+ *        `data` array should then hold one transformation per set.
+ *
+ *  \param[in] M array of `float4` elements with the homogeneous coordinates of the points.
+ *  \param[out] tM array of `float4` elements with the transformed homogeneous 
+ *                 coordinates of the points.
+ *  \param[in] data array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
+ *                  is the **quaternion**, and the second is the **translation vector**. 
+ *                  If there is a need to apply **scaling**, the factor should be available 
+ *                  in the last element of the translation vector. That is, 
+ *                  \f$ t = \left[ \begin{matrix} t_x & t_y & t_z & s \end{matrix} \right]^T \f$.
+ */
+kernel
+void icpTransform_Quaternion_SoA (global float4 *M, global float4 *tM, constant float4 *data)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+
+    // Choose pair
+    uint idx = gY * gXdim + gX;
+    data += gY << 1;
+
+    float4 q = data[0];
+    float4 t = data[1];
+
+    float4 tp = M[idx];
+    float3 p = tp.xyz;
+
+    tp.xyz = t.w * (p + cross (2 * q.xyz, cross (q.xyz, p) + q.w * p)) + t.xyz;
+
+    tM[idx] = tp;
+}
+
+
 /*! \brief Computes a matrix-vector product, \f$ x_{new}=Nx \f$.
  *
  *  \param[in] N `4x4` matrix (`4xfloat4` elements).
@@ -959,23 +1788,52 @@ void prod (float4 *N, float4 *x, float4 *x_new)
  *        one corresponding to the most positive eigenvalue \f$\lambda\f$. If \f$ \mu<0 \f$, 
  *        the algorithm is executed again on \f$ N'=N + |\lambda| I \f$. Then, the eigenvalue 
  *        \f$ \lambda \f$ is \f$ \mu' - \mu \f$. The corresponding eigenvector doesn't change.
- *  \note The kernel should be dispatched as a task (1 work-item).
+ *  \note The iterations stop when the step between two consecutive estimates drops to 
+ *        `tolerance`, or when it stops changing. At most `maxIterations` iterations are 
+ *        performed in total, including the ones after a shift. The host classes default 
+ *        to `2000`, which covers the `1000` iterations per pass that the kernel used to 
+ *        allow. With a `warmStart`, the iterations start from the quaternion already in 
+ *        `Tk` (the previous \f$ q_k \f$), which near convergence is close to the solution. 
+ *        An invalid quaternion (e.g., an uninitialized buffer) falls back to the default 
+ *        starting vector.
+ *  \note If the iterations run out while the estimate still belongs to a negative 
+ *        eigenvalue, that is, before the shift, the rotation falls back to the 
+ *        identity, \f$ q_k = \left[ \begin{matrix} 0 & 0 & 0 & 1 \end{matrix} \right]^T \f$, 
+ *        and only the scale and translation are updated in that iteration. If they 
+ *        run out after the shift, the last estimate on \f$ N' \f$ is kept.
+ *  \note The kernel should be dispatched as a task (1 work-item). For a batch of 
+ *        set pairs, it should be dispatched with one work-item per pair, and 
+ *        the arrays should hold the quantities of each pair one after the other.
  *
  *  \param[in] Sij array (sums of products) of size \f$11*sizeof\ (float)\f$.
  *                 The first `9` elements (in row major order) are the \f$S_k\f$ matrix, and 
  *                 the next `2` are the numerator and denominator of the scale \f$s_k\f$.
  *  \param[in] means array (fixed and moving set means) of size \f$2*sizeof\ (float4)\f$.
- *  \param[out] Tk array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
+ *  \param[in,out] Tk array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
  *                 is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
  *                 \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
  *                 and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
  *                 t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
  *                 in the last element of the translation vector. That is, \f$ t_k = 
  *                 \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$.
+ *                 When `warmStart` is set, the quaternion is also read as the starting vector.
+ *  \param[out] iterations array of size \f$ sizeof\ (uint) \f$. The number of 
+ *                         Power Method iterations that were performed.
+ *  \param[in] tolerance convergence threshold on the distance between two consecutive estimates.
+ *  \param[in] maxIterations maximum number of Power Method iterations.
+ *  \param[in] warmStart flag to indicate whether to start from the quaternion in `Tk`.
  */
 kernel
-void icpPowerMethod (global float *Sij, global float4 *means, global float4 *Tk)
+void icpPowerMethod (global float *Sij, global float4 *means, global float4 *Tk, 
+                     global uint *iterations, float tolerance, uint maxIterations, uint warmStart)
 {
+    // Choose pair
+    uint gX = get_global_id (0);
+    Sij += gX * 11;
+    means += gX << 1;
+    Tk += gX << 1;
+    iterations += gX;
+
     float Sxx = Sij[0];
     float Sxy = Sij[1];
     float Sxz = Sij[2];
@@ -1000,45 +1858,69 @@ void icpPowerMethod (global float *Sij, global float4 *means, global float4 *Tk)
 
     // Power Method ============================================================
 
-    float4 x = (float4) (1.f);
+    float4 x0 = (float4) (1.f);
+    if (warmStart)
+    {
+        float4 qk_prev = Tk[0];
+        float norm2 = dot (qk_prev, qk_prev);
+        if (norm2 > 0.5f && norm2 < 2.f) x0 = qk_prev;  // False for NaNs too
+    }
+
+    float4 x = x0;
     float4 x_new;
 
     // Parameters
-    uint maxIter = 1000;
-    float error, error_new;
+    uint iter = 0;
+    float error, error_new = -1.f;
+    bool valid = true;
 
     while (true)
     {
-        for (uint iter = 0; iter < maxIter; ++iter)
+        while (iter < maxIterations)
         {
             prod (N, &x, &x_new);
 
             x_new = fast_normalize (x_new);
+            ++iter;
 
             error = error_new;
-            if ((error_new = fast_distance (x, x_new)) == error) break;
+            error_new = fast_distance (x, x_new);
+            if (error_new <= tolerance || error_new == error) break;
 
             x = x_new;
         }
 
         float lambda = dot (N[0], x_new) / x_new.x;
 
-        if (lambda < 0)
-        {
-            N[0].x -= lambda;
-            N[1].y -= lambda;
-            N[2].z -= lambda;
-            N[3].w -= lambda;
+        if (!(lambda < 0)) break;
 
-            x = (float4) (1.f);
-        }
-        else
+        // The estimate belongs to the negative eigenvalue, and there 
+        // are no iterations left for the shift, so it's discarded
+        if (iter >= maxIterations)
+        {
+            valid = false;
             break;
+        }
+
+        N[0].x -= lambda;
+        N[1].y -= lambda;
+        N[2].z -= lambda;
+        N[3].w -= lambda;
+
+        x = x0;
+        error_new = -1.f;
     }
 
-    x = x_new;
-    prod (N, &x, &x_new);
-    x_new = normalize (x_new);
+    *iterations = iter;
+
+    if (valid)
+    {
+        x = x_new;
+        prod (N, &x, &x_new);
+        x_new = normalize (x_new);
+    }
+    else
+        x_new = (float4) (0.f, 0.f, 0.f, 1.f);  // Identity rotation
 
     // Transformation ==========================================================
 
@@ -1052,3 +1934,447 @@ void icpPowerMethod (global float *Sij, global float4 *means, global float4 *Tk)
     Tk[0] = qk;
     Tk[1] = (float4) (tk, sk);
 }
+
+
+/*! \brief Computes the quantities that represent the incremental development 
+ *         in the transformation estimation in iteration `k`.
+ *  \details Solves the orthogonal Procrustes problem on the device, as described 
+ *           by `Arun` et al. Given \f$ S=U\Sigma V^T \f$, the rotation is \f$ R_k = 
+ *           VDU^T \f$, \f$ D=diag(1,1,det(VU^T)) \f$. The right singular vectors come 
+ *           from a cyclic Jacobi eigen-decomposition of \f$ S^TS=V\Sigma^2V^T \f$, and 
+ *           the left ones from Gram-Schmidt on \f$ SV=U\Sigma \f$. Then, the scale 
+ *           \f$ s_k \f$ and translation \f$ t_k \f$ are computed.
+ *  \note The third left singular vector is taken as \f$ u_1 \times u_2 \f$, which 
+ *        folds the reflection correction into \f$ R_k = v_1u_1^T+v_2u_2^T+det(V) 
+ *        v_3(u_1 \times u_2)^T \f$, and keeps the solution well defined when 
+ *        \f$ S \f$ has rank 2 (e.g., planar scenes).
+ *  \note The kernel should be dispatched as a task (1 work-item). For a batch of 
+ *        set pairs, it should be dispatched with one work-item per pair, and 
+ *        the arrays should hold the quantities of each pair one after the other.
+ *
+ *  \param[in] Sij array (sums of products) of size \f$11*sizeof\ (float)\f$.
+ *                 The first `9` elements (in row major order) are the \f$S_k\f$ matrix, and 
+ *                 the next `2` are the numerator and denominator of the scale \f$s_k\f$.
+ *  \param[in] means array (fixed and moving set means) of size \f$2*sizeof\ (float4)\f$.
+ *  \param[out] Tk array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
+ *                 is the **unit quaternion** \f$ \dot{q_k} = q_w + q_x i + q_y j + q_z k = 
+ *                 \left[ \begin{matrix} q_x & q_y & q_z & q_w \end{matrix} \right]^T \f$, 
+ *                 and the second one is the **translation vector** \f$ t_k=\left[ \begin{matrix} 
+ *                 t_x & t_y & t_z & 1 \end{matrix} \right]^T \f$. The scale is placed 
+ *                 in the last element of the translation vector. That is, \f$ t_k = 
+ *                 \left[ \begin{matrix} t_x & t_y & t_z & s_k \end{matrix} \right]^T \f$.
+ */
+kernel
+void icpSVD (global float *Sij, global float4 *means, global float4 *Tk)
+{
+    // Choose pair
+    uint gX = get_global_id (0);
+    Sij += gX * 11;
+    means += gX << 1;
+    Tk += gX << 1;
+
+    // The rotation doesn't depend on the magnitude of S, so normalize it
+    float S[3][3];
+    float maxS = 0.f;
+    for (uint i = 0; i < 3; ++i)
+        for (uint j = 0; j < 3; ++j)
+            maxS = fmax (maxS, fabs (S[i][j] = Sij[i * 3 + j]));
+    maxS = (maxS > 0.f) ? maxS : 1.f;
+    for (uint i = 0; i < 3; ++i)
+        for (uint j = 0; j < 3; ++j)
+            S[i][j] /= maxS;
+
+    float sk = sqrt (Sij[9] / Sij[10]);
+
+    prefetch (means, 2);
+
+    // A = S^T S
+    float A[3][3], V[3][3];
+    for (uint i = 0; i < 3; ++i)
+    {
+        for (uint j = 0; j < 3; ++j)
+        {
+            A[i][j] = S[0][i] * S[0][j] + S[1][i] * S[1][j] + S[2][i] * S[2][j];
+            V[i][j] = (i == j) ? 1.f : 0.f;
+        }
+    }
+
+    // Cyclic Jacobi ===========================================================
+
+    for (uint sweep = 0; sweep < 8; ++sweep)
+    {
+        for (uint r = 0; r < 3; ++r)
+        {
+            uint p = (r == 2) ? 1 : 0;
+            uint q = (r == 0) ? 1 : 2;
+
+            if (fabs (A[p][q]) < 1e-12f) continue;
+
+            float theta = (A[q][q] - A[p][p]) / (2.f * A[p][q]);
+            float t = sign (theta) / (fabs (theta) + sqrt (theta * theta + 1.f));
+            t = (theta == 0.f) ? 1.f : t;
+            float c = rsqrt (t * t + 1.f);
+            float s = t * c;
+
+            // A <- J^T A J
+            for (uint k = 0; k < 3; ++k)
+            {
+                float akp = A[k][p], akq = A[k][q];
+                A[k][p] = c * akp - s * akq;
+                A[k][q] = s * akp + c * akq;
+            }
+            for (uint k = 0; k < 3; ++k)
+            {
+                float apk = A[p][k], aqk = A[q][k];
+                A[p][k] = c * apk - s * aqk;
+                A[q][k] = s * apk + c * aqk;
+            }
+
+            // V <- V J
+            for (uint k = 0; k < 3; ++k)
+            {
+                float vkp = V[k][p], vkq = V[k][q];
+                V[k][p] = c * vkp - s * vkq;
+                V[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+
+    // Sort the eigenvalues in descending order
+    uint o0 = 0, o1 = 1, o2 = 2, tmp;
+    if (A[o0][o0] < A[o1][o1]) { tmp = o0; o0 = o1; o1 = tmp; }
+    if (A[o1][o1] < A[o2][o2]) { tmp = o1; o1 = o2; o2 = tmp; }
+    if (A[o0][o0] < A[o1][o1]) { tmp = o0; o0 = o1; o1 = tmp; }
+
+    float3 v1 = (float3) (V[0][o0], V[1][o0], V[2][o0]);
+    float3 v2 = (float3) (V[0][o1], V[1][o1], V[2][o1]);
+    float3 v3 = (float3) (V[0][o2], V[1][o2], V[2][o2]);
+
+    // U Sigma = S V
+    float3 s0 = (float3) (S[0][0], S[0][1], S[0][2]);
+    float3 s1 = (float3) (S[1][0], S[1][1], S[1][2]);
+    float3 s2 = (float3) (S[2][0], S[2][1], S[2][2]);
+
+    float3 u1 = normalize ((float3) (dot (s0, v1), dot (s1, v1), dot (s2, v1)));
+    float3 u2 = (float3) (dot (s0, v2), dot (s1, v2), dot (s2, v2));
+    u2 = normalize (u2 - dot (u1, u2) * u1);
+    float3 u3 = cross (u1, u2);
+
+    float detV = dot (v1, cross (v2, v3));
+
+    // R = v1 u1^T + v2 u2^T + det(V) v3 u3^T
+    float3 R0 = v1.x * u1 + v2.x * u2 + detV * v3.x * u3;
+    float3 R1 = v1.y * u1 + v2.y * u2 + detV * v3.y * u3;
+    float3 R2 = v1.z * u1 + v2.z * u2 + detV * v3.z * u3;
+
+    // Rotation matrix to quaternion ===========================================
+
+    float4 qk;
+    float trace = R0.x + R1.y + R2.z;
+    if (trace > 0.f)
+    {
+        float w = 0.5f * sqrt (1.f + trace);
+        float f = 0.25f / w;
+        qk = (float4) ((R2.y - R1.z) * f, (R0.z - R2.x) * f, (R1.x - R0.y) * f, w);
+    }
+    else if (R0.x > R1.y && R0.x > R2.z)
+    {
+        float x = 0.5f * sqrt (1.f + R0.x - R1.y - R2.z);
+        float f = 0.25f / x;
+        qk = (float4) (x, (R0.y + R1.x) * f, (R0.z + R2.x) * f, (R2.y - R1.z) * f);
+    }
+    else if (R1.y > R2.z)
+    {
+        float y = 0.5f * sqrt (1.f - R0.x + R1.y - R2.z);
+        float f = 0.25f / y;
+        qk = (float4) ((R0.y + R1.x) * f, y, (R1.z + R2.y) * f, (R0.z - R2.x) * f);
+    }
+    else
+    {
+        float z = 0.5f * sqrt (1.f - R0.x - R1.y + R2.z);
+        float f = 0.25f / z;
+        qk = (float4) ((R0.z + R2.x) * f, (R1.z + R2.y) * f, z, (R1.x - R0.y) * f);
+    }
+    qk = normalize (qk);
+    qk = (qk.w < 0.f) ? -qk : qk;  // Keep the scalar part non-negative
+
+    // Transformation ==========================================================
+
+    float3 mf = means[0].xyz;
+    float3 mm = means[1].xyz;
+
+    float3 tk = mf - sk * (float3) (dot (R0, mm), dot (R1, mm), dot (R2, mm));
+
+    Tk[0] = qk;
+    Tk[1] = (float4) (tk, sk);
+}
+
+
+/*! \brief Produces the sums for the normal equations of the point-to-plane error.
+ *  \details Linearizes the point-to-plane error, \f$ \sum{(n_i \cdot (Rm_i+t-f_i))^2} \f$, 
+ *           for a small rotation \f$ R \approx I+[\omega]_\times \f$ about a pivot \f$ p \f$. 
+ *           With the points shifted and scaled, \f$ \tilde{m}_i=c(m_i-p) \f$ and 
+ *           \f$ \tilde{f}_i=c(f_i-p) \f$, every pair contributes a row \f$ a_i = \left[ 
+ *           \begin{matrix} \tilde{m}_i \times n_i & n_i \end{matrix} \right]^T \f$ and a 
+ *           residual \f$ b_i = n_i \cdot (\tilde{f}_i-\tilde{m}_i) \f$. The kernel accumulates 
+ *           the upper triangle of \f$ A=\sum{a_ia_i^T} \f$, the vector \f$ g=\sum{a_ib_i} \f$, 
+ *           and the sums of the shifted moving points, in one pass over the sets.
+ *  \details The normal of a fixed point is looked up in the normal map of the fixed 
+ *           frame, at the pixel the point projects to. That is, the fixed set is expected 
+ *           to be sampled from an organized point cloud, like the one from `icpBackProject`. 
+ *           Pairs without a valid normal don't contribute to the sums.
+ *  \note Each work-item processes up to 4 pairs of points. So, the output 
+ *        of each work-item is partial sums. On a next step, these results 
+ *        will have to be reduced, and then passed to `icpPlaneSolve`.
+ *  \note The global workspace should be one dimensional and its **x** dimension, 
+ *        \f$ gXdim \f$, should be greater or equal to the number of points, `m`, 
+ *        in the sets divided by 4. That is, \f$ \ gXdim \geq m/4 \f$. There is no 
+ *        requirement for the local workspace.
+ *
+ *  \param[in] F array (fixed set) of `float8` elements. The first 
+ *               3 dimensions should contain the xyz coordinates of the points.
+ *  \param[in] M array (moving set) of `float8` elements. The first 
+ *               3 dimensions should contain the xyz coordinates of the points.
+ *  \param[in] N array (normal map of the fixed frame) of `float4` elements, 
+ *               as produced by `icpNormals`.
+ *  \param[in] pivot array of 1 `float4` element, the pivot \f$ p \f$.
+ *  \param[out] sums array (partial sums). Its number of rows is `31`. The first 
+ *                   `21` rows are the upper triangle of \f$ A \f$ in row major order, 
+ *                   the next `6` are \f$ g \f$, the next `3` are the sums of the shifted 
+ *                   moving points, and the last one is the number of valid pairs. Its 
+ *                   number of columns is \f$ gXdim \f$. So, its size should be 
+ *                   \f$ 31 * gXdim * sizeof\ (float) \f$.
+ *  \param[in] intrinsics camera parameters of the fixed frame, \f$ intrinsics = \left[ 
+ *                        \begin{matrix} f_x & f_y & c_x & c_y \end{matrix} \right] \f$.
+ *  \param[in] width width (in pixels) of the normal map.
+ *  \param[in] height height (in pixels) of the normal map.
+ *  \param[in] m number of points in the sets.
+ *  \param[in] c scaling factor. 
+ */
+kernel
+void icpPlaneProducts (global float4 *F, global float4 *M, global float4 *N, global float4 *pivot, 
+                       global float *sums, float4 intrinsics, uint width, uint height, uint m, float c)
+{
+    m = ICP_N (m);  // Constants in specialized programs
+    c = ICP_SCALE (c);
+
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+
+    float3 p = pivot[0].xyz;
+
+    float S[31];
+    for (uint k = 0; k < 31; ++k)
+        S[k] = 0.f;
+
+    for (uint pi = gX; pi < m; pi += gXdim)
+    {
+        float3 f = F[pi << 1].xyz;
+        float3 mp = M[pi << 1].xyz;
+
+        // Look up the normal at the pixel of the fixed point
+        int2 uv = convert_int2_rte (f.xy * intrinsics.xy / f.z + intrinsics.zw);
+        float3 n = (float3) (0.f);
+        if (f.z > 0.f && uv.x >= 0 && uv.y >= 0 && uv.x < (int) width && uv.y < (int) height)
+            n = N[uv.y * width + uv.x].xyz;
+        float w = (dot (n, n) > 0.f) ? 1.f : 0.f;
+
+        float3 Mp = (float3) c * (mp - p);
+        float3 Fp = (float3) c * (f - p);
+
+        float3 cr = cross (Mp, n);
+        float a[6] = { cr.x, cr.y, cr.z, n.x, n.y, n.z };
+        float b = dot (n, Fp - Mp);
+
+        uint k = 0;
+        for (uint i = 0; i < 6; ++i)
+            for (uint j = i; j < 6; ++j)
+                S[k++] += a[i] * a[j];
+        for (uint i = 0; i < 6; ++i)
+            S[k++] += a[i] * b;
+        S[27] += w * Mp.x;
+        S[28] += w * Mp.y;
+        S[29] += w * Mp.z;
+        S[30] += w;
+    }
+
+    for (uint k = 0; k < 31; ++k)
+        sums[k * gXdim + gX] = S[k];
+}
+
+
+/*! \brief Solves the normal equations of the point-to-plane error.
+ *  \details Solves the \f$ 6 \times 6 \f$ system \f$ Ax=g \f$, produced by 
+ *           `icpPlaneProducts`, for \f$ x = \left[ \begin{matrix} \omega & \tilde{t} 
+ *           \end{matrix} \right]^T \f$. The system is equilibrated to a unit diagonal, 
+ *           which puts the rotation and translation blocks on the same scale, slightly 
+ *           damped, and solved with a Cholesky decomposition. The rotation \f$ \omega \f$ 
+ *           is converted to a unit quaternion, and the rotation about the pivot to a 
+ *           translation, \f$ t_k = p+\tilde{t}/c-R_kp \f$.
+ *  \details The mean of the moving set, after the incremental transformation, becomes 
+ *           the pivot of the next iteration.
+ *  \note The kernel should be dispatched as a task (1 work-item).
+ *
+ *  \param[in] S array of `31` `float` elements (the reduced sums).
+ *  \param[in,out] pivot array of 1 `float4` element, the pivot \f$ p \f$.
+ *  \param[out] Tk array of size \f$ 2 * sizeof\ (float4) \f$, with the same layout 
+ *                 as the output of `icpSVD`. The scale \f$ s_k \f$ is always `1`.
+ *  \param[in] c scaling factor. 
+ */
+kernel
+void icpPlaneSolve (global float *S, global float4 *pivot, global float4 *Tk, float c)
+{
+    c = ICP_SCALE (c);  // Constant in specialized programs
+
+    float A[6][6], g[6], D[6];
+
+    uint k = 0;
+    for (uint i = 0; i < 6; ++i)
+        for (uint j = i; j < 6; ++j)
+            A[i][j] = A[j][i] = S[k++];
+    for (uint i = 0; i < 6; ++i)
+        g[i] = S[k++];
+
+    // Equilibrate the system, and damp it slightly
+    for (uint i = 0; i < 6; ++i)
+        D[i] = (A[i][i] > 0.f) ? rsqrt (A[i][i]) : 0.f;
+    for (uint i = 0; i < 6; ++i)
+    {
+        for (uint j = 0; j < 6; ++j)
+            A[i][j] *= D[i] * D[j];
+        A[i][i] = (D[i] > 0.f) ? A[i][i] + 1e-6f : 1.f;
+        g[i] *= D[i];
+    }
+
+    // Cholesky decomposition, A = L L^T (in the lower triangle)
+    for (uint j = 0; j < 6; ++j)
+    {
+        float d = A[j][j];
+        for (uint k = 0; k < j; ++k)
+            d -= A[j][k] * A[j][k];
+        A[j][j] = sqrt (fmax (d, 1e-12f));
+
+        for (uint i = j + 1; i < 6; ++i)
+        {
+            float v = A[i][j];
+            for (uint k = 0; k < j; ++k)
+                v -= A[i][k] * A[j][k];
+            A[i][j] = v / A[j][j];
+        }
+    }
+
+    // L y = g, L^T x = y
+    float x[6];
+    for (uint i = 0; i < 6; ++i)
+    {
+        float v = g[i];
+        for (uint k = 0; k < i; ++k)
+            v -= A[i][k] * x[k];
+        x[i] = v / A[i][i];
+    }
+    for (int i = 5; i >= 0; --i)
+    {
+        float v = x[i];
+        for (uint k = i + 1; k < 6; ++k)
+            v -= A[k][i] * x[k];
+        x[i] = v / A[i][i];
+    }
+    for (uint i = 0; i < 6; ++i)
+        x[i] *= D[i];
+
+    // Transformation ==========================================================
+
+    float3 omega = (float3) (x[0], x[1], x[2]);
+    float theta = length (omega);
+
+    float4 qk = (float4) (0.f, 0.f, 0.f, 1.f);
+    if (theta > 0.f)
+        qk = (float4) (sin (0.5f * theta) * omega / theta, cos (0.5f * theta));
+
+    float3 p = pivot[0].xyz;
+    float3 Rp = p + cross (2 * qk.xyz, cross (qk.xyz, p) + qk.w * p);
+    float3 tk = p + (float3) (x[3], x[4], x[5]) / c - Rp;
+
+    Tk[0] = qk;
+    Tk[1] = (float4) (tk, 1.f);
+
+    // The next pivot is the transformed mean of the moving set
+    if (S[30] > 0.f)
+    {
+        float3 mm = p + vload3 (0, S + 27) / (c * S[30]);
+        pivot[0] = (float4) (mm + cross (2 * qk.xyz, cross (qk.xyz, mm) + qk.w * mm) + tk, 0.f);
+    }
+}
+
+
+/*! \brief Updates the transformation estimation with the incremental development 
+ *         of iteration `k`, and checks for convergence.
+ *  \details Composes the incremental transformation \f$ (\dot{q}_k,t_k,s_k) \f$ with 
+ *           the current estimation \f$ (\dot{q},t,s) \f$. That is, \f$ \dot{q}' = 
+ *           \dot{q}_k\dot{q} \f$, \f$ t' = s_k\dot{q}_kt\dot{q}_k^*+t_k \f$, and 
+ *           \f$ s' = s_ks \f$. Then, the change in angle, \f$ 2\ atan2(\|\mathcal{v}_k\|, 
+ *           \omega_k) \f$, and in translation, \f$ \|t_k\| \f$, are compared against 
+ *           the thresholds. When both are below them, the convergence flag gets raised.
+ *  \note Once convergence has been flagged, the kernel leaves the transformation 
+ *        intact. This way, a batch of iterations can be enqueued at once, and the 
+ *        host only has to check the flag at the end of the batch.
+ *  \note The kernel should be dispatched as a task (1 work-item). For a batch of 
+ *        set pairs, it should be dispatched with one work-item per pair, and 
+ *        the arrays should hold the quantities of each pair one after the other. 
+ *        The convergence flags then act as per-pair masks.
+ *
+ *  \param[in] Tk array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
+ *                is the incremental **unit quaternion**, and the second one is the 
+ *                incremental **translation vector**, with the scale \f$ s_k \f$ in 
+ *                its last element. That is the output of `icpPowerMethod`.
+ *  \param[in,out] T array of size \f$ 2 * sizeof\ (float4) \f$. The first `float4` 
+ *                   is the **quaternion**, and the second one is the **translation 
+ *                   vector**, with the scale \f$ s \f$ in its last element.
+ *  \param[in,out] C array of size \f$ 2 * sizeof\ (uint) \f$. The first element is 
+ *                   the convergence flag, and the second one is the number of 
+ *                   iterations performed. Both should be zeroed before a registration.
+ *  \param[in] angle_threshold threshold for the change in angle (in degrees).
+ *  \param[in] translation_threshold threshold for the change in translation (in mm).
+ */
+kernel
+void icpUpdateTransform (global float4 *Tk, global float4 *T, global uint *C, 
+                         float angle_threshold, float translation_threshold)
+{
+    // Choose pair
+    uint gX = get_global_id (0);
+    Tk += gX << 1;
+    T += gX << 1;
+    C += gX << 1;
+
+    if (C[0]) return;
+
+    float4 qk = Tk[0];
+    float4 tk = Tk[1];
+    float4 q = T[0];
+    float4 t = T[1];
+
+    // Compose the rotations, q = qk * q
+    float4 q_new;
+    q_new.xyz = qk.w * q.xyz + q.w * qk.xyz + cross (qk.xyz, q.xyz);
+    q_new.w = qk.w * q.w - dot (qk.xyz, q.xyz);
+    q_new = normalize (q_new);
+
+    // Update the translation, t = sk * Rk * t + tk
+    float3 p = t.xyz;
+    float3 t_new = tk.w * (p + cross (2 * qk.xyz, cross (qk.xyz, p) + qk.w * p)) + tk.xyz;
+
+    T[0] = q_new;
+    T[1] = (float4) (t_new, tk.w * t.w);
+
+    // Convergence check =======================================================
+
+    float delta_angle = 180.f / M_PI_F * 2.f * atan2 (length (qk.xyz), qk.w);  // in degrees
+    float delta_translation = length (tk.xyz);  // in mm
+
+    C[1] += 1;
+    if (delta_angle < angle_threshold && delta_translation < translation_threshold)
+        C[0] = 1;
+}
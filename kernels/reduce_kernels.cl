@@ -262,3 +262,352 @@ void reduce_sum_f (global float4 *in, global float *out, local float *data, uint
     if (lX == 0) 
         out[gY * wgXdim + wgX] = data[0];
 }
+
+
+/*! \brief Subgroup support.
+ *  \details When the device exposes `cl_khr_subgroups` (with OpenCL C 2.0), or 
+ *           `cl_intel_subgroups`, the work-group reductions of the single-pass 
+ *           kernels are performed with `sub_group_reduce_*`, and a barrier is only 
+ *           needed to combine the results of the subgroups. Otherwise, they fall 
+ *           back to the local memory tree reductions.
+ */
+#if defined (cl_khr_subgroups) && __OPENCL_C_VERSION__ >= 200
+    #pragma OPENCL EXTENSION cl_khr_subgroups : enable
+    #define REDUCE_SUBGROUPS
+#elif defined (cl_intel_subgroups)
+    #pragma OPENCL EXTENSION cl_intel_subgroups : enable
+    #define REDUCE_SUBGROUPS
+#endif
+
+
+/*! \brief Reduces a value per work-item to the minimum in the work-group.
+ *  \note The number of work-items in a work-group should be a **power of 2**. 
+ *        With subgroups, the partials of the subgroups are combined in strides 
+ *        of the subgroup size, so there is no limit on the number of subgroups.
+ *
+ *  \param[in] x value of the work-item.
+ *  \param[in] data local buffer of at least \f$ lXdim*sizeof\ (float) \f$.
+ *  \return The minimum. It's valid only for the first work-item.
+ */
+inline
+float wgReduceMin_f (float x, local float *data)
+{
+    uint lX = get_local_id (0);
+    barrier (CLK_LOCAL_MEM_FENCE);  // data might be in use
+
+#ifdef REDUCE_SUBGROUPS
+    x = sub_group_reduce_min (x);
+    if (get_num_sub_groups () == 1) return x;
+
+    if (get_sub_group_local_id () == 0) data[get_sub_group_id ()] = x;
+    barrier (CLK_LOCAL_MEM_FENCE);
+    // Every subgroup combines the partials, in strides of the subgroup size, 
+    // since there might be more subgroups than work-items in a subgroup
+    x = INFINITY;
+    for (uint i = get_sub_group_local_id (); i < get_num_sub_groups (); i += get_sub_group_size ())
+        x = fmin (x, data[i]);
+    return sub_group_reduce_min (x);
+#else
+    data[lX] = x;
+    for (uint d = get_local_size (0) >> 1; d > 0; d >>= 1)
+    {
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (lX < d)
+            data[lX] = fmin (data[lX], data[lX + d]);
+    }
+    return data[0];
+#endif
+}
+
+
+/*! \brief Reduces a value per work-item to the maximum in the work-group.
+ *  \note The number of work-items in a work-group should be a **power of 2**. 
+ *        With subgroups, the partials of the subgroups are combined in strides 
+ *        of the subgroup size, so there is no limit on the number of subgroups.
+ *
+ *  \param[in] x value of the work-item.
+ *  \param[in] data local buffer of at least \f$ lXdim*sizeof\ (uint) \f$.
+ *  \return The maximum. It's valid only for the first work-item.
+ */
+inline
+uint wgReduceMax_ui (uint x, local uint *data)
+{
+    uint lX = get_local_id (0);
+    barrier (CLK_LOCAL_MEM_FENCE);  // data might be in use
+
+#ifdef REDUCE_SUBGROUPS
+    x = sub_group_reduce_max (x);
+    if (get_num_sub_groups () == 1) return x;
+
+    if (get_sub_group_local_id () == 0) data[get_sub_group_id ()] = x;
+    barrier (CLK_LOCAL_MEM_FENCE);
+    // Every subgroup combines the partials, in strides of the subgroup size, 
+    // since there might be more subgroups than work-items in a subgroup
+    x = 0;
+    for (uint i = get_sub_group_local_id (); i < get_num_sub_groups (); i += get_sub_group_size ())
+        x = max (x, data[i]);
+    return sub_group_reduce_max (x);
+#else
+    data[lX] = x;
+    for (uint d = get_local_size (0) >> 1; d > 0; d >>= 1)
+    {
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (lX < d)
+            data[lX] = max (data[lX], data[lX + d]);
+    }
+    return data[0];
+#endif
+}
+
+
+/*! \brief Reduces a value per work-item to the sum in the work-group.
+ *  \note The number of work-items in a work-group should be a **power of 2**. 
+ *        With subgroups, the partials of the subgroups are combined in strides 
+ *        of the subgroup size, so there is no limit on the number of subgroups.
+ *
+ *  \param[in] x value of the work-item.
+ *  \param[in] data local buffer of at least \f$ lXdim*sizeof\ (float) \f$.
+ *  \return The sum. It's valid only for the first work-item.
+ */
+inline
+float wgReduceSum_f (float x, local float *data)
+{
+    uint lX = get_local_id (0);
+    barrier (CLK_LOCAL_MEM_FENCE);  // data might be in use
+
+#ifdef REDUCE_SUBGROUPS
+    x = sub_group_reduce_add (x);
+    if (get_num_sub_groups () == 1) return x;
+
+    if (get_sub_group_local_id () == 0) data[get_sub_group_id ()] = x;
+    barrier (CLK_LOCAL_MEM_FENCE);
+    // Every subgroup combines the partials, in strides of the subgroup size, 
+    // since there might be more subgroups than work-items in a subgroup
+    x = 0.f;
+    for (uint i = get_sub_group_local_id (); i < get_num_sub_groups (); i += get_sub_group_size ())
+        x += data[i];
+    return sub_group_reduce_add (x);
+#else
+    data[lX] = x;
+    for (uint d = get_local_size (0) >> 1; d > 0; d >>= 1)
+    {
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (lX < d)
+            data[lX] += data[lX + d];
+    }
+    return data[0];
+#endif
+}
+
+
+/*! \brief Performs a reduce operation on the columns of an array, in a single launch.
+ *  \details Computes the minimum element for each row in an array. Every work-group 
+ *           reduces a block of the row, and stores its result. The last work-group 
+ *           to finish, on each row, reduces the results of the blocks, and stores 
+ *           the final result (last-block-done pattern).
+ *  \note The number of elements, `N`, in a row of the array should be a **multiple 
+ *        of 4** (the data are handled as `float4`). The work-items stride over 
+ *        the row, so there is no requirement on the **x** dimension of the global 
+ *        workspace, \f$ gXdim \f$. The **y** dimension of the global workspace, 
+ *        \f$ gYdim \f$, should be equal to the number of rows, `M`, in the array. 
+ *        The local workspace should be `1` in the **y** dimension, and a 
+ *        **power of 2** in the **x** dimension.
+ *
+ *  \param[in] in input array of `float` elements.
+ *  \param[out] out (reduced) output array of `float` elements. Its size should be 
+ *                  \f$ rows*sizeof\ (float) \f$.
+ *  \param[out] blocks array with the results of the blocks. Its size should be 
+ *                     \f$ wgXdim*rows*sizeof\ (float) \f$.
+ *  \param[in,out] count array of counters of finished work-groups, one per row. 
+ *                       It should be initialized to `0`. The kernel resets it 
+ *                       to `0` before it returns.
+ *  \param[in] data local buffer. Its size should be \f$ lXdim*sizeof\ (float) \f$.
+ *  \param[in] n number of elements in a row of the array divided by 4.
+ */
+kernel
+void reduce_min_f_SP (global float4 *in, global float *out, volatile global float *blocks, 
+                      global uint *count, local float *data, uint n)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint lXdim = get_local_size (0);
+    uint wgXdim = get_num_groups (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+    uint lX = get_local_id (0);
+    uint wgX = get_group_id (0);
+
+    local uint last;
+
+    float4 a = (float4) (INFINITY);
+    for (uint i = gX; i < n; i += gXdim)
+        a = fmin (a, in[gY * n + i]);
+    float x = wgReduceMin_f (fmin (fmin (a.x, a.y), fmin (a.z, a.w)), data);
+
+    // The last work-group reduces the blocks
+    if (lX == 0)
+    {
+        blocks[gY * wgXdim + wgX] = x;
+        mem_fence (CLK_GLOBAL_MEM_FENCE);
+        last = (atomic_inc (count + gY) == wgXdim - 1);
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    if (last)
+    {
+        x = INFINITY;
+        for (uint i = lX; i < wgXdim; i += lXdim)
+            x = fmin (x, blocks[gY * wgXdim + i]);
+        x = wgReduceMin_f (x, data);
+
+        if (lX == 0)
+        {
+            out[gY] = x;
+            count[gY] = 0;
+        }
+    }
+}
+
+
+/*! \brief Performs a reduce operation on the columns of an array, in a single launch.
+ *  \details Computes the maximum element for each row in an array. Every work-group 
+ *           reduces a block of the row, and stores its result. The last work-group 
+ *           to finish, on each row, reduces the results of the blocks, and stores 
+ *           the final result (last-block-done pattern).
+ *  \note The number of elements, `N`, in a row of the array should be a **multiple 
+ *        of 4** (the data are handled as `uint4`). The work-items stride over 
+ *        the row, so there is no requirement on the **x** dimension of the global 
+ *        workspace, \f$ gXdim \f$. The **y** dimension of the global workspace, 
+ *        \f$ gYdim \f$, should be equal to the number of rows, `M`, in the array. 
+ *        The local workspace should be `1` in the **y** dimension, and a 
+ *        **power of 2** in the **x** dimension.
+ *
+ *  \param[in] in input array of `uint` elements.
+ *  \param[out] out (reduced) output array of `uint` elements. Its size should be 
+ *                  \f$ rows*sizeof\ (uint) \f$.
+ *  \param[out] blocks array with the results of the blocks. Its size should be 
+ *                     \f$ wgXdim*rows*sizeof\ (uint) \f$.
+ *  \param[in,out] count array of counters of finished work-groups, one per row. 
+ *                       It should be initialized to `0`. The kernel resets it 
+ *                       to `0` before it returns.
+ *  \param[in] data local buffer. Its size should be \f$ lXdim*sizeof\ (uint) \f$.
+ *  \param[in] n number of elements in a row of the array divided by 4.
+ */
+kernel
+void reduce_max_ui_SP (global uint4 *in, global uint *out, volatile global uint *blocks, 
+                       global uint *count, local uint *data, uint n)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint lXdim = get_local_size (0);
+    uint wgXdim = get_num_groups (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+    uint lX = get_local_id (0);
+    uint wgX = get_group_id (0);
+
+    local uint last;
+
+    uint4 a = (uint4) (0);
+    for (uint i = gX; i < n; i += gXdim)
+        a = max (a, in[gY * n + i]);
+    uint x = wgReduceMax_ui (max (max (a.x, a.y), max (a.z, a.w)), data);
+
+    // The last work-group reduces the blocks
+    if (lX == 0)
+    {
+        blocks[gY * wgXdim + wgX] = x;
+        mem_fence (CLK_GLOBAL_MEM_FENCE);
+        last = (atomic_inc (count + gY) == wgXdim - 1);
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    if (last)
+    {
+        x = 0;
+        for (uint i = lX; i < wgXdim; i += lXdim)
+            x = max (x, blocks[gY * wgXdim + i]);
+        x = wgReduceMax_ui (x, data);
+
+        if (lX == 0)
+        {
+            out[gY] = x;
+            count[gY] = 0;
+        }
+    }
+}
+
+
+/*! \brief Performs a reduce operation on the columns of an array, in a single launch.
+ *  \details Computes the sum of the elements of each row in an array. Every work-group 
+ *           reduces a block of the row, and stores its result. The last work-group 
+ *           to finish, on each row, reduces the results of the blocks, and stores 
+ *           the final result (last-block-done pattern).
+ *  \note The number of elements, `N`, in a row of the array should be a **multiple 
+ *        of 4** (the data are handled as `float4`). The work-items stride over 
+ *        the row, so there is no requirement on the **x** dimension of the global 
+ *        workspace, \f$ gXdim \f$. The **y** dimension of the global workspace, 
+ *        \f$ gYdim \f$, should be equal to the number of rows, `M`, in the array. 
+ *        The local workspace should be `1` in the **y** dimension, and a 
+ *        **power of 2** in the **x** dimension.
+ *
+ *  \param[in] in input array of `float` elements.
+ *  \param[out] out (reduced) output array of `float` elements. Its size should be 
+ *                  \f$ rows*sizeof\ (float) \f$.
+ *  \param[out] blocks array with the results of the blocks. Its size should be 
+ *                     \f$ wgXdim*rows*sizeof\ (float) \f$.
+ *  \param[in,out] count array of counters of finished work-groups, one per row. 
+ *                       It should be initialized to `0`. The kernel resets it 
+ *                       to `0` before it returns.
+ *  \param[in] data local buffer. Its size should be \f$ lXdim*sizeof\ (float) \f$.
+ *  \param[in] n number of elements in a row of the array divided by 4.
+ */
+kernel
+void reduce_sum_f_SP (global float4 *in, global float *out, volatile global float *blocks, 
+                      global uint *count, local float *data, uint n)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+    uint lXdim = get_local_size (0);
+    uint wgXdim = get_num_groups (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+    uint gY = get_global_id (1);
+    uint lX = get_local_id (0);
+    uint wgX = get_group_id (0);
+
+    local uint last;
+
+    float4 a = (float4) (0.f);
+    for (uint i = gX; i < n; i += gXdim)
+        a += in[gY * n + i];
+    float x = wgReduceSum_f (dot (a, (float4) (1.f)), data);
+
+    // The last work-group reduces the blocks
+    if (lX == 0)
+    {
+        blocks[gY * wgXdim + wgX] = x;
+        mem_fence (CLK_GLOBAL_MEM_FENCE);
+        last = (atomic_inc (count + gY) == wgXdim - 1);
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    if (last)
+    {
+        x = 0.f;
+        for (uint i = lX; i < wgXdim; i += lXdim)
+            x += blocks[gY * wgXdim + i];
+        x = wgReduceSum_f (x, data);
+
+        if (lX == 0)
+        {
+            out[gY] = x;
+            count[gY] = 0;
+        }
+    }
+}
@@ -308,3 +308,333 @@ void addGroupSums_i (global int *sums, global int4 *out, uint n)
     if (gX < n)
         out[gY * n + gX] += sum;
 }
+
+
+/*! \brief States of the blocks in a decoupled look-back scan.
+ *  \details The states are tagged with the epoch of the launch that produced 
+ *           them, \f$ flag = (epoch \ll 2) | state \f$, so the status array 
+ *           doesn't have to be cleared between launches.
+ */
+#define SCAN_INVALID    0  /*!< The block hasn't published anything yet. */
+#define SCAN_AGGREGATE  1  /*!< The block has published the sum of its elements. */
+#define SCAN_PREFIX     2  /*!< The block has published its inclusive prefix. */
+
+
+/*! \brief Performs an exclusive scan on the local buffer of a work-group.
+ *  \details It's the up-sweep and down-sweep phases of the [Blelloch][1] scan.
+ *           [1]: http://http.developer.nvidia.com/GPUGems3/gpugems3_ch39.html
+ *
+ *  \param[in,out] data local buffer of `2 int` elements per work-item.
+ *  \return The sum of the elements in the buffer.
+ */
+inline
+int blockScan_i (local int *data)
+{
+    uint lXdim = get_local_size (0);
+    uint lX = get_local_id (0);
+
+    uint offset = 1;
+
+    // Up-Sweep phase
+    for (uint d = lXdim; d > 0; d >>= 1)
+    {
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (lX < d)
+        {
+            uint ai = offset * (2 * lX + 1) - 1;
+            uint bi = offset * (2 * lX + 2) - 1;
+            data[bi] += data[ai];
+        }
+        offset <<= 1;
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    int total = data[2 * lXdim - 1];
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    // Clear the last register
+    if (lX == (lXdim - 1))
+        data[2 * lX + 1] = 0;
+
+    // Down-Sweep phase
+    for (uint d = 1; d < (2 * lXdim); d <<= 1)
+    {
+        offset >>= 1;
+        barrier (CLK_LOCAL_MEM_FENCE);
+        if (lX < d)
+        {
+            uint ai = offset * (2 * lX + 1) - 1;
+            uint bi = offset * (2 * lX + 2) - 1;
+            int tmp = data[ai];
+            data[ai] = data[bi];
+            data[bi] += tmp;
+        }
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    return total;
+}
+
+
+/*! \brief Performs a scan operation on the columns of an array, in a single launch.
+ *  \details The blocks are scanned with the [Blelloch][1] algorithm, and they 
+ *           are chained with the decoupled look-back of [Merrill and Garland][2]. 
+ *           Every work-group publishes the sum of its block, and then the first 
+ *           work-item looks back at the preceding blocks, accumulating their sums 
+ *           until it finds a block that has published its inclusive prefix. 
+ *           The blocks are assigned to the work-groups in the order they start, 
+ *           so a work-group only ever waits on work-groups that are already running.
+ *           [1]: http://http.developer.nvidia.com/GPUGems3/gpugems3_ch39.html
+ *           [2]: https://research.nvidia.com/publication/single-pass-parallel-prefix-scan-decoupled-look-back
+ *
+ *  \param[in] in input array of `int` elements.
+ *  \param[out] out output array of `int` elements.
+ *  \param[in] data local buffer of `2 int` elements per work-item.
+ *  \param[in,out] status array of block states. Its size should be \f$ M \times wgXdim \f$.
+ *  \param[in,out] values array of block sums and inclusive prefixes. 
+ *                        Its size should be \f$ M \times wgXdim \f$.
+ *  \param[in,out] tickets array of block counters, one per row. 
+ *                         It should be initialized to `0`.
+ *  \param[in] n the number of elements in a row of the array divided by 4.
+ *  \param[in] epoch identifier of the launch. It should be different from the 
+ *                   one of the previous launch, and in the range \f$ [1, 2^{30}) \f$.
+ *  \param[out] wgX local variable that receives the block index of the work-group.
+ *  \param[out] prefix local variable that receives the exclusive prefix of the block.
+ *  \param[in] inclusive flag to indicate whether to perform an `inclusive` 
+ *                       or an `exclusive` scan.
+ */
+inline
+void scanDLB_i (global int4 *in, global int4 *out, local int *data, 
+                volatile global uint *status, volatile global int2 *values, 
+                global uint *tickets, uint n, uint epoch, 
+                local uint *wgX, local int *prefix, bool inclusive)
+{
+    // Workspace dimensions
+    uint lXdim = get_local_size (0);
+    uint wgXdim = get_num_groups (0);
+
+    // Workspace indices
+    uint gY = get_global_id (1);
+    uint lX = get_local_id (0);
+
+    // Get a block in the order the work-groups start
+    if (lX == 0)
+    {
+        *wgX = atomic_inc (tickets + gY);
+        if (*wgX == wgXdim - 1) tickets[gY] = 0;  // Every ticket has been taken
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    uint wg = *wgX;
+    uint gX = wg * lXdim + lX;
+
+    // Load 8 int elements per work-item
+    int4 flag = (int4) (2 * gX) < (int4) (n);
+    int4 a = select ((int4) (0), in[gY * n + 2 * gX], flag);
+    flag = (int4) (2 * gX + 1) < (int4) (n);
+    int4 b = select ((int4) (0), in[gY * n + 2 * gX + 1], flag);
+
+    // Perform a serial scan on the 2 int4 elements
+    a.y += a.x; a.z += a.y; a.w += a.z;
+    b.y += b.x; b.z += b.y; b.w += b.z;
+
+    // Store the sum of each int4 element
+    data[2 * lX] = a.w;
+    data[2 * lX + 1] = b.w;
+
+    // Shift the int4 elements to the right by one
+    if (!inclusive)
+    {
+        a = (int4) (0, a.xyz);
+        b = (int4) (0, b.xyz);
+    }
+
+    int total = blockScan_i (data);
+
+    // Chain the block to its predecessors
+    if (lX == 0)
+    {
+        uint base = gY * wgXdim;
+        uint tag = epoch << 2;
+        int excl = 0;
+
+        if (wg != 0)
+        {
+            values[base + wg].x = total;
+            mem_fence (CLK_GLOBAL_MEM_FENCE);
+            atomic_xchg (status + base + wg, tag | SCAN_AGGREGATE);
+
+            for (int j = wg - 1; j >= 0; )
+            {
+                uint s = atomic_or (status + base + j, 0u);
+                if ((s & ~3u) != tag) continue;  // Not published yet
+
+                mem_fence (CLK_GLOBAL_MEM_FENCE);
+                if ((s & 3u) == SCAN_PREFIX)
+                {
+                    excl += values[base + j].y;
+                    break;
+                }
+                excl += values[base + j].x;
+                --j;
+            }
+        }
+
+        values[base + wg].y = excl + total;
+        mem_fence (CLK_GLOBAL_MEM_FENCE);
+        atomic_xchg (status + base + wg, tag | SCAN_PREFIX);
+
+        *prefix = excl;
+    }
+    barrier (CLK_LOCAL_MEM_FENCE);
+
+    // Update the sums on the int4 elements
+    // and store the results
+    if ((2 * gX) < n)
+    {
+        a += data[2 * lX] + *prefix;
+        out[gY * n + 2 * gX] = a;
+    }
+
+    if ((2 * gX + 1) < n)
+    {
+        b += data[2 * lX + 1] + *prefix;
+        out[gY * n + 2 * gX + 1] = b;
+    }
+}
+
+
+/*! \brief Performs an inclusive scan operation on the columns of an array, in a single launch.
+ *  \details Implements a single-pass scan with decoupled look-back. 
+ *           For more details, look at `scanDLB_i`.
+ *  \note When there are multiple rows in the array, a scan operation is 
+ *        performed per row, in parallel.
+ *  \note The number of elements, `N`, in a row of the array should be a **multiple 
+ *        of 4** (the data are handled as `int4`). The **x** dimension of the 
+ *        global workspace, \f$ gXdim \f$, should be greater than or equal to the number of 
+ *        elements in a row of the array divided by 8. That is, \f$ \ gXdim \geq N/8 \f$. 
+ *        Each work-item handles `8 int` (= `2 int4`) elements in a row of the array. 
+ *        The **y** dimension of the global workspace, \f$ gYdim \f$, should be equal 
+ *        to the number of rows, `M`, in the array. That is, \f$ \ gYdim = M \f$. 
+ *        The local workspace should be `1` in the **y** dimension, and a 
+ *        **power of 2** in the **x** dimension. There is no limit on the 
+ *        number of work-groups.
+ *
+ *  \param[in] in input array of `int` elements.
+ *  \param[out] out output array of `int` elements.
+ *  \param[in] data local buffer. Its size should be `2 int` elements for each 
+ *                  work-item in a work-group. That is \f$ 2*lXdim*sizeof\ (int) \f$.
+ *  \param[in,out] status array of block states. Its size should be \f$ M \times wgXdim \f$.
+ *  \param[in,out] values array of block sums and inclusive prefixes (`int2` elements). 
+ *                        Its size should be \f$ M \times wgXdim \f$.
+ *  \param[in,out] tickets array of block counters, one per row. 
+ *                         It should be initialized to `0`.
+ *  \param[in] n the number of elements in a row of the array divided by 4.
+ *  \param[in] epoch identifier of the launch. It should be different from the one 
+ *                   of the previous launch, and in the range \f$ [1, 2^{30}) \f$.
+ */
+kernel
+void inclusiveScan_i_DLB (global int4 *in, global int4 *out, local int *data, 
+                          volatile global uint *status, volatile global int2 *values, 
+                          global uint *tickets, uint n, uint epoch)
+{
+    // Local variables have to be declared at kernel scope
+    local uint wgX;
+    local int prefix;
+
+    scanDLB_i (in, out, data, status, values, tickets, n, epoch, &wgX, &prefix, true);
+}
+
+
+/*! \brief Performs an exclusive scan operation on the columns of an array, in a single launch.
+ *  \details Implements a single-pass scan with decoupled look-back. 
+ *           For more details, look at `scanDLB_i`.
+ *  \note The requirements are the same as for `inclusiveScan_i_DLB`.
+ *
+ *  \param[in] in input array of `int` elements.
+ *  \param[out] out output array of `int` elements.
+ *  \param[in] data local buffer. Its size should be `2 int` elements for each 
+ *                  work-item in a work-group. That is \f$ 2*lXdim*sizeof\ (int) \f$.
+ *  \param[in,out] status array of block states. Its size should be \f$ M \times wgXdim \f$.
+ *  \param[in,out] values array of block sums and inclusive prefixes (`int2` elements). 
+ *                        Its size should be \f$ M \times wgXdim \f$.
+ *  \param[in,out] tickets array of block counters, one per row. 
+ *                         It should be initialized to `0`.
+ *  \param[in] n the number of elements in a row of the array divided by 4.
+ *  \param[in] epoch identifier of the launch. It should be different from the one 
+ *                   of the previous launch, and in the range \f$ [1, 2^{30}) \f$.
+ */
+kernel
+void exclusiveScan_i_DLB (global int4 *in, global int4 *out, local int *data, 
+                          volatile global uint *status, volatile global int2 *values, 
+                          global uint *tickets, uint n, uint epoch)
+{
+    // Local variables have to be declared at kernel scope
+    local uint wgX;
+    local int prefix;
+
+    scanDLB_i (in, out, data, status, values, tickets, n, epoch, &wgX, &prefix, false);
+}
+
+
+/*! \brief Predicate for the points kept by `compactFlag`.
+ *  \details By default, a point is kept when its depth (z coordinate) is finite 
+ *           and not zero. A different predicate can be given at build time, 
+ *           e.g. `-D "COMPACT_PREDICATE(p)=(p.s7 > 0.5f)"`.
+ */
+#ifndef COMPACT_PREDICATE
+    #define COMPACT_PREDICATE(p) ((p).s2 != 0.f && isfinite ((p).s2))
+#endif
+
+
+/*! \brief Flags the points of an array that satisfy the compaction predicate.
+ *  \details The flags are meant to be scanned (`exclusive` scan), 
+ *           for `compactScatter` to get the positions of the kept points.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        greater than or equal to the number of points, and a multiple of 4. 
+ *        The extra flags are set to zero. There is no requirement for the 
+ *        local workspace.
+ *
+ *  \param[in] in array of `float8` elements.
+ *  \param[out] flags array of `int` elements. `1` for the kept points and `0` otherwise.
+ *  \param[in] n number of points in the array.
+ */
+kernel
+void compactFlag (global float8 *in, global int *flags, uint n)
+{
+    uint gX = get_global_id (0);
+
+    flags[gX] = (gX < n) && COMPACT_PREDICATE (in[gX]);
+}
+
+
+/*! \brief Moves the flagged points of an array to the front of the output array.
+ *  \details Point `i` is stored at position `scan[i]`, so the kept points 
+ *           retain their relative order. The number of kept points is 
+ *           stored in `count`.
+ *  \note The **x** dimension of the global workspace, \f$ gXdim \f$, should be 
+ *        equal to the number of points. That is, \f$ \ gXdim=n \f$. There is no 
+ *        requirement for the local workspace.
+ *
+ *  \param[in] in array of `float8` elements.
+ *  \param[in] flags array of `int` elements, as produced by `compactFlag`.
+ *  \param[in] scan array of `int` elements (exclusive scan of the flags).
+ *  \param[out] out array of `float8` elements. The first `count` elements are the kept points.
+ *  \param[out] count number of kept points.
+ */
+kernel
+void compactScatter (global float8 *in, global int *flags, global int *scan, 
+                     global float8 *out, global uint *count)
+{
+    // Workspace dimensions
+    uint gXdim = get_global_size (0);
+
+    // Workspace indices
+    uint gX = get_global_id (0);
+
+    if (flags[gX])
+        out[scan[gX]] = in[gX];
+
+    if (gX == gXdim - 1)
+        count[0] = scan[gX] + flags[gX];
+}
@@ -32,8 +32,10 @@
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 #include <CLUtils.hpp>
 #include <ICP/algorithms.hpp>
+#include <ICP/program_cache.hpp>
 
 
 /*! \note All the classes assume there is a fully configured `clutils::CLEnv` 
@@ -47,51 +49,79 @@ namespace cl_algo
 namespace ICP
 {
 
+    /*! \brief Checks a number of points, and a scaling factor, against the 
+     *         constants of a program built by `addProgramSpecialized`.
+     *
+     *  \param[in] env the OpenCL environment.
+     *  \param[in] info the environment info of the class.
+     *  \param[in] m number of points in the sets.
+     *  \param[in] c scaling factor of the `S` matrix kernels. If `0`, it isn't checked.
+     *  \return False if the program was specialized for different values.
+     */
+    static bool matchesSpecialization (clutils::CLEnv &env, const clutils::CLEnvInfo<1> &info, 
+                                       unsigned int m, float c = 0.f)
+    {
+        unsigned int sm; float sc;
+        getSpecialization (env.getProgram (info.pgIdx), env.devices[info.pIdx][info.dIdx], sm, sc);
+
+        return (sm == 0 || sm == m) && (c == 0.f || sc == 0.f || sc == c);
+    }
+
+
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
     template <>
-    Reduce<ReduceConfig::MIN, cl_float>::Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    Reduce<ReduceConfig::MIN, cl_float>::Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
         recKernel (env.getProgram (info.pgIdx), "reduce_min_f"), 
-        groupRecKernel (env.getProgram (info.pgIdx), "reduce_min_f")
+        groupRecKernel (env.getProgram (info.pgIdx), "reduce_min_f"), 
+        spKernel (env.getProgram (info.pgIdx), "reduce_min_f_SP"), 
+        singlePass (false)
     {
-        wgMultiple = recKernel.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
+        wgMultiple = getWorkGroupMultiple (recKernel, env.devices[info.pIdx][info.dIdx]);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
     template <>
-    Reduce<ReduceConfig::MAX, cl_uint>::Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    Reduce<ReduceConfig::MAX, cl_uint>::Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
         recKernel (env.getProgram (info.pgIdx), "reduce_max_ui"), 
-        groupRecKernel (env.getProgram (info.pgIdx), "reduce_max_ui")
+        groupRecKernel (env.getProgram (info.pgIdx), "reduce_max_ui"), 
+        spKernel (env.getProgram (info.pgIdx), "reduce_max_ui_SP"), 
+        singlePass (false)
     {
-        wgMultiple = recKernel.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
+        wgMultiple = getWorkGroupMultiple (recKernel, env.devices[info.pIdx][info.dIdx]);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
     template <>
-    Reduce<ReduceConfig::SUM, cl_float>::Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    Reduce<ReduceConfig::SUM, cl_float>::Reduce (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
         recKernel (env.getProgram (info.pgIdx), "reduce_sum_f"), 
-        groupRecKernel (env.getProgram (info.pgIdx), "reduce_sum_f")
+        groupRecKernel (env.getProgram (info.pgIdx), "reduce_sum_f"), 
+        spKernel (env.getProgram (info.pgIdx), "reduce_sum_f_SP"), 
+        singlePass (false)
     {
-        wgMultiple = recKernel.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
+        wgMultiple = getWorkGroupMultiple (recKernel, env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -131,7 +161,7 @@ namespace ICP
     template <ReduceConfig C, typename T>
     void Reduce<C, T>::init (unsigned int _cols, unsigned int _rows, Staging _staging)
     {
-        cols = _cols; rows = _rows;
+        cols = colsMax = _cols; rows = _rows;
         bufferInSize  = cols * rows * sizeof (T);
         bufferOutSize = rows * sizeof (T);
         staging = _staging;
@@ -185,8 +215,7 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferIn () == nullptr)
-                    hBufferIn = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
 
                 hPtrIn = (T *) queue.enqueueMapBuffer (
                     hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
@@ -200,8 +229,7 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (T *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
@@ -220,6 +248,11 @@ namespace ICP
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
+        // The single-pass kernel resets the counters after every launch
+        std::vector<cl_uint> zeros (rows, 0);
+        dBufferCount = cl::Buffer (context, CL_MEM_READ_WRITE, rows * sizeof (cl_uint));
+        queue.enqueueWriteBuffer (dBufferCount, CL_TRUE, 0, rows * sizeof (cl_uint), zeros.data ());
+
         // Set kernel arguments
         if (wgXdim == 1)
         {
@@ -239,6 +272,76 @@ namespace ICP
             groupRecKernel.setArg (1, dBufferOut);
             groupRecKernel.setArg (2, cl::Local (2 * local[0] * sizeof (T)));
             groupRecKernel.setArg (3, (cl_uint) (wgXdim / 4));
+
+            spKernel.setArg (0, dBufferIn);
+            spKernel.setArg (1, dBufferOut);
+            spKernel.setArg (2, dBufferR);
+            spKernel.setArg (3, dBufferCount);
+            spKernel.setArg (4, cl::Local (local[0] * sizeof (T)));
+            spKernel.setArg (5, cols / 4);
+        }
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of columns, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of columns given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _cols number of columns in the input array.
+     */
+    template <ReduceConfig C, typename T>
+    void Reduce<C, T>::resize (unsigned int _cols)
+    {
+        try
+        {
+            if (_cols == 0)
+                throw "The array cannot have zero columns";
+
+            if (_cols % 4 != 0)
+                throw "The number of columns in the array must be a multiple of 4";
+
+            if (_cols > colsMax)
+                throw "The number of columns cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[Reduce]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        cols = _cols;
+        bufferInSize = cols * rows * sizeof (T);
+
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (cols / (float) (8 * wgMultiple));
+        // Round up to a multiple of 4 (data are handled as float4)
+        if ((wgXdim != 1) && (wgXdim % 4)) wgXdim += 4 - wgXdim % 4;
+
+        bufferGRSize = wgXdim * rows * sizeof (T);
+
+        // Set workspaces
+        globalR = cl::NDRange (wgXdim * wgMultiple, rows);
+
+        // Set kernel arguments
+        if (wgXdim == 1)
+        {
+            recKernel.setArg (1, dBufferOut);
+            recKernel.setArg (3, cols / 4);
+        }
+        else
+        {
+            recKernel.setArg (1, dBufferR);
+            recKernel.setArg (3, cols / 4);
+
+            groupRecKernel.setArg (3, (cl_uint) (wgXdim / 4));
+
+            spKernel.setArg (0, dBufferIn);
+            spKernel.setArg (1, dBufferOut);
+            spKernel.setArg (2, dBufferR);
+            spKernel.setArg (3, dBufferCount);
+            spKernel.setArg (4, cl::Local (local[0] * sizeof (T)));
+            spKernel.setArg (5, cols / 4);
         }
     }
 
@@ -314,6 +417,10 @@ namespace ICP
         {
             queue.enqueueNDRangeKernel (recKernel, cl::NullRange, globalR, local, events, event);
         }
+        else if (singlePass)
+        {
+            queue.enqueueNDRangeKernel (spKernel, cl::NullRange, globalR, local, events, event);
+        }
         else
         {
             queue.enqueueNDRangeKernel (recKernel, cl::NullRange, globalR, local, events);
@@ -322,6 +429,26 @@ namespace ICP
     }
 
 
+    /*! \return The flag for the single-pass reduction. */
+    template <ReduceConfig C, typename T>
+    bool Reduce<C, T>::getSinglePass ()
+    {
+        return singlePass;
+    }
+
+
+    /*! \details Updates the flag for the single-pass reduction. It only has an 
+     *           effect when a row spans more than one work-group.
+     *  
+     *  \param[in] _singlePass flag for the single-pass reduction.
+     */
+    template <ReduceConfig C, typename T>
+    void Reduce<C, T>::setSinglePass (bool _singlePass)
+    {
+        singlePass = _singlePass;
+    }
+
+
     /*! \brief Template instantiation for the case of `MIN` reduction and `cl_float` data. */
     template class Reduce<ReduceConfig::MIN, cl_float>;
     /*! \brief Template instantiation for the case of `MAX` reduction and `cl_uint` data. */
@@ -332,35 +459,41 @@ namespace ICP
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
     template <>
-    Scan<ScanConfig::INCLUSIVE, cl_int>::Scan (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    Scan<ScanConfig::INCLUSIVE, cl_int>::Scan (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
         kernelScan (env.getProgram (info.pgIdx), "inclusiveScan_i"), 
         kernelSumsScan (env.getProgram (info.pgIdx), "inclusiveScan_i"), 
-        kernelAddSums (env.getProgram (info.pgIdx), "addGroupSums_i")
+        kernelAddSums (env.getProgram (info.pgIdx), "addGroupSums_i"), 
+        kernelDLB (env.getProgram (info.pgIdx), "inclusiveScan_i_DLB"), 
+        singlePass (false), epoch (0), statusSize (0), ticketsSize (0)
     {
-        wgMultiple = kernelScan.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
+        wgMultiple = getWorkGroupMultiple (kernelScan, env.devices[info.pIdx][info.dIdx]);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
     template <>
-    Scan<ScanConfig::EXCLUSIVE, cl_int>::Scan (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    Scan<ScanConfig::EXCLUSIVE, cl_int>::Scan (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
         kernelScan (env.getProgram (info.pgIdx), "exclusiveScan_i"), 
         kernelSumsScan (env.getProgram (info.pgIdx), "inclusiveScan_i"), 
-        kernelAddSums (env.getProgram (info.pgIdx), "addGroupSums_i")
+        kernelAddSums (env.getProgram (info.pgIdx), "addGroupSums_i"), 
+        kernelDLB (env.getProgram (info.pgIdx), "exclusiveScan_i_DLB"), 
+        singlePass (false), epoch (0), statusSize (0), ticketsSize (0)
     {
-        wgMultiple = kernelScan.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
+        wgMultiple = getWorkGroupMultiple (kernelScan, env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -398,20 +531,26 @@ namespace ICP
      *  \param[in] _cols number of columns in the input array.
      *  \param[in] _rows number of rows in the input array.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     *  \param[in] _singlePass flag to indicate whether or not to scan a row that spans 
+     *                         multiple work-groups in a single launch (decoupled look-back).
      */
     template <ScanConfig C, typename T>
-    void Scan<C, T>::init (unsigned int _cols, unsigned int _rows, Staging _staging)
+    void Scan<C, T>::init (unsigned int _cols, unsigned int _rows, Staging _staging, bool _singlePass)
     {
         cols = _cols; rows = _rows;
         bufferSize = cols * rows * sizeof (T);
         staging = _staging;
+        singlePass = _singlePass;
 
         // Establish the number of work-groups per row
         wgXdim = std::ceil (cols / (float) (8 * wgMultiple));
         // Round up to a multiple of 4 (data are handled as int4)
-        if ((wgXdim != 1) && (wgXdim % 4)) wgXdim += 4 - wgXdim % 4;
+        if (!singlePass && (wgXdim != 1) && (wgXdim % 4)) wgXdim += 4 - wgXdim % 4;
 
-        bufferSumsSize = wgXdim * rows * sizeof (T);
+        // In single-pass mode, a (sum, inclusive prefix) pair per block
+        bufferSumsSize = (singlePass ? 2 : 1) * wgXdim * rows * sizeof (T);
+        // Room for both modes, so that the buffer survives a change of mode
+        size_t wgXdimMax = (wgXdim % 4) ? wgXdim + 4 - wgXdim % 4 : wgXdim;
 
         try
         {
@@ -422,8 +561,8 @@ namespace ICP
                 throw "The number of columns in the array must be a multiple of 4";
 
             // (8 * wgMultiple) elements per work-group
-            // (8 * wgMultiple) work-groups maximum
-            if (cols > std::pow (8 * wgMultiple, 2))
+            // (8 * wgMultiple) work-groups maximum, unless in single-pass mode
+            if (!singlePass && cols > std::pow (8 * wgMultiple, 2))
             {
                 std::ostringstream ss;
                 ss << "The current configuration of Scan supports arrays ";
@@ -458,8 +597,7 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferIn () == nullptr)
-                    hBufferIn = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferSize);
+                allocStaging (hBufferIn, bufferSize, context, pool, lease);
 
                 hPtrIn = (T *) queue.enqueueMapBuffer (
                     hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferSize);
@@ -473,8 +611,7 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferSize);
+                allocStaging (hBufferOut, bufferSize, context, pool, lease);
 
                 hPtrOut = (T *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferSize);
@@ -489,10 +626,31 @@ namespace ICP
         if (dBufferIn () == nullptr)
             dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferSize);
         if (dBufferSums () == nullptr)
-            dBufferSums = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSumsSize);
+            dBufferSums = cl::Buffer (context, CL_MEM_READ_WRITE, 2 * wgXdimMax * rows * sizeof (T));
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSize);
 
+        // The blocks are tagged with the epoch of the launch, and the first one is 1
+        if (singlePass && wgXdim != 1)
+        {
+            // The block states are only reallocated when they grow
+            if (statusSize < wgXdim * rows)
+            {
+                statusSize = wgXdim * rows;
+                dBufferStatus = cl::Buffer (context, CL_MEM_READ_WRITE, statusSize * sizeof (cl_uint));
+            }
+            if (ticketsSize < rows)
+            {
+                ticketsSize = rows;
+                dBufferTickets = cl::Buffer (context, CL_MEM_READ_WRITE, ticketsSize * sizeof (cl_uint));
+            }
+
+            std::vector<cl_uint> zeros (wgXdim * rows, 0);
+            queue.enqueueWriteBuffer (dBufferStatus, CL_FALSE, 0, wgXdim * rows * sizeof (cl_uint), zeros.data ());
+            queue.enqueueWriteBuffer (dBufferTickets, CL_TRUE, 0, rows * sizeof (cl_uint), zeros.data ());
+            epoch = 0;
+        }
+
         // Set kernel arguments
         if (wgXdim == 1)
         {
@@ -502,6 +660,16 @@ namespace ICP
             kernelScan.setArg (3, dBufferSums);  // Unused
             kernelScan.setArg (4, cols / 4);
         }
+        else if (singlePass)
+        {
+            kernelDLB.setArg (0, dBufferIn);
+            kernelDLB.setArg (1, dBufferOut);
+            kernelDLB.setArg (2, cl::Local (2 * localScan[0] * sizeof (T)));
+            kernelDLB.setArg (3, dBufferStatus);
+            kernelDLB.setArg (4, dBufferSums);
+            kernelDLB.setArg (5, dBufferTickets);
+            kernelDLB.setArg (6, cols / 4);
+        }
         else
         {
             kernelScan.setArg (0, dBufferIn);
@@ -595,6 +763,14 @@ namespace ICP
             queue.enqueueNDRangeKernel (
                 kernelScan, cl::NullRange, globalScan, localScan, events, event);
         }
+        else if (singlePass)
+        {
+            epoch = epoch % 0x3FFFFFFF + 1;
+            kernelDLB.setArg (7, epoch);
+
+            queue.enqueueNDRangeKernel (
+                kernelDLB, cl::NullRange, globalScan, localScan, events, event);
+        }
         else
         {
             queue.enqueueNDRangeKernel (
@@ -617,13 +793,16 @@ namespace ICP
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPLMs::ICPLMs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    Compact::Compact (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "getLMs"), 
-        n (640 * 480), m (128 * 128), d (8)
+        flagKernel (env.getProgram (info.pgIdx), "compactFlag"), 
+        scatterKernel (env.getProgram (info.pgIdx), "compactScatter"), 
+        scan (env, info, pool), singlePass (false), n (0), d (8)
     {
     }
 
@@ -633,18 +812,26 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPLMs::get (ICPLMs::Memory mem)
+    cl::Memory& Compact::get (Compact::Memory mem)
     {
         switch (mem)
         {
-            case ICPLMs::Memory::H_IN:
+            case Compact::Memory::H_IN:
                 return hBufferIn;
-            case ICPLMs::Memory::H_OUT:
+            case Compact::Memory::H_OUT:
                 return hBufferOut;
-            case ICPLMs::Memory::D_IN:
+            case Compact::Memory::H_COUNT:
+                return hBufferCount;
+            case Compact::Memory::D_IN:
                 return dBufferIn;
-            case ICPLMs::Memory::D_OUT:
+            case Compact::Memory::D_FLAGS:
+                return dBufferFlags;
+            case Compact::Memory::D_SCAN:
+                return scan.get (Scan<ScanConfig::EXCLUSIVE, cl_int>::Memory::D_OUT);
+            case Compact::Memory::D_OUT:
                 return dBufferOut;
+            case Compact::Memory::D_COUNT:
+                return dBufferCount;
         }
     }
 
@@ -654,16 +841,31 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
+     *  \param[in] _n number of points in the input array.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPLMs::init (Staging _staging)
+    void Compact::init (unsigned int _n, Staging _staging)
     {
+        n = _n;
+        nPad = (n % 4) ? n + 4 - n % 4 : n;  // The flags are scanned as int4
         bufferInSize = n * sizeof (cl_float8);
-        bufferOutSize = m * sizeof (cl_float8);
+        bufferFlagsSize = nPad * sizeof (cl_int);
         staging = _staging;
 
+        try
+        {
+            if (n == 0)
+                throw "The array cannot have zero points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[Compact]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
         // Set workspaces
-        global = cl::NDRange (256, 128);
+        globalF = cl::NDRange (nPad);
+        globalS = cl::NDRange (n);
 
         // Create staging buffers
         bool io = false;
@@ -672,14 +874,14 @@ namespace ICP
             case Staging::NONE:
                 hPtrIn = nullptr;
                 hPtrOut = nullptr;
+                hPtrCount = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferIn () == nullptr)
-                    hBufferIn = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
 
                 hPtrIn = (cl_float *) queue.enqueueMapBuffer (
                     hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
@@ -689,31 +891,53 @@ namespace ICP
                 {
                     queue.finish ();
                     hPtrOut = nullptr;
+                    hPtrCount = nullptr;
                     break;
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferInSize, context, pool, lease);
+                allocStaging (hBufferCount, sizeof (cl_uint), context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferInSize);
+                hPtrCount = (cl_uint *) queue.enqueueMapBuffer (
+                    hBufferCount, CL_FALSE, CL_MAP_READ, 0, sizeof (cl_uint));
                 queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                queue.enqueueUnmapMemObject (hBufferCount, hPtrCount);
                 queue.finish ();
 
                 if (!io) hPtrIn = nullptr;
                 break;
         }
-        
+
         // Create device buffers
         if (dBufferIn () == nullptr)
             dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferFlags () == nullptr)
+            dBufferFlags = cl::Buffer (context, CL_MEM_READ_WRITE, bufferFlagsSize);
         if (dBufferOut () == nullptr)
-            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferInSize);
+        if (dBufferCount () == nullptr)
+            dBufferCount = cl::Buffer (context, CL_MEM_WRITE_ONLY, sizeof (cl_uint));
+
+        // Configure the scan on the flags
+        scan.get (Scan<ScanConfig::EXCLUSIVE, cl_int>::Memory::D_IN) = dBufferFlags;
+        scan.init (nPad, 1, Staging::NONE, singlePass);
+
+        cl::Buffer &dBufferScan = (cl::Buffer &) 
+            scan.get (Scan<ScanConfig::EXCLUSIVE, cl_int>::Memory::D_OUT);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferIn);
-        kernel.setArg (1, dBufferOut);
+        flagKernel.setArg (0, dBufferIn);
+        flagKernel.setArg (1, dBufferFlags);
+        flagKernel.setArg (2, n);
+
+        scatterKernel.setArg (0, dBufferIn);
+        scatterKernel.setArg (1, dBufferFlags);
+        scatterKernel.setArg (2, dBufferScan);
+        scatterKernel.setArg (3, dBufferOut);
+        scatterKernel.setArg (4, dBufferCount);
     }
 
 
@@ -728,14 +952,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPLMs::write (ICPLMs::Memory mem, void *ptr, bool block, 
-                           const std::vector<cl::Event> *events, cl::Event *event)
+    void Compact::write (Compact::Memory mem, void *ptr, bool block, 
+                         const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPLMs::Memory::D_IN:
+                case Compact::Memory::D_IN:
                     if (ptr != nullptr)
                         std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrIn);
                     queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
@@ -756,16 +980,19 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPLMs::read (ICPLMs::Memory mem, bool block, 
-                           const std::vector<cl::Event> *events, cl::Event *event)
+    void* Compact::read (Compact::Memory mem, bool block, 
+                         const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPLMs::Memory::H_OUT:
-                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                case Compact::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferInSize, hPtrOut, events, event);
                     return hPtrOut;
+                case Compact::Memory::H_COUNT:
+                    queue.enqueueReadBuffer (dBufferCount, block, 0, sizeof (cl_uint), hPtrCount, events, event);
+                    return hPtrCount;
                 default:
                     return nullptr;
             }
@@ -779,21 +1006,45 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPLMs::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void Compact::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+        queue.enqueueNDRangeKernel (flagKernel, cl::NullRange, globalF, cl::NullRange, events);
+        scan.run ();
+        queue.enqueueNDRangeKernel (scatterKernel, cl::NullRange, globalS, cl::NullRange, nullptr, event);
+    }
+
+
+    /*! \return The flag for the single-pass scan of the flags. */
+    bool Compact::getSinglePass ()
+    {
+        return singlePass;
+    }
+
+
+    /*! \details Updates the flag for the single-pass scan of the flags. If the 
+     *           instance has already been initialized, the scan is reconfigured, 
+     *           and it retains its memory objects.
+     *  
+     *  \param[in] _singlePass flag for the single-pass scan.
+     */
+    void Compact::setSinglePass (bool _singlePass)
+    {
+        singlePass = _singlePass;
+        if (n != 0)
+            scan.init (nPad, 1, Staging::NONE, singlePass);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPReps::ICPReps (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPBackProject::ICPBackProject (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "getReps"), 
-        m (128 * 128), d (8)
+        kernel (env.getProgram (info.pgIdx), "icpBackProject")
     {
     }
 
@@ -803,17 +1054,21 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPReps::get (ICPReps::Memory mem)
+    cl::Memory& ICPBackProject::get (ICPBackProject::Memory mem)
     {
         switch (mem)
         {
-            case ICPReps::Memory::H_IN:
-                return hBufferIn;
-            case ICPReps::Memory::H_OUT:
+            case ICPBackProject::Memory::H_IN_D:
+                return hBufferInD;
+            case ICPBackProject::Memory::H_IN_RGB:
+                return hBufferInRGB;
+            case ICPBackProject::Memory::H_OUT:
                 return hBufferOut;
-            case ICPReps::Memory::D_IN:
-                return dBufferIn;
-            case ICPReps::Memory::D_OUT:
+            case ICPBackProject::Memory::D_IN_D:
+                return dBufferInD;
+            case ICPBackProject::Memory::D_IN_RGB:
+                return dBufferInRGB;
+            case ICPBackProject::Memory::D_OUT:
                 return dBufferOut;
         }
     }
@@ -823,45 +1078,46 @@ namespace ICP
      *  \note If you have assigned a memory object to one member variable of the class 
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
+     *  \note The principal point is placed at the center of the frames. 
+     *        Call `setIntrinsics` to specify it.
      *        
-     *  \param[in] _nr number of representatives in the output array.
+     *  \param[in] _width width (in pixels) of the frames.
+     *  \param[in] _height height (in pixels) of the frames.
+     *  \param[in] _fx focal length (in pixels) along the x axis.
+     *  \param[in] _fy focal length (in pixels) along the y axis.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPReps::init (unsigned int _nr, Staging _staging)
+    void ICPBackProject::init (unsigned int _width, unsigned int _height, 
+                               float _fx, float _fy, Staging _staging)
     {
-        nr = _nr;
-        bufferInSize = m * sizeof (cl_float8);
-        bufferOutSize = nr * sizeof (cl_float8);
+        width = _width; height = _height;
+        n = width * height;
+        bufferInDSize = n * sizeof (cl_ushort);
+        bufferInRGBSize = 3 * n * sizeof (cl_uchar);
+        bufferOutSize = n * sizeof (cl_float8);
         staging = _staging;
 
         try
         {
-            if (nr == 0)
-                throw "The number of representatives cannot be zero";
-
-            if (nr % 4)
-                throw "The number of representatives has to be a multiple of 4";
+            if (n == 0)
+                throw "The frames cannot have zero pixels";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPReps]: " << error << std::endl;
+            std::cerr << "Error[ICPBackProject]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
-        // e.g. nr = 32 -> nrx = 8, nry = 4
-        int p = std::log2 (nr);
-        nrx = std::pow (2, p - p / 2);
-        nry = std::pow (2, p / 2);
-
         // Set workspaces
-        global = cl::NDRange (nrx, nry);
-
+        global = cl::NDRange (width, height);
+        
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrIn = nullptr;
+                hPtrInD = nullptr;
+                hPtrInRGB = nullptr;
                 hPtrOut = nullptr;
                 break;
 
@@ -869,12 +1125,15 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferIn () == nullptr)
-                    hBufferIn = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
+                allocStaging (hBufferInD, bufferInDSize, context, pool, lease);
+                allocStaging (hBufferInRGB, bufferInRGBSize, context, pool, lease);
 
-                hPtrIn = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
-                queue.enqueueUnmapMemObject (hBufferIn, hPtrIn);
+                hPtrInD = (cl_ushort *) queue.enqueueMapBuffer (
+                    hBufferInD, CL_FALSE, CL_MAP_WRITE, 0, bufferInDSize);
+                hPtrInRGB = (cl_uchar *) queue.enqueueMapBuffer (
+                    hBufferInRGB, CL_FALSE, CL_MAP_WRITE, 0, bufferInRGBSize);
+                queue.enqueueUnmapMemObject (hBufferInD, hPtrInD);
+                queue.enqueueUnmapMemObject (hBufferInRGB, hPtrInRGB);
 
                 if (!io)
                 {
@@ -884,27 +1143,49 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
                 queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
                 queue.finish ();
 
-                if (!io) hPtrIn = nullptr;
+                if (!io)
+                {
+                    hPtrInD = nullptr;
+                    hPtrInRGB = nullptr;
+                }
                 break;
         }
-        
+
         // Create device buffers
-        if (dBufferIn () == nullptr)
-            dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferInD () == nullptr)
+            dBufferInD = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInDSize);
+        if (dBufferInRGB () == nullptr)
+            dBufferInRGB = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInRGBSize);
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferIn);
-        kernel.setArg (1, dBufferOut);
+        kernel.setArg (0, dBufferInD);
+        kernel.setArg (1, dBufferInRGB);
+        kernel.setArg (2, dBufferOut);
+        setIntrinsics (_fx, _fy, (width - 1) / 2.f, (height - 1) / 2.f);
+    }
+
+
+    /*! \details The camera parameters are usually available 
+     *           in the header of a point cloud file (`PCFileHeader`).
+     *
+     *  \param[in] _fx focal length (in pixels) along the x axis.
+     *  \param[in] _fy focal length (in pixels) along the y axis.
+     *  \param[in] _cx x coordinate (in pixels) of the principal point.
+     *  \param[in] _cy y coordinate (in pixels) of the principal point.
+     */
+    void ICPBackProject::setIntrinsics (float _fx, float _fy, float _cx, float _cy)
+    {
+        intrinsics = { { _fx, _fy, _cx, _cy } };
+        kernel.setArg (3, intrinsics);
     }
 
 
@@ -919,17 +1200,22 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPReps::write (ICPReps::Memory mem, void *ptr, bool block, 
-                            const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPBackProject::write (ICPBackProject::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPReps::Memory::D_IN:
+                case ICPBackProject::Memory::D_IN_D:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrIn);
-                    queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
+                        std::copy ((cl_ushort *) ptr, (cl_ushort *) ptr + n, hPtrInD);
+                    queue.enqueueWriteBuffer (dBufferInD, block, 0, bufferInDSize, hPtrInD, events, event);
+                    break;
+                case ICPBackProject::Memory::D_IN_RGB:
+                    if (ptr != nullptr)
+                        std::copy ((cl_uchar *) ptr, (cl_uchar *) ptr + 3 * n, hPtrInRGB);
+                    queue.enqueueWriteBuffer (dBufferInRGB, block, 0, bufferInRGBSize, hPtrInRGB, events, event);
                     break;
                 default:
                     break;
@@ -947,14 +1233,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPReps::read (ICPReps::Memory mem, bool block, 
-                            const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPBackProject::read (ICPBackProject::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPReps::Memory::H_OUT:
+                case ICPBackProject::Memory::H_OUT:
                     queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
                     return hPtrOut;
                 default:
@@ -968,9 +1254,9 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the last kernel execution.
+     *  \param[out] event event associated with the kernel execution.
      */
-    void ICPReps::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPBackProject::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
         queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
     }
@@ -978,16 +1264,15 @@ namespace ICP
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPWeights::ICPWeights (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPNormals::ICPNormals (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        weightKernel (env.getProgram (info.pgIdx), "icpComputeReduceWeights"), 
-        groupWeightKernel (env.getProgram (info.pgIdx), "reduce_sum_fd")
+        kernel (env.getProgram (info.pgIdx), "icpNormals")
     {
-        wgMultiple = weightKernel.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -996,24 +1281,18 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPWeights::get (ICPWeights::Memory mem)
+    cl::Memory& ICPNormals::get (ICPNormals::Memory mem)
     {
         switch (mem)
         {
-            case ICPWeights::Memory::H_IN:
+            case ICPNormals::Memory::H_IN:
                 return hBufferIn;
-            case ICPWeights::Memory::H_OUT_W:
-                return hBufferOutW;
-            case ICPWeights::Memory::H_OUT_SUM_W:
-                return hBufferOutSW;
-            case ICPWeights::Memory::D_IN:
+            case ICPNormals::Memory::H_OUT:
+                return hBufferOut;
+            case ICPNormals::Memory::D_IN:
                 return dBufferIn;
-            case ICPWeights::Memory::D_OUT_W:
-                return dBufferOutW;
-            case ICPWeights::Memory::D_GW:
-                return dBufferGW;
-            case ICPWeights::Memory::D_OUT_SUM_W:
-                return dBufferOutSW;
+            case ICPNormals::Memory::D_OUT:
+                return dBufferOut;
         }
     }
 
@@ -1023,56 +1302,33 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _n number of elements in the input sets.
+     *  \param[in] _width width (in pixels) of the point cloud.
+     *  \param[in] _height height (in pixels) of the point cloud.
+     *  \param[in] _max_dz maximum difference in depth between the neighbors of a point, 
+     *                     relative to its depth, for the point to get a normal.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPWeights::init (unsigned int _n, Staging _staging)
+    void ICPNormals::init (unsigned int _width, unsigned int _height, float _max_dz, Staging _staging)
     {
-        n = _n;
-        bufferInSize  = n * sizeof (rbc_dist_id);
-        bufferOutWSize = n * sizeof (cl_float);
-        bufferOutSWSize = sizeof (cl_double);
+        width = _width; height = _height;
+        n = width * height;
+        bufferInSize = n * sizeof (cl_float8);
+        bufferOutSize = n * sizeof (cl_float4);
         staging = _staging;
 
-        // Establish the number of work-groups per row
-        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
-        // Round up to a multiple of 4 (data are handled as float4 in reduce_sum)
-        if ((wgXdim != 1) && (wgXdim % 4)) wgXdim += 4 - wgXdim % 4;
-
-        bufferGWSize = wgXdim * sizeof (cl_double);
-
         try
         {
-            if (wgXdim == 0)
-                throw "The array cannot have zero elements";
-
-            if (n % 2 != 0)
-                throw "The number of elements in the array must be a multiple of 2";
-
-            // (2 * wgMultiple) elements per work-group
-            // (8 * wgMultiple) work-groups maximum
-            if (n > 16 * wgMultiple * wgMultiple)
-            {
-                std::ostringstream ss;
-                ss << "The current configuration of ICPWeights supports arrays ";
-                ss << "of up to " << 16 * wgMultiple * wgMultiple << " elements";
-                throw ss.str ().c_str ();
-            }
+            if (n == 0)
+                throw "The point cloud cannot have zero points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPWeights]: " << error << std::endl;
+            std::cerr << "Error[ICPNormals]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
-        // Extract kernel
-        if (wgXdim > 1)
-            weightKernel = cl::Kernel (env.getProgram (info.pgIdx), "icpComputeReduceWeights_WG");
-
         // Set workspaces
-        globalW = cl::NDRange (wgXdim * wgMultiple);
-        globalGW = cl::NDRange (wgMultiple);
-        local = cl::NDRange (wgMultiple);
+        global = cl::NDRange (width, height);
         
         // Create staging buffers
         bool io = false;
@@ -1080,79 +1336,49 @@ namespace ICP
         {
             case Staging::NONE:
                 hPtrIn = nullptr;
-                hPtrOutW = nullptr;
-                hPtrOutSW = nullptr;
+                hPtrOut = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferIn () == nullptr)
-                    hBufferIn = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
 
-                hPtrIn = (rbc_dist_id *) queue.enqueueMapBuffer (
+                hPtrIn = (cl_float *) queue.enqueueMapBuffer (
                     hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
                 queue.enqueueUnmapMemObject (hBufferIn, hPtrIn);
 
                 if (!io)
                 {
                     queue.finish ();
-                    hPtrOutW = nullptr;
-                    hPtrOutSW = nullptr;
+                    hPtrOut = nullptr;
                     break;
                 }
 
             case Staging::O:
-                if (hBufferOutW () == nullptr)
-                    hBufferOutW = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutWSize);
-                if (hBufferOutSW () == nullptr)
-                    hBufferOutSW = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSWSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
-                hPtrOutW = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferOutW, CL_FALSE, CL_MAP_READ, 0, bufferOutWSize);
-                hPtrOutSW = (cl_double *) queue.enqueueMapBuffer (
-                    hBufferOutSW, CL_FALSE, CL_MAP_READ, 0, bufferOutSWSize);
-                queue.enqueueUnmapMemObject (hBufferOutW, hPtrOutW);
-                queue.enqueueUnmapMemObject (hBufferOutSW, hPtrOutSW);
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
                 queue.finish ();
 
-                if (!io) hPtrIn = nullptr;
+                if (!io)
+                    hPtrIn = nullptr;
                 break;
         }
 
         // Create device buffers
         if (dBufferIn () == nullptr)
             dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
-        if (dBufferOutW () == nullptr)
-            dBufferOutW = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutWSize);
-        if (dBufferGW () == nullptr && wgXdim != 1)
-            dBufferGW = cl::Buffer (context, CL_MEM_READ_WRITE, bufferGWSize);
-        if (dBufferOutSW () == nullptr)
-            dBufferOutSW = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSWSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        if (wgXdim == 1)
-        {
-            weightKernel.setArg (0, dBufferIn);
-            weightKernel.setArg (1, dBufferOutW);
-            weightKernel.setArg (2, dBufferOutSW);
-            weightKernel.setArg (3, cl::Local (2 * local[0] * sizeof (cl_float)));
-            weightKernel.setArg (4, n);
-        }
-        else
-        {
-            weightKernel.setArg (0, dBufferIn);
-            weightKernel.setArg (1, dBufferOutW);
-            weightKernel.setArg (2, dBufferGW);
-            weightKernel.setArg (3, cl::Local (2 * local[0] * sizeof (cl_float)));
-            weightKernel.setArg (4, n);
-
-            groupWeightKernel.setArg (0, dBufferGW);
-            groupWeightKernel.setArg (1, dBufferOutSW);
-            groupWeightKernel.setArg (2, cl::Local (2 * local[0] * sizeof (cl_double)));
-            groupWeightKernel.setArg (3, (cl_uint) (wgXdim / 4));
-        }
+        kernel.setArg (0, dBufferIn);
+        kernel.setArg (1, dBufferOut);
+        setDepthThreshold (_max_dz);
     }
 
 
@@ -1167,16 +1393,16 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPWeights::write (ICPWeights::Memory mem, void *ptr, bool block, 
-                            const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPNormals::write (ICPNormals::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPWeights::Memory::D_IN:
+                case ICPNormals::Memory::D_IN:
                     if (ptr != nullptr)
-                        std::copy ((rbc_dist_id *) ptr, (rbc_dist_id *) ptr + n, hPtrIn);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8 * n, hPtrIn);
                     queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
                     break;
                 default:
@@ -1195,19 +1421,16 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPWeights::read (ICPWeights::Memory mem, bool block, 
-                            const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPNormals::read (ICPNormals::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPWeights::Memory::H_OUT_W:
-                    queue.enqueueReadBuffer (dBufferOutW, block, 0, bufferOutWSize, hPtrOutW, events, event);
-                    return hPtrOutW;
-                case ICPWeights::Memory::H_OUT_SUM_W:
-                    queue.enqueueReadBuffer (dBufferOutSW, block, 0, bufferOutSWSize, hPtrOutSW, events, event);
-                    return hPtrOutSW;
+                case ICPNormals::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
                 default:
                     return nullptr;
             }
@@ -1221,32 +1444,44 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the kernel execution.
      */
-    void ICPWeights::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPNormals::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        if (wgXdim == 1)
-        {
-            queue.enqueueNDRangeKernel (weightKernel, cl::NullRange, globalW, local, events, event);
-        }
-        else
-        {
-            queue.enqueueNDRangeKernel (weightKernel, cl::NullRange, globalW, local, events);
-            queue.enqueueNDRangeKernel (groupWeightKernel, cl::NullRange, globalGW, local, nullptr, event);
-        }
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+    }
+
+
+    /*! \return The threshold for the depth discontinuities, relative to the depth of a point. */
+    float ICPNormals::getDepthThreshold ()
+    {
+        return max_dz;
+    }
+
+
+    /*! \details Updates the kernel argument for the threshold for the depth discontinuities.
+     *  \note A point whose neighbors differ in depth by more than `_max_dz` times 
+     *        its depth is considered to be on an edge, and gets a zero normal.
+     *  
+     *  \param[in] _max_dz threshold for the depth discontinuities, relative to the depth of a point.
+     */
+    void ICPNormals::setDepthThreshold (float _max_dz)
+    {
+        max_dz = _max_dz;
+        kernel.setArg (2, max_dz);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPMean<ICPMeanConfig::REGULAR>::ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPLMs::ICPLMs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        meanKernel (env.getProgram (info.pgIdx), "icpMean"), 
-        groupMeanKernel (env.getProgram (info.pgIdx), "icpGMean"), d (8)
+        kernel (env.getProgram (info.pgIdx), "getLMs"), 
+        layout (ICPLayout::AOS), color (ICPColor::UCHAR), compact (false), singlePass (false), d (8)
     {
-        wgMultiple = meanKernel.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -1255,23 +1490,21 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPMean<ICPMeanConfig::REGULAR>::get (ICPMean::Memory mem)
+    cl::Memory& ICPLMs::get (ICPLMs::Memory mem)
     {
         switch (mem)
         {
-            case ICPMean::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPMean::Memory::H_IN_M:
-                return hBufferInM;
-            case ICPMean::Memory::H_OUT:
+            case ICPLMs::Memory::H_IN:
+                return hBufferIn;
+            case ICPLMs::Memory::H_IN_C:
+                return hBufferInC;
+            case ICPLMs::Memory::H_OUT:
                 return hBufferOut;
-            case ICPMean::Memory::D_IN_F:
-                return dBufferInF;
-            case ICPMean::Memory::D_IN_M:
-                return dBufferInM;
-            case ICPMean::Memory::D_GM:
-                return dBufferGM;
-            case ICPMean::Memory::D_OUT:
+            case ICPLMs::Memory::D_IN:
+                return dBufferIn;
+            case ICPLMs::Memory::D_IN_C:
+                return dBufferInC;
+            case ICPLMs::Memory::D_OUT:
                 return dBufferOut;
         }
     }
@@ -1282,57 +1515,110 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _n number of points in the input array.
+     *  \note The compaction kernels and the `Scan` instances are created here 
+     *        (and only if `_compact` is set), so the program needs to include 
+     *        `kernels/scan_kernels.cl` only when compaction is enabled.
+     *        
+     *  \param[in] _width number of points per row in the point cloud.
+     *  \param[in] _height number of points per column in the point cloud.
+     *  \param[in] _m number of landmarks. It has to be a power of 2.
+     *  \param[in] _compact flag to indicate whether or not to sample only the 
+     *                      valid (non-zero depth) points.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPMean<ICPMeanConfig::REGULAR>::init (unsigned int _n, Staging _staging)
+    void ICPLMs::init (unsigned int _width, unsigned int _height, unsigned int _m, 
+                       bool _compact, Staging _staging)
     {
-        n = _n;
-        bufferInSize  = n * sizeof (cl_float8);
-        bufferOutSize = 2 * sizeof (cl_float4);
+        init (_width, _height, _m, _compact, ICPLayout::AOS, ICPColor::UCHAR, _staging);
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _width number of points per row in the point cloud.
+     *  \param[in] _height number of points per column in the point cloud.
+     *  \param[in] _m number of landmarks. It has to be a power of 2.
+     *  \param[in] _compact flag to indicate whether or not to sample only the 
+     *                      valid (non-zero depth) points. Compaction is only 
+     *                      available for `ICPLayout::AOS`.
+     *  \param[in] _layout memory layout of the point cloud. For `ICPLayout::SOA`, 
+     *                     `D_IN` holds the geometry stream and `D_IN_C` the color stream.
+     *  \param[in] _color storage format of the color stream (for `ICPLayout::SOA`).
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPLMs::init (unsigned int _width, unsigned int _height, unsigned int _m, bool _compact, 
+                       ICPLayout _layout, ICPColor _color, Staging _staging)
+    {
+        width = _width; height = _height;
+        n = width * height; m = _m; mMax = m;
+        compact = _compact;
+        d = (_layout == ICPLayout::SOA) ? 4 : 8;
+        bufferInSize = n * d * sizeof (cl_float);
+        bufferInCSize = (_color == ICPColor::HALF) ? n * 4 * sizeof (cl_half) : n * sizeof (cl_uchar4);
+        bufferOutSize = m * sizeof (cl_float8);
         staging = _staging;
 
-        // Establish the number of work-groups per row
-        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
+        try
+        {
+            if (m == 0 || (m & (m - 1)))
+                throw "The number of landmarks has to be a power of 2";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPLMs]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
 
-        bufferGMSize = 2 * (wgXdim * sizeof (cl_float4));
+        // e.g. m = 16384 -> lx = 128, ly = 128
+        int p = std::log2 (m);
+        lx = std::pow (2, p - p / 2);
+        ly = std::pow (2, p / 2);
+
+        // 10% of the points around the cloud are ignored
+        area = { { width / 10, height / 10, width - 2 * (width / 10), height - 2 * (height / 10) } };
 
         try
         {
-            if (wgXdim == 0)
-                throw "The array cannot have zero points";
+            if (area.s[2] < lx || area.s[3] < ly)
+                throw "The point cloud is too small for the requested number of landmarks";
 
-            if (n % 2 != 0)
-                throw "The number of points in the array must be a multiple of 2";
+            if (compact && width % 4)
+                throw "The number of points per row has to be a multiple of 4 for compaction";
 
-            // (2 * wgMultiple) points per work-group
-            // (2 * wgMultiple) work-groups maximum
-            if (n > std::pow (2 * wgMultiple, 2))
-            {
-                std::ostringstream ss;
-                ss << "The current configuration of ICPMean<ICPMeanConfig::REGULAR> supports arrays ";
-                ss << "of up to " << std::pow (2 * wgMultiple, 2) << " points";
-                throw ss.str ().c_str ();
-            }
+            if (compact && _layout == ICPLayout::SOA)
+                throw "Compaction is not available for the structure-of-arrays layout";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPMean<ICPMeanConfig::REGULAR>]: " << error << std::endl;
+            std::cerr << "Error[ICPLMs]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
+        if (_layout != layout || _color != color)
+        {
+            layout = _layout; color = _color;
+            const char *name = (layout == ICPLayout::AOS) ? "getLMs" : 
+                               (color == ICPColor::HALF) ? "getLMs_SoA_Half" : "getLMs_SoA";
+            kernel = cl::Kernel (env.getProgram (info.pgIdx), name);
+        }
+
         // Set workspaces
-        globalM = cl::NDRange (wgXdim * wgMultiple, 2);
-        globalGM = cl::NDRange (wgMultiple, 2);
-        local = cl::NDRange (wgMultiple, 1);
-        
+        global = (layout == ICPLayout::SOA) ? cl::NDRange (lx, ly) : cl::NDRange (2 * lx, ly);
+        globalF = cl::NDRange (width, height);
+        globalT = cl::NDRange (((height + 3) / 4) * 4);
+        globalC = cl::NDRange (m);
+        bufferTotalsSize = ((height + 3) / 4) * 4 * sizeof (cl_int);
+
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
-                hPtrInM = nullptr;
+                hPtrIn = nullptr;
+                hPtrInC = nullptr;
                 hPtrOut = nullptr;
                 break;
 
@@ -1340,17 +1626,21 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
 
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
-                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
-                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+                hPtrIn = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                queue.enqueueUnmapMemObject (hBufferIn, hPtrIn);
+
+                hPtrInC = nullptr;
+                if (layout == ICPLayout::SOA)
+                {
+                    allocStaging (hBufferInC, bufferInCSize, context, pool, lease);
+
+                    hPtrInC = (cl_uchar *) queue.enqueueMapBuffer (
+                        hBufferInC, CL_FALSE, CL_MAP_WRITE, 0, bufferInCSize);
+                    queue.enqueueUnmapMemObject (hBufferInC, hPtrInC);
+                }
 
                 if (!io)
                 {
@@ -1360,54 +1650,119 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
                 queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
                 queue.finish ();
 
-                if (!io)
-                {
-                    hPtrInF = nullptr;
-                    hPtrInM = nullptr;
-                }
+                if (!io) { hPtrIn = nullptr; hPtrInC = nullptr; }
                 break;
         }
-
+        
         // Create device buffers
-        if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
-        if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
-        if (dBufferGM () == nullptr && wgXdim != 1)
-            dBufferGM = cl::Buffer (context, CL_MEM_READ_WRITE, bufferGMSize);
+        if (dBufferIn () == nullptr)
+            dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (layout == ICPLayout::SOA && dBufferInC () == nullptr)
+            dBufferInC = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInCSize);
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        if (wgXdim == 1)
+        if (layout == ICPLayout::SOA)
         {
-            meanKernel.setArg (0, dBufferInF);
-            meanKernel.setArg (1, dBufferInM);
-            meanKernel.setArg (2, dBufferOut);
-            meanKernel.setArg (3, cl::Local (local[0] * 6 * sizeof (cl_float)));
-            meanKernel.setArg (4, n);
+            kernel.setArg (0, dBufferIn);
+            kernel.setArg (1, dBufferInC);
+            kernel.setArg (2, dBufferOut);
+            kernel.setArg (3, width);
+            kernel.setArg (4, area);
+            return;
         }
-        else
+
+        kernel.setArg (0, dBufferIn);
+        kernel.setArg (1, dBufferOut);
+        kernel.setArg (2, width);
+        kernel.setArg (3, area);
+
+        if (!compact) return;
+
+        // Set up compaction
+        if (!scanFlags)
         {
-            meanKernel.setArg (0, dBufferInF);
-            meanKernel.setArg (1, dBufferInM);
-            meanKernel.setArg (2, dBufferGM);
-            meanKernel.setArg (3, cl::Local (local[0] * 6 * sizeof (cl_float)));
-            meanKernel.setArg (4, n);
+            flagKernel = cl::Kernel (env.getProgram (info.pgIdx), "icpFlagValid");
+            totalsKernel = cl::Kernel (env.getProgram (info.pgIdx), "icpGetRowTotals");
+            compactKernel = cl::Kernel (env.getProgram (info.pgIdx), "getLMs_Compact");
+            scanFlags.reset (new Scan<ScanConfig::INCLUSIVE, cl_int> (env, info, pool));
+            scanTotals.reset (new Scan<ScanConfig::INCLUSIVE, cl_int> (env, info, pool));
+        }
 
-            groupMeanKernel.setArg (0, dBufferGM);
-            groupMeanKernel.setArg (1, dBufferOut);
-            groupMeanKernel.setArg (2, cl::Local (local[0] * 6 * sizeof (cl_float)));
-            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+        if (dBufferFlags () == nullptr)
+            dBufferFlags = cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_int));
+        if (dBufferTotals () == nullptr)
+            dBufferTotals = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTotalsSize);
+
+        scanFlags->get (Scan<ScanConfig::INCLUSIVE, cl_int>::Memory::D_IN) = dBufferFlags;
+        scanFlags->init (width, height, Staging::NONE, singlePass);
+        scanTotals->get (Scan<ScanConfig::INCLUSIVE, cl_int>::Memory::D_IN) = dBufferTotals;
+        scanTotals->init (bufferTotalsSize / sizeof (cl_int), 1, Staging::NONE);
+
+        cl::Buffer &dBufferScan = (cl::Buffer &) 
+            scanFlags->get (Scan<ScanConfig::INCLUSIVE, cl_int>::Memory::D_OUT);
+        cl::Buffer &dBufferRowScan = (cl::Buffer &) 
+            scanTotals->get (Scan<ScanConfig::INCLUSIVE, cl_int>::Memory::D_OUT);
+
+        flagKernel.setArg (0, dBufferIn);
+        flagKernel.setArg (1, dBufferFlags);
+        flagKernel.setArg (2, area);
+
+        totalsKernel.setArg (0, dBufferScan);
+        totalsKernel.setArg (1, dBufferTotals);
+        totalsKernel.setArg (2, width);
+        totalsKernel.setArg (3, height);
+
+        compactKernel.setArg (0, dBufferIn);
+        compactKernel.setArg (1, dBufferScan);
+        compactKernel.setArg (2, dBufferRowScan);
+        compactKernel.setArg (3, dBufferOut);
+        compactKernel.setArg (4, width);
+        compactKernel.setArg (5, height);
+    }
+
+
+    /*! \details Updates the workspaces for a new number of landmarks, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of landmarks given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of landmarks. It has to be a power of 2.
+     */
+    void ICPLMs::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0 || (_m & (_m - 1)))
+                throw "The number of landmarks has to be a power of 2";
+
+            if (_m > mMax)
+                throw "The number of landmarks cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPLMs]: " << error << std::endl;
+            exit (EXIT_FAILURE);
         }
+
+        m = _m;
+        bufferOutSize = m * sizeof (cl_float8);
+
+        int p = std::log2 (m);
+        lx = std::pow (2, p - p / 2);
+        ly = std::pow (2, p / 2);
+
+        // Set workspaces
+        global = (layout == ICPLayout::SOA) ? cl::NDRange (lx, ly) : cl::NDRange (2 * lx, ly);
+        globalC = cl::NDRange (m);
     }
 
 
@@ -1422,22 +1777,23 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPMean<ICPMeanConfig::REGULAR>::write (ICPMean::Memory mem, void *ptr, bool block, 
-                                                 const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPLMs::write (ICPLMs::Memory mem, void *ptr, bool block, 
+                           const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPMean::Memory::D_IN_F:
+                case ICPLMs::Memory::D_IN:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferInSize, hPtrInF, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrIn);
+                    queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
                     break;
-                case ICPMean::Memory::D_IN_M:
+                case ICPLMs::Memory::D_IN_C:
+                    if (layout != ICPLayout::SOA) break;
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInSize, hPtrInM, events, event);
+                        std::copy ((cl_uchar *) ptr, (cl_uchar *) ptr + bufferInCSize, hPtrInC);
+                    queue.enqueueWriteBuffer (dBufferInC, block, 0, bufferInCSize, hPtrInC, events, event);
                     break;
                 default:
                     break;
@@ -1455,14 +1811,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPMean<ICPMeanConfig::REGULAR>::read (ICPMean::Memory mem, bool block, 
-                                                 const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPLMs::read (ICPLMs::Memory mem, bool block, 
+                           const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPMean::Memory::H_OUT:
+                case ICPLMs::Memory::H_OUT:
                     queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
                     return hPtrOut;
                 default:
@@ -1476,34 +1832,57 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
+     *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPMean<ICPMeanConfig::REGULAR>::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPLMs::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        if (wgXdim == 1)
-        {
-            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events, event);
-        }
-        else
+        if (!compact)
         {
-            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events);
-            queue.enqueueNDRangeKernel (groupMeanKernel, cl::NullRange, globalGM, local, nullptr, event);
+            queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+            return;
         }
+
+        queue.enqueueNDRangeKernel (flagKernel, cl::NullRange, globalF, cl::NullRange, events);
+        scanFlags->run ();
+        queue.enqueueNDRangeKernel (totalsKernel, cl::NullRange, globalT, cl::NullRange);
+        scanTotals->run ();
+        queue.enqueueNDRangeKernel (compactKernel, cl::NullRange, globalC, cl::NullRange, nullptr, event);
+    }
+
+
+    /*! \return The flag for the single-pass scan of the valid flags. */
+    bool ICPLMs::getSinglePass ()
+    {
+        return singlePass;
+    }
+
+
+    /*! \details Updates the flag for the single-pass scan of the valid flags. It only 
+     *           has an effect with compaction. If compaction has already been set up, 
+     *           the scan is reconfigured, and it retains its memory objects.
+     *  
+     *  \param[in] _singlePass flag for the single-pass scan.
+     */
+    void ICPLMs::setSinglePass (bool _singlePass)
+    {
+        singlePass = _singlePass;
+        if (compact && scanFlags)
+            scanFlags->init (width, height, Staging::NONE, singlePass);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPMean<ICPMeanConfig::WEIGHTED>::ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPReps::ICPReps (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        meanKernel (env.getProgram (info.pgIdx), "icpMean_Weighted"), 
-        groupMeanKernel (env.getProgram (info.pgIdx), "icpGMean"), d (8)
+        kernel (env.getProgram (info.pgIdx), "getReps"), 
+        d (8)
     {
-        wgMultiple = meanKernel.getWorkGroupInfo
-            <CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -1512,31 +1891,17 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPMean<ICPMeanConfig::WEIGHTED>::get (ICPMean::Memory mem)
+    cl::Memory& ICPReps::get (ICPReps::Memory mem)
     {
         switch (mem)
         {
-            case ICPMean::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPMean::Memory::H_IN_M:
-                return hBufferInM;
-            case ICPMean::Memory::H_IN_W:
-                return hBufferInW;
-            case ICPMean::Memory::H_IN_SUM_W:
-                return hBufferInSW;
-            case ICPMean::Memory::H_OUT:
+            case ICPReps::Memory::H_IN:
+                return hBufferIn;
+            case ICPReps::Memory::H_OUT:
                 return hBufferOut;
-            case ICPMean::Memory::D_IN_F:
-                return dBufferInF;
-            case ICPMean::Memory::D_IN_M:
-                return dBufferInM;
-            case ICPMean::Memory::D_IN_W:
-                return dBufferInW;
-            case ICPMean::Memory::D_IN_SUM_W:
-                return dBufferInSW;
-            case ICPMean::Memory::D_GM:
-                return dBufferGM;
-            case ICPMean::Memory::D_OUT:
+            case ICPReps::Memory::D_IN:
+                return dBufferIn;
+            case ICPReps::Memory::D_OUT:
                 return dBufferOut;
         }
     }
@@ -1547,61 +1912,58 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _n number of points in the input sets.
+     *  \param[in] _nr number of representatives in the output array.
+     *  \param[in] _m number of landmarks in the input array. It has to be a power of 2, 
+     *                and the landmarks are interpreted as an array \f$ (n_{lx} \times n_{ly}) \f$, 
+     *                as produced by `ICPLMs`.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPMean<ICPMeanConfig::WEIGHTED>::init (unsigned int _n, Staging _staging)
+    void ICPReps::init (unsigned int _nr, unsigned int _m, Staging _staging)
     {
-        n = _n;
-        bufferInFMSize  = n * sizeof (cl_float8);
-        bufferInWSize  = n * sizeof (cl_float);
-        bufferInSWSize  = sizeof (cl_double);
-        bufferOutSize = 2 * sizeof (cl_float4);
+        nr = nrMax = _nr; m = mMax = _m;
+        bufferInSize = m * sizeof (cl_float8);
+        bufferOutSize = nr * sizeof (cl_float8);
         staging = _staging;
 
-        // Establish the number of work-groups per row
-        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
-
-        bufferGMSize = 2 * (wgXdim * sizeof (cl_float4));
-
         try
         {
-            if (wgXdim == 0)
-                throw "The array cannot have zero points";
+            if (nr == 0)
+                throw "The number of representatives cannot be zero";
 
-            if (n % 2 != 0)
-                throw "The number of points in the array must be a multiple of 2";
+            if (nr % 4)
+                throw "The number of representatives has to be a multiple of 4";
 
-            // (2 * wgMultiple) points per work-group
-            // (2 * wgMultiple) work-groups maximum
-            if (n > std::pow (2 * wgMultiple, 2))
-            {
-                std::ostringstream ss;
-                ss << "The current configuration of ICPMean<ICPMeanConfig::WEIGHTED> supports arrays ";
-                ss << "of up to " << std::pow (2 * wgMultiple, 2) << " points";
-                throw ss.str ().c_str ();
-            }
+            if (m == 0 || (m & (m - 1)))
+                throw "The number of landmarks has to be a power of 2";
+
+            if (nr > m)
+                throw "The number of representatives cannot exceed the number of landmarks";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPMean<ICPMeanConfig::WEIGHTED>]: " << error << std::endl;
+            std::cerr << "Error[ICPReps]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
+        // e.g. nr = 32 -> nrx = 8, nry = 4
+        int p = std::log2 (nr);
+        nrx = std::pow (2, p - p / 2);
+        nry = std::pow (2, p / 2);
+
+        // e.g. m = 16384 -> lx = 128, ly = 128
+        p = std::log2 (m);
+        lx = std::pow (2, p - p / 2);
+        ly = std::pow (2, p / 2);
+
         // Set workspaces
-        globalM = cl::NDRange (wgXdim * wgMultiple, 2);
-        globalGM = cl::NDRange (wgMultiple, 2);
-        local = cl::NDRange (wgMultiple, 1);
-        
+        global = cl::NDRange (nrx, nry);
+
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
-                hPtrInM = nullptr;
-                hPtrInW = nullptr;
-                hPtrInSW = nullptr;
+                hPtrIn = nullptr;
                 hPtrOut = nullptr;
                 break;
 
@@ -1609,27 +1971,11 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInFMSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInFMSize);
-                if (hBufferInW () == nullptr)
-                    hBufferInW = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInWSize);
-                if (hBufferInSW () == nullptr)
-                    hBufferInSW = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSWSize);
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
 
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
-                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
-                hPtrInW = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInW, CL_FALSE, CL_MAP_WRITE, 0, bufferInWSize);
-                hPtrInSW = (cl_double *) queue.enqueueMapBuffer (
-                    hBufferInSW, CL_FALSE, CL_MAP_WRITE, 0, bufferInSWSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
-                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
-                queue.enqueueUnmapMemObject (hBufferInW, hPtrInW);
-                queue.enqueueUnmapMemObject (hBufferInSW, hPtrInSW);
+                hPtrIn = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                queue.enqueueUnmapMemObject (hBufferIn, hPtrIn);
 
                 if (!io)
                 {
@@ -1639,64 +1985,82 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
                 queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
                 queue.finish ();
 
-                if (!io)
-                {
-                    hPtrInF = nullptr;
-                    hPtrInM = nullptr;
-                    hPtrInW = nullptr;
-                    hPtrInSW = nullptr;
-                }
+                if (!io) hPtrIn = nullptr;
                 break;
         }
-
+        
         // Create device buffers
-        if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
-        if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
-        if (dBufferInW () == nullptr)
-            dBufferInW = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInWSize);
-        if (dBufferInSW () == nullptr)
-            dBufferInSW = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSWSize);
-        if (dBufferGM () == nullptr && wgXdim != 1)
-            dBufferGM = cl::Buffer (context, CL_MEM_READ_WRITE, bufferGMSize);
+        if (dBufferIn () == nullptr)
+            dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        if (wgXdim == 1)
+        kernel.setArg (0, dBufferIn);
+        kernel.setArg (1, dBufferOut);
+        kernel.setArg (2, lx);
+        kernel.setArg (3, ly);
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of landmarks and representatives, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of landmarks and representatives given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _nr number of representatives in the output array.
+     *  \param[in] _m number of landmarks in the input array. It has to be a power of 2.
+     */
+    void ICPReps::resize (unsigned int _nr, unsigned int _m)
+    {
+        try
         {
-            meanKernel.setArg (0, dBufferInF);
-            meanKernel.setArg (1, dBufferInM);
-            meanKernel.setArg (2, dBufferOut);
-            meanKernel.setArg (3, dBufferInW);
-            meanKernel.setArg (4, dBufferInSW);
-            meanKernel.setArg (5, cl::Local (local[0] * 6 * sizeof (cl_float)));
-            meanKernel.setArg (6, n);
+            if (_nr == 0)
+                throw "The number of representatives cannot be zero";
+
+            if (_nr % 4)
+                throw "The number of representatives has to be a multiple of 4";
+
+            if (_m == 0 || (_m & (_m - 1)))
+                throw "The number of landmarks has to be a power of 2";
+
+            if (_nr > _m)
+                throw "The number of representatives cannot exceed the number of landmarks";
+
+            if (_nr > nrMax || _m > mMax)
+                throw "The number of landmarks or representatives cannot exceed the capacity set by init";
         }
-        else
+        catch (const char *error)
         {
-            meanKernel.setArg (0, dBufferInF);
-            meanKernel.setArg (1, dBufferInM);
-            meanKernel.setArg (2, dBufferGM);
-            meanKernel.setArg (3, dBufferInW);
-            meanKernel.setArg (4, dBufferInSW);
-            meanKernel.setArg (5, cl::Local (local[0] * 6 * sizeof (cl_float)));
-            meanKernel.setArg (6, n);
-
-            groupMeanKernel.setArg (0, dBufferGM);
-            groupMeanKernel.setArg (1, dBufferOut);
-            groupMeanKernel.setArg (2, cl::Local (local[0] * 6 * sizeof (cl_float)));
-            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+            std::cerr << "Error[ICPReps]: " << error << std::endl;
+            exit (EXIT_FAILURE);
         }
+
+        nr = _nr; m = _m;
+        bufferInSize = m * sizeof (cl_float8);
+        bufferOutSize = nr * sizeof (cl_float8);
+
+        int p = std::log2 (nr);
+        nrx = std::pow (2, p - p / 2);
+        nry = std::pow (2, p / 2);
+
+        p = std::log2 (m);
+        lx = std::pow (2, p - p / 2);
+        ly = std::pow (2, p / 2);
+
+        // Set workspaces
+        global = cl::NDRange (nrx, nry);
+
+        // Set kernel arguments
+        kernel.setArg (2, lx);
+        kernel.setArg (3, ly);
     }
 
 
@@ -1711,32 +2075,17 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPMean<ICPMeanConfig::WEIGHTED>::write (ICPMean::Memory mem, void *ptr, bool block, 
-                                                  const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPReps::write (ICPReps::Memory mem, void *ptr, bool block, 
+                            const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPMean::Memory::D_IN_F:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferInFMSize, hPtrInF, events, event);
-                    break;
-                case ICPMean::Memory::D_IN_M:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInFMSize, hPtrInM, events, event);
-                    break;
-                case ICPMean::Memory::D_IN_W:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n, hPtrInW);
-                    queue.enqueueWriteBuffer (dBufferInW, block, 0, bufferInWSize, hPtrInW, events, event);
-                    break;
-                case ICPMean::Memory::D_IN_SUM_W:
+                case ICPReps::Memory::D_IN:
                     if (ptr != nullptr)
-                        std::copy ((cl_double *) ptr, (cl_double *) ptr + 1, hPtrInSW);
-                    queue.enqueueWriteBuffer (dBufferInSW, block, 0, bufferInSWSize, hPtrInSW, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrIn);
+                    queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
                     break;
                 default:
                     break;
@@ -1754,14 +2103,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPMean<ICPMeanConfig::WEIGHTED>::read (ICPMean::Memory mem, bool block, 
-                                                  const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPReps::read (ICPReps::Memory mem, bool block, 
+                            const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPMean::Memory::H_OUT:
+                case ICPReps::Memory::H_OUT:
                     queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
                     return hPtrOut;
                 default:
@@ -1775,31 +2124,27 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
+     *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPMean<ICPMeanConfig::WEIGHTED>::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPReps::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        if (wgXdim == 1)
-        {
-            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events, event);
-        }
-        else
-        {
-            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events);
-            queue.enqueueNDRangeKernel (groupMeanKernel, cl::NullRange, globalGM, local, nullptr, event);
-        }
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPDevs::ICPDevs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPWeights::ICPWeights (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "icpSubtractMean"), d (8)
+        weightKernel (env.getProgram (info.pgIdx), "icpComputeReduceWeights"), 
+        groupWeightKernel (env.getProgram (info.pgIdx), "reduce_sum_fd")
     {
+        wgMultiple = getWorkGroupMultiple (weightKernel, env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -1808,30 +2153,24 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPDevs::get (ICPDevs::Memory mem)
+    cl::Memory& ICPWeights::get (ICPWeights::Memory mem)
     {
         switch (mem)
         {
-            case ICPDevs::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPDevs::Memory::H_IN_M:
-                return hBufferInM;
-            case ICPDevs::Memory::H_IN_MEAN:
-                return hBufferInMean;
-            case ICPDevs::Memory::H_OUT_DEV_F:
-                return hBufferOutDF;
-            case ICPDevs::Memory::H_OUT_DEV_M:
-                return hBufferOutDM;
-            case ICPDevs::Memory::D_IN_F:
-                return dBufferInF;
-            case ICPDevs::Memory::D_IN_M:
-                return dBufferInM;
-            case ICPDevs::Memory::D_IN_MEAN:
-                return dBufferInMean;
-            case ICPDevs::Memory::D_OUT_DEV_F:
-                return dBufferOutDF;
-            case ICPDevs::Memory::D_OUT_DEV_M:
-                return dBufferOutDM;
+            case ICPWeights::Memory::H_IN:
+                return hBufferIn;
+            case ICPWeights::Memory::H_OUT_W:
+                return hBufferOutW;
+            case ICPWeights::Memory::H_OUT_SUM_W:
+                return hBufferOutSW;
+            case ICPWeights::Memory::D_IN:
+                return dBufferIn;
+            case ICPWeights::Memory::D_OUT_W:
+                return dBufferOutW;
+            case ICPWeights::Memory::D_GW:
+                return dBufferGW;
+            case ICPWeights::Memory::D_OUT_SUM_W:
+                return dBufferOutSW;
         }
     }
 
@@ -1841,113 +2180,206 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _n number of points.
+     *  \param[in] _n number of elements in the input sets.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPDevs::init (unsigned int _n, Staging _staging)
+    void ICPWeights::init (unsigned int _n, Staging _staging)
     {
-        n = _n;
-        bufferInFMSize = n * sizeof (cl_float8);
-        bufferInMeanSize = 2 * sizeof (cl_float4);
-        bufferOutSize = n * sizeof (cl_float4);
+        n = nMax = _n;
+        bufferInSize  = n * sizeof (rbc_dist_id);
+        bufferOutWSize = n * sizeof (cl_float);
+        bufferOutSWSize = sizeof (cl_double);
         staging = _staging;
 
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
+        // Round up to a multiple of 4 (data are handled as float4 in reduce_sum)
+        if ((wgXdim != 1) && (wgXdim % 4)) wgXdim += 4 - wgXdim % 4;
+
+        bufferGWSize = wgXdim * sizeof (cl_double);
+
         try
         {
-            if (n == 0)
-                throw "The array cannot have zero points";
+            if (wgXdim == 0)
+                throw "The array cannot have zero elements";
+
+            if (n % 2 != 0)
+                throw "The number of elements in the array must be a multiple of 2";
+
+            // (2 * wgMultiple) elements per work-group
+            // (8 * wgMultiple) work-groups maximum
+            if (n > 16 * wgMultiple * wgMultiple)
+            {
+                std::ostringstream ss;
+                ss << "The current configuration of ICPWeights supports arrays ";
+                ss << "of up to " << 16 * wgMultiple * wgMultiple << " elements";
+                throw ss.str ().c_str ();
+            }
+            if (!matchesSpecialization (env, info, _n))
+                throw "The program is specialized for a different number of points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPDevs]: " << error << std::endl;
+            std::cerr << "Error[ICPWeights]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
-        // Set workspaces
-        global = cl::NDRange (n, 2);
+        // Extract kernel
+        if (wgXdim > 1)
+            weightKernel = cl::Kernel (env.getProgram (info.pgIdx), "icpComputeReduceWeights_WG");
 
+        // Set workspaces
+        globalW = cl::NDRange (wgXdim * wgMultiple);
+        globalGW = cl::NDRange (wgMultiple);
+        local = cl::NDRange (wgMultiple);
+        
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
-                hPtrInM = nullptr;
-                hPtrInMean = nullptr;
-                hPtrOutDevF = nullptr;
-                hPtrOutDevM = nullptr;
+                hPtrIn = nullptr;
+                hPtrOutW = nullptr;
+                hPtrOutSW = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInFMSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInFMSize);
-                if (hBufferInMean () == nullptr)
-                    hBufferInMean = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInMeanSize);
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
 
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
-                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
-                hPtrInMean = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInMean, CL_FALSE, CL_MAP_WRITE, 0, bufferInMeanSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
-                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
-                queue.enqueueUnmapMemObject (hBufferInMean, hPtrInMean);
+                hPtrIn = (rbc_dist_id *) queue.enqueueMapBuffer (
+                    hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                queue.enqueueUnmapMemObject (hBufferIn, hPtrIn);
 
                 if (!io)
                 {
                     queue.finish ();
-                    hPtrOutDevF = nullptr;
-                    hPtrOutDevM = nullptr;
+                    hPtrOutW = nullptr;
+                    hPtrOutSW = nullptr;
                     break;
                 }
 
             case Staging::O:
-                if (hBufferOutDF () == nullptr)
-                    hBufferOutDF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
-                if (hBufferOutDM () == nullptr)
-                    hBufferOutDM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOutW, bufferOutWSize, context, pool, lease);
+                allocStaging (hBufferOutSW, bufferOutSWSize, context, pool, lease);
 
-                hPtrOutDevF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferOutDF, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
-                hPtrOutDevM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferOutDM, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
-                queue.enqueueUnmapMemObject (hBufferOutDF, hPtrOutDevF);
-                queue.enqueueUnmapMemObject (hBufferOutDM, hPtrOutDevM);
+                hPtrOutW = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutW, CL_FALSE, CL_MAP_READ, 0, bufferOutWSize);
+                hPtrOutSW = (cl_double *) queue.enqueueMapBuffer (
+                    hBufferOutSW, CL_FALSE, CL_MAP_READ, 0, bufferOutSWSize);
+                queue.enqueueUnmapMemObject (hBufferOutW, hPtrOutW);
+                queue.enqueueUnmapMemObject (hBufferOutSW, hPtrOutSW);
                 queue.finish ();
 
-                if (!io)
-                {
-                    hPtrInF = nullptr;
-                    hPtrInM = nullptr;
-                    hPtrInMean = nullptr;
-                }
+                if (!io) hPtrIn = nullptr;
                 break;
         }
-        
+
         // Create device buffers
-        if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
-        if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
-        if (dBufferInMean () == nullptr)
-            dBufferInMean = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMeanSize);
-        if (dBufferOutDF () == nullptr)
-            dBufferOutDF = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
-        if (dBufferOutDM () == nullptr)
-            dBufferOutDM = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
+        if (dBufferIn () == nullptr)
+            dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferOutW () == nullptr)
+            dBufferOutW = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutWSize);
+        if (dBufferGW () == nullptr && wgXdim != 1)
+            dBufferGW = cl::Buffer (context, CL_MEM_READ_WRITE, bufferGWSize);
+        if (dBufferOutSW () == nullptr)
+            dBufferOutSW = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSWSize);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferInF);
-        kernel.setArg (1, dBufferInM);
-        kernel.setArg (2, dBufferOutDF);
-        kernel.setArg (3, dBufferOutDM);
-        kernel.setArg (4, dBufferInMean);
+        if (wgXdim == 1)
+        {
+            weightKernel.setArg (0, dBufferIn);
+            weightKernel.setArg (1, dBufferOutW);
+            weightKernel.setArg (2, dBufferOutSW);
+            weightKernel.setArg (3, cl::Local (2 * local[0] * sizeof (cl_float)));
+            weightKernel.setArg (4, n);
+        }
+        else
+        {
+            weightKernel.setArg (0, dBufferIn);
+            weightKernel.setArg (1, dBufferOutW);
+            weightKernel.setArg (2, dBufferGW);
+            weightKernel.setArg (3, cl::Local (2 * local[0] * sizeof (cl_float)));
+            weightKernel.setArg (4, n);
+
+            groupWeightKernel.setArg (0, dBufferGW);
+            groupWeightKernel.setArg (1, dBufferOutSW);
+            groupWeightKernel.setArg (2, cl::Local (2 * local[0] * sizeof (cl_double)));
+            groupWeightKernel.setArg (3, (cl_uint) (wgXdim / 4));
+        }
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of elements, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of elements given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _n number of elements in the input sets.
+     */
+    void ICPWeights::resize (unsigned int _n)
+    {
+        try
+        {
+            if (_n == 0)
+                throw "The array cannot have zero elements";
+
+            if (_n % 2 != 0)
+                throw "The number of elements in the array must be a multiple of 2";
+
+            if (_n > nMax)
+                throw "The number of elements cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _n))
+                throw "The program is specialized for a different number of points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPWeights]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        bool wg = (wgXdim > 1);
+
+        n = _n;
+        bufferInSize  = n * sizeof (rbc_dist_id);
+        bufferOutWSize = n * sizeof (cl_float);
+
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
+        // Round up to a multiple of 4 (data are handled as float4 in reduce_sum)
+        if ((wgXdim != 1) && (wgXdim % 4)) wgXdim += 4 - wgXdim % 4;
+
+        bufferGWSize = wgXdim * sizeof (cl_double);
+
+        // Extract kernel (only when crossing the single work-group boundary)
+        if (wg != (wgXdim > 1))
+        {
+            weightKernel = cl::Kernel (env.getProgram (info.pgIdx), 
+                (wgXdim > 1) ? "icpComputeReduceWeights_WG" : "icpComputeReduceWeights");
+
+            weightKernel.setArg (0, dBufferIn);
+            weightKernel.setArg (1, dBufferOutW);
+            weightKernel.setArg (3, cl::Local (2 * local[0] * sizeof (cl_float)));
+        }
+
+        // Set workspaces
+        globalW = cl::NDRange (wgXdim * wgMultiple);
+
+        // Set kernel arguments
+        if (wgXdim == 1)
+        {
+            weightKernel.setArg (2, dBufferOutSW);
+            weightKernel.setArg (4, n);
+        }
+        else
+        {
+            weightKernel.setArg (2, dBufferGW);
+            weightKernel.setArg (4, n);
+
+            groupWeightKernel.setArg (3, (cl_uint) (wgXdim / 4));
+        }
     }
 
 
@@ -1962,27 +2394,17 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPDevs::write (ICPDevs::Memory mem, void *ptr, bool block, 
-                         const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPWeights::write (ICPWeights::Memory mem, void *ptr, bool block, 
+                            const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPDevs::Memory::D_IN_F:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferInFMSize, hPtrInF, events, event);
-                    break;
-                case ICPDevs::Memory::D_IN_M:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInFMSize, hPtrInM, events, event);
-                    break;
-                case ICPDevs::Memory::D_IN_MEAN:
+                case ICPWeights::Memory::D_IN:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 4, hPtrInMean);
-                    queue.enqueueWriteBuffer (dBufferInMean, block, 0, bufferInMeanSize, hPtrInMean, events, event);
+                        std::copy ((rbc_dist_id *) ptr, (rbc_dist_id *) ptr + n, hPtrIn);
+                    queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
                     break;
                 default:
                     break;
@@ -2000,19 +2422,19 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPDevs::read (ICPDevs::Memory mem, bool block, 
-                         const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPWeights::read (ICPWeights::Memory mem, bool block, 
+                            const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPDevs::Memory::H_OUT_DEV_F:
-                    queue.enqueueReadBuffer (dBufferOutDF, block, 0, bufferOutSize, hPtrOutDevF, events, event);
-                    return hPtrOutDevF;
-                case ICPDevs::Memory::H_OUT_DEV_M:
-                    queue.enqueueReadBuffer (dBufferOutDM, block, 0, bufferOutSize, hPtrOutDevM, events, event);
-                    return hPtrOutDevM;
+                case ICPWeights::Memory::H_OUT_W:
+                    queue.enqueueReadBuffer (dBufferOutW, block, 0, bufferOutWSize, hPtrOutW, events, event);
+                    return hPtrOutW;
+                case ICPWeights::Memory::H_OUT_SUM_W:
+                    queue.enqueueReadBuffer (dBufferOutSW, block, 0, bufferOutSWSize, hPtrOutSW, events, event);
+                    return hPtrOutSW;
                 default:
                     return nullptr;
             }
@@ -2024,24 +2446,36 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the last kernel execution.
+     *  \param[out] event event associated with the kernel execution.
      */
-    void ICPDevs::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPWeights::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
-    }
-
+        if (wgXdim == 1)
+        {
+            queue.enqueueNDRangeKernel (weightKernel, cl::NullRange, globalW, local, events, event);
+        }
+        else
+        {
+            queue.enqueueNDRangeKernel (weightKernel, cl::NullRange, globalW, local, events);
+            queue.enqueueNDRangeKernel (groupWeightKernel, cl::NullRange, globalGW, local, nullptr, event);
+        }
+    }
+
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPS<ICPSConfig::REGULAR>::ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPMean<ICPMeanConfig::REGULAR>::ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "icpSijProducts"), 
-        reduceSij (env, info), d (4)
+        meanKernel (env.getProgram (info.pgIdx), "icpMean"), 
+        groupMeanKernel (env.getProgram (info.pgIdx), "icpGMean"), 
+        spKernel (env.getProgram (info.pgIdx), "icpMean_SP"), d (8), singlePass (false)
     {
+        wgMultiple = getWorkGroupMultiple (meanKernel, env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -2050,23 +2484,23 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPS<ICPSConfig::REGULAR>::get (ICPS::Memory mem)
+    cl::Memory& ICPMean<ICPMeanConfig::REGULAR>::get (ICPMean::Memory mem)
     {
         switch (mem)
         {
-            case ICPS::Memory::H_IN_DEV_M:
-                return hBufferInDM;
-            case ICPS::Memory::H_IN_DEV_F:
-                return hBufferInDF;
-            case ICPS::Memory::H_OUT:
+            case ICPMean::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPMean::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPMean::Memory::H_OUT:
                 return hBufferOut;
-            case ICPS::Memory::D_IN_DEV_M:
-                return dBufferInDM;
-            case ICPS::Memory::D_IN_DEV_F:
-                return dBufferInDF;
-            case ICPS::Memory::D_SIJ:
-                return dBufferSij;
-            case ICPS::Memory::D_OUT:
+            case ICPMean::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPMean::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPMean::Memory::D_GM:
+                return dBufferGM;
+            case ICPMean::Memory::D_OUT:
                 return dBufferOut;
         }
     }
@@ -2077,44 +2511,59 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the sets.
-     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues.
+     *  \param[in] _n number of points in the input array.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPS<ICPSConfig::REGULAR>::init (unsigned int _m, float _c, Staging _staging)
+    void ICPMean<ICPMeanConfig::REGULAR>::init (unsigned int _n, Staging _staging)
     {
-        m = _m; c = _c;
-        bufferInSize = m * sizeof (cl_float4);
-        bufferOutSize = 11 * sizeof (cl_float);
+        n = nMax = _n;
+        bufferInSize  = n * sizeof (cl_float8);
+        bufferOutSize = 2 * sizeof (cl_float4);
         staging = _staging;
 
-        unsigned int n = m;
-        if (n % 4) n += 4 - n % 4;
-        n /= 4;
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
 
-        bufferSijSize = 11 * (n * sizeof (cl_float));
+        bufferGMSize = 2 * (wgXdim * sizeof (cl_float4));
 
         try
         {
-            if (m == 0)
+            if (wgXdim == 0)
                 throw "The array cannot have zero points";
+
+            if (n % 2 != 0)
+                throw "The number of points in the array must be a multiple of 2";
+
+            // (2 * wgMultiple) points per work-group
+            // (2 * wgMultiple) work-groups maximum
+            if (n > std::pow (2 * wgMultiple, 2))
+            {
+                std::ostringstream ss;
+                ss << "The current configuration of ICPMean<ICPMeanConfig::REGULAR> supports arrays ";
+                ss << "of up to " << std::pow (2 * wgMultiple, 2) << " points";
+                throw ss.str ().c_str ();
+            }
+            if (!matchesSpecialization (env, info, _n))
+                throw "The program is specialized for a different number of points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPS<ICPSConfig::REGULAR>]: " << error << std::endl;
+            std::cerr << "Error[ICPMean<ICPMeanConfig::REGULAR>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
         // Set workspaces
-        global = cl::NDRange (n);
-
+        globalM = cl::NDRange (wgXdim * wgMultiple, 2);
+        globalGM = cl::NDRange (wgMultiple, 2);
+        local = cl::NDRange (wgMultiple, 1);
+        
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInDevM = nullptr;
-                hPtrInDevF = nullptr;
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
                 hPtrOut = nullptr;
                 break;
 
@@ -2122,17 +2571,15 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferInDM () == nullptr)
-                    hBufferInDM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
-                if (hBufferInDF () == nullptr)
-                    hBufferInDF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSize);
+                allocStaging (hBufferInF, bufferInSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferInSize, context, pool, lease);
 
-                hPtrInDevM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInDM, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
-                hPtrInDevF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInDF, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
-                queue.enqueueUnmapMemObject (hBufferInDM, hPtrInDevM);
-                queue.enqueueUnmapMemObject (hBufferInDF, hPtrInDevF);
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
 
                 if (!io)
                 {
@@ -2142,8 +2589,7 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
@@ -2152,32 +2598,120 @@ namespace ICP
 
                 if (!io)
                 {
-                    hPtrInDevM = nullptr;
-                    hPtrInDevF = nullptr;
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
                 }
                 break;
         }
-        
+
         // Create device buffers
-        if (dBufferInDM () == nullptr)
-            dBufferInDM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
-        if (dBufferInDF () == nullptr)
-            dBufferInDF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
-        if (dBufferSij () == nullptr)
-            dBufferSij = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSijSize);
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferGM () == nullptr && wgXdim != 1)
+            dBufferGM = cl::Buffer (context, CL_MEM_READ_WRITE, bufferGMSize);
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
+        // The single-pass kernel resets the counters after every launch
+        cl_uint zeros[2] = { 0, 0 };
+        dBufferCount = cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_uint));
+        queue.enqueueWriteBuffer (dBufferCount, CL_TRUE, 0, 2 * sizeof (cl_uint), zeros);
+
         // Set kernel arguments
-        kernel.setArg (0, dBufferInDM);
-        kernel.setArg (1, dBufferInDF);
-        kernel.setArg (2, dBufferSij);
-        kernel.setArg (3, m);
-        kernel.setArg (4, c);
+        if (wgXdim == 1)
+        {
+            meanKernel.setArg (0, dBufferInF);
+            meanKernel.setArg (1, dBufferInM);
+            meanKernel.setArg (2, dBufferOut);
+            meanKernel.setArg (3, cl::Local (local[0] * 6 * sizeof (cl_float)));
+            meanKernel.setArg (4, n);
+        }
+        else
+        {
+            meanKernel.setArg (0, dBufferInF);
+            meanKernel.setArg (1, dBufferInM);
+            meanKernel.setArg (2, dBufferGM);
+            meanKernel.setArg (3, cl::Local (local[0] * 6 * sizeof (cl_float)));
+            meanKernel.setArg (4, n);
 
-        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSij;
-        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferOut;
-        reduceSij.init (n, 11, Staging::NONE);
+            groupMeanKernel.setArg (0, dBufferGM);
+            groupMeanKernel.setArg (1, dBufferOut);
+            groupMeanKernel.setArg (2, cl::Local (local[0] * 6 * sizeof (cl_float)));
+            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+
+            spKernel.setArg (0, dBufferInF);
+            spKernel.setArg (1, dBufferInM);
+            spKernel.setArg (2, dBufferOut);
+            spKernel.setArg (3, dBufferGM);
+            spKernel.setArg (4, dBufferCount);
+            spKernel.setArg (5, cl::Local (local[0] * 3 * sizeof (cl_float)));
+            spKernel.setArg (6, n);
+        }
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _n number of points in the input array.
+     */
+    void ICPMean<ICPMeanConfig::REGULAR>::resize (unsigned int _n)
+    {
+        try
+        {
+            if (_n == 0)
+                throw "The array cannot have zero points";
+
+            if (_n % 2 != 0)
+                throw "The number of points in the array must be a multiple of 2";
+
+            if (_n > nMax)
+                throw "The number of points cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _n))
+                throw "The program is specialized for a different number of points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPMean<ICPMeanConfig::REGULAR>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        n = _n;
+        bufferInSize = n * sizeof (cl_float8);
+
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
+
+        bufferGMSize = 2 * (wgXdim * sizeof (cl_float4));
+
+        // Set workspaces
+        globalM = cl::NDRange (wgXdim * wgMultiple, 2);
+
+        // Set kernel arguments
+        if (wgXdim == 1)
+        {
+            meanKernel.setArg (2, dBufferOut);
+            meanKernel.setArg (4, n);
+        }
+        else
+        {
+            meanKernel.setArg (2, dBufferGM);
+            meanKernel.setArg (4, n);
+
+            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+
+            spKernel.setArg (0, dBufferInF);
+            spKernel.setArg (1, dBufferInM);
+            spKernel.setArg (2, dBufferOut);
+            spKernel.setArg (3, dBufferGM);
+            spKernel.setArg (4, dBufferCount);
+            spKernel.setArg (5, cl::Local (local[0] * 3 * sizeof (cl_float)));
+            spKernel.setArg (6, n);
+        }
     }
 
 
@@ -2192,22 +2726,22 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPS<ICPSConfig::REGULAR>::write (ICPS::Memory mem, void *ptr, bool block, 
-                                           const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPMean<ICPMeanConfig::REGULAR>::write (ICPMean::Memory mem, void *ptr, bool block, 
+                                                 const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPS::Memory::D_IN_DEV_M:
+                case ICPMean::Memory::D_IN_F:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevM);
-                    queue.enqueueWriteBuffer (dBufferInDM, block, 0, bufferInSize, hPtrInDevM, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferInSize, hPtrInF, events, event);
                     break;
-                case ICPS::Memory::D_IN_DEV_F:
+                case ICPMean::Memory::D_IN_M:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevF);
-                    queue.enqueueWriteBuffer (dBufferInDF, block, 0, bufferInSize, hPtrInDevF, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInSize, hPtrInM, events, event);
                     break;
                 default:
                     break;
@@ -2225,14 +2759,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPS<ICPSConfig::REGULAR>::read (ICPS::Memory mem, bool block, 
-                                           const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPMean<ICPMeanConfig::REGULAR>::read (ICPMean::Memory mem, bool block, 
+                                                 const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPS::Memory::H_OUT:
+                case ICPMean::Memory::H_OUT:
                     queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
                     return hPtrOut;
                 default:
@@ -2246,50 +2780,57 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the last kernel execution.
+     *  \param[out] event event associated with the kernel execution.
      */
-    void ICPS<ICPSConfig::REGULAR>::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPMean<ICPMeanConfig::REGULAR>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events);
-
-        reduceSij.run (nullptr, event);
+        if (wgXdim == 1)
+        {
+            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events, event);
+        }
+        else if (singlePass)
+        {
+            queue.enqueueNDRangeKernel (spKernel, cl::NullRange, globalM, local, events, event);
+        }
+        else
+        {
+            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events);
+            queue.enqueueNDRangeKernel (groupMeanKernel, cl::NullRange, globalGM, local, nullptr, event);
+        }
     }
 
 
-    /*! \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \return The scaling factor c.
-     */
-    float ICPS<ICPSConfig::REGULAR>::getScaling ()
+    /*! \return The flag for the single-pass computation of the means. */
+    bool ICPMean<ICPMeanConfig::REGULAR>::getSinglePass ()
     {
-        return c;
+        return singlePass;
     }
 
 
-    /*! \details Updates the kernel argument for the scaling factor c.
-     *  \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
+    /*! \details Updates the flag for the single-pass computation of the means. 
+     *           It only has an effect when the sets span more than one work-group.
      *  
-     *  \param[in] _c scaling factor.
+     *  \param[in] _singlePass flag for the single-pass computation of the means.
      */
-    void ICPS<ICPSConfig::REGULAR>::setScaling (float _c)
+    void ICPMean<ICPMeanConfig::REGULAR>::setSinglePass (bool _singlePass)
     {
-        c = _c;
-        kernel.setArg (4, c);
+        singlePass = _singlePass;
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPS<ICPSConfig::WEIGHTED>::ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPMean<ICPMeanConfig::WEIGHTED>::ICPMean (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "icpSijProducts_Weighted"), 
-        reduceSij (env, info), d (4)
+        meanKernel (env.getProgram (info.pgIdx), "icpMean_Weighted"), 
+        groupMeanKernel (env.getProgram (info.pgIdx), "icpGMean"), d (8)
     {
+        wgMultiple = getWorkGroupMultiple (meanKernel, env.devices[info.pIdx][info.dIdx]);
     }
 
 
@@ -2298,27 +2839,31 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPS<ICPSConfig::WEIGHTED>::get (ICPS::Memory mem)
+    cl::Memory& ICPMean<ICPMeanConfig::WEIGHTED>::get (ICPMean::Memory mem)
     {
         switch (mem)
         {
-            case ICPS::Memory::H_IN_DEV_M:
-                return hBufferInDM;
-            case ICPS::Memory::H_IN_DEV_F:
-                return hBufferInDF;
-            case ICPS::Memory::H_IN_W:
+            case ICPMean::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPMean::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPMean::Memory::H_IN_W:
                 return hBufferInW;
-            case ICPS::Memory::H_OUT:
+            case ICPMean::Memory::H_IN_SUM_W:
+                return hBufferInSW;
+            case ICPMean::Memory::H_OUT:
                 return hBufferOut;
-            case ICPS::Memory::D_IN_DEV_M:
-                return dBufferInDM;
-            case ICPS::Memory::D_IN_DEV_F:
-                return dBufferInDF;
-            case ICPS::Memory::D_IN_W:
+            case ICPMean::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPMean::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPMean::Memory::D_IN_W:
                 return dBufferInW;
-            case ICPS::Memory::D_SIJ:
-                return dBufferSij;
-            case ICPS::Memory::D_OUT:
+            case ICPMean::Memory::D_IN_SUM_W:
+                return dBufferInSW;
+            case ICPMean::Memory::D_GM:
+                return dBufferGM;
+            case ICPMean::Memory::D_OUT:
                 return dBufferOut;
         }
     }
@@ -2329,46 +2874,63 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the sets.
-     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues.
+     *  \param[in] _n number of points in the input sets.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPS<ICPSConfig::WEIGHTED>::init (unsigned int _m, float _c, Staging _staging)
+    void ICPMean<ICPMeanConfig::WEIGHTED>::init (unsigned int _n, Staging _staging)
     {
-        m = _m; c = _c;
-        bufferInFMSize = m * sizeof (cl_float4);
-        bufferInWSize = m * sizeof (cl_float);
-        bufferOutSize = 11 * sizeof (cl_float);
+        n = nMax = _n;
+        bufferInFMSize  = n * sizeof (cl_float8);
+        bufferInWSize  = n * sizeof (cl_float);
+        bufferInSWSize  = sizeof (cl_double);
+        bufferOutSize = 2 * sizeof (cl_float4);
         staging = _staging;
 
-        unsigned int n = m;
-        if (n % 4) n += 4 - n % 4;
-        n /= 4;
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
 
-        bufferSijSize = 11 * (n * sizeof (cl_float));
+        bufferGMSize = 2 * (wgXdim * sizeof (cl_float4));
 
         try
         {
-            if (m == 0)
+            if (wgXdim == 0)
                 throw "The array cannot have zero points";
+
+            if (n % 2 != 0)
+                throw "The number of points in the array must be a multiple of 2";
+
+            // (2 * wgMultiple) points per work-group
+            // (2 * wgMultiple) work-groups maximum
+            if (n > std::pow (2 * wgMultiple, 2))
+            {
+                std::ostringstream ss;
+                ss << "The current configuration of ICPMean<ICPMeanConfig::WEIGHTED> supports arrays ";
+                ss << "of up to " << std::pow (2 * wgMultiple, 2) << " points";
+                throw ss.str ().c_str ();
+            }
+            if (!matchesSpecialization (env, info, _n))
+                throw "The program is specialized for a different number of points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPS<ICPSConfig::WEIGHTED>]: " << error << std::endl;
+            std::cerr << "Error[ICPMean<ICPMeanConfig::WEIGHTED>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
         // Set workspaces
-        global = cl::NDRange (n);
-
+        globalM = cl::NDRange (wgXdim * wgMultiple, 2);
+        globalGM = cl::NDRange (wgMultiple, 2);
+        local = cl::NDRange (wgMultiple, 1);
+        
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInDevM = nullptr;
-                hPtrInDevF = nullptr;
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
                 hPtrInW = nullptr;
+                hPtrInSW = nullptr;
                 hPtrOut = nullptr;
                 break;
 
@@ -2376,22 +2938,23 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferInDM () == nullptr)
-                    hBufferInDM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInFMSize);
-                if (hBufferInDF () == nullptr)
-                    hBufferInDF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInFMSize);
-                if (hBufferInW () == nullptr)
-                    hBufferInW = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInWSize);
+                allocStaging (hBufferInF, bufferInFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferInFMSize, context, pool, lease);
+                allocStaging (hBufferInW, bufferInWSize, context, pool, lease);
+                allocStaging (hBufferInSW, bufferInSWSize, context, pool, lease);
 
-                hPtrInDevM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInDM, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
-                hPtrInDevF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInDF, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
                 hPtrInW = (cl_float *) queue.enqueueMapBuffer (
                     hBufferInW, CL_FALSE, CL_MAP_WRITE, 0, bufferInWSize);
-                queue.enqueueUnmapMemObject (hBufferInDM, hPtrInDevM);
-                queue.enqueueUnmapMemObject (hBufferInDF, hPtrInDevF);
+                hPtrInSW = (cl_double *) queue.enqueueMapBuffer (
+                    hBufferInSW, CL_FALSE, CL_MAP_WRITE, 0, bufferInSWSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
                 queue.enqueueUnmapMemObject (hBufferInW, hPtrInW);
+                queue.enqueueUnmapMemObject (hBufferInSW, hPtrInSW);
 
                 if (!io)
                 {
@@ -2401,8 +2964,7 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
@@ -2411,36 +2973,110 @@ namespace ICP
 
                 if (!io)
                 {
-                    hPtrInDevM = nullptr;
-                    hPtrInDevF = nullptr;
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
                     hPtrInW = nullptr;
+                    hPtrInSW = nullptr;
                 }
                 break;
         }
-        
+
         // Create device buffers
-        if (dBufferInDM () == nullptr)
-            dBufferInDM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
-        if (dBufferInDF () == nullptr)
-            dBufferInDF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
         if (dBufferInW () == nullptr)
             dBufferInW = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInWSize);
-        if (dBufferSij () == nullptr)
-            dBufferSij = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSijSize);
+        if (dBufferInSW () == nullptr)
+            dBufferInSW = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSWSize);
+        if (dBufferGM () == nullptr && wgXdim != 1)
+            dBufferGM = cl::Buffer (context, CL_MEM_READ_WRITE, bufferGMSize);
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferInDM);
-        kernel.setArg (1, dBufferInDF);
-        kernel.setArg (2, dBufferInW);
-        kernel.setArg (3, dBufferSij);
-        kernel.setArg (4, m);
-        kernel.setArg (5, c);
+        if (wgXdim == 1)
+        {
+            meanKernel.setArg (0, dBufferInF);
+            meanKernel.setArg (1, dBufferInM);
+            meanKernel.setArg (2, dBufferOut);
+            meanKernel.setArg (3, dBufferInW);
+            meanKernel.setArg (4, dBufferInSW);
+            meanKernel.setArg (5, cl::Local (local[0] * 6 * sizeof (cl_float)));
+            meanKernel.setArg (6, n);
+        }
+        else
+        {
+            meanKernel.setArg (0, dBufferInF);
+            meanKernel.setArg (1, dBufferInM);
+            meanKernel.setArg (2, dBufferGM);
+            meanKernel.setArg (3, dBufferInW);
+            meanKernel.setArg (4, dBufferInSW);
+            meanKernel.setArg (5, cl::Local (local[0] * 6 * sizeof (cl_float)));
+            meanKernel.setArg (6, n);
 
-        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSij;
-        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferOut;
-        reduceSij.init (n, 11, Staging::NONE);
+            groupMeanKernel.setArg (0, dBufferGM);
+            groupMeanKernel.setArg (1, dBufferOut);
+            groupMeanKernel.setArg (2, cl::Local (local[0] * 6 * sizeof (cl_float)));
+            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+        }
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _n number of points in the input sets.
+     */
+    void ICPMean<ICPMeanConfig::WEIGHTED>::resize (unsigned int _n)
+    {
+        try
+        {
+            if (_n == 0)
+                throw "The array cannot have zero points";
+
+            if (_n % 2 != 0)
+                throw "The number of points in the array must be a multiple of 2";
+
+            if (_n > nMax)
+                throw "The number of points cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _n))
+                throw "The program is specialized for a different number of points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPMean<ICPMeanConfig::WEIGHTED>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        n = _n;
+        bufferInFMSize = n * sizeof (cl_float8);
+        bufferInWSize = n * sizeof (cl_float);
+
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (n / (float) (2 * wgMultiple));
+
+        bufferGMSize = 2 * (wgXdim * sizeof (cl_float4));
+
+        // Set workspaces
+        globalM = cl::NDRange (wgXdim * wgMultiple, 2);
+
+        // Set kernel arguments
+        if (wgXdim == 1)
+        {
+            meanKernel.setArg (2, dBufferOut);
+            meanKernel.setArg (6, n);
+        }
+        else
+        {
+            meanKernel.setArg (2, dBufferGM);
+            meanKernel.setArg (6, n);
+
+            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+        }
     }
 
 
@@ -2455,28 +3091,33 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPS<ICPSConfig::WEIGHTED>::write (ICPS::Memory mem, void *ptr, bool block, 
-                                            const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPMean<ICPMeanConfig::WEIGHTED>::write (ICPMean::Memory mem, void *ptr, bool block, 
+                                                  const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPS::Memory::D_IN_DEV_M:
+                case ICPMean::Memory::D_IN_F:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevM);
-                    queue.enqueueWriteBuffer (dBufferInDM, block, 0, bufferInFMSize, hPtrInDevM, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferInFMSize, hPtrInF, events, event);
                     break;
-                case ICPS::Memory::D_IN_DEV_F:
+                case ICPMean::Memory::D_IN_M:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevF);
-                    queue.enqueueWriteBuffer (dBufferInDF, block, 0, bufferInFMSize, hPtrInDevF, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInFMSize, hPtrInM, events, event);
                     break;
-                case ICPS::Memory::D_IN_W:
+                case ICPMean::Memory::D_IN_W:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInW);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n, hPtrInW);
                     queue.enqueueWriteBuffer (dBufferInW, block, 0, bufferInWSize, hPtrInW, events, event);
                     break;
+                case ICPMean::Memory::D_IN_SUM_W:
+                    if (ptr != nullptr)
+                        std::copy ((cl_double *) ptr, (cl_double *) ptr + 1, hPtrInSW);
+                    queue.enqueueWriteBuffer (dBufferInSW, block, 0, bufferInSWSize, hPtrInSW, events, event);
+                    break;
                 default:
                     break;
             }
@@ -2493,14 +3134,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPS<ICPSConfig::WEIGHTED>::read (ICPS::Memory mem, bool block, 
-                                            const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPMean<ICPMeanConfig::WEIGHTED>::read (ICPMean::Memory mem, bool block, 
+                                                  const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPS::Memory::H_OUT:
+                case ICPMean::Memory::H_OUT:
                     queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
                     return hPtrOut;
                 default:
@@ -2514,49 +3155,32 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the last kernel execution.
-     */
-    void ICPS<ICPSConfig::WEIGHTED>::run (const std::vector<cl::Event> *events, cl::Event *event)
-    {
-        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events);
-
-        reduceSij.run (nullptr, event);
-    }
-
-
-    /*! \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \return The scaling factor c.
-     */
-    float ICPS<ICPSConfig::WEIGHTED>::getScaling ()
-    {
-        return c;
-    }
-
-
-    /*! \details Updates the kernel argument for the scaling factor c.
-     *  \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \param[in] _c scaling factor.
+     *  \param[out] event event associated with the kernel execution.
      */
-    void ICPS<ICPSConfig::WEIGHTED>::setScaling (float _c)
+    void ICPMean<ICPMeanConfig::WEIGHTED>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        c = _c;
-        kernel.setArg (4, c);
+        if (wgXdim == 1)
+        {
+            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events, event);
+        }
+        else
+        {
+            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, local, events);
+            queue.enqueueNDRangeKernel (groupMeanKernel, cl::NullRange, globalGM, local, nullptr, event);
+        }
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPTransform<ICPTransformConfig::QUATERNION>::ICPTransform (
-        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPDevs::ICPDevs (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "icpTransform_Quaternion"), d (8)
+        kernel (env.getProgram (info.pgIdx), "icpSubtractMean"), d (8)
     {
     }
 
@@ -2566,22 +3190,30 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPTransform<ICPTransformConfig::QUATERNION>::get (ICPTransform::Memory mem)
+    cl::Memory& ICPDevs::get (ICPDevs::Memory mem)
     {
         switch (mem)
         {
-            case ICPTransform::Memory::H_IN_M:
+            case ICPDevs::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPDevs::Memory::H_IN_M:
                 return hBufferInM;
-            case ICPTransform::Memory::H_IN_T:
-                return hBufferInT;
-            case ICPTransform::Memory::H_OUT:
-                return hBufferOut;
-            case ICPTransform::Memory::D_IN_M:
+            case ICPDevs::Memory::H_IN_MEAN:
+                return hBufferInMean;
+            case ICPDevs::Memory::H_OUT_DEV_F:
+                return hBufferOutDF;
+            case ICPDevs::Memory::H_OUT_DEV_M:
+                return hBufferOutDM;
+            case ICPDevs::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPDevs::Memory::D_IN_M:
                 return dBufferInM;
-            case ICPTransform::Memory::D_IN_T:
-                return dBufferInT;
-            case ICPTransform::Memory::D_OUT:
-                return dBufferOut;
+            case ICPDevs::Memory::D_IN_MEAN:
+                return dBufferInMean;
+            case ICPDevs::Memory::D_OUT_DEV_F:
+                return dBufferOutDF;
+            case ICPDevs::Memory::D_OUT_DEV_M:
+                return dBufferOutDM;
         }
     }
 
@@ -2591,93 +3223,140 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the set.
+     *  \param[in] _n number of points.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPTransform<ICPTransformConfig::QUATERNION>::init (unsigned int _m, Staging _staging)
+    void ICPDevs::init (unsigned int _n, Staging _staging)
     {
-        m = _m;
-        bufferInMSize = m * sizeof (cl_float8);
-        bufferInTSize = 2 * sizeof (cl_float4);
-        bufferOutSize = m * sizeof (cl_float8);
+        n = nMax = _n;
+        bufferInFMSize = n * sizeof (cl_float8);
+        bufferInMeanSize = 2 * sizeof (cl_float4);
+        bufferOutSize = n * sizeof (cl_float4);
         staging = _staging;
 
         try
         {
-            if (m == 0)
-                throw "The set cannot have zero points";
+            if (n == 0)
+                throw "The array cannot have zero points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPTransform<ICPTransformConfig::QUATERNION>]: " << error << std::endl;
+            std::cerr << "Error[ICPDevs]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
         // Set workspaces
-        global = cl::NDRange (2, m);
-        
+        global = cl::NDRange (n, 2);
+
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
+                hPtrInF = nullptr;
                 hPtrInM = nullptr;
-                hPtrInT = nullptr;
-                hPtrOut = nullptr;
+                hPtrInMean = nullptr;
+                hPtrOutDevF = nullptr;
+                hPtrOutDevM = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInMSize);
-                if (hBufferInT () == nullptr)
-                    hBufferInT = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInTSize);
+                allocStaging (hBufferInF, bufferInFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferInFMSize, context, pool, lease);
+                allocStaging (hBufferInMean, bufferInMeanSize, context, pool, lease);
 
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
                 hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInMSize);
-                hPtrInT = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInT, CL_FALSE, CL_MAP_WRITE, 0, bufferInTSize);
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
+                hPtrInMean = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInMean, CL_FALSE, CL_MAP_WRITE, 0, bufferInMeanSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
                 queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
-                queue.enqueueUnmapMemObject (hBufferInT, hPtrInT);
+                queue.enqueueUnmapMemObject (hBufferInMean, hPtrInMean);
 
                 if (!io)
                 {
                     queue.finish ();
-                    hPtrOut = nullptr;
+                    hPtrOutDevF = nullptr;
+                    hPtrOutDevM = nullptr;
                     break;
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOutDF, bufferOutSize, context, pool, lease);
+                allocStaging (hBufferOutDM, bufferOutSize, context, pool, lease);
 
-                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
-                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                hPtrOutDevF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutDF, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                hPtrOutDevM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutDM, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOutDF, hPtrOutDevF);
+                queue.enqueueUnmapMemObject (hBufferOutDM, hPtrOutDevM);
                 queue.finish ();
 
                 if (!io)
                 {
+                    hPtrInF = nullptr;
                     hPtrInM = nullptr;
-                    hPtrInT = nullptr;
+                    hPtrInMean = nullptr;
                 }
                 break;
         }
-
+        
         // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
         if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMSize);
-        if (dBufferInT () == nullptr)
-            dBufferInT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInTSize);
-        if (dBufferOut () == nullptr)
-            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInMean () == nullptr)
+            dBufferInMean = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMeanSize);
+        if (dBufferOutDF () == nullptr)
+            dBufferOutDF = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
+        if (dBufferOutDM () == nullptr)
+            dBufferOutDM = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferInM);
-        kernel.setArg (1, dBufferOut);
-        kernel.setArg (2, dBufferInT);
+        kernel.setArg (0, dBufferInF);
+        kernel.setArg (1, dBufferInM);
+        kernel.setArg (2, dBufferOutDF);
+        kernel.setArg (3, dBufferOutDM);
+        kernel.setArg (4, dBufferInMean);
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _n number of points in the input sets.
+     */
+    void ICPDevs::resize (unsigned int _n)
+    {
+        try
+        {
+            if (_n == 0)
+                throw "The array cannot have zero points";
+
+            if (_n > nMax)
+                throw "The number of points cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPDevs]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        n = _n;
+        bufferInFMSize = n * sizeof (cl_float8);
+        bufferOutSize = n * sizeof (cl_float4);
+
+        // Set workspaces
+        global = cl::NDRange (n, 2);
     }
 
 
@@ -2692,22 +3371,27 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPTransform<ICPTransformConfig::QUATERNION>::write (
-        ICPTransform::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPDevs::write (ICPDevs::Memory mem, void *ptr, bool block, 
+                         const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPTransform::Memory::D_IN_M:
+                case ICPDevs::Memory::D_IN_F:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInMSize, hPtrInM, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferInFMSize, hPtrInF, events, event);
                     break;
-                case ICPTransform::Memory::D_IN_T:
+                case ICPDevs::Memory::D_IN_M:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 2 * 4, hPtrInT);
-                    queue.enqueueWriteBuffer (dBufferInT, block, 0, bufferInTSize, hPtrInT, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + n * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInFMSize, hPtrInM, events, event);
+                    break;
+                case ICPDevs::Memory::D_IN_MEAN:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 4, hPtrInMean);
+                    queue.enqueueWriteBuffer (dBufferInMean, block, 0, bufferInMeanSize, hPtrInMean, events, event);
                     break;
                 default:
                     break;
@@ -2725,16 +3409,19 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPTransform<ICPTransformConfig::QUATERNION>::read (
-        ICPTransform::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPDevs::read (ICPDevs::Memory mem, bool block, 
+                         const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPTransform::Memory::H_OUT:
-                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
-                    return hPtrOut;
+                case ICPDevs::Memory::H_OUT_DEV_F:
+                    queue.enqueueReadBuffer (dBufferOutDF, block, 0, bufferOutSize, hPtrOutDevF, events, event);
+                    return hPtrOutDevF;
+                case ICPDevs::Memory::H_OUT_DEV_M:
+                    queue.enqueueReadBuffer (dBufferOutDM, block, 0, bufferOutSize, hPtrOutDevM, events, event);
+                    return hPtrOutDevM;
                 default:
                     return nullptr;
             }
@@ -2746,9 +3433,9 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
+     *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPTransform<ICPTransformConfig::QUATERNION>::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPDevs::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
         queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
     }
@@ -2756,13 +3443,15 @@ namespace ICP
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPTransform<ICPTransformConfig::MATRIX>::ICPTransform (
-        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPS<ICPSConfig::REGULAR>::ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "icpTransform_Matrix"), d (8)
+        kernel (env.getProgram (info.pgIdx), "icpSijProducts"), 
+        reduceSij (env, info, pool), d (4)
     {
     }
 
@@ -2772,21 +3461,23 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPTransform<ICPTransformConfig::MATRIX>::get (ICPTransform::Memory mem)
+    cl::Memory& ICPS<ICPSConfig::REGULAR>::get (ICPS::Memory mem)
     {
         switch (mem)
         {
-            case ICPTransform::Memory::H_IN_M:
-                return hBufferInM;
-            case ICPTransform::Memory::H_IN_T:
-                return hBufferInT;
-            case ICPTransform::Memory::H_OUT:
+            case ICPS::Memory::H_IN_DEV_M:
+                return hBufferInDM;
+            case ICPS::Memory::H_IN_DEV_F:
+                return hBufferInDF;
+            case ICPS::Memory::H_OUT:
                 return hBufferOut;
-            case ICPTransform::Memory::D_IN_M:
-                return dBufferInM;
-            case ICPTransform::Memory::D_IN_T:
-                return dBufferInT;
-            case ICPTransform::Memory::D_OUT:
+            case ICPS::Memory::D_IN_DEV_M:
+                return dBufferInDM;
+            case ICPS::Memory::D_IN_DEV_F:
+                return dBufferInDF;
+            case ICPS::Memory::D_SIJ:
+                return dBufferSij;
+            case ICPS::Memory::D_OUT:
                 return dBufferOut;
         }
     }
@@ -2797,38 +3488,46 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the set.
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPTransform<ICPTransformConfig::MATRIX>::init (unsigned int _m, Staging _staging)
+    void ICPS<ICPSConfig::REGULAR>::init (unsigned int _m, float _c, Staging _staging)
     {
-        m = _m;
-        bufferInMSize = m * sizeof (cl_float8);
-        bufferInTSize = 4 * sizeof (cl_float4);
-        bufferOutSize = m * sizeof (cl_float8);
+        m = mMax = _m; c = _c;
+        bufferInSize = m * sizeof (cl_float4);
+        bufferOutSize = 11 * sizeof (cl_float);
         staging = _staging;
 
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
+
+        bufferSijSize = 11 * (n * sizeof (cl_float));
+
         try
         {
             if (m == 0)
-                throw "The set cannot have zero points";
+                throw "The array cannot have zero points";
+            if (!matchesSpecialization (env, info, _m, _c))
+                throw "The program is specialized for a different number of points or scaling factor";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPTransform<ICPTransformConfig::MATRIX>]: " << error << std::endl;
+            std::cerr << "Error[ICPS<ICPSConfig::REGULAR>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
 
         // Set workspaces
-        global = cl::NDRange (2, m);
-        
+        global = cl::NDRange (n);
+
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInM = nullptr;
-                hPtrInT = nullptr;
+                hPtrInDevM = nullptr;
+                hPtrInDevF = nullptr;
                 hPtrOut = nullptr;
                 break;
 
@@ -2836,17 +3535,15 @@ namespace ICP
                 io = true;
 
             case Staging::I:
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInMSize);
-                if (hBufferInT () == nullptr)
-                    hBufferInT = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInTSize);
+                allocStaging (hBufferInDM, bufferInSize, context, pool, lease);
+                allocStaging (hBufferInDF, bufferInSize, context, pool, lease);
 
-                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInMSize);
-                hPtrInT = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInT, CL_FALSE, CL_MAP_WRITE, 0, bufferInTSize);
-                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
-                queue.enqueueUnmapMemObject (hBufferInT, hPtrInT);
+                hPtrInDevM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInDM, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                hPtrInDevF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInDF, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                queue.enqueueUnmapMemObject (hBufferInDM, hPtrInDevM);
+                queue.enqueueUnmapMemObject (hBufferInDF, hPtrInDevF);
 
                 if (!io)
                 {
@@ -2856,8 +3553,7 @@ namespace ICP
                 }
 
             case Staging::O:
-                if (hBufferOut () == nullptr)
-                    hBufferOut = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
                 hPtrOut = (cl_float *) queue.enqueueMapBuffer (
                     hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
@@ -2866,24 +3562,76 @@ namespace ICP
 
                 if (!io)
                 {
-                    hPtrInM = nullptr;
-                    hPtrInT = nullptr;
+                    hPtrInDevM = nullptr;
+                    hPtrInDevF = nullptr;
                 }
                 break;
         }
-
+        
         // Create device buffers
-        if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMSize);
-        if (dBufferInT () == nullptr)
-            dBufferInT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInTSize);
+        if (dBufferInDM () == nullptr)
+            dBufferInDM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferInDF () == nullptr)
+            dBufferInDF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferSij () == nullptr)
+            dBufferSij = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSijSize);
         if (dBufferOut () == nullptr)
             dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferInM);
-        kernel.setArg (1, dBufferOut);
-        kernel.setArg (2, dBufferInT);
+        kernel.setArg (0, dBufferInDM);
+        kernel.setArg (1, dBufferInDF);
+        kernel.setArg (2, dBufferSij);
+        kernel.setArg (3, m);
+        kernel.setArg (4, c);
+
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSij;
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferOut;
+        reduceSij.init (n, 11, Staging::NONE);
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the sets.
+     */
+    void ICPS<ICPSConfig::REGULAR>::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The array cannot have zero points";
+
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _m, c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPS<ICPSConfig::REGULAR>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m;
+        bufferInSize = m * sizeof (cl_float4);
+
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
+
+        bufferSijSize = 11 * (n * sizeof (cl_float));
+
+        // Set workspaces
+        global = cl::NDRange (n);
+
+        // Set kernel arguments
+        kernel.setArg (3, m);
+
+        reduceSij.resize (n);
     }
 
 
@@ -2898,22 +3646,22 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPTransform<ICPTransformConfig::MATRIX>::write (
-        ICPTransform::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPS<ICPSConfig::REGULAR>::write (ICPS::Memory mem, void *ptr, bool block, 
+                                           const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPTransform::Memory::D_IN_M:
+                case ICPS::Memory::D_IN_DEV_M:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInMSize, hPtrInM, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevM);
+                    queue.enqueueWriteBuffer (dBufferInDM, block, 0, bufferInSize, hPtrInDevM, events, event);
                     break;
-                case ICPTransform::Memory::D_IN_T:
+                case ICPS::Memory::D_IN_DEV_F:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 16, hPtrInT);
-                    queue.enqueueWriteBuffer (dBufferInT, block, 0, bufferInTSize, hPtrInT, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevF);
+                    queue.enqueueWriteBuffer (dBufferInDF, block, 0, bufferInSize, hPtrInDevF, events, event);
                     break;
                 default:
                     break;
@@ -2931,14 +3679,14 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPTransform<ICPTransformConfig::MATRIX>::read (
-        ICPTransform::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPS<ICPSConfig::REGULAR>::read (ICPS::Memory mem, bool block, 
+                                           const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPTransform::Memory::H_OUT:
+                case ICPS::Memory::H_OUT:
                     queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
                     return hPtrOut;
                 default:
@@ -2952,23 +3700,59 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
+     *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPTransform<ICPTransformConfig::MATRIX>::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPS<ICPSConfig::REGULAR>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events);
+
+        reduceSij.run (nullptr, event);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPS<ICPSConfig::REGULAR>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPS<ICPSConfig::REGULAR>::setScaling (float _c)
+    {
+        c = _c;
+        kernel.setArg (4, c);
     }
 
 
     /*! \param[in] _env opencl environment.
      *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPPowerMethod::ICPPowerMethod (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info) : 
-        env (_env), info (_info), 
+    ICPS<ICPSConfig::WEIGHTED>::ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
         context (env.getContext (info.pIdx)), 
         queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
-        kernel (env.getProgram (info.pgIdx), "icpPowerMethod")
+        kernel (env.getProgram (info.pgIdx), "icpSijProducts_Weighted"), 
+        local (cl::NullRange), reduceSij (env, info, pool), d (4), ept (4), wgSize (0)
     {
+        WorkGroupConfig config;
+        if (getTunedConfig (kernel, env.devices[info.pIdx][info.dIdx], config) && config.ept != 0)
+        {
+            ept = config.ept;
+            wgSize = config.local;
+            if (wgSize != 0) local = cl::NDRange (wgSize);
+        }
     }
 
 
@@ -2977,22 +3761,28 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPPowerMethod::get (ICPPowerMethod::Memory mem)
+    cl::Memory& ICPS<ICPSConfig::WEIGHTED>::get (ICPS::Memory mem)
     {
         switch (mem)
         {
-            case ICPPowerMethod::Memory::H_IN_S:
-                return hBufferInS;
-            case ICPPowerMethod::Memory::H_IN_MEAN:
-                return hBufferInMean;
-            case ICPPowerMethod::Memory::H_OUT_T_K:
-                return hBufferOutTk;
-            case ICPPowerMethod::Memory::D_IN_S:
-                return dBufferInS;
-            case ICPPowerMethod::Memory::D_IN_MEAN:
-                return dBufferInMean;
-            case ICPPowerMethod::Memory::D_OUT_T_K:
-                return dBufferOutTk;
+            case ICPS::Memory::H_IN_DEV_M:
+                return hBufferInDM;
+            case ICPS::Memory::H_IN_DEV_F:
+                return hBufferInDF;
+            case ICPS::Memory::H_IN_W:
+                return hBufferInW;
+            case ICPS::Memory::H_OUT:
+                return hBufferOut;
+            case ICPS::Memory::D_IN_DEV_M:
+                return dBufferInDM;
+            case ICPS::Memory::D_IN_DEV_F:
+                return dBufferInDF;
+            case ICPS::Memory::D_IN_W:
+                return dBufferInW;
+            case ICPS::Memory::D_SIJ:
+                return dBufferSij;
+            case ICPS::Memory::D_OUT:
+                return dBufferOut;
         }
     }
 
@@ -3001,111 +3791,204 @@ namespace ICP
      *  \note If you have assigned a memory object to one member variable of the class 
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
+     *  \note Each work-item processes 4 pairs of points, unless `tuneWorkGroups` has 
+     *        stored a launch configuration for `icpSijProducts_Weighted` on the device.
      *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPPowerMethod::init (Staging _staging)
+    void ICPS<ICPSConfig::WEIGHTED>::init (unsigned int _m, float _c, Staging _staging)
     {
-        bufferInSSize = 11 * sizeof (cl_float);
-        bufferInMeanSize = 2 * sizeof (cl_float4);
-        bufferOutTkSize = 2 * sizeof (cl_float4);
+        m = mMax = _m; c = _c;
+        bufferInFMSize = m * sizeof (cl_float4);
+        bufferInWSize = m * sizeof (cl_float);
+        bufferOutSize = 11 * sizeof (cl_float);
         staging = _staging;
-        
+
+        // ept points per work-item, in whole work-groups of at least 4 (data are handled as float4 in reduce_sum)
+        unsigned int q = std::max (wgSize, 4u);
+        unsigned int n = (m + ept - 1) / ept;
+        if (n % q) n += q - n % q;
+
+        bufferSijSize = 11 * (n * sizeof (cl_float));
+
+        try
+        {
+            if (m == 0)
+                throw "The array cannot have zero points";
+            if (!matchesSpecialization (env, info, _m, _c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPS<ICPSConfig::WEIGHTED>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        // Set workspaces
+        global = cl::NDRange (n);
+
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInS = nullptr;
-                hPtrInMean = nullptr;
-                hPtrOutTk = nullptr;
+                hPtrInDevM = nullptr;
+                hPtrInDevF = nullptr;
+                hPtrInW = nullptr;
+                hPtrOut = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferInS () == nullptr)
-                    hBufferInS = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInSSize);
-                if (hBufferInMean () == nullptr)
-                    hBufferInMean = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferInMeanSize);
+                allocStaging (hBufferInDM, bufferInFMSize, context, pool, lease);
+                allocStaging (hBufferInDF, bufferInFMSize, context, pool, lease);
+                allocStaging (hBufferInW, bufferInWSize, context, pool, lease);
 
-                hPtrInS = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInS, CL_FALSE, CL_MAP_WRITE, 0, bufferInSSize);
-                hPtrInMean = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInMean, CL_FALSE, CL_MAP_WRITE, 0, bufferInMeanSize);
-                queue.enqueueUnmapMemObject (hBufferInS, hPtrInS);
-                queue.enqueueUnmapMemObject (hBufferInMean, hPtrInMean);
+                hPtrInDevM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInDM, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
+                hPtrInDevF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInDF, CL_FALSE, CL_MAP_WRITE, 0, bufferInFMSize);
+                hPtrInW = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInW, CL_FALSE, CL_MAP_WRITE, 0, bufferInWSize);
+                queue.enqueueUnmapMemObject (hBufferInDM, hPtrInDevM);
+                queue.enqueueUnmapMemObject (hBufferInDF, hPtrInDevF);
+                queue.enqueueUnmapMemObject (hBufferInW, hPtrInW);
 
                 if (!io)
                 {
                     queue.finish ();
-                    hPtrOutTk = nullptr;
+                    hPtrOut = nullptr;
                     break;
                 }
 
             case Staging::O:
-                if (hBufferOutTk () == nullptr)
-                    hBufferOutTk = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferOutTkSize);
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
 
-                hPtrOutTk = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferOutTk, CL_FALSE, CL_MAP_READ, 0, bufferOutTkSize);
-                queue.enqueueUnmapMemObject (hBufferOutTk, hPtrOutTk);
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
                 queue.finish ();
 
                 if (!io)
                 {
-                    hPtrInS = nullptr;
-                    hPtrInMean = nullptr;
+                    hPtrInDevM = nullptr;
+                    hPtrInDevF = nullptr;
+                    hPtrInW = nullptr;
                 }
                 break;
         }
-
+        
         // Create device buffers
-        if (dBufferInS () == nullptr)
-            dBufferInS = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSSize);
-        if (dBufferInMean () == nullptr)
-            dBufferInMean = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInMeanSize);
-        if (dBufferOutTk () == nullptr)
-            dBufferOutTk = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutTkSize);
+        if (dBufferInDM () == nullptr)
+            dBufferInDM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInDF () == nullptr)
+            dBufferInDF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInW () == nullptr)
+            dBufferInW = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInWSize);
+        if (dBufferSij () == nullptr)
+            dBufferSij = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSijSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
         // Set kernel arguments
-        kernel.setArg (0, dBufferInS);
-        kernel.setArg (1, dBufferInMean);
-        kernel.setArg (2, dBufferOutTk);
+        kernel.setArg (0, dBufferInDM);
+        kernel.setArg (1, dBufferInDF);
+        kernel.setArg (2, dBufferInW);
+        kernel.setArg (3, dBufferSij);
+        kernel.setArg (4, m);
+        kernel.setArg (5, c);
+
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSij;
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferOut;
+        reduceSij.init (n, 11, Staging::NONE);
     }
 
 
-    /*! \details The transfer happens from a staging buffer on the host to the 
-     *           associated (specified) device buffer.
-     *  
-     *  \param[in] mem enumeration value specifying an input device buffer.
-     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
-     *                 data from `ptr` will be copied to the associated staging buffer.
-     *  \param[in] block a flag to indicate whether to perform a blocking 
-     *                   or a non-blocking operation.
-     *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the write operation to the device buffer.
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the sets.
      */
-    void ICPPowerMethod::write (ICPPowerMethod::Memory mem, 
-        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPS<ICPSConfig::WEIGHTED>::resize (unsigned int _m)
     {
-        if (staging == Staging::I || staging == Staging::IO)
+        try
         {
-            switch (mem)
-            {
-                case ICPPowerMethod::Memory::D_IN_S:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 11, hPtrInS);
-                    queue.enqueueWriteBuffer (dBufferInS, block, 0, bufferInSSize, hPtrInS, events, event);
-                    break;
-                case ICPPowerMethod::Memory::D_IN_MEAN:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrInMean);
-                    queue.enqueueWriteBuffer (dBufferInMean, block, 0, bufferInMeanSize, hPtrInMean, events, event);
-                    break;
-                default:
-                    break;
+            if (_m == 0)
+                throw "The array cannot have zero points";
+
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _m, c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPS<ICPSConfig::WEIGHTED>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m;
+        bufferInFMSize = m * sizeof (cl_float4);
+        bufferInWSize = m * sizeof (cl_float);
+
+        // ept points per work-item, in whole work-groups of at least 4 (data are handled as float4 in reduce_sum)
+        unsigned int q = std::max (wgSize, 4u);
+        unsigned int n = (m + ept - 1) / ept;
+        if (n % q) n += q - n % q;
+
+        bufferSijSize = 11 * (n * sizeof (cl_float));
+
+        // Set workspaces
+        global = cl::NDRange (n);
+
+        // Set kernel arguments
+        kernel.setArg (4, m);
+
+        reduceSij.resize (n);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPS<ICPSConfig::WEIGHTED>::write (ICPS::Memory mem, void *ptr, bool block, 
+                                            const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPS::Memory::D_IN_DEV_M:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevM);
+                    queue.enqueueWriteBuffer (dBufferInDM, block, 0, bufferInFMSize, hPtrInDevM, events, event);
+                    break;
+                case ICPS::Memory::D_IN_DEV_F:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInDevF);
+                    queue.enqueueWriteBuffer (dBufferInDF, block, 0, bufferInFMSize, hPtrInDevF, events, event);
+                    break;
+                case ICPS::Memory::D_IN_W:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInW);
+                    queue.enqueueWriteBuffer (dBufferInW, block, 0, bufferInWSize, hPtrInW, events, event);
+                    break;
+                default:
+                    break;
             }
         }
     }
@@ -3120,16 +4003,16 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPPowerMethod::read (ICPPowerMethod::Memory mem, 
-        bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPS<ICPSConfig::WEIGHTED>::read (ICPS::Memory mem, bool block, 
+                                            const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPPowerMethod::Memory::H_OUT_T_K:
-                    queue.enqueueReadBuffer (dBufferOutTk, block, 0, bufferOutTkSize, hPtrOutTk, events, event);
-                    return hPtrOutTk;
+                case ICPS::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
                 default:
                     return nullptr;
             }
@@ -3141,29 +4024,52 @@ namespace ICP
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
+     *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPPowerMethod::run (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPS<ICPSConfig::WEIGHTED>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        queue.enqueueTask (kernel, events, event);
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, local, events);
+
+        reduceSij.run (nullptr, event);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPS<ICPSConfig::WEIGHTED>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPS<ICPSConfig::WEIGHTED>::setScaling (float _c)
+    {
+        c = _c;
+        kernel.setArg (4, c);
     }
 
 
     /*! \param[in] _env opencl environment.
-     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
-     *                      It specifies the context, queue, etc, to be used.
-     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
-     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::ICPStep (clutils::CLEnv &_env, 
-        clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP) : 
-        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), 
-        context (env.getContext (infoICP.pIdx)), 
-        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
-        fReps (env, infoICP), rbcC (env, infoRBC), 
-        transform (env, infoICP), rbcS (env, infoRBC), 
-        means (env, infoICP), devs (env, infoICP), 
-        matrixS (env, infoICP), d (8)
+    ICPS<ICPSConfig::FUSED>::ICPS (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpSijProducts_Fused"), 
+        finalKernel (env.getProgram (info.pgIdx), "icpSijFinalize_Fused"), 
+        reduceSij (env, info, pool)
     {
     }
 
@@ -3173,22 +4079,30 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::get (ICPStep::Memory mem)
+    cl::Memory& ICPS<ICPSConfig::FUSED>::get (ICPS::Memory mem)
     {
         switch (mem)
         {
-            case ICPStep::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPStep::Memory::H_IN_M:
-                return hBufferInM;
-            case ICPStep::Memory::H_IO_T:
-                return hBufferIOT;
-            case ICPStep::Memory::D_IN_F:
+            case ICPS::Memory::H_OUT:
+                return hBufferOut;
+            case ICPS::Memory::H_OUT_MEAN:
+                return hBufferMean;
+            case ICPS::Memory::D_IN_F:
                 return dBufferInF;
-            case ICPStep::Memory::D_IN_M:
+            case ICPS::Memory::D_IN_M:
                 return dBufferInM;
-            case ICPStep::Memory::D_IO_T:
-                return dBufferIOT;
+            case ICPS::Memory::D_IN_W:
+                return dBufferInW;
+            case ICPS::Memory::D_IN_SUM_W:
+                return dBufferInSumW;
+            case ICPS::Memory::D_SIJ:
+                return dBufferSij;
+            case ICPS::Memory::D_SUMS:
+                return dBufferSums;
+            case ICPS::Memory::D_OUT:
+                return dBufferOut;
+            case ICPS::Memory::D_OUT_MEAN:
+                return dBufferMean;
         }
     }
 
@@ -3197,218 +4111,154 @@ namespace ICP
      *  \note If you have assigned a memory object to one member variable of the class 
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
+     *  \note The input buffers are expected to be produced on the device, 
+     *        so there are no input staging buffers.
      *        
      *  \param[in] _m number of points in the sets.
-     *  \param[in] _nr number of fixed set representatives.
-     *  \param[in] _a factor scaling the results of the distance calculations for the 
-     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
-     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
-     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
-     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
-     *                (https://random-ball-cover.nlamprian.me).
-     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
-     *                issues when computing the `S` matrix.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::init (
-        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    void ICPS<ICPSConfig::FUSED>::init (unsigned int _m, float _c, Staging _staging)
     {
-        m = _m; nr = _nr; a = _a; c = _c;
-        bufferFMSize = m * sizeof (cl_float8);
-        bufferTSize = 2 * sizeof (cl_float4);
+        m = mMax = _m; c = _c;
+        bufferInFMSize = m * sizeof (cl_float8);
+        bufferInWSize = m * sizeof (cl_float);
+        bufferSumsSize = 17 * sizeof (cl_float);
+        bufferOutSize = 11 * sizeof (cl_float);
+        bufferMeanSize = 2 * sizeof (cl_float4);
         staging = _staging;
 
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
+
+        bufferSijSize = 17 * (n * sizeof (cl_float));
+
         try
         {
             if (m == 0)
-                throw "The sets of landmarks cannot have zero points";
-
-            if (nr == 0)
-                throw "The sets of representatives cannot have zero points";
-
-            if (a == 0.f)
-                throw "The alpha parameter cannot be equal to zero";
+                throw "The array cannot have zero points";
+            if (!matchesSpecialization (env, info, _m, _c))
+                throw "The program is specialized for a different number of points or scaling factor";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>]: " 
-                      << error << std::endl;
+            std::cerr << "Error[ICPS<ICPSConfig::FUSED>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
-        
+
+        // Set workspaces
+        global = cl::NDRange (n);
+
         // Create staging buffers
-        bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
-                hPtrInM = nullptr;
+            case Staging::I:
+                hPtrOut = nullptr;
+                hPtrOutMean = nullptr;
                 break;
 
             case Staging::IO:
-                io = true;
-
-            case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
-
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
-                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
-                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
-
-                if (!io)
-                {
-                    queue.finish ();
-                    break;
-                }
-
             case Staging::O:
-                if (!io)
-                {
-                    hPtrInF = nullptr;
-                    hPtrInM = nullptr;
-                }
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
+                allocStaging (hBufferMean, bufferMeanSize, context, pool, lease);
+
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                hPtrOutMean = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferMean, CL_FALSE, CL_MAP_READ, 0, bufferMeanSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                queue.enqueueUnmapMemObject (hBufferMean, hPtrOutMean);
+                queue.finish ();
                 break;
         }
-
-        if (hBufferIOT () == nullptr)
-            hBufferIOT = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferTSize);
-
-        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
-            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
-        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
-        queue.finish ();
-
+        
         // Create device buffers
         if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
         if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
-        if (dBufferIOT () == nullptr)
-            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
-
-        // Load initial identity transformation
-        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
-        std::copy (T0, T0 + 8, hPtrIOT);
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
-
-        R = Eigen::Matrix3f::Identity ();
-        q = Eigen::Quaternionf (R);
-        t.setZero ();
-        s = 1.f;
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInW () == nullptr)
+            dBufferInW = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInWSize);
+        if (dBufferInSumW () == nullptr)
+            dBufferInSumW = cl::Buffer (context, CL_MEM_READ_ONLY, sizeof (cl_double));
+        if (dBufferSij () == nullptr)
+            dBufferSij = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSijSize);
+        if (dBufferSums () == nullptr)
+            dBufferSums = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSumsSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
+        if (dBufferMean () == nullptr)
+            dBufferMean = cl::Buffer (context, CL_MEM_READ_WRITE, bufferMeanSize);
 
-        // Configure classes
+        // Zero the reference points
+        cl_float4 k0[2] = { { { 0.f, 0.f, 0.f, 0.f } }, { { 0.f, 0.f, 0.f, 0.f } } };
+        queue.enqueueWriteBuffer (dBufferMean, CL_TRUE, 0, bufferMeanSize, k0);
 
-        // Classes in the initialization step ==================================
-        
-        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
-        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
-        fReps.init (nr, Staging::NONE);
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInF);
+        kernel.setArg (1, dBufferInM);
+        kernel.setArg (2, dBufferInW);
+        kernel.setArg (3, dBufferMean);
+        kernel.setArg (4, dBufferSij);
+        kernel.setArg (5, m);
+        kernel.setArg (6, c);
 
-        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+        finalKernel.setArg (0, dBufferSums);
+        finalKernel.setArg (1, dBufferInSumW);
+        finalKernel.setArg (2, dBufferMean);
+        finalKernel.setArg (3, dBufferOut);
+        finalKernel.setArg (4, c);
 
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
-        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSij;
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferSums;
+        reduceSij.init (n, 17, Staging::NONE);
+    }
 
-        // Classes in the iteration step =======================================
 
-        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the sets.
+     */
+    void ICPS<ICPSConfig::FUSED>::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The array cannot have zero points";
 
-        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
-        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
-        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        transform.init (m, Staging::NONE);
-
-        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
-        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
-
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
-            transform.get (ICPTransform<TC>::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
-            fReps.get (ICPReps::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
-
-        const ICPMeanConfig MC = ICPMeanConfig::REGULAR;
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _m, c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPS<ICPSConfig::FUSED>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
 
-        means.get (ICPMean<MC>::Memory::D_IN_F) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        means.get (ICPMean<MC>::Memory::D_IN_M) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        means.get (ICPMean<MC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
-        means.init (m, Staging::O);
+        m = _m;
+        bufferInFMSize = m * sizeof (cl_float8);
+        bufferInWSize = m * sizeof (cl_float);
 
-        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
-        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.init (m, Staging::NONE);
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
 
-        const ICPSConfig SC = ICPSConfig::REGULAR;
+        bufferSijSize = 17 * (n * sizeof (cl_float));
 
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
-        matrixS.init (m, c, Staging::O);
-    }
+        // Set workspaces
+        global = cl::NDRange (n);
 
+        // Set kernel arguments
+        kernel.setArg (5, m);
 
-    /*! \details The transfer happens from a staging buffer on the host to the 
-     *           associated (specified) device buffer.
-     *  
-     *  \param[in] mem enumeration value specifying an input device buffer.
-     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
-     *                 data from `ptr` will be copied to the associated staging buffer.
-     *  \param[in] block a flag to indicate whether to perform a blocking 
-     *                   or a non-blocking operation.
-     *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the write operation to the device buffer.
-     */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::write (
-        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
-    {
-        if (staging == Staging::I || staging == Staging::IO)
-        {
-            switch (mem)
-            {
-                case ICPStep::Memory::D_IN_F:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
-                    break;
-                case ICPStep::Memory::D_IN_M:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
-                    break;
-                case ICPStep::Memory::D_IO_T:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
-                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
-                    break;
-                default:
-                    break;
-            }
-        }
+        reduceSij.resize (n);
     }
 
 
@@ -3421,16 +4271,19 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::read (
-        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPS<ICPSConfig::FUSED>::read (ICPS::Memory mem, bool block, 
+                                         const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPStep::Memory::H_IO_T:
-                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
-                    return hPtrIOT;
+                case ICPS::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
+                case ICPS::Memory::H_OUT_MEAN:
+                    queue.enqueueReadBuffer (dBufferMean, block, 0, bufferMeanSize, hPtrOutMean, events, event);
+                    return hPtrOutMean;
                 default:
                     return nullptr;
             }
@@ -3439,125 +4292,57 @@ namespace ICP
     }
 
 
-    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
-     *        and before any calls to `run` (for each registration).
-     */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::buildRBC (
-        const std::vector<cl::Event> *events, cl::Event *event)
-    {
-        fReps.run (events);
-        rbcC.run (nullptr, event);
-    }
-
-
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
-     *  \param[in] config flag. If true, configures the `RBC search` process. 
-     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[out] event event associated with the last kernel execution.
      */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::run (
-        const std::vector<cl::Event> *events, cl::Event *event, bool config)
-    {
-        transform.run ();
-        rbcS.run (nullptr, nullptr, config);
-        means.run ();
-        devs.run ();
-        matrixS.run ();
-
-        mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::REGULAR>::Memory::H_OUT, CL_FALSE);
-        Sij = (cl_float *) matrixS.read (ICPS<ICPSConfig::REGULAR>::Memory::H_OUT);
-        sk = std::sqrt (Sij[9] / Sij[10]);
-
-        mf = Eigen::Map<Eigen::Vector3f> (mean);
-        mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
-        S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
-        
-        Eigen::JacobiSVD<Eigen::MatrixXf, Eigen::NoQRPreconditioner> 
-            svd (S, Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-        Rk = svd.matrixV () * svd.matrixU ().transpose ();
-        if (Rk.determinant () < 0)
-        {
-            Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
-            B (2, 2) = Rk.determinant ();
-            Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
-        }
-        qk = Eigen::Quaternionf (Rk);
-
-        tk = mf - sk * Rk * mm;
-
-        R = Rk * R;
-        q = Eigen::Quaternionf (R);
-        t = sk * Rk * t + tk;
-        s = sk * s;
-        
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
-        hPtrIOT[7] = s;  // Scale
-
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, event);
-    }
-
-
-    /*! \return The scaling parameter \f$ \alpha \f$. */
-    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::getAlpha ()
+    void ICPS<ICPSConfig::FUSED>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        return a;
-    }
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events);
 
+        reduceSij.run ();
 
-    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
-     *
-     *  \param[in] _a scaling parameter \f$ \alpha \f$.
-     */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::setAlpha (float _a)
-    {
-        a = _a;
-        rbcC.setAlpha (a);
-        rbcS.setAlpha (a);
+        queue.enqueueNDRangeKernel (finalKernel, cl::NullRange, cl::NDRange (1), cl::NullRange, nullptr, event);
     }
 
 
-    /*! \note The scaling factor c multiplies the points (deviations) before processing
+    /*! \note The scaling factor c multiplies the points (shifted) before processing
      *        in order to deal with floating point arithmetic issues.
      *  
      *  \return The scaling factor c.
      */
-    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::getScaling ()
+    float ICPS<ICPSConfig::FUSED>::getScaling ()
     {
         return c;
     }
 
 
-    /*! \details Updates the kernel argument for the scaling factor c.
-     *  \note The scaling factor c multiplies the points (deviations) before processing
+    /*! \details Updates the kernel arguments for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (shifted) before processing
      *        in order to deal with floating point arithmetic issues.
      *  
      *  \param[in] _c scaling factor.
      */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::setScaling (float _c)
+    void ICPS<ICPSConfig::FUSED>::setScaling (float _c)
     {
         c = _c;
-        matrixS.setScaling (c);
+        kernel.setArg (6, c);
+        finalKernel.setArg (4, c);
     }
 
 
     /*! \param[in] _env opencl environment.
-     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
-     *                      It specifies the context, queue, etc, to be used.
-     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
-     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::ICPStep (clutils::CLEnv &_env, 
-        clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP) : 
-        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), 
-        context (env.getContext (infoICP.pIdx)), 
-        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
-        fReps (env, infoICP), rbcC (env, infoRBC), 
-        transform (env, infoICP), rbcS (env, infoRBC), weights (env, infoICP), 
-        means (env, infoICP), devs (env, infoICP), matrixS (env, infoICP), d (8)
+    ICPTransform<ICPTransformConfig::QUATERNION>::ICPTransform (
+        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpTransform_Quaternion"), d (8)
     {
     }
 
@@ -3567,22 +4352,22 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::get (ICPStep::Memory mem)
+    cl::Memory& ICPTransform<ICPTransformConfig::QUATERNION>::get (ICPTransform::Memory mem)
     {
         switch (mem)
         {
-            case ICPStep::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPStep::Memory::H_IN_M:
+            case ICPTransform::Memory::H_IN_M:
                 return hBufferInM;
-            case ICPStep::Memory::H_IO_T:
-                return hBufferIOT;
-            case ICPStep::Memory::D_IN_F:
-                return dBufferInF;
-            case ICPStep::Memory::D_IN_M:
+            case ICPTransform::Memory::H_IN_T:
+                return hBufferInT;
+            case ICPTransform::Memory::H_OUT:
+                return hBufferOut;
+            case ICPTransform::Memory::D_IN_M:
                 return dBufferInM;
-            case ICPStep::Memory::D_IO_T:
-                return dBufferIOT;
+            case ICPTransform::Memory::D_IN_T:
+                return dBufferInT;
+            case ICPTransform::Memory::D_OUT:
+                return dBufferOut;
         }
     }
 
@@ -3592,190 +4377,122 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the sets.
-     *  \param[in] _nr number of fixed set representatives.
-     *  \param[in] _a factor scaling the results of the distance calculations for the 
-     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
-     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
-     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
-     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
-     *                (https://random-ball-cover.nlamprian.me).
-     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
-     *                issues when computing the `S` matrix.
+     *  \param[in] _m number of points in the set.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::init (
-        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    void ICPTransform<ICPTransformConfig::QUATERNION>::init (unsigned int _m, Staging _staging)
     {
-        m = _m; nr = _nr; a = _a; c = _c;
-        bufferFMSize = m * sizeof (cl_float8);
-        bufferTSize = 2 * sizeof (cl_float4);
+        m = mMax = _m;
+        bufferInMSize = m * sizeof (cl_float8);
+        bufferInTSize = 2 * sizeof (cl_float4);
+        bufferOutSize = m * sizeof (cl_float8);
         staging = _staging;
 
         try
         {
             if (m == 0)
-                throw "The sets of landmarks cannot have zero points";
-
-            if (nr == 0)
-                throw "The sets of representatives cannot have zero points";
-
-            if (a == 0.f)
-                throw "The alpha parameter cannot be equal to zero";
+                throw "The set cannot have zero points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>]: " 
-                      << error << std::endl;
+            std::cerr << "Error[ICPTransform<ICPTransformConfig::QUATERNION>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
+
+        // Set workspaces
+        global = cl::NDRange (2, m);
         
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
                 hPtrInM = nullptr;
+                hPtrInT = nullptr;
+                hPtrOut = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
+                allocStaging (hBufferInM, bufferInMSize, context, pool, lease);
+                allocStaging (hBufferInT, bufferInTSize, context, pool, lease);
 
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
                 hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInMSize);
+                hPtrInT = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInT, CL_FALSE, CL_MAP_WRITE, 0, bufferInTSize);
                 queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+                queue.enqueueUnmapMemObject (hBufferInT, hPtrInT);
 
                 if (!io)
                 {
                     queue.finish ();
+                    hPtrOut = nullptr;
                     break;
                 }
 
             case Staging::O:
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
+
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                queue.finish ();
+
                 if (!io)
                 {
-                    hPtrInF = nullptr;
                     hPtrInM = nullptr;
+                    hPtrInT = nullptr;
                 }
                 break;
         }
 
-        if (hBufferIOT () == nullptr)
-            hBufferIOT = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferTSize);
-
-        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
-            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
-        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
-        queue.finish ();
-
         // Create device buffers
-        if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
         if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
-        if (dBufferIOT () == nullptr)
-            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
-
-        // Load initial identity transformation
-        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
-        std::copy (T0, T0 + 8, hPtrIOT);
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
-
-        R = Eigen::Matrix3f::Identity ();
-        q = Eigen::Quaternionf (R);
-        t.setZero ();
-        s = 1.f;
-
-        // Configure classes
-
-        // Classes in the initialization step ==================================
-        
-        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
-        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
-        fReps.init (nr, Staging::NONE);
-
-        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
-
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
-        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
-
-        // Classes in the iteration step =======================================
-
-        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
-
-        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
-        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
-        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        transform.init (m, Staging::NONE);
-
-        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
-        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
-
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
-            transform.get (ICPTransform<TC>::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
-            fReps.get (ICPReps::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMSize);
+        if (dBufferInT () == nullptr)
+            dBufferInT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInTSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
-        weights.get (ICPWeights::Memory::D_IN) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN_ID);
-        weights.get (ICPWeights::Memory::D_OUT_W) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float));
-        weights.get (ICPWeights::Memory::D_OUT_SUM_W) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, sizeof (cl_double));
-        weights.init (m, Staging::NONE);
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInM);
+        kernel.setArg (1, dBufferOut);
+        kernel.setArg (2, dBufferInT);
+    }
 
-        const ICPMeanConfig MC = ICPMeanConfig::WEIGHTED;
 
-        means.get (ICPMean<MC>::Memory::D_IN_F) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        means.get (ICPMean<MC>::Memory::D_IN_M) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        means.get (ICPMean<MC>::Memory::D_IN_W) = 
-            weights.get (ICPWeights::Memory::D_OUT_W);
-        means.get (ICPMean<MC>::Memory::D_IN_SUM_W) = 
-            weights.get (ICPWeights::Memory::D_OUT_SUM_W);
-        means.get (ICPMean<MC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
-        means.init (m, Staging::O);
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the set.
+     */
+    void ICPTransform<ICPTransformConfig::QUATERNION>::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The set cannot have zero points";
 
-        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
-        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.init (m, Staging::NONE);
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTransform<ICPTransformConfig::QUATERNION>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
 
-        const ICPSConfig SC = ICPSConfig::WEIGHTED;
+        m = _m;
+        bufferInMSize = m * sizeof (cl_float8);
+        bufferOutSize = m * sizeof (cl_float8);
 
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
-        matrixS.get (ICPS<SC>::Memory::D_IN_W) = weights.get (ICPWeights::Memory::D_OUT_W);
-        matrixS.init (m, c, Staging::O);
+        // Set workspaces
+        global = cl::NDRange (2, m);
     }
 
 
@@ -3790,27 +4507,22 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::write (
-        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPTransform<ICPTransformConfig::QUATERNION>::write (
+        ICPTransform::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPStep::Memory::D_IN_F:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
-                    break;
-                case ICPStep::Memory::D_IN_M:
+                case ICPTransform::Memory::D_IN_M:
                     if (ptr != nullptr)
                         std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInMSize, hPtrInM, events, event);
                     break;
-                case ICPStep::Memory::D_IO_T:
+                case ICPTransform::Memory::D_IN_T:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
-                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 2 * 4, hPtrInT);
+                    queue.enqueueWriteBuffer (dBufferInT, block, 0, bufferInTSize, hPtrInT, events, event);
                     break;
                 default:
                     break;
@@ -3828,16 +4540,16 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::read (
-        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPTransform<ICPTransformConfig::QUATERNION>::read (
+        ICPTransform::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPStep::Memory::H_IO_T:
-                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
-                    return hPtrIOT;
+                case ICPTransform::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
                 default:
                     return nullptr;
             }
@@ -3846,126 +4558,28 @@ namespace ICP
     }
 
 
-    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
-     *        and before any calls to `run` (for each registration).
-     */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::buildRBC (
-        const std::vector<cl::Event> *events, cl::Event *event)
-    {
-        fReps.run (events);
-        rbcC.run (nullptr, event);
-    }
-
-
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the kernel execution.
-     *  \param[in] config flag. If true, configures the `RBC search` process. 
-     *                    Set to true once, when the `RBC` data structure is reset.
-     */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::run (
-        const std::vector<cl::Event> *events, cl::Event *event, bool config)
-    {
-        transform.run ();
-        rbcS.run (nullptr, nullptr, config);
-        weights.run ();
-        means.run ();
-        devs.run ();
-        matrixS.run ();
-
-        mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::WEIGHTED>::Memory::H_OUT, CL_FALSE);
-        Sij = (cl_float *) matrixS.read (ICPS<ICPSConfig::WEIGHTED>::Memory::H_OUT);
-        sk = std::sqrt (Sij[9] / Sij[10]);
-
-        mf = Eigen::Map<Eigen::Vector3f> (mean);
-        mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
-        S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
-        
-        Eigen::JacobiSVD<Eigen::MatrixXf, Eigen::NoQRPreconditioner> 
-            svd (S, Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-        Rk = svd.matrixV () * svd.matrixU ().transpose ();
-        if (Rk.determinant () < 0)
-        {
-            Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
-            B (2, 2) = Rk.determinant ();
-            Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
-        }
-        qk = Eigen::Quaternionf (Rk);
-
-        tk = mf - sk * Rk * mm;
-
-        R = Rk * R;
-        q = Eigen::Quaternionf (R);
-        t = sk * Rk * t + tk;
-        s = sk * s;
-        
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
-        hPtrIOT[7] = s;  // Scale
-
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, event);
-    }
-
-
-    /*! \return The scaling parameter \f$ \alpha \f$. */
-    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getAlpha ()
-    {
-        return a;
-    }
-
-
-    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
-     *
-     *  \param[in] _a scaling parameter \f$ \alpha \f$.
-     */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setAlpha (float _a)
-    {
-        a = _a;
-        rbcC.setAlpha (a);
-        rbcS.setAlpha (a);
-    }
-
-
-    /*! \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \return The scaling factor c.
-     */
-    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getScaling ()
-    {
-        return c;
-    }
-
-
-    /*! \details Updates the kernel argument for the scaling factor c.
-     *  \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \param[in] _c scaling factor.
      */
-    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setScaling (float _c)
+    void ICPTransform<ICPTransformConfig::QUATERNION>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        c = _c;
-        matrixS.setScaling (c);
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
     }
 
 
     /*! \param[in] _env opencl environment.
-     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
-     *                      It specifies the context, queue, etc, to be used.
-     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
-     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
      */
-    ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::ICPStep (
-        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP) : 
-        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), 
-        context (env.getContext (infoICP.pIdx)), 
-        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
-        fReps (env, infoICP), rbcC (env, infoRBC), 
-        transform (env, infoICP), rbcS (env, infoRBC), means (env, infoICP), 
-        devs (env, infoICP), matrixS (env, infoICP), powMethod (env, infoICP), d (8)
+    ICPTransform<ICPTransformConfig::MATRIX>::ICPTransform (
+        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpTransform_Matrix"), d (8)
     {
     }
 
@@ -3975,22 +4589,22 @@ namespace ICP
      *  \param[in] mem enumeration value specifying the requested memory object.
      *  \return A reference to the requested memory object.
      */
-    cl::Memory& ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::get (ICPStep::Memory mem)
+    cl::Memory& ICPTransform<ICPTransformConfig::MATRIX>::get (ICPTransform::Memory mem)
     {
         switch (mem)
         {
-            case ICPStep::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPStep::Memory::H_IN_M:
+            case ICPTransform::Memory::H_IN_M:
                 return hBufferInM;
-            case ICPStep::Memory::H_IO_T:
-                return hBufferIOT;
-            case ICPStep::Memory::D_IN_F:
-                return dBufferInF;
-            case ICPStep::Memory::D_IN_M:
+            case ICPTransform::Memory::H_IN_T:
+                return hBufferInT;
+            case ICPTransform::Memory::H_OUT:
+                return hBufferOut;
+            case ICPTransform::Memory::D_IN_M:
                 return dBufferInM;
-            case ICPStep::Memory::D_IO_T:
-                return dBufferIOT;
+            case ICPTransform::Memory::D_IN_T:
+                return dBufferInT;
+            case ICPTransform::Memory::D_OUT:
+                return dBufferOut;
         }
     }
 
@@ -4000,184 +4614,122 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the sets.
-     *  \param[in] _nr number of fixed set representatives.
-     *  \param[in] _a factor scaling the results of the distance calculations for the 
-     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
-     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
-     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
-     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
-     *                (https://random-ball-cover.nlamprian.me).
-     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
-     *                issues when computing the `S` matrix.
+     *  \param[in] _m number of points in the set.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::init (
-        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    void ICPTransform<ICPTransformConfig::MATRIX>::init (unsigned int _m, Staging _staging)
     {
-        m = _m; nr = _nr; a = _a; c = _c;
-        bufferFMSize = m * sizeof (cl_float8);
-        bufferTSize = 2 * sizeof (cl_float4);
+        m = mMax = _m;
+        bufferInMSize = m * sizeof (cl_float8);
+        bufferInTSize = 4 * sizeof (cl_float4);
+        bufferOutSize = m * sizeof (cl_float8);
         staging = _staging;
 
         try
         {
             if (m == 0)
-                throw "The sets of landmarks cannot have zero points";
-
-            if (nr == 0)
-                throw "The sets of representatives cannot have zero points";
-
-            if (a == 0.f)
-                throw "The alpha parameter cannot be equal to zero";
+                throw "The set cannot have zero points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>]: " 
-                      << error << std::endl;
+            std::cerr << "Error[ICPTransform<ICPTransformConfig::MATRIX>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
+
+        // Set workspaces
+        global = cl::NDRange (2, m);
         
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
                 hPtrInM = nullptr;
+                hPtrInT = nullptr;
+                hPtrOut = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
+                allocStaging (hBufferInM, bufferInMSize, context, pool, lease);
+                allocStaging (hBufferInT, bufferInTSize, context, pool, lease);
 
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
                 hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInMSize);
+                hPtrInT = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInT, CL_FALSE, CL_MAP_WRITE, 0, bufferInTSize);
                 queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+                queue.enqueueUnmapMemObject (hBufferInT, hPtrInT);
 
                 if (!io)
                 {
                     queue.finish ();
+                    hPtrOut = nullptr;
                     break;
                 }
 
             case Staging::O:
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
+
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                queue.finish ();
+
                 if (!io)
                 {
-                    hPtrInF = nullptr;
                     hPtrInM = nullptr;
+                    hPtrInT = nullptr;
                 }
                 break;
         }
 
-        if (hBufferIOT () == nullptr)
-            hBufferIOT = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferTSize);
-
-        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
-            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
-        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
-        queue.finish ();
-
         // Create device buffers
-        if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
         if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
-        if (dBufferIOT () == nullptr)
-            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
-
-        // Load initial identity transformation
-        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
-        std::copy (T0, T0 + 8, hPtrIOT);
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
-
-        R = Eigen::Matrix3f::Identity ();
-        q = Eigen::Quaternionf (R);
-        t.setZero ();
-        s = 1.f;
-
-        // Configure classes
-
-        // Classes in the initialization step ==================================
-        
-        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
-        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
-        fReps.init (nr, Staging::NONE);
-
-        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
-
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
-        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
-
-        // Classes in the iteration step =======================================
-
-        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
-
-        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
-        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
-        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        transform.init (m, Staging::NONE);
-
-        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
-        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
-
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
-            transform.get (ICPTransform<TC>::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
-            fReps.get (ICPReps::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMSize);
+        if (dBufferInT () == nullptr)
+            dBufferInT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInTSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
-        const ICPMeanConfig MC = ICPMeanConfig::REGULAR;
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInM);
+        kernel.setArg (1, dBufferOut);
+        kernel.setArg (2, dBufferInT);
+    }
 
-        means.get (ICPMean<MC>::Memory::D_IN_F) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        means.get (ICPMean<MC>::Memory::D_IN_M) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        means.get (ICPMean<MC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
-        means.init (m, Staging::O);
 
-        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
-        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.init (m, Staging::NONE);
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the set.
+     */
+    void ICPTransform<ICPTransformConfig::MATRIX>::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The set cannot have zero points";
 
-        const ICPSConfig SC = ICPSConfig::REGULAR;
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTransform<ICPTransformConfig::MATRIX>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
 
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
-        matrixS.get (ICPS<SC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, 11 * sizeof (cl_float));
-        matrixS.init (m, c, Staging::NONE);
+        m = _m;
+        bufferInMSize = m * sizeof (cl_float8);
+        bufferOutSize = m * sizeof (cl_float8);
 
-        powMethod.get (ICPPowerMethod::Memory::D_IN_S) = matrixS.get (ICPS<SC>::Memory::D_OUT);
-        powMethod.get (ICPPowerMethod::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
-        powMethod.get (ICPPowerMethod::Memory::D_OUT_T_K) = dBufferIOT;
-        powMethod.init (Staging::O);
+        // Set workspaces
+        global = cl::NDRange (2, m);
     }
 
 
@@ -4192,27 +4744,22 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::write (
-        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPTransform<ICPTransformConfig::MATRIX>::write (
+        ICPTransform::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPStep::Memory::D_IN_F:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
-                    break;
-                case ICPStep::Memory::D_IN_M:
+                case ICPTransform::Memory::D_IN_M:
                     if (ptr != nullptr)
                         std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInMSize, hPtrInM, events, event);
                     break;
-                case ICPStep::Memory::D_IO_T:
+                case ICPTransform::Memory::D_IN_T:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
-                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 16, hPtrInT);
+                    queue.enqueueWriteBuffer (dBufferInT, block, 0, bufferInTSize, hPtrInT, events, event);
                     break;
                 default:
                     break;
@@ -4230,16 +4777,16 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the read operation to the staging buffer.
      */
-    void* ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::read (
-        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void* ICPTransform<ICPTransformConfig::MATRIX>::read (
+        ICPTransform::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::O || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPStep::Memory::H_IO_T:
-                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
-                    return hPtrIOT;
+                case ICPTransform::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
                 default:
                     return nullptr;
             }
@@ -4248,138 +4795,54 @@ namespace ICP
     }
 
 
-    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
-     *        and before any calls to `run` (for each registration).
-     */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::buildRBC (
-        const std::vector<cl::Event> *events, cl::Event *event)
-    {
-        fReps.run (events);
-        rbcC.run (nullptr, event);
-    }
-
-
     /*! \details The function call is non-blocking.
      *
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the kernel execution.
-     *  \param[in] config flag. If true, configures the `RBC search` process. 
-     *                    Set to true once, when the `RBC` data structure is reset.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::run (
-        const std::vector<cl::Event> *events, cl::Event *event, bool config)
+    void ICPTransform<ICPTransformConfig::MATRIX>::run (const std::vector<cl::Event> *events, cl::Event *event)
     {
-        transform.run ();
-        rbcS.run (nullptr, nullptr, config);
-        means.run ();
-        devs.run ();
-        matrixS.run ();
-        powMethod.run ();
-
-        Tk = (cl_float *) powMethod.read (ICPPowerMethod::Memory::H_OUT_T_K);
-
-        qk = Eigen::Quaternionf (Tk);
-        Rk = qk.toRotationMatrix ();
-        tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
-        sk = Tk[7];
-
-        R = Rk * R;
-        q = Eigen::Quaternionf (R);
-        t = sk * Rk * t + tk;
-        s = sk * s;
-        
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
-        hPtrIOT[7] = s;  // Scale
-
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, event);
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
     }
 
 
-    /*! \return The scaling parameter \f$ \alpha \f$. */
-    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getAlpha ()
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::ICPTransform (
+        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpTransform_Quaternion_SoA"), d (4)
     {
-        return a;
     }
 
 
-    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
      *
-     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setAlpha (float _a)
+    cl::Memory& ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::get (ICPTransform::Memory mem)
     {
-        a = _a;
-        rbcC.setAlpha (a);
-        rbcS.setAlpha (a);
-    }
-
-
-    /*! \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \return The scaling factor c.
-     */
-    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getScaling ()
-    {
-        return c;
-    }
-
-
-    /*! \details Updates the kernel argument for the scaling factor c.
-     *  \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \param[in] _c scaling factor.
-     */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setScaling (float _c)
-    {
-        c = _c;
-        matrixS.setScaling (c);
-    }
-
-
-    /*! \param[in] _env opencl environment.
-     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
-     *                      It specifies the context, queue, etc, to be used.
-     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
-     *                      It specifies the context, queue, etc, to be used.
-     */
-    ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::ICPStep (
-        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP) : 
-        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), 
-        context (env.getContext (infoICP.pIdx)), 
-        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
-        fReps (env, infoICP), rbcC (env, infoRBC), 
-        transform (env, infoICP), rbcS (env, infoRBC), weights (env, infoICP), 
-        means (env, infoICP), devs (env, infoICP), matrixS (env, infoICP), 
-        powMethod (env, infoICP), d (8)
-    {
-    }
-
-
-    /*! \details This interface exists to allow CL memory sharing between different kernels.
-     *
-     *  \param[in] mem enumeration value specifying the requested memory object.
-     *  \return A reference to the requested memory object.
-     */
-    cl::Memory& ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::get (ICPStep::Memory mem)
-    {
-        switch (mem)
-        {
-            case ICPStep::Memory::H_IN_F:
-                return hBufferInF;
-            case ICPStep::Memory::H_IN_M:
-                return hBufferInM;
-            case ICPStep::Memory::H_IO_T:
-                return hBufferIOT;
-            case ICPStep::Memory::D_IN_F:
-                return dBufferInF;
-            case ICPStep::Memory::D_IN_M:
-                return dBufferInM;
-            case ICPStep::Memory::D_IO_T:
-                return dBufferIOT;
-        }
+        switch (mem)
+        {
+            case ICPTransform::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPTransform::Memory::H_IN_T:
+                return hBufferInT;
+            case ICPTransform::Memory::H_OUT:
+                return hBufferOut;
+            case ICPTransform::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPTransform::Memory::D_IN_T:
+                return dBufferInT;
+            case ICPTransform::Memory::D_OUT:
+                return dBufferOut;
+        }
     }
 
 
@@ -4388,197 +4851,122 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the sets.
-     *  \param[in] _nr number of fixed set representatives.
-     *  \param[in] _a factor scaling the results of the distance calculations for the 
-     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
-     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
-     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
-     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
-     *                (https://random-ball-cover.nlamprian.me).
-     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
-     *                issues when computing the `S` matrix.
+     *  \param[in] _m number of points in the set.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::init (
-        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    void ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::init (unsigned int _m, Staging _staging)
     {
-        m = _m; nr = _nr; a = _a; c = _c;
-        bufferFMSize = m * sizeof (cl_float8);
-        bufferTSize = 2 * sizeof (cl_float4);
+        m = mMax = _m;
+        bufferInMSize = m * sizeof (cl_float4);
+        bufferInTSize = 2 * sizeof (cl_float4);
+        bufferOutSize = m * sizeof (cl_float4);
         staging = _staging;
 
         try
         {
             if (m == 0)
-                throw "The sets of landmarks cannot have zero points";
-
-            if (nr == 0)
-                throw "The sets of representatives cannot have zero points";
-
-            if (a == 0.f)
-                throw "The alpha parameter cannot be equal to zero";
+                throw "The set cannot have zero points";
         }
         catch (const char *error)
         {
-            std::cerr << "Error[ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>]: " 
-                      << error << std::endl;
+            std::cerr << "Error[ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>]: " << error << std::endl;
             exit (EXIT_FAILURE);
         }
+
+        // Set workspaces
+        global = cl::NDRange (m);
         
         // Create staging buffers
         bool io = false;
         switch (staging)
         {
             case Staging::NONE:
-                hPtrInF = nullptr;
                 hPtrInM = nullptr;
+                hPtrInT = nullptr;
+                hPtrOut = nullptr;
                 break;
 
             case Staging::IO:
                 io = true;
 
             case Staging::I:
-                if (hBufferInF () == nullptr)
-                    hBufferInF = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
-                if (hBufferInM () == nullptr)
-                    hBufferInM = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferFMSize);
+                allocStaging (hBufferInM, bufferInMSize, context, pool, lease);
+                allocStaging (hBufferInT, bufferInTSize, context, pool, lease);
 
-                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
                 hPtrInM = (cl_float *) queue.enqueueMapBuffer (
-                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
-                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferInMSize);
+                hPtrInT = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInT, CL_FALSE, CL_MAP_WRITE, 0, bufferInTSize);
                 queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+                queue.enqueueUnmapMemObject (hBufferInT, hPtrInT);
 
                 if (!io)
                 {
                     queue.finish ();
+                    hPtrOut = nullptr;
                     break;
                 }
 
             case Staging::O:
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
+
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                queue.finish ();
+
                 if (!io)
                 {
-                    hPtrInF = nullptr;
                     hPtrInM = nullptr;
+                    hPtrInT = nullptr;
                 }
                 break;
         }
 
-        if (hBufferIOT () == nullptr)
-            hBufferIOT = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, bufferTSize);
-
-        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
-            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
-        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
-        queue.finish ();
-
         // Create device buffers
-        if (dBufferInF () == nullptr)
-            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
         if (dBufferInM () == nullptr)
-            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
-        if (dBufferIOT () == nullptr)
-            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
-
-        // Load initial identity transformation
-        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
-        std::copy (T0, T0 + 8, hPtrIOT);
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
-
-        R = Eigen::Matrix3f::Identity ();
-        q = Eigen::Quaternionf (R);
-        t.setZero ();
-        s = 1.f;
-
-        // Configure classes
-
-        // Classes in the initialization step ==================================
-        
-        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
-        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
-        fReps.init (nr, Staging::NONE);
-
-        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
-
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
-        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
-        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
-
-        // Classes in the iteration step =======================================
-
-        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
-
-        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
-        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
-        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        transform.init (m, Staging::NONE);
-
-        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
-        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
-        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
-
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
-            transform.get (ICPTransform<TC>::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
-            fReps.get (ICPReps::Memory::D_OUT);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
-            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
-        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
-
-        weights.get (ICPWeights::Memory::D_IN) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN_ID);
-        weights.get (ICPWeights::Memory::D_OUT_W) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float));
-        weights.get (ICPWeights::Memory::D_OUT_SUM_W) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, sizeof (cl_double));
-        weights.init (m, Staging::NONE);
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInMSize);
+        if (dBufferInT () == nullptr)
+            dBufferInT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInTSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
 
-        const ICPMeanConfig MC = ICPMeanConfig::WEIGHTED;
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInM);
+        kernel.setArg (1, dBufferOut);
+        kernel.setArg (2, dBufferInT);
+    }
 
-        means.get (ICPMean<MC>::Memory::D_IN_F) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        means.get (ICPMean<MC>::Memory::D_IN_M) = 
-            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        means.get (ICPMean<MC>::Memory::D_IN_W) = 
-            weights.get (ICPWeights::Memory::D_OUT_W);
-        means.get (ICPMean<MC>::Memory::D_IN_SUM_W) = 
-            weights.get (ICPWeights::Memory::D_OUT_SUM_W);
-        means.get (ICPMean<MC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
-        means.init (m, Staging::O);
 
-        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
-        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
-        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
-        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
-        devs.init (m, Staging::NONE);
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the set.
+     */
+    void ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The set cannot have zero points";
 
-        const ICPSConfig SC = ICPSConfig::WEIGHTED;
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
 
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
-        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
-        matrixS.get (ICPS<SC>::Memory::D_IN_W) = weights.get (ICPWeights::Memory::D_OUT_W);
-        matrixS.get (ICPS<SC>::Memory::D_OUT) = 
-            cl::Buffer (context, CL_MEM_READ_WRITE, 11 * sizeof (cl_float));
-        matrixS.init (m, c, Staging::NONE);
+        m = _m;
+        bufferInMSize = m * sizeof (cl_float4);
+        bufferOutSize = m * sizeof (cl_float4);
 
-        powMethod.get (ICPPowerMethod::Memory::D_IN_S) = matrixS.get (ICPS<SC>::Memory::D_OUT);
-        powMethod.get (ICPPowerMethod::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
-        powMethod.get (ICPPowerMethod::Memory::D_OUT_T_K) = dBufferIOT;
-        powMethod.init (Staging::O);
+        // Set workspaces
+        global = cl::NDRange (m);
     }
 
 
@@ -4593,27 +4981,22 @@ namespace ICP
      *  \param[in] events a wait-list of events.
      *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::write (
-        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::write (
+        ICPTransform::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
     {
         if (staging == Staging::I || staging == Staging::IO)
         {
             switch (mem)
             {
-                case ICPStep::Memory::D_IN_F:
-                    if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
-                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
-                    break;
-                case ICPStep::Memory::D_IN_M:
+                case ICPTransform::Memory::D_IN_M:
                     if (ptr != nullptr)
                         std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
-                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferInMSize, hPtrInM, events, event);
                     break;
-                case ICPStep::Memory::D_IO_T:
+                case ICPTransform::Memory::D_IN_T:
                     if (ptr != nullptr)
-                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
-                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 2 * 4, hPtrInT);
+                    queue.enqueueWriteBuffer (dBufferInT, block, 0, bufferInTSize, hPtrInT, events, event);
                     break;
                 default:
                     break;
@@ -4629,128 +5012,5647 @@ namespace ICP
      *  \param[in] block a flag to indicate whether to perform a blocking 
      *                   or a non-blocking operation.
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the read operation to the staging buffer.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::read (
+        ICPTransform::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPTransform::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     */
+    void ICPTransform<ICPTransformConfig::QUATERNION, ICPLayout::SOA>::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPSplit::ICPSplit (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpSplit_SoA"), color (ICPColor::UCHAR)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPSplit::get (ICPSplit::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPSplit::Memory::H_IN:
+                return hBufferIn;
+            case ICPSplit::Memory::H_OUT_G:
+                return hBufferOutG;
+            case ICPSplit::Memory::H_OUT_C:
+                return hBufferOutC;
+            case ICPSplit::Memory::D_IN:
+                return dBufferIn;
+            case ICPSplit::Memory::D_OUT_G:
+                return dBufferOutG;
+            case ICPSplit::Memory::D_OUT_C:
+                return dBufferOutC;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the set.
+     *  \param[in] _color storage format of the color stream.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPSplit::init (unsigned int _m, ICPColor _color, Staging _staging)
+    {
+        m = _m;
+        bufferInSize = m * sizeof (cl_float8);
+        bufferOutGSize = m * sizeof (cl_float4);
+        bufferOutCSize = (_color == ICPColor::HALF) ? m * 4 * sizeof (cl_half) : m * sizeof (cl_uchar4);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The set cannot have zero points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPSplit]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        if (_color != color)
+        {
+            color = _color;
+            const char *name = (color == ICPColor::HALF) ? "icpSplit_SoA_Half" : "icpSplit_SoA";
+            kernel = cl::Kernel (env.getProgram (info.pgIdx), name);
+        }
+
+        // Set workspaces
+        global = cl::NDRange (m);
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrIn = nullptr;
+                hPtrOutG = nullptr;
+                hPtrOutC = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferIn, bufferInSize, context, pool, lease);
+
+                hPtrIn = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferIn, CL_FALSE, CL_MAP_WRITE, 0, bufferInSize);
+                queue.enqueueUnmapMemObject (hBufferIn, hPtrIn);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    hPtrOutG = nullptr;
+                    hPtrOutC = nullptr;
+                    break;
+                }
+
+            case Staging::O:
+                allocStaging (hBufferOutG, bufferOutGSize, context, pool, lease);
+                allocStaging (hBufferOutC, bufferOutCSize, context, pool, lease);
+
+                hPtrOutG = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutG, CL_FALSE, CL_MAP_READ, 0, bufferOutGSize);
+                hPtrOutC = (cl_uchar *) queue.enqueueMapBuffer (
+                    hBufferOutC, CL_FALSE, CL_MAP_READ, 0, bufferOutCSize);
+                queue.enqueueUnmapMemObject (hBufferOutG, hPtrOutG);
+                queue.enqueueUnmapMemObject (hBufferOutC, hPtrOutC);
+                queue.finish ();
+
+                if (!io)
+                    hPtrIn = nullptr;
+                break;
+        }
+
+        // Create device buffers
+        if (dBufferIn () == nullptr)
+            dBufferIn = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSize);
+        if (dBufferOutG () == nullptr)
+            dBufferOutG = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutGSize);
+        if (dBufferOutC () == nullptr)
+            dBufferOutC = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutCSize);
+
+        // Set kernel arguments
+        kernel.setArg (0, dBufferIn);
+        kernel.setArg (1, dBufferOutG);
+        kernel.setArg (2, dBufferOutC);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPSplit::write (ICPSplit::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPSplit::Memory::D_IN:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8 * m, hPtrIn);
+                    queue.enqueueWriteBuffer (dBufferIn, block, 0, bufferInSize, hPtrIn, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPSplit::read (ICPSplit::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPSplit::Memory::H_OUT_G:
+                    queue.enqueueReadBuffer (dBufferOutG, block, 0, bufferOutGSize, hPtrOutG, events, event);
+                    return hPtrOutG;
+                case ICPSplit::Memory::H_OUT_C:
+                    queue.enqueueReadBuffer (dBufferOutC, block, 0, bufferOutCSize, hPtrOutC, events, event);
+                    return hPtrOutC;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     */
+    void ICPSplit::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPMerge::ICPMerge (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpMerge_SoA"), color (ICPColor::UCHAR)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPMerge::get (ICPMerge::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPMerge::Memory::H_IN_G:
+                return hBufferInG;
+            case ICPMerge::Memory::H_IN_C:
+                return hBufferInC;
+            case ICPMerge::Memory::H_OUT:
+                return hBufferOut;
+            case ICPMerge::Memory::D_IN_G:
+                return dBufferInG;
+            case ICPMerge::Memory::D_IN_C:
+                return dBufferInC;
+            case ICPMerge::Memory::D_OUT:
+                return dBufferOut;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the set.
+     *  \param[in] _color storage format of the color stream.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPMerge::init (unsigned int _m, ICPColor _color, Staging _staging)
+    {
+        m = _m;
+        bufferInGSize = m * sizeof (cl_float4);
+        bufferInCSize = (_color == ICPColor::HALF) ? m * 4 * sizeof (cl_half) : m * sizeof (cl_uchar4);
+        bufferOutSize = m * sizeof (cl_float8);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The set cannot have zero points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPMerge]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        if (_color != color)
+        {
+            color = _color;
+            const char *name = (color == ICPColor::HALF) ? "icpMerge_SoA_Half" : "icpMerge_SoA";
+            kernel = cl::Kernel (env.getProgram (info.pgIdx), name);
+        }
+
+        // Set workspaces
+        global = cl::NDRange (m);
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInG = nullptr;
+                hPtrInC = nullptr;
+                hPtrOut = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInG, bufferInGSize, context, pool, lease);
+                allocStaging (hBufferInC, bufferInCSize, context, pool, lease);
+
+                hPtrInG = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInG, CL_FALSE, CL_MAP_WRITE, 0, bufferInGSize);
+                hPtrInC = (cl_uchar *) queue.enqueueMapBuffer (
+                    hBufferInC, CL_FALSE, CL_MAP_WRITE, 0, bufferInCSize);
+                queue.enqueueUnmapMemObject (hBufferInG, hPtrInG);
+                queue.enqueueUnmapMemObject (hBufferInC, hPtrInC);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    hPtrOut = nullptr;
+                    break;
+                }
+
+            case Staging::O:
+                allocStaging (hBufferOut, bufferOutSize, context, pool, lease);
+
+                hPtrOut = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOut, CL_FALSE, CL_MAP_READ, 0, bufferOutSize);
+                queue.enqueueUnmapMemObject (hBufferOut, hPtrOut);
+                queue.finish ();
+
+                if (!io)
+                {
+                    hPtrInG = nullptr;
+                    hPtrInC = nullptr;
+                }
+                break;
+        }
+
+        // Create device buffers
+        if (dBufferInG () == nullptr)
+            dBufferInG = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInGSize);
+        if (dBufferInC () == nullptr)
+            dBufferInC = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInCSize);
+        if (dBufferOut () == nullptr)
+            dBufferOut = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutSize);
+
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInG);
+        kernel.setArg (1, dBufferInC);
+        kernel.setArg (2, dBufferOut);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPMerge::write (ICPMerge::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPMerge::Memory::D_IN_G:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 4 * m, hPtrInG);
+                    queue.enqueueWriteBuffer (dBufferInG, block, 0, bufferInGSize, hPtrInG, events, event);
+                    break;
+                case ICPMerge::Memory::D_IN_C:
+                    if (ptr != nullptr)
+                        std::copy ((cl_uchar *) ptr, (cl_uchar *) ptr + bufferInCSize, hPtrInC);
+                    queue.enqueueWriteBuffer (dBufferInC, block, 0, bufferInCSize, hPtrInC, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPMerge::read (ICPMerge::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPMerge::Memory::H_OUT:
+                    queue.enqueueReadBuffer (dBufferOut, block, 0, bufferOutSize, hPtrOut, events, event);
+                    return hPtrOut;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     */
+    void ICPMerge::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events, event);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPPowerMethod::ICPPowerMethod (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpPowerMethod"), 
+        tolerance (0.f), max_iterations (2000), warm_start (false)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPPowerMethod::get (ICPPowerMethod::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPPowerMethod::Memory::H_IN_S:
+                return hBufferInS;
+            case ICPPowerMethod::Memory::H_IN_MEAN:
+                return hBufferInMean;
+            case ICPPowerMethod::Memory::H_OUT_T_K:
+                return hBufferOutTk;
+            case ICPPowerMethod::Memory::H_OUT_ITER:
+                return hBufferOutIter;
+            case ICPPowerMethod::Memory::D_IN_S:
+                return dBufferInS;
+            case ICPPowerMethod::Memory::D_IN_MEAN:
+                return dBufferInMean;
+            case ICPPowerMethod::Memory::D_OUT_T_K:
+                return dBufferOutTk;
+            case ICPPowerMethod::Memory::D_OUT_ITER:
+                return dBufferOutIter;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPPowerMethod::init (Staging _staging)
+    {
+        bufferInSSize = 11 * sizeof (cl_float);
+        bufferInMeanSize = 2 * sizeof (cl_float4);
+        bufferOutTkSize = 2 * sizeof (cl_float4);
+        bufferOutIterSize = sizeof (cl_uint);
+        staging = _staging;
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInS = nullptr;
+                hPtrInMean = nullptr;
+                hPtrOutTk = nullptr;
+                hPtrOutIter = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInS, bufferInSSize, context, pool, lease);
+                allocStaging (hBufferInMean, bufferInMeanSize, context, pool, lease);
+
+                hPtrInS = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInS, CL_FALSE, CL_MAP_WRITE, 0, bufferInSSize);
+                hPtrInMean = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInMean, CL_FALSE, CL_MAP_WRITE, 0, bufferInMeanSize);
+                queue.enqueueUnmapMemObject (hBufferInS, hPtrInS);
+                queue.enqueueUnmapMemObject (hBufferInMean, hPtrInMean);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    hPtrOutTk = nullptr;
+                    hPtrOutIter = nullptr;
+                    break;
+                }
+
+            case Staging::O:
+                allocStaging (hBufferOutTk, bufferOutTkSize, context, pool, lease);
+                allocStaging (hBufferOutIter, bufferOutIterSize, context, pool, lease);
+
+                hPtrOutTk = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutTk, CL_FALSE, CL_MAP_READ, 0, bufferOutTkSize);
+                hPtrOutIter = (cl_uint *) queue.enqueueMapBuffer (
+                    hBufferOutIter, CL_FALSE, CL_MAP_READ, 0, bufferOutIterSize);
+                queue.enqueueUnmapMemObject (hBufferOutTk, hPtrOutTk);
+                queue.enqueueUnmapMemObject (hBufferOutIter, hPtrOutIter);
+                queue.finish ();
+
+                if (!io)
+                {
+                    hPtrInS = nullptr;
+                    hPtrInMean = nullptr;
+                }
+                break;
+        }
+
+        // Create device buffers
+        if (dBufferInS () == nullptr)
+            dBufferInS = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSSize);
+        if (dBufferInMean () == nullptr)
+            dBufferInMean = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInMeanSize);
+        if (dBufferOutTk () == nullptr)
+            dBufferOutTk = cl::Buffer (context, CL_MEM_READ_WRITE, bufferOutTkSize);
+        if (dBufferOutIter () == nullptr)
+            dBufferOutIter = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutIterSize);
+
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInS);
+        kernel.setArg (1, dBufferInMean);
+        kernel.setArg (2, dBufferOutTk);
+        kernel.setArg (3, dBufferOutIter);
+        kernel.setArg (4, tolerance);
+        kernel.setArg (5, (cl_uint) max_iterations);
+        kernel.setArg (6, (cl_uint) warm_start);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPPowerMethod::write (ICPPowerMethod::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPPowerMethod::Memory::D_IN_S:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 11, hPtrInS);
+                    queue.enqueueWriteBuffer (dBufferInS, block, 0, bufferInSSize, hPtrInS, events, event);
+                    break;
+                case ICPPowerMethod::Memory::D_IN_MEAN:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrInMean);
+                    queue.enqueueWriteBuffer (dBufferInMean, block, 0, bufferInMeanSize, hPtrInMean, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPPowerMethod::read (ICPPowerMethod::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPPowerMethod::Memory::H_OUT_T_K:
+                    queue.enqueueReadBuffer (dBufferOutTk, block, 0, bufferOutTkSize, hPtrOutTk, events, event);
+                    return hPtrOutTk;
+                case ICPPowerMethod::Memory::H_OUT_ITER:
+                    queue.enqueueReadBuffer (dBufferOutIter, block, 0, bufferOutIterSize, hPtrOutIter, events, event);
+                    return hPtrOutIter;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     */
+    void ICPPowerMethod::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueTask (kernel, events, event);
+    }
+
+
+    /*! \return The convergence tolerance of the Power Method. */
+    float ICPPowerMethod::getTolerance ()
+    {
+        return tolerance;
+    }
+
+
+    /*! \details Updates the kernel argument for the convergence tolerance. The iterations 
+     *           stop when the distance between two consecutive estimates drops to `tolerance`. 
+     *           A tolerance of `0` runs until the distance stops changing.
+     *  
+     *  \param[in] _tolerance convergence tolerance.
+     */
+    void ICPPowerMethod::setTolerance (float _tolerance)
+    {
+        tolerance = _tolerance;
+        kernel.setArg (4, tolerance);
+    }
+
+
+    /*! \return The maximum number of Power Method iterations. */
+    unsigned int ICPPowerMethod::getMaxIterations ()
+    {
+        return max_iterations;
+    }
+
+
+    /*! \details Updates the kernel argument for the maximum number of iterations. 
+     *           It bounds the latency of the kernel, including the iterations 
+     *           after a shift for a negative eigenvalue. The default, `2000`, 
+     *           covers `1000` iterations on each pass.
+     *  
+     *  \param[in] _max_iterations maximum number of iterations. It's clamped to at least `1`.
+     */
+    void ICPPowerMethod::setMaxIterations (unsigned int _max_iterations)
+    {
+        max_iterations = std::max (_max_iterations, 1U);
+        kernel.setArg (5, (cl_uint) max_iterations);
+    }
+
+
+    /*! \return The flag for warm starting the Power Method. */
+    bool ICPPowerMethod::getWarmStart ()
+    {
+        return warm_start;
+    }
+
+
+    /*! \details Updates the kernel argument for the warm start. When set, the iterations 
+     *           start from the quaternion in `D_OUT_T_K`, that is, the previous \f$ q_k \f$.
+     *  
+     *  \param[in] _warm_start flag to indicate whether to warm start the Power Method.
+     */
+    void ICPPowerMethod::setWarmStart (bool _warm_start)
+    {
+        warm_start = _warm_start;
+        kernel.setArg (6, (cl_uint) warm_start);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPSVD::ICPSVD (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpSVD")
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPSVD::get (ICPSVD::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPSVD::Memory::H_IN_S:
+                return hBufferInS;
+            case ICPSVD::Memory::H_IN_MEAN:
+                return hBufferInMean;
+            case ICPSVD::Memory::H_OUT_T_K:
+                return hBufferOutTk;
+            case ICPSVD::Memory::D_IN_S:
+                return dBufferInS;
+            case ICPSVD::Memory::D_IN_MEAN:
+                return dBufferInMean;
+            case ICPSVD::Memory::D_OUT_T_K:
+                return dBufferOutTk;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPSVD::init (Staging _staging)
+    {
+        bufferInSSize = 11 * sizeof (cl_float);
+        bufferInMeanSize = 2 * sizeof (cl_float4);
+        bufferOutTkSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInS = nullptr;
+                hPtrInMean = nullptr;
+                hPtrOutTk = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInS, bufferInSSize, context, pool, lease);
+                allocStaging (hBufferInMean, bufferInMeanSize, context, pool, lease);
+
+                hPtrInS = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInS, CL_FALSE, CL_MAP_WRITE, 0, bufferInSSize);
+                hPtrInMean = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInMean, CL_FALSE, CL_MAP_WRITE, 0, bufferInMeanSize);
+                queue.enqueueUnmapMemObject (hBufferInS, hPtrInS);
+                queue.enqueueUnmapMemObject (hBufferInMean, hPtrInMean);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    hPtrOutTk = nullptr;
+                    break;
+                }
+
+            case Staging::O:
+                allocStaging (hBufferOutTk, bufferOutTkSize, context, pool, lease);
+
+                hPtrOutTk = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutTk, CL_FALSE, CL_MAP_READ, 0, bufferOutTkSize);
+                queue.enqueueUnmapMemObject (hBufferOutTk, hPtrOutTk);
+                queue.finish ();
+
+                if (!io)
+                {
+                    hPtrInS = nullptr;
+                    hPtrInMean = nullptr;
+                }
+                break;
+        }
+
+        // Create device buffers
+        if (dBufferInS () == nullptr)
+            dBufferInS = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInSSize);
+        if (dBufferInMean () == nullptr)
+            dBufferInMean = cl::Buffer (context, CL_MEM_READ_WRITE, bufferInMeanSize);
+        if (dBufferOutTk () == nullptr)
+            dBufferOutTk = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferOutTkSize);
+
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInS);
+        kernel.setArg (1, dBufferInMean);
+        kernel.setArg (2, dBufferOutTk);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPSVD::write (ICPSVD::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPSVD::Memory::D_IN_S:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 11, hPtrInS);
+                    queue.enqueueWriteBuffer (dBufferInS, block, 0, bufferInSSize, hPtrInS, events, event);
+                    break;
+                case ICPSVD::Memory::D_IN_MEAN:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrInMean);
+                    queue.enqueueWriteBuffer (dBufferInMean, block, 0, bufferInMeanSize, hPtrInMean, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPSVD::read (ICPSVD::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPSVD::Memory::H_OUT_T_K:
+                    queue.enqueueReadBuffer (dBufferOutTk, block, 0, bufferOutTkSize, hPtrOutTk, events, event);
+                    return hPtrOutTk;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     */
+    void ICPSVD::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueTask (kernel, events, event);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPPlane::ICPPlane (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpPlaneProducts"), 
+        solveKernel (env.getProgram (info.pgIdx), "icpPlaneSolve"), 
+        reduceSums (env, info, pool)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPPlane::get (ICPPlane::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPPlane::Memory::H_OUT_T_K:
+                return hBufferOutTk;
+            case ICPPlane::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPPlane::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPPlane::Memory::D_IN_N:
+                return dBufferInN;
+            case ICPPlane::Memory::D_SUMS_P:
+                return dBufferSumsP;
+            case ICPPlane::Memory::D_SUMS:
+                return dBufferSums;
+            case ICPPlane::Memory::D_PIVOT:
+                return dBufferPivot;
+            case ICPPlane::Memory::D_OUT_T_K:
+                return dBufferOutTk;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *  \note The input buffers are expected to be produced on the device, 
+     *        so there are no input staging buffers.
+     *  \note The principal point is placed at the center of the normal map. 
+     *        Call `setIntrinsics` to specify the camera parameters.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _width width (in pixels) of the normal map.
+     *  \param[in] _height height (in pixels) of the normal map.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPPlane::init (unsigned int _m, unsigned int _width, unsigned int _height, 
+                         float _c, Staging _staging)
+    {
+        m = mMax = _m; width = _width; height = _height; c = _c;
+        bufferInFMSize = m * sizeof (cl_float8);
+        bufferInNSize = width * height * sizeof (cl_float4);
+        bufferSumsSize = 31 * sizeof (cl_float);
+        bufferTkSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
+
+        bufferSumsPSize = 31 * (n * sizeof (cl_float));
+
+        try
+        {
+            if (m == 0)
+                throw "The array cannot have zero points";
+            if (width * height == 0)
+                throw "The normal map cannot have zero pixels";
+            if (!matchesSpecialization (env, info, _m, _c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPPlane]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        // Set workspaces
+        global = cl::NDRange (n);
+
+        // Create staging buffers
+        switch (staging)
+        {
+            case Staging::NONE:
+            case Staging::I:
+                hPtrOutTk = nullptr;
+                break;
+
+            case Staging::IO:
+            case Staging::O:
+                allocStaging (hBufferOutTk, bufferTkSize, context, pool, lease);
+
+                hPtrOutTk = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferOutTk, CL_FALSE, CL_MAP_READ, 0, bufferTkSize);
+                queue.enqueueUnmapMemObject (hBufferOutTk, hPtrOutTk);
+                queue.finish ();
+                break;
+        }
+        
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInFMSize);
+        if (dBufferInN () == nullptr)
+            dBufferInN = cl::Buffer (context, CL_MEM_READ_ONLY, bufferInNSize);
+        if (dBufferSumsP () == nullptr)
+            dBufferSumsP = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSumsPSize);
+        if (dBufferSums () == nullptr)
+            dBufferSums = cl::Buffer (context, CL_MEM_READ_WRITE, bufferSumsSize);
+        if (dBufferPivot () == nullptr)
+            dBufferPivot = cl::Buffer (context, CL_MEM_READ_WRITE, sizeof (cl_float4));
+        if (dBufferOutTk () == nullptr)
+            dBufferOutTk = cl::Buffer (context, CL_MEM_WRITE_ONLY, bufferTkSize);
+
+        // Zero the pivot
+        cl_float4 p0 = { { 0.f, 0.f, 0.f, 0.f } };
+        queue.enqueueWriteBuffer (dBufferPivot, CL_TRUE, 0, sizeof (cl_float4), &p0);
+
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInF);
+        kernel.setArg (1, dBufferInM);
+        kernel.setArg (2, dBufferInN);
+        kernel.setArg (3, dBufferPivot);
+        kernel.setArg (4, dBufferSumsP);
+        setIntrinsics (595.f, 595.f, (width - 1) / 2.f, (height - 1) / 2.f);
+        kernel.setArg (6, width);
+        kernel.setArg (7, height);
+        kernel.setArg (8, m);
+        kernel.setArg (9, c);
+
+        solveKernel.setArg (0, dBufferSums);
+        solveKernel.setArg (1, dBufferPivot);
+        solveKernel.setArg (2, dBufferOutTk);
+        solveKernel.setArg (3, c);
+
+        reduceSums.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSumsP;
+        reduceSums.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferSums;
+        reduceSums.init (n, 31, Staging::NONE);
+    }
+
+
+    /*! \details Updates the workspaces and kernel arguments for a new number of points, 
+     *           and retains every memory object set up by `init`.
+     *  \note `init` has to have been called first. The number of points given 
+     *        to `init` is the capacity of the instance, and `resize` cannot exceed it.
+     *        
+     *  \param[in] _m number of points in the sets.
+     */
+    void ICPPlane::resize (unsigned int _m)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The array cannot have zero points";
+
+            if (_m > mMax)
+                throw "The number of points cannot exceed the capacity set by init";
+            if (!matchesSpecialization (env, info, _m, c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPPlane]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m;
+        bufferInFMSize = m * sizeof (cl_float8);
+
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
+
+        bufferSumsPSize = 31 * (n * sizeof (cl_float));
+
+        // Set workspaces
+        global = cl::NDRange (n);
+
+        // Set kernel arguments
+        kernel.setArg (8, m);
+
+        reduceSums.resize (n);
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPPlane::read (ICPPlane::Memory mem, bool block, 
+                          const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPPlane::Memory::H_OUT_T_K:
+                    queue.enqueueReadBuffer (dBufferOutTk, block, 0, bufferTkSize, hPtrOutTk, events, event);
+                    return hPtrOutTk;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the last kernel execution.
+     */
+    void ICPPlane::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueNDRangeKernel (kernel, cl::NullRange, global, cl::NullRange, events);
+
+        reduceSums.run ();
+
+        queue.enqueueTask (solveKernel, nullptr, event);
+    }
+
+
+    /*! \details The camera parameters are the ones the fixed frame was 
+     *           back-projected with (e.g. the ones given to `ICPBackProject`).
+     *
+     *  \param[in] _fx focal length (in pixels) along the x axis.
+     *  \param[in] _fy focal length (in pixels) along the y axis.
+     *  \param[in] _cx x coordinate (in pixels) of the principal point.
+     *  \param[in] _cy y coordinate (in pixels) of the principal point.
+     */
+    void ICPPlane::setIntrinsics (float _fx, float _fy, float _cx, float _cy)
+    {
+        intrinsics = { { _fx, _fy, _cx, _cy } };
+        kernel.setArg (5, intrinsics);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (shifted) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPPlane::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (shifted) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPPlane::setScaling (float _c)
+    {
+        c = _c;
+        kernel.setArg (9, c);
+        solveKernel.setArg (3, c);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _info opencl configuration. It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPUpdateTransform::ICPUpdateTransform (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _info, StagingPool *_pool) : 
+        env (_env), info (_info), pool (_pool), 
+        context (env.getContext (info.pIdx)), 
+        queue (env.getQueue (info.ctxIdx, info.qIdx[0])), 
+        kernel (env.getProgram (info.pgIdx), "icpUpdateTransform")
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPUpdateTransform::get (ICPUpdateTransform::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPUpdateTransform::Memory::H_IN_T_K:
+                return hBufferInTk;
+            case ICPUpdateTransform::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPUpdateTransform::Memory::H_IO_C:
+                return hBufferIOC;
+            case ICPUpdateTransform::Memory::D_IN_T_K:
+                return dBufferInTk;
+            case ICPUpdateTransform::Memory::D_IO_T:
+                return dBufferIOT;
+            case ICPUpdateTransform::Memory::D_IO_C:
+                return dBufferIOC;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPUpdateTransform::init (float _angle_threshold, float _translation_threshold, Staging _staging)
+    {
+        angle_threshold = _angle_threshold;
+        translation_threshold = _translation_threshold;
+        bufferTSize = 2 * sizeof (cl_float4);
+        bufferCSize = 2 * sizeof (cl_uint);
+        staging = _staging;
+
+        // Create staging buffers
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInTk = nullptr;
+                hPtrIOT = nullptr;
+                hPtrIOC = nullptr;
+                break;
+
+            case Staging::IO:
+            case Staging::I:
+                allocStaging (hBufferInTk, bufferTSize, context, pool, lease);
+
+                hPtrInTk = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInTk, CL_FALSE, CL_MAP_WRITE, 0, bufferTSize);
+                queue.enqueueUnmapMemObject (hBufferInTk, hPtrInTk);
+
+            case Staging::O:
+                allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+                allocStaging (hBufferIOC, bufferCSize, context, pool, lease);
+
+                hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferIOT, CL_FALSE, CL_MAP_READ | CL_MAP_WRITE, 0, bufferTSize);
+                hPtrIOC = (cl_uint *) queue.enqueueMapBuffer (
+                    hBufferIOC, CL_FALSE, CL_MAP_READ | CL_MAP_WRITE, 0, bufferCSize);
+                queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+                queue.enqueueUnmapMemObject (hBufferIOC, hPtrIOC);
+                queue.finish ();
+
+                if (staging == Staging::O)
+                    hPtrInTk = nullptr;
+                break;
+        }
+
+        // Create device buffers
+        if (dBufferInTk () == nullptr)
+            dBufferInTk = cl::Buffer (context, CL_MEM_READ_ONLY, bufferTSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferIOC () == nullptr)
+            dBufferIOC = cl::Buffer (context, CL_MEM_READ_WRITE, bufferCSize);
+
+        // Set kernel arguments
+        kernel.setArg (0, dBufferInTk);
+        kernel.setArg (1, dBufferIOT);
+        kernel.setArg (2, dBufferIOC);
+        kernel.setArg (3, angle_threshold);
+        kernel.setArg (4, translation_threshold);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  \note The transformation and the convergence state are both input and output, 
+     *        so their staging buffers are available with any staging configuration 
+     *        other than `Staging::NONE`.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPUpdateTransform::write (ICPUpdateTransform::Memory mem, 
+        void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging != Staging::NONE)
+        {
+            switch (mem)
+            {
+                case ICPUpdateTransform::Memory::D_IN_T_K:
+                    if (hPtrInTk == nullptr) break;
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrInTk);
+                    queue.enqueueWriteBuffer (dBufferInTk, block, 0, bufferTSize, hPtrInTk, events, event);
+                    break;
+                case ICPUpdateTransform::Memory::D_IO_T:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    break;
+                case ICPUpdateTransform::Memory::D_IO_C:
+                    if (ptr != nullptr)
+                        std::copy ((cl_uint *) ptr, (cl_uint *) ptr + 2, hPtrIOC);
+                    queue.enqueueWriteBuffer (dBufferIOC, block, 0, bufferCSize, hPtrIOC, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPUpdateTransform::read (ICPUpdateTransform::Memory mem, 
+        bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging != Staging::NONE)
+        {
+            switch (mem)
+            {
+                case ICPUpdateTransform::Memory::H_IO_T:
+                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    return hPtrIOT;
+                case ICPUpdateTransform::Memory::H_IO_C:
+                    queue.enqueueReadBuffer (dBufferIOC, block, 0, bufferCSize, hPtrIOC, events, event);
+                    return hPtrIOC;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     */
+    void ICPUpdateTransform::run (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueTask (kernel, events, event);
+    }
+
+
+    /*! \return The threshold for the change in angle (in degrees). */
+    float ICPUpdateTransform::getAngleThreshold ()
+    {
+        return angle_threshold;
+    }
+
+
+    /*! \details Updates the kernel argument for the threshold for the change in angle.
+     *  
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees).
+     */
+    void ICPUpdateTransform::setAngleThreshold (float _angle_threshold)
+    {
+        angle_threshold = _angle_threshold;
+        kernel.setArg (3, angle_threshold);
+    }
+
+
+    /*! \return The threshold for the change in translation (in mm). */
+    float ICPUpdateTransform::getTranslationThreshold ()
+    {
+        return translation_threshold;
+    }
+
+
+    /*! \details Updates the kernel argument for the threshold for the change in translation.
+     *  
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm).
+     */
+    void ICPUpdateTransform::setTranslationThreshold (float _translation_threshold)
+    {
+        translation_threshold = _translation_threshold;
+        kernel.setArg (4, translation_threshold);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::ICPStep (clutils::CLEnv &_env, 
+        clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), trace (nullptr), 
+        fReps (env, infoICP, pool), rbcC (env, infoRBC), 
+        transform (env, infoICP, pool), retransform (env, infoICP, pool), rbcS (env, infoRBC), 
+        means (env, infoICP, pool), devs (env, infoICP, pool), 
+        matrixS (env, infoICP, pool), procrustes (env, infoICP, pool), 
+        deviceSolve (false), d (8)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::get (ICPStep::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPStep::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPStep::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPStep::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPStep::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPStep::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPStep::Memory::D_IO_T:
+                return dBufferIOT;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::init (
+        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    {
+        m = mMax = _m; nr = nrMax = _nr; a = _a; c = _c;
+        bufferFMSize = m * sizeof (cl_float8);
+        bufferTSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInF, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferFMSize, context, pool, lease);
+
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    break;
+                }
+
+            case Staging::O:
+                if (!io)
+                {
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
+                }
+                break;
+        }
+
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+
+        allocStaging (hBufferTk, bufferTSize, context, pool, lease);
+
+        hPtrTk = (cl_float *) queue.enqueueMapBuffer (
+            hBufferTk, CL_FALSE, CL_MAP_WRITE, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferTk, hPtrTk);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferTk () == nullptr)
+            dBufferTk = cl::Buffer (context, CL_MEM_READ_ONLY, bufferTSize);
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+
+        // Configure classes
+
+        // Classes in the initialization step ==================================
+        
+        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
+        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
+        fReps.init (nr, m, Staging::NONE);
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+
+        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
+        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
+        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        transform.init (m, Staging::NONE);
+
+        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
+
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
+            transform.get (ICPTransform<TC>::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
+            fReps.get (ICPReps::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+
+        // The reuse iterations transform the permuted moving set in place
+        retransform.get (ICPTransform<TC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferTk;
+        retransform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.init (m, Staging::NONE);
+
+        const ICPMeanConfig MC = ICPMeanConfig::REGULAR;
+
+        means.get (ICPMean<MC>::Memory::D_IN_F) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        means.get (ICPMean<MC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        means.get (ICPMean<MC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+        means.init (m, Staging::O);
+
+        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.init (m, Staging::NONE);
+
+        const ICPSConfig SC = ICPSConfig::REGULAR;
+
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
+        matrixS.init (m, c, Staging::O);
+
+        procrustes.get (ICPSVD::Memory::D_IN_S) = matrixS.get (ICPS<SC>::Memory::D_OUT);
+        procrustes.get (ICPSVD::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        procrustes.init (Staging::O);
+    }
+
+
+    /*! \details Reconfigures the pipeline for new numbers of landmarks and representatives, 
+     *           and retains every memory object set up by `init`. That is, it only 
+     *           updates the workspaces and kernel arguments of the classes in the pipeline, 
+     *           so that the number of landmarks can be adapted from frame to frame.
+     *  \note `init` has to have been called first, with the maximum numbers of landmarks 
+     *        and representatives the instance will be asked to handle. `resize` cannot exceed them.
+     *  \note The `RBC` classes are configured again through their `init`, which maintains 
+     *        the memory objects already assigned to them. The `RBC` data structure has to 
+     *        be rebuilt with `buildRBC`, and the next `run` has to configure the `RBC search`.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::resize (unsigned int _m, unsigned int _nr)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (_nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (_m > mMax || _nr > nrMax)
+                throw "The sets cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m; nr = _nr;
+        bufferFMSize = m * sizeof (cl_float8);
+
+        // Classes in the initialization step ==================================
+
+        fReps.resize (nr, m);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        transform.resize (m);
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+        retransform.resize (m);
+        means.resize (m);
+        devs.resize (m);
+        matrixS.resize (m);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::write (
+        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::D_IN_F:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
+                    break;
+                case ICPStep::Memory::D_IN_M:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    break;
+                case ICPStep::Memory::D_IO_T:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::read (
+        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::H_IO_T:
+                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    return hPtrIOT;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::buildRBC (
+        const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        fReps.run (events);
+        rbcC.run (nullptr, event);
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::run (
+        const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        if (trace != nullptr) trace->begin ();
+
+        if (reuse)
+        {
+            Eigen::Map<Eigen::Vector4f> (hPtrTk, 4) = qk.coeffs ();  // Quaternion
+            Eigen::Map<Eigen::Vector4f> (hPtrTk + 4, 4) = tk.homogeneous ();  // Translation
+            hPtrTk[7] = sk;  // Scale
+
+            queue.enqueueWriteBuffer (dBufferTk, CL_FALSE, 0, bufferTSize, hPtrTk, events);
+            retransform.run (nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+        }
+        else
+        {
+            transform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+            rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config);
+        }
+        means.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+        devs.run (nullptr, traceEvent (trace, ICPStage::DEVS));
+        matrixS.run (nullptr, traceEvent (trace, ICPStage::S, queue));
+        if (deviceSolve)
+            procrustes.run (nullptr, traceEvent (trace, ICPStage::SOLVE));
+
+        if (deviceSolve)
+        {
+            Tk = (cl_float *) procrustes.read (
+                ICPSVD::Memory::H_OUT_T_K, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+
+            qk = Eigen::Quaternionf (Tk);
+            Rk = Eigen::Matrix3f (qk);
+            tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+            sk = Tk[7];
+        }
+        else
+        {
+            mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::REGULAR>::Memory::H_OUT, CL_FALSE);
+            Sij = (cl_float *) matrixS.read (
+                ICPS<ICPSConfig::REGULAR>::Memory::H_OUT, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+            sk = std::sqrt (Sij[9] / Sij[10]);
+
+            mf = Eigen::Map<Eigen::Vector3f> (mean);
+            mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
+            S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
+
+            Eigen::JacobiSVD<Eigen::Matrix3f, Eigen::NoQRPreconditioner> 
+                svd (S, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+            Rk = svd.matrixV () * svd.matrixU ().transpose ();
+            if (Rk.determinant () < 0)
+            {
+                Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
+                B (2, 2) = Rk.determinant ();
+                Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+            }
+            qk = Eigen::Quaternionf (Rk);
+
+            tk = mf - sk * Rk * mm;
+        }
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = sk * Rk * t + tk;
+        s = sk * s;
+        
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        hPtrIOT[7] = s;  // Scale
+
+        cl::Event *wEvent = traceEvent (trace, ICPStage::WRITE);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, 
+                                  (wEvent != nullptr) ? wEvent : event);
+        if (wEvent != nullptr && event != nullptr) *event = *wEvent;
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::setAlpha (float _a)
+    {
+        a = _a;
+        rbcC.setAlpha (a);
+        rbcS.setAlpha (a);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::setScaling (float _c)
+    {
+        c = _c;
+        matrixS.setScaling (c);
+    }
+
+
+    /*! \return The flag for solving for the incremental transformation on the device. */
+    bool ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::getDeviceSolve ()
+    {
+        return deviceSolve;
+    }
+
+
+    /*! \details When set, `ICPSVD` computes \f$ (\dot{q}_k,t_k,s_k) \f$ on the device, right 
+     *           after the `S` matrix, and only the incremental transformation is read back. 
+     *           Otherwise, the means and the `S` matrix are read back, and the rotation 
+     *           is solved on the host with `Eigen::JacobiSVD`.
+     *
+     *  \param[in] _deviceSolve flag to indicate whether to solve for 
+     *                          the incremental transformation on the device.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::setDeviceSolve (bool _deviceSolve)
+    {
+        deviceSolve = _deviceSolve;
+    }
+
+
+    /*! \return The attached timing trace, or `nullptr` if tracing is disabled. */
+    ICPTrace* ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::getTrace ()
+    {
+        return trace;
+    }
+
+
+    /*! \details When a trace is attached, every stage of an iteration records an event, 
+     *           and `ICP::run` collects the timestamps into the trace once a registration 
+     *           is done. Pass `nullptr` to disable tracing.
+     *  \note The command queue should be created with `CL_QUEUE_PROFILING_ENABLE`.
+     *
+     *  \param[in] _trace the trace to attach, or `nullptr`.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::setTrace (ICPTrace *_trace)
+    {
+        trace = _trace;
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::ICPStep (clutils::CLEnv &_env, 
+        clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), trace (nullptr), 
+        fReps (env, infoICP, pool), rbcC (env, infoRBC), 
+        transform (env, infoICP, pool), retransform (env, infoICP, pool), rbcS (env, infoRBC), weights (env, infoICP, pool), 
+        means (env, infoICP, pool), devs (env, infoICP, pool), matrixS (env, infoICP, pool), 
+        matrixF (env, infoICP, pool), fused (false), 
+        procrustes (env, infoICP, pool), deviceSolve (false), d (8)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::get (ICPStep::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPStep::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPStep::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPStep::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPStep::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPStep::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPStep::Memory::D_IO_T:
+                return dBufferIOT;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::init (
+        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    {
+        m = mMax = _m; nr = nrMax = _nr; a = _a; c = _c;
+        bufferFMSize = m * sizeof (cl_float8);
+        bufferTSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInF, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferFMSize, context, pool, lease);
+
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    break;
+                }
+
+            case Staging::O:
+                if (!io)
+                {
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
+                }
+                break;
+        }
+
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+
+        allocStaging (hBufferTk, bufferTSize, context, pool, lease);
+
+        hPtrTk = (cl_float *) queue.enqueueMapBuffer (
+            hBufferTk, CL_FALSE, CL_MAP_WRITE, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferTk, hPtrTk);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferTk () == nullptr)
+            dBufferTk = cl::Buffer (context, CL_MEM_READ_ONLY, bufferTSize);
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+
+        // Configure classes
+
+        // Classes in the initialization step ==================================
+        
+        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
+        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
+        fReps.init (nr, m, Staging::NONE);
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+
+        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
+        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
+        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        transform.init (m, Staging::NONE);
+
+        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
+
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
+            transform.get (ICPTransform<TC>::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
+            fReps.get (ICPReps::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+
+        // The reuse iterations transform the permuted moving set in place
+        retransform.get (ICPTransform<TC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferTk;
+        retransform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.init (m, Staging::NONE);
+
+        weights.get (ICPWeights::Memory::D_IN) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN_ID);
+        weights.get (ICPWeights::Memory::D_OUT_W) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float));
+        weights.get (ICPWeights::Memory::D_OUT_SUM_W) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, sizeof (cl_double));
+        weights.init (m, Staging::NONE);
+
+        const ICPMeanConfig MC = ICPMeanConfig::WEIGHTED;
+
+        means.get (ICPMean<MC>::Memory::D_IN_F) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        means.get (ICPMean<MC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        means.get (ICPMean<MC>::Memory::D_IN_W) = 
+            weights.get (ICPWeights::Memory::D_OUT_W);
+        means.get (ICPMean<MC>::Memory::D_IN_SUM_W) = 
+            weights.get (ICPWeights::Memory::D_OUT_SUM_W);
+        means.get (ICPMean<MC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+        means.init (m, Staging::O);
+
+        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.init (m, Staging::NONE);
+
+        const ICPSConfig SC = ICPSConfig::WEIGHTED;
+
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
+        matrixS.get (ICPS<SC>::Memory::D_IN_W) = weights.get (ICPWeights::Memory::D_OUT_W);
+        matrixS.init (m, c, Staging::O);
+
+        // The fused path shares the output buffers of the regular path
+        const ICPSConfig FC = ICPSConfig::FUSED;
+
+        matrixF.get (ICPS<FC>::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        matrixF.get (ICPS<FC>::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        matrixF.get (ICPS<FC>::Memory::D_IN_W) = weights.get (ICPWeights::Memory::D_OUT_W);
+        matrixF.get (ICPS<FC>::Memory::D_IN_SUM_W) = weights.get (ICPWeights::Memory::D_OUT_SUM_W);
+        matrixF.get (ICPS<FC>::Memory::D_OUT) = matrixS.get (ICPS<SC>::Memory::D_OUT);
+        matrixF.get (ICPS<FC>::Memory::D_OUT_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        matrixF.init (m, c, Staging::NONE);
+
+        procrustes.get (ICPSVD::Memory::D_IN_S) = matrixS.get (ICPS<SC>::Memory::D_OUT);
+        procrustes.get (ICPSVD::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        procrustes.init (Staging::O);
+    }
+
+
+    /*! \details Reconfigures the pipeline for new numbers of landmarks and representatives, 
+     *           and retains every memory object set up by `init`. That is, it only 
+     *           updates the workspaces and kernel arguments of the classes in the pipeline, 
+     *           so that the number of landmarks can be adapted from frame to frame.
+     *  \note `init` has to have been called first, with the maximum numbers of landmarks 
+     *        and representatives the instance will be asked to handle. `resize` cannot exceed them.
+     *  \note The `RBC` classes are configured again through their `init`, which maintains 
+     *        the memory objects already assigned to them. The `RBC` data structure has to 
+     *        be rebuilt with `buildRBC`, and the next `run` has to configure the `RBC search`.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::resize (unsigned int _m, unsigned int _nr)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (_nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (_m > mMax || _nr > nrMax)
+                throw "The sets cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m; nr = _nr;
+        bufferFMSize = m * sizeof (cl_float8);
+
+        // Classes in the initialization step ==================================
+
+        fReps.resize (nr, m);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        transform.resize (m);
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+        retransform.resize (m);
+        weights.resize (m);
+        means.resize (m);
+        devs.resize (m);
+        matrixS.resize (m);
+        matrixF.resize (m);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::write (
+        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::D_IN_F:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
+                    break;
+                case ICPStep::Memory::D_IN_M:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    break;
+                case ICPStep::Memory::D_IO_T:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::read (
+        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::H_IO_T:
+                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    return hPtrIOT;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::buildRBC (
+        const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        fReps.run (events);
+        rbcC.run (nullptr, event);
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::run (
+        const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        if (trace != nullptr) trace->begin ();
+
+        if (reuse)
+        {
+            Eigen::Map<Eigen::Vector4f> (hPtrTk, 4) = qk.coeffs ();  // Quaternion
+            Eigen::Map<Eigen::Vector4f> (hPtrTk + 4, 4) = tk.homogeneous ();  // Translation
+            hPtrTk[7] = sk;  // Scale
+
+            queue.enqueueWriteBuffer (dBufferTk, CL_FALSE, 0, bufferTSize, hPtrTk, events);
+            retransform.run (nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+        }
+        else
+        {
+            transform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+            rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config);
+            weights.run (nullptr, traceEvent (trace, ICPStage::WEIGHTS, queue));
+        }
+        if (fused)
+            matrixF.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+        else
+        {
+            means.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+            devs.run (nullptr, traceEvent (trace, ICPStage::DEVS));
+            matrixS.run (nullptr, traceEvent (trace, ICPStage::S, queue));
+        }
+        if (deviceSolve)
+            procrustes.run (nullptr, traceEvent (trace, ICPStage::SOLVE));
+
+        if (deviceSolve)
+        {
+            Tk = (cl_float *) procrustes.read (
+                ICPSVD::Memory::H_OUT_T_K, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+
+            qk = Eigen::Quaternionf (Tk);
+            Rk = Eigen::Matrix3f (qk);
+            tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+            sk = Tk[7];
+        }
+        else
+        {
+            mean = (cl_float *) means.read (ICPMean<ICPMeanConfig::WEIGHTED>::Memory::H_OUT, CL_FALSE);
+            Sij = (cl_float *) matrixS.read (
+                ICPS<ICPSConfig::WEIGHTED>::Memory::H_OUT, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+            sk = std::sqrt (Sij[9] / Sij[10]);
+
+            mf = Eigen::Map<Eigen::Vector3f> (mean);
+            mm = Eigen::Map<Eigen::Vector3f> (mean + 4);
+            S = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, Eigen::Stride<1, 3> > (Sij);
+
+            Eigen::JacobiSVD<Eigen::Matrix3f, Eigen::NoQRPreconditioner> 
+                svd (S, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+            Rk = svd.matrixV () * svd.matrixU ().transpose ();
+            if (Rk.determinant () < 0)
+            {
+                Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
+                B (2, 2) = Rk.determinant ();
+                Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+            }
+            qk = Eigen::Quaternionf (Rk);
+
+            tk = mf - sk * Rk * mm;
+        }
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = sk * Rk * t + tk;
+        s = sk * s;
+        
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        hPtrIOT[7] = s;  // Scale
+
+        cl::Event *wEvent = traceEvent (trace, ICPStage::WRITE);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, 
+                                  (wEvent != nullptr) ? wEvent : event);
+        if (wEvent != nullptr && event != nullptr) *event = *wEvent;
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setAlpha (float _a)
+    {
+        a = _a;
+        rbcC.setAlpha (a);
+        rbcS.setAlpha (a);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setScaling (float _c)
+    {
+        c = _c;
+        matrixS.setScaling (c);
+        matrixF.setScaling (c);
+    }
+
+
+    /*! \return The flag for the fused computation of the means and the `S` matrix. */
+    bool ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getFusion ()
+    {
+        return fused;
+    }
+
+
+    /*! \details When set, `ICPS<ICPSConfig::FUSED>` replaces `ICPMean<ICPMeanConfig::WEIGHTED>`, 
+     *           `ICPDevs` and `ICPS<ICPSConfig::WEIGHTED>` in the %ICP iterations. The points 
+     *           are then read once per iteration, and the deviations are never computed.
+     *
+     *  \param[in] _fused flag to indicate whether to use the fused computation 
+     *                    of the means and the `S` matrix.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setFusion (bool _fused)
+    {
+        fused = _fused;
+    }
+
+
+    /*! \return The flag for solving for the incremental transformation on the device. */
+    bool ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getDeviceSolve ()
+    {
+        return deviceSolve;
+    }
+
+
+    /*! \details When set, `ICPSVD` computes \f$ (\dot{q}_k,t_k,s_k) \f$ on the device, right 
+     *           after the `S` matrix, and only the incremental transformation is read back. 
+     *           Otherwise, the means and the `S` matrix are read back, and the rotation 
+     *           is solved on the host with `Eigen::JacobiSVD`.
+     *
+     *  \param[in] _deviceSolve flag to indicate whether to solve for 
+     *                          the incremental transformation on the device.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setDeviceSolve (bool _deviceSolve)
+    {
+        deviceSolve = _deviceSolve;
+    }
+
+
+    /*! \return The attached timing trace, or `nullptr` if tracing is disabled. */
+    ICPTrace* ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::getTrace ()
+    {
+        return trace;
+    }
+
+
+    /*! \details When a trace is attached, every stage of an iteration records an event, 
+     *           and `ICP::run` collects the timestamps into the trace once a registration 
+     *           is done. Pass `nullptr` to disable tracing.
+     *  \note The command queue should be created with `CL_QUEUE_PROFILING_ENABLE`.
+     *
+     *  \param[in] _trace the trace to attach, or `nullptr`.
+     */
+    void ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>::setTrace (ICPTrace *_trace)
+    {
+        trace = _trace;
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::ICPStep (
+        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), trace (nullptr), 
+        fReps (env, infoICP, pool), rbcC (env, infoRBC), 
+        transform (env, infoICP, pool), retransform (env, infoICP, pool), rbcS (env, infoRBC), means (env, infoICP, pool), 
+        devs (env, infoICP, pool), matrixS (env, infoICP, pool), powMethod (env, infoICP, pool), 
+        update (env, infoICP, pool), d (8)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::get (ICPStep::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPStep::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPStep::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPStep::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPStep::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPStep::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPStep::Memory::D_IO_T:
+                return dBufferIOT;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::init (
+        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    {
+        m = mMax = _m; nr = nrMax = _nr; a = _a; c = _c;
+        bufferFMSize = m * sizeof (cl_float8);
+        bufferTSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInF, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferFMSize, context, pool, lease);
+
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    break;
+                }
+
+            case Staging::O:
+                if (!io)
+                {
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
+                }
+                break;
+        }
+
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferTk () == nullptr)
+            dBufferTk = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+
+        // Configure classes
+
+        // Classes in the initialization step ==================================
+        
+        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
+        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
+        fReps.init (nr, m, Staging::NONE);
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+
+        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
+        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
+        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        transform.init (m, Staging::NONE);
+
+        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
+
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
+            transform.get (ICPTransform<TC>::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
+            fReps.get (ICPReps::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+
+        // The reuse iterations transform the permuted moving set in place
+        retransform.get (ICPTransform<TC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferTk;
+        retransform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.init (m, Staging::NONE);
+
+        const ICPMeanConfig MC = ICPMeanConfig::REGULAR;
+
+        means.get (ICPMean<MC>::Memory::D_IN_F) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        means.get (ICPMean<MC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        means.get (ICPMean<MC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+        means.init (m, Staging::O);
+
+        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.init (m, Staging::NONE);
+
+        const ICPSConfig SC = ICPSConfig::REGULAR;
+
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
+        matrixS.get (ICPS<SC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, 11 * sizeof (cl_float));
+        matrixS.init (m, c, Staging::NONE);
+
+        powMethod.get (ICPPowerMethod::Memory::D_IN_S) = matrixS.get (ICPS<SC>::Memory::D_OUT);
+        powMethod.get (ICPPowerMethod::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        powMethod.get (ICPPowerMethod::Memory::D_OUT_T_K) = dBufferTk;
+        powMethod.init (Staging::O);
+
+        update.get (ICPUpdateTransform::Memory::D_IN_T_K) = dBufferTk;
+        update.get (ICPUpdateTransform::Memory::D_IO_T) = dBufferIOT;
+        update.init (0.001f, 0.01f, Staging::O);
+    }
+
+
+    /*! \details Reconfigures the pipeline for new numbers of landmarks and representatives, 
+     *           and retains every memory object set up by `init`. That is, it only 
+     *           updates the workspaces and kernel arguments of the classes in the pipeline, 
+     *           so that the number of landmarks can be adapted from frame to frame.
+     *  \note `init` has to have been called first, with the maximum numbers of landmarks 
+     *        and representatives the instance will be asked to handle. `resize` cannot exceed them.
+     *  \note The `RBC` classes are configured again through their `init`, which maintains 
+     *        the memory objects already assigned to them. The `RBC` data structure has to 
+     *        be rebuilt with `buildRBC`, and the next `run` has to configure the `RBC search`.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::resize (unsigned int _m, unsigned int _nr)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (_nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (_m > mMax || _nr > nrMax)
+                throw "The sets cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m; nr = _nr;
+        bufferFMSize = m * sizeof (cl_float8);
+
+        // Classes in the initialization step ==================================
+
+        fReps.resize (nr, m);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        transform.resize (m);
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+        retransform.resize (m);
+        means.resize (m);
+        devs.resize (m);
+        matrixS.resize (m);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::write (
+        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::D_IN_F:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
+                    break;
+                case ICPStep::Memory::D_IN_M:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    break;
+                case ICPStep::Memory::D_IO_T:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::read (
+        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::H_IO_T:
+                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    return hPtrIOT;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::buildRBC (
+        const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        fReps.run (events);
+        rbcC.run (nullptr, event);
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::run (
+        const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        if (trace != nullptr) trace->begin ();
+
+        if (reuse)
+            retransform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+        else
+        {
+            transform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+            rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config);
+        }
+        means.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+        devs.run (nullptr, traceEvent (trace, ICPStage::DEVS));
+        matrixS.run (nullptr, traceEvent (trace, ICPStage::S, queue));
+        powMethod.run (nullptr, traceEvent (trace, ICPStage::SOLVE));
+
+        if (trace != nullptr)
+            queue.enqueueReadBuffer ((cl::Buffer &) powMethod.get (ICPPowerMethod::Memory::D_OUT_ITER), 
+                                     CL_FALSE, 0, sizeof (cl_uint), trace->solverIterations ());
+
+        Tk = (cl_float *) powMethod.read (
+            ICPPowerMethod::Memory::H_OUT_T_K, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+
+        qk = Eigen::Quaternionf (Tk);
+        Rk = qk.toRotationMatrix ();
+        tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+        sk = Tk[7];
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = sk * Rk * t + tk;
+        s = sk * s;
+        
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        hPtrIOT[7] = s;  // Scale
+
+        cl::Event *wEvent = traceEvent (trace, ICPStage::WRITE);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, 
+                                  (wEvent != nullptr) ? wEvent : event);
+        if (wEvent != nullptr && event != nullptr) *event = *wEvent;
+    }
+
+
+    /*! \details Enqueues `iterations` %ICP iterations at once. The transformation estimation 
+     *           is composed, and the convergence check is performed, on the device, by 
+     *           `ICPUpdateTransform`. So, there are no transfers to or from the host. Once 
+     *           convergence has been flagged, the remaining iterations in the batch leave 
+     *           the transformation intact. The function call is non-blocking.
+     *  \note The host side estimation, `R`, `q`, `t`, `s`, and the incremental parameters, 
+     *        `Rk`, `qk`, `tk`, `sk`, are not updated. The convergence state should be 
+     *        zeroed, through `ICPUpdateTransform`, before the first batch of a registration.
+     *
+     *  \param[in] iterations number of iterations to enqueue.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the last kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::runBatch (
+        unsigned int iterations, const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            if (trace != nullptr) trace->begin ();
+
+            if (reuse)
+                retransform.run ((i == 0) ? events : nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+            else
+            {
+                transform.run ((i == 0) ? events : nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+                rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config && i == 0);
+            }
+            means.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+            devs.run (nullptr, traceEvent (trace, ICPStage::DEVS));
+            matrixS.run (nullptr, traceEvent (trace, ICPStage::S, queue));
+            powMethod.run (nullptr, traceEvent (trace, ICPStage::SOLVE));
+            cl::Event *uEvent = traceEvent (trace, ICPStage::UPDATE);
+            update.run (nullptr, (uEvent != nullptr) ? uEvent : ((i == iterations - 1) ? event : nullptr));
+            if (uEvent != nullptr && event != nullptr && i == iterations - 1) *event = *uEvent;
+
+            if (trace != nullptr)
+                queue.enqueueReadBuffer ((cl::Buffer &) powMethod.get (ICPPowerMethod::Memory::D_OUT_ITER), 
+                                         CL_FALSE, 0, sizeof (cl_uint), trace->solverIterations ());
+        }
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setAlpha (float _a)
+    {
+        a = _a;
+        rbcC.setAlpha (a);
+        rbcS.setAlpha (a);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setScaling (float _c)
+    {
+        c = _c;
+        matrixS.setScaling (c);
+    }
+
+
+    /*! \return The attached timing trace, or `nullptr` if tracing is disabled. */
+    ICPTrace* ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getTrace ()
+    {
+        return trace;
+    }
+
+
+    /*! \details When a trace is attached, every stage of an iteration records an event, 
+     *           and `ICP::run` collects the timestamps into the trace once a registration 
+     *           is done. Pass `nullptr` to disable tracing.
+     *  \note The command queue should be created with `CL_QUEUE_PROFILING_ENABLE`.
+     *
+     *  \param[in] _trace the trace to attach, or `nullptr`.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setTrace (ICPTrace *_trace)
+    {
+        trace = _trace;
+    }
+
+
+    /*! \return The convergence tolerance of the Power Method. */
+    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getPowerTolerance ()
+    {
+        return powMethod.getTolerance ();
+    }
+
+
+    /*! \details The Power Method stops when the distance between two consecutive 
+     *           estimates drops to `_tolerance`. Look at `ICPPowerMethod::setTolerance`.
+     *  
+     *  \param[in] _tolerance convergence tolerance.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setPowerTolerance (float _tolerance)
+    {
+        powMethod.setTolerance (_tolerance);
+    }
+
+
+    /*! \return The maximum number of Power Method iterations. */
+    unsigned int ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getPowerMaxIterations ()
+    {
+        return powMethod.getMaxIterations ();
+    }
+
+
+    /*! \details It bounds the latency of the rotation estimation in every %ICP iteration. 
+     *           Look at `ICPPowerMethod::setMaxIterations`.
+     *  
+     *  \param[in] _max_iterations maximum number of Power Method iterations.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setPowerMaxIterations (unsigned int _max_iterations)
+    {
+        powMethod.setMaxIterations (_max_iterations);
+    }
+
+
+    /*! \return The flag for warm starting the Power Method. */
+    bool ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getPowerWarmStart ()
+    {
+        return powMethod.getWarmStart ();
+    }
+
+
+    /*! \details When set, the Power Method in every %ICP iteration starts from the 
+     *           \f$ q_k \f$ of the previous one. Look at `ICPPowerMethod::setWarmStart`.
+     *  
+     *  \param[in] _warm_start flag to indicate whether to warm start the Power Method.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::setPowerWarmStart (bool _warm_start)
+    {
+        powMethod.setWarmStart (_warm_start);
+    }
+
+
+    /*! \details Reads the count back from the device. With an attached trace, 
+     *           the count of every %ICP iteration is also recorded in the trace.
+     *  \note The function call is blocking.
+     *  
+     *  \return The number of Power Method iterations of the last %ICP iteration.
+     */
+    unsigned int ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::getPowerIterations ()
+    {
+        return *((cl_uint *) powMethod.read (ICPPowerMethod::Memory::H_OUT_ITER));
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::ICPStep (
+        clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), trace (nullptr), 
+        fReps (env, infoICP, pool), rbcC (env, infoRBC), 
+        transform (env, infoICP, pool), retransform (env, infoICP, pool), rbcS (env, infoRBC), weights (env, infoICP, pool), 
+        means (env, infoICP, pool), devs (env, infoICP, pool), matrixS (env, infoICP, pool), 
+        matrixF (env, infoICP, pool), fused (false), 
+        powMethod (env, infoICP, pool), update (env, infoICP, pool), d (8)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::get (ICPStep::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPStep::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPStep::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPStep::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPStep::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPStep::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPStep::Memory::D_IO_T:
+                return dBufferIOT;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::init (
+        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    {
+        m = mMax = _m; nr = nrMax = _nr; a = _a; c = _c;
+        bufferFMSize = m * sizeof (cl_float8);
+        bufferTSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInF, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferFMSize, context, pool, lease);
+
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    break;
+                }
+
+            case Staging::O:
+                if (!io)
+                {
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
+                }
+                break;
+        }
+
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferTk () == nullptr)
+            dBufferTk = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+
+        // Configure classes
+
+        // Classes in the initialization step ==================================
+        
+        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
+        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
+        fReps.init (nr, m, Staging::NONE);
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+
+        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
+        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
+        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        transform.init (m, Staging::NONE);
+
+        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
+
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
+            transform.get (ICPTransform<TC>::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
+            fReps.get (ICPReps::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+
+        // The reuse iterations transform the permuted moving set in place
+        retransform.get (ICPTransform<TC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferTk;
+        retransform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.init (m, Staging::NONE);
+
+        weights.get (ICPWeights::Memory::D_IN) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN_ID);
+        weights.get (ICPWeights::Memory::D_OUT_W) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float));
+        weights.get (ICPWeights::Memory::D_OUT_SUM_W) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, sizeof (cl_double));
+        weights.init (m, Staging::NONE);
+
+        const ICPMeanConfig MC = ICPMeanConfig::WEIGHTED;
+
+        means.get (ICPMean<MC>::Memory::D_IN_F) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        means.get (ICPMean<MC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        means.get (ICPMean<MC>::Memory::D_IN_W) = 
+            weights.get (ICPWeights::Memory::D_OUT_W);
+        means.get (ICPMean<MC>::Memory::D_IN_SUM_W) = 
+            weights.get (ICPWeights::Memory::D_OUT_SUM_W);
+        means.get (ICPMean<MC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+        means.init (m, Staging::O);
+
+        devs.get (ICPDevs::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        devs.get (ICPDevs::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        devs.get (ICPDevs::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        devs.get (ICPDevs::Memory::D_OUT_DEV_F) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.get (ICPDevs::Memory::D_OUT_DEV_M) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float4));
+        devs.init (m, Staging::NONE);
+
+        const ICPSConfig SC = ICPSConfig::WEIGHTED;
+
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_M) = devs.get (ICPDevs::Memory::D_OUT_DEV_M);
+        matrixS.get (ICPS<SC>::Memory::D_IN_DEV_F) = devs.get (ICPDevs::Memory::D_OUT_DEV_F);
+        matrixS.get (ICPS<SC>::Memory::D_IN_W) = weights.get (ICPWeights::Memory::D_OUT_W);
+        matrixS.get (ICPS<SC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, 11 * sizeof (cl_float));
+        matrixS.init (m, c, Staging::NONE);
+
+        // The fused path shares the output buffers of the regular path
+        const ICPSConfig FC = ICPSConfig::FUSED;
+
+        matrixF.get (ICPS<FC>::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        matrixF.get (ICPS<FC>::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        matrixF.get (ICPS<FC>::Memory::D_IN_W) = weights.get (ICPWeights::Memory::D_OUT_W);
+        matrixF.get (ICPS<FC>::Memory::D_IN_SUM_W) = weights.get (ICPWeights::Memory::D_OUT_SUM_W);
+        matrixF.get (ICPS<FC>::Memory::D_OUT) = matrixS.get (ICPS<SC>::Memory::D_OUT);
+        matrixF.get (ICPS<FC>::Memory::D_OUT_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        matrixF.init (m, c, Staging::NONE);
+
+        powMethod.get (ICPPowerMethod::Memory::D_IN_S) = matrixS.get (ICPS<SC>::Memory::D_OUT);
+        powMethod.get (ICPPowerMethod::Memory::D_IN_MEAN) = means.get (ICPMean<MC>::Memory::D_OUT);
+        powMethod.get (ICPPowerMethod::Memory::D_OUT_T_K) = dBufferTk;
+        powMethod.init (Staging::O);
+
+        update.get (ICPUpdateTransform::Memory::D_IN_T_K) = dBufferTk;
+        update.get (ICPUpdateTransform::Memory::D_IO_T) = dBufferIOT;
+        update.init (0.001f, 0.01f, Staging::O);
+    }
+
+
+    /*! \details Reconfigures the pipeline for new numbers of landmarks and representatives, 
+     *           and retains every memory object set up by `init`. That is, it only 
+     *           updates the workspaces and kernel arguments of the classes in the pipeline, 
+     *           so that the number of landmarks can be adapted from frame to frame.
+     *  \note `init` has to have been called first, with the maximum numbers of landmarks 
+     *        and representatives the instance will be asked to handle. `resize` cannot exceed them.
+     *  \note The `RBC` classes are configured again through their `init`, which maintains 
+     *        the memory objects already assigned to them. The `RBC` data structure has to 
+     *        be rebuilt with `buildRBC`, and the next `run` has to configure the `RBC search`.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::resize (unsigned int _m, unsigned int _nr)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (_nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (_m > mMax || _nr > nrMax)
+                throw "The sets cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m; nr = _nr;
+        bufferFMSize = m * sizeof (cl_float8);
+
+        // Classes in the initialization step ==================================
+
+        fReps.resize (nr, m);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        transform.resize (m);
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+        retransform.resize (m);
+        weights.resize (m);
+        means.resize (m);
+        devs.resize (m);
+        matrixS.resize (m);
+        matrixF.resize (m);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::write (
+        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::D_IN_F:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
+                    break;
+                case ICPStep::Memory::D_IN_M:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    break;
+                case ICPStep::Memory::D_IO_T:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::read (
+        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::H_IO_T:
+                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    return hPtrIOT;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::buildRBC (
+        const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        fReps.run (events);
+        rbcC.run (nullptr, event);
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::run (
+        const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        if (trace != nullptr) trace->begin ();
+
+        if (reuse)
+            retransform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+        else
+        {
+            transform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+            rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config);
+            weights.run (nullptr, traceEvent (trace, ICPStage::WEIGHTS, queue));
+        }
+        if (fused)
+            matrixF.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+        else
+        {
+            means.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+            devs.run (nullptr, traceEvent (trace, ICPStage::DEVS));
+            matrixS.run (nullptr, traceEvent (trace, ICPStage::S, queue));
+        }
+        powMethod.run (nullptr, traceEvent (trace, ICPStage::SOLVE));
+
+        if (trace != nullptr)
+            queue.enqueueReadBuffer ((cl::Buffer &) powMethod.get (ICPPowerMethod::Memory::D_OUT_ITER), 
+                                     CL_FALSE, 0, sizeof (cl_uint), trace->solverIterations ());
+
+        Tk = (cl_float *) powMethod.read (
+            ICPPowerMethod::Memory::H_OUT_T_K, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+
+        qk = Eigen::Quaternionf (Tk);
+        Rk = qk.toRotationMatrix ();
+        tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+        sk = Tk[7];
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = sk * Rk * t + tk;
+        s = sk * s;
+        
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        hPtrIOT[7] = s;  // Scale
+
+        cl::Event *wEvent = traceEvent (trace, ICPStage::WRITE);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, 
+                                  (wEvent != nullptr) ? wEvent : event);
+        if (wEvent != nullptr && event != nullptr) *event = *wEvent;
+    }
+
+
+    /*! \details Enqueues `iterations` %ICP iterations at once. The transformation estimation 
+     *           is composed, and the convergence check is performed, on the device, by 
+     *           `ICPUpdateTransform`. So, there are no transfers to or from the host. Once 
+     *           convergence has been flagged, the remaining iterations in the batch leave 
+     *           the transformation intact. The function call is non-blocking.
+     *  \note The host side estimation, `R`, `q`, `t`, `s`, and the incremental parameters, 
+     *        `Rk`, `qk`, `tk`, `sk`, are not updated. The convergence state should be 
+     *        zeroed, through `ICPUpdateTransform`, before the first batch of a registration.
+     *
+     *  \param[in] iterations number of iterations to enqueue.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the last kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::runBatch (
+        unsigned int iterations, const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            if (trace != nullptr) trace->begin ();
+
+            if (reuse)
+                retransform.run ((i == 0) ? events : nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+            else
+            {
+                transform.run ((i == 0) ? events : nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+                rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config && i == 0);
+                weights.run (nullptr, traceEvent (trace, ICPStage::WEIGHTS, queue));
+            }
+            if (fused)
+                matrixF.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+            else
+            {
+                means.run (nullptr, traceEvent (trace, ICPStage::MEANS, queue));
+                devs.run (nullptr, traceEvent (trace, ICPStage::DEVS));
+                matrixS.run (nullptr, traceEvent (trace, ICPStage::S, queue));
+            }
+            powMethod.run (nullptr, traceEvent (trace, ICPStage::SOLVE));
+            cl::Event *uEvent = traceEvent (trace, ICPStage::UPDATE);
+            update.run (nullptr, (uEvent != nullptr) ? uEvent : ((i == iterations - 1) ? event : nullptr));
+            if (uEvent != nullptr && event != nullptr && i == iterations - 1) *event = *uEvent;
+
+            if (trace != nullptr)
+                queue.enqueueReadBuffer ((cl::Buffer &) powMethod.get (ICPPowerMethod::Memory::D_OUT_ITER), 
+                                         CL_FALSE, 0, sizeof (cl_uint), trace->solverIterations ());
+        }
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setAlpha (float _a)
+    {
+        a = _a;
+        rbcC.setAlpha (a);
+        rbcS.setAlpha (a);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setScaling (float _c)
+    {
+        c = _c;
+        matrixS.setScaling (c);
+        matrixF.setScaling (c);
+    }
+
+
+    /*! \return The flag for the fused computation of the means and the `S` matrix. */
+    bool ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getFusion ()
+    {
+        return fused;
+    }
+
+
+    /*! \details When set, `ICPS<ICPSConfig::FUSED>` replaces `ICPMean<ICPMeanConfig::WEIGHTED>`, 
+     *           `ICPDevs` and `ICPS<ICPSConfig::WEIGHTED>` in the %ICP iterations. The points 
+     *           are then read once per iteration, and the deviations are never computed.
+     *
+     *  \param[in] _fused flag to indicate whether to use the fused computation 
+     *                    of the means and the `S` matrix.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setFusion (bool _fused)
+    {
+        fused = _fused;
+    }
+
+
+    /*! \return The attached timing trace, or `nullptr` if tracing is disabled. */
+    ICPTrace* ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getTrace ()
+    {
+        return trace;
+    }
+
+
+    /*! \details When a trace is attached, every stage of an iteration records an event, 
+     *           and `ICP::run` collects the timestamps into the trace once a registration 
+     *           is done. Pass `nullptr` to disable tracing.
+     *  \note The command queue should be created with `CL_QUEUE_PROFILING_ENABLE`.
+     *
+     *  \param[in] _trace the trace to attach, or `nullptr`.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setTrace (ICPTrace *_trace)
+    {
+        trace = _trace;
+    }
+
+
+    /*! \return The convergence tolerance of the Power Method. */
+    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getPowerTolerance ()
+    {
+        return powMethod.getTolerance ();
+    }
+
+
+    /*! \details The Power Method stops when the distance between two consecutive 
+     *           estimates drops to `_tolerance`. Look at `ICPPowerMethod::setTolerance`.
+     *  
+     *  \param[in] _tolerance convergence tolerance.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setPowerTolerance (float _tolerance)
+    {
+        powMethod.setTolerance (_tolerance);
+    }
+
+
+    /*! \return The maximum number of Power Method iterations. */
+    unsigned int ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getPowerMaxIterations ()
+    {
+        return powMethod.getMaxIterations ();
+    }
+
+
+    /*! \details It bounds the latency of the rotation estimation in every %ICP iteration. 
+     *           Look at `ICPPowerMethod::setMaxIterations`.
+     *  
+     *  \param[in] _max_iterations maximum number of Power Method iterations.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setPowerMaxIterations (unsigned int _max_iterations)
+    {
+        powMethod.setMaxIterations (_max_iterations);
+    }
+
+
+    /*! \return The flag for warm starting the Power Method. */
+    bool ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getPowerWarmStart ()
+    {
+        return powMethod.getWarmStart ();
+    }
+
+
+    /*! \details When set, the Power Method in every %ICP iteration starts from the 
+     *           \f$ q_k \f$ of the previous one. Look at `ICPPowerMethod::setWarmStart`.
+     *  
+     *  \param[in] _warm_start flag to indicate whether to warm start the Power Method.
+     */
+    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setPowerWarmStart (bool _warm_start)
+    {
+        powMethod.setWarmStart (_warm_start);
+    }
+
+
+    /*! \details Reads the count back from the device. With an attached trace, 
+     *           the count of every %ICP iteration is also recorded in the trace.
+     *  \note The function call is blocking.
+     *  
+     *  \return The number of Power Method iterations of the last %ICP iteration.
+     */
+    unsigned int ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getPowerIterations ()
+    {
+        return *((cl_uint *) powMethod.read (ICPPowerMethod::Memory::H_OUT_ITER));
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::ICPStep (clutils::CLEnv &_env, 
+        clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), trace (nullptr), 
+        fReps (env, infoICP, pool), rbcC (env, infoRBC), 
+        transform (env, infoICP, pool), retransform (env, infoICP, pool), rbcS (env, infoRBC), 
+        plane (env, infoICP, pool), 
+        fx (595.f), fy (595.f), cx (319.5f), cy (239.5f), width (640), height (480), d (8)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::get (ICPStep::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPStep::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPStep::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPStep::Memory::H_IN_N:
+                return hBufferInN;
+            case ICPStep::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPStep::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPStep::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPStep::Memory::D_IN_N:
+                return dBufferInN;
+            case ICPStep::Memory::D_IO_T:
+                return dBufferIOT;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *  \note The normal map is expected to be \f$ 640 \times 480 \f$. 
+     *        Call `setFrameSize` before `init` to specify its dimensions.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the normal equations.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::init (
+        unsigned int _m, unsigned int _nr, float _a, float _c, Staging _staging)
+    {
+        m = mMax = _m; nr = nrMax = _nr; a = _a; c = _c;
+        bufferFMSize = m * sizeof (cl_float8);
+        bufferNSize = width * height * sizeof (cl_float4);
+        bufferTSize = 2 * sizeof (cl_float4);
+        staging = _staging;
+
+        try
+        {
+            if (m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+        
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
+                hPtrInN = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInF, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInN, bufferNSize, context, pool, lease);
+
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInN = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInN, CL_FALSE, CL_MAP_WRITE, 0, bufferNSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+                queue.enqueueUnmapMemObject (hBufferInN, hPtrInN);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    break;
+                }
+
+            case Staging::O:
+                if (!io)
+                {
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
+                    hPtrInN = nullptr;
+                }
+                break;
+        }
+
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+
+        allocStaging (hBufferTk, bufferTSize, context, pool, lease);
+
+        hPtrTk = (cl_float *) queue.enqueueMapBuffer (
+            hBufferTk, CL_FALSE, CL_MAP_WRITE, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferTk, hPtrTk);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInN () == nullptr)
+            dBufferInN = cl::Buffer (context, CL_MEM_READ_ONLY, bufferNSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferTk () == nullptr)
+            dBufferTk = cl::Buffer (context, CL_MEM_READ_ONLY, bufferTSize);
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = sk = 1.f;
+
+        // Configure classes
+
+        // Classes in the initialization step ==================================
+        
+        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
+        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
+        fReps.init (nr, m, Staging::NONE);
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+
+        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
+        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
+        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        transform.init (m, Staging::NONE);
+
+        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
+
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
+            transform.get (ICPTransform<TC>::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
+            fReps.get (ICPReps::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+
+        // The reuse iterations transform the permuted moving set in place
+        retransform.get (ICPTransform<TC>::Memory::D_IN_M) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferTk;
+        retransform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        retransform.init (m, Staging::NONE);
+
+        plane.get (ICPPlane::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        plane.get (ICPPlane::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        plane.get (ICPPlane::Memory::D_IN_N) = dBufferInN;
+        plane.init (m, width, height, c, Staging::O);
+        plane.setIntrinsics (fx, fy, cx, cy);
+    }
+
+
+    /*! \details Reconfigures the pipeline for new numbers of landmarks and representatives, 
+     *           and retains every memory object set up by `init`. That is, it only 
+     *           updates the workspaces and kernel arguments of the classes in the pipeline, 
+     *           so that the number of landmarks can be adapted from frame to frame.
+     *  \note `init` has to have been called first, with the maximum numbers of landmarks 
+     *        and representatives the instance will be asked to handle. `resize` cannot exceed them.
+     *  \note The `RBC` classes are configured again through their `init`, which maintains 
+     *        the memory objects already assigned to them. The `RBC` data structure has to 
+     *        be rebuilt with `buildRBC`, and the next `run` has to configure the `RBC search`.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::resize (unsigned int _m, unsigned int _nr)
+    {
+        try
+        {
+            if (_m == 0)
+                throw "The sets of landmarks cannot have zero points";
+
+            if (_nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (_m > mMax || _nr > nrMax)
+                throw "The sets cannot exceed the capacity set by init";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>]: " 
+                      << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        m = _m; nr = _nr;
+        bufferFMSize = m * sizeof (cl_float8);
+
+        // Classes in the initialization step ==================================
+
+        fReps.resize (nr, m);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the iteration step =======================================
+
+        transform.resize (m);
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+        retransform.resize (m);
+        plane.resize (m);
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::write (
+        ICPStep::Memory mem, void *ptr, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::I || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::D_IN_F:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
+                    break;
+                case ICPStep::Memory::D_IN_M:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                    break;
+                case ICPStep::Memory::D_IN_N:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 4 * width * height, hPtrInN);
+                    queue.enqueueWriteBuffer (dBufferInN, block, 0, bufferNSize, hPtrInN, events, event);
+                    break;
+                case ICPStep::Memory::D_IO_T:
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                    queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::read (
+        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        if (staging == Staging::O || staging == Staging::IO)
+        {
+            switch (mem)
+            {
+                case ICPStep::Memory::H_IO_T:
+                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                    return hPtrIOT;
+                default:
+                    return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+
+    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::buildRBC (
+        const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        fReps.run (events);
+        rbcC.run (nullptr, event);
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the kernel execution.
+     *  \param[in] config flag. If true, configures the `RBC search` process. 
+     *                    Set to true once, when the `RBC` data structure is reset.
+     *  \param[in] reuse flag. If true, keeps the correspondences of the previous iteration. 
+     *                   The `RBC search` is skipped, and the permuted moving set gets 
+     *                   transformed in place by the previous incremental transformation.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::run (
+        const std::vector<cl::Event> *events, cl::Event *event, bool config, bool reuse)
+    {
+        if (trace != nullptr) trace->begin ();
+
+        if (reuse)
+        {
+            Eigen::Map<Eigen::Vector4f> (hPtrTk, 4) = qk.coeffs ();  // Quaternion
+            Eigen::Map<Eigen::Vector4f> (hPtrTk + 4, 4) = tk.homogeneous ();  // Translation
+
+            queue.enqueueWriteBuffer (dBufferTk, CL_FALSE, 0, bufferTSize, hPtrTk, events);
+            retransform.run (nullptr, traceEvent (trace, ICPStage::TRANSFORM));
+        }
+        else
+        {
+            transform.run (events, traceEvent (trace, ICPStage::TRANSFORM));
+            rbcS.run (nullptr, traceEvent (trace, ICPStage::SEARCH, queue), config);
+        }
+        plane.run (nullptr, traceEvent (trace, ICPStage::SOLVE, queue));
+
+        Tk = (cl_float *) plane.read (
+            ICPPlane::Memory::H_OUT_T_K, CL_TRUE, nullptr, traceEvent (trace, ICPStage::READ));
+
+        qk = Eigen::Quaternionf (Tk);
+        Rk = Eigen::Matrix3f (qk);
+        tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = Rk * t + tk;
+        
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+
+        cl::Event *wEvent = traceEvent (trace, ICPStage::WRITE);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, 
+                                  (wEvent != nullptr) ? wEvent : event);
+        if (wEvent != nullptr && event != nullptr) *event = *wEvent;
+    }
+
+
+    /*! \details The normal map has to have the dimensions of 
+     *           the frame the fixed set was sampled from.
+     *  \note It has to be called before `init`, which allocates the buffers for the normal map.
+     *
+     *  \param[in] _width width (in pixels) of the normal map.
+     *  \param[in] _height height (in pixels) of the normal map.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::setFrameSize (
+        unsigned int _width, unsigned int _height)
+    {
+        width = _width; height = _height;
+    }
+
+
+    /*! \details The camera parameters are the ones the fixed frame was back-projected with. 
+     *           They are used to look up the normals of the fixed points in the normal map.
+     *           It can be called either before or after `init`.
+     *
+     *  \param[in] _fx focal length (in pixels) along the x axis.
+     *  \param[in] _fy focal length (in pixels) along the y axis.
+     *  \param[in] _cx x coordinate (in pixels) of the principal point.
+     *  \param[in] _cy y coordinate (in pixels) of the principal point.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::setIntrinsics (
+        float _fx, float _fy, float _cx, float _cy)
+    {
+        fx = _fx; fy = _fy; cx = _cx; cy = _cy;
+        plane.setIntrinsics (fx, fy, cx, cy);
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    float ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::setAlpha (float _a)
+    {
+        a = _a;
+        rbcC.setAlpha (a);
+        rbcS.setAlpha (a);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (shifted) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling factor c.
+     *  \note The scaling factor c multiplies the points (shifted) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \param[in] _c scaling factor.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::setScaling (float _c)
+    {
+        c = _c;
+        plane.setScaling (c);
+    }
+
+
+    /*! \return The attached timing trace, or `nullptr` if tracing is disabled. */
+    ICPTrace* ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::getTrace ()
+    {
+        return trace;
+    }
+
+
+    /*! \details When a trace is attached, every stage of an iteration records an event, 
+     *           and `ICP::run` collects the timestamps into the trace once a registration 
+     *           is done. Pass `nullptr` to disable tracing.
+     *  \note The command queue should be created with `CL_QUEUE_PROFILING_ENABLE`.
+     *
+     *  \param[in] _trace the trace to attach, or `nullptr`.
+     */
+    void ICPStep<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>::setTrace (ICPTrace *_trace)
+    {
+        trace = _trace;
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICP<CR, CW>::ICP (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        ICPStep<CR, CW>::ICPStep (_env, _infoRBC, _infoICP, _pool), batch_size (8), 
+        reuse_angle_threshold (0.0), reuse_translation_threshold (0.0)
+    {
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::init (unsigned int _m, unsigned int _nr, float _a, float _c, unsigned int _max_iterations, 
+        double _angle_threshold, double _translation_threshold, Staging _staging)
+    {
+        max_iterations = _max_iterations;
+        angle_threshold = _angle_threshold;
+        translation_threshold = _translation_threshold;
+
+        ICPStep<CR, CW>::init (_m, _nr, _a, _c, _staging);
+    }
+
+
+    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::buildRBC (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        ICPStep<CR, CW>::buildRBC (events, event);
+        k = 0;
+    }
+
+
+    /*! \details Executes the iterative ICP algorithm and estimates the 
+     *           relative transformation between the two associated point clouds.
+     *           When the change in the transformation falls below the reuse thresholds, 
+     *           the next iteration keeps the correspondences, and skips the `RBC search`. 
+     *           A registration doesn't converge on reused correspondences, though. 
+     *           It performs one more iteration with a full search first.
+     *  \note The function call is blocking, so it doesn't need to offer an event. 
+     *        It also doesn't accept events, since it's meant to be called after 
+     *        `buildRBC` which is the one that will wait on the events.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::run ()
+    {
+        ICPStep<CR, CW>::run (nullptr, nullptr, true);
+        
+        bool reuse = false;
+        while (true)
+        {
+            bool converged = !check ();
+            if (converged && (!reuse || k == max_iterations)) break;
+
+            reuse = !converged && reusable ();
+            ICPStep<CR, CW>::run (nullptr, nullptr, false, reuse);
+        }
+        
+        this->queue.finish ();
+
+        if (this->trace != nullptr)
+            this->trace->end ((k == max_iterations) ? 
+                ICPConvergence::MAX_ITERATIONS : ICPConvergence::THRESHOLD, k);
+    }
+
+
+    /*! \details Enqueues the iterations in batches of `batch_size`, and reads back the 
+     *           convergence state after each batch. The transformation update and the 
+     *           convergence check are performed on the device. It's shared by the 
+     *           `POWER_METHOD` configurations.
+     *  \note It's a template, so that it's only instantiated by the configurations 
+     *        that call it. The other ones don't have a device side convergence check.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    template <ICPStepConfigT T>
+    void ICP<CR, CW>::runBatched ()
+    {
+        cl_uint C0[2] = { 0, 0 };
+        this->update.setAngleThreshold (angle_threshold);
+        this->update.setTranslationThreshold (translation_threshold);
+        this->update.write (ICPUpdateTransform::Memory::D_IO_C, C0);
+
+        unsigned int enqueued = 0;
+        bool reuse = false;
+        cl_uint *C;
+        while (true)
+        {
+            unsigned int iterations = std::min (std::max (batch_size, 1U), max_iterations - enqueued);
+            this->runBatch (iterations, nullptr, nullptr, enqueued == 0, reuse);
+            enqueued += iterations;
+
+            C = (cl_uint *) this->update.read (ICPUpdateTransform::Memory::H_IO_C, 
+                CL_TRUE, nullptr, traceEvent (this->trace, ICPStage::READ));
+            if (enqueued >= max_iterations) break;
+
+            if (C[0] != 0)
+            {
+                if (!reuse) break;
+
+                // Don't converge on reused correspondences
+                C0[1] = C[1];
+                this->update.write (ICPUpdateTransform::Memory::D_IO_C, C0);
+                reuse = false;
+            }
+            else if (reuse_angle_threshold > 0.0 && reuse_translation_threshold > 0.0)
+            {
+                this->Tk = (cl_float *) this->powMethod.read (ICPPowerMethod::Memory::H_OUT_T_K);
+                this->qk = Eigen::Quaternionf (this->Tk);
+                this->tk = Eigen::Map<Eigen::Vector3f> (this->Tk + 4, 3);
+                reuse = reusable ();
+            }
+        }
+
+        k = C[1];
+
+        // Synchronize the host side estimation
+        this->queue.enqueueReadBuffer (this->dBufferIOT, CL_TRUE, 0, this->bufferTSize, this->hPtrIOT);
+        this->q = Eigen::Quaternionf (this->hPtrIOT);
+        this->R = this->q.toRotationMatrix ();
+        this->t = Eigen::Map<Eigen::Vector3f> (this->hPtrIOT + 4, 3);
+        this->s = this->hPtrIOT[7];
+
+        if (this->trace != nullptr)
+            this->trace->end ((C[0] != 0) ? 
+                ICPConvergence::THRESHOLD : ICPConvergence::MAX_ITERATIONS, k);
+    }
+
+
+    /*! \details Executes the iterative ICP algorithm and estimates the 
+     *           relative transformation between the two associated point clouds.
+     *           The iterations are enqueued in batches of `batch_size`, and the 
+     *           transformation update and the convergence check are performed on 
+     *           the device. After each batch, only the convergence state is read 
+     *           back. The final transformation is read back once, at the end.
+     *           If the reuse thresholds are set, the last incremental transformation 
+     *           of a batch is read back too. When it falls below them, the next batch 
+     *           keeps the correspondences, and skips the `RBC search`. A batch that 
+     *           converges on reused correspondences is followed by one with full searches.
+     *  \note The function call is blocking, so it doesn't need to offer an event. 
+     *        It also doesn't accept events, since it's meant to be called after 
+     *        `buildRBC` which is the one that will wait on the events.
+     */
+    template <>
+    void ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>::run ()
+    {
+        runBatched ();
+    }
+
+
+    /*! \details Executes the iterative ICP algorithm and estimates the 
+     *           relative transformation between the two associated point clouds.
+     *           The iterations are enqueued in batches of `batch_size`, and the 
+     *           transformation update and the convergence check are performed on 
+     *           the device. After each batch, only the convergence state is read 
+     *           back. The final transformation is read back once, at the end.
+     *           If the reuse thresholds are set, the last incremental transformation 
+     *           of a batch is read back too. When it falls below them, the next batch 
+     *           keeps the correspondences, and skips the `RBC search`. A batch that 
+     *           converges on reused correspondences is followed by one with full searches.
+     *  \note The function call is blocking, so it doesn't need to offer an event. 
+     *        It also doesn't accept events, since it's meant to be called after 
+     *        `buildRBC` which is the one that will wait on the events.
+     */
+    template <>
+    void ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::run ()
+    {
+        runBatched ();
+    }
+
+
+    /*! \details Checks the change in the transformation and the number of iterations.
+     *  \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     *        
+     *  \return `false` for convergence, `true` otherwise.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    inline bool ICP<CR, CW>::check ()
+    {
+        k++;
+        double delta_angle = 180.0 / M_PI * 2.0 * std::atan2 (this->qk.vec ().norm (), this->qk.w ());  // in degrees
+        double delta_tanslation = this->tk.norm ();  // in mm
+
+        if (k == max_iterations) return false;
+        if (delta_angle < angle_threshold && delta_tanslation < translation_threshold) return false;
+
+        return true;
+    }
+
+
+    /*! \details Checks the last incremental transformation against the reuse thresholds.
+     *        
+     *  \return `true` if the next iteration can reuse the correspondences, `false` otherwise.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    inline bool ICP<CR, CW>::reusable ()
+    {
+        double delta_angle = 180.0 / M_PI * 2.0 * std::atan2 (this->qk.vec ().norm (), this->qk.w ());  // in degrees
+        double delta_tanslation = this->tk.norm ();  // in mm
+
+        return delta_angle < reuse_angle_threshold && delta_tanslation < reuse_translation_threshold;
+    }
+
+
+    /*! \return The maximum number of iterations. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    unsigned int ICP<CR, CW>::getMaxIterations ()
+    {
+        return max_iterations;
+    }
+
+
+    /*! \details Updates the parameter for the maximum number of iterations.
+     *  
+     *  \param[in] _max_iterations maximum number of iterations.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::setMaxIterations (unsigned int _max_iterations)
+    {
+        max_iterations = _max_iterations;
+    }
+
+
+    /*! \return The threshold for the change in angle (in degrees). */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    double ICP<CR, CW>::getAngleThreshold ()
+    {
+        return angle_threshold;
+    }
+
+
+    /*! \details Updates the parameter for the threshold for the change 
+     *           in angle (in degrees) in the transformation.
+     *  
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::setAngleThreshold (double _angle_threshold)
+    {
+        angle_threshold = _angle_threshold;
+    }
+
+
+    /*! \return The threshold for the change in translation (in mm). */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    double ICP<CR, CW>::getTranslationThreshold ()
+    {
+        return translation_threshold;
+    }
+
+
+    /*! \details Updates the parameter for the threshold for the change 
+     *           in translation (in mm) in the transformation.
+     *  
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::setTranslationThreshold (double _translation_threshold)
+    {
+        translation_threshold = _translation_threshold;
+    }
+
+
+    /*! \return The number of iterations enqueued between convergence checks. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    unsigned int ICP<CR, CW>::getBatchSize ()
+    {
+        return batch_size;
+    }
+
+
+    /*! \details Updates the number of iterations that are enqueued at once, 
+     *           before the convergence flag gets read back.
+     *  \note It is only used by the `POWER_METHOD` configurations. A larger batch 
+     *        saves host-device synchronization points, at the cost of some redundant 
+     *        iterations after convergence.
+     *  
+     *  \param[in] _batch_size number of iterations per batch.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::setBatchSize (unsigned int _batch_size)
+    {
+        batch_size = _batch_size;
+    }
+
+
+    /*! \return The bound on the change in angle (in degrees) for reusing the correspondences. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    double ICP<CR, CW>::getReuseAngleThreshold ()
+    {
+        return reuse_angle_threshold;
+    }
+
+
+    /*! \details Updates the bound on the change in angle (in degrees), below which 
+     *           the next iteration reuses the correspondences of the previous one, 
+     *           instead of performing the `RBC search`.
+     *  \note Reuse is enabled only when both reuse thresholds are positive. They should 
+     *        be larger than the convergence thresholds. Otherwise, they never take effect.
+     *  
+     *  \param[in] _reuse_angle_threshold bound on the change in angle (in degrees).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::setReuseAngleThreshold (double _reuse_angle_threshold)
+    {
+        reuse_angle_threshold = _reuse_angle_threshold;
+    }
+
+
+    /*! \return The bound on the change in translation (in mm) for reusing the correspondences. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    double ICP<CR, CW>::getReuseTranslationThreshold ()
+    {
+        return reuse_translation_threshold;
+    }
+
+
+    /*! \details Updates the bound on the change in translation (in mm), below which 
+     *           the next iteration reuses the correspondences of the previous one, 
+     *           instead of performing the `RBC search`.
+     *  \note Reuse is enabled only when both reuse thresholds are positive. They should 
+     *        be larger than the convergence thresholds. Otherwise, they never take effect.
+     *  
+     *  \param[in] _reuse_translation_threshold bound on the change in translation (in mm).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICP<CR, CW>::setReuseTranslationThreshold (double _reuse_translation_threshold)
+    {
+        reuse_translation_threshold = _reuse_translation_threshold;
+    }
+
+
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors.  */
+    template class ICP<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
+    template class ICP<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors.   */
+    template class ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors.  */
+    template class ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that minimizes the point-to-plane error, and considers regular residual errors.     */
+    template class ICP<ICPStepConfigT::POINT_TO_PLANE, ICPStepConfigW::REGULAR>;
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPBatch::ICPBatch (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
+        repsKernel (env.getProgram (infoICP.pgIdx), "getReps"), 
+        transformKernel (env.getProgram (infoICP.pgIdx), "icpTransform_Quaternion"), 
+        meanKernel (env.getProgram (infoICP.pgIdx), "icpMean"), 
+        groupMeanKernel (env.getProgram (infoICP.pgIdx), "icpGMean"), 
+        devsKernel (env.getProgram (infoICP.pgIdx), "icpSubtractMean"), 
+        sijKernel (env.getProgram (infoICP.pgIdx), "icpSijProducts"), 
+        powMethodKernel (env.getProgram (infoICP.pgIdx), "icpPowerMethod"), 
+        updateKernel (env.getProgram (infoICP.pgIdx), "icpUpdateTransform"), 
+        reduceSij (env, infoICP, pool), d (8), batch_size (8), 
+        power_tolerance (0.f), power_max_iterations (2000), power_warm_start (false)
+    {
+        wgMultiple = getWorkGroupMultiple (meanKernel, env.devices[infoICP.pIdx][infoICP.dIdx]);
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPBatch::get (ICPBatch::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPBatch::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPBatch::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPBatch::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPBatch::Memory::H_IO_C:
+                return hBufferIOC;
+            case ICPBatch::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPBatch::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPBatch::Memory::D_IO_T:
+                return dBufferIOT;
+            case ICPBatch::Memory::D_IO_C:
+                return dBufferIOC;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of points in each set. The landmarks are expected 
+     *                to be extracted by `ICPLMs`, so it should be a power of 2, e.g. \f$ 128*128 \f$.
+     *  \param[in] _nr number of fixed set representatives per pair.
+     *  \param[in] _k number of pairs of sets.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrices.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    void ICPBatch::init (unsigned int _m, unsigned int _nr, unsigned int _k, float _a, float _c, 
+        unsigned int _max_iterations, double _angle_threshold, double _translation_threshold, Staging _staging)
+    {
+        m = _m; nr = _nr; k = _k; a = _a; c = _c;
+        max_iterations = _max_iterations;
+        angle_threshold = _angle_threshold;
+        translation_threshold = _translation_threshold;
+        bufferFMSize = k * m * sizeof (cl_float8);
+        bufferTSize = k * 2 * sizeof (cl_float4);
+        bufferCSize = k * 2 * sizeof (cl_uint);
+        staging = _staging;
+
+        // Establish the number of work-groups per row
+        wgXdim = std::ceil (m / (float) (2 * wgMultiple));
+
+        cl_uint align = env.devices[infoICP.pIdx][infoICP.dIdx].getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN> () / 8;
+
+        try
+        {
+            if (m == 0 || (m & (m - 1)))
+                throw "The number of landmarks in each set has to be a power of 2";
+
+            if (nr > m)
+                throw "The number of representatives cannot exceed the number of landmarks";
+
+            if (nr == 0 || nr % 4)
+                throw "The number of representatives has to be a non-zero multiple of 4";
+
+            if (k == 0)
+                throw "The batch cannot have zero pairs of sets";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+
+            // (2 * wgMultiple) points per work-group
+            // (2 * wgMultiple) work-groups maximum
+            if (m > std::pow (2 * wgMultiple, 2))
+                throw "The device does not support the mean computation on sets of that size";
+
+            if ((m * sizeof (cl_float8)) % align || (nr * sizeof (cl_float8)) % align)
+                throw "The sets are not aligned to the device base address alignment";
+            if (!matchesSpecialization (env, infoICP, _m, _c))
+                throw "The program is specialized for a different number of points or scaling factor";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPBatch]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        unsigned int n = m;
+        if (n % 4) n += 4 - n % 4;
+        n /= 4;
+
+        // e.g. nr = 32 -> nrx = 8, nry = 4
+        int p = std::log2 (nr);
+        unsigned int nrx = std::pow (2, p - p / 2);
+        unsigned int nry = std::pow (2, p / 2);
+
+        // e.g. m = 16384 -> lx = 128, ly = 128
+        p = std::log2 (m);
+        cl_uint lx = std::pow (2, p - p / 2);
+        cl_uint ly = std::pow (2, p / 2);
+
+        // Set workspaces
+        globalR = cl::NDRange (nrx, nry, k);
+        globalT = cl::NDRange (2, m, k);
+        globalM = cl::NDRange (wgXdim * wgMultiple, 2, k);
+        globalGM = cl::NDRange (wgMultiple, 2, k);
+        localM = cl::NDRange (wgMultiple, 1, 1);
+        globalD = cl::NDRange (m, 2, k);
+        globalS = cl::NDRange (n, k);
+        globalP = cl::NDRange (k);
+
+        // Create staging buffers
+        bool io = false;
+        switch (staging)
+        {
+            case Staging::NONE:
+                hPtrInF = nullptr;
+                hPtrInM = nullptr;
+                break;
+
+            case Staging::IO:
+                io = true;
+
+            case Staging::I:
+                allocStaging (hBufferInF, bufferFMSize, context, pool, lease);
+                allocStaging (hBufferInM, bufferFMSize, context, pool, lease);
+
+                hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+                    hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, bufferFMSize);
+                queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+                queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+
+                if (!io)
+                {
+                    queue.finish ();
+                    break;
+                }
+
+            case Staging::O:
+                if (!io)
+                {
+                    hPtrInF = nullptr;
+                    hPtrInM = nullptr;
+                }
+                break;
+        }
+
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+        allocStaging (hBufferIOC, bufferCSize, context, pool, lease);
+
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ | CL_MAP_WRITE, 0, bufferTSize);
+        hPtrIOC = (cl_uint *) queue.enqueueMapBuffer (
+            hBufferIOC, CL_FALSE, CL_MAP_READ | CL_MAP_WRITE, 0, bufferCSize);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+        queue.enqueueUnmapMemObject (hBufferIOC, hPtrIOC);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_ONLY, bufferFMSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        if (dBufferIOC () == nullptr)
+            dBufferIOC = cl::Buffer (context, CL_MEM_READ_WRITE, bufferCSize);
+
+        dBufferR = cl::Buffer (context, CL_MEM_READ_WRITE, k * nr * sizeof (cl_float8));
+        dBufferTM = cl::Buffer (context, CL_MEM_READ_WRITE, bufferFMSize);
+        dBufferNN = cl::Buffer (context, CL_MEM_READ_WRITE, bufferFMSize);
+        dBufferQP = cl::Buffer (context, CL_MEM_READ_WRITE, bufferFMSize);
+        if (wgXdim != 1)
+            dBufferGM = cl::Buffer (context, CL_MEM_READ_WRITE, k * 2 * wgXdim * sizeof (cl_float4));
+        dBufferMean = cl::Buffer (context, CL_MEM_READ_WRITE, k * 2 * sizeof (cl_float4));
+        dBufferDevF = cl::Buffer (context, CL_MEM_READ_WRITE, k * m * sizeof (cl_float4));
+        dBufferDevM = cl::Buffer (context, CL_MEM_READ_WRITE, k * m * sizeof (cl_float4));
+        dBufferSij = cl::Buffer (context, CL_MEM_READ_WRITE, k * 11 * n * sizeof (cl_float));
+        dBufferS = cl::Buffer (context, CL_MEM_READ_WRITE, k * 11 * sizeof (cl_float));
+        dBufferTk = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        dBufferIter = cl::Buffer (context, CL_MEM_READ_WRITE, k * sizeof (cl_uint));
+
+        // Load initial identity transformations
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        for (unsigned int i = 0; i < k; ++i)
+            std::copy (T0, T0 + 8, hPtrIOT + i * 8);
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        // Set kernel arguments
+        repsKernel.setArg (0, dBufferInF);
+        repsKernel.setArg (1, dBufferR);
+        repsKernel.setArg (2, lx);
+        repsKernel.setArg (3, ly);
+
+        transformKernel.setArg (0, dBufferInM);
+        transformKernel.setArg (1, dBufferTM);
+        transformKernel.setArg (2, dBufferIOT);
+
+        meanKernel.setArg (0, dBufferNN);
+        meanKernel.setArg (1, dBufferQP);
+        meanKernel.setArg (2, (wgXdim == 1) ? dBufferMean : dBufferGM);
+        meanKernel.setArg (3, cl::Local (localM[0] * 6 * sizeof (cl_float)));
+        meanKernel.setArg (4, m);
+
+        if (wgXdim != 1)
+        {
+            groupMeanKernel.setArg (0, dBufferGM);
+            groupMeanKernel.setArg (1, dBufferMean);
+            groupMeanKernel.setArg (2, cl::Local (localM[0] * 6 * sizeof (cl_float)));
+            groupMeanKernel.setArg (3, (cl_uint) wgXdim);
+        }
+
+        devsKernel.setArg (0, dBufferNN);
+        devsKernel.setArg (1, dBufferQP);
+        devsKernel.setArg (2, dBufferDevF);
+        devsKernel.setArg (3, dBufferDevM);
+        devsKernel.setArg (4, dBufferMean);
+
+        sijKernel.setArg (0, dBufferDevM);
+        sijKernel.setArg (1, dBufferDevF);
+        sijKernel.setArg (2, dBufferSij);
+        sijKernel.setArg (3, m);
+        sijKernel.setArg (4, c);
+
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_IN) = dBufferSij;
+        reduceSij.get (Reduce<ReduceConfig::SUM, cl_float>::Memory::D_OUT) = dBufferS;
+        reduceSij.init (n, 11 * k, Staging::NONE);
+
+        powMethodKernel.setArg (0, dBufferS);
+        powMethodKernel.setArg (1, dBufferMean);
+        powMethodKernel.setArg (2, dBufferTk);
+        powMethodKernel.setArg (3, dBufferIter);
+        powMethodKernel.setArg (4, power_tolerance);
+        powMethodKernel.setArg (5, (cl_uint) power_max_iterations);
+        powMethodKernel.setArg (6, (cl_uint) power_warm_start);
+
+        updateKernel.setArg (0, dBufferTk);
+        updateKernel.setArg (1, dBufferIOT);
+        updateKernel.setArg (2, dBufferIOC);
+        updateKernel.setArg (3, (cl_float) angle_threshold);
+        updateKernel.setArg (4, (cl_float) translation_threshold);
+
+        // Configure the RBC classes on the sub-buffers of each pair
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S1 = RBC::KernelTypeS::KINECT;
+
+        rbcC.clear (); rbcC.reserve (k);
+        rbcS.clear (); rbcS.reserve (k);
+
+        for (unsigned int i = 0; i < k; ++i)
+        {
+            cl_buffer_region rFM = { i * m * sizeof (cl_float8), m * sizeof (cl_float8) };
+            cl_buffer_region rR = { i * nr * sizeof (cl_float8), nr * sizeof (cl_float8) };
+
+            cl::Buffer dBufferR_i = dBufferR.createSubBuffer (
+                CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &rR);
+
+            rbcC.emplace_back (env, infoRBC);
+            rbcC[i].get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = 
+                dBufferInF.createSubBuffer (CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &rFM);
+            rbcC[i].get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = dBufferR_i;
+            rbcC[i].init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+            rbcS.emplace_back (env, infoRBC);
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_IN_Q) = 
+                dBufferTM.createSubBuffer (CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &rFM);
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_IN_R) = dBufferR_i;
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_IN_X_P) = 
+                rbcC[i].get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_IN_O) = 
+                rbcC[i].get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_IN_N) = 
+                rbcC[i].get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_OUT_NN) = 
+                dBufferNN.createSubBuffer (CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &rFM);
+            rbcS[i].get (RBC::RBCSearch<K1, P1, S1>::Memory::D_OUT_Q_P) = 
+                dBufferQP.createSubBuffer (CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &rFM);
+            rbcS[i].init (m, nr, m, a, RBC::Staging::NONE);
+        }
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  \note The transformations and the convergence states are both input and output, 
+     *        so their staging buffers are available with any staging configuration.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
+     */
+    void ICPBatch::write (ICPBatch::Memory mem, void *ptr, bool block, 
+                          const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        switch (mem)
+        {
+            case ICPBatch::Memory::D_IN_F:
+                if (staging == Staging::I || staging == Staging::IO)
+                {
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + k * m * d, hPtrInF);
+                    queue.enqueueWriteBuffer (dBufferInF, block, 0, bufferFMSize, hPtrInF, events, event);
+                }
+                break;
+            case ICPBatch::Memory::D_IN_M:
+                if (staging == Staging::I || staging == Staging::IO)
+                {
+                    if (ptr != nullptr)
+                        std::copy ((cl_float *) ptr, (cl_float *) ptr + k * m * d, hPtrInM);
+                    queue.enqueueWriteBuffer (dBufferInM, block, 0, bufferFMSize, hPtrInM, events, event);
+                }
+                break;
+            case ICPBatch::Memory::D_IO_T:
+                if (ptr != nullptr)
+                    std::copy ((cl_float *) ptr, (cl_float *) ptr + k * 8, hPtrIOT);
+                queue.enqueueWriteBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                break;
+            case ICPBatch::Memory::D_IO_C:
+                if (ptr != nullptr)
+                    std::copy ((cl_uint *) ptr, (cl_uint *) ptr + k * 2, hPtrIOC);
+                queue.enqueueWriteBuffer (dBufferIOC, block, 0, bufferCSize, hPtrIOC, events, event);
+                break;
+            default:
+                break;
+        }
+    }
+
+
+    /*! \details The transfer happens from a device buffer to the associated 
+     *           (specified) staging buffer on the host.
+     *  
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the read operation to the staging buffer.
+     */
+    void* ICPBatch::read (ICPBatch::Memory mem, bool block, 
+                          const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        switch (mem)
+        {
+            case ICPBatch::Memory::H_IO_T:
+                queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
+                return hPtrIOT;
+            case ICPBatch::Memory::H_IO_C:
+                queue.enqueueReadBuffer (dBufferIOC, block, 0, bufferCSize, hPtrIOC, events, event);
+                return hPtrIOC;
+            default:
+                return nullptr;
+        }
+    }
+
+
+    /*! \details The representatives of all the fixed sets are extracted in one 
+     *           kernel launch. The `RBC` data structures are then built per pair.
+     *  \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    void ICPBatch::buildRBC (const std::vector<cl::Event> *events, cl::Event *event)
+    {
+        queue.enqueueNDRangeKernel (repsKernel, cl::NullRange, globalR, cl::NullRange, events);
+
+        for (unsigned int i = 0; i < k; ++i)
+            rbcC[i].run (nullptr, (i == k - 1) ? event : nullptr);
+    }
+
+
+    /*! \details Executes the iterative ICP algorithm on all the pairs of sets, and 
+     *           estimates their relative transformations. The iterations are enqueued 
+     *           in batches of `batch_size`. After each batch, only the convergence 
+     *           states are read back. The registration stops when all the pairs have 
+     *           converged, or when the maximum number of iterations has been reached. 
+     *           The final transformations are read back at once, at the end, in `hPtrIOT`. 
+     *           The convergence flag and the number of iterations performed on each 
+     *           pair are available in `hPtrIOC`.
+     *  \note The function call is blocking, so it doesn't need to offer an event. 
+     *        It also doesn't accept events, since it's meant to be called after 
+     *        `buildRBC` which is the one that will wait on the events.
+     */
+    void ICPBatch::run ()
+    {
+        std::fill (hPtrIOC, hPtrIOC + 2 * k, 0);
+        queue.enqueueWriteBuffer (dBufferIOC, CL_FALSE, 0, bufferCSize, hPtrIOC);
+
+        unsigned int enqueued = 0;
+        unsigned int converged;
+        do
+        {
+            unsigned int iterations = std::min (std::max (batch_size, 1U), max_iterations - enqueued);
+            runBatch (iterations, enqueued == 0);
+            enqueued += iterations;
+
+            queue.enqueueReadBuffer (dBufferIOC, CL_TRUE, 0, bufferCSize, hPtrIOC);
+
+            converged = 0;
+            for (unsigned int i = 0; i < k; ++i)
+                if (hPtrIOC[i * 2]) ++converged;
+        } while (converged < k && enqueued < max_iterations);
+
+        queue.enqueueReadBuffer (dBufferIOT, CL_TRUE, 0, bufferTSize, hPtrIOT);
+    }
+
+
+    /*! \details The function call is non-blocking.
+     *
+     *  \param[in] iterations number of iterations to enqueue.
+     *  \param[in] config flag. If true, configures the `RBC search` processes. 
+     *                    Set to true once, when the `RBC` data structures are reset.
+     */
+    void ICPBatch::runBatch (unsigned int iterations, bool config)
+    {
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            queue.enqueueNDRangeKernel (transformKernel, cl::NullRange, globalT, cl::NullRange);
+
+            for (auto &search : rbcS)
+                search.run (nullptr, nullptr, config && i == 0);
+
+            queue.enqueueNDRangeKernel (meanKernel, cl::NullRange, globalM, localM);
+            if (wgXdim != 1)
+                queue.enqueueNDRangeKernel (groupMeanKernel, cl::NullRange, globalGM, localM);
+            queue.enqueueNDRangeKernel (devsKernel, cl::NullRange, globalD, cl::NullRange);
+            queue.enqueueNDRangeKernel (sijKernel, cl::NullRange, globalS, cl::NullRange);
+            reduceSij.run ();
+            queue.enqueueNDRangeKernel (powMethodKernel, cl::NullRange, globalP, cl::NullRange);
+            queue.enqueueNDRangeKernel (updateKernel, cl::NullRange, globalP, cl::NullRange);
+        }
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    float ICPBatch::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    void ICPBatch::setAlpha (float _a)
+    {
+        a = _a;
+        for (auto &construct : rbcC) construct.setAlpha (a);
+        for (auto &search : rbcS) search.setAlpha (a);
+    }
+
+
+    /*! \note The scaling factor c multiplies the points (deviations) before processing
+     *        in order to deal with floating point arithmetic issues.
+     *  
+     *  \return The scaling factor c.
+     */
+    float ICPBatch::getScaling ()
+    {
+        return c;
+    }
+
+
+    /*! \details Updates the kernel argument for the scaling factor c.
+     *
+     *  \param[in] _c scaling factor.
+     */
+    void ICPBatch::setScaling (float _c)
+    {
+        c = _c;
+        sijKernel.setArg (4, c);
+    }
+
+
+    /*! \return The maximum number of iterations. */
+    unsigned int ICPBatch::getMaxIterations ()
+    {
+        return max_iterations;
+    }
+
+
+    /*! \param[in] _max_iterations maximum number of iterations. */
+    void ICPBatch::setMaxIterations (unsigned int _max_iterations)
+    {
+        max_iterations = _max_iterations;
+    }
+
+
+    /*! \return The threshold for the change in angle (in degrees). */
+    double ICPBatch::getAngleThreshold ()
+    {
+        return angle_threshold;
+    }
+
+
+    /*! \details Updates the kernel argument for the angle threshold.
+     *
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees).
+     */
+    void ICPBatch::setAngleThreshold (double _angle_threshold)
+    {
+        angle_threshold = _angle_threshold;
+        updateKernel.setArg (3, (cl_float) angle_threshold);
+    }
+
+
+    /*! \return The threshold for the change in translation (in mm). */
+    double ICPBatch::getTranslationThreshold ()
+    {
+        return translation_threshold;
+    }
+
+
+    /*! \details Updates the kernel argument for the translation threshold.
+     *
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm).
+     */
+    void ICPBatch::setTranslationThreshold (double _translation_threshold)
+    {
+        translation_threshold = _translation_threshold;
+        updateKernel.setArg (4, (cl_float) translation_threshold);
+    }
+
+
+    /*! \return The number of iterations enqueued between convergence checks. */
+    unsigned int ICPBatch::getBatchSize ()
+    {
+        return batch_size;
+    }
+
+
+    /*! \param[in] _batch_size number of iterations enqueued between convergence checks. */
+    void ICPBatch::setBatchSize (unsigned int _batch_size)
+    {
+        batch_size = _batch_size;
+    }
+
+
+    /*! \return The convergence tolerance of the Power Method. */
+    float ICPBatch::getPowerTolerance ()
+    {
+        return power_tolerance;
+    }
+
+
+    /*! \details Updates the kernel argument for the convergence tolerance. 
+     *           Look at `ICPPowerMethod::setTolerance`.
+     *  
+     *  \param[in] _tolerance convergence tolerance.
+     */
+    void ICPBatch::setPowerTolerance (float _tolerance)
+    {
+        power_tolerance = _tolerance;
+        powMethodKernel.setArg (4, power_tolerance);
+    }
+
+
+    /*! \return The maximum number of Power Method iterations. */
+    unsigned int ICPBatch::getPowerMaxIterations ()
+    {
+        return power_max_iterations;
+    }
+
+
+    /*! \details Updates the kernel argument for the maximum number of iterations. 
+     *           Look at `ICPPowerMethod::setMaxIterations`.
+     *  
+     *  \param[in] _max_iterations maximum number of iterations. It's clamped to at least `1`.
+     */
+    void ICPBatch::setPowerMaxIterations (unsigned int _max_iterations)
+    {
+        power_max_iterations = std::max (_max_iterations, 1U);
+        powMethodKernel.setArg (5, (cl_uint) power_max_iterations);
+    }
+
+
+    /*! \return The flag for warm starting the Power Method. */
+    bool ICPBatch::getPowerWarmStart ()
+    {
+        return power_warm_start;
+    }
+
+
+    /*! \details Updates the kernel argument for the warm start. When set, the Power 
+     *           Method of every pair starts from the previous \f$ q_k \f$ of the pair.
+     *  
+     *  \param[in] _warm_start flag to indicate whether to warm start the Power Method.
+     */
+    void ICPBatch::setPowerWarmStart (bool _warm_start)
+    {
+        power_warm_start = _warm_start;
+        powMethodKernel.setArg (6, (cl_uint) power_warm_start);
+    }
+
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPOdometry<CR, CW>::ICPOdometry (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, 
+                                      clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
+        lm (env, infoICP, pool), reg (env, infoRBC, infoICP, pool)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    cl::Memory& ICPOdometry<CR, CW>::get (ICPOdometry::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPOdometry::Memory::H_IN:
+                return lm.get (ICPLMs::Memory::H_IN);
+            case ICPOdometry::Memory::H_IN_C:
+                return lm.get (ICPLMs::Memory::H_IN_C);
+            case ICPOdometry::Memory::D_IN:
+                return lm.get (ICPLMs::Memory::D_IN);
+            case ICPOdometry::Memory::D_IN_C:
+                return lm.get (ICPLMs::Memory::D_IN_C);
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m number of landmarks extracted from each frame. It has to be a power of 2.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
+     *                f_g(a)\|x_g-x'_g\|_2^2+f_p(a)\|x_p-x'_p\|_2^2 \f$. For more info, 
+     *                look at `euclideanSquaredMetric8` in [kernels/rbc_kernels.cl]
+     *                (https://random-ball-cover.nlamprian.me).
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     *  \param[in] _warm_start flag to indicate whether to initialize each registration with 
+     *                         the previous relative motion, or with the identity transformation.
+     *  \param[in] _layout memory layout of the frames. Look at `ICPLMs`.
+     *  \param[in] _color storage format of the color stream of the frames (for `ICPLayout::SOA`).
+     *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPOdometry<CR, CW>::init (unsigned int _m, unsigned int _nr, float _a, float _c, 
+        unsigned int _max_iterations, double _angle_threshold, double _translation_threshold, 
+        bool _warm_start, ICPLayout _layout, ICPColor _color, Staging _staging)
+    {
+        m = _m;
+        warm_start = _warm_start;
+
+        // Create device buffers
+        if (dBufferF () == nullptr)
+            dBufferF = cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        if (dBufferM () == nullptr)
+            dBufferM = cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+
+        // Configure classes
+        lm.get (ICPLMs::Memory::D_OUT) = dBufferM;
+        lm.init (640, 480, m, false, _layout, _color, 
+                 (_staging == Staging::I || _staging == Staging::IO) ? Staging::I : Staging::NONE);
+        hPtrIn = lm.hPtrIn;
+        hPtrInC = lm.hPtrInC;
+
+        reg.get (ICPStep<CR, CW>::Memory::D_IN_F) = dBufferF;
+        reg.get (ICPStep<CR, CW>::Memory::D_IN_M) = dBufferM;
+        reg.init (m, _nr, _a, _c, _max_iterations, _angle_threshold, _translation_threshold, Staging::NONE);
+
+        reset ();
+    }
+
+
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
      */
-    void* ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::read (
-        ICPStep::Memory mem, bool block, const std::vector<cl::Event> *events, cl::Event *event)
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPOdometry<CR, CW>::write (ICPOdometry::Memory mem, void *ptr, bool block, 
+                                     const std::vector<cl::Event> *events, cl::Event *event)
     {
-        if (staging == Staging::O || staging == Staging::IO)
+        switch (mem)
         {
-            switch (mem)
-            {
-                case ICPStep::Memory::H_IO_T:
-                    queue.enqueueReadBuffer (dBufferIOT, block, 0, bufferTSize, hPtrIOT, events, event);
-                    return hPtrIOT;
-                default:
-                    return nullptr;
-            }
+            case ICPOdometry::Memory::D_IN:
+                lm.write (ICPLMs::Memory::D_IN, ptr, block, events, event);
+                break;
+            case ICPOdometry::Memory::D_IN_C:
+                lm.write (ICPLMs::Memory::D_IN_C, ptr, block, events, event);
+                break;
+            default:
+                break;
         }
-        return nullptr;
-    }
-
-
-    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
-     *        and before any calls to `run` (for each registration).
-     */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::buildRBC (
-        const std::vector<cl::Event> *events, cl::Event *event)
-    {
-        fReps.run (events);
-        rbcC.run (nullptr, event);
     }
 
 
-    /*! \details The function call is non-blocking.
+    /*! \details Promotes the landmarks of the previous frame to the fixed set, extracts 
+     *           the landmarks of the new frame into the moving set, and performs the %ICP 
+     *           registration between them. The relative transformation is available in 
+     *           `Rr`, `qr`, `tr`, `sr`, and the accumulated global pose in `R`, `q`, `t`, `s`.
+     *  \note The first frame after a reset only initializes the sequence.
+     *  \note The function call is blocking.
      *
      *  \param[in] events a wait-list of events.
-     *  \param[out] event event associated with the kernel execution.
-     *  \param[in] config flag. If true, configures the `RBC search` process. 
-     *                    Set to true once, when the `RBC` data structure is reset.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::run (
-        const std::vector<cl::Event> *events, cl::Event *event, bool config)
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPOdometry<CR, CW>::run (const std::vector<cl::Event> *events)
     {
-        transform.run ();
-        rbcS.run (nullptr, nullptr, config);
-        weights.run ();
-        means.run ();
-        devs.run ();
-        matrixS.run ();
-        powMethod.run ();
+        // The moving set of the previous frame becomes the fixed set
+        if (frames > 0)
+            queue.enqueueCopyBuffer (dBufferM, dBufferF, 0, 0, m * sizeof (cl_float8), events);
 
-        Tk = (cl_float *) powMethod.read (ICPPowerMethod::Memory::H_OUT_T_K);
+        lm.run ((frames > 0) ? nullptr : events);
 
-        qk = Eigen::Quaternionf (Tk);
-        Rk = qk.toRotationMatrix ();
-        tk = Eigen::Map<Eigen::Vector3f> (Tk + 4, 3);
-        sk = Tk[7];
+        if (frames++ == 0)
+        {
+            queue.finish ();
+            return;
+        }
 
-        R = Rk * R;
-        q = Eigen::Quaternionf (R);
-        t = sk * Rk * t + tk;
-        s = sk * s;
-        
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
-        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
-        hPtrIOT[7] = s;  // Scale
+        if (!warm_start)
+            load (Eigen::Quaternionf::Identity (), Eigen::Vector3f::Zero (), 1.f);
+
+        reg.buildRBC ();
+        reg.run ();
+        k = reg.k;
 
-        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT, nullptr, event);
+        // Relative transformation between the last two frames
+        qr = reg.q;
+        Rr = reg.R;
+        tr = reg.t;
+        sr = reg.s;
+
+        // Accumulate the global pose
+        t = s * R * tr + t;
+        R = R * Rr;
+        q = Eigen::Quaternionf (R);
+        s = s * sr;
     }
 
 
-    /*! \return The scaling parameter \f$ \alpha \f$. */
-    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getAlpha ()
+    /*! \details The next frame starts a new sequence. The global pose, 
+     *           and the initial estimation of the relative transformation 
+     *           are reset to the identity transformation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPOdometry<CR, CW>::reset ()
     {
-        return a;
+        frames = 0;
+        k = 0;
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+
+        Rr = R; qr = q; tr = t; sr = s;
+
+        load (qr, tr, sr);
     }
 
 
-    /*! \details Updates the kernel arguments for the scaling parameter \f$ \alpha \f$.
-     *
-     *  \param[in] _a scaling parameter \f$ \alpha \f$.
-     */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setAlpha (float _a)
+    /*! \return The flag for the warm-start of the registrations. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    bool ICPOdometry<CR, CW>::getWarmStart ()
     {
-        a = _a;
-        rbcC.setAlpha (a);
-        rbcS.setAlpha (a);
+        return warm_start;
     }
 
 
-    /*! \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \return The scaling factor c.
+    /*! \param[in] _warm_start flag to indicate whether to initialize each registration with 
+     *                         the previous relative motion, or with the identity transformation.
      */
-    float ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::getScaling ()
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPOdometry<CR, CW>::setWarmStart (bool _warm_start)
     {
-        return c;
+        warm_start = _warm_start;
     }
 
 
-    /*! \details Updates the kernel argument for the scaling factor c.
-     *  \note The scaling factor c multiplies the points (deviations) before processing
-     *        in order to deal with floating point arithmetic issues.
-     *  
-     *  \param[in] _c scaling factor.
+    /*! \details Updates both the host side and the device side estimations of the registration.
+     *
+     *  \param[in] _q quaternion.
+     *  \param[in] _t translation vector.
+     *  \param[in] _s scale factor.
      */
-    void ICPStep<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>::setScaling (float _c)
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPOdometry<CR, CW>::load (const Eigen::Quaternionf &_q, const Eigen::Vector3f &_t, cl_float _s)
     {
-        c = _c;
-        matrixS.setScaling (c);
+        reg.q = _q;
+        reg.R = _q.toRotationMatrix ();
+        reg.t = _t;
+        reg.s = _s;
+
+        Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT, 4) = reg.q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT + 4, 4) = reg.t.homogeneous ();  // Translation
+        reg.hPtrIOT[7] = reg.s;  // Scale
+
+        queue.enqueueWriteBuffer ((cl::Buffer &) reg.get (ICPStep<CR, CW>::Memory::D_IO_T), 
+                                  CL_FALSE, 0, 2 * sizeof (cl_float4), reg.hPtrIOT);
     }
 
 
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors.  */
+    template class ICPOdometry<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
+    template class ICPOdometry<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors.   */
+    template class ICPOdometry<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors.  */
+    template class ICPOdometry<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+
+
     /*! \param[in] _env opencl environment.
      *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
      *                      It specifies the context, queue, etc, to be used.
      *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
      *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPPyramid<CR, CW>::ICPPyramid (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, 
+                                    clutils::CLEnvInfo<1> _infoICP, 
+        StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
+        levels (0)
+    {
+        // Placeholders for the input buffers
+        lmF.emplace_back (env, infoICP, pool);
+        lmM.emplace_back (env, infoICP, pool);
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    ICP<CR, CW>::ICP (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP) : 
-        ICPStep<CR, CW>::ICPStep (_env, _infoRBC, _infoICP)
+    cl::Memory& ICPPyramid<CR, CW>::get (ICPPyramid::Memory mem)
     {
+        switch (mem)
+        {
+            case ICPPyramid::Memory::H_IN_F:
+                return lmF[0].get (ICPLMs::Memory::H_IN);
+            case ICPPyramid::Memory::H_IN_M:
+                return lmM[0].get (ICPLMs::Memory::H_IN);
+            case ICPPyramid::Memory::D_IN_F:
+                return lmF[0].get (ICPLMs::Memory::D_IN);
+            case ICPPyramid::Memory::D_IN_M:
+                return lmM[0].get (ICPLMs::Memory::D_IN);
+        }
     }
 
 
@@ -4759,8 +10661,9 @@ namespace ICP
      *        before the call to `init`, then that memory will be maintained. Otherwise, 
      *        a new memory object will be created.
      *        
-     *  \param[in] _m number of points in the sets.
-     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _levels configurations of the levels, ordered from the coarsest to the finest.
+     *  \param[in] _width width (in pixels) of the point clouds.
+     *  \param[in] _height height (in pixels) of the point clouds.
      *  \param[in] _a factor scaling the results of the distance calculations for the 
      *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
      *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. That is, \f$ \|x-x'\|_2^2= 
@@ -4769,138 +10672,254 @@ namespace ICP
      *                (https://random-ball-cover.nlamprian.me).
      *  \param[in] _c scaling factor for dealing with floating point arithmetic 
      *                issues when computing the `S` matrix.
-     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
-     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
-     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
      *  \param[in] _staging flag to indicate whether or not to instantiate the staging buffers.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    void ICP<CR, CW>::init (unsigned int _m, unsigned int _nr, float _a, float _c, unsigned int _max_iterations, 
-        double _angle_threshold, double _translation_threshold, Staging _staging)
+    void ICPPyramid<CR, CW>::init (const std::vector<ICPPyramidLevel> &_levels, unsigned int _width, 
+        unsigned int _height, float _a, float _c, Staging _staging)
     {
-        max_iterations = _max_iterations;
-        angle_threshold = _angle_threshold;
-        translation_threshold = _translation_threshold;
+        try
+        {
+            if (_levels.empty ())
+                throw "The pyramid has to have at least one level";
 
-        ICPStep<CR, CW>::init (_m, _nr, _a, _c, _staging);
+            if (levels != 0)
+                throw "The pyramid has already been initialized";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPPyramid]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        levels = _levels.size ();
+        k.assign (levels, 0);
+
+        lmF.reserve (levels);
+        lmM.reserve (levels);
+        regs.reserve (levels);
+
+        Staging stagingLM = (_staging == Staging::I || _staging == Staging::IO) ? Staging::I : Staging::NONE;
+
+        for (unsigned int l = 0; l < levels; ++l)
+        {
+            const ICPPyramidLevel &level = _levels[l];
+
+            if (l > 0)
+            {
+                lmF.emplace_back (env, infoICP, pool);
+                lmM.emplace_back (env, infoICP, pool);
+
+                // All levels sample the same point clouds
+                lmF[l].get (ICPLMs::Memory::D_IN) = lmF[0].get (ICPLMs::Memory::D_IN);
+                lmM[l].get (ICPLMs::Memory::D_IN) = lmM[0].get (ICPLMs::Memory::D_IN);
+            }
+
+            lmF[l].get (ICPLMs::Memory::D_OUT) = 
+                cl::Buffer (context, CL_MEM_READ_WRITE, level.m * sizeof (cl_float8));
+            lmF[l].init (_width, _height, level.m, false, (l == 0) ? stagingLM : Staging::NONE);
+            lmM[l].get (ICPLMs::Memory::D_OUT) = 
+                cl::Buffer (context, CL_MEM_READ_WRITE, level.m * sizeof (cl_float8));
+            lmM[l].init (_width, _height, level.m, false, (l == 0) ? stagingLM : Staging::NONE);
+
+            regs.emplace_back (env, infoRBC, infoICP, pool);
+            regs[l].get (ICPStep<CR, CW>::Memory::D_IN_F) = lmF[l].get (ICPLMs::Memory::D_OUT);
+            regs[l].get (ICPStep<CR, CW>::Memory::D_IN_M) = lmM[l].get (ICPLMs::Memory::D_OUT);
+
+            // All levels work on the same transformation
+            if (l > 0)
+                regs[l].get (ICPStep<CR, CW>::Memory::D_IO_T) = regs[0].get (ICPStep<CR, CW>::Memory::D_IO_T);
+
+            regs[l].init (level.m, level.nr, _a, _c, level.max_iterations, 
+                          level.angle_threshold, level.translation_threshold, Staging::NONE);
+        }
+
+        hPtrInF = lmF[0].hPtrIn;
+        hPtrInM = lmM[0].hPtrIn;
+
+        reset ();
     }
 
 
-    /*! \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
-     *        and before any calls to `run` (for each registration).
+    /*! \details The transfer happens from a staging buffer on the host to the 
+     *           associated (specified) device buffer.
+     *  
+     *  \param[in] mem enumeration value specifying an input device buffer.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer.
+     *  \param[in] block a flag to indicate whether to perform a blocking 
+     *                   or a non-blocking operation.
+     *  \param[in] events a wait-list of events.
+     *  \param[out] event event associated with the write operation to the device buffer.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    void ICP<CR, CW>::buildRBC (const std::vector<cl::Event> *events, cl::Event *event)
+    void ICPPyramid<CR, CW>::write (ICPPyramid::Memory mem, void *ptr, bool block, 
+                                    const std::vector<cl::Event> *events, cl::Event *event)
     {
-        ICPStep<CR, CW>::buildRBC (events, event);
-        k = 0;
+        switch (mem)
+        {
+            case ICPPyramid::Memory::D_IN_F:
+                lmF[0].write (ICPLMs::Memory::D_IN, ptr, block, events, event);
+                break;
+            case ICPPyramid::Memory::D_IN_M:
+                lmM[0].write (ICPLMs::Memory::D_IN, ptr, block, events, event);
+                break;
+            default:
+                break;
+        }
     }
 
 
-    /*! \details Executes the iterative ICP algorithm and estimates the 
-     *           relative transformation between the two associated point clouds.
-     *  \note The function call is blocking, so it doesn't need to offer an event. 
-     *        It also doesn't accept events, since it's meant to be called after 
-     *        `buildRBC` which is the one that will wait on the events.
+    /*! \details Extracts the landmarks for all levels, and performs the %ICP registration 
+     *           on each level in turn, from the coarsest to the finest. Each level starts 
+     *           from the estimation of the previous one. The final estimation is available 
+     *           in `R`, `q`, `t`, `s`, and the number of iterations per level in `k`.
+     *  \note The function call is blocking.
+     *
+     *  \param[in] events a wait-list of events.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    void ICP<CR, CW>::run ()
+    void ICPPyramid<CR, CW>::run (const std::vector<cl::Event> *events)
     {
-        ICPStep<CR, CW>::run (nullptr, nullptr, true);
-        
-        while (check ()) ICPStep<CR, CW>::run ();
-        
-        this->queue.finish ();
+        for (unsigned int l = 0; l < levels; ++l)
+        {
+            lmF[l].run (events);
+            lmM[l].run (events);
+        }
+
+        // Continue from the last estimation
+        if (levels > 1)
+            handoff (regs[levels - 1], regs[0]);
+
+        for (unsigned int l = 0; l < levels; ++l)
+        {
+            if (l > 0) handoff (regs[l - 1], regs[l]);
+
+            regs[l].buildRBC ();
+            regs[l].run ();
+            k[l] = regs[l].k;
+        }
+
+        R = regs[levels - 1].R;
+        q = regs[levels - 1].q;
+        t = regs[levels - 1].t;
+        s = regs[levels - 1].s;
     }
 
 
-    /*! \details Checks the change in the transformation and the number of iterations.
-     *  \note Call `buildRBC` after the `D_IN_F` buffer has been written, 
-     *        and before any calls to `run` (for each registration).
-     *        
-     *  \return `false` for convergence, `true` otherwise.
-     */
+    /*! \details Updates both the host side and the device side estimations. */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    inline bool ICP<CR, CW>::check ()
+    void ICPPyramid<CR, CW>::reset ()
     {
-        k++;
-        double delta_angle = 180.0 / M_PI * 2.0 * std::atan2 (this->qk.vec ().norm (), this->qk.w ());  // in degrees
-        double delta_tanslation = this->tk.norm ();  // in mm
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
 
-        if (k == max_iterations) return false;
-        if (delta_angle < angle_threshold && delta_tanslation < translation_threshold) return false;
+        ICP<CR, CW> &reg = regs[levels - 1];
+        reg.R = R; reg.q = q; reg.t = t; reg.s = s;
 
-        return true;
+        Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        reg.hPtrIOT[7] = s;  // Scale
+
+        queue.enqueueWriteBuffer ((cl::Buffer &) reg.get (ICPStep<CR, CW>::Memory::D_IO_T), 
+                                  CL_FALSE, 0, 2 * sizeof (cl_float4), reg.hPtrIOT);
     }
 
 
-    /*! \return The maximum number of iterations. */
+    /*! \return The number of levels. */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    unsigned int ICP<CR, CW>::getMaxIterations ()
+    unsigned int ICPPyramid<CR, CW>::getLevels ()
     {
-        return max_iterations;
+        return levels;
     }
 
 
-    /*! \details Updates the parameter for the maximum number of iterations.
-     *  
-     *  \param[in] _max_iterations maximum number of iterations.
+    /*! \param[in] level index of the level, starting from the coarsest one.
+     *  \return The maximum number of iterations at the level.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    void ICP<CR, CW>::setMaxIterations (unsigned int _max_iterations)
+    unsigned int ICPPyramid<CR, CW>::getMaxIterations (unsigned int level)
     {
-        max_iterations = _max_iterations;
+        return regs[level].getMaxIterations ();
     }
 
 
-    /*! \return The threshold for the change in angle (in degrees). */
+    /*! \param[in] level index of the level, starting from the coarsest one.
+     *  \param[in] _max_iterations maximum number of iterations at the level.
+     */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    double ICP<CR, CW>::getAngleThreshold ()
+    void ICPPyramid<CR, CW>::setMaxIterations (unsigned int level, unsigned int _max_iterations)
     {
-        return angle_threshold;
+        regs[level].setMaxIterations (_max_iterations);
     }
 
 
-    /*! \details Updates the parameter for the threshold for the change 
-     *           in angle (in degrees) in the transformation.
-     *  
-     *  \param[in] _angle_threshold threshold for the change in angle (in degrees).
+    /*! \param[in] level index of the level, starting from the coarsest one.
+     *  \return The threshold for the change in angle (in degrees) at the level.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    void ICP<CR, CW>::setAngleThreshold (double _angle_threshold)
+    double ICPPyramid<CR, CW>::getAngleThreshold (unsigned int level)
     {
-        angle_threshold = _angle_threshold;
+        return regs[level].getAngleThreshold ();
     }
 
 
-    /*! \return The threshold for the change in translation (in mm). */
+    /*! \param[in] level index of the level, starting from the coarsest one.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) at the level.
+     */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    double ICP<CR, CW>::getTranslationThreshold ()
+    void ICPPyramid<CR, CW>::setAngleThreshold (unsigned int level, double _angle_threshold)
     {
-        return translation_threshold;
+        regs[level].setAngleThreshold (_angle_threshold);
     }
 
 
-    /*! \details Updates the parameter for the threshold for the change 
-     *           in translation (in mm) in the transformation.
-     *  
-     *  \param[in] _translation_threshold threshold for the change in translation (in mm).
+    /*! \param[in] level index of the level, starting from the coarsest one.
+     *  \return The threshold for the change in translation (in mm) at the level.
      */
     template <ICPStepConfigT CR, ICPStepConfigW CW>
-    void ICP<CR, CW>::setTranslationThreshold (double _translation_threshold)
+    double ICPPyramid<CR, CW>::getTranslationThreshold (unsigned int level)
     {
-        translation_threshold = _translation_threshold;
+        return regs[level].getTranslationThreshold ();
+    }
+
+
+    /*! \param[in] level index of the level, starting from the coarsest one.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) at the level.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPPyramid<CR, CW>::setTranslationThreshold (unsigned int level, double _translation_threshold)
+    {
+        regs[level].setTranslationThreshold (_translation_threshold);
+    }
+
+
+    /*! \details The levels share the device side transformation buffer, 
+     *           so only the host side estimation needs to be passed along.
+     *
+     *  \param[in] from level that holds the current estimation.
+     *  \param[out] to level to receive the current estimation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPPyramid<CR, CW>::handoff (ICP<CR, CW> &from, ICP<CR, CW> &to)
+    {
+        to.R = from.R;
+        to.q = from.q;
+        to.t = from.t;
+        to.s = from.s;
     }
 
 
     /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors.  */
-    template class ICP<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    template class ICPPyramid<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
     /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
-    template class ICP<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    template class ICPPyramid<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
     /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors.   */
-    template class ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    template class ICPPyramid<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
     /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors.  */
-    template class ICP<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+    template class ICPPyramid<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
 
 }
 }
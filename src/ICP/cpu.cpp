@@ -0,0 +1,724 @@
+/*! \file cpu.cpp
+ *  \brief Defines a multithreaded CPU backend for the %ICP pipeline.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <ICP/cpu.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \param[in] _threads number of threads, including the calling thread. 
+     *                      If `0`, it uses as many threads as the hardware supports.
+     */
+    ICPThreadPool::ICPThreadPool (unsigned int _threads) : 
+        task (nullptr), n (0), generation (0), pending (0), quit (false)
+    {
+        unsigned int threads = (_threads > 0) ? _threads : std::max (std::thread::hardware_concurrency (), 1U);
+
+        for (unsigned int chunk = 1; chunk < threads; ++chunk)
+            workers.emplace_back (&ICPThreadPool::work, this, chunk);
+    }
+
+
+    ICPThreadPool::~ICPThreadPool ()
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            quit = true;
+        }
+        cvTask.notify_all ();
+
+        for (auto &worker : workers)
+            worker.join ();
+    }
+
+
+    /*! \details Chunk `i` covers the indices \f$ [in/T, (i+1)n/T) \f$, where `T` 
+     *           is the number of threads. The call blocks until all chunks are done.
+     *
+     *  \param[in] _n number of indices.
+     *  \param[in] _task function processing a chunk.
+     */
+    void ICPThreadPool::run (unsigned int _n, const Task &_task)
+    {
+        if (workers.empty ())
+        {
+            _task (0, _n, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            task = &_task;
+            n = _n;
+            pending = workers.size ();
+            generation++;
+        }
+        cvTask.notify_all ();
+
+        _task (0, (unsigned long long) _n / size (), 0);
+
+        std::unique_lock<std::mutex> lock (mutex);
+        cvDone.wait (lock, [this] { return pending == 0; });
+    }
+
+
+    /*! \return The number of threads, including the calling thread. */
+    unsigned int ICPThreadPool::size () const
+    {
+        return workers.size () + 1;
+    }
+
+
+    /*! \param[in] chunk index of the chunk that the thread processes. */
+    void ICPThreadPool::work (unsigned int chunk)
+    {
+        unsigned int seen = 0;
+
+        while (true)
+        {
+            const Task *t;
+            unsigned long long _n;
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                cvTask.wait (lock, [&] { return quit || generation != seen; });
+                if (quit) return;
+
+                seen = generation;
+                t = task;
+                _n = n;
+            }
+
+            (*t) (_n * chunk / size (), _n * (chunk + 1) / size (), chunk);
+
+            std::lock_guard<std::mutex> lock (mutex);
+            if (--pending == 0) cvDone.notify_one ();
+        }
+    }
+
+
+    /*! \param[in] n number of points. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::Points::resize (unsigned int n)
+    {
+        x.resize (n); y.resize (n); z.resize (n);
+        r.resize (n); g.resize (n); b.resize (n);
+    }
+
+
+    /*! \param[in] in array of `n` points, in `cl_float8` layout.
+     *  \param[in] n number of points.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::Points::load (const cl_float *in, unsigned int n)
+    {
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            x[i] = in[i * 8];     y[i] = in[i * 8 + 1]; z[i] = in[i * 8 + 2];
+            r[i] = in[i * 8 + 4]; g[i] = in[i * 8 + 5]; b[i] = in[i * 8 + 6];
+        }
+    }
+
+
+    /*! \param[in] _threads number of threads, including the calling thread. 
+     *                      If `0`, it uses as many threads as the hardware supports.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPCPU<CR, CW>::ICPCPU (unsigned int _threads) : 
+        hPtrInF (nullptr), hPtrInM (nullptr), hPtrIOT (nullptr), k (0), 
+        pool (_threads), a (1e2f), c (1e-6f), m (0), nr (0), d (8)
+    {
+    }
+
+
+    /*! \details Allocates the arrays, and loads the identity transformation.
+     *        
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the photometric dimensions in the distance calculations.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic issues 
+     *                when computing the `S` matrix. The sums are accumulated in double 
+     *                precision, so it's only kept for compatibility with `ICP<CR, CW>`.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     *  \param[in] _staging flag to indicate whether or not to expose the input staging buffers. 
+     *                      The output staging buffer is always available.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::init (unsigned int _m, unsigned int _nr, float _a, float _c, 
+        unsigned int _max_iterations, double _angle_threshold, double _translation_threshold, Staging _staging)
+    {
+        m = _m; nr = _nr;
+        a = _a; c = _c;
+        max_iterations = _max_iterations;
+        angle_threshold = _angle_threshold;
+        translation_threshold = _translation_threshold;
+        staging = _staging;
+
+        try
+        {
+            if (m == 0 || (m & (m - 1)))
+                throw "The number of landmarks has to be a power of 2";
+
+            if (nr == 0 || (nr & (nr - 1)))
+                throw "The number of representatives has to be a power of 2";
+
+            if (nr > m)
+                throw "The number of representatives cannot exceed the number of landmarks";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPCPU]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        // Create staging buffers
+        hInF.resize (m * d);
+        hInM.resize (m * d);
+        hIOT.resize (8);
+
+        bool input = (staging == Staging::I || staging == Staging::IO);
+        hPtrInF = input ? hInF.data () : nullptr;
+        hPtrInM = input ? hInM.data () : nullptr;
+        hPtrIOT = hIOT.data ();
+
+        // Create internal arrays
+        fixed.resize (m); moving.resize (m); tMoving.resize (m);
+        reps.resize (nr); lists.resize (m); matched.resize (m);
+        owner.resize (m);
+        offsets.resize (nr + 1);
+        dist.resize (m);
+        sums.resize (pool.size ());
+        scratch.resize (pool.size ());
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+        write (ICPCPU::Memory::D_IO_T);
+    }
+
+
+    /*! \details `D_IN_F` and `D_IN_M` convert the landmarks to the internal 
+     *           layout. `D_IO_T` loads the transformation estimation, `q`, `R`, 
+     *           `t`, `s`, from `H_IO_T`.
+     *
+     *  \param[in] mem enumeration value specifying the internal array to be updated.
+     *  \param[in] ptr a pointer to an array holding input data. If not NULL, the 
+     *                 data from `ptr` will be copied to the associated staging buffer first.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::write (ICPCPU::Memory mem, void *ptr)
+    {
+        switch (mem)
+        {
+            case ICPCPU::Memory::D_IN_F:
+                if (ptr != nullptr)
+                    std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hInF.data ());
+                fixed.load (hInF.data (), m);
+                break;
+            case ICPCPU::Memory::D_IN_M:
+                if (ptr != nullptr)
+                    std::copy ((cl_float *) ptr, (cl_float *) ptr + m * d, hInM.data ());
+                moving.load (hInM.data (), m);
+                break;
+            case ICPCPU::Memory::D_IO_T:
+                if (ptr != nullptr)
+                    std::copy ((cl_float *) ptr, (cl_float *) ptr + 8, hPtrIOT);
+                q = Eigen::Quaternionf (hPtrIOT);
+                R = q.toRotationMatrix ();
+                t = Eigen::Map<Eigen::Vector3f> (hPtrIOT + 4, 3);
+                s = hPtrIOT[7];
+                break;
+            default:
+                break;
+        }
+    }
+
+
+    /*! \details The output staging buffer is kept up to date with every iteration.
+     *
+     *  \param[in] mem enumeration value specifying an output staging buffer.
+     *  \return A pointer to the staging buffer.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void* ICPCPU<CR, CW>::read (ICPCPU::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPCPU::Memory::H_IO_T:
+                return hPtrIOT;
+            default:
+                return nullptr;
+        }
+    }
+
+
+    /*! \details Picks the representatives from the fixed set, like `ICPReps`, 
+     *           assigns every fixed landmark to its nearest representative, 
+     *           and groups the landmarks in one list per representative.
+     *  \note Call `buildRBC` after the `D_IN_F` array has been written, 
+     *        and before any calls to `run` (for each registration).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::buildRBC ()
+    {
+        // e.g. nr = 32 -> nrx = 8, nry = 4
+        int p = std::log2 (nr);
+        unsigned int nrx = 1U << (p - p / 2);
+        unsigned int nry = 1U << (p / 2);
+
+        // e.g. m = 16384 -> lx = 128, ly = 128
+        p = std::log2 (m);
+        unsigned int lx = 1U << (p - p / 2);
+        unsigned int ly = 1U << (p / 2);
+
+        unsigned int stepX = lx / nrx, stepY = ly / nry;
+        unsigned int offX = std::max (stepX >> 1, 1U) - 1, offY = std::max (stepY >> 1, 1U) - 1;
+
+        for (unsigned int gY = 0; gY < nry; ++gY)
+            for (unsigned int gX = 0; gX < nrx; ++gX)
+            {
+                unsigned int i = (gY * stepY + offY) * lx + gX * stepX + offX;
+                unsigned int j = gY * nrx + gX;
+                reps.x[j] = fixed.x[i]; reps.y[j] = fixed.y[i]; reps.z[j] = fixed.z[i];
+                reps.r[j] = fixed.r[i]; reps.g[j] = fixed.g[i]; reps.b[j] = fixed.b[i];
+            }
+
+        // Assign the fixed landmarks to representatives
+        pool.run (m, [this] (unsigned int begin, unsigned int end, unsigned int chunk)
+        {
+            std::vector<cl_float> &dr = scratch[chunk];
+            dr.resize (std::max ((unsigned int) dr.size (), nr));
+
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                const float px = fixed.x[i], py = fixed.y[i], pz = fixed.z[i];
+                const float pr = fixed.r[i], pg = fixed.g[i], pb = fixed.b[i];
+                for (unsigned int j = 0; j < nr; ++j)
+                {
+                    float dx = px - reps.x[j], dy = py - reps.y[j], dz = pz - reps.z[j];
+                    float dR = pr - reps.r[j], dG = pg - reps.g[j], dB = pb - reps.b[j];
+                    dr[j] = dx * dx + dy * dy + dz * dz + a * (dR * dR + dG * dG + dB * dB);
+                }
+                owner[i] = std::min_element (dr.begin (), dr.begin () + nr) - dr.begin ();
+            }
+        });
+
+        // Group the landmarks by representative
+        std::fill (offsets.begin (), offsets.end (), 0);
+        for (unsigned int i = 0; i < m; ++i)
+            offsets[owner[i] + 1]++;
+        for (unsigned int j = 0; j < nr; ++j)
+            offsets[j + 1] += offsets[j];
+
+        std::vector<unsigned int> pos (offsets.begin (), offsets.end () - 1);
+        unsigned int longest = 0;
+        for (unsigned int j = 0; j < nr; ++j)
+            longest = std::max (longest, offsets[j + 1] - offsets[j]);
+
+        for (unsigned int i = 0; i < m; ++i)
+        {
+            unsigned int l = pos[owner[i]]++;
+            lists.x[l] = fixed.x[i]; lists.y[l] = fixed.y[i]; lists.z[l] = fixed.z[i];
+            lists.r[l] = fixed.r[i]; lists.g[l] = fixed.g[i]; lists.b[l] = fixed.b[i];
+        }
+
+        for (auto &dr : scratch)
+            dr.resize (std::max (std::max (longest, nr), (unsigned int) dr.size ()));
+
+        k = 0;
+    }
+
+
+    /*! \details It's a one-shot search. The query is only compared with the landmarks 
+     *           in the list of its nearest representative. The distances are computed 
+     *           into a buffer first, so that the loops vectorize.
+     *
+     *  \param[in] begin index of the first query.
+     *  \param[in] end index past the last query.
+     *  \param[in] chunk index of the chunk.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::search (unsigned int begin, unsigned int end, unsigned int chunk)
+    {
+        cl_float *dr = scratch[chunk].data ();
+
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const float px = tMoving.x[i], py = tMoving.y[i], pz = tMoving.z[i];
+            const float pr = tMoving.r[i], pg = tMoving.g[i], pb = tMoving.b[i];
+
+            // Nearest representative
+            for (unsigned int j = 0; j < nr; ++j)
+            {
+                float dx = px - reps.x[j], dy = py - reps.y[j], dz = pz - reps.z[j];
+                float dR = pr - reps.r[j], dG = pg - reps.g[j], dB = pb - reps.b[j];
+                dr[j] = dx * dx + dy * dy + dz * dz + a * (dR * dR + dG * dG + dB * dB);
+            }
+            unsigned int rep = std::min_element (dr, dr + nr) - dr;
+
+            // Nearest neighbor in the list of the representative
+            unsigned int first = offsets[rep], n = offsets[rep + 1] - first;
+            const float *lx = lists.x.data () + first, *ly = lists.y.data () + first, *lz = lists.z.data () + first;
+            const float *lr = lists.r.data () + first, *lg = lists.g.data () + first, *lb = lists.b.data () + first;
+            for (unsigned int l = 0; l < n; ++l)
+            {
+                float dx = px - lx[l], dy = py - ly[l], dz = pz - lz[l];
+                float dR = pr - lr[l], dG = pg - lg[l], dB = pb - lb[l];
+                dr[l] = dx * dx + dy * dy + dz * dz + a * (dR * dR + dG * dG + dB * dB);
+            }
+            unsigned int nn = first + (std::min_element (dr, dr + n) - dr);
+
+            matched.x[i] = lists.x[nn];
+            matched.y[i] = lists.y[nn];
+            matched.z[i] = lists.z[nn];
+            dist[i] = dr[nn - first];
+        }
+    }
+
+
+    /*! \param[in] begin index of the first pair.
+     *  \param[in] end index past the last pair.
+     *  \param[in] chunk index of the chunk.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::means (unsigned int begin, unsigned int end, unsigned int chunk)
+    {
+        Sums &S = sums[chunk];
+        S.w = 0.0;
+        std::fill (S.f, S.f + 3, 0.0);
+        std::fill (S.m, S.m + 3, 0.0);
+
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            double w = (CW == ICPStepConfigW::WEIGHTED) ? 100.0 / (100.0 + dist[i]) : 1.0;
+            S.w += w;
+            S.f[0] += w * matched.x[i]; S.f[1] += w * matched.y[i]; S.f[2] += w * matched.z[i];
+            S.m[0] += w * tMoving.x[i]; S.m[1] += w * tMoving.y[i]; S.m[2] += w * tMoving.z[i];
+        }
+    }
+
+
+    /*! \param[in] begin index of the first pair.
+     *  \param[in] end index past the last pair.
+     *  \param[in] chunk index of the chunk.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::products (unsigned int begin, unsigned int end, unsigned int chunk)
+    {
+        Sums &S = sums[chunk];
+        std::fill (S.mf, S.mf + 9, 0.0);
+        S.mm = S.ff = 0.0;
+
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            double w = (CW == ICPStepConfigW::WEIGHTED) ? 100.0 / (100.0 + dist[i]) : 1.0;
+            double dm[3] = { tMoving.x[i] - mm[0], tMoving.y[i] - mm[1], tMoving.z[i] - mm[2] };
+            double df[3] = { matched.x[i] - mf[0], matched.y[i] - mf[1], matched.z[i] - mf[2] };
+
+            for (unsigned int r = 0; r < 3; ++r)
+                for (unsigned int c = 0; c < 3; ++c)
+                    S.mf[r * 3 + c] += w * dm[r] * df[c];
+            S.mm += w * (dm[0] * dm[0] + dm[1] * dm[1] + dm[2] * dm[2]);
+            S.ff += w * (df[0] * df[0] + df[1] * df[1] + df[2] * df[2]);
+        }
+    }
+
+
+    /*! \details The `EIGEN` configurations use `Eigen::JacobiSVD`, like `ICPStep`. 
+     *           The `POWER_METHOD` configurations find the dominant eigenvector of 
+     *           the `N` matrix, like `ICPPowerMethod`.
+     *
+     *  \param[in] S sums of products of the deviations, \f$ S_{ij}=\sum w\ m_i f_j \f$.
+     *  \param[in] Smm sum of the squared norms of the moving set deviations.
+     *  \param[in] Sff sum of the squared norms of the fixed set deviations.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::solve (const Eigen::Matrix3d &S, double Smm, double Sff)
+    {
+        sk = std::sqrt (Sff / Smm);
+
+        if (CR == ICPStepConfigT::EIGEN)
+        {
+            Eigen::JacobiSVD<Eigen::Matrix3f, Eigen::NoQRPreconditioner> 
+                svd (S.cast<float> (), Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+            Rk = svd.matrixV () * svd.matrixU ().transpose ();
+            if (Rk.determinant () < 0)
+            {
+                Eigen::Matrix3f B = Eigen::Matrix3f::Identity ();
+                B (2, 2) = Rk.determinant ();
+                Rk = svd.matrixV () * B * svd.matrixU ().transpose ();
+            }
+            qk = Eigen::Quaternionf (Rk);
+        }
+        else
+        {
+            double Sxx = S (0, 0), Sxy = S (0, 1), Sxz = S (0, 2);
+            double Syx = S (1, 0), Syy = S (1, 1), Syz = S (1, 2);
+            double Szx = S (2, 0), Szy = S (2, 1), Szz = S (2, 2);
+
+            Eigen::Matrix4d N;
+            N << Sxx - Syy - Szz,         Sxy + Syx,         Szx + Sxz,       Syz - Szy, 
+                       Sxy + Syx, - Sxx + Syy - Szz,         Syz + Szy,       Szx - Sxz, 
+                       Szx + Sxz,         Syz + Szy, - Sxx - Syy + Szz,       Sxy - Syx, 
+                       Syz - Szy,         Szx - Sxz,         Sxy - Syx, Sxx + Syy + Szz;
+
+            // Power Method, shifted when the dominant eigenvalue is negative
+            Eigen::Vector4d x;
+            while (true)
+            {
+                x = Eigen::Vector4d::Constant (0.5);
+                for (unsigned int iter = 0; iter < 1000; ++iter)
+                {
+                    Eigen::Vector4d x_new = (N * x).normalized ();
+                    bool done = (x_new - x).norm () < 1e-9;
+                    x = x_new;
+                    if (done) break;
+                }
+
+                double lambda = x.dot (N * x);
+                if (!(lambda < 0)) break;
+                N -= lambda * Eigen::Matrix4d::Identity ();
+            }
+
+            qk = Eigen::Quaternionf (x[3], x[0], x[1], x[2]);  // x is [ q_x q_y q_z q_w ]
+            qk.normalize ();
+            Rk = qk.toRotationMatrix ();
+        }
+
+        tk = mf.cast<float> () - sk * Rk * mm.cast<float> ();
+    }
+
+
+    /*! \details Transforms the moving set, searches for the nearest neighbors, 
+     *           estimates the incremental transformation, and composes it 
+     *           with the current estimation.
+     *  \note Call `buildRBC` after the `D_IN_F` array has been written, 
+     *        and before any calls to `step` (for each registration).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::step ()
+    {
+        // Transform the moving set
+        const Eigen::Matrix3f sR = s * R;
+        pool.run (m, [this, &sR] (unsigned int begin, unsigned int end, unsigned int)
+        {
+            const float r00 = sR (0, 0), r01 = sR (0, 1), r02 = sR (0, 2);
+            const float r10 = sR (1, 0), r11 = sR (1, 1), r12 = sR (1, 2);
+            const float r20 = sR (2, 0), r21 = sR (2, 1), r22 = sR (2, 2);
+            const float tx = t[0], ty = t[1], tz = t[2];
+
+            const float *x = moving.x.data (), *y = moving.y.data (), *z = moving.z.data ();
+            float *tx_ = tMoving.x.data (), *ty_ = tMoving.y.data (), *tz_ = tMoving.z.data ();
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                tx_[i] = r00 * x[i] + r01 * y[i] + r02 * z[i] + tx;
+                ty_[i] = r10 * x[i] + r11 * y[i] + r12 * z[i] + ty;
+                tz_[i] = r20 * x[i] + r21 * y[i] + r22 * z[i] + tz;
+            }
+            std::copy (moving.r.begin () + begin, moving.r.begin () + end, tMoving.r.begin () + begin);
+            std::copy (moving.g.begin () + begin, moving.g.begin () + end, tMoving.g.begin () + begin);
+            std::copy (moving.b.begin () + begin, moving.b.begin () + end, tMoving.b.begin () + begin);
+        });
+
+        using namespace std::placeholders;
+        pool.run (m, std::bind (&ICPCPU::search, this, _1, _2, _3));
+
+        // Means
+        pool.run (m, std::bind (&ICPCPU::means, this, _1, _2, _3));
+        double w = 0.0;
+        mf.setZero (); mm.setZero ();
+        for (auto &S : sums)
+        {
+            w += S.w;
+            mf += Eigen::Map<Eigen::Vector3d> (S.f);
+            mm += Eigen::Map<Eigen::Vector3d> (S.m);
+        }
+        mf /= w; mm /= w;
+
+        // S matrix
+        pool.run (m, std::bind (&ICPCPU::products, this, _1, _2, _3));
+        Eigen::Matrix3d S = Eigen::Matrix3d::Zero ();
+        double Smm = 0.0, Sff = 0.0;
+        for (auto &P : sums)
+        {
+            S += Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor> > (P.mf);
+            Smm += P.mm;
+            Sff += P.ff;
+        }
+
+        solve (S, Smm, Sff);
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = sk * Rk * t + tk;
+        s = sk * s;
+        
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        hPtrIOT[7] = s;  // Scale
+    }
+
+
+    /*! \details Executes the iterative ICP algorithm and estimates the 
+     *           relative transformation between the two associated point clouds.
+     *  \note The function call is blocking.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::run ()
+    {
+        step ();
+        
+        while (check ()) step ();
+    }
+
+
+    /*! \details Checks the change in the transformation and the number of iterations.
+     *        
+     *  \return `false` for convergence, `true` otherwise.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    inline bool ICPCPU<CR, CW>::check ()
+    {
+        k++;
+        double delta_angle = 180.0 / M_PI * 2.0 * std::atan2 (qk.vec ().norm (), qk.w ());  // in degrees
+        double delta_tanslation = tk.norm ();  // in mm
+
+        if (k == max_iterations) return false;
+        if (delta_angle < angle_threshold && delta_tanslation < translation_threshold) return false;
+
+        return true;
+    }
+
+
+    /*! \return The scaling parameter \f$ \alpha \f$. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    float ICPCPU<CR, CW>::getAlpha ()
+    {
+        return a;
+    }
+
+
+    /*! \details The `RBC` data structure has to be rebuilt, with `buildRBC`, for the 
+     *           new value to apply to the assignment of the landmarks to the lists.
+     *
+     *  \param[in] _a scaling parameter \f$ \alpha \f$.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::setAlpha (float _a)
+    {
+        a = _a;
+    }
+
+
+    /*! \return The maximum number of iterations. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    unsigned int ICPCPU<CR, CW>::getMaxIterations ()
+    {
+        return max_iterations;
+    }
+
+
+    /*! \details Updates the parameter for the maximum number of iterations.
+     *  
+     *  \param[in] _max_iterations maximum number of iterations.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::setMaxIterations (unsigned int _max_iterations)
+    {
+        max_iterations = _max_iterations;
+    }
+
+
+    /*! \return The threshold for the change in angle (in degrees). */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    double ICPCPU<CR, CW>::getAngleThreshold ()
+    {
+        return angle_threshold;
+    }
+
+
+    /*! \details Updates the parameter for the threshold for the change 
+     *           in angle (in degrees) in the transformation.
+     *  
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::setAngleThreshold (double _angle_threshold)
+    {
+        angle_threshold = _angle_threshold;
+    }
+
+
+    /*! \return The threshold for the change in translation (in mm). */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    double ICPCPU<CR, CW>::getTranslationThreshold ()
+    {
+        return translation_threshold;
+    }
+
+
+    /*! \details Updates the parameter for the threshold for the change 
+     *           in translation (in mm) in the transformation.
+     *  
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm).
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPCPU<CR, CW>::setTranslationThreshold (double _translation_threshold)
+    {
+        translation_threshold = _translation_threshold;
+    }
+
+
+    /*! \return The number of threads, including the calling thread. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    unsigned int ICPCPU<CR, CW>::getThreads ()
+    {
+        return pool.size ();
+    }
+
+
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors. */
+    template class ICPCPU<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
+    template class ICPCPU<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors. */
+    template class ICPCPU<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors. */
+    template class ICPCPU<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+
+}
+}
@@ -0,0 +1,475 @@
+/*! \file pc_file.cpp
+ *  \brief Defines a memory-mapped, chunked file format for point cloud sequences.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ICP/pc_file.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Rounds a size up to a multiple of `pcFileAlignment`. */
+    static uint64_t alignSize (uint64_t size)
+    {
+        return (size + pcFileAlignment - 1) / pcFileAlignment * pcFileAlignment;
+    }
+
+
+    /*! \brief Writes zeros up to the next multiple of `pcFileAlignment`. */
+    static void pad (std::ofstream &file, uint64_t size)
+    {
+        static const std::vector<char> zeros (pcFileAlignment, 0);
+        uint64_t rem = alignSize (size) - size;
+        file.write (zeros.data (), rem);
+    }
+
+
+    /*! \brief Returns the size (in bytes) of an uncompressed frame. */
+    static uint64_t frameSize (PCFileLayout layout, uint64_t n)
+    {
+        return (layout == PCFileLayout::FLOAT8) ? 
+            n * sizeof (cl_float8) : n * (sizeof (uint16_t) + 3 * sizeof (uint8_t));
+    }
+
+
+    /*! \brief Run-length encodes a depth plane.
+     *  \details Runs of at least 3 equal values become a (token, value) pair. 
+     *           The rest of the values are grouped in literal sequences. The 
+     *           invalid (zero) regions and the flat surfaces of a depth frame 
+     *           compress well, and the worst case grows by one token in 32767.
+     */
+    static void encodeRLE (const uint16_t *in, uint64_t n, std::vector<uint16_t> &out)
+    {
+        const uint64_t maxCount = 0x7FFF;
+
+        // Length of the run starting at i
+        auto run = [in, n, maxCount] (uint64_t i)
+        {
+            uint64_t j = i + 1;
+            while (j < n && j - i < maxCount && in[j] == in[i]) ++j;
+            return j - i;
+        };
+
+        out.clear ();
+        uint64_t i = 0;
+        while (i < n)
+        {
+            uint64_t r = run (i);
+            if (r >= 3)
+            {
+                out.push_back (0x8000 | r);
+                out.push_back (in[i]);
+                i += r;
+                continue;
+            }
+
+            uint64_t start = i;
+            while (i < n && i - start < maxCount && (r = run (i)) < 3)
+                i += r;
+            i = std::min (i, start + maxCount);
+
+            out.push_back (i - start);
+            out.insert (out.end (), in + start, in + i);
+        }
+    }
+
+
+    /*! \brief Decodes a run-length encoded depth plane.
+     *  \return True if the stream decodes to exactly `n` values.
+     */
+    static bool decodeRLE (const uint16_t *in, uint64_t count, uint16_t *out, uint64_t n)
+    {
+        uint64_t i = 0, o = 0;
+        while (i < count)
+        {
+            uint16_t token = in[i++];
+            uint64_t len = token & 0x7FFF;
+
+            if (token & 0x8000)
+            {
+                if (i >= count || o + len > n) return false;
+                std::fill (out + o, out + o + len, in[i++]);
+            }
+            else
+            {
+                if (i + len > count || o + len > n) return false;
+                std::copy (in + i, in + i + len, out + o);
+                i += len;
+            }
+            o += len;
+        }
+
+        return o == n;
+    }
+
+
+    /*! \details The principal point is placed at the center of the frame.
+     *
+     *  \param[in] path path to the file.
+     *  \param[in] _width width (in pixels) of the frames.
+     *  \param[in] _height height (in pixels) of the frames.
+     *  \param[in] _fx focal length (in pixels) along the x axis.
+     *  \param[in] _fy focal length (in pixels) along the y axis.
+     *  \param[in] _layout layout of the frames.
+     *  \param[in] _compression compression of the depth planes. 
+     *                          It's only available for the `RGBD` layout.
+     */
+    PCFileWriter::PCFileWriter (const std::string &path, unsigned int _width, unsigned int _height, 
+                                float _fx, float _fy, PCFileLayout _layout, PCFileCompression _compression)
+    {
+        if (_layout == PCFileLayout::FLOAT8 && _compression != PCFileCompression::NONE)
+            throw "Compression is only available for the RGBD layout";
+
+        file.open (path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw "Failed to create the point cloud file";
+
+        std::memset (&header, 0, sizeof (header));
+        std::memcpy (header.magic, "ICPC", 4);
+        header.version = pcFileVersion;
+        header.width = _width;
+        header.height = _height;
+        header.layout = _layout;
+        header.fx = _fx;
+        header.fy = _fy;
+        header.cx = (_width - 1) / 2.f;
+        header.cy = (_height - 1) / 2.f;
+        header.frames = 0;
+        header.frameBytes = frameSize (_layout, (uint64_t) _width * _height);
+        header.chunkBytes = (_compression == PCFileCompression::NONE) ? 
+            alignSize (sizeof (PCChunkHeader)) + alignSize (header.frameBytes) : 0;
+        header.dataOffset = alignSize (sizeof (PCFileHeader));
+        header.compression = _compression;
+
+        file.write ((char *) &header, sizeof (header));
+        pad (file, sizeof (header));
+    }
+
+
+    PCFileWriter::~PCFileWriter ()
+    {
+        close ();
+    }
+
+
+    /*! \param[in] pc8d the point cloud, with `width*height` points.
+     *  \param[in] timestamp capture time (in us) of the frame.
+     */
+    void PCFileWriter::append (const cl_float8 *pc8d, uint64_t timestamp)
+    {
+        if (header.layout != PCFileLayout::FLOAT8)
+            throw "The point cloud file doesn't hold FLOAT8 frames";
+
+        write (timestamp, (const char *) pc8d, header.frameBytes);
+    }
+
+
+    /*! \param[in] depth the depth frame (in mm), with `width*height` values.
+     *  \param[in] rgb the RGB frame, with `width*height` pixels, 3 channels per pixel.
+     *  \param[in] timestamp capture time (in us) of the frames.
+     */
+    void PCFileWriter::append (const uint16_t *depth, const uint8_t *rgb, uint64_t timestamp)
+    {
+        if (header.layout != PCFileLayout::RGBD)
+            throw "The point cloud file doesn't hold RGBD frames";
+
+        const uint64_t n = (uint64_t) header.width * header.height;
+
+        if (header.compression == PCFileCompression::RLE)
+        {
+            encodeRLE (depth, n, encoded);
+            write (timestamp, (const char *) encoded.data (), encoded.size () * sizeof (uint16_t), 
+                   (const char *) rgb, 3 * n);
+        }
+        else
+            write (timestamp, (const char *) depth, n * sizeof (uint16_t), (const char *) rgb, 3 * n);
+    }
+
+
+    /*! \param[in] timestamp capture time (in us) of the frame.
+     *  \param[in] data the frame, or the depth plane for the `RGBD` layout.
+     *  \param[in] bytes size (in bytes) of `data`.
+     *  \param[in] rgb the RGB plane for the `RGBD` layout.
+     *  \param[in] rgbBytes size (in bytes) of `rgb`.
+     */
+    void PCFileWriter::write (uint64_t timestamp, const char *data, uint32_t bytes, 
+                              const char *rgb, uint32_t rgbBytes)
+    {
+        if (!file.is_open ())
+            throw "The point cloud file is closed";
+
+        PCChunkHeader chunk { timestamp, header.frames, bytes + rgbBytes, 
+                              (rgb != nullptr) ? bytes : 0, 0 };
+        file.write ((char *) &chunk, sizeof (chunk));
+        pad (file, sizeof (chunk));
+
+        file.write (data, bytes);
+        if (rgb != nullptr)
+            file.write (rgb, rgbBytes);
+        pad (file, chunk.bytes);
+
+        if (!file)
+            throw "Failed to write in the point cloud file";
+
+        header.frames++;
+    }
+
+
+    /*! \details The call has no effect if the file is already closed. */
+    void PCFileWriter::close ()
+    {
+        if (!file.is_open ()) return;
+
+        file.seekp (0);
+        file.write ((char *) &header, sizeof (header));
+        file.close ();
+    }
+
+
+    /*! \return The number of frames. */
+    unsigned int PCFileWriter::frames () const
+    {
+        return header.frames;
+    }
+
+
+    /*! \details The file is mapped privately, so that the pages can be handed 
+     *           to `CL_MEM_USE_HOST_PTR` buffers, while the file stays intact.
+     *           The chunks are indexed once, since compressed frames vary in size.
+     *
+     *  \param[in] path path to the file.
+     */
+    PCFile::PCFile (const std::string &path) : fd (-1), base (nullptr), bytes (0)
+    {
+        const unsigned int rawBytes = 640 * 480 * sizeof (cl_float8);
+
+        fd = open (path.c_str (), O_RDONLY);
+        if (fd < 0)
+            throw "Failed to open the point cloud file";
+
+        struct stat st;
+        if (fstat (fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close (fd);
+            throw "Failed to read the point cloud file";
+        }
+        bytes = st.st_size;
+
+        void *ptr = mmap (nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close (fd);
+            throw "Failed to map the point cloud file";
+        }
+        base = (unsigned char *) ptr;
+        madvise (base, bytes, MADV_SEQUENTIAL);
+
+        bool valid = true;
+        if (bytes >= sizeof (PCFileHeader) && std::memcmp (base, "ICPC", 4) == 0)
+        {
+            std::memcpy (&header, base, sizeof (header));
+            if (header.version < 2)
+                header.compression = PCFileCompression::NONE;
+
+            valid = header.version <= pcFileVersion && 
+                    (header.layout == PCFileLayout::FLOAT8 || header.layout == PCFileLayout::RGBD) && 
+                    header.frameBytes == frameSize (header.layout, (uint64_t) header.width * header.height);
+
+            // Index the chunks
+            uint64_t offset = header.dataOffset;
+            for (unsigned int i = 0; valid && i < header.frames; ++i)
+            {
+                if (offset + alignSize (sizeof (PCChunkHeader)) > bytes)
+                {
+                    valid = false;
+                    break;
+                }
+
+                offsets.push_back (offset);
+                PCChunkHeader c = chunk (i);
+                uint64_t payload = (c.bytes == 0) ? header.frameBytes : c.bytes;
+                offset += alignSize (sizeof (PCChunkHeader)) + alignSize (payload);
+
+                valid = offsets[i] + alignSize (sizeof (PCChunkHeader)) + payload <= bytes;
+            }
+        }
+        else if (bytes % rawBytes == 0)
+        {
+            // Raw dump, without a header
+            std::memset (&header, 0, sizeof (header));
+            std::memcpy (header.magic, "ICPC", 4);
+            header.version = 0;
+            header.width = 640;
+            header.height = 480;
+            header.layout = PCFileLayout::FLOAT8;
+            header.fx = 595.f;
+            header.fy = 595.f;
+            header.cx = (640 - 1) / 2.f;
+            header.cy = (480 - 1) / 2.f;
+            header.frames = bytes / rawBytes;
+            header.frameBytes = rawBytes;
+            header.chunkBytes = rawBytes;
+            header.dataOffset = 0;
+            header.compression = PCFileCompression::NONE;
+
+            for (unsigned int i = 0; i < header.frames; ++i)
+                offsets.push_back ((uint64_t) i * rawBytes);
+        }
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            munmap (base, bytes);
+            ::close (fd);
+            throw "Invalid point cloud file";
+        }
+    }
+
+
+    PCFile::~PCFile ()
+    {
+        munmap (base, bytes);
+        ::close (fd);
+    }
+
+
+    /*! \return The header. */
+    const PCFileHeader& PCFile::getHeader () const
+    {
+        return header;
+    }
+
+
+    /*! \return The number of frames. */
+    unsigned int PCFile::frames () const
+    {
+        return header.frames;
+    }
+
+
+    /*! \param[in] idx index of the chunk.
+     *  \return The header of the chunk.
+     */
+    PCChunkHeader PCFile::chunk (unsigned int idx) const
+    {
+        PCChunkHeader c;
+        std::memcpy (&c, base + offsets[idx], sizeof (c));
+
+        return c;
+    }
+
+
+    /*! \details The frames start on page boundaries.
+     *
+     *  \param[in] idx index of the frame.
+     *  \return A pointer to the first point of the frame.
+     */
+    const cl_float8* PCFile::frame (unsigned int idx) const
+    {
+        if (idx >= header.frames)
+            throw "Frame index out of range";
+
+        if (header.layout != PCFileLayout::FLOAT8)
+            throw "The point cloud file doesn't hold FLOAT8 frames";
+
+        uint64_t offset = offsets[idx];
+        if (header.version > 0)
+            offset += alignSize (sizeof (PCChunkHeader));
+
+        return (const cl_float8 *) (base + offset);
+    }
+
+
+    /*! \details Decompresses, or copies, the frames from the mapped pages.
+     *
+     *  \param[in] idx index of the frame.
+     *  \param[out] depth array that receives the depth frame, `width*height` values.
+     *  \param[out] rgb array that receives the RGB frame, `3*width*height` values.
+     */
+    void PCFile::readRGBD (unsigned int idx, uint16_t *depth, uint8_t *rgb) const
+    {
+        if (idx >= header.frames)
+            throw "Frame index out of range";
+
+        if (header.layout != PCFileLayout::RGBD)
+            throw "The point cloud file doesn't hold RGBD frames";
+
+        const uint64_t n = (uint64_t) header.width * header.height;
+        PCChunkHeader c = chunk (idx);
+        const unsigned char *data = base + offsets[idx] + alignSize (sizeof (PCChunkHeader));
+
+        if (header.compression == PCFileCompression::RLE)
+        {
+            if (!decodeRLE ((const uint16_t *) data, c.depthBytes / sizeof (uint16_t), depth, n))
+                throw "Corrupted depth frame";
+        }
+        else
+            std::memcpy (depth, data, n * sizeof (uint16_t));
+
+        std::memcpy (rgb, data + c.depthBytes, 3 * n);
+    }
+
+
+    /*! \param[in] idx index of the frame.
+     *  \return The timestamp, or `0` for raw dumps.
+     */
+    uint64_t PCFile::timestamp (unsigned int idx) const
+    {
+        if (idx >= header.frames)
+            throw "Frame index out of range";
+
+        if (header.version == 0) return 0;
+
+        return chunk (idx).timestamp;
+    }
+
+
+    /*! \details The buffer is read-only and uses the mapped pages as its storage. 
+     *           The buffer must not outlive the `PCFile` instance.
+     *
+     *  \param[in] context the context in which to create the buffer.
+     *  \param[in] idx index of the frame.
+     *  \return The buffer.
+     */
+    cl::Buffer PCFile::buffer (const cl::Context &context, unsigned int idx) const
+    {
+        return cl::Buffer (context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, 
+                           header.frameBytes, (void *) frame (idx));
+    }
+
+}
+}
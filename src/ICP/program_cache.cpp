@@ -0,0 +1,589 @@
+/*! \file program_cache.cpp
+ *  \brief Defines an on-disk cache of OpenCL program binaries and launch configurations.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ICP/program_cache.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Computes the 64-bit FNV-1a hash of a string.
+     *  \details Unlike `std::hash`, the result is stable across runs and 
+     *           standard library implementations, so it can name files.
+     */
+    static uint64_t fnv1a (const std::string &str)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char ch : str)
+        {
+            hash ^= ch;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+
+    /*! \brief Reads the contents of a file.
+     *  \return True on success.
+     */
+    static bool readFile (const std::string &filename, std::string &contents)
+    {
+        std::ifstream file (filename, std::ios::in | std::ios::binary);
+        if (!file) return false;
+
+        std::ostringstream ss;
+        ss << file.rdbuf ();
+        contents = ss.str ();
+
+        return true;
+    }
+
+
+    /*! \brief Produces a temporary name for a file that is about to be replaced.
+     *  \details The name holds the process id and a per process counter, so 
+     *           concurrent writers, in the same or in different processes, 
+     *           never share a temporary file.
+     */
+    static std::string tempPath (const std::string &path)
+    {
+        static std::atomic<unsigned int> counter (0);
+
+        std::ostringstream tmpPath;
+        tmpPath << path << "." << getpid () << "." << counter++ << ".tmp";
+
+        return tmpPath.str ();
+    }
+
+
+    /*! \brief Extracts the include directories (`-I`) from the build options. */
+    static std::vector<std::string> includeDirs (const char *build_options)
+    {
+        std::vector<std::string> dirs;
+        if (build_options == nullptr) return dirs;
+
+        std::istringstream options (build_options);
+        std::string option;
+        while (options >> option)
+        {
+            if (option.compare (0, 2, "-I") != 0) continue;
+            if (option.size () > 2) dirs.push_back (option.substr (2));
+            else if (options >> option) dirs.push_back (option);
+        }
+
+        return dirs;
+    }
+
+
+    /*! \brief Appends the files that a kernel source includes to the cache key.
+     *  \details Follows the `#include` directives recursively. A name is looked up 
+     *           next to the including file, and then in the include directories. 
+     *           Files that can't be found are left to the compiler to report.
+     *
+     *  \param[in] source contents of the including file.
+     *  \param[in] filename name of the including file.
+     *  \param[in] dirs include directories.
+     *  \param[in,out] visited files already in the key.
+     *  \param[out] key cache key.
+     */
+    static void appendIncludes (const std::string &source, const std::string &filename, 
+                                const std::vector<std::string> &dirs, 
+                                std::set<std::string> &visited, std::ostringstream &key)
+    {
+        size_t slash = filename.find_last_of ('/');
+        std::string dir = (slash == std::string::npos) ? "." : filename.substr (0, slash);
+
+        std::istringstream lines (source);
+        std::string line;
+        while (std::getline (lines, line))
+        {
+            size_t pos = line.find_first_not_of (" \t");
+            if (pos == std::string::npos || line[pos] != '#') continue;
+            pos = line.find_first_not_of (" \t", pos + 1);
+            if (pos == std::string::npos || line.compare (pos, 7, "include") != 0) continue;
+
+            size_t begin = line.find_first_of ("\"<", pos + 7);
+            if (begin == std::string::npos) continue;
+            size_t end = line.find_first_of ("\">", begin + 1);
+            if (end == std::string::npos) continue;
+            std::string name = line.substr (begin + 1, end - begin - 1);
+
+            std::vector<std::string> candidates { dir + "/" + name };
+            for (auto &d : dirs)
+                candidates.push_back (d + "/" + name);
+
+            for (auto &candidate : candidates)
+            {
+                std::string contents;
+                if (!readFile (candidate, contents)) continue;
+
+                if (visited.insert (candidate).second)
+                {
+                    key << candidate << '\n' << contents;
+                    appendIncludes (contents, candidate, dirs, visited, key);
+                }
+                break;
+            }
+        }
+    }
+
+
+    /*! \brief Reads the binaries of a program from the cache.
+     *  \details The file holds the number of binaries, followed by 
+     *           the size and the contents of each binary.
+     *  \return True if there was a binary for every device.
+     */
+    static bool loadBinaries (const std::string &path, size_t nDevices, 
+                              std::vector<std::vector<unsigned char>> &binaries)
+    {
+        std::ifstream file (path, std::ios::in | std::ios::binary);
+        if (!file) return false;
+
+        uint64_t n;
+        if (!file.read ((char *) &n, sizeof (n)) || n != nDevices) return false;
+
+        binaries.resize (n);
+        for (auto &binary : binaries)
+        {
+            uint64_t size;
+            if (!file.read ((char *) &size, sizeof (size)) || size == 0) return false;
+
+            binary.resize (size);
+            if (!file.read ((char *) binary.data (), size)) return false;
+        }
+
+        return true;
+    }
+
+
+    /*! \brief Stores the binaries of a program in the cache.
+     *  \details The file is written under a unique temporary name and then renamed, 
+     *           so concurrent processes never see a partially written file.
+     */
+    static void storeBinaries (const std::string &path, cl::Program &program)
+    {
+        std::vector<size_t> sizes = program.getInfo<CL_PROGRAM_BINARY_SIZES> ();
+
+        std::vector<std::vector<unsigned char>> binaries (sizes.size ());
+        std::vector<unsigned char *> ptrs (sizes.size ());
+        for (size_t i = 0; i < sizes.size (); ++i)
+        {
+            if (sizes[i] == 0) return;
+            binaries[i].resize (sizes[i]);
+            ptrs[i] = binaries[i].data ();
+        }
+
+        // cl::Program::getInfo doesn't allocate the binary buffers, so query them directly
+        if (clGetProgramInfo (program (), CL_PROGRAM_BINARIES, 
+                              ptrs.size () * sizeof (unsigned char *), ptrs.data (), nullptr) != CL_SUCCESS)
+            return;
+
+        std::string tmpPath = tempPath (path);
+        {
+            std::ofstream file (tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file) return;
+
+            uint64_t n = binaries.size ();
+            file.write ((const char *) &n, sizeof (n));
+            for (auto &binary : binaries)
+            {
+                uint64_t size = binary.size ();
+                file.write ((const char *) &size, sizeof (size));
+                file.write ((const char *) binary.data (), size);
+            }
+
+            if (!file) { std::remove (tmpPath.c_str ()); return; }
+        }
+
+        if (std::rename (tmpPath.c_str (), path.c_str ()) != 0)
+            std::remove (tmpPath.c_str ());
+    }
+
+
+    /*! \brief Makes sure that the placeholder program, which reserves 
+     *         a program index on a cache hit, is in the cache.
+     *  \return True if the file is in place.
+     */
+    static bool placeholderFile (const std::string &cacheDir, std::string &filename)
+    {
+        filename = cacheDir + "/placeholder.cl";
+
+        std::string contents;
+        if (readFile (filename, contents)) return true;
+
+        std::ofstream (filename) << "kernel void placeholder () {}\n";
+        return readFile (filename, contents);
+    }
+
+
+    /*! \details The cache files are named after the hash of the key, `<cacheDir>/<hash>.bin`.
+     *
+     *  \param[in] env the OpenCL environment.
+     *  \param[in] ctxIdx index of the context on which the program will be built.
+     *  \param[in] kernel_filenames names of the files holding the kernel sources.
+     *  \param[in] build_options options passed to the compiler.
+     *  \param[in] cacheDir directory holding the cached binaries. If empty, the 
+     *                      cache is disabled, and the call falls through to `addProgram`.
+     *  \return A reference to the program inside the environment.
+     */
+    cl::Program& addProgramCached (clutils::CLEnv &env, unsigned int ctxIdx, 
+                                   const std::vector<std::string> &kernel_filenames, 
+                                   const char *build_options, const std::string &cacheDir)
+    {
+        if (cacheDir.empty ())
+            return env.addProgram (ctxIdx, kernel_filenames, nullptr, build_options);
+
+        // Build the cache key
+        cl::Context &context = env.getContext (ctxIdx);
+        std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES> ();
+
+        std::ostringstream key;
+        for (auto &device : devices)
+            key << device.getInfo<CL_DEVICE_NAME> () << '\n' 
+                << device.getInfo<CL_DEVICE_VERSION> () << '\n' 
+                << device.getInfo<CL_DRIVER_VERSION> () << '\n';
+        key << (build_options ? build_options : "") << '\n';
+        std::vector<std::string> dirs = includeDirs (build_options);
+        std::set<std::string> visited;
+        for (auto &filename : kernel_filenames)
+        {
+            std::string source;
+            if (!readFile (filename, source))  // Let addProgram report the error
+                return env.addProgram (ctxIdx, kernel_filenames, nullptr, build_options);
+            key << source;
+            appendIncludes (source, filename, dirs, visited, key);
+        }
+
+        std::ostringstream path;
+        path << cacheDir << "/" << std::hex << std::setw (16) << std::setfill ('0') 
+             << fnv1a (key.str ()) << ".bin";
+
+        mkdir (cacheDir.c_str (), 0755);
+
+        // Cache hit
+        std::vector<std::vector<unsigned char>> binaries;
+        if (loadBinaries (path.str (), devices.size (), binaries))
+        {
+            cl::Program::Binaries bins;
+            for (auto &binary : binaries)
+                bins.push_back (std::make_pair ((const void *) binary.data (), binary.size ()));
+
+            try
+            {
+                cl_int err = CL_SUCCESS;
+                cl::Program program (context, devices, bins, nullptr, &err);
+                if (err == CL_SUCCESS && program.build (devices, build_options) == CL_SUCCESS)
+                {
+                    // Reserve a program index with a trivial program, and swap in the cached one
+                    std::string placeholder;
+                    if (placeholderFile (cacheDir, placeholder))
+                    {
+                        cl::Program &slot = env.addProgram (ctxIdx, { placeholder });
+                        slot = program;
+                        return slot;
+                    }
+                }
+            }
+            catch (const cl::Error &)
+            {
+                // The driver rejected the binaries, fall back to the sources
+            }
+        }
+
+        // Cache miss
+        cl::Program &program = env.addProgram (ctxIdx, kernel_filenames, nullptr, build_options);
+        storeBinaries (path.str (), program);
+
+        return program;
+    }
+
+
+    /*! \details The scaling factor is printed with enough digits to round-trip exactly. 
+     *           e.g. `-D ICP_M=16384 -D ICP_C=1.000000000e-06f -D ICP_WG=64`.
+     *
+     *  \param[in] m number of points in the sets.
+     *  \param[in] c scaling factor of the `S` matrix kernels.
+     *  \param[in] wg local workspace size of the reductions. If `0`, it's left to the classes.
+     *  \return The build options.
+     */
+    std::string specializationOptions (unsigned int m, float c, unsigned int wg)
+    {
+        std::ostringstream options;
+        options << "-D ICP_M=" << m << " -D ICP_C=" 
+                << std::scientific << std::setprecision (9) << c << "f";
+        if (wg != 0) options << " -D ICP_WG=" << wg;
+
+        return options.str ();
+    }
+
+
+    /*! \param[in] env the OpenCL environment.
+     *  \param[in] ctxIdx index of the context on which the program will be built.
+     *  \param[in] kernel_filenames names of the files holding the kernel sources.
+     *  \param[in] m number of points in the sets.
+     *  \param[in] c scaling factor of the `S` matrix kernels.
+     *  \param[in] wg local workspace size of the reductions. If `0`, it's left to the classes.
+     *  \param[in] build_options additional options passed to the compiler.
+     *  \param[in] cacheDir directory holding the cached binaries. If empty, the cache is disabled.
+     *  \return A reference to the program inside the environment.
+     */
+    cl::Program& addProgramSpecialized (clutils::CLEnv &env, unsigned int ctxIdx, 
+                                        const std::vector<std::string> &kernel_filenames, 
+                                        unsigned int m, float c, unsigned int wg, 
+                                        const char *build_options, const std::string &cacheDir)
+    {
+        std::string options = specializationOptions (m, c, wg);
+        if (build_options) options = std::string (build_options) + " " + options;
+
+        return addProgramCached (env, ctxIdx, kernel_filenames, options.c_str (), cacheDir);
+    }
+
+
+    /*! \param[in] program the program.
+     *  \param[in] device the device for which the program was built.
+     *  \param[out] m number of points in the sets, or `0` if it's not fixed.
+     *  \param[out] c scaling factor of the `S` matrix kernels, or `0` if it's not fixed.
+     */
+    void getSpecialization (const cl::Program &program, const cl::Device &device, unsigned int &m, float &c)
+    {
+        std::string options = program.getBuildInfo<CL_PROGRAM_BUILD_OPTIONS> (device);
+
+        m = 0; c = 0.f;
+
+        size_t pos = options.find ("-D ICP_M=");
+        if (pos != std::string::npos)
+            m = std::stoul (options.substr (pos + 9));
+
+        pos = options.find ("-D ICP_C=");
+        if (pos != std::string::npos)
+            c = std::stof (options.substr (pos + 9));
+    }
+
+
+    /*! \param[in] kernel the kernel.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \return The local workspace size.
+     */
+    size_t getWorkGroupMultiple (const cl::Kernel &kernel, const cl::Device &device)
+    {
+        cl::size_t<3> compiled = kernel.getWorkGroupInfo<CL_KERNEL_COMPILE_WORK_GROUP_SIZE> (device);
+        if (compiled[0] != 0) return compiled[0];
+
+        WorkGroupConfig config;
+        if (getTunedConfig (kernel, device, config) && config.local != 0 && 
+            config.local <= kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE> (device))
+            return config.local;
+
+        return kernel.getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (device);
+    }
+
+
+    /*! \brief The tuned launch configurations of a device. */
+    struct TunedConfigs
+    {
+        bool loaded;  /*!< Whether the file of the device has been read. */
+        std::map<std::string, WorkGroupConfig> configs;  /*!< Configurations per kernel name. */
+    };
+
+
+    /*! \brief Guards the tuning directory and the tables of launch configurations. 
+     *  \details The classes look up their configurations on construction, which 
+     *           may happen concurrently on independent pipelines.
+     */
+    static std::mutex tuneMutex;
+    static std::string tuneDirectory { "kernels/tuning" };
+    static std::map<std::string, TunedConfigs> tuneTables;
+
+
+    /*! \brief Returns the path of the tuning file of a device. */
+    static std::string tuningPath (const cl::Device &device)
+    {
+        std::ostringstream key;
+        key << device.getInfo<CL_DEVICE_NAME> () << '\n' 
+            << device.getInfo<CL_DEVICE_VERSION> () << '\n' 
+            << device.getInfo<CL_DRIVER_VERSION> () << '\n';
+
+        std::ostringstream path;
+        path << tuneDirectory << "/" << std::hex << std::setw (16) << std::setfill ('0') 
+             << fnv1a (key.str ()) << ".txt";
+
+        return path.str ();
+    }
+
+
+    /*! \brief Returns the table of a device, reading its tuning file on first use.
+     *  \details The file holds a line per kernel, `<name> <local> <ept>`. 
+     *           Malformed lines are ignored.
+     *  \note `tuneMutex` has to be held by the caller.
+     */
+    static TunedConfigs& tuningTable (const cl::Device &device)
+    {
+        std::string path = tuningPath (device);
+        TunedConfigs &table = tuneTables[path];
+        if (table.loaded) return table;
+
+        table.loaded = true;
+        if (tuneDirectory.empty ()) return table;
+
+        std::ifstream file (path);
+        std::string line;
+        while (std::getline (file, line))
+        {
+            std::istringstream ss (line);
+            std::string name;
+            WorkGroupConfig config;
+            if (ss >> name >> config.local >> config.ept)
+                table.configs.emplace (name, config);
+        }
+
+        return table;
+    }
+
+
+    /*! \param[in] tuneDir the directory. If empty, nothing is loaded or stored.
+     */
+    void setTuningDir (const std::string &tuneDir)
+    {
+        std::lock_guard<std::mutex> lock (tuneMutex);
+        tuneDirectory = tuneDir;
+        tuneTables.clear ();
+    }
+
+
+    /*! \param[in] kernelName name of the kernel function.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \param[out] config the configuration. It's left untouched if there is none.
+     *  \return True if there is a configuration.
+     */
+    bool getTunedConfig (const std::string &kernelName, const cl::Device &device, WorkGroupConfig &config)
+    {
+        std::lock_guard<std::mutex> lock (tuneMutex);
+        TunedConfigs &table = tuningTable (device);
+
+        auto it = table.configs.find (kernelName);
+        if (it == table.configs.end ()) return false;
+
+        config = it->second;
+        return true;
+    }
+
+
+    /*! \param[in] kernel the kernel.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \param[out] config the configuration. It's left untouched if there is none.
+     *  \return True if there is a configuration.
+     */
+    bool getTunedConfig (const cl::Kernel &kernel, const cl::Device &device, WorkGroupConfig &config)
+    {
+        std::string name = kernel.getInfo<CL_KERNEL_FUNCTION_NAME> ();
+        // Some drivers count the terminating null character
+        name.erase (std::find (name.begin (), name.end (), '\0'), name.end ());
+
+        return getTunedConfig (name, device, config);
+    }
+
+
+    /*! \param[in] kernelName name of the kernel function.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     *  \param[in] config the configuration.
+     */
+    void setTunedConfig (const std::string &kernelName, const cl::Device &device, const WorkGroupConfig &config)
+    {
+        std::lock_guard<std::mutex> lock (tuneMutex);
+        tuningTable (device).configs[kernelName] = config;
+    }
+
+
+    /*! \param[in] kernelName name of the kernel function.
+     *  \param[in] device the device on which the kernel will be dispatched.
+     */
+    void clearTunedConfig (const std::string &kernelName, const cl::Device &device)
+    {
+        std::lock_guard<std::mutex> lock (tuneMutex);
+        tuningTable (device).configs.erase (kernelName);
+    }
+
+
+    /*! \param[in] device the device.
+     *  \return True if there are any configurations.
+     */
+    bool hasTunedConfigs (const cl::Device &device)
+    {
+        std::lock_guard<std::mutex> lock (tuneMutex);
+        return !tuningTable (device).configs.empty ();
+    }
+
+
+    /*! \param[in] device the device.
+     *  \return True on success.
+     */
+    bool storeTunedConfigs (const cl::Device &device)
+    {
+        std::lock_guard<std::mutex> lock (tuneMutex);
+        if (tuneDirectory.empty ()) return false;
+
+        TunedConfigs &table = tuningTable (device);
+        std::string path = tuningPath (device);
+        std::string tmpPath = tempPath (path);
+
+        mkdir (tuneDirectory.c_str (), 0755);
+
+        {
+            std::ofstream file (tmpPath, std::ios::out | std::ios::trunc);
+            if (!file) return false;
+
+            for (auto &entry : table.configs)
+                file << entry.first << " " << entry.second.local << " " << entry.second.ept << "\n";
+
+            if (!file) { std::remove (tmpPath.c_str ()); return false; }
+        }
+
+        if (std::rename (tmpPath.c_str (), path.c_str ()) != 0)
+        {
+            std::remove (tmpPath.c_str ());
+            return false;
+        }
+
+        return true;
+    }
+
+}
+}
@@ -0,0 +1,280 @@
+/*! \file scheduler.cpp
+ *  \brief Defines a scheduler that distributes %ICP registrations across OpenCL devices.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <ICP/scheduler.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \details Creates one `ICP<CR, CW>` pipeline, and one staging pool, for every 
+     *           pair of configurations. Pipeline `i` uses `_infoRBC[i]` and `_infoICP[i]`.
+     *
+     *  \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configurations for the `RBC` classes of the pipelines. 
+     *                      They specify the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configurations for the `ICP` classes of the pipelines. 
+     *                      They specify the context, queue, etc, to be used.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPScheduler<CR, CW>::ICPScheduler (clutils::CLEnv &_env, const std::vector< clutils::CLEnvInfo<1> > &_infoRBC, 
+                                        const std::vector< clutils::CLEnvInfo<1> > &_infoICP) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), first (0), done (0), quit (false), d (8)
+    {
+        try
+        {
+            if (infoRBC.empty ())
+                throw "The scheduler needs at least one pipeline";
+
+            if (infoRBC.size () != infoICP.size ())
+                throw "Every pipeline needs a configuration for both the RBC and the ICP classes";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPScheduler]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        regs.reserve (infoICP.size ());
+        for (size_t p = 0; p < infoICP.size (); ++p)
+        {
+            const clutils::CLEnvInfo<1> &info = infoICP[p];
+            pools.emplace_back (new StagingPool (env.getContext (info.pIdx), env.devices[info.pIdx][info.dIdx]));
+            regs.emplace_back (env, infoRBC[p], info, pools[p].get ());
+        }
+    }
+
+
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPScheduler<CR, CW>::~ICPScheduler ()
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            quit = true;
+        }
+        cvJobs.notify_all ();
+
+        for (auto &worker : workers)
+            worker.join ();
+    }
+
+
+    /*! \details Initializes every pipeline with the same parameters, and starts 
+     *           one worker thread per pipeline. Call it once, before any calls to `submit`.
+     *
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. For more info, 
+     *                look at `ICPStep::init`.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPScheduler<CR, CW>::init (unsigned int _m, unsigned int _nr, float _a, float _c, 
+        unsigned int _max_iterations, double _angle_threshold, double _translation_threshold)
+    {
+        m = _m;
+
+        try
+        {
+            if (!workers.empty ())
+                throw "The scheduler has already been initialized";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPScheduler]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        for (auto &reg : regs)
+            reg.init (m, _nr, _a, _c, _max_iterations, _angle_threshold, _translation_threshold, Staging::IO);
+
+        for (unsigned int p = 0; p < regs.size (); ++p)
+            workers.emplace_back (&ICPScheduler<CR, CW>::work, this, p);
+    }
+
+
+    /*! \details The landmark sets are copied, so the arrays can be reused 
+     *           as soon as the call returns.
+     *
+     *  \param[in] fixed array holding the fixed set of \f$ m \f$ landmarks, in `cl_float8` layout.
+     *  \param[in] moving array holding the moving set of \f$ m \f$ landmarks, in `cl_float8` layout.
+     *  \return The submission index of the pair, counting from the first submission 
+     *          after the last call to `collect`.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    size_t ICPScheduler<CR, CW>::submit (const cl_float *fixed, const cl_float *moving)
+    {
+        Job job;
+        job.fixed.assign (fixed, fixed + m * d);
+        job.moving.assign (moving, moving + m * d);
+
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            index = results.size ();
+            job.id = first + index;
+            results.emplace_back ();
+            jobs.push_back (std::move (job));
+        }
+        cvJobs.notify_one ();
+
+        return index;
+    }
+
+
+    /*! \details Blocks until every submitted pair has been registered.
+     *
+     *  \return The results of the registrations, in submission order.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    std::vector< ICPSchedulerResult, Eigen::aligned_allocator<ICPSchedulerResult> > 
+    ICPScheduler<CR, CW>::collect ()
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        cvDone.wait (lock, [this] { return done == first + results.size (); });
+
+        std::vector< ICPSchedulerResult, Eigen::aligned_allocator<ICPSchedulerResult> > out;
+        out.swap (results);
+        first = done;
+
+        return out;
+    }
+
+
+    /*! \return The number of pipelines. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    size_t ICPScheduler<CR, CW>::pipelines ()
+    {
+        return regs.size ();
+    }
+
+
+    /*! \return The number of iterations enqueued between convergence checks. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    unsigned int ICPScheduler<CR, CW>::getBatchSize ()
+    {
+        return regs[0].getBatchSize ();
+    }
+
+
+    /*! \details Forwards to `ICP::setBatchSize` on every pipeline.
+     *  \note It should be called while there are no pending registrations, 
+     *        i.e. before the first `submit`, or right after a `collect`.
+     *  
+     *  \param[in] _batch_size number of iterations per batch.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPScheduler<CR, CW>::setBatchSize (unsigned int _batch_size)
+    {
+        for (auto &reg : regs)
+            reg.setBatchSize (_batch_size);
+    }
+
+
+    /*! \details Waits on the work queue, and registers the pairs it gets on pipeline `p`. 
+     *           The registration is blocking, so the staging buffers of the pipeline 
+     *           can be refilled right after.
+     *
+     *  \param[in] p index of the pipeline.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPScheduler<CR, CW>::work (unsigned int p)
+    {
+        ICP<CR, CW> &reg = regs[p];
+
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                cvJobs.wait (lock, [this] { return quit || !jobs.empty (); });
+                if (jobs.empty ()) return;
+
+                job = std::move (jobs.front ());
+                jobs.pop_front ();
+            }
+
+            auto start = std::chrono::steady_clock::now ();
+
+            // Load the identity transformation
+            reg.q = Eigen::Quaternionf::Identity ();
+            reg.R = Eigen::Matrix3f::Identity ();
+            reg.t.setZero ();
+            reg.s = 1.f;
+
+            Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT, 4) = reg.q.coeffs ();  // Quaternion
+            Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT + 4, 4) = reg.t.homogeneous ();  // Translation
+            reg.hPtrIOT[7] = reg.s;  // Scale
+
+            reg.write (ICPStep<CR, CW>::Memory::D_IN_F, job.fixed.data ());
+            reg.write (ICPStep<CR, CW>::Memory::D_IN_M, job.moving.data ());
+            reg.write (ICPStep<CR, CW>::Memory::D_IO_T);
+
+            reg.buildRBC ();  // Build the RBC data structure
+            reg.run ();  // Perform the ICP registration
+
+            ICPSchedulerResult res;
+            res.q = reg.q;
+            res.t = reg.t;
+            res.s = reg.s;
+            res.k = reg.k;
+            res.pipeline = p;
+            res.time = std::chrono::duration<double, std::milli> (
+                std::chrono::steady_clock::now () - start).count ();
+
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                results[job.id - first] = res;
+                ++done;
+            }
+            cvDone.notify_all ();
+        }
+    }
+
+
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors. */
+    template class ICPScheduler<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
+    template class ICPScheduler<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors. */
+    template class ICPScheduler<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors. */
+    template class ICPScheduler<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+
+}
+}
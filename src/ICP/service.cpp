@@ -0,0 +1,284 @@
+/*! \file service.cpp
+ *  \brief Defines a service that runs concurrent %ICP sessions on a shared OpenCL environment.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <chrono>
+#include <ICP/program_cache.hpp>
+#include <ICP/service.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \details The pipeline uses the same queue for both the `RBC` and the `%ICP` classes. 
+     *           It's constructed and initialized while the service lock is held by `open`.
+     *
+     *  \param[in] _service the service that opened the session.
+     *  \param[in] _qIdx index of the command queue of the session.
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations. For more info, 
+     *                look at `ICPStep::init`.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPSession<CR, CW>::ICPSession (ICPService<CR, CW> &_service, unsigned int _qIdx, unsigned int _m, 
+                                    unsigned int _nr, float _a, float _c, unsigned int _max_iterations, 
+                                    double _angle_threshold, double _translation_threshold) : 
+        service (_service), qIdx (_qIdx), queue (service.env.getQueue (0, qIdx)), 
+        pool (service.env.getContext (0), service.env.devices[0][service.dIdx]), 
+        reg (service.env, clutils::CLEnvInfo<1> (0, service.dIdx, 0, { qIdx }, 0), 
+             clutils::CLEnvInfo<1> (0, service.dIdx, 0, { qIdx }, 1), &pool), 
+        time (0.0), k (0), m (_m), d (8)
+    {
+        reg.init (m, _nr, _a, _c, _max_iterations, _angle_threshold, _translation_threshold, Staging::IO);
+        reset ();
+    }
+
+
+    /*! \details Waits for the commands of the session, so that the next session can take its queue right away. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPSession<CR, CW>::~ICPSession ()
+    {
+        queue.finish ();
+        service.release (qIdx);
+    }
+
+
+    /*! \details The registration starts from the pose of the session, and is blocking. 
+     *           Its estimate becomes the new pose. The landmark sets are copied to the 
+     *           staging buffers, so the arrays can be reused as soon as the call returns.
+     *
+     *  \param[in] fixed array holding the fixed set of \f$ m \f$ landmarks, in `cl_float8` layout.
+     *  \param[in] moving array holding the moving set of \f$ m \f$ landmarks, in `cl_float8` layout.
+     *  \return The outcome of the registration. `pipeline` holds the queue index of the session.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPSchedulerResult ICPSession<CR, CW>::align (const cl_float *fixed, const cl_float *moving)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        auto start = std::chrono::steady_clock::now ();
+
+        // Load the pose
+        reg.q = q;
+        reg.R = q.toRotationMatrix ();
+        reg.t = t;
+        reg.s = s;
+
+        Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT, 4) = reg.q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT + 4, 4) = reg.t.homogeneous ();  // Translation
+        reg.hPtrIOT[7] = reg.s;  // Scale
+
+        reg.write (ICPStep<CR, CW>::Memory::D_IN_F, (void *) fixed);
+        reg.write (ICPStep<CR, CW>::Memory::D_IN_M, (void *) moving);
+        reg.write (ICPStep<CR, CW>::Memory::D_IO_T);
+
+        reg.buildRBC ();  // Build the RBC data structure
+        reg.run ();  // Perform the ICP registration
+
+        q = reg.q;
+        t = reg.t;
+        s = reg.s;
+        k = reg.k;
+        time = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+
+        ICPSchedulerResult res;
+        res.q = q;
+        res.t = t;
+        res.s = s;
+        res.k = k;
+        res.pipeline = qIdx;
+        res.time = time;
+
+        return res;
+    }
+
+
+    /*! \details Use it when a stream starts over, e.g. after a tracking loss. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPSession<CR, CW>::reset ()
+    {
+        setPose (Eigen::Quaternionf::Identity (), Eigen::Vector3f::Zero (), 1.f);
+    }
+
+
+    /*! \return The pose of the session, and the number of iterations and the duration 
+     *          of the last registration. `pipeline` holds the queue index of the session.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPSchedulerResult ICPSession<CR, CW>::getPose ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        ICPSchedulerResult res;
+        res.q = q;
+        res.t = t;
+        res.s = s;
+        res.k = k;
+        res.pipeline = qIdx;
+        res.time = time;
+
+        return res;
+    }
+
+
+    /*! \details The pose is the initial guess of the next registration.
+     *
+     *  \param[in] _q rotation, given in quaternion representation.
+     *  \param[in] _t translation, given as a vector in 3-D.
+     *  \param[in] _s scale.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPSession<CR, CW>::setPose (const Eigen::Quaternionf &_q, const Eigen::Vector3f &_t, cl_float _s)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        q = _q; t = _t; s = _s;
+    }
+
+
+    /*! \return The index of the command queue of the session. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    unsigned int ICPSession<CR, CW>::index ()
+    {
+        return qIdx;
+    }
+
+
+    /*! \details Creates a context on platform `0`, and adds the `RBC` and the `%ICP` 
+     *           programs to it, with indices `0` and `1`, respectively.
+     *
+     *  \param[in] kernel_files_rbc names of the files holding the `RBC` kernel sources.
+     *  \param[in] kernel_files_icp names of the files holding the reduce, scan and `%ICP` kernel sources.
+     *  \param[in] _dIdx index of the device in the context, on which the sessions will run.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    ICPService<CR, CW>::ICPService (const std::vector<std::string> &kernel_files_rbc, 
+                                    const std::vector<std::string> &kernel_files_icp, unsigned int _dIdx) : 
+        dIdx (_dIdx), nQueues (0)
+    {
+        env.addContext (0);
+        addProgramCached (env, 0, kernel_files_rbc);
+        addProgramCached (env, 0, kernel_files_icp);
+    }
+
+
+    /*! \details Takes the queue of a closed session, if there is one, or adds a new queue 
+     *           to the context. The session is ready to `align` when the call returns.
+     *
+     *  \param[in] _m number of points in the sets.
+     *  \param[in] _nr number of fixed set representatives.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. For more info, 
+     *                look at `ICPStep::init`.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     *  \return The session.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    std::unique_ptr< ICPSession<CR, CW> > 
+    ICPService<CR, CW>::open (unsigned int _m, unsigned int _nr, float _a, float _c, 
+        unsigned int _max_iterations, double _angle_threshold, double _translation_threshold)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        unsigned int qIdx;
+        if (freeQueues.empty ())
+        {
+            env.addQueue (0, dIdx);
+            qIdx = nQueues++;
+        }
+        else
+        {
+            qIdx = freeQueues.back ();
+            freeQueues.pop_back ();
+        }
+
+        return std::unique_ptr< ICPSession<CR, CW> > (new ICPSession<CR, CW> (
+            *this, qIdx, _m, _nr, _a, _c, _max_iterations, _angle_threshold, _translation_threshold));
+    }
+
+
+    /*! \return The number of open sessions. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    size_t ICPService<CR, CW>::sessions ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        return nQueues - freeQueues.size ();
+    }
+
+
+    /*! \note Adding queues or programs to the environment, while sessions run, isn't thread-safe.
+     *
+     *  \return A reference to the OpenCL environment.
+     */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    clutils::CLEnv& ICPService<CR, CW>::getEnv ()
+    {
+        return env;
+    }
+
+
+    /*! \param[in] qIdx index of the command queue of the session. */
+    template <ICPStepConfigT CR, ICPStepConfigW CW>
+    void ICPService<CR, CW>::release (unsigned int qIdx)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        freeQueues.push_back (qIdx);
+    }
+
+
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors. */
+    template class ICPSession<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
+    template class ICPSession<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors. */
+    template class ICPSession<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors. */
+    template class ICPSession<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors. */
+    template class ICPService<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
+    template class ICPService<ICPStepConfigT::EIGEN, ICPStepConfigW::WEIGHTED>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers regular residual errors. */
+    template class ICPService<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::REGULAR>;
+    /*! \brief Instantiation that uses the Power Method to estimate the rotation, and considers weighted residual errors. */
+    template class ICPService<ICPStepConfigT::POWER_METHOD, ICPStepConfigW::WEIGHTED>;
+
+}
+}
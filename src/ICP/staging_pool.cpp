@@ -0,0 +1,238 @@
+/*! \file staging_pool.cpp
+ *  \brief Defines a pool of pinned host memory for the staging buffers of the `cl_algo::ICP` classes.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <ICP/staging_pool.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \details The blocks are aligned to `CL_DEVICE_MEM_BASE_ADDR_ALIGN`, 
+     *           as required for the origin of a sub-buffer.
+     *
+     *  \param[in] _context context in which to allocate the slabs.
+     *  \param[in] device device whose alignment requirement the blocks satisfy.
+     *  \param[in] _slabSize size (in bytes) of a slab. Larger requests get a slab of their own.
+     */
+    StagingPool::StagingPool (const cl::Context &_context, const cl::Device &device, size_t _slabSize) : 
+        context (_context), 
+        alignment (std::max<size_t> (device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN> () / 8, 1)), 
+        slabSize (_slabSize), total (0)
+    {
+    }
+
+
+    /*! \param[in] size size (in bytes) of the buffer.
+     *  \return A sub-buffer of one of the slabs.
+     */
+    cl::Buffer StagingPool::allocate (size_t size)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        size = align (std::max<size_t> (size, 1));
+
+        // First fit among the free blocks
+        Block block { 0, 0, 0 };
+        bool found = false;
+        for (size_t s = 0; s < freeBlocks.size () && !found; ++s)
+        {
+            for (auto it = freeBlocks[s].begin (); it != freeBlocks[s].end (); ++it)
+            {
+                if (it->size < size) continue;
+
+                block = { s, it->offset, size };
+                it->offset += size;
+                it->size -= size;
+                if (it->size == 0) freeBlocks[s].erase (it);
+                found = true;
+                break;
+            }
+        }
+
+        // Otherwise, add a slab
+        if (!found)
+        {
+            size_t bytes = std::max (slabSize, size);
+            slabBuffers.emplace_back (context, CL_MEM_ALLOC_HOST_PTR, bytes);
+            total += bytes;
+            freeBlocks.emplace_back ();
+            if (bytes > size)
+                freeBlocks.back ().push_back ({ slabBuffers.size () - 1, size, bytes - size });
+
+            block = { slabBuffers.size () - 1, 0, size };
+        }
+
+        cl_buffer_region region { block.offset, block.size };
+        cl::Buffer buffer = slabBuffers[block.slab].createSubBuffer (
+            CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region);
+        blocks[buffer ()] = block;
+
+        return buffer;
+    }
+
+
+    /*! \details Buffers that don't come from the pool are ignored.
+     *
+     *  \param[in] buffer the staging buffer.
+     */
+    void StagingPool::release (const cl::Buffer &buffer)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        auto it = blocks.find (buffer ());
+        if (it == blocks.end ()) return;
+
+        Block block = it->second;
+        blocks.erase (it);
+
+        // Keep the free list sorted, and merge the block with its neighbors
+        std::vector<Block> &list = freeBlocks[block.slab];
+        auto next = std::find_if (list.begin (), list.end (), 
+            [&block] (const Block &b) { return b.offset > block.offset; });
+        next = list.insert (next, block);
+
+        if (next + 1 != list.end () && next->offset + next->size == (next + 1)->offset)
+        {
+            next->size += (next + 1)->size;
+            list.erase (next + 1);
+        }
+        if (next != list.begin () && (next - 1)->offset + (next - 1)->size == next->offset)
+        {
+            (next - 1)->size += next->size;
+            list.erase (next);
+        }
+    }
+
+
+    /*! \details It's meant to be called from `init`. An unassigned buffer is 
+     *           allocated. A buffer from the pool is kept, if it has the same 
+     *           (aligned) size, or it's replaced otherwise. A buffer that 
+     *           doesn't come from the pool (e.g. it was assigned through `get`) 
+     *           is kept as it is.
+     *
+     *  \param[in,out] buffer the staging buffer.
+     *  \param[in] size size (in bytes) of the buffer.
+     */
+    void StagingPool::acquire (cl::Buffer &buffer, size_t size)
+    {
+        if (buffer () != nullptr)
+        {
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+
+                auto it = blocks.find (buffer ());
+                if (it == blocks.end ()) return;
+                if (it->second.size == align (std::max<size_t> (size, 1))) return;
+            }
+
+            release (buffer);
+        }
+
+        buffer = allocate (size);
+    }
+
+
+    /*! \return The number of slabs. */
+    size_t StagingPool::slabs ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        return slabBuffers.size ();
+    }
+
+
+    /*! \return The total size (in bytes) of the slabs. */
+    size_t StagingPool::capacity ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        return total;
+    }
+
+
+    /*! \return The size (in bytes) of the allocated blocks. */
+    size_t StagingPool::used ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        size_t bytes = 0;
+        for (const auto &b : blocks)
+            bytes += b.second.size;
+
+        return bytes;
+    }
+
+
+    /*! \param[in] size a size (in bytes).
+     *  \return The size rounded up to a multiple of `alignment`.
+     */
+    size_t StagingPool::align (size_t size) const
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+
+
+    /*! \details A block that `acquire` has replaced, is forgotten, since it's 
+     *           already back in the pool.
+     *
+     *  \param[in] pool pool the buffer was allocated from.
+     *  \param[in] buffer the staging buffer.
+     *  \param[in] previous the object the buffer held before `acquire`.
+     */
+    void StagingLease::track (StagingPool *pool, const cl::Buffer &buffer, cl_mem previous)
+    {
+        if (!blocks) blocks = std::make_shared<Blocks> ();
+        blocks->pool = pool;
+
+        std::vector<cl::Buffer> &buffers = blocks->buffers;
+        if (previous != nullptr && previous != buffer ())
+            buffers.erase (std::remove_if (buffers.begin (), buffers.end (), 
+                [previous] (const cl::Buffer &b) { return b () == previous; }), buffers.end ());
+
+        auto it = std::find_if (buffers.begin (), buffers.end (), 
+            [&buffer] (const cl::Buffer &b) { return b () == buffer (); });
+        if (it == buffers.end ())
+            buffers.push_back (buffer);
+    }
+
+
+    /*! \details Buffers that don't come from the pool (e.g. they were 
+     *           assigned through `get`) are ignored by the pool.
+     */
+    StagingLease::Blocks::~Blocks ()
+    {
+        for (const cl::Buffer &b : buffers)
+            pool->release (b);
+    }
+
+}
+}
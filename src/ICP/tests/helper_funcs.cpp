@@ -31,6 +31,7 @@
 #include <string>
 #include <chrono>
 #include <random>
+#include <cmath>
 #include <ICP/tests/helper_funcs.hpp>
 
 
@@ -74,4 +75,60 @@ namespace ICP
         return false;
     }
 
+
+    /*! \param[out] pc output points.
+     *  \param[in] n number of points.
+     */
+    void randomLMs (cl_float *pc, uint32_t n)
+    {
+        for (uint32_t j = 0; j < n; ++j)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+                pc[j * 8 + k] = 1e3f * rNum_R_0_1 ();
+            pc[j * 8 + 3] = 1.f;
+            for (uint32_t k = 4; k < 8; ++k)
+                pc[j * 8 + k] = rNum_R_0_1 ();
+        }
+    }
+
+
+    /*! \param[in] in input points.
+     *  \param[out] out output points.
+     *  \param[in] n number of points.
+     *  \param[in] angle rotation angle in radians.
+     *  \param[in] tx translation along the x axis.
+     *  \param[in] ty translation along the y axis.
+     *  \param[in] tz translation along the z axis.
+     */
+    void moveLMs (const cl_float *in, cl_float *out, uint32_t n, float angle, 
+                  float tx, float ty, float tz)
+    {
+        float c = std::cos (angle), s = std::sin (angle);
+
+        for (uint32_t j = 0; j < n; ++j)
+        {
+            const cl_float *p = in + j * 8;
+            cl_float *q = out + j * 8;
+
+            q[0] = c * p[0] - s * p[1] + tx;
+            q[1] = s * p[0] + c * p[1] + ty;
+            q[2] = p[2] + tz;
+            std::copy (p + 3, p + 8, q + 3);
+        }
+    }
+
+
+    /*! \param[out] fixed fixed set.
+     *  \param[out] moving moving set.
+     *  \param[in] n number of points in each set.
+     */
+    void registrationPair (std::vector<cl_float> &fixed, std::vector<cl_float> &moving, uint32_t n)
+    {
+        fixed.resize (n * 8);
+        moving.resize (n * 8);
+
+        randomLMs (fixed.data (), n);
+        moveLMs (fixed.data (), moving.data (), n);
+    }
+
 }
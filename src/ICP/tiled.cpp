@@ -0,0 +1,660 @@
+/*! \file tiled.cpp
+ *  \brief Defines an out-of-core %ICP pipeline for point clouds larger than device memory.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ICP/tiled.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \param[in] _env opencl environment.
+     *  \param[in] _infoRBC opencl configuration for the `RBC` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoICP opencl configuration for the `ICP` classes. 
+     *                      It specifies the context, queue, etc, to be used.
+     *  \param[in] _infoIO opencl configuration for the uploads of the tiles. 
+     *                     It should specify a queue in the same context as `_infoICP`.
+     *  \param[in] _pool pool to allocate the staging buffers from. If `nullptr`, 
+     *                   every staging buffer is a separate pinned allocation.
+     */
+    ICPTiled::ICPTiled (clutils::CLEnv &_env, clutils::CLEnvInfo<1> _infoRBC, clutils::CLEnvInfo<1> _infoICP, 
+                        clutils::CLEnvInfo<1> _infoIO, StagingPool *_pool) : 
+        env (_env), infoRBC (_infoRBC), infoICP (_infoICP), infoIO (_infoIO), pool (_pool), 
+        context (env.getContext (infoICP.pIdx)), 
+        queue (env.getQueue (infoICP.ctxIdx, infoICP.qIdx[0])), 
+        ioQueue (env.getQueue (infoIO.ctxIdx, infoIO.qIdx[0])), 
+        weightsKernel (env.getProgram (infoICP.pgIdx), "icpValidWeights"), 
+        fReps (env, infoICP, pool), rbcC (env, infoRBC), transform (env, infoICP, pool), 
+        rbcS (env, infoRBC), matrixF (env, infoICP, pool), 
+        fixed (nullptr), moving (nullptr), nF (0), nM (0), d (8)
+    {
+    }
+
+
+    /*! \details This interface exists to allow CL memory sharing between different kernels.
+     *
+     *  \param[in] mem enumeration value specifying the requested memory object.
+     *  \return A reference to the requested memory object.
+     */
+    cl::Memory& ICPTiled::get (ICPTiled::Memory mem)
+    {
+        switch (mem)
+        {
+            case ICPTiled::Memory::H_IN_F:
+                return hBufferInF;
+            case ICPTiled::Memory::H_IN_M:
+                return hBufferInM;
+            case ICPTiled::Memory::H_IO_T:
+                return hBufferIOT;
+            case ICPTiled::Memory::D_UP_F:
+                return dBufferUpF;
+            case ICPTiled::Memory::D_UP_M:
+                return dBufferUpM;
+            case ICPTiled::Memory::D_IN_F:
+                return dBufferInF;
+            case ICPTiled::Memory::D_IN_M:
+                return dBufferInM;
+            case ICPTiled::Memory::D_IO_T:
+                return dBufferIOT;
+        }
+    }
+
+
+    /*! \details Sets up memory objects as necessary, and defines the kernel workspaces.
+     *           The device memory in use is bounded by the tile size, `m`, and doesn't 
+     *           depend on the sizes of the point clouds.
+     *  \note If you have assigned a memory object to one member variable of the class 
+     *        before the call to `init`, then that memory will be maintained. Otherwise, 
+     *        a new memory object will be created.
+     *        
+     *  \param[in] _m maximum number of points in a tile, and in a chunk of moving points.
+     *  \param[in] _nr number of representatives per tile.
+     *  \param[in] _a factor scaling the results of the distance calculations for the 
+     *                geometric \f$ x_g \f$ and photometric \f$ x_p \f$ dimensions of 
+     *                the \f$ x\epsilon\mathbb{R}^8 \f$ points. For more info, look at 
+     *                `ICPStep<ICPStepConfigT::EIGEN, ICPStepConfigW::REGULAR>::init`.
+     *  \param[in] _c scaling factor for dealing with floating point arithmetic 
+     *                issues when computing the `S` matrix.
+     *  \param[in] _max_iterations maximum number of iterations that a registration is allowed to perform.
+     *  \param[in] _angle_threshold threshold for the change in angle (in degrees) in the transformation.
+     *  \param[in] _translation_threshold threshold for the change in translation (in mm) in the transformation.
+     */
+    void ICPTiled::init (unsigned int _m, unsigned int _nr, float _a, float _c, unsigned int _max_iterations, 
+        double _angle_threshold, double _translation_threshold)
+    {
+        m = _m; nr = _nr; a = _a; c = _c;
+        max_iterations = _max_iterations;
+        angle_threshold = _angle_threshold;
+        translation_threshold = _translation_threshold;
+        bufferFMSize = m * sizeof (cl_float8);
+        bufferTSize = 2 * sizeof (cl_float4);
+
+        try
+        {
+            if (m == 0)
+                throw "The tiles cannot have zero points";
+
+            if (nr == 0)
+                throw "The sets of representatives cannot have zero points";
+
+            if (nr > m)
+                throw "The sets of representatives cannot be larger than the tiles";
+
+            if (a == 0.f)
+                throw "The alpha parameter cannot be equal to zero";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTiled]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        // Create staging buffers
+        allocStaging (hBufferInF, 2 * bufferFMSize, context, pool, lease);
+        allocStaging (hBufferInM, 2 * bufferFMSize, context, pool, lease);
+        allocStaging (hBufferIOT, bufferTSize, context, pool, lease);
+
+        hPtrInF = (cl_float *) queue.enqueueMapBuffer (
+            hBufferInF, CL_FALSE, CL_MAP_WRITE, 0, 2 * bufferFMSize);
+        hPtrInM = (cl_float *) queue.enqueueMapBuffer (
+            hBufferInM, CL_FALSE, CL_MAP_WRITE, 0, 2 * bufferFMSize);
+        hPtrIOT = (cl_float *) queue.enqueueMapBuffer (
+            hBufferIOT, CL_FALSE, CL_MAP_READ, 0, bufferTSize);
+        queue.enqueueUnmapMemObject (hBufferInF, hPtrInF);
+        queue.enqueueUnmapMemObject (hBufferInM, hPtrInM);
+        queue.enqueueUnmapMemObject (hBufferIOT, hPtrIOT);
+        queue.finish ();
+
+        // Create device buffers
+        if (dBufferUpF () == nullptr)
+            dBufferUpF = cl::Buffer (context, CL_MEM_READ_ONLY, 2 * bufferFMSize);
+        if (dBufferUpM () == nullptr)
+            dBufferUpM = cl::Buffer (context, CL_MEM_READ_ONLY, 2 * bufferFMSize);
+        if (dBufferInF () == nullptr)
+            dBufferInF = cl::Buffer (context, CL_MEM_READ_WRITE, bufferFMSize);
+        if (dBufferInM () == nullptr)
+            dBufferInM = cl::Buffer (context, CL_MEM_READ_WRITE, bufferFMSize);
+        if (dBufferIOT () == nullptr)
+            dBufferIOT = cl::Buffer (context, CL_MEM_READ_WRITE, bufferTSize);
+        dBufferW = cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float));
+        dBufferSumW = cl::Buffer (context, CL_MEM_READ_ONLY, sizeof (cl_double));
+        dBufferShift = cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+
+        // Load initial identity transformation
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+        k = 0;
+
+        // Configure classes
+
+        // Classes in the tile construction step ===============================
+
+        fReps.get (ICPReps::Memory::D_IN) = dBufferInF;
+        fReps.get (ICPReps::Memory::D_OUT) = cl::Buffer (context, CL_MEM_READ_WRITE, nr * sizeof (cl_float8));
+        fReps.init (nr, m, Staging::NONE);
+
+        const RBC::KernelTypeC K1 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P1 = RBC::RBCPermuteConfig::GENERIC;
+
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_X) = dBufferInF;
+        rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_IN_R) = fReps.get (ICPReps::Memory::D_OUT);
+        rbcC.init (m, nr, d, a, 0, RBC::Staging::NONE);
+
+        // Classes in the chunk processing step ================================
+
+        const ICPTransformConfig TC = ICPTransformConfig::QUATERNION;
+
+        transform.get (ICPTransform<TC>::Memory::D_IN_M) = dBufferInM;
+        transform.get (ICPTransform<TC>::Memory::D_IN_T) = dBufferIOT;
+        transform.get (ICPTransform<TC>::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        transform.init (m, Staging::NONE);
+
+        const RBC::KernelTypeC K2 = RBC::KernelTypeC::KINECT_R;
+        const RBC::RBCPermuteConfig P2 = RBC::RBCPermuteConfig::GENERIC;
+        const RBC::KernelTypeS S2 = RBC::KernelTypeS::KINECT;
+
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_Q) = 
+            transform.get (ICPTransform<TC>::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_R) = 
+            fReps.get (ICPReps::Memory::D_OUT);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_X_P) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_X_P);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_O) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_O);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_IN_N) = 
+            rbcC.get (RBC::RBCConstruct<K1, P1>::Memory::D_OUT_N);
+        rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        rbcS.init (m, nr, m, a, RBC::Staging::NONE);
+
+        weightsKernel.setArg (0, rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P));
+        weightsKernel.setArg (1, dBufferW);
+
+        const ICPSConfig FC = ICPSConfig::FUSED;
+
+        matrixF.get (ICPS<FC>::Memory::D_IN_F) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_NN);
+        matrixF.get (ICPS<FC>::Memory::D_IN_M) = rbcS.get (RBC::RBCSearch<K2, P2, S2>::Memory::D_OUT_Q_P);
+        matrixF.get (ICPS<FC>::Memory::D_IN_W) = dBufferW;
+        matrixF.get (ICPS<FC>::Memory::D_IN_SUM_W) = dBufferSumW;
+        matrixF.get (ICPS<FC>::Memory::D_OUT_MEAN) = dBufferShift;
+        matrixF.init (m, c, Staging::O);
+    }
+
+
+    /*! \details Builds a kd-tree over the fixed set. Every node splits its points 
+     *           on the median of the longest axis of their bounding box, until 
+     *           there are at most `m` points left. The leaves are the tiles. 
+     *           The tiles are ranges of a permutation of the fixed set, so 
+     *           the points themselves are not moved.
+     *  \note The partition is computed once per fixed set, and it's kept for 
+     *        every registration against it.
+     *
+     *  \param[in] ptr array of \f$ n*8 \f$ `cl_float` elements, with the fixed set of points.
+     *  \param[in] n number of points in the fixed set.
+     */
+    void ICPTiled::setFixed (const cl_float *ptr, size_t n)
+    {
+        try
+        {
+            if (n == 0)
+                throw "The fixed set cannot have zero points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTiled]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        fixed = ptr; nF = n;
+
+        fOrder.resize (nF);
+        for (size_t i = 0; i < nF; ++i)
+            fOrder[i] = i;
+
+        nodes.assign (1, Node ());
+        tiles_.clear ();
+
+        struct Range { unsigned int node; size_t begin, end; };
+        std::vector<Range> ranges (1, Range { 0, 0, nF });
+
+        while (!ranges.empty ())
+        {
+            Range r = ranges.back ();
+            ranges.pop_back ();
+
+            double lo[3], hi[3], sum[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                lo[j] = std::numeric_limits<double>::max ();
+                hi[j] = std::numeric_limits<double>::lowest ();
+                sum[j] = 0.0;
+            }
+
+            for (size_t i = r.begin; i < r.end; ++i)
+            {
+                const cl_float *p = fixed + fOrder[i] * d;
+                for (int j = 0; j < 3; ++j)
+                {
+                    lo[j] = std::min (lo[j], (double) p[j]);
+                    hi[j] = std::max (hi[j], (double) p[j]);
+                    sum[j] += p[j];
+                }
+            }
+
+            size_t count = r.end - r.begin;
+
+            if (count <= m)
+            {
+                Tile tile;
+                tile.begin = r.begin;
+                tile.count = count;
+                for (int j = 0; j < 3; ++j)
+                    tile.centroid[j] = (cl_float) (sum[j] / count);
+
+                nodes[r.node].axis = -1;
+                nodes[r.node].tile = tiles_.size ();
+                tiles_.push_back (tile);
+                continue;
+            }
+
+            int axis = 0;
+            for (int j = 1; j < 3; ++j)
+                if (hi[j] - lo[j] > hi[axis] - lo[axis]) axis = j;
+
+            size_t mid = r.begin + count / 2;
+            const cl_float *F = fixed;
+            unsigned int D = d;
+            std::nth_element (fOrder.begin () + r.begin, fOrder.begin () + mid, fOrder.begin () + r.end, 
+                [F, D, axis] (size_t i, size_t j) { return F[i * D + axis] < F[j * D + axis]; });
+
+            unsigned int left = nodes.size ();
+            nodes.resize (left + 2);
+
+            nodes[r.node].axis = axis;
+            nodes[r.node].split = fixed[fOrder[mid] * d + axis];
+            nodes[r.node].child[0] = left;
+            nodes[r.node].child[1] = left + 1;
+
+            ranges.push_back (Range { left, r.begin, mid });
+            ranges.push_back (Range { left + 1, mid, r.end });
+        }
+    }
+
+
+    /*! \details Every registration starts from the identity transformation.
+     *  \note The homogeneous coordinate of the moving points is taken to be `1`, 
+     *        since a `0` marks the padding of the chunks on the device.
+     *
+     *  \param[in] ptr array of \f$ n*8 \f$ `cl_float` elements, with the moving set of points.
+     *  \param[in] n number of points in the moving set.
+     */
+    void ICPTiled::setMoving (const cl_float *ptr, size_t n)
+    {
+        try
+        {
+            if (n == 0)
+                throw "The moving set cannot have zero points";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTiled]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        moving = ptr; nM = n;
+        mOrder.resize (nM);
+        mTile.resize (nM);
+
+        R = Eigen::Matrix3f::Identity ();
+        q = Eigen::Quaternionf (R);
+        t.setZero ();
+        s = 1.f;
+        k = 0;
+
+        cl_float T0[8] = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        std::copy (T0, T0 + 8, hPtrIOT);
+    }
+
+
+    /*! \details Assigns the moving points to the tiles, by their current estimate, 
+     *           and streams the tiles through the device. The `RBC` data structure 
+     *           of a tile is built when the tile gets uploaded, and it's searched by every 
+     *           chunk of moving points assigned to the tile. Since only one tile resides 
+     *           on the device, every tile is uploaded and built again in every call. The upload of the next chunk overlaps 
+     *           with the processing of the current one. The partial sums of every chunk 
+     *           are read back without blocking, and they are combined once the last chunk 
+     *           is processed. Then, the incremental transformation is solved on the host.
+     *  \note The function call is blocking.
+     */
+    void ICPTiled::step ()
+    {
+        try
+        {
+            if (nF == 0 || nM == 0)
+                throw "The fixed and moving sets have to be set before a registration";
+        }
+        catch (const char *error)
+        {
+            std::cerr << "Error[ICPTiled]: " << error << std::endl;
+            exit (EXIT_FAILURE);
+        }
+
+        // Assign the moving points to the tiles
+        std::vector<size_t> offsets (tiles_.size () + 1, 0);
+        for (size_t j = 0; j < nM; ++j)
+        {
+            Eigen::Vector3f p = s * R * Eigen::Map<const Eigen::Vector3f> (moving + j * d) + t;
+            mTile[j] = locate (p.data ());
+            offsets[mTile[j] + 1]++;
+        }
+        for (size_t i = 1; i < offsets.size (); ++i)
+            offsets[i] += offsets[i - 1];
+
+        std::vector<size_t> ends (offsets.begin (), offsets.end () - 1);
+        for (size_t j = 0; j < nM; ++j)
+            mOrder[ends[mTile[j]]++] = j;
+
+        chunks_.clear ();
+        for (unsigned int i = 0; i < tiles_.size (); ++i)
+            for (size_t b = offsets[i]; b < offsets[i + 1]; b += m)
+                chunks_.push_back (Chunk { i, b, std::min ((size_t) m, offsets[i + 1] - b) });
+
+        // Load the current estimate
+        queue.enqueueWriteBuffer (dBufferIOT, CL_FALSE, 0, bufferTSize, hPtrIOT);
+
+        double w = 0.0, sff = 0.0, smm = 0.0;
+        Eigen::Vector3d mf = Eigen::Vector3d::Zero ();
+        Eigen::Vector3d mm = Eigen::Vector3d::Zero ();
+        Eigen::Matrix3d S = Eigen::Matrix3d::Zero ();
+
+        hSums.resize (chunks_.size () * 20);
+        sumEvents.resize (chunks_.size ());
+
+        upload (chunks_[0], 0, true);
+
+        for (size_t i = 0; i < chunks_.size (); ++i)
+        {
+            unsigned int slot = i % 2;
+            process (chunks_[i], slot, i == 0 || chunks_[i].tile != chunks_[i - 1].tile);
+
+            // Each chunk reads its sums into its own place
+            queue.enqueueReadBuffer ((cl::Buffer &) matrixF.get (ICPS<ICPSConfig::FUSED>::Memory::D_OUT), 
+                                     CL_FALSE, 0, 11 * sizeof (cl_float), hSums.data () + i * 20);
+            queue.enqueueReadBuffer ((cl::Buffer &) matrixF.get (ICPS<ICPSConfig::FUSED>::Memory::D_OUT_MEAN), 
+                                     CL_FALSE, 0, 2 * sizeof (cl_float4), hSums.data () + i * 20 + 12, 
+                                     nullptr, &sumEvents[i]);
+            queue.flush ();
+
+            // Overlap the next upload with the processing of this chunk. The upload 
+            // reuses the staging slot of the previous chunk, so that has to be done
+            if (i + 1 < chunks_.size ())
+            {
+                if (i > 0) sumEvents[i - 1].wait ();
+                upload (chunks_[i + 1], 1 - slot, chunks_[i + 1].tile != chunks_[i].tile);
+            }
+        }
+
+        sumEvents.back ().wait ();  // The queue is in order, so every read is done
+
+        // Combine the partial sums of the chunks
+        for (size_t i = 0; i < chunks_.size (); ++i)
+        {
+            cl_float *Sij = hSums.data () + i * 20;
+            cl_float *mean = hSums.data () + i * 20 + 12;
+
+            double n = (double) chunks_[i].count;
+            double wn = w + n;
+            double cc = (double) c * c * w * n / wn;
+
+            Eigen::Vector3d df = Eigen::Map<Eigen::Vector3f> (mean).cast<double> () - mf;
+            Eigen::Vector3d dm = Eigen::Map<Eigen::Vector3f> (mean + 4).cast<double> () - mm;
+            Eigen::Matrix3d St = Eigen::Map<Eigen::Matrix3f, Eigen::Unaligned, 
+                                            Eigen::Stride<1, 3> > (Sij).cast<double> ();
+
+            S += St + cc * dm * df.transpose ();
+            sff += Sij[9] + cc * df.squaredNorm ();
+            smm += Sij[10] + cc * dm.squaredNorm ();
+            mf += (n / wn) * df;
+            mm += (n / wn) * dm;
+            w = wn;
+        }
+
+        // Solve for the incremental transformation
+        sk = (cl_float) std::sqrt (sff / smm);
+
+        Eigen::JacobiSVD<Eigen::Matrix3d, Eigen::NoQRPreconditioner> 
+            svd (S, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+        Eigen::Matrix3d Rd = svd.matrixV () * svd.matrixU ().transpose ();
+        if (Rd.determinant () < 0)
+        {
+            Eigen::Matrix3d B = Eigen::Matrix3d::Identity ();
+            B (2, 2) = Rd.determinant ();
+            Rd = svd.matrixV () * B * svd.matrixU ().transpose ();
+        }
+        Rk = Rd.cast<float> ();
+        qk = Eigen::Quaternionf (Rk);
+
+        tk = (mf - (double) sk * Rd * mm).cast<float> ();
+
+        R = Rk * R;
+        q = Eigen::Quaternionf (R);
+        t = sk * Rk * t + tk;
+        s = sk * s;
+
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT, 4) = q.coeffs ();  // Quaternion
+        Eigen::Map<Eigen::Vector4f> (hPtrIOT + 4, 4) = t.homogeneous ();  // Translation
+        hPtrIOT[7] = s;  // Scale
+    }
+
+
+    /*! \details Executes the iterative ICP algorithm and estimates the 
+     *           relative transformation between the two associated point clouds.
+     *  \note The function call is blocking.
+     */
+    void ICPTiled::run ()
+    {
+        step ();
+        while (check ())
+            step ();
+    }
+
+
+    /*! \return The number of tiles of the fixed set. */
+    size_t ICPTiled::tiles ()
+    {
+        return tiles_.size ();
+    }
+
+
+    /*! \return The number of chunks processed in the last iteration. */
+    size_t ICPTiled::chunks ()
+    {
+        return chunks_.size ();
+    }
+
+
+    /*! \details Descends the kd-tree. The cells of the leaves cover the whole 
+     *           space, so a point outside the bounds of the fixed set still 
+     *           gets the tile nearest to it along the splitting axes.
+     *
+     *  \param[in] p array with the xyz coordinates of the point.
+     *  \return The index of the tile.
+     */
+    unsigned int ICPTiled::locate (const cl_float *p) const
+    {
+        unsigned int i = 0;
+        while (nodes[i].axis >= 0)
+            i = nodes[i].child[(p[nodes[i].axis] < nodes[i].split) ? 0 : 1];
+
+        return nodes[i].tile;
+    }
+
+
+    /*! \details Packs the chunk (and, if requested, its tile) into a half of the 
+     *           staging buffers, and writes it to the same half of the upload buffers, 
+     *           on the transfer queue. The half was last used by the chunk before 
+     *           the previous one, which has been processed by now.
+     *
+     *  \param[in] chunk the chunk of moving points.
+     *  \param[in] slot the half of the staging and upload buffers to use.
+     *  \param[in] withTile flag. If true, the tile of the chunk is uploaded too.
+     */
+    void ICPTiled::upload (const Chunk &chunk, unsigned int slot, bool withTile)
+    {
+        if (withTile)
+        {
+            const Tile &tile = tiles_[chunk.tile];
+            cl_float *hF = hPtrInF + slot * m * d;
+
+            // The tile gets padded with its own points
+            for (size_t i = 0; i < m; ++i)
+            {
+                const cl_float *p = fixed + fOrder[tile.begin + i % tile.count] * d;
+                std::copy (p, p + d, hF + i * d);
+            }
+
+            ioQueue.enqueueWriteBuffer (dBufferUpF, CL_FALSE, slot * bufferFMSize, bufferFMSize, 
+                                        hF, nullptr, &upEvents[slot][0]);
+        }
+
+        cl_float *hM = hPtrInM + slot * m * d;
+
+        for (size_t i = 0; i < chunk.count; ++i)
+        {
+            const cl_float *p = moving + mOrder[chunk.begin + i] * d;
+            std::copy (p, p + d, hM + i * d);
+            hM[i * d + 3] = 1.f;
+        }
+
+        // The chunk gets padded with masked copies of its first point
+        for (size_t i = chunk.count; i < m; ++i)
+        {
+            std::copy (hM, hM + d, hM + i * d);
+            hM[i * d + 3] = 0.f;
+        }
+
+        ioQueue.enqueueWriteBuffer (dBufferUpM, CL_FALSE, slot * bufferFMSize, bufferFMSize, 
+                                    hM, nullptr, &upEvents[slot][1]);
+        ioQueue.flush ();
+    }
+
+
+    /*! \details Copies the chunk (and, if requested, its tile) from the upload 
+     *           buffers, once the transfers are complete, and enqueues the pipeline. 
+     *           The sums are shifted by the centroid of the tile, which keeps them 
+     *           well conditioned far from the origin.
+     *
+     *  \param[in] chunk the chunk of moving points.
+     *  \param[in] slot the half of the upload buffers holding the chunk.
+     *  \param[in] withTile flag. If true, the tile of the chunk is copied too, 
+     *                   and the `RBC` data structure is rebuilt.
+     */
+    void ICPTiled::process (const Chunk &chunk, unsigned int slot, bool withTile)
+    {
+        std::vector<cl::Event> waitList (1, upEvents[slot][1]);
+        if (withTile)
+        {
+            waitList.push_back (upEvents[slot][0]);
+            queue.enqueueCopyBuffer (dBufferUpF, dBufferInF, slot * bufferFMSize, 0, bufferFMSize, &waitList);
+        }
+        queue.enqueueCopyBuffer (dBufferUpM, dBufferInM, slot * bufferFMSize, 0, bufferFMSize, &waitList);
+
+        if (withTile)
+        {
+            fReps.run ();
+            rbcC.run ();
+        }
+
+        const Tile &tile = tiles_[chunk.tile];
+        for (int j = 0; j < 3; ++j)
+            hShift[slot][j] = hShift[slot][4 + j] = tile.centroid[j];
+        hShift[slot][3] = hShift[slot][7] = 0.f;
+        hSumW[slot] = (cl_double) chunk.count;
+
+        queue.enqueueWriteBuffer (dBufferShift, CL_FALSE, 0, 2 * sizeof (cl_float4), hShift[slot]);
+        queue.enqueueWriteBuffer (dBufferSumW, CL_FALSE, 0, sizeof (cl_double), &hSumW[slot]);
+
+        transform.run ();
+        rbcS.run (nullptr, nullptr, withTile);
+        queue.enqueueNDRangeKernel (weightsKernel, cl::NullRange, cl::NDRange (m), cl::NullRange);
+        matrixF.run ();
+        queue.flush ();
+    }
+
+
+    /*! \details Checks the last incremental transformation against the thresholds.
+     *        
+     *  \return `false` if the registration has converged, or reached the 
+     *          maximum number of iterations, `true` otherwise.
+     */
+    bool ICPTiled::check ()
+    {
+        k++;
+        double delta_angle = 180.0 / M_PI * 2.0 * std::atan2 (qk.vec ().norm (), qk.w ());  // in degrees
+        double delta_tanslation = tk.norm ();  // in mm
+
+        if (k == max_iterations) return false;
+        if (delta_angle < angle_threshold && delta_tanslation < translation_threshold) return false;
+
+        return true;
+    }
+
+}
+}
@@ -0,0 +1,234 @@
+/*! \file trace.cpp
+ *  \brief Defines the per-stage timing instrumentation of the %ICP pipeline.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <ICP/trace.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \param[in] _capacity number of iterations the ring buffer keeps. */
+    ICPTrace::ICPTrace (unsigned int _capacity) : 
+        ring (std::max (_capacity, 1U)), head (0), count (0), 
+        registrations (0), iterations (0), convergence (ICPConvergence::NONE)
+    {
+    }
+
+
+    /*! \details Call it before enqueueing the commands of an iteration. */
+    void ICPTrace::begin ()
+    {
+        pending.emplace_back ();
+        pendingStart.emplace_back ();
+        pendingSolver.push_back (0);
+    }
+
+
+    /*! \details The event is associated with the current iteration, 
+     *           the one opened by the last call to `begin`.
+     *
+     *  \param[in] stage the stage of the command.
+     *  \return A pointer to the event of the stage.
+     */
+    cl::Event* ICPTrace::event (ICPStage stage)
+    {
+        if (pending.empty ()) begin ();
+        return &pending.back ()[(unsigned int) stage];
+    }
+
+
+    /*! \details The event is associated with the current iteration. When it's set, the 
+     *           `QUEUED`, `SUBMIT` and `START` timestamps of the stage are taken from 
+     *           it, and only the `END` timestamp from the event of the stage.
+     *
+     *  \param[in] stage the stage of the commands.
+     *  \return A pointer to the start event of the stage.
+     */
+    cl::Event* ICPTrace::startEvent (ICPStage stage)
+    {
+        if (pending.empty ()) begin ();
+        return &pendingStart.back ()[(unsigned int) stage];
+    }
+
+
+    /*! \details The slot is associated with the current iteration, the one opened 
+     *           by the last call to `begin`. It's meant to be the destination of a 
+     *           non-blocking read, so it stays valid until the next call to `end`.
+     *
+     *  \return A pointer to the slot. It holds `0` until it's written.
+     */
+    cl_uint* ICPTrace::solverIterations ()
+    {
+        if (pending.empty ()) begin ();
+        return &pendingSolver.back ();
+    }
+
+
+    /*! \details Reads the profiling information of the events of the pending 
+     *           iterations into the ring buffer, and records the outcome of the 
+     *           registration. It should be called after the commands of the 
+     *           registration have completed (e.g., after `queue.finish ()`).
+     *
+     *  \param[in] reason the reason the registration ended.
+     *  \param[in] _iterations the number of iterations the registration performed.
+     */
+    void ICPTrace::end (ICPConvergence reason, unsigned int _iterations)
+    {
+        for (unsigned int i = 0; i < pending.size (); ++i)
+        {
+            ICPTraceRecord &record = ring[head];
+            record.registration = registrations;
+            record.iteration = i;
+            record.solverIterations = pendingSolver[i];
+
+            for (unsigned int st = 0; st < nICPStages; ++st)
+            {
+                cl::Event &event = pending[i][st];
+                record.recorded[st] = (event () != nullptr);
+                if (!record.recorded[st]) continue;
+
+                cl::Event &start = (pendingStart[i][st] () != nullptr) ? pendingStart[i][st] : event;
+                record.stamps[st][0] = start.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED> ();
+                record.stamps[st][1] = start.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT> ();
+                record.stamps[st][2] = start.getProfilingInfo<CL_PROFILING_COMMAND_START> ();
+                record.stamps[st][3] = event.getProfilingInfo<CL_PROFILING_COMMAND_END> ();
+            }
+
+            head = (head + 1) % ring.size ();
+            count = std::min (count + 1, (unsigned int) ring.size ());
+        }
+        pending.clear ();
+        pendingStart.clear ();
+        pendingSolver.clear ();
+
+        registrations++;
+        iterations = _iterations;
+        convergence = reason;
+    }
+
+
+    /*! \details The capacity of the ring buffer is maintained. */
+    void ICPTrace::clear ()
+    {
+        pending.clear ();
+        pendingStart.clear ();
+        pendingSolver.clear ();
+        head = count = 0;
+        registrations = iterations = 0;
+        convergence = ICPConvergence::NONE;
+    }
+
+
+    /*! \return The number of records in the ring buffer. */
+    unsigned int ICPTrace::size () const
+    {
+        return count;
+    }
+
+
+    /*! \return The capacity of the ring buffer. */
+    unsigned int ICPTrace::capacity () const
+    {
+        return ring.size ();
+    }
+
+
+    /*! \param[in] idx index of the record. Index `0` is the oldest record in the ring buffer.
+     *  \return A reference to the record.
+     */
+    const ICPTraceRecord& ICPTrace::operator[] (unsigned int idx) const
+    {
+        return ring[(head + ring.size () - count + idx) % ring.size ()];
+    }
+
+
+    /*! \details Considers the records in the ring buffer that contain the stage. The 
+     *           percentiles are computed with the nearest-rank method.
+     *
+     *  \param[in] stage the stage of interest.
+     *  \param[in] from the timestamp at which the duration starts.
+     *  \param[in] to the timestamp at which the duration ends.
+     *  \return The statistics of the duration. All fields are zero if there are no samples.
+     */
+    ICPStageStats ICPTrace::stats (ICPStage stage, ICPStamp from, ICPStamp to) const
+    {
+        unsigned int st = (unsigned int) stage;
+        unsigned int f = (unsigned int) from, t = (unsigned int) to;
+
+        std::vector<double> durations;
+        durations.reserve (count);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const ICPTraceRecord &record = (*this)[i];
+            if (record.recorded[st])
+                durations.push_back ((record.stamps[st][t] - record.stamps[st][f]) * 1e-6);
+        }
+
+        ICPStageStats s = { 0, 0.0, 0.0, 0.0, 0.0 };
+        if (durations.empty ()) return s;
+
+        std::sort (durations.begin (), durations.end ());
+        unsigned int n = durations.size ();
+
+        s.samples = n;
+        for (double d : durations) s.mean += d;
+        s.mean /= n;
+        s.p50 = durations[(unsigned int) std::ceil (0.50 * n) - 1];
+        s.p99 = durations[(unsigned int) std::ceil (0.99 * n) - 1];
+        s.max = durations[n - 1];
+
+        return s;
+    }
+
+
+    /*! \return The number of registrations that have ended since the last `clear`. */
+    unsigned int ICPTrace::getRegistrations () const
+    {
+        return registrations;
+    }
+
+
+    /*! \return The number of iterations of the last registration. */
+    unsigned int ICPTrace::getIterations () const
+    {
+        return iterations;
+    }
+
+
+    /*! \return The reason the last registration ended. */
+    ICPConvergence ICPTrace::getConvergence () const
+    {
+        return convergence;
+    }
+
+}
+}
@@ -0,0 +1,280 @@
+/*! \file tuner.cpp
+ *  \brief Defines an auto-tuner for the launch configurations of the %ICP and reduction kernels.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+#include <ICP/algorithms.hpp>
+#include <ICP/program_cache.hpp>
+#include <ICP/tuner.hpp>
+
+
+namespace cl_algo
+{
+namespace ICP
+{
+
+    /*! \brief Returns the candidate local workspace sizes of a kernel.
+     *  \details They are the preferred work-group size multiple of the kernel, times 
+     *           powers of 2, up to its maximum work-group size. There are none, if the 
+     *           kernel was compiled for a fixed size.
+     */
+    static std::vector<WorkGroupConfig> localSizes (clutils::CLEnv &env, const clutils::CLEnvInfo<1> &info, 
+                                                    const std::string &name)
+    {
+        cl::Device &device = env.devices[info.pIdx][info.dIdx];
+        cl::Kernel kernel (env.getProgram (info.pgIdx), name.c_str ());
+
+        std::vector<WorkGroupConfig> configs;
+        cl::size_t<3> compiled = kernel.getWorkGroupInfo<CL_KERNEL_COMPILE_WORK_GROUP_SIZE> (device);
+        if (compiled[0] != 0) return configs;
+
+        size_t maxSize = kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE> (device);
+        size_t size = kernel.getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE> (device);
+        for (; size != 0 && size <= maxSize; size *= 2)
+            configs.push_back ({ size, 0 });
+
+        return configs;
+    }
+
+
+    /*! \brief Times an initialized class instance.
+     *  \return The best of `nRepeat` execution times, after a warm-up execution.
+     */
+    template <typename T>
+    static double bestTime (T &op, clutils::GPUTimer<std::milli> &timer, unsigned int nRepeat)
+    {
+        op.run (timer);
+
+        double best = std::numeric_limits<double>::max ();
+        for (unsigned int i = 0; i < nRepeat; ++i)
+            best = std::min (best, op.run (timer));
+
+        return best;
+    }
+
+
+    /*! \brief Times a kernel under each candidate configuration, and keeps the fastest.
+     *  \details `bench` constructs, initializes and times a class instance, which picks up 
+     *           the configuration under test from the table. It returns a negative time 
+     *           for a configuration that the class doesn't support.
+     */
+    template <typename Bench>
+    static void tuneKernel (const std::string &name, const cl::Device &device, 
+                            const std::vector<WorkGroupConfig> &candidates, Bench bench)
+    {
+        WorkGroupConfig best { 0, 0 };
+        double bestT = std::numeric_limits<double>::max ();
+        bool found = false;
+
+        for (const WorkGroupConfig &config : candidates)
+        {
+            setTunedConfig (name, device, config);
+            try
+            {
+                double t = bench (config);
+                if (t >= 0.0 && t < bestT) { bestT = t; best = config; found = true; }
+            }
+            catch (const cl::Error &)
+            {
+                // The device turned the configuration down
+            }
+        }
+
+        if (found) setTunedConfig (name, device, best);
+        else clearTunedConfig (name, device);
+    }
+
+
+    /*! \param[in] env the OpenCL environment.
+     *  \param[in] info the environment info that the classes will be given.
+     *  \param[in] m number of points to tune for.
+     *  \param[in] force flag to indicate whether or not to tune even if there are 
+     *                   stored configurations for the device already.
+     *  \param[in] nRepeat number of timed executions per configuration. The best one counts.
+     *  \return True if the kernels were tuned, false if stored configurations were found.
+     */
+    bool tuneWorkGroups (clutils::CLEnv &env, clutils::CLEnvInfo<1> info, unsigned int m, 
+                         bool force, unsigned int nRepeat)
+    {
+        cl::Device &device = env.devices[info.pIdx][info.dIdx];
+        if (!force && hasTunedConfigs (device)) return false;
+
+        // A specialized program only accepts the constants it was built for
+        unsigned int sm; float c;
+        getSpecialization (env.getProgram (info.pgIdx), device, sm, c);
+        if (sm != 0) m = sm;
+        if (c == 0.f) c = 1e-6f;
+
+        // The arrays are handled as float4/int4
+        unsigned int mR = m;
+        if (mR % 4) mR += 4 - mR % 4;
+
+        unsigned int nS = (m + 3) / 4;
+        if (nS % 4) nS += 4 - nS % 4;
+
+        // The timings don't depend on the data, so every input is the same zeroed buffer.
+        // It's large enough for m float8 points, which covers the 11 rows of products too
+        std::vector<cl_float> zeros (8 * mR, 0.f);
+        cl::Buffer dBufferZeros (env.getContext (info.pIdx), CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, 
+                                 zeros.size () * sizeof (cl_float), zeros.data ());
+
+        clutils::GPUTimer<std::milli> timer (device);
+
+        typedef Reduce<ReduceConfig::SUM, cl_float> ReduceSum;
+        typedef Reduce<ReduceConfig::MIN, cl_float> ReduceMin;
+        typedef Reduce<ReduceConfig::MAX, cl_uint> ReduceMax;
+        typedef Scan<ScanConfig::INCLUSIVE, cl_int> ScanIncl;
+        typedef Scan<ScanConfig::EXCLUSIVE, cl_int> ScanExcl;
+
+        // Reductions (the sum, with the shape of the S matrix products)
+        tuneKernel ("reduce_sum_f", device, localSizes (env, info, "reduce_sum_f"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                if (nS > 64 * config.local * config.local) return -1.0;
+                ReduceSum reduce (env, info);
+                reduce.get (ReduceSum::Memory::D_IN) = dBufferZeros;
+                reduce.init (nS, 11, Staging::NONE);
+                return bestTime (reduce, timer, nRepeat);
+            });
+
+        tuneKernel ("reduce_min_f", device, localSizes (env, info, "reduce_min_f"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                if (mR > 64 * config.local * config.local) return -1.0;
+                ReduceMin reduce (env, info);
+                reduce.get (ReduceMin::Memory::D_IN) = dBufferZeros;
+                reduce.init (mR, 1, Staging::NONE);
+                return bestTime (reduce, timer, nRepeat);
+            });
+
+        tuneKernel ("reduce_max_ui", device, localSizes (env, info, "reduce_max_ui"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                if (mR > 64 * config.local * config.local) return -1.0;
+                ReduceMax reduce (env, info);
+                reduce.get (ReduceMax::Memory::D_IN) = dBufferZeros;
+                reduce.init (mR, 1, Staging::NONE);
+                return bestTime (reduce, timer, nRepeat);
+            });
+
+        // Scans
+        tuneKernel ("inclusiveScan_i", device, localSizes (env, info, "inclusiveScan_i"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                if (mR > 64 * config.local * config.local) return -1.0;
+                ScanIncl scan (env, info);
+                scan.get (ScanIncl::Memory::D_IN) = dBufferZeros;
+                scan.init (mR, 1, Staging::NONE);
+                return bestTime (scan, timer, nRepeat);
+            });
+
+        tuneKernel ("exclusiveScan_i", device, localSizes (env, info, "exclusiveScan_i"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                if (mR > 64 * config.local * config.local) return -1.0;
+                ScanExcl scan (env, info);
+                scan.get (ScanExcl::Memory::D_IN) = dBufferZeros;
+                scan.init (mR, 1, Staging::NONE);
+                return bestTime (scan, timer, nRepeat);
+            });
+
+        // Weights
+        tuneKernel ("icpComputeReduceWeights", device, localSizes (env, info, "icpComputeReduceWeights"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                if (m % 2 != 0 || m > 16 * config.local * config.local) return -1.0;
+                ICPWeights weights (env, info);
+                weights.get (ICPWeights::Memory::D_IN) = dBufferZeros;
+                weights.init (m, Staging::NONE);
+                return bestTime (weights, timer, nRepeat);
+            });
+
+        // Means
+        tuneKernel ("icpMean", device, localSizes (env, info, "icpMean"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                typedef ICPMean<ICPMeanConfig::REGULAR> Mean;
+                if (m > 4 * config.local * config.local) return -1.0;
+                Mean mean (env, info);
+                mean.get (Mean::Memory::D_IN_F) = dBufferZeros;
+                mean.get (Mean::Memory::D_IN_M) = dBufferZeros;
+                mean.init (m, Staging::NONE);
+                return bestTime (mean, timer, nRepeat);
+            });
+
+        tuneKernel ("icpMean_Weighted", device, localSizes (env, info, "icpMean_Weighted"), 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                typedef ICPMean<ICPMeanConfig::WEIGHTED> Mean;
+                if (m > 4 * config.local * config.local) return -1.0;
+                Mean mean (env, info);
+                mean.get (Mean::Memory::D_IN_F) = dBufferZeros;
+                mean.get (Mean::Memory::D_IN_M) = dBufferZeros;
+                mean.get (Mean::Memory::D_IN_W) = dBufferZeros;
+                mean.get (Mean::Memory::D_IN_SUM_W) = dBufferZeros;
+                mean.init (m, Staging::NONE);
+                return bestTime (mean, timer, nRepeat);
+            });
+
+        // S matrix products, over local sizes (0 leaves it to the driver) and elements per work-item
+        std::vector<WorkGroupConfig> configs;
+        std::vector<WorkGroupConfig> sizes = localSizes (env, info, "icpSijProducts_Weighted");
+        sizes.insert (sizes.begin (), { 0, 0 });
+        for (const WorkGroupConfig &size : sizes)
+            for (unsigned int ept = 1; ept <= 32; ept *= 2)
+                configs.push_back ({ size.local, ept });
+
+        // The reduction of the products was tuned above
+        size_t wgReduce = getWorkGroupMultiple (
+            cl::Kernel (env.getProgram (info.pgIdx), "reduce_sum_f"), device);
+
+        tuneKernel ("icpSijProducts_Weighted", device, configs, 
+            [&] (const WorkGroupConfig &config) -> double
+            {
+                typedef ICPS<ICPSConfig::WEIGHTED> S;
+                size_t q = std::max (config.local, (size_t) 4);
+                size_t n = (m + config.ept - 1) / config.ept;
+                if (n % q) n += q - n % q;
+                if (n > 64 * wgReduce * wgReduce) return -1.0;
+                S s (env, info);
+                s.get (S::Memory::D_IN_DEV_M) = dBufferZeros;
+                s.get (S::Memory::D_IN_DEV_F) = dBufferZeros;
+                s.get (S::Memory::D_IN_W) = dBufferZeros;
+                s.init (m, c, Staging::NONE);
+                return bestTime (s, timer, nRepeat);
+            });
+
+        storeTunedConfigs (device);
+
+        return true;
+    }
+
+}
+}
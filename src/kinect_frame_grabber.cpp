@@ -1,11 +1,24 @@
 /*! \file kinect_frame_grabber.cpp
- *  \brief Grabs and stores, in a binary file, an 8-D point cloud from a Kinect RGB and Depth frame.
+ *  \brief Grabs and stores, in a binary file, 8-D point clouds from Kinect RGB and Depth frames.
+ *  \details The point clouds are stored in the format of `cl_algo::ICP::PCFile`.
+ *           Alternatively, the raw Depth and RGB frames can be recorded, and 
+ *           be back-projected on the GPU at load time (`ICPBackProject`).
+ *  \details The freenect callbacks deliver the frames into a ring of pinned, 
+ *           mapped OpenCL staging slots (`FrameRing`), from which they are 
+ *           uploaded as they are. The point clouds are built on the GPU.
  *  \note **Command line arguments**:
  *  \note `-s <name>`: suffix for the name of the binary file.
  *  \note `-f       `: enable Guided Image Filtering.
+ *  \note `-n <num> `: number of consecutive frames to record (default 1).
+ *  \note `-r       `: record the raw Depth and RGB frames (`RGBD` layout).
+ *  \note `-c       `: run-length encode the raw Depth frames (along with `-r`).
  *  \note **Example usage**:
  *  \note `./bin/kinect_frame_grabber -s test_1 -f`
  *  \note to filter the frames, and store the point cloud in `../data/kg_pc8d_test_1.bin`
+ *  \note `./bin/kinect_frame_grabber -s seq -n 300`
+ *  \note to record a sequence of 300 frames in `../data/kg_pc8d_seq.bin`
+ *  \note `./bin/kinect_frame_grabber -s seq -n 300 -r -c`
+ *  \note to record the same sequence as compressed raw frames, at a fraction of the size
  *  \author Nick Lamprianidis
  *  \version 2.0
  *  \date 2015
@@ -39,10 +52,13 @@
 #include <algorithm>
 #include <mutex>
 #include <ctime>
+#include <chrono>
 
 #include <GL/glew.h>
 #include <CLUtils.hpp>
 #include <GuidedFilter/algorithms.hpp>
+#include <ICP/algorithms.hpp>
+#include <ICP/pc_file.hpp>
 
 #if defined(__APPLE__) || defined(__MACOSX)
 #include <GLUT/glut.h>
@@ -74,14 +90,301 @@ Freenect::Freenect freenect;
 MyFreenectDevice *device;
 double freenectAngle = 0.0;
 
+// Capture
+class FrameRing;
+class CloudBuilder;
+FrameRing *ring = nullptr;
+CloudBuilder *builder = nullptr;
+
 // Configuration
 bool filtered;
+bool raw, compressed;
 std::string suffix;
+unsigned int n_frames;
+cl_algo::ICP::PCFileWriter *writer = nullptr;
+
+
+/*! \brief A ring of Kinect frame slots in pinned, mapped OpenCL staging memory.
+ *  \details The freenect callbacks copy the frames straight into the slots, 
+ *           and the frames are uploaded to the device from there. The slots 
+ *           are allocated once. At any time, one slot is being filled by the 
+ *           callbacks, one holds the latest complete pair of frames, and one 
+ *           is in use by the display and the processing pipeline.
+ *  \note The callbacks run on the freenect thread, and they are the only ones 
+ *        that touch the slot being filled. `acquire` runs on the GLUT thread.
+ */
+class FrameRing
+{
+public:
+    /*! \brief Number of frame slots. */
+    static const unsigned int slots = 3;
+
+    /*! \param[in] context context in which to allocate the slots.
+     *  \param[in] _queue command queue used to map the slots.
+     *  \param[in] _n number of pixels per frame.
+     */
+    FrameRing (cl::Context &context, cl::CommandQueue &_queue, unsigned int _n) : 
+        queue (_queue), n (_n), write (0), ready (1), read (2), fresh (false)
+    {
+        for (Slot &s : slot)
+        {
+            s.hBufferD = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, n * sizeof (cl_ushort));
+            s.hBufferRGB = cl::Buffer (context, CL_MEM_ALLOC_HOST_PTR, 3 * n * sizeof (cl_uchar));
+
+            // The slots stay mapped for the lifetime of the ring
+            s.depth = (uint16_t *) queue.enqueueMapBuffer (
+                s.hBufferD, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, n * sizeof (cl_ushort));
+            s.rgb = (uint8_t *) queue.enqueueMapBuffer (
+                s.hBufferRGB, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, 3 * n * sizeof (cl_uchar));
+
+            std::fill (s.depth, s.depth + n, 0);
+            std::fill (s.rgb, s.rgb + 3 * n, 0);
+            s.hasDepth = s.hasRGB = false;
+        }
+    }
+
+
+    ~FrameRing ()
+    {
+        for (Slot &s : slot)
+        {
+            queue.enqueueUnmapMemObject (s.hBufferD, s.depth);
+            queue.enqueueUnmapMemObject (s.hBufferRGB, s.rgb);
+        }
+        queue.finish ();
+    }
+
+
+    /*! \brief Stores a Depth frame in the slot being filled. */
+    void putDepth (const void *depth)
+    {
+        std::copy ((const uint16_t *) depth, (const uint16_t *) depth + n, slot[write].depth);
+        slot[write].hasDepth = true;
+
+        if (slot[write].hasRGB) publish ();
+    }
+
+
+    /*! \brief Stores an RGB frame in the slot being filled. */
+    void putRGB (const void *rgb)
+    {
+        std::copy ((const uint8_t *) rgb, (const uint8_t *) rgb + 3 * n, slot[write].rgb);
+        slot[write].hasRGB = true;
+
+        if (slot[write].hasDepth) publish ();
+    }
+
+
+    /*! \brief Takes over the latest complete pair of frames.
+     *  \details The previously acquired slot is handed back to the callbacks, 
+     *           so any transfers from it must have completed.
+     *
+     *  \return A flag to indicate whether new frames were present.
+     */
+    bool acquire ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        if (!fresh)
+            return false;
+
+        std::swap (read, ready);
+        fresh = false;
+
+        return true;
+    }
+
+
+    /*! \brief Returns the acquired Depth frame. */
+    const uint16_t* depth () const
+    {
+        return slot[read].depth;
+    }
+
+
+    /*! \brief Returns the acquired RGB frame. */
+    const uint8_t* rgb () const
+    {
+        return slot[read].rgb;
+    }
+
+private:
+    /*! \brief Makes the slot being filled the latest complete one. */
+    void publish ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        std::swap (write, ready);
+        fresh = true;
+
+        slot[write].hasDepth = false;
+        slot[write].hasRGB = false;
+    }
+
+    /*! \brief A pair of Depth and RGB frames. */
+    struct Slot
+    {
+        cl::Buffer hBufferD, hBufferRGB;
+        uint16_t *depth;
+        uint8_t *rgb;
+        bool hasDepth, hasRGB;
+    };
+
+    cl::CommandQueue &queue;
+    unsigned int n;
+    Slot slot[slots];
+    unsigned int write, ready, read;
+    bool fresh;
+    std::mutex mutex;
+
+};
+
+
+/*! \brief Builds 8-D point clouds from Kinect frames on the GPU.
+ *  \details The OpenCL environment and the kernel classes are set up once. 
+ *           The frames are uploaded straight from the pinned slots of a 
+ *           `FrameRing`, and either go through Guided Image Filtering, or 
+ *           get back-projected by `ICPBackProject`.
+ */
+class CloudBuilder
+{
+public:
+    /*! \param[in] _filtered flag to indicate whether or not to filter the frames. */
+    CloudBuilder (bool _filtered) : 
+        env ({ "kernels/GF/imageSupport_kernels.cl", 
+               "kernels/GF/scan_kernels.cl", 
+               "kernels/GF/transpose_kernels.cl", 
+               "kernels/GF/boxFilter_kernels.cl",
+               "kernels/GF/math_kernels.cl", 
+               "kernels/GF/guidedFilter_kernels.cl" }), 
+        filtered (_filtered), 
+        infoGF (0, 0, 0, { 0, 1 }, 0), infoICP (0, 0, 0, { 0 }, 1), 
+        context (env.getContext (0)), queue (initQueues ()), 
+        kGFRGB (env, infoGF), kGFDepth (env, infoGF), kPC8D (env, infoGF.getCLEnvInfo (0)), 
+        kBP (env, infoICP)
+    {
+        using namespace cl_algo::GF;
+        using namespace cl_algo::GF::Kinect;
+
+        const int radius = 5;
+        const float eps = 0.005f;
+        const float scaling = 1e-3f;
+
+        // Guided Image Filtering
+        kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_R) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
+        kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_G) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
+        kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_B) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
+        kGFRGB.init (640, 480, radius, eps, cl_algo::GF::Staging::NONE);
+
+        kGFDepth.get (GuidedFilterDepth::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
+        kGFDepth.init (640, 480, radius, eps, scaling, cl_algo::GF::Staging::NONE);
+
+        kPC8D.get (RGBDTo8D::Memory::D_IN_D) = 
+            kGFDepth.get (GuidedFilterDepth::Memory::D_OUT);
+        kPC8D.get (RGBDTo8D::Memory::D_IN_R) = 
+            kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_R);
+        kPC8D.get (RGBDTo8D::Memory::D_IN_G) = 
+            kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_G);
+        kPC8D.get (RGBDTo8D::Memory::D_IN_B) = 
+            kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_B);
+        kPC8D.init (640, 480, 595.f, 1.f, 0, cl_algo::GF::Staging::NONE);
+
+        // Back-projection
+        kBP.init (640, 480, 595.f, 595.f, cl_algo::ICP::Staging::NONE);
+    }
+
+
+    /*! \brief Returns the context of the pipeline. */
+    cl::Context& getContext ()
+    {
+        return context;
+    }
+
+
+    /*! \brief Returns the main command queue of the pipeline. */
+    cl::CommandQueue& getQueue ()
+    {
+        return queue;
+    }
+
+
+    /*! \brief Builds a point cloud.
+     *  \details The call blocks until the point cloud is available, 
+     *           so `depth` and `rgb` can be reused afterwards.
+     *
+     *  \param[in] depth Depth frame, in pinned memory.
+     *  \param[in] rgb RGB frame, in pinned memory.
+     *  \param[out] pc8d array that receives the point cloud, `640*480` `cl_float8` points.
+     */
+    void build (const uint16_t *depth, const uint8_t *rgb, cl_float *pc8d)
+    {
+        using namespace cl_algo::GF;
+        using namespace cl_algo::GF::Kinect;
+
+        cl::Buffer *dBufferOut;
+
+        if (filtered)
+        {
+            queue.enqueueWriteBuffer ((cl::Buffer &) kGFRGB.get (
+                GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_IN), 
+                CL_FALSE, 0, 3 * n * sizeof (cl_uchar), rgb);
+            queue.enqueueWriteBuffer ((cl::Buffer &) kGFDepth.get (GuidedFilterDepth::Memory::D_IN), 
+                CL_FALSE, 0, n * sizeof (cl_ushort), depth);
+
+            kGFRGB.run ();
+            kGFDepth.run ();
+            kPC8D.run ();
+
+            dBufferOut = (cl::Buffer *) &kPC8D.get (RGBDTo8D::Memory::D_OUT);
+        }
+        else
+        {
+            queue.enqueueWriteBuffer ((cl::Buffer &) kBP.get (cl_algo::ICP::ICPBackProject::Memory::D_IN_D), 
+                CL_FALSE, 0, n * sizeof (cl_ushort), depth);
+            queue.enqueueWriteBuffer ((cl::Buffer &) kBP.get (cl_algo::ICP::ICPBackProject::Memory::D_IN_RGB), 
+                CL_FALSE, 0, 3 * n * sizeof (cl_uchar), rgb);
+
+            kBP.run ();
+
+            dBufferOut = (cl::Buffer *) &kBP.get (cl_algo::ICP::ICPBackProject::Memory::D_OUT);
+        }
+
+        queue.enqueueReadBuffer (*dBufferOut, CL_TRUE, 0, n * sizeof (cl_float8), pc8d);
+    }
+
+private:
+    /*! \brief Adds the second queue and the ICP program to the environment. */
+    cl::CommandQueue& initQueues ()
+    {
+        env.addQueue (0, 0);
+        env.addProgram (0, "kernels/ICP/icp_kernels.cl");
+
+        return env.getQueue (0, 0);
+    }
+
+    static const unsigned int n = 640 * 480;
+
+    clutils::CLEnv env;
+    bool filtered;
+    clutils::CLEnvInfo<2> infoGF;
+    clutils::CLEnvInfo<1> infoICP;
+    cl::Context &context;
+    cl::CommandQueue &queue;
+    cl_algo::GF::GuidedFilterRGB<cl_algo::GF::GuidedFilterRGBConfig::SEPARATED> kGFRGB;
+    cl_algo::GF::GuidedFilterDepth kGFDepth;
+    cl_algo::GF::Kinect::RGBDTo8D kPC8D;
+    cl_algo::ICP::ICPBackProject kBP;
+
+};
 
 
 /*! \brief A class that extends Freenect::FreenectDevice by defining 
- *         the VideoCallback function so we can be getting updates 
- *         with the latest RGB frame.
+ *         the VideoCallback and DepthCallback functions, which deliver 
+ *         the frames to a `FrameRing`.
  */
 class MyFreenectDevice : public Freenect::FreenectDevice
 {
@@ -92,12 +395,7 @@ public:
      *  \param[in] idx index of the device on the bus.
      */
     MyFreenectDevice (freenect_context *ctx, int idx) : 
-        Freenect::FreenectDevice (ctx, idx), 
-        rgbBuffer (freenect_find_video_mode (
-            FREENECT_RESOLUTION_MEDIUM, FREENECT_VIDEO_RGB).bytes), 
-        depthBuffer (freenect_find_depth_mode (
-            FREENECT_RESOLUTION_MEDIUM, FREENECT_DEPTH_REGISTERED).bytes / 2), 
-        newRGBFrame (false), newDepthFrame (false)
+        Freenect::FreenectDevice (ctx, idx)
     {
         // setVideoFormat (FREENECT_VIDEO_YUV_RGB, FREENECT_RESOLUTION_MEDIUM);
         setDepthFormat (FREENECT_DEPTH_REGISTERED);
@@ -112,10 +410,7 @@ public:
      */
     void VideoCallback (void *rgb, uint32_t timestamp)
     {
-        std::lock_guard<std::mutex> lock (rgbMutex);
-        
-        std::copy ((uint8_t *) rgb, (uint8_t *) rgb + getVideoBufferSize (), rgbBuffer.data ());
-        newRGBFrame = true;
+        ring->putRGB (rgb);
     }
 
 
@@ -127,167 +422,101 @@ public:
      */
     void DepthCallback (void *depth, uint32_t timestamp)
     {
-        std::lock_guard<std::mutex> lock (depthMutex);
-        
-        std::copy ((uint16_t *) depth, (uint16_t *) depth + getDepthBufferSize () / 2, depthBuffer.data ());
-        newDepthFrame = true;
+        ring->putDepth (depth);
     }
 
 
-    /*! \brief Retrieves the most recently received RGB and Depth frames.
+    /*! \brief Acquires the most recently received RGB and Depth frames.
+     *  \details The frames are then available through `ring`.
      *
      *  \return A flag to indicate whether new frames were present.
      */
-    bool updateFrames (std::vector<uint8_t> &rgb, std::vector<uint16_t> &depth)
+    bool updateFrames ()
     {
-        std::lock_guard<std::mutex> lockRGB (rgbMutex);
-        std::lock_guard<std::mutex> lockDepth (depthMutex);
-        
-        if (!newRGBFrame || !newDepthFrame)
-            return false;
-
-        rgb.swap (rgbBuffer);
-        depth.swap (depthBuffer);
-
-        newRGBFrame = false;
-        newDepthFrame = false;
-
-        return true;
+        return ring->acquire ();
     }
 
-private:
-    std::mutex rgbMutex, depthMutex;
-    std::vector<uint8_t> rgbBuffer;
-    std::vector<uint16_t> depthBuffer;
-    bool newRGBFrame, newDepthFrame;
-
 };
 
 
-/*! \brief Stores the given Kinect frames in binary files. */
-void saveBinary (std::vector<uint8_t> &rgb, std::vector<uint16_t> &depth)
+/*! \brief Appends the given Kinect frames to the binary file. */
+void saveBinary (const uint8_t *rgb, const uint16_t *depth)
 {
-    // Filtering ===============================================================
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds> (
+        std::chrono::system_clock::now ().time_since_epoch ()).count ();
 
-    using namespace clutils;
-    using namespace cl_algo::GF;
-    using namespace cl_algo::GF::Kinect;
+    // Processing ==============================================================
 
     const unsigned int n = 640 * 480;
-    std::vector<cl_float> fPC8D (8 * n);
+    static std::vector<cl_float> fPC8D (raw ? 0 : 8 * n);
 
-    if (filtered)
+    // Raw frames are stored as they are
+    if (!raw)
     {
         try
         {
-            const std::vector<std::string> kernel_files = { "kernels/GF/imageSupport_kernels.cl", 
-                                                            "kernels/GF/scan_kernels.cl", 
-                                                            "kernels/GF/transpose_kernels.cl", 
-                                                            "kernels/GF/boxFilter_kernels.cl",
-                                                            "kernels/GF/math_kernels.cl", 
-                                                            "kernels/GF/guidedFilter_kernels.cl" };
-
-            const int radius = 5;
-            const float eps = 0.005f;
-            const float scaling = 1e-3f;
-
-            CLEnv env (kernel_files);
-            env.addQueue (0, 0);
-            cl::Context &context = env.getContext (0);
-            cl::CommandQueue &queue0 = env.getQueue(0, 0);
-
-            CLEnvInfo<2> info (0, 0, 0, { 0, 1 }, 0);
-            GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED> kGFRGB (env, info);
-            GuidedFilterDepth kGFDepth (env, info);
-            RGBDTo8D kPC8D (env, info.getCLEnvInfo (0));
-
-            kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_R) = 
-                cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
-            kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_G) = 
-                cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
-            kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_B) = 
-                cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
-            kGFRGB.init (640, 480, radius, eps, Staging::I);
-
-            kGFDepth.get (GuidedFilterDepth::Memory::D_OUT) = 
-                cl::Buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
-            kGFDepth.init (640, 480, radius, eps, scaling, Staging::I);
-
-            kPC8D.get (RGBDTo8D::Memory::D_IN_D) = 
-                kGFDepth.get (GuidedFilterDepth::Memory::D_OUT);
-            kPC8D.get (RGBDTo8D::Memory::D_IN_R) = 
-                kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_R);
-            kPC8D.get (RGBDTo8D::Memory::D_IN_G) = 
-                kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_G);
-            kPC8D.get (RGBDTo8D::Memory::D_IN_B) = 
-                kGFRGB.get (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_OUT_B);
-            kPC8D.init (640, 480, 595.f, 1.f, 0, Staging::NONE);
-
-            kGFRGB.write (GuidedFilterRGB<GuidedFilterRGBConfig::SEPARATED>::Memory::D_IN, rgb.data ());
-            kGFDepth.write (GuidedFilterDepth::Memory::D_IN, depth.data ());
-
-            kGFRGB.run ();
-            kGFDepth.run ();
-            kPC8D.run ();
-
-            queue0.enqueueReadBuffer ((cl::Buffer &) kPC8D.get (RGBDTo8D::Memory::D_OUT), 
-                CL_TRUE, 0, n * sizeof (cl_float8), fPC8D.data ());
+            builder->build (depth, rgb, fPC8D.data ());
         }
         catch (const cl::Error &error)
         {
             std::cerr << error.what ()
-                      << " (" << getOpenCLErrorCodeString (error.err ()) 
+                      << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
                       << ")"  << std::endl;
             exit (EXIT_FAILURE);
         }
     }
-    else
-    {
-        for (int y = 0; y < 480; ++y)
-        {
-            for (int x = 0; x < 640; ++x)
-            {
-                int p = y * 640 + x;
-
-                float d = depth[p];
-                fPC8D[8 * p + 0] = (x - (640 - 1) / 2.f) * d / 595.f;
-                fPC8D[8 * p + 1] = (y - (480 - 1) / 2.f) * d / 595.f;
-                fPC8D[8 * p + 2] = d;
-                fPC8D[8 * p + 3] = 1.f;
-
-                fPC8D[8 * p + 4] = rgb[3 * p]     / 255.f;
-                fPC8D[8 * p + 5] = rgb[3 * p + 1] / 255.f;
-                fPC8D[8 * p + 6] = rgb[3 * p + 2] / 255.f;
-                fPC8D[8 * p + 7] = 1.f;
-            }
-        }
-    }
 
     // Storing =================================================================
 
     std::ostringstream spath;
     spath << "../data/kg_pc8d_" << suffix << ".bin";
-    const char *path = spath.str ().c_str ();
-    std::ofstream f (path, std::ios::binary);
-    f.write ((char *) fPC8D.data (), 480 * 640 * sizeof (cl_float8));
-    f.close ();
-    std::cout << "Point cloud saved in " << path << std::endl;
+    std::string path = spath.str ();
+
+    try
+    {
+        if (writer == nullptr)
+        {
+            using namespace cl_algo::ICP;
+            PCFileLayout layout = raw ? PCFileLayout::RGBD : PCFileLayout::FLOAT8;
+            PCFileCompression compression = compressed ? PCFileCompression::RLE : PCFileCompression::NONE;
+            writer = new PCFileWriter (path, 640, 480, 595.f, 595.f, layout, compression);
+        }
+
+        if (raw)
+            writer->append (depth, rgb, timestamp);
+        else
+            writer->append ((cl_float8 *) fPC8D.data (), timestamp);
+
+        if (writer->frames () == n_frames)
+        {
+            writer->close ();
+            std::cout << n_frames << (raw ? " frame(s)" : " point cloud(s)") 
+                      << " saved in " << path << std::endl;
+        }
+    }
+    catch (const char *error)
+    {
+        std::cerr << "Error[kinect_frame_grabber]: " << error << std::endl;
+        exit (EXIT_FAILURE);
+    }
 }
 
 
 /*! \brief Display callback for the window. */
 void drawGLScene ()
 {
-    static std::vector<uint8_t> rgb (3 * 640 * 480);
-    static std::vector<uint16_t> depth (640 * 480);
-
-    if (device->updateFrames (rgb, depth))
+    bool newFrame = device->updateFrames ();
+    if (newFrame)
         frame_id++;
 
-    if (!frame_taken && frame_id == 10)
+    const uint8_t *rgb = ring->rgb ();
+    const uint16_t *depth = ring->depth ();
+
+    // Skip the first frames, and then record the next n_frames ones
+    if (!frame_taken && newFrame && frame_id >= 10)
     {
         saveBinary (rgb, depth);
-        frame_taken = true;
+        frame_taken = writer->frames () == n_frames;
     }
 
     glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -471,7 +700,7 @@ void printInfo ()
  *  
  *  \param[in] argc command line argument count.
  *  \param[in] argv command line arguments.
- *  \param[in] flag argument to look for (`-s`, `-f`).
+ *  \param[in] flag argument to look for (`-s`, `-f`, `-n`, `-r`, `-c`).
  *  \return A string with the argument value.
  */
 std::string getArgument (int argc, char **argv, std::string flag)
@@ -480,9 +709,9 @@ std::string getArgument (int argc, char **argv, std::string flag)
     {
         if (flag.compare (argv[i]) == 0)
         {
-            if (flag.compare ("-s") == 0)
+            if ((flag.compare ("-s") == 0 || flag.compare ("-n") == 0) && i + 1 < argc)
                 return std::string (argv[i + 1]);
-            else if (flag.compare ("-f") == 0)
+            else if (flag.compare ("-f") == 0 || flag.compare ("-r") == 0 || flag.compare ("-c") == 0)
                 return std::string ("1");
         }
     }
@@ -513,6 +742,14 @@ void configure (int argc, char **argv)
 
     // Guided Image Filtering
     filtered = !getArgument (argc, argv, "-f").empty ();
+
+    // Raw recording, optionally compressed
+    raw = !getArgument (argc, argv, "-r").empty ();
+    compressed = raw && !getArgument (argc, argv, "-c").empty ();
+
+    // Number of frames to record
+    std::string frames = getArgument (argc, argv, "-n");
+    n_frames = frames.empty () ? 1 : std::max (std::stoi (frames), 1);
 }
 
 
@@ -523,6 +760,10 @@ int main (int argc, char **argv)
         configure (argc, argv);
         printInfo ();
 
+        // The frame slots and the pipeline are set up once, before the capture starts
+        builder = new CloudBuilder (filtered);
+        ring = new FrameRing (builder->getContext (), builder->getQueue (), 640 * 480);
+
         device = &freenect.createDevice<MyFreenectDevice> (0);
         device->startVideo ();
         device->startDepth ();
@@ -534,8 +775,18 @@ int main (int argc, char **argv)
         device->stopVideo ();
         device->stopDepth ();
 
+        delete writer;
+        delete ring;
+        delete builder;
+
         return 0;
     }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+    }
     catch (const std::runtime_error &error)
     {
         std::cerr << "Kinect: " << error.what () << std::endl;
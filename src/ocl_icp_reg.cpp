@@ -27,6 +27,8 @@
  */
 
 #include <ocl_icp_reg.hpp>
+#include <ICP/program_cache.hpp>
+#include <ICP/tuner.hpp>
 
 
 const std::vector<std::string> kernel_files_rbc = { "kernels/RBC/reduce_kernels.cl", 
@@ -34,6 +36,7 @@ const std::vector<std::string> kernel_files_rbc = { "kernels/RBC/reduce_kernels.
                                                     "kernels/RBC/rbc_kernels.cl" };
 
 const std::vector<std::string> kernel_files_icp = { "kernels/ICP/reduce_kernels.cl", 
+                                                    "kernels/ICP/scan_kernels.cl", 
                                                     "kernels/ICP/icp_kernels.cl" };
 
 
@@ -43,14 +46,22 @@ const std::vector<std::string> kernel_files_icp = { "kernels/ICP/reduce_kernels.
  *                           The buffer holds the information for two point clouds.
  *  \param[in] width width (in pixels) of the associated point clouds.
  *  \param[in] height height (in pixels) of the associated point clouds.
+ *  \param[in] m number of landmarks that the registration is set up for. 
+ *               The work-groups get tuned for it.
  */
-CLEnvGL::CLEnvGL (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, int width, int height) : 
+CLEnvGL::CLEnvGL (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, int width, int height, unsigned int m) : 
     CLEnv (), glPC4DBuffer (glPC4DBuffer), glRGBABuffer (glRGBABuffer), width (width), height (height)
 {
     addContext (0, true);
     addQueueGL (0);
-    addProgram (0, kernel_files_rbc);
-    addProgram (0, kernel_files_icp);
+    addQueue (0, 0);  // Queue for the frame uploads in streaming mode
+    addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);  // Queue for the work-group tuning
+    addQueueGL (0);  // Queue for the visualization
+    cl_algo::ICP::addProgramCached (*this, 0, kernel_files_rbc);
+    cl_algo::ICP::addProgramCached (*this, 0, kernel_files_icp);
+
+    // On the first run on a device, pick the local workspaces of the ICP kernels
+    cl_algo::ICP::tuneWorkGroups (*this, clutils::CLEnvInfo<1> (0, 0, 0, { 2 }, 1), m);
 }
 
 
@@ -75,18 +86,32 @@ void CLEnvGL::initGLMemObjects ()
  *                          The buffer holds the information for two point clouds.
  *  \param[in] glRGBABuffer OpenGL vertex buffer id for the color points. 
  *                          The buffer holds the information for two point clouds.
+ *  \param[in] _width width (in pixels) of the associated point clouds.
+ *  \param[in] _height height (in pixels) of the associated point clouds.
+ *  \param[in] _m number of landmarks to sample from each point cloud. It has to be a power of 2.
+ *  \param[in] _r number of fixed set representatives.
+ *  \param[in] _compact flag to indicate whether or not to sample landmarks 
+ *                      only among the valid (non-zero depth) points.
  */
 template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
-ICPReg<RC, WC>::ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) : 
-    width (640), height (480), n (640 * 480), m (16384), r (256), 
-    env (glPC4DBuffer, glRGBABuffer, width, height), 
-    infoRBC (0, 0, 0, { 0 }, 0), infoICP (0, 0, 0, { 0 }, 1), 
-    context (env.getContext (0)), queue (env.getQueue (0, 0)), 
+ICPReg<RC, WC>::ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, unsigned int _width, unsigned int _height, 
+                        unsigned int _m, unsigned int _r, bool _compact) : 
+    width (_width), height (_height), n (_width * _height), m (_m), r (_r), 
+    env (glPC4DBuffer, glRGBABuffer, width, height, m), 
+    infoRBC (0, 0, 0, { 0 }, 0), infoICP (0, 0, 0, { 0 }, 1), infoLM (0, 0, 0, { 1 }, 1), 
+    infoVis (0, 0, 0, { 3 }, 1), context (env.getContext (0)), 
+    queue (env.getQueue (0, 0)), queueLM (env.getQueue (0, 1)), queueVis (env.getQueue (0, 3)), 
     glPC4DBuffer (glPC4DBuffer), glRGBABuffer (glRGBABuffer), 
     blue { 0.f, 0.15f, 1.f, 1.f }, green { 0.3f, 1.f, 0.f, 1.f }, dummy { 0.f, 0.f, 0.f, 0.f }, 
     vBlue (n, *(cl_float4 *) blue), vGreen (n, *(cl_float4 *) green), vDummy (n, *(cl_float4 *) dummy), 
     a (2e2f), c (1e-6f), max_iterations (40), angle_threshold (0.001), translation_threshold (0.01), 
-    fLM (env, infoICP), mLM (env, infoICP), reg (env, infoRBC, infoICP), transform (env, infoICP)
+    pool (context, env.devices[0][0]), 
+    bp (env, infoICP, &pool), bpLM (env, infoLM, &pool), fLM (env, infoICP, &pool), mLM (env, infoICP, &pool), 
+    reg (env, infoRBC, infoICP, &pool), transform (env, infoVis, &pool), 
+    sEvents (slots), frames (0), visMode (ICPVisMode::EVERY), 
+    visRate (30.0), visAngle (5.0), visTranslation (50.0), 
+    visQ (Eigen::Quaternionf::Identity ()), dispQ (Eigen::Quaternionf::Identity ()), 
+    visT (Eigen::Vector3f::Zero ()), dispT (Eigen::Vector3f::Zero ())
 {
     // OpenGL buffer copy parameters
     src_origin_g[0] = 0;                  src_origin_g[1] = 0; src_origin_g[2] = 0;
@@ -99,14 +124,21 @@ ICPReg<RC, WC>::ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) :
     dBufferGL.emplace_back (context, CL_MEM_WRITE_ONLY, *glPC4DBuffer);
     dBufferGL.emplace_back (context, CL_MEM_WRITE_ONLY, *glRGBABuffer);
 
+    // The visualization reads a copy of the transformation, 
+    // so the registration can move on to the next estimate
+    dBufferVisT = cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+
     // Initialize classes
+    bp.init (width, height, 595.f, 595.f, cl_algo::ICP::Staging::I);
+    bpLM.init (width, height, 595.f, 595.f, cl_algo::ICP::Staging::I);
+
     fLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT) = 
         cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-    fLM.init (cl_algo::ICP::Staging::I);
+    fLM.init (width, height, m, _compact, cl_algo::ICP::Staging::I);
 
     mLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT) = 
         cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-    mLM.init (cl_algo::ICP::Staging::I);
+    mLM.init (width, height, m, _compact, cl_algo::ICP::Staging::I);
 
     reg.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IN_F) = fLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT);
     reg.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IN_M) = mLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT);
@@ -116,9 +148,31 @@ ICPReg<RC, WC>::ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) :
         <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_M) = 
         mLM.get (cl_algo::ICP::ICPLMs::Memory::D_IN);
     transform.get (cl_algo::ICP::ICPTransform
-        <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_T) = 
-        reg.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IO_T);
+        <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_T) = dBufferVisT;
     transform.init (n, cl_algo::ICP::Staging::NONE);
+
+    // Initialize the frame slots for streaming mode
+    sLM.reserve (slots);
+    sTransform.reserve (slots);
+    for (unsigned int i = 0; i < slots; ++i)
+    {
+        sLM.emplace_back (env, infoLM, &pool);
+        sLM[i].get (cl_algo::ICP::ICPLMs::Memory::D_OUT) = 
+            cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
+        sLM[i].init (width, height, m, _compact, cl_algo::ICP::Staging::I);
+
+        sTransform.emplace_back (env, infoVis, &pool);
+        sTransform[i].get (cl_algo::ICP::ICPTransform
+            <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_M) = 
+            sLM[i].get (cl_algo::ICP::ICPLMs::Memory::D_IN);
+        sTransform[i].get (cl_algo::ICP::ICPTransform
+            <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_T) = dBufferVisT;
+        sTransform[i].get (cl_algo::ICP::ICPTransform
+            <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_OUT) = 
+            transform.get (cl_algo::ICP::ICPTransform
+                <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_OUT);
+        sTransform[i].init (n, cl_algo::ICP::Staging::NONE);
+    }
 }
 
 
@@ -128,14 +182,56 @@ ICPReg<RC, WC>::ICPReg (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) :
  *  \param[in] pc8d2 moving point cloud.
  */
 template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
-void ICPReg<RC, WC>::init (std::vector<cl_float8> pc8d1, std::vector<cl_float8> pc8d2)
+void ICPReg<RC, WC>::init (const std::vector<cl_float8> &pc8d1, const std::vector<cl_float8> &pc8d2)
 {
+    syncVis ();  // The visualization might still be reading the point clouds
+
     fLM.write (cl_algo::ICP::ICPLMs::Memory::D_IN, (cl_float *) pc8d1.data ());
     mLM.write (cl_algo::ICP::ICPLMs::Memory::D_IN, (cl_float *) pc8d2.data ());
 
+    initBuffers ();
+}
+
+
+/*! \brief Initializes the OpenGL buffers from mapped point cloud files.
+ *  \details The frames are copied to the device straight from the mapped pages, 
+ *           through `CL_MEM_USE_HOST_PTR` buffers, without going through the 
+ *           staging buffers. Raw `RGBD` frames are back-projected on the device.
+ *  
+ *  \param[in] file1 file holding the fixed point cloud.
+ *  \param[in] idx1 index of the fixed point cloud in `file1`.
+ *  \param[in] file2 file holding the moving point cloud.
+ *  \param[in] idx2 index of the moving point cloud in `file2`.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::init (const cl_algo::ICP::PCFile &file1, unsigned int idx1, 
+                           const cl_algo::ICP::PCFile &file2, unsigned int idx2)
+{
+    if (file1.getHeader ().width * file1.getHeader ().height != n || 
+        file2.getHeader ().width * file2.getHeader ().height != n)
+        throw "The point cloud resolution doesn't match";
+
+    syncVis ();  // The visualization might still be reading the point clouds
+
+    upload (file1, idx1, (cl::Buffer &) fLM.get (cl_algo::ICP::ICPLMs::Memory::D_IN), queue, bp);
+    upload (file2, idx2, (cl::Buffer &) mLM.get (cl_algo::ICP::ICPLMs::Memory::D_IN), queue, bp);
+
+    initBuffers ();
+}
+
+
+/*! \brief Extracts the landmarks, and initializes the OpenGL buffers, 
+ *         once the point clouds have been uploaded. */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::initBuffers ()
+{
     fLM.run ();
     mLM.run ();
 
+    // The moving point cloud is displayed untransformed
+    visQ = dispQ = Eigen::Quaternionf::Identity ();
+    visT = dispT = Eigen::Vector3f::Zero ();
+
 
     glFinish ();  // Wait for OpenGL pending operations on buffers to finish
 
@@ -172,34 +268,297 @@ void ICPReg<RC, WC>::registerPC ()
     reg.run ();  // Perform the ICP registration
     timer.stop ();
 
-    transform.run ();  // Transform the moving point cloud
+    // Transform and display the moving point cloud on the visualization queue
+    if (visDue (false)) updateVis (transform);
+
+    print (timer.duration ());
+}
+
+
+/*! \brief Streams a frame through the registration pipeline.
+ *  \details Uploads the frame and extracts its landmarks on the second command queue. 
+ *           Meanwhile, the previous pair of frames gets registered on the main queue. 
+ *           The landmark extraction signals an event, which the registration waits on, 
+ *           so there is no synchronization point between the two queues.
+ *           The moving point cloud of the registered pair is transformed and 
+ *           displayed along with the fixed one.
+ *  \note The first two calls only fill the pipeline. The results of a call concern 
+ *        the frames passed in the two calls before it.
+ *  
+ *  \param[in] pc8d new point cloud frame.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::stream (const std::vector<cl_float8> &pc8d)
+{
+    // Upload the new frame on the second queue
+    // The slot is overwritten after the visualization is done reading it
+    std::vector<cl::Event> events { visEvent };
+    sLM[frames % slots].write (cl_algo::ICP::ICPLMs::Memory::D_IN, (cl_float *) pc8d.data (), 
+                               CL_FALSE, (visEvent () != nullptr) ? &events : nullptr);
+
+    streamSlot ();
+}
+
+
+/*! \brief Streams a frame of a mapped point cloud file through the registration pipeline.
+ *  \details Works like the `std::vector` overload, but the frame is copied 
+ *           to the device straight from the mapped pages, through a 
+ *           `CL_MEM_USE_HOST_PTR` buffer. Raw `RGBD` frames are back-projected 
+ *           on the second queue.
+ *  
+ *  \param[in] file file holding the point cloud frame.
+ *  \param[in] idx index of the frame in `file`.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::stream (const cl_algo::ICP::PCFile &file, unsigned int idx)
+{
+    if (file.getHeader ().width * file.getHeader ().height != n)
+        throw "The point cloud resolution doesn't match";
+
+    // Upload the new frame on the second queue, once the 
+    // visualization is done reading the slot
+    std::vector<cl::Event> events { visEvent };
+    upload (file, idx, (cl::Buffer &) sLM[frames % slots].get (cl_algo::ICP::ICPLMs::Memory::D_IN), 
+            queueLM, bpLM, (visEvent () != nullptr) ? &events : nullptr);
+
+    streamSlot ();
+}
+
+
+/*! \brief Uploads a frame of a mapped point cloud file to a device buffer.
+ *  \details `FLOAT8` frames are copied straight from the mapped pages. `RGBD` 
+ *           frames are decoded on the host, and back-projected on the device, 
+ *           so only the depth and RGB planes (5 bytes per pixel, instead of 32) 
+ *           go over the bus.
+ *  
+ *  \param[in] file file holding the frame.
+ *  \param[in] idx index of the frame in `file`.
+ *  \param[out] buffer device buffer that receives the point cloud.
+ *  \param[in] q command queue on which to enqueue the operations.
+ *  \param[in] backProject back-projection instance associated with `q`.
+ *  \param[in] events a wait-list of events for the write to `buffer`.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::upload (const cl_algo::ICP::PCFile &file, unsigned int idx, cl::Buffer &buffer, 
+                             cl::CommandQueue &q, cl_algo::ICP::ICPBackProject &backProject, 
+                             const std::vector<cl::Event> *events)
+{
+    const cl_algo::ICP::PCFileHeader &header = file.getHeader ();
+
+    if (header.layout == cl_algo::ICP::PCFileLayout::FLOAT8)
+    {
+        q.enqueueCopyBuffer (file.buffer (context, idx), buffer, 0, 0, n * sizeof (cl_float8), events);
+        return;
+    }
+
+    // The staging buffers are reused on the next call, so the writes are blocking
+    file.readRGBD (idx, backProject.hPtrInD, backProject.hPtrInRGB);
+    backProject.setIntrinsics (header.fx, header.fy, header.cx, header.cy);
+    backProject.write (cl_algo::ICP::ICPBackProject::Memory::D_IN_D, nullptr, CL_TRUE);
+    backProject.write (cl_algo::ICP::ICPBackProject::Memory::D_IN_RGB, nullptr, CL_TRUE);
+    backProject.run ();
+
+    q.enqueueCopyBuffer ((cl::Buffer &) backProject.get (cl_algo::ICP::ICPBackProject::Memory::D_OUT), 
+        buffer, 0, 0, n * sizeof (cl_float8), events);
+}
+
+
+/*! \brief Extracts the landmarks of an uploaded frame, and 
+ *         registers the previous pair of frames. */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::streamSlot ()
+{
+    static clutils::CPUTimer<double, std::milli> timer;
+
+    // Extract the landmarks of the new frame on the second queue
+    unsigned int s = frames % slots;
+    sLM[s].run (nullptr, &sEvents[s]);
+    queueLM.flush ();
+
+    if (frames++ < 2) return;
+
+    // Register the previous pair of frames on the main queue
+    unsigned int f = (frames - 3) % slots;
+    unsigned int mv = (frames - 2) % slots;
+    std::vector<cl::Event> events { sEvents[f], sEvents[mv] };
+
+    timer.start ();
+
+    queue.enqueueCopyBuffer ((cl::Buffer &) sLM[f].get (cl_algo::ICP::ICPLMs::Memory::D_OUT), 
+        (cl::Buffer &) reg.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IN_F), 
+        0, 0, m * sizeof (cl_float8), &events);
+    queue.enqueueCopyBuffer ((cl::Buffer &) sLM[mv].get (cl_algo::ICP::ICPLMs::Memory::D_OUT), 
+        (cl::Buffer &) reg.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IN_M), 
+        0, 0, m * sizeof (cl_float8));
+
+    reg.buildRBC ();  // Build the RBC data structure
+    reg.run ();  // Perform the ICP registration
+
+    timer.stop ();
+
+    // Display the fixed and the transformed point clouds on the visualization queue
+    if (visDue (true)) updateVis (sTransform[mv], &sLM[f].get (cl_algo::ICP::ICPLMs::Memory::D_IN));
+
+    print (timer.duration ());
+}
+
+
+/*! \brief Sets the update policy of the visualization.
+ *  
+ *  \param[in] mode update policy.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::setVisMode (ICPVisMode mode)
+{
+    visMode = mode;
+}
+
+
+/*! \brief Sets the maximum update rate of the visualization in `ICPVisMode::RATE` mode.
+ *  
+ *  \param[in] fps maximum number of updates per second.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::setVisRate (double fps)
+{
+    visRate = fps;
+}
+
+
+/*! \brief Sets the thresholds that mark a keyframe in `ICPVisMode::KEYFRAMES` mode.
+ *  \details The visualization gets updated when the rotation or the translation 
+ *           since the last update exceeds the respective threshold.
+ *  
+ *  \param[in] angle rotation threshold (in degrees).
+ *  \param[in] translation translation threshold (in mm).
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::setKeyframeThresholds (double angle, double translation)
+{
+    visAngle = angle;
+    visTranslation = translation;
+}
+
+
+/*! \brief Waits for the last update of the OpenGL buffers to finish.
+ *  \details Call it before OpenGL reads the buffers.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::syncVis ()
+{
+    if (visEvent () != nullptr) visEvent.wait ();
+}
+
+
+/*! \brief Decides whether to update the visualization after a registration.
+ *  \details An update that is due while the previous one is still in flight 
+ *           is dropped, except in `ICPVisMode::EVERY` mode, where it waits.
+ *  
+ *  \param[in] pairwise flag to indicate whether the estimate is relative to the 
+ *                      previous frame (streaming mode), instead of the fixed point cloud.
+ *  \return `true` if the visualization should be updated, `false` otherwise.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+bool ICPReg<RC, WC>::visDue (bool pairwise)
+{
+    // Keep track of the motion since the last update
+    if (pairwise)
+    {
+        visT = visQ * reg.t + visT;
+        visQ = visQ * reg.q;
+    }
+    else
+    {
+        visT = reg.t - dispT;
+        visQ = dispQ.conjugate () * reg.q;
+    }
+
+    bool pending = visEvent () != nullptr && 
+        visEvent.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS> () > CL_COMPLETE;
+
+    switch (visMode)
+    {
+        case ICPVisMode::EVERY:
+            if (pending) visEvent.wait ();
+            return true;
+        case ICPVisMode::RATE:
+            return !pending && (visEvent () == nullptr || visTimer.stop () >= 1e3 / visRate);
+        case ICPVisMode::KEYFRAMES:
+        {
+            double angle = 180.0 / M_PI * 2 * std::atan2 (visQ.vec ().norm (), std::abs (visQ.w ()));
+            return !pending && (angle >= visAngle || visT.norm () >= visTranslation);
+        }
+    }
+
+    return true;
+}
+
+
+/*! \brief Transforms the moving point cloud, and updates the OpenGL buffers, 
+ *         on the visualization queue.
+ *  \details The transformation estimate is copied on the main queue, and the 
+ *           visualization queue picks it up from there, so the two queues 
+ *           never wait on each other. The geometry and the color of 
+ *           the moving point cloud come straight out of the transformation.
+ *  
+ *  \param[in] tr transformation instance associated with the moving point cloud.
+ *  \param[in] fixed buffer with the fixed point cloud, if it has changed since the last update. 
+ *                   Then, the color of the moving point cloud gets updated as well.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::updateVis (
+    cl_algo::ICP::ICPTransform<cl_algo::ICP::ICPTransformConfig::QUATERNION> &tr, const cl::Memory *fixed)
+{
+    std::vector<cl::Event> events (1);
+    queue.enqueueCopyBuffer ((cl::Buffer &) reg.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IO_T), 
+        dBufferVisT, 0, 0, 2 * sizeof (cl_float4), nullptr, &events[0]);
+    queue.flush ();
+
+    tr.run (&events);  // Transform the moving point cloud
 
     glFinish ();  // Wait for OpenGL pending operations on buffers to finish
 
     // Take ownership of OpenGL buffers
-    queue.enqueueAcquireGLObjects ((std::vector<cl::Memory> *) &dBufferGL);
-
-    // Transfer the transformed point cloud to the OpenGL buffer
-    queue.enqueueCopyBufferRect (
-        (cl::Buffer &) transform.get (cl_algo::ICP::ICPTransform
-            <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_OUT), 
-        dBufferGL[0], src_origin_g, dst_origin_2, region, 
-        sizeof (cl_float8), 0, sizeof (cl_float4), 0);
+    queueVis.enqueueAcquireGLObjects ((std::vector<cl::Memory> *) &dBufferGL);
+
+    // Transfer the transformed (and the fixed) point cloud to the OpenGL buffers
+    cl::Buffer &out = (cl::Buffer &) tr.get (cl_algo::ICP::ICPTransform
+        <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_OUT);
+    queueVis.enqueueCopyBufferRect (out, dBufferGL[0], src_origin_g, dst_origin_2, region, sizeof (cl_float8), 0, sizeof (cl_float4), 0);
+    if (fixed != nullptr)
+    {
+        queueVis.enqueueCopyBufferRect (out, dBufferGL[1], src_origin_c, dst_origin_2, region, sizeof (cl_float8), 0, sizeof (cl_float4), 0);
+        queueVis.enqueueCopyBufferRect ((const cl::Buffer &) *fixed, dBufferGL[0], src_origin_g, dst_origin_1, region, sizeof (cl_float8), 0, sizeof (cl_float4), 0);
+        queueVis.enqueueCopyBufferRect ((const cl::Buffer &) *fixed, dBufferGL[1], src_origin_c, dst_origin_1, region, sizeof (cl_float8), 0, sizeof (cl_float4), 0);
+    }
 
     // Give up ownership of OpenGL buffers
-    queue.enqueueReleaseGLObjects ((std::vector<cl::Memory> *) &dBufferGL);
+    queueVis.enqueueReleaseGLObjects ((std::vector<cl::Memory> *) &dBufferGL, nullptr, &visEvent);
 
-    queue.finish ();
+    queueVis.flush ();
 
-    // Print results ===========================================================
-    
+    visTimer.start ();
+    visQ = Eigen::Quaternionf::Identity ();
+    visT = Eigen::Vector3f::Zero ();
+    dispQ = reg.q;
+    dispT = reg.t;
+}
+
+
+/*! \brief Displays the parameters of the last registration.
+ *  
+ *  \param[in] latency duration (in ms) of the registration.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPReg<RC, WC>::print (double latency)
+{
     double sinth_2 = reg.q.vec ().norm ();
     double angle = 180.f / M_PI * 2 * std::atan2 (sinth_2, reg.q.w ());
     Eigen::Vector3f axis ((sinth_2 == 0.0) ? Eigen::Vector3f::Zero () : reg.q.vec ().normalized ());
 
     std::cout << std::endl << "================" << std::endl << std::endl;
     std::cout << "    Iterations            :    " << reg.k << std::endl;
-    std::cout << "    Latency               :    " << timer.duration () << " ms" << std::endl;
+    std::cout << "    Latency               :    " << latency << " ms" << std::endl;
     std::cout << "    Rotation angle        :    " << angle << " degrees" << std::endl;
     std::cout << "    Rotation axis         :    " << axis.transpose () << std::endl;
     std::cout << "    Translation vector    :    " << reg.t.transpose () << std::endl;
@@ -27,6 +27,7 @@
  */
 
 #include <ocl_icp_sbs.hpp>
+#include <ICP/program_cache.hpp>
 
 
 const std::vector<std::string> kernel_files_rbc = { "kernels/RBC/reduce_kernels.cl", 
@@ -49,8 +50,9 @@ CLEnvGL::CLEnvGL (GLuint *glPC4DBuffer, GLuint *glRGBABuffer, int width, int hei
 {
     addContext (0, true);
     addQueueGL (0);
-    addProgram (0, kernel_files_rbc);
-    addProgram (0, kernel_files_icp);
+    addQueueGL (0);  // Queue for the visualization
+    cl_algo::ICP::addProgramCached (*this, 0, kernel_files_rbc);
+    cl_algo::ICP::addProgramCached (*this, 0, kernel_files_icp);
 }
 
 
@@ -80,13 +82,13 @@ template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
 ICPSBS<RC, WC>::ICPSBS (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) : 
     width (640), height (480), n (640 * 480), m (16384), r (256), 
     env (glPC4DBuffer, glRGBABuffer, width, height), 
-    infoRBC (0, 0, 0, { 0 }, 0), infoICP (0, 0, 0, { 0 }, 1), 
-    context (env.getContext (0)), queue (env.getQueue (0, 0)), 
+    infoRBC (0, 0, 0, { 0 }, 0), infoICP (0, 0, 0, { 0 }, 1), infoVis (0, 0, 0, { 1 }, 1), 
+    context (env.getContext (0)), queue (env.getQueue (0, 0)), queueVis (env.getQueue (0, 1)), 
     glPC4DBuffer (glPC4DBuffer), glRGBABuffer (glRGBABuffer), 
     blue { 0.f, 0.15f, 1.f, 1.f }, green { 0.3f, 1.f, 0.f, 1.f }, dummy { 0.f, 0.f, 0.f, 0.f }, 
     vBlue (n, *(cl_float4 *) blue), vGreen (n, *(cl_float4 *) green), vDummy (n, *(cl_float4 *) dummy), 
     a (2e2f), c (1e-6f), fLM (env, infoICP), mLM (env, infoICP), 
-    icpStep (env, infoRBC, infoICP), transform (env, infoICP)
+    icpStep (env, infoRBC, infoICP), transform (env, infoVis)
 {
     // OpenGL buffer copy parameters
     src_origin_g[0] = 0;                  src_origin_g[1] = 0; src_origin_g[2] = 0;
@@ -99,14 +101,17 @@ ICPSBS<RC, WC>::ICPSBS (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) :
     dBufferGL.emplace_back (context, CL_MEM_WRITE_ONLY, *glPC4DBuffer);
     dBufferGL.emplace_back (context, CL_MEM_WRITE_ONLY, *glRGBABuffer);
 
+    // The visualization reads a copy of the transformation
+    dBufferVisT = cl::Buffer (context, CL_MEM_READ_WRITE, 2 * sizeof (cl_float4));
+
     // Initialize classes
     fLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT) = 
         cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-    fLM.init (cl_algo::ICP::Staging::I);
+    fLM.init (width, height, m, false, cl_algo::ICP::Staging::I);
 
     mLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT) = 
         cl::Buffer (context, CL_MEM_READ_WRITE, m * sizeof (cl_float8));
-    mLM.init (cl_algo::ICP::Staging::I);
+    mLM.init (width, height, m, false, cl_algo::ICP::Staging::I);
 
     icpStep.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IN_F) = 
         fLM.get (cl_algo::ICP::ICPLMs::Memory::D_OUT);
@@ -118,8 +123,7 @@ ICPSBS<RC, WC>::ICPSBS (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) :
         <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_M) = 
         mLM.get (cl_algo::ICP::ICPLMs::Memory::D_IN);
     transform.get (cl_algo::ICP::ICPTransform
-        <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_T) = 
-        icpStep.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IO_T);
+        <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_IN_T) = dBufferVisT;
     transform.init (n, cl_algo::ICP::Staging::NONE);
 }
 
@@ -132,6 +136,8 @@ ICPSBS<RC, WC>::ICPSBS (GLuint *glPC4DBuffer, GLuint *glRGBABuffer) :
 template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
 void ICPSBS<RC, WC>::init (std::vector<cl_float8> pc8d1, std::vector<cl_float8> pc8d2)
 {
+    syncVis ();  // The visualization might still be reading the moving point cloud
+
     fLM.write (cl_algo::ICP::ICPLMs::Memory::D_IN, (cl_float *) pc8d1.data ());
     mLM.write (cl_algo::ICP::ICPLMs::Memory::D_IN, (cl_float *) pc8d2.data ());
 
@@ -178,26 +184,33 @@ void ICPSBS<RC, WC>::step ()
     queue.finish ();
     latency = timer.stop ();
 
-    transform.run ();  // Transform the moving point cloud
-
     config = false;
 
+    // Hand the transformation over to the visualization queue
+    std::vector<cl::Event> events (1);
+    syncVis ();  // The previous update might still be reading the transformation
+    queue.enqueueCopyBuffer ((cl::Buffer &) icpStep.get (cl_algo::ICP::ICPStep<RC, WC>::Memory::D_IO_T), 
+        dBufferVisT, 0, 0, 2 * sizeof (cl_float4), nullptr, &events[0]);
+    queue.flush ();
+
+    transform.run (&events);  // Transform the moving point cloud
+
     glFinish ();  // Wait for OpenGL pending operations on buffers to finish
 
     // Take ownership of OpenGL buffers
-    queue.enqueueAcquireGLObjects ((std::vector<cl::Memory> *) &dBufferGL);
+    queueVis.enqueueAcquireGLObjects ((std::vector<cl::Memory> *) &dBufferGL);
 
     // Transfer the transformed point cloud to the OpenGL buffer
-    queue.enqueueCopyBufferRect (
+    queueVis.enqueueCopyBufferRect (
         (cl::Buffer &) transform.get (cl_algo::ICP::ICPTransform
             <cl_algo::ICP::ICPTransformConfig::QUATERNION>::Memory::D_OUT), 
         dBufferGL[0], src_origin_g, dst_origin_2, region, 
         sizeof (cl_float8), 0, sizeof (cl_float4), 0);
 
     // Give up ownership of OpenGL buffers
-    queue.enqueueReleaseGLObjects ((std::vector<cl::Memory> *) &dBufferGL);
+    queueVis.enqueueReleaseGLObjects ((std::vector<cl::Memory> *) &dBufferGL, nullptr, &visEvent);
 
-    queue.finish ();
+    queueVis.flush ();
 
     // Print results ===========================================================
     
@@ -218,6 +231,16 @@ void ICPSBS<RC, WC>::step ()
 }
 
 
+/*! \brief Waits for the last update of the OpenGL buffers to finish.
+ *  \details Call it before OpenGL reads the buffers.
+ */
+template <cl_algo::ICP::ICPStepConfigT RC, cl_algo::ICP::ICPStepConfigW WC>
+void ICPSBS<RC, WC>::syncVis ()
+{
+    if (visEvent () != nullptr) visEvent.wait ();
+}
+
+
 /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers regular residual errors. */
 template class ICPSBS<cl_algo::ICP::ICPStepConfigT::EIGEN, cl_algo::ICP::ICPStepConfigW::REGULAR>;
 /*! \brief Instantiation that uses the Eigen library to estimate the rotation, and considers weighted residual errors. */
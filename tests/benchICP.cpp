@@ -0,0 +1,920 @@
+/*! \file benchICP.cpp
+ *  \brief Benchmark suite for the `%ICP` registration pipelines.
+ *  \details Sweeps the number of landmarks `m`, the number of representatives `r`,
+ *           the four `ICP<CR, CW>` configurations, and the single, batched,
+ *           pipelined and scheduled modes of execution on the GPU, and the `ICPCPU` backend
+ *           in the cpu mode, so that the sweep over `m` shows where the two cross over. 
+ *           For every point of the sweep, it reports
+ *           the per-iteration latency, the end-to-end registrations per second, and
+ *           the modelled host-device traffic per registration, in `CSV` or `JSON` format.
+ *  \note The latency percentiles are taken over the individual iterations in the single 
+ *        and pipelined modes, which are traced in repetitions of their own (look at 
+ *        `ICPTrace`), so that the events don't weigh on the throughput. The scheduled 
+ *        and cpu modes time every registration, and the batched mode every repetition, 
+ *        instead. The `latency_source` field tells which one applies.
+ *  \note Run from the build directory, e.g.
+ *        `./bin/icp_bench --m=4096,16384 --r=256 --repeat=20 --format=json --output=bench.json`.
+ *        Run with `--help` to list the options.
+ *  \note The datasets are reproducible. `kg_pc8d` and `kg_pc8d_wall` are the bundled pairs
+ *        of point clouds in `data`. `synthetic` registers the landmarks of `kg_pc8d_1` against
+ *        a copy of them, displaced by a rigid transformation and noise drawn from `--seed`.
+ *  \author Nick Lamprianidis
+ *  \version 1.1.0
+ *  \date 2015
+ *  \copyright The MIT License (MIT)
+ *  \par
+ *  Copyright (c) 2015 Nick Lamprianidis
+ *  \par
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *  \par
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *  \par
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <CLUtils.hpp>
+#include <ICP/algorithms.hpp>
+#include <ICP/trace.hpp>
+#include <ICP/program_cache.hpp>
+#include <ICP/scheduler.hpp>
+#include <ICP/cpu.hpp>
+
+
+// Kernel filenames
+const std::vector<std::string> kernel_files_rbc = { "kernels/RBC/reduce_kernels.cl",
+                                                    "kernels/RBC/scan_kernels.cl",
+                                                    "kernels/RBC/rbc_kernels.cl" };
+
+const std::vector<std::string> kernel_files_icp = { "kernels/ICP/reduce_kernels.cl",
+                                                    "kernels/ICP/scan_kernels.cl",
+                                                    "kernels/ICP/icp_kernels.cl" };
+
+const unsigned int width = 640;
+const unsigned int height = 480;
+const unsigned int n = width * height;
+
+typedef cl_algo::ICP::ICPStepConfigT CT;
+typedef cl_algo::ICP::ICPStepConfigW CW;
+
+
+/*! \brief Benchmark parameters, as given on the command line. */
+struct Options
+{
+    std::vector<unsigned int> m { 4096, 16384 };
+    std::vector<unsigned int> r { 128, 256 };
+    std::vector<std::string> configs { "eigen_regular", "eigen_weighted",
+                                       "power_method_regular", "power_method_weighted" };
+    std::vector<std::string> modes { "single", "batched", "pipelined", "scheduled", "cpu" };
+    std::string dataset { "kg_pc8d" };
+    std::string data_dir { "../data" };
+    std::string format { "csv" };
+    std::string output;
+    unsigned int pairs = 8;
+    unsigned int warmup = 2;
+    unsigned int repeat = 10;
+    unsigned int max_iterations = 40;
+    unsigned int batch_size = 0;
+    unsigned int threads = 0;
+    unsigned int seed = 42;
+};
+
+
+/*! \brief Measurements for one point of the sweep. */
+struct Result
+{
+    std::string config, mode;
+    unsigned int m, r;
+    double iterations;     /*!< Mean number of iterations per registration. */
+    double latency_mean;   /*!< Mean latency per iteration (in ms). */
+    double latency_p50;    /*!< Median latency per iteration (in ms). */
+    double latency_p99;    /*!< 99th percentile of the latency per iteration (in ms). */
+    /*! \brief What the latency samples are: `iteration` for traced iterations, `registration` 
+     *         for the duration of a registration over its iterations, or `repetition` for 
+     *         the duration of a repetition over the iterations of its longest registration. */
+    std::string latency_source;
+    double throughput;     /*!< End-to-end registrations per second. */
+    double h2d_bytes;      /*!< Mean host-to-device bytes per registration, as modelled by `countBytes`. */
+    double d2h_bytes;      /*!< Mean device-to-host bytes per registration, as modelled by `countBytes`. */
+};
+
+
+/*! \brief The pair of landmark sets registered in every registration. */
+struct Landmarks
+{
+    std::vector<cl_float8> fixed, moving;
+};
+
+
+/*! \brief Splits a comma separated list.
+ *
+ *  \param[in] list comma separated list.
+ *  \return The list items.
+ */
+std::vector<std::string> split (const std::string &list)
+{
+    std::vector<std::string> items;
+    std::istringstream ss (list);
+    std::string item;
+
+    while (std::getline (ss, item, ','))
+        if (!item.empty ()) items.push_back (item);
+
+    return items;
+}
+
+
+/*! \brief Prints the command line options. */
+void printUsage ()
+{
+    std::cout << "Usage: icp_bench [options]\n\n"
+              << "  --m=LIST           numbers of landmarks, powers of 2 (4096,16384)\n"
+              << "  --r=LIST           numbers of representatives (128,256)\n"
+              << "  --configs=LIST     eigen_regular, eigen_weighted, power_method_regular, \n"
+              << "                     power_method_weighted (all)\n"
+              << "  --modes=LIST       single, batched, pipelined, scheduled, cpu (all)\n"
+              << "  --dataset=NAME     kg_pc8d, kg_pc8d_wall, or synthetic (kg_pc8d)\n"
+              << "  --data=DIR         directory with the point clouds (../data)\n"
+              << "  --pairs=N          registrations per repetition, and batch size k (8)\n"
+              << "  --warmup=N         untimed repetitions (2)\n"
+              << "  --repeat=N         timed repetitions (10)\n"
+              << "  --max-iterations=N maximum number of iterations per registration (40)\n"
+              << "  --batch-size=N     iterations between convergence checks, in the single, pipelined, \n"
+              << "                     batched and scheduled modes, 0 keeps the default (0)\n"
+              << "  --threads=N        threads of the cpu mode, 0 uses all the hardware threads (0)\n"
+              << "  --seed=N           seed of the synthetic dataset (42)\n"
+              << "  --format=FORMAT    csv or json (csv)\n"
+              << "  --output=FILE      output file (stdout)\n";
+}
+
+
+/*! \brief Parses the command line options.
+ *
+ *  \param[in] argc command line argument count.
+ *  \param[in] argv command line arguments.
+ *  \param[out] opts the benchmark parameters.
+ *  \return False if the benchmark should not run.
+ */
+bool parse (int argc, char **argv, Options &opts)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg (argv[i]);
+        size_t eq = arg.find ('=');
+        std::string key = arg.substr (0, eq);
+        std::string value = (eq == std::string::npos) ? "" : arg.substr (eq + 1);
+
+        if (key == "--help")
+        {
+            printUsage ();
+            return false;
+        }
+        else if (key == "--m" || key == "--r")
+        {
+            std::vector<unsigned int> &list = (key == "--m") ? opts.m : opts.r;
+            list.clear ();
+            for (auto &item : split (value))
+                list.push_back (std::stoul (item));
+        }
+        else if (key == "--configs") opts.configs = split (value);
+        else if (key == "--modes") opts.modes = split (value);
+        else if (key == "--dataset") opts.dataset = value;
+        else if (key == "--data") opts.data_dir = value;
+        else if (key == "--pairs") opts.pairs = std::max (std::stoul (value), 1UL);
+        else if (key == "--warmup") opts.warmup = std::stoul (value);
+        else if (key == "--repeat") opts.repeat = std::max (std::stoul (value), 1UL);
+        else if (key == "--max-iterations") opts.max_iterations = std::max (std::stoul (value), 1UL);
+        else if (key == "--batch-size") opts.batch_size = std::stoul (value);
+        else if (key == "--threads") opts.threads = std::stoul (value);
+        else if (key == "--seed") opts.seed = std::stoul (value);
+        else if (key == "--format") opts.format = value;
+        else if (key == "--output") opts.output = value;
+        else
+        {
+            std::cerr << "Error[icp_bench]: Unknown option " << arg << std::endl;
+            printUsage ();
+            return false;
+        }
+    }
+
+    for (auto m : opts.m)
+        if (m == 0 || (m & (m - 1)) != 0)
+        {
+            std::cerr << "Error[icp_bench]: The number of landmarks has to be a power of 2" << std::endl;
+            return false;
+        }
+
+    return true;
+}
+
+
+/*! \brief Reads in a binary file.
+ *
+ *  \param[in] path path to the file.
+ *  \param[out] data array that receives the data.
+ *  \param[in] n number of bytes to read.
+ */
+void fread (const std::string &path, char *data, size_t n)
+{
+    std::ifstream f (path, std::ios::binary);
+    if (!f.read (data, n))
+        throw "Failed to read the point cloud";
+}
+
+
+/*! \brief Samples `m` landmarks from a point cloud on the device.
+ *
+ *  \param[in] env the OpenCL environment.
+ *  \param[in] pc8d the point cloud.
+ *  \param[in] m number of landmarks.
+ *  \return The landmarks.
+ */
+std::vector<cl_float8> sampleLMs (clutils::CLEnv &env, std::vector<cl_float8> &pc8d, unsigned int m)
+{
+    cl_algo::ICP::ICPLMs lm (env, clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 1));
+    lm.init (width, height, m, false, cl_algo::ICP::Staging::IO);
+    lm.write (cl_algo::ICP::ICPLMs::Memory::D_IN, (cl_float *) pc8d.data ());
+    lm.run ();
+    cl_float8 *ptr = (cl_float8 *) lm.read ();
+
+    return std::vector<cl_float8> (ptr, ptr + m);
+}
+
+
+/*! \brief Loads and samples the pair of landmark sets of the dataset.
+ *  \details For the `synthetic` dataset, the moving set is the fixed set,
+ *           rotated by up to 3 deg about a random axis, translated by up to
+ *           30 mm on every axis, and perturbed by gaussian noise of 1 mm.
+ *
+ *  \param[in] env the OpenCL environment.
+ *  \param[in] opts the benchmark parameters.
+ *  \param[in] m number of landmarks.
+ *  \return The pair of landmark sets.
+ */
+Landmarks loadLMs (clutils::CLEnv &env, const Options &opts, unsigned int m)
+{
+    bool synthetic = opts.dataset == "synthetic";
+    std::string name = synthetic ? "kg_pc8d" : opts.dataset;
+    std::vector<cl_float8> pc8d (n);
+    Landmarks lms;
+
+    fread (opts.data_dir + "/" + name + "_1.bin", (char *) pc8d.data (), n * sizeof (cl_float8));
+    lms.fixed = sampleLMs (env, pc8d, m);
+
+    if (!synthetic)
+    {
+        fread (opts.data_dir + "/" + name + "_2.bin", (char *) pc8d.data (), n * sizeof (cl_float8));
+        lms.moving = sampleLMs (env, pc8d, m);
+        return lms;
+    }
+
+    std::mt19937 gen (opts.seed);
+    std::uniform_real_distribution<float> uni (-1.f, 1.f);
+    std::normal_distribution<float> noise (0.f, 1.f);
+
+    Eigen::Vector3f axis (uni (gen), uni (gen), uni (gen));
+    float angle = 3.f * std::abs (uni (gen)) * M_PI / 180.f;
+    Eigen::Matrix3f R (Eigen::AngleAxisf (angle, axis.normalized ()));
+    Eigen::Vector3f t (30.f * uni (gen), 30.f * uni (gen), 30.f * uni (gen));
+
+    lms.moving = lms.fixed;
+    for (auto &p : lms.moving)
+    {
+        Eigen::Map<Eigen::Vector3f> x (p.s);
+        Eigen::Vector3f e (noise (gen), noise (gen), noise (gen));
+        x = R * x + t + e;
+    }
+
+    return lms;
+}
+
+
+/*! \brief Computes a percentile of a sample.
+ *
+ *  \param[in] v the sample.
+ *  \param[in] p the percentile, in [0, 1].
+ *  \return The percentile.
+ */
+double percentile (std::vector<double> v, double p)
+{
+    std::sort (v.begin (), v.end ());
+    return v[std::min ((size_t) (p * (v.size () - 1) + 0.5), v.size () - 1)];
+}
+
+
+/*! \brief Fills in the latency and throughput fields of a result.
+ *
+ *  \param[in] times the durations of the timed repetitions (in ms).
+ *  \param[in] iterations the total number of iterations in every timed repetition.
+ *  \param[in] pairs number of registrations per repetition.
+ *  \param[in] latency the latency samples (in ms), one per iteration, registration, 
+ *                     or repetition, as given by `source`.
+ *  \param[in] source what the latency samples are.
+ *  \param[out] res the result.
+ */
+void summarize (const std::vector<double> &times, const std::vector<unsigned int> &iterations,
+                unsigned int pairs, const std::vector<double> &latency, const std::string &source,
+                Result &res)
+{
+    double total = 0.0, totalIterations = 0.0;
+    for (size_t i = 0; i < times.size (); ++i)
+    {
+        total += times[i];
+        totalIterations += iterations[i];
+    }
+
+    res.iterations = totalIterations / (times.size () * pairs);
+    res.latency_mean = total / std::max (totalIterations, 1.0);
+    res.latency_p50 = latency.empty () ? 0.0 : percentile (latency, 0.50);
+    res.latency_p99 = latency.empty () ? 0.0 : percentile (latency, 0.99);
+    res.latency_source = source;
+    res.throughput = 1e3 * times.size () * pairs / total;
+}
+
+
+/*! \brief Collects the latencies of the traced iterations.
+ *  \details An iteration spans from the start of its first recorded stage 
+ *           to the end of its last one, on the device timeline. For the `EIGEN` 
+ *           configurations, that includes the solve on the host.
+ *
+ *  \param[in] trace the trace.
+ *  \param[out] latency the latencies (in ms) get appended to it.
+ */
+void collectIterations (const cl_algo::ICP::ICPTrace &trace, std::vector<double> &latency)
+{
+    const unsigned int START = (unsigned int) cl_algo::ICP::ICPStamp::START;
+    const unsigned int END = (unsigned int) cl_algo::ICP::ICPStamp::END;
+
+    for (unsigned int i = 0; i < trace.size (); ++i)
+    {
+        const cl_algo::ICP::ICPTraceRecord &rec = trace[i];
+        cl_ulong first = ~(cl_ulong) 0, last = 0;
+        for (unsigned int st = 0; st < cl_algo::ICP::nICPStages; ++st)
+        {
+            if (!rec.recorded[st]) continue;
+            first = std::min (first, rec.stamps[st][START]);
+            last = std::max (last, rec.stamps[st][END]);
+        }
+
+        if (last > first)
+            latency.push_back ((last - first) * 1e-6);
+    }
+}
+
+
+/*! \brief Resets an %ICP instance to the identity transformation, on the host and on the device.
+ *
+ *  \param[in] reg the %ICP instance.
+ */
+template <CT CR, CW CWt>
+void reset (cl_algo::ICP::ICP<CR, CWt> &reg)
+{
+    reg.q = Eigen::Quaternionf::Identity ();
+    reg.R = Eigen::Matrix3f::Identity ();
+    reg.t.setZero ();
+    reg.s = 1.f;
+
+    Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT, 4) = reg.q.coeffs ();  // Quaternion
+    Eigen::Map<Eigen::Vector4f> (reg.hPtrIOT + 4, 4) = reg.t.homogeneous ();  // Translation
+    reg.hPtrIOT[7] = reg.s;  // Scale
+
+    reg.write (cl_algo::ICP::ICP<CR, CWt>::Memory::D_IO_T);
+}
+
+
+/*! \brief Models the bytes that a registration of `k` iterations transfers.
+ *  \details The count follows the transfers the pipeline is known to enqueue, 
+ *           and is not measured. The landmarks and the initial transformation are uploaded once.
+ *           The `EIGEN` configurations then read back the means and the
+ *           `S` matrix, and upload the transformation, in every iteration.
+ *           The `POWER_METHOD` configurations read back the convergence
+ *           state once per batch, and the transformation once at the end.
+ *
+ *  \param[in] m number of landmarks.
+ *  \param[in] k number of iterations.
+ *  \param[in] pm flag to indicate a `POWER_METHOD` configuration.
+ *  \param[in] batch_size number of iterations between convergence checks.
+ *  \param[out] h2d host-to-device bytes.
+ *  \param[out] d2h device-to-host bytes.
+ */
+void countBytes (unsigned int m, unsigned int k, bool pm, unsigned int batch_size, double &h2d, double &d2h)
+{
+    const double T = 2 * sizeof (cl_float4), C = 2 * sizeof (cl_uint);
+
+    h2d += 2.0 * m * sizeof (cl_float8) + T;
+
+    if (pm)
+    {
+        unsigned int bs = std::max (batch_size, 1U);
+        unsigned int batches = (k + bs - 1) / bs;
+        h2d += C;
+        d2h += batches * C + T;
+    }
+    else
+    {
+        h2d += k * T;
+        d2h += k * (2 * sizeof (cl_float4) + 11 * sizeof (cl_float));
+    }
+}
+
+
+/*! \brief Benchmarks the single and the pipelined modes of a configuration.
+ *  \details In single mode, every registration uploads its landmarks, builds the `RBC`
+ *           data structure, and registers, one after the other on a single queue.
+ *           In pipelined mode, two instances on separate queues alternate, and the
+ *           uploads and `RBC` construction of the next registration are enqueued
+ *           before the current one gets registered. The timed repetitions are followed 
+ *           by as many traced ones, which give the per-iteration latencies.
+ *
+ *  \param[in] env the OpenCL environment.
+ *  \param[in] opts the benchmark parameters.
+ *  \param[in] lms the pair of landmark sets.
+ *  \param[in] m number of landmarks.
+ *  \param[in] r number of representatives.
+ *  \param[in] pipelined flag to select the pipelined mode.
+ *  \param[out] res the result.
+ */
+template <CT CR, CW CWt>
+void benchICP (clutils::CLEnv &env, const Options &opts, Landmarks &lms,
+               unsigned int m, unsigned int r, bool pipelined, Result &res)
+{
+    typedef cl_algo::ICP::ICP<CR, CWt> ICPT;
+    const bool pm = (CR == CT::POWER_METHOD);
+
+    ICPT reg0 (env, clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 0), clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 1));
+    ICPT reg1 (env, clutils::CLEnvInfo<1> (0, 0, 0, { 1 }, 0), clutils::CLEnvInfo<1> (0, 0, 0, { 1 }, 1));
+    ICPT *regs[2] = { &reg0, &reg1 };
+    unsigned int nRegs = pipelined ? 2 : 1;
+
+    for (unsigned int i = 0; i < nRegs; ++i)
+    {
+        regs[i]->init (m, r, 2e2f, 1e-6f, opts.max_iterations, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        if (opts.batch_size > 0) regs[i]->setBatchSize (opts.batch_size);
+    }
+
+    // Enqueues the uploads and the RBC construction of a registration
+    auto prepare = [&lms] (ICPT &reg)
+    {
+        reg.write (ICPT::Memory::D_IN_F, (cl_float *) lms.fixed.data ());
+        reg.write (ICPT::Memory::D_IN_M, (cl_float *) lms.moving.data ());
+        reset (reg);
+        reg.buildRBC ();
+    };
+
+    // Registers the pairs of a repetition, and returns their numbers of iterations
+    auto registration = [&] ()
+    {
+        std::vector<unsigned int> k (opts.pairs);
+
+        prepare (*regs[0]);
+        for (unsigned int i = 0; i < opts.pairs; ++i)
+        {
+            ICPT &reg = *regs[i % nRegs];
+            if (pipelined && i + 1 < opts.pairs)
+            {
+                prepare (*regs[(i + 1) % nRegs]);
+                env.getQueue (0, (i + 1) % nRegs).flush ();
+            }
+            reg.run ();
+            k[i] = reg.k;
+            if (!pipelined && i + 1 < opts.pairs)
+                prepare (reg);
+        }
+
+        return k;
+    };
+
+    clutils::CPUTimer<double, std::milli> cTimer;
+    std::vector<double> times, latency;
+    std::vector<unsigned int> iterations;
+    res.h2d_bytes = res.d2h_bytes = 0.0;
+
+    for (unsigned int rep = 0; rep < opts.warmup + opts.repeat; ++rep)
+    {
+        cTimer.start ();
+
+        std::vector<unsigned int> k = registration ();
+
+        double time = cTimer.stop ();
+
+        if (rep < opts.warmup) continue;
+
+        times.push_back (time);
+        iterations.push_back (0);
+        for (auto ki : k)
+        {
+            iterations.back () += ki;
+            countBytes (m, ki, pm, reg0.getBatchSize (), res.h2d_bytes, res.d2h_bytes);
+        }
+    }
+
+    // Traced repetitions
+    std::vector<cl_algo::ICP::ICPTrace> traces (nRegs, cl_algo::ICP::ICPTrace (opts.pairs * opts.max_iterations));
+    for (unsigned int i = 0; i < nRegs; ++i)
+        regs[i]->setTrace (&traces[i]);
+
+    for (unsigned int rep = 0; rep < opts.repeat; ++rep)
+    {
+        for (auto &trace : traces) trace.clear ();
+        registration ();
+        for (auto &trace : traces) collectIterations (trace, latency);
+    }
+
+    for (unsigned int i = 0; i < nRegs; ++i)
+        regs[i]->setTrace (nullptr);
+
+    res.h2d_bytes /= opts.repeat * opts.pairs;
+    res.d2h_bytes /= opts.repeat * opts.pairs;
+    summarize (times, iterations, opts.pairs, latency, "iteration", res);
+}
+
+
+/*! \brief Benchmarks the batched mode.
+ *  \details `ICPBatch` registers `pairs` copies of the pair of landmark sets at once.
+ *           It's only available for the `POWER_METHOD`, `REGULAR` configuration.
+ *
+ *  \param[in] env the OpenCL environment.
+ *  \param[in] opts the benchmark parameters.
+ *  \param[in] lms the pair of landmark sets.
+ *  \param[in] m number of landmarks.
+ *  \param[in] r number of representatives.
+ *  \param[out] res the result.
+ */
+void benchBatch (clutils::CLEnv &env, const Options &opts, Landmarks &lms,
+                 unsigned int m, unsigned int r, Result &res)
+{
+    typedef cl_algo::ICP::ICPBatch::Memory Memory;
+    const unsigned int k = opts.pairs;
+    const double T = 2 * sizeof (cl_float4), C = 2 * sizeof (cl_uint);
+
+    cl_algo::ICP::ICPBatch batch (env, clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 0),
+                                       clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 1));
+    batch.init (m, r, k, 2e2f, 1e-6f, opts.max_iterations, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    if (opts.batch_size > 0) batch.setBatchSize (opts.batch_size);
+
+    clutils::CPUTimer<double, std::milli> cTimer;
+    std::vector<double> times, latency;
+    std::vector<unsigned int> iterations;
+    res.h2d_bytes = res.d2h_bytes = 0.0;
+
+    for (unsigned int rep = 0; rep < opts.warmup + opts.repeat; ++rep)
+    {
+        cTimer.start ();
+
+        for (unsigned int i = 0; i < k; ++i)
+        {
+            std::copy ((cl_float *) lms.fixed.data (), (cl_float *) lms.fixed.data () + 8 * m,
+                       batch.hPtrInF + i * 8 * m);
+            std::copy ((cl_float *) lms.moving.data (), (cl_float *) lms.moving.data () + 8 * m,
+                       batch.hPtrInM + i * 8 * m);
+            std::fill (batch.hPtrIOT + i * 8, batch.hPtrIOT + (i + 1) * 8, 0.f);
+            batch.hPtrIOT[i * 8 + 3] = 1.f;  // Identity quaternion
+            batch.hPtrIOT[i * 8 + 7] = 1.f;  // Unit scale
+        }
+        batch.write (Memory::D_IN_F);
+        batch.write (Memory::D_IN_M);
+        batch.write (Memory::D_IO_T);
+        batch.buildRBC ();
+        batch.run ();
+
+        double time = cTimer.stop ();
+
+        if (rep < opts.warmup) continue;
+
+        unsigned int total = 0, longest = 0;
+        for (unsigned int i = 0; i < k; ++i)
+        {
+            total += batch.hPtrIOC[i * 2 + 1];
+            longest = std::max (longest, batch.hPtrIOC[i * 2 + 1]);
+        }
+
+        unsigned int bs = std::max (batch.getBatchSize (), 1U);
+        unsigned int batches = (longest + bs - 1) / bs;
+
+        times.push_back (time);
+        latency.push_back (time / std::max (longest, 1U));  // The pairs iterate in lockstep
+        iterations.push_back (total);
+        res.h2d_bytes += k * (2.0 * m * sizeof (cl_float8) + T + C);
+        res.d2h_bytes += batches * k * C + k * T;
+    }
+
+    res.h2d_bytes /= opts.repeat * k;
+    res.d2h_bytes /= opts.repeat * k;
+    summarize (times, iterations, k, latency, "repetition", res);
+}
+
+
+/*! \brief Benchmarks the scheduled mode of a configuration.
+ *  \details An `ICPScheduler` distributes the `pairs` registrations across one
+ *           pipeline per device, or across the two queues when there is a single device. 
+ *           The latency samples are the durations of the registrations on their pipelines.
+ *
+ *  \param[in] env the OpenCL environment.
+ *  \param[in] opts the benchmark parameters.
+ *  \param[in] lms the pair of landmark sets.
+ *  \param[in] m number of landmarks.
+ *  \param[in] r number of representatives.
+ *  \param[out] res the result.
+ */
+template <CT CR, CW CWt>
+void benchScheduler (clutils::CLEnv &env, const Options &opts, Landmarks &lms,
+                     unsigned int m, unsigned int r, Result &res)
+{
+    const bool pm = (CR == CT::POWER_METHOD);
+
+    // Queue 0 and 1 are on device 0, queue d + 1 is on device d
+    std::vector< clutils::CLEnvInfo<1> > infoRBC, infoICP;
+    unsigned int nDevices = (unsigned int) env.devices[0].size ();
+    for (unsigned int p = 0; p < std::max (nDevices, 2U); ++p)
+    {
+        unsigned int d = (nDevices > 1) ? p : 0, q = (p == 0) ? 0 : p + (nDevices > 1);
+        infoRBC.push_back (clutils::CLEnvInfo<1> (0, d, 0, { q }, 0));
+        infoICP.push_back (clutils::CLEnvInfo<1> (0, d, 0, { q }, 1));
+    }
+
+    cl_algo::ICP::ICPScheduler<CR, CWt> scheduler (env, infoRBC, infoICP);
+    scheduler.init (m, r, 2e2f, 1e-6f, opts.max_iterations, 0.001, 0.01);
+    if (opts.batch_size > 0) scheduler.setBatchSize (opts.batch_size);
+
+    clutils::CPUTimer<double, std::milli> cTimer;
+    std::vector<double> times, latency;
+    std::vector<unsigned int> iterations;
+    res.h2d_bytes = res.d2h_bytes = 0.0;
+
+    for (unsigned int rep = 0; rep < opts.warmup + opts.repeat; ++rep)
+    {
+        cTimer.start ();
+
+        for (unsigned int i = 0; i < opts.pairs; ++i)
+            scheduler.submit ((cl_float *) lms.fixed.data (), (cl_float *) lms.moving.data ());
+        auto regs = scheduler.collect ();
+
+        double time = cTimer.stop ();
+
+        if (rep < opts.warmup) continue;
+
+        times.push_back (time);
+        iterations.push_back (0);
+        for (auto &reg : regs)
+        {
+            iterations.back () += reg.k;
+            latency.push_back (reg.time / std::max (reg.k, 1U));
+            countBytes (m, reg.k, pm, scheduler.getBatchSize (), res.h2d_bytes, res.d2h_bytes);
+        }
+    }
+
+    res.h2d_bytes /= opts.repeat * opts.pairs;
+    res.d2h_bytes /= opts.repeat * opts.pairs;
+    summarize (times, iterations, opts.pairs, latency, "registration", res);
+}
+
+
+/*! \brief Benchmarks the cpu mode of a configuration.
+ *  \details An `ICPCPU` instance converts the landmarks, builds its `RBC` data 
+ *           structure, and registers, one registration after the other. 
+ *           There is no host-device traffic. The latency samples are the 
+ *           durations of the registrations.
+ *
+ *  \param[in] opts the benchmark parameters.
+ *  \param[in] lms the pair of landmark sets.
+ *  \param[in] m number of landmarks.
+ *  \param[in] r number of representatives.
+ *  \param[out] res the result.
+ */
+template <CT CR, CW CWt>
+void benchCPU (const Options &opts, Landmarks &lms, unsigned int m, unsigned int r, Result &res)
+{
+    typedef cl_algo::ICP::ICPCPU<CR, CWt> ICPT;
+
+    ICPT reg (opts.threads);
+    reg.init (m, r, 2e2f, 1e-6f, opts.max_iterations, 0.001, 0.01);
+
+    clutils::CPUTimer<double, std::milli> cTimer, rTimer;
+    std::vector<double> times, latency;
+    std::vector<unsigned int> iterations;
+    res.h2d_bytes = res.d2h_bytes = 0.0;
+
+    cl_float T0[8] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
+
+    for (unsigned int rep = 0; rep < opts.warmup + opts.repeat; ++rep)
+    {
+        unsigned int k = 0;
+        std::vector<double> regLatency (opts.pairs);
+
+        cTimer.start ();
+
+        for (unsigned int i = 0; i < opts.pairs; ++i)
+        {
+            rTimer.start ();
+            reg.write (ICPT::Memory::D_IN_F, (cl_float *) lms.fixed.data ());
+            reg.write (ICPT::Memory::D_IN_M, (cl_float *) lms.moving.data ());
+            reg.write (ICPT::Memory::D_IO_T, T0);
+            reg.buildRBC ();
+            reg.run ();
+            regLatency[i] = rTimer.stop () / std::max (reg.k, 1U);
+            k += reg.k;
+        }
+
+        double time = cTimer.stop ();
+
+        if (rep < opts.warmup) continue;
+
+        times.push_back (time);
+        iterations.push_back (k);
+        latency.insert (latency.end (), regLatency.begin (), regLatency.end ());
+    }
+
+    summarize (times, iterations, opts.pairs, latency, "registration", res);
+}
+
+
+/*! \brief Runs one point of the sweep.
+ *
+ *  \return False if the configuration doesn't support the mode.
+ */
+bool bench (clutils::CLEnv &env, const Options &opts, Landmarks &lms, unsigned int m, unsigned int r,
+            const std::string &config, const std::string &mode, Result &res)
+{
+    bool pipelined = mode == "pipelined";
+
+    res.config = config; res.mode = mode; res.m = m; res.r = r;
+
+    if (mode == "batched")
+    {
+        if (config != "power_method_regular") return false;
+        benchBatch (env, opts, lms, m, r, res);
+    }
+    else if (mode == "scheduled")
+    {
+        if (config == "eigen_regular")
+            benchScheduler<CT::EIGEN, CW::REGULAR> (env, opts, lms, m, r, res);
+        else if (config == "eigen_weighted")
+            benchScheduler<CT::EIGEN, CW::WEIGHTED> (env, opts, lms, m, r, res);
+        else if (config == "power_method_regular")
+            benchScheduler<CT::POWER_METHOD, CW::REGULAR> (env, opts, lms, m, r, res);
+        else if (config == "power_method_weighted")
+            benchScheduler<CT::POWER_METHOD, CW::WEIGHTED> (env, opts, lms, m, r, res);
+        else
+            throw "Unknown configuration";
+    }
+    else if (mode == "cpu")
+    {
+        if (config == "eigen_regular")
+            benchCPU<CT::EIGEN, CW::REGULAR> (opts, lms, m, r, res);
+        else if (config == "eigen_weighted")
+            benchCPU<CT::EIGEN, CW::WEIGHTED> (opts, lms, m, r, res);
+        else if (config == "power_method_regular")
+            benchCPU<CT::POWER_METHOD, CW::REGULAR> (opts, lms, m, r, res);
+        else if (config == "power_method_weighted")
+            benchCPU<CT::POWER_METHOD, CW::WEIGHTED> (opts, lms, m, r, res);
+        else
+            throw "Unknown configuration";
+    }
+    else if (mode != "single" && !pipelined)
+        throw "Unknown mode";
+    else if (config == "eigen_regular")
+        benchICP<CT::EIGEN, CW::REGULAR> (env, opts, lms, m, r, pipelined, res);
+    else if (config == "eigen_weighted")
+        benchICP<CT::EIGEN, CW::WEIGHTED> (env, opts, lms, m, r, pipelined, res);
+    else if (config == "power_method_regular")
+        benchICP<CT::POWER_METHOD, CW::REGULAR> (env, opts, lms, m, r, pipelined, res);
+    else if (config == "power_method_weighted")
+        benchICP<CT::POWER_METHOD, CW::WEIGHTED> (env, opts, lms, m, r, pipelined, res);
+    else
+        throw "Unknown configuration";
+
+    return true;
+}
+
+
+/*! \brief Writes the results.
+ *
+ *  \param[in] out output stream.
+ *  \param[in] opts the benchmark parameters.
+ *  \param[in] device description of the device and the driver.
+ *  \param[in] results the results.
+ */
+void report (std::ostream &out, const Options &opts, const std::string &device,
+             const std::vector<Result> &results)
+{
+    if (opts.format == "json")
+    {
+        out << "{\n  \"device\": \"" << device << "\",\n"
+            << "  \"dataset\": \"" << opts.dataset << "\",\n"
+            << "  \"pairs\": " << opts.pairs << ", \"warmup\": " << opts.warmup
+            << ", \"repeat\": " << opts.repeat << ", \"max_iterations\": " << opts.max_iterations << ",\n"
+            << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size (); ++i)
+        {
+            const Result &res = results[i];
+            out << "    { \"config\": \"" << res.config << "\", \"mode\": \"" << res.mode << "\", "
+                << "\"m\": " << res.m << ", \"r\": " << res.r << ", "
+                << "\"iterations\": " << res.iterations << ", "
+                << "\"latency_mean_ms\": " << res.latency_mean << ", "
+                << "\"latency_p50_ms\": " << res.latency_p50 << ", "
+                << "\"latency_p99_ms\": " << res.latency_p99 << ", "
+                << "\"latency_source\": \"" << res.latency_source << "\", "
+                << "\"registrations_per_s\": " << res.throughput << ", "
+                << "\"h2d_bytes_model\": " << res.h2d_bytes << ", "
+                << "\"d2h_bytes_model\": " << res.d2h_bytes << " }"
+                << ((i + 1 < results.size ()) ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+    else
+    {
+        out << "device,dataset,config,mode,m,r,pairs,warmup,repeat,iterations,"
+            << "latency_mean_ms,latency_p50_ms,latency_p99_ms,latency_source,registrations_per_s,"
+            << "h2d_bytes_model,d2h_bytes_model\n";
+        for (auto &res : results)
+            out << '"' << device << "\"," << opts.dataset << "," << res.config << "," << res.mode << ","
+                << res.m << "," << res.r << "," << opts.pairs << "," << opts.warmup << "," << opts.repeat << ","
+                << res.iterations << "," << res.latency_mean << "," << res.latency_p50 << ","
+                << res.latency_p99 << "," << res.latency_source << "," << res.throughput << ","
+                << res.h2d_bytes << "," << res.d2h_bytes << "\n";
+    }
+}
+
+
+int main (int argc, char **argv)
+{
+    try
+    {
+        Options opts;
+        if (!parse (argc, argv, opts)) return EXIT_SUCCESS;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv env;
+        env.addContext (0);
+        env.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        env.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);  // Second queue for the pipelined mode
+        for (unsigned int d = 1; d < env.devices[0].size (); ++d)
+            env.addQueue (0, d, CL_QUEUE_PROFILING_ENABLE);  // One queue per device for the scheduled mode
+        cl_algo::ICP::addProgramCached (env, 0, kernel_files_rbc);
+        cl_algo::ICP::addProgramCached (env, 0, kernel_files_icp);
+
+        cl::Device device = env.getContext (0).getInfo<CL_CONTEXT_DEVICES> ()[0];
+        std::string deviceInfo = device.getInfo<CL_DEVICE_NAME> () + " (" +
+                                 device.getInfo<CL_DRIVER_VERSION> () + ")";
+
+        std::vector<Result> results;
+        for (auto m : opts.m)
+        {
+            Landmarks lms = loadLMs (env, opts, m);
+
+            for (auto r : opts.r)
+                for (auto &config : opts.configs)
+                    for (auto &mode : opts.modes)
+                    {
+                        Result res;
+                        if (bench (env, opts, lms, m, r, config, mode, res))
+                        {
+                            results.push_back (res);
+                            std::cerr << config << " " << mode << " m=" << m << " r=" << r << ": "
+                                      << res.throughput << " reg/s" << std::endl;
+                        }
+                    }
+        }
+
+        if (opts.output.empty ())
+            report (std::cout, opts, deviceInfo, results);
+        else
+        {
+            std::ofstream f (opts.output);
+            report (f, opts, deviceInfo, results);
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ())
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+    catch (const char *error)
+    {
+        std::cerr << "Error[icp_bench]: " << error << std::endl;
+        exit (EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
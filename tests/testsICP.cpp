@@ -33,20 +33,31 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <fstream>
 #include <algorithm>
 #include <chrono>
 #include <random>
 #include <limits>
 #include <cmath>
+#include <thread>
 #include <gtest/gtest.h>
 #include <CLUtils.hpp>
 #include <RBC/data_types.hpp>
 #include <ICP/algorithms.hpp>
+#include <ICP/program_cache.hpp>
+#include <ICP/pc_file.hpp>
+#include <ICP/staging_pool.hpp>
+#include <ICP/scheduler.hpp>
+#include <ICP/cpu.hpp>
+#include <ICP/tiled.hpp>
+#include <ICP/tuner.hpp>
+#include <ICP/service.hpp>
 #include <ICP/tests/helper_funcs.hpp>
 
 
 // Kernel filenames
 const std::string kernel_filename_reduce { "kernels/ICP/reduce_kernels.cl" };
+const std::string kernel_filename_scan   { "kernels/ICP/scan_kernels.cl"   };
 const std::string kernel_filename_icp    { "kernels/ICP/icp_kernels.cl"    };
 
 // Uniform random number generators
@@ -141,6 +152,269 @@ TEST (ICP, getLMs)
 }
 
 
+/*! \brief Tests the **getLMs_Compact** kernel.
+ *  \details The kernel samples a set of landmarks among the valid points. 
+ *           The valid flags are scanned with the three-pass scan, and then 
+ *           again with the single-pass scan.
+ */
+TEST (ICP, getLMs_Compact)
+{
+    try
+    {
+        const unsigned int width = 640, height = 480;
+        const unsigned int n = width * height;  // 307200
+        const unsigned int m = 1 << 12;         //   4096
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        const std::vector<std::string> kernel_files = { kernel_filename_scan, 
+                                                        kernel_filename_icp };
+        clEnv.addProgram (0, kernel_files);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPLMs glm (clEnv, info);
+        glm.init (width, height, m, true);
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (glm.hPtrIn, glm.hPtrIn + n * d, ICP::rNum_0_10000);
+        // Invalidate about a third of the points
+        for (uint j = 0; j < n; ++j)
+            if (ICP::rNum_R_0_1 () < 0.33f) glm.hPtrIn[j * d + 2] = 0.f;
+        // ICP::printBufferF ("Original:", glm.hPtrIn, d, n, 3);
+
+        glm.write ();  // Copy data to device
+        
+        glm.run ();  // Execute kernels
+        
+        cl_float *results = (cl_float *) glm.read ();  // Copy results to host
+        // ICP::printBufferF ("Received:", results, d, m, 3);
+
+        // Produce reference landmarks
+        cl_float *refLM = new cl_float[m * d];
+        ICP::cpuICPLMsCompact (glm.hPtrIn, refLM, width, height, m);
+        // ICP::printBufferF ("Expected:", refLM, d, m, 3);
+
+        // Verify landmarks
+        for (uint j = 0; j < m; ++j)
+        {
+            ASSERT_NE (0.f, results[j * d + 2]);
+            for (uint k = 0; k < d; ++k)
+                ASSERT_EQ (refLM[j * d + k], results[j * d + k]);
+        }
+
+        // Repeat with the single-pass scan
+        ASSERT_FALSE (glm.getSinglePass ());
+        glm.setSinglePass (true);
+        glm.run ();
+        results = (cl_float *) glm.read ();
+        for (uint j = 0; j < m; ++j)
+            for (uint k = 0; k < d; ++k)
+                ASSERT_EQ (refLM[j * d + k], results[j * d + k]);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPLMsCompact (glm.hPtrIn, refLM, width, height, m);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = glm.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPLMs (Compact)");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **getLMs_SoA** kernel.
+ *  \details The kernel samples a set of landmarks from separate 
+ *           geometry and color streams.
+ */
+TEST (ICP, getLMs_SoA)
+{
+    try
+    {
+        const unsigned int width = 640, height = 480;
+        const unsigned int n = width * height;  // 307200
+        const unsigned int m = 1 << 14;         //  16384
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPLMs glm (clEnv, info);
+        glm.init (width, height, m, false, cl_algo::ICP::ICPLayout::SOA);
+
+        // Initialize data (writes on staging buffers directly)
+        std::generate (glm.hPtrIn, glm.hPtrIn + n * 4, ICP::rNum_0_10000);
+        std::generate (glm.hPtrInC, glm.hPtrInC + n * 4, ICP::rNum_0_255);
+
+        // Copy data to device
+        glm.write (cl_algo::ICP::ICPLMs::Memory::D_IN);
+        glm.write (cl_algo::ICP::ICPLMs::Memory::D_IN_C);
+        
+        glm.run ();  // Execute kernels
+        
+        cl_float *results = (cl_float *) glm.read ();  // Copy results to host
+        // ICP::printBufferF ("Received:", results, d, m, 3);
+
+        // Produce reference landmarks from the interleaved point cloud
+        cl_float *pc = new cl_float[n * d];
+        for (uint i = 0; i < n; ++i)
+        {
+            for (uint k = 0; k < 4; ++k)
+            {
+                pc[i * d + k] = glm.hPtrIn[i * 4 + k];
+                pc[i * d + 4 + k] = glm.hPtrInC[i * 4 + k] / 255.f;
+            }
+        }
+
+        cl_float *refLM = new cl_float[m * d];
+        ICP::cpuICPLMs (pc, refLM);
+        // ICP::printBufferF ("Expected:", refLM, d, m, 3);
+
+        // Verify landmarks
+        for (uint j = 0; j < m; ++j)
+        {
+            for (uint k = 0; k < 4; ++k)
+            {
+                ASSERT_EQ (refLM[j * d + k], results[j * d + k]);
+                ASSERT_FLOAT_EQ (refLM[j * d + 4 + k], results[j * d + 4 + k]);
+            }
+        }
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPLMs (pc, refLM);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = glm.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPLMs (SoA)");
+        }
+
+        delete[] pc;
+        delete[] refLM;
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `resize` method of the `ICPLMs` class.
+ *  \details An instance initialized at capacity samples fewer landmarks, 
+ *           on a coarser grid, and retains its memory objects.
+ */
+TEST (ICP, getLMs_Resize)
+{
+    try
+    {
+        const unsigned int n = 640 * 480;  // 307200
+        const unsigned int m = 1 << 14;    //  16384
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPLMs glm (clEnv, info);
+        glm.init ();  // Capacity
+
+        cl_mem dBufferIn = glm.get (cl_algo::ICP::ICPLMs::Memory::D_IN) ();
+        cl_mem dBufferOut = glm.get (cl_algo::ICP::ICPLMs::Memory::D_OUT) ();
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (glm.hPtrIn, glm.hPtrIn + n * d, ICP::rNum_0_10000);
+
+        glm.write ();  // Copy data to device
+
+        // Fewer landmarks, with an odd power of 2, and back to the capacity
+        for (unsigned int mk : { m / 4, m / 8, m })
+        {
+            glm.resize (mk);
+
+            // The memory objects are retained
+            ASSERT_EQ (dBufferIn, glm.get (cl_algo::ICP::ICPLMs::Memory::D_IN) ());
+            ASSERT_EQ (dBufferOut, glm.get (cl_algo::ICP::ICPLMs::Memory::D_OUT) ());
+
+            glm.run ();  // Execute kernels
+            
+            cl_float *results = (cl_float *) glm.read ();  // Copy results to host
+
+            // Produce reference landmarks
+            std::vector<cl_float> refLM (mk * d);
+            ICP::cpuICPLMs (glm.hPtrIn, refLM.data (), 640, 480, mk);
+
+            // Verify landmarks
+            for (uint j = 0; j < mk; ++j)
+                for (uint k = 0; k < d; ++k)
+                    ASSERT_EQ (refLM[j * d + k], results[j * d + k]);
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
 /*! \brief Tests the **icpGetReps** kernel.
  *  \details The kernel samples a set of representatives.
  */
@@ -222,6 +496,67 @@ TEST (ICP, getReps)
 }
 
 
+/*! \brief Tests the **getReps** kernel, when the representatives are as dense as the landmarks.
+ *  \details Every landmark in a dimension is a representative, and the 
+ *           sampling offset in that dimension is 0.
+ */
+TEST (ICP, getReps_Dense)
+{
+    try
+    {
+        const unsigned int m = 1 << 12;  //  4096
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+
+        // Steps of 1 in both dimensions, and in the x dimension only
+        for (unsigned int nr : { m, m / 2 })
+        {
+            cl_algo::ICP::ICPReps grp (clEnv, info);
+            grp.init (nr, m);
+
+            // Initialize data (writes on staging buffer directly)
+            std::generate (grp.hPtrIn, grp.hPtrIn + m * d, ICP::rNum_0_10000);
+
+            grp.write ();  // Copy data to device
+            
+            grp.run ();  // Execute kernels
+            
+            cl_float *results = (cl_float *) grp.read ();  // Copy results to host
+
+            // Produce reference representatives
+            std::vector<cl_float> refRep (nr * d);
+            ICP::cpuICPReps (grp.hPtrIn, refRep.data (), nr, m);
+
+            // Verify representatives
+            for (uint j = 0; j < nr; ++j)
+                for (uint k = 0; k < d; ++k)
+                    ASSERT_EQ (refRep[j * d + k], results[j * d + k]);
+
+            // With steps of 1, every landmark is a representative
+            if (nr == m)
+            {
+                for (uint k = 0; k < m * d; ++k)
+                    ASSERT_EQ (grp.hPtrIn[k], results[k]);
+            }
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
 /*! \brief Tests the **icpComputeReduceWeights** kernel.
  *  \details The kernel computes weights and their sum.
  */
@@ -406,19 +741,16 @@ TEST (ICP, icpMean)
 }
 
 
-/*! \brief Tests the **icpMean_Weighted** kernel.
- *  \details The kernel computes the means of sets of points.
+/*! \brief Tests the single-pass **icpMean_SP** kernel.
+ *  \details The kernel computes the means of sets of points, in a single launch. 
+ *           The results are compared against the two-pass computation.
  */
-TEST (ICP, icpMean_Weighted)
+TEST (ICP, icpMean_SinglePass)
 {
     try
     {
         const unsigned int n = 1 << 14;  // 16384
         const unsigned int d = 8;
-        // const unsigned int bufferInFMSize = n * sizeof (cl_float8);
-        // const unsigned int bufferInWSize = n * sizeof (cl_float);
-        // const unsigned int bufferInSWSize = sizeof (cl_double);
-        // const unsigned int bufferOutSize = 2 * sizeof (cl_float4);
 
         // Setup the OpenCL environment
         clutils::CLEnv clEnv;
@@ -428,39 +760,175 @@ TEST (ICP, icpMean_Weighted)
 
         // Configure kernel execution parameters
         clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
-        const cl_algo::ICP::ICPMeanConfig C = cl_algo::ICP::ICPMeanConfig::WEIGHTED;
+        const cl_algo::ICP::ICPMeanConfig C = cl_algo::ICP::ICPMeanConfig::REGULAR;
         cl_algo::ICP::ICPMean<C> mean (clEnv, info);
         mean.init (n);
+        ASSERT_FALSE (mean.getSinglePass ());  // Off by default
 
         // Initialize data (writes on staging buffer directly)
         std::generate (mean.hPtrInF, mean.hPtrInF + n * d, ICP::rNum_0_10000);
         std::generate (mean.hPtrInM, mean.hPtrInM + n * d, ICP::rNum_0_255);
-        std::generate (mean.hPtrInW, mean.hPtrInW + n, ICP::rNum_R_0_1);
-        mean.hPtrInSW[0] = std::accumulate (mean.hPtrInW, mean.hPtrInW + n, 0.0);
-        // ICP::printBufferF ("Original F:", mean.hPtrInF, d, n, 3);
-        // ICP::printBufferF ("Original M:", mean.hPtrInM, d, n, 3);
-        // ICP::printBufferF ("Original W:", mean.hPtrInW, 1, n, 3);
 
         // Copy data to device
         mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_F);
         mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_M);
-        mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_W);
-        mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_SUM_W);
-        
-        mean.run ();  // Execute kernels (~ 25 us)
-        
-        cl_float *results = (cl_float *) mean.read ();  // Copy results to host
-        // ICP::printBufferF ("Received:", results, 4, 2, 3);
+
+        // Two-pass computation
+        mean.run ();
+        cl_float *results = (cl_float *) mean.read ();
+        std::vector<cl_float> twoPass (results, results + 8);
 
         // Produce reference mean vector
         cl_float refMean[8];
-        ICP::cpuICPMeanWeighted (mean.hPtrInF, mean.hPtrInM, refMean, mean.hPtrInW, n);
-        // ICP::printBufferF ("Expected:", refMean, 4, 2, 3);
+        ICP::cpuICPMean (mean.hPtrInF, mean.hPtrInM, refMean, n);
 
-        // Verify mean vector
+        // Single-pass computation, repeated to check that the counters get reset
+        mean.setSinglePass (true);
         float eps = 420000 * std::numeric_limits<float>::epsilon ();  // 0.0500679
-        for (uint i = 0; i < 8; ++i)
-            ASSERT_LT (std::abs (refMean[i] - results[i]), eps);
+        for (int k = 0; k < 3; ++k)
+        {
+            mean.run ();
+            results = (cl_float *) mean.read ();
+
+            for (uint i = 0; i < 8; ++i)
+            {
+                ASSERT_LT (std::abs (refMean[i] - results[i]), eps);
+                ASSERT_LT (std::abs (twoPass[i] - results[i]), eps);
+            }
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `resize` method of the `ICPMean` class.
+ *  \details An instance initialized at capacity computes the means of 
+ *           smaller sets, and retains its memory objects.
+ */
+TEST (ICP, icpMean_Resize)
+{
+    try
+    {
+        const unsigned int n = 1 << 14;  // 16384
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const cl_algo::ICP::ICPMeanConfig C = cl_algo::ICP::ICPMeanConfig::REGULAR;
+        cl_algo::ICP::ICPMean<C> mean (clEnv, info);
+        mean.init (n);  // Capacity
+
+        cl_mem dBufferInF = mean.get (cl_algo::ICP::ICPMean<C>::Memory::D_IN_F) ();
+        cl_mem dBufferOut = mean.get (cl_algo::ICP::ICPMean<C>::Memory::D_OUT) ();
+
+        // Smaller sets, down to a single work-group, and back to the capacity
+        for (unsigned int nk : { n / 4, 64u, n })
+        {
+            mean.resize (nk);
+
+            // The memory objects are retained
+            ASSERT_EQ (dBufferInF, mean.get (cl_algo::ICP::ICPMean<C>::Memory::D_IN_F) ());
+            ASSERT_EQ (dBufferOut, mean.get (cl_algo::ICP::ICPMean<C>::Memory::D_OUT) ());
+
+            // Initialize data (writes on staging buffer directly)
+            std::generate (mean.hPtrInF, mean.hPtrInF + nk * d, ICP::rNum_0_10000);
+            std::generate (mean.hPtrInM, mean.hPtrInM + nk * d, ICP::rNum_0_255);
+
+            // Copy data to device
+            mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_F);
+            mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_M);
+            
+            mean.run ();  // Execute kernels
+            
+            cl_float *results = (cl_float *) mean.read ();  // Copy results to host
+
+            // Produce reference mean vector
+            cl_float refMean[8];
+            ICP::cpuICPMean (mean.hPtrInF, mean.hPtrInM, refMean, nk);
+
+            // Verify mean vector
+            float eps = 420000 * std::numeric_limits<float>::epsilon ();  // 0.0500679
+            for (uint i = 0; i < 8; ++i)
+                ASSERT_LT (std::abs (refMean[i] - results[i]), eps);
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **icpMean_Weighted** kernel.
+ *  \details The kernel computes the means of sets of points.
+ */
+TEST (ICP, icpMean_Weighted)
+{
+    try
+    {
+        const unsigned int n = 1 << 14;  // 16384
+        const unsigned int d = 8;
+        // const unsigned int bufferInFMSize = n * sizeof (cl_float8);
+        // const unsigned int bufferInWSize = n * sizeof (cl_float);
+        // const unsigned int bufferInSWSize = sizeof (cl_double);
+        // const unsigned int bufferOutSize = 2 * sizeof (cl_float4);
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const cl_algo::ICP::ICPMeanConfig C = cl_algo::ICP::ICPMeanConfig::WEIGHTED;
+        cl_algo::ICP::ICPMean<C> mean (clEnv, info);
+        mean.init (n);
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (mean.hPtrInF, mean.hPtrInF + n * d, ICP::rNum_0_10000);
+        std::generate (mean.hPtrInM, mean.hPtrInM + n * d, ICP::rNum_0_255);
+        std::generate (mean.hPtrInW, mean.hPtrInW + n, ICP::rNum_R_0_1);
+        mean.hPtrInSW[0] = std::accumulate (mean.hPtrInW, mean.hPtrInW + n, 0.0);
+        // ICP::printBufferF ("Original F:", mean.hPtrInF, d, n, 3);
+        // ICP::printBufferF ("Original M:", mean.hPtrInM, d, n, 3);
+        // ICP::printBufferF ("Original W:", mean.hPtrInW, 1, n, 3);
+
+        // Copy data to device
+        mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_F);
+        mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_M);
+        mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_W);
+        mean.write (cl_algo::ICP::ICPMean<C>::Memory::D_IN_SUM_W);
+        
+        mean.run ();  // Execute kernels (~ 25 us)
+        
+        cl_float *results = (cl_float *) mean.read ();  // Copy results to host
+        // ICP::printBufferF ("Received:", results, 4, 2, 3);
+
+        // Produce reference mean vector
+        cl_float refMean[8];
+        ICP::cpuICPMeanWeighted (mean.hPtrInF, mean.hPtrInM, refMean, mean.hPtrInW, n);
+        // ICP::printBufferF ("Expected:", refMean, 4, 2, 3);
+
+        // Verify mean vector
+        float eps = 420000 * std::numeric_limits<float>::epsilon ();  // 0.0500679
+        for (uint i = 0; i < 8; ++i)
+            ASSERT_LT (std::abs (refMean[i] - results[i]), eps);
 
         // Profiling ===========================================================
         if (profiling)
@@ -789,6 +1257,127 @@ TEST (ICP, icpSijProducts_Weighted)
 }
 
 
+/*! \brief Tests the **icpSijProducts_Fused** and **icpSijFinalize_Fused** kernels.
+ *  \details The kernels produce the weighted S matrix and the weighted means 
+ *           of the fixed and moving sets in one pass over the points. The test 
+ *           runs twice, first with zero reference points, and then with the 
+ *           means of the first run as the reference points.
+ */
+TEST (ICP, icpSijProducts_Fused)
+{
+    try
+    {
+        const std::vector<std::string> kernel_files = { kernel_filename_reduce, 
+                                                        kernel_filename_icp };
+
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int d = 8;
+        const float c = 1e-6f;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_files);
+
+        cl::Context &context = clEnv.getContext (0);
+
+        // Initialize data
+        std::vector<cl_float> F (m * d), M (m * d), W (m);
+        std::function<float ()> rNum_R__1000_1000 = std::bind (
+            std::uniform_real_distribution<float> (-1000.f, 1000.f), 
+            std::default_random_engine (std::chrono::system_clock::now ().time_since_epoch ().count ()));
+        std::generate (F.begin (), F.end (), rNum_R__1000_1000);
+        std::generate (M.begin (), M.end (), rNum_R__1000_1000);
+        std::generate (W.begin (), W.end (), ICP::rNum_R_0_1);
+        cl_double sumW = std::accumulate (W.begin (), W.end (), 0.0);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const cl_algo::ICP::ICPSConfig C = cl_algo::ICP::ICPSConfig::FUSED;
+        cl_algo::ICP::ICPS<C> s (clEnv, info);
+
+        // The inputs are produced on the device, so copy them on buffers given to the class
+        s.get (cl_algo::ICP::ICPS<C>::Memory::D_IN_F) = 
+            cl::Buffer (context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, m * d * sizeof (cl_float), F.data ());
+        s.get (cl_algo::ICP::ICPS<C>::Memory::D_IN_M) = 
+            cl::Buffer (context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, m * d * sizeof (cl_float), M.data ());
+        s.get (cl_algo::ICP::ICPS<C>::Memory::D_IN_W) = 
+            cl::Buffer (context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, m * sizeof (cl_float), W.data ());
+        s.get (cl_algo::ICP::ICPS<C>::Memory::D_IN_SUM_W) = 
+            cl::Buffer (context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof (cl_double), &sumW);
+        s.init (m, c);
+
+        // Produce reference means and S matrix
+        cl_float refMean[8], refS[11];
+        std::vector<cl_float> DF (m * 4), DM (m * 4);
+        ICP::cpuICPMeanWeighted (F.data (), M.data (), refMean, W.data (), m);
+        ICP::cpuICPDevs (F.data (), M.data (), DF.data (), DM.data (), refMean, m);
+        ICP::cpuICPSw (DM.data (), DF.data (), W.data (), refS, m, c);
+        std::swap (refS[9], refS[10]);  // The kernels produce fp' * fp before mp' * mp
+
+        float eps = 4200 * std::numeric_limits<float>::epsilon ();  // 0.000500679
+        float epsMean = 0.05f;
+
+        for (uint r = 0; r < 2; ++r)
+        {
+            s.run ();  // Execute kernels
+
+            cl_float *results = (cl_float *) s.read ();  // Copy results to host
+            cl_float *means = (cl_float *) s.read (cl_algo::ICP::ICPS<C>::Memory::H_OUT_MEAN);
+            // ICP::printBufferF ("Received:", results, 11, 1, 7);
+            // ICP::printBufferF ("Expected:", refS, 11, 1, 7);
+
+            // Verify S matrix
+            for (uint i = 0; i < 11; ++i)
+                ASSERT_LT (std::abs (refS[i] - results[i]), eps);
+
+            // Verify means
+            for (uint i = 0; i < 3; ++i)
+            {
+                ASSERT_LT (std::abs (refMean[i] - means[i]), epsMean);
+                ASSERT_LT (std::abs (refMean[4 + i] - means[4 + i]), epsMean);
+            }
+        }
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPMeanWeighted (F.data (), M.data (), refMean, W.data (), m);
+                ICP::cpuICPDevs (F.data (), M.data (), DF.data (), DM.data (), refMean, m);
+                ICP::cpuICPSw (DM.data (), DF.data (), W.data (), refS, m, c);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = s.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPS<ICPSConfig::FUSED>");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
 /*! \brief Tests the **icpTransform_Quaternion** kernel.
  *  \details The kernel transforms a set of points using a 
  *           unit quaternion and a translation vector.
@@ -884,17 +1473,16 @@ TEST (ICP, icpTransform_Quaternion)
 }
 
 
-/*! \brief Tests the **icpTransform_Matrix** kernel.
- *  \details The kernel transforms a set of points using a transformation matrix.
+/*! \brief Tests the **icpTransform_Quaternion_SoA** kernel.
+ *  \details The kernel transforms the geometry stream of a set of points 
+ *           using a quaternion and a translation vector.
  */
-TEST (ICP, icpTransform_Matrix)
+TEST (ICP, icpTransform_Quaternion_SoA)
 {
     try
     {
         const unsigned int m = 1 << 14;  // 16384
-        const unsigned int d = 8;
-        // const unsigned int bufferInSize = m * sizeof (cl_float8);
-        // const unsigned int bufferOutSize = m * sizeof (cl_float8);
+        const unsigned int d = 4;
 
         // Setup the OpenCL environment
         clutils::CLEnv clEnv;
@@ -904,43 +1492,40 @@ TEST (ICP, icpTransform_Matrix)
 
         // Configure kernel execution parameters
         clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
-        const cl_algo::ICP::ICPTransformConfig C = cl_algo::ICP::ICPTransformConfig::MATRIX;
-        cl_algo::ICP::ICPTransform<C> transform (clEnv, info);
+        const cl_algo::ICP::ICPTransformConfig C = cl_algo::ICP::ICPTransformConfig::QUATERNION;
+        const cl_algo::ICP::ICPLayout L = cl_algo::ICP::ICPLayout::SOA;
+        cl_algo::ICP::ICPTransform<C, L> transform (clEnv, info);
         transform.init (m);
 
         // Initialize data (writes on staging buffer directly)
         // Randomized set of points
         std::generate (transform.hPtrInM, transform.hPtrInM + m * d, ICP::rNum_0_255);
+        // Some random unit quaternion
+        transform.hPtrInT[0] = 0.5144; transform.hPtrInT[1] = 0.5743;
+        transform.hPtrInT[2] = 0.5632; transform.hPtrInT[3] = 0.2973;
+        // Randomized translation vector
+        std::generate (transform.hPtrInT + 4, transform.hPtrInT + 7, ICP::rNum_0_255);
         // Some random scaling factor
-        float s = ICP::rNum_R_0_1 ();
-        // Some random rotation matrix (axis = (1/sqrt(3), 1/sqrt(3), 1/sqrt(3)), angle = 36.21deg)
-        transform.hPtrInT[0] = s *  0.871238; transform.hPtrInT[1] = s * -0.276687;
-        transform.hPtrInT[2] = s *  0.405449; transform.hPtrInT[3] = ICP::rNum_0_255 ();
-        transform.hPtrInT[4] = s *  0.405449; transform.hPtrInT[5] = s *  0.871238;
-        transform.hPtrInT[6] = s * -0.276687; transform.hPtrInT[7] = ICP::rNum_0_255 ();
-        transform.hPtrInT[8] = s * -0.276687; transform.hPtrInT[9] = s *  0.405449;
-        transform.hPtrInT[10] = s * 0.871238; transform.hPtrInT[11] = ICP::rNum_0_255 ();
-        transform.hPtrInT[12] = 0.f; transform.hPtrInT[13] = 0.f;
-        transform.hPtrInT[14] = 0.f; transform.hPtrInT[15] = 1.f;
+        std::generate (transform.hPtrInT + 7, transform.hPtrInT + 8, ICP::rNum_R_0_1);
         // ICP::printBufferF ("Original M:", transform.hPtrInM, d, m, 3);
-        // ICP::printBufferF ("Original T:", transform.hPtrInT, 4, 4, 3);
+        // ICP::printBufferF ("Original T:", transform.hPtrInT, 1, 8, 3);
 
         // Copy data to device
-        transform.write (cl_algo::ICP::ICPTransform<C>::Memory::D_IN_M);
-        transform.write (cl_algo::ICP::ICPTransform<C>::Memory::D_IN_T);
+        transform.write (cl_algo::ICP::ICPTransform<C, L>::Memory::D_IN_M);
+        transform.write (cl_algo::ICP::ICPTransform<C, L>::Memory::D_IN_T);
         
-        transform.run ();  // Execute kernels (18 us)
+        transform.run ();  // Execute kernels
         
         cl_float *results = (cl_float *) transform.read ();  // Copy results to host
         // ICP::printBufferF ("Received:", results, d, m, 3);
 
         // Produce reference transformed set
         cl_float *refTM = new cl_float[m * d];
-        ICP::cpuICPTransformM (transform.hPtrInM, refTM, transform.hPtrInT, m);
+        ICP::cpuICPTransformQSoA (transform.hPtrInM, refTM, transform.hPtrInT, m);
         // ICP::printBufferF ("Expected:", refTM, d, m, 3);
 
         // Verify transformed set
-        float eps = 42000 * std::numeric_limits<float>::epsilon ();  // 0.00500679
+        float eps = 4200 * std::numeric_limits<float>::epsilon ();  // 0.000500679
         for (uint i = 0; i < m; ++i)
             for (uint k = 0; k < d; ++k)
                 ASSERT_LT (std::abs (refTM[i * d + k] - results[i * d + k]), eps);
@@ -956,7 +1541,7 @@ TEST (ICP, icpTransform_Matrix)
             for (int i = 0; i < nRepeat; ++i)
             {
                 cTimer.start ();
-                ICP::cpuICPTransformM (transform.hPtrInM, refTM, transform.hPtrInT, m);
+                ICP::cpuICPTransformQSoA (transform.hPtrInM, refTM, transform.hPtrInT, m);
                 pCPU[i] = cTimer.stop ();
             }
             
@@ -967,7 +1552,7 @@ TEST (ICP, icpTransform_Matrix)
                 pGPU[i] = transform.run (gTimer);
 
             // Benchmark
-            pGPU.print (pCPU, "ICPTransform<MATRIX>");
+            pGPU.print (pCPU, "ICPTransform<QUATERNION, SOA>");
         }
 
     }
@@ -981,17 +1566,16 @@ TEST (ICP, icpTransform_Matrix)
 }
 
 
-/*! \brief Tests the **icpPowerMethod** kernel.
- *  \details The kernel uses the Power Method to estimate the 
- *           incremental development in the transformation estimation.
+/*! \brief Tests the **icpSplit_SoA** and **icpMerge_SoA** kernels.
+ *  \details The kernels split a set of 8-D points into a geometry and a 
+ *           color stream, and merge the streams back into 8-D points.
  */
-TEST (ICP, icpPowerMethod)
+TEST (ICP, icpSplit_SoA)
 {
     try
     {
-        // const unsigned int bufferInSSize = 11 * sizeof (cl_float);
-        // const unsigned int bufferOutMeanSize = 2 * sizeof (cl_float4);
-        // const unsigned int bufferOutTkSize = 2 * sizeof (cl_float4);
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int d = 8;
 
         // Setup the OpenCL environment
         clutils::CLEnv clEnv;
@@ -1001,36 +1585,348 @@ TEST (ICP, icpPowerMethod)
 
         // Configure kernel execution parameters
         clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
-        cl_algo::ICP::ICPPowerMethod pm (clEnv, info);
-        pm.init ();
+        cl_algo::ICP::ICPSplit split (clEnv, info);
+        split.init (m);
+
+        cl_algo::ICP::ICPMerge merge (clEnv, info);
+        merge.get (cl_algo::ICP::ICPMerge::Memory::D_IN_G) = 
+            split.get (cl_algo::ICP::ICPSplit::Memory::D_OUT_G);
+        merge.get (cl_algo::ICP::ICPMerge::Memory::D_IN_C) = 
+            split.get (cl_algo::ICP::ICPSplit::Memory::D_OUT_C);
+        merge.init (m, cl_algo::ICP::ICPColor::UCHAR, cl_algo::ICP::Staging::O);
 
         // Initialize data (writes on staging buffer directly)
-        cl_float S[11] = 
-        {
-              0.00168053,   0.000131408, -0.000775179, 
-              0.000156595,  0.00102674,  -0.000563479, 
-             -0.000722137, -0.000559463,  0.00246661, 
-              0.00521271,   0.00515292
-        };
-        cl_float means[8] = 
+        for (uint i = 0; i < m; ++i)
         {
-            -33.9694f, -17.6421f, 1494.22f, 0.f, 
-            -44.8322f, -19.3835f, 1485.93f, 0.f 
-        };
-        // ICP::printBufferF ("Original S:", S, 3, 4, 9);
-        // ICP::printBufferF ("Original Mean:", means, 4, 2, 4);
+            for (uint k = 0; k < 4; ++k)
+            {
+                split.hPtrIn[i * d + k] = ICP::rNum_0_255 ();
+                split.hPtrIn[i * d + 4 + k] = ICP::rNum_0_255 () / 255.f;
+            }
+        }
+        // ICP::printBufferF ("Original:", split.hPtrIn, d, m, 3);
 
         // Copy data to device
-        pm.write (cl_algo::ICP::ICPPowerMethod::Memory::D_IN_S, S);
-        pm.write (cl_algo::ICP::ICPPowerMethod::Memory::D_IN_MEAN, means);
+        split.write (cl_algo::ICP::ICPSplit::Memory::D_IN);
         
-        pm.run ();  // Execute kernel (27 us for 56 iterations)
+        split.run ();  // Execute kernels
+        merge.run ();
         
-        cl_float *results = (cl_float *) pm.read ();  // Copy results to host
-        // ICP::printBufferF ("Received Tk:", results, 4, 2, 7);
+        // Copy results to host
+        cl_float *resultsG = (cl_float *) split.read (cl_algo::ICP::ICPSplit::Memory::H_OUT_G, CL_FALSE);
+        cl_uchar *resultsC = (cl_uchar *) split.read (cl_algo::ICP::ICPSplit::Memory::H_OUT_C);
+        cl_float *results = (cl_float *) merge.read ();
 
-        // Produce reference transformed set
-        cl_float refTk[8];
+        // Produce reference streams
+        cl_float *refG = new cl_float[m * 4];
+        cl_uchar *refC = new cl_uchar[m * 4];
+        ICP::cpuICPSplit (split.hPtrIn, refG, refC, m);
+
+        // Verify streams
+        for (uint i = 0; i < m * 4; ++i)
+        {
+            ASSERT_EQ (refG[i], resultsG[i]);
+            ASSERT_EQ (refC[i], resultsC[i]);
+        }
+
+        // Verify merged set (8-bit colors survive the round trip)
+        float eps = 4200 * std::numeric_limits<float>::epsilon ();  // 0.000500679
+        for (uint i = 0; i < m * d; ++i)
+            ASSERT_LT (std::abs (split.hPtrIn[i] - results[i]), eps);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPSplit (split.hPtrIn, refG, refC, m);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = split.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPSplit");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Accuracy regression test for the packed color streams.
+ *  \details Two sets of 8-D points, with colors off the 8-bit grid, go through 
+ *           an `ICPSplit` - `ICPMerge` round trip for each `ICPColor` format. 
+ *           The nearest neighbors under the photogeometric distance are then 
+ *           computed on the packed and the original sets, and the error 
+ *           introduced by the packing is verified to stay within bounds.
+ */
+TEST (ICP, photogeometricAccuracy_Packed)
+{
+    try
+    {
+        const unsigned int m = 1 << 11;  // 2048
+        const unsigned int d = 8;
+        const float a = 1.f;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Initialize data
+        // The fixed set is followed by the moving set, which is a perturbed copy of the former
+        std::vector<cl_float> sets (2 * m * d);
+        for (uint i = 0; i < m; ++i)
+        {
+            for (uint k = 0; k < 3; ++k)
+            {
+                sets[i * d + k] = ICP::rNum_R_0_1 ();
+                sets[i * d + 4 + k] = ICP::rNum_R_0_1 ();
+            }
+            sets[i * d + 3] = sets[i * d + 7] = 1.f;
+
+            for (uint k = 0; k < d; ++k)
+            {
+                float noise = (k == 3 || k == 7) ? 0.f : 0.01f * (ICP::rNum_R_0_1 () - 0.5f);
+                sets[(m + i) * d + k] = std::min (std::max (sets[i * d + k] + noise, 0.f), 1.f);
+            }
+        }
+        cl_float *F = sets.data (), *M = sets.data () + m * d;
+
+        // Produce reference nearest neighbors
+        std::vector<uint32_t> refNN (m);
+        ICP::cpuNNPhotogeometric (M, F, refNN.data (), m, m, a);
+
+        // Maximum error per color channel, and the resulting bound on the error of a distance
+        const std::vector<cl_algo::ICP::ICPColor> formats = 
+            { cl_algo::ICP::ICPColor::UCHAR, cl_algo::ICP::ICPColor::HALF };
+        const std::vector<float> channelError = { 0.5f / 255.f, std::ldexp (1.f, -12) };
+
+        for (uint f = 0; f < formats.size (); ++f)
+        {
+            // Configure kernel execution parameters
+            clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+            cl_algo::ICP::ICPSplit split (clEnv, info);
+            split.init (2 * m, formats[f], cl_algo::ICP::Staging::I);
+
+            cl_algo::ICP::ICPMerge merge (clEnv, info);
+            merge.get (cl_algo::ICP::ICPMerge::Memory::D_IN_G) = 
+                split.get (cl_algo::ICP::ICPSplit::Memory::D_OUT_G);
+            merge.get (cl_algo::ICP::ICPMerge::Memory::D_IN_C) = 
+                split.get (cl_algo::ICP::ICPSplit::Memory::D_OUT_C);
+            merge.init (2 * m, formats[f], cl_algo::ICP::Staging::O);
+
+            split.write (cl_algo::ICP::ICPSplit::Memory::D_IN, sets.data ());
+            split.run ();
+            merge.run ();
+
+            cl_float *packed = (cl_float *) merge.read ();  // Copy results to host
+            cl_float *pF = packed, *pM = packed + m * d;
+
+            // Find nearest neighbors on the packed sets
+            std::vector<uint32_t> NN (m);
+            ICP::cpuNNPhotogeometric (pM, pF, NN.data (), m, m, a);
+
+            // Distances between two packed points are off by at most delta
+            float e = 2.f * std::sqrt (3.f) * channelError[f];
+            float delta = a * (2.f * std::sqrt (3.f) * e + e * e);
+
+            // Verify nearest neighbors
+            unsigned int mismatches = 0;
+            for (uint i = 0; i < m; ++i)
+            {
+                if (NN[i] == refNN[i]) continue;
+                ++mismatches;
+
+                float excess = ICP::cpuDistPhotogeometric (M + i * d, F + NN[i] * d, a) - 
+                               ICP::cpuDistPhotogeometric (M + i * d, F + refNN[i] * d, a);
+                ASSERT_LE (excess, 2.f * delta);
+            }
+            ASSERT_LT (mismatches, m / 100);
+
+            // Verify the packed colors
+            for (uint i = 0; i < 2 * m; ++i)
+                for (uint k = 4; k < 7; ++k)
+                    ASSERT_LE (std::abs (sets[i * d + k] - packed[i * d + k]), 
+                               channelError[f] + std::numeric_limits<float>::epsilon ());
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **icpTransform_Matrix** kernel.
+ *  \details The kernel transforms a set of points using a transformation matrix.
+ */
+TEST (ICP, icpTransform_Matrix)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int d = 8;
+        // const unsigned int bufferInSize = m * sizeof (cl_float8);
+        // const unsigned int bufferOutSize = m * sizeof (cl_float8);
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const cl_algo::ICP::ICPTransformConfig C = cl_algo::ICP::ICPTransformConfig::MATRIX;
+        cl_algo::ICP::ICPTransform<C> transform (clEnv, info);
+        transform.init (m);
+
+        // Initialize data (writes on staging buffer directly)
+        // Randomized set of points
+        std::generate (transform.hPtrInM, transform.hPtrInM + m * d, ICP::rNum_0_255);
+        // Some random scaling factor
+        float s = ICP::rNum_R_0_1 ();
+        // Some random rotation matrix (axis = (1/sqrt(3), 1/sqrt(3), 1/sqrt(3)), angle = 36.21deg)
+        transform.hPtrInT[0] = s *  0.871238; transform.hPtrInT[1] = s * -0.276687;
+        transform.hPtrInT[2] = s *  0.405449; transform.hPtrInT[3] = ICP::rNum_0_255 ();
+        transform.hPtrInT[4] = s *  0.405449; transform.hPtrInT[5] = s *  0.871238;
+        transform.hPtrInT[6] = s * -0.276687; transform.hPtrInT[7] = ICP::rNum_0_255 ();
+        transform.hPtrInT[8] = s * -0.276687; transform.hPtrInT[9] = s *  0.405449;
+        transform.hPtrInT[10] = s * 0.871238; transform.hPtrInT[11] = ICP::rNum_0_255 ();
+        transform.hPtrInT[12] = 0.f; transform.hPtrInT[13] = 0.f;
+        transform.hPtrInT[14] = 0.f; transform.hPtrInT[15] = 1.f;
+        // ICP::printBufferF ("Original M:", transform.hPtrInM, d, m, 3);
+        // ICP::printBufferF ("Original T:", transform.hPtrInT, 4, 4, 3);
+
+        // Copy data to device
+        transform.write (cl_algo::ICP::ICPTransform<C>::Memory::D_IN_M);
+        transform.write (cl_algo::ICP::ICPTransform<C>::Memory::D_IN_T);
+        
+        transform.run ();  // Execute kernels (18 us)
+        
+        cl_float *results = (cl_float *) transform.read ();  // Copy results to host
+        // ICP::printBufferF ("Received:", results, d, m, 3);
+
+        // Produce reference transformed set
+        cl_float *refTM = new cl_float[m * d];
+        ICP::cpuICPTransformM (transform.hPtrInM, refTM, transform.hPtrInT, m);
+        // ICP::printBufferF ("Expected:", refTM, d, m, 3);
+
+        // Verify transformed set
+        float eps = 42000 * std::numeric_limits<float>::epsilon ();  // 0.00500679
+        for (uint i = 0; i < m; ++i)
+            for (uint k = 0; k < d; ++k)
+                ASSERT_LT (std::abs (refTM[i * d + k] - results[i * d + k]), eps);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPTransformM (transform.hPtrInM, refTM, transform.hPtrInT, m);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = transform.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPTransform<MATRIX>");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **icpPowerMethod** kernel.
+ *  \details The kernel uses the Power Method to estimate the 
+ *           incremental development in the transformation estimation.
+ */
+TEST (ICP, icpPowerMethod)
+{
+    try
+    {
+        // const unsigned int bufferInSSize = 11 * sizeof (cl_float);
+        // const unsigned int bufferOutMeanSize = 2 * sizeof (cl_float4);
+        // const unsigned int bufferOutTkSize = 2 * sizeof (cl_float4);
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPPowerMethod pm (clEnv, info);
+        pm.init ();
+
+        // Initialize data (writes on staging buffer directly)
+        cl_float S[11] = 
+        {
+              0.00168053,   0.000131408, -0.000775179, 
+              0.000156595,  0.00102674,  -0.000563479, 
+             -0.000722137, -0.000559463,  0.00246661, 
+              0.00521271,   0.00515292
+        };
+        cl_float means[8] = 
+        {
+            -33.9694f, -17.6421f, 1494.22f, 0.f, 
+            -44.8322f, -19.3835f, 1485.93f, 0.f 
+        };
+        // ICP::printBufferF ("Original S:", S, 3, 4, 9);
+        // ICP::printBufferF ("Original Mean:", means, 4, 2, 4);
+
+        // Copy data to device
+        pm.write (cl_algo::ICP::ICPPowerMethod::Memory::D_IN_S, S);
+        pm.write (cl_algo::ICP::ICPPowerMethod::Memory::D_IN_MEAN, means);
+        
+        pm.run ();  // Execute kernel (27 us for 56 iterations)
+        
+        cl_float *results = (cl_float *) pm.read ();  // Copy results to host
+        // ICP::printBufferF ("Received Tk:", results, 4, 2, 7);
+
+        // Produce reference transformed set
+        cl_float refTk[8];
         ICP::cpuICPPowerMethod (pm.hPtrInS, pm.hPtrInMean, refTk);
         // ICP::printBufferF ("Expected Tk:", refTk, 4, 2, 7);
 
@@ -1051,6 +1947,50 @@ TEST (ICP, icpPowerMethod)
         for (uint k = 0; k < 8; ++k)
             ASSERT_LT (std::abs (svdTk[k] - results[k]), eps);
 
+        typedef cl_algo::ICP::ICPPowerMethod::Memory PM;
+
+        // Verify the number of iterations
+        cl_uint coldIter = *((cl_uint *) pm.read (PM::H_OUT_ITER));
+        ASSERT_GT (coldIter, 0U);
+        ASSERT_LE (coldIter, pm.getMaxIterations ());
+
+        // Warm start from the previous solution
+        pm.setWarmStart (true);
+        pm.run ();
+        results = (cl_float *) pm.read ();
+        cl_uint warmIter = *((cl_uint *) pm.read (PM::H_OUT_ITER));
+        ASSERT_LE (warmIter, coldIter);
+        for (uint k = 0; k < 8; ++k)
+            ASSERT_LT (std::abs (svdTk[k] - results[k]), eps);
+
+        // Bound the number of iterations
+        unsigned int budget = pm.getMaxIterations ();
+        ASSERT_EQ (2000U, budget);
+        pm.setWarmStart (false);
+        pm.setMaxIterations (4);
+        pm.run ();
+        ASSERT_LE (*((cl_uint *) pm.read (PM::H_OUT_ITER)), 4U);
+        pm.setMaxIterations (budget);
+
+        // Negative dominant eigenvalue, N = diag (-3, 1, 1, 1)
+        cl_float Sn[11] = { -1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+        cl_float meansn[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+        pm.write (PM::D_IN_S, Sn);
+        pm.write (PM::D_IN_MEAN, meansn);
+
+        // No iterations left for the shift, so the rotation falls back to the identity
+        pm.setMaxIterations (1);
+        pm.run ();
+        results = (cl_float *) pm.read ();
+        ASSERT_EQ (0.f, results[0]); ASSERT_EQ (0.f, results[1]);
+        ASSERT_EQ (0.f, results[2]); ASSERT_EQ (1.f, results[3]);
+
+        // With the shift, the eigenvector of the negative eigenvalue is avoided
+        pm.setMaxIterations (budget);
+        pm.run ();
+        results = (cl_float *) pm.read ();
+        ASSERT_LT (std::abs (results[0]), eps);
+
         // Profiling ===========================================================
         if (profiling)
         {
@@ -1087,6 +2027,2109 @@ TEST (ICP, icpPowerMethod)
 }
 
 
+/*! \brief Tests the **icpSVD** kernel.
+ *  \details The kernel solves the orthogonal Procrustes problem on the device 
+ *           to estimate the incremental development in the transformation estimation.
+ */
+TEST (ICP, icpSVD)
+{
+    try
+    {
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPSVD svd (clEnv, info);
+        svd.init ();
+
+        // Initialize data (writes on staging buffer directly)
+        cl_float S[11] = 
+        {
+              0.00168053,   0.000131408, -0.000775179, 
+              0.000156595,  0.00102674,  -0.000563479, 
+             -0.000722137, -0.000559463,  0.00246661, 
+              0.00521271,   0.00515292
+        };
+        cl_float means[8] = 
+        {
+            -33.9694f, -17.6421f, 1494.22f, 0.f, 
+            -44.8322f, -19.3835f, 1485.93f, 0.f 
+        };
+        // ICP::printBufferF ("Original S:", S, 3, 4, 9);
+        // ICP::printBufferF ("Original Mean:", means, 4, 2, 4);
+
+        // Copy data to device
+        svd.write (cl_algo::ICP::ICPSVD::Memory::D_IN_S, S);
+        svd.write (cl_algo::ICP::ICPSVD::Memory::D_IN_MEAN, means);
+        
+        svd.run ();  // Execute kernel
+        
+        cl_float *results = (cl_float *) svd.read ();  // Copy results to host
+        // ICP::printBufferF ("Received Tk:", results, 4, 2, 7);
+
+        cl_float svdTk[8] = 
+        {
+            0.00111412f, 0.00730956f, -0.00647493f, 0.999952f, 
+              -10.4598f,    4.74009f,   -0.762817f,  1.00578f
+        };
+        // ICP::printBufferF ("SVD Tk:", svdTk, 4, 2, 7);
+
+        // Verify transformation against the Eigen::JacobiSVD solution
+        float eps = 42000 * std::numeric_limits<float>::epsilon ();  // 0.00500679
+        for (uint k = 0; k < 8; ++k)
+            ASSERT_LT (std::abs (svdTk[k] - results[k]), eps);
+
+        // Verify transformation against the Power Method solution
+        cl_float refTk[8];
+        ICP::cpuICPPowerMethod (svd.hPtrInS, svd.hPtrInMean, refTk);
+        // ICP::printBufferF ("Expected Tk:", refTk, 4, 2, 7);
+        for (uint k = 0; k < 8; ++k)
+            ASSERT_LT (std::abs (refTk[k] - results[k]), eps);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPPowerMethod (svd.hPtrInS, svd.hPtrInMean, refTk);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = svd.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPSVD");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **icpUpdateTransform** kernel.
+ *  \details The kernel composes the incremental transformation with 
+ *           the current estimation, and checks for convergence.
+ */
+TEST (ICP, icpUpdateTransform)
+{
+    try
+    {
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const float angle_threshold = 0.001f, translation_threshold = 0.01f;
+        cl_algo::ICP::ICPUpdateTransform ut (clEnv, info);
+        ut.init (angle_threshold, translation_threshold);
+
+        // Initialize data (writes on staging buffer directly)
+        cl_float Tk[8] = 
+        {
+            0.00111412f, 0.00730956f, -0.00647493f, 0.999952f, 
+              -10.4598f,    4.74009f,   -0.762817f,  1.00578f
+        };
+        cl_float T[8] = 
+        {
+            0.0174524f,       0.f,         0.f, 0.9998477f, 
+                25.3f,    -12.7f,        4.1f,        1.f
+        };
+        cl_uint C[2] = { 0, 0 };
+
+        // Copy data to device
+        ut.write (cl_algo::ICP::ICPUpdateTransform::Memory::D_IN_T_K, Tk);
+        ut.write (cl_algo::ICP::ICPUpdateTransform::Memory::D_IO_T, T);
+        ut.write (cl_algo::ICP::ICPUpdateTransform::Memory::D_IO_C, C);
+
+        ut.run ();  // Execute kernel
+
+        // Copy results to host
+        cl_float *results = (cl_float *) ut.read (cl_algo::ICP::ICPUpdateTransform::Memory::H_IO_T);
+        cl_uint *conv = (cl_uint *) ut.read (cl_algo::ICP::ICPUpdateTransform::Memory::H_IO_C);
+
+        // Produce reference transformation
+        cl_float refT[8]; std::copy (T, T + 8, refT);
+        cl_uint refC[2] = { 0, 0 };
+        ICP::cpuICPUpdateTransform (Tk, refT, refC, angle_threshold, translation_threshold);
+
+        // Verify transformation against reference implementation
+        float eps = 42000 * std::numeric_limits<float>::epsilon ();  // 0.00500679
+        for (uint k = 0; k < 8; ++k)
+            ASSERT_LT (std::abs (refT[k] - results[k]), eps);
+        ASSERT_EQ (refC[0], conv[0]);
+        ASSERT_EQ (refC[1], conv[1]);
+        ASSERT_EQ (0U, conv[0]);
+
+        // Verify convergence on a negligible increment
+        cl_float Tk0[8] = { 0.f, 0.f, 0.f, 1.f, 0.001f, 0.f, 0.f, 1.f };
+        ut.write (cl_algo::ICP::ICPUpdateTransform::Memory::D_IN_T_K, Tk0);
+        ut.run ();
+        ICP::cpuICPUpdateTransform (Tk0, refT, refC, angle_threshold, translation_threshold);
+
+        conv = (cl_uint *) ut.read (cl_algo::ICP::ICPUpdateTransform::Memory::H_IO_C);
+        ASSERT_EQ (1U, conv[0]);
+        ASSERT_EQ (2U, conv[1]);
+
+        // Verify that the transformation is left intact after convergence
+        ut.write (cl_algo::ICP::ICPUpdateTransform::Memory::D_IN_T_K, Tk);
+        ut.run ();
+
+        results = (cl_float *) ut.read (cl_algo::ICP::ICPUpdateTransform::Memory::H_IO_T);
+        conv = (cl_uint *) ut.read (cl_algo::ICP::ICPUpdateTransform::Memory::H_IO_C);
+        for (uint k = 0; k < 8; ++k)
+            ASSERT_LT (std::abs (refT[k] - results[k]), eps);
+        ASSERT_EQ (2U, conv[1]);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                refC[0] = refC[1] = 0;
+                cTimer.start ();
+                ICP::cpuICPUpdateTransform (Tk, refT, refC, angle_threshold, translation_threshold);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = ut.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPUpdateTransform");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the on-disk cache of program binaries.
+ *  \details The ICP kernels are built twice through `addProgramCached`. The 
+ *           second build comes from the binaries stored by the first one, and 
+ *           the resulting program is verified by running a kernel from it.
+ */
+TEST (ICP, addProgramCached)
+{
+    try
+    {
+        const std::string cacheDir { "kernels/cache_tests" };
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int d = 8;
+
+        // Populate the cache
+        {
+            clutils::CLEnv clEnv;
+            clEnv.addContext (0);
+            clEnv.addQueue (0, 0);
+            cl_algo::ICP::addProgramCached (clEnv, 0, { kernel_filename_icp }, nullptr, cacheDir);
+        }
+
+        // Setup the OpenCL environment from the cache
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0);
+        cl_algo::ICP::addProgramCached (clEnv, 0, { kernel_filename_icp }, nullptr, cacheDir);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const cl_algo::ICP::ICPTransformConfig C = cl_algo::ICP::ICPTransformConfig::QUATERNION;
+        cl_algo::ICP::ICPTransform<C> transform (clEnv, info);
+        transform.init (m);
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (transform.hPtrInM, transform.hPtrInM + m * d, ICP::rNum_0_255);
+        transform.hPtrInT[0] = 0.5144; transform.hPtrInT[1] = 0.5743;
+        transform.hPtrInT[2] = 0.5632; transform.hPtrInT[3] = 0.2973;
+        std::generate (transform.hPtrInT + 4, transform.hPtrInT + 7, ICP::rNum_0_255);
+        transform.hPtrInT[7] = 1.f;
+
+        // Copy data to device
+        transform.write (cl_algo::ICP::ICPTransform<C>::Memory::D_IN_M);
+        transform.write (cl_algo::ICP::ICPTransform<C>::Memory::D_IN_T);
+        
+        transform.run ();  // Execute kernels
+        
+        cl_float *results = (cl_float *) transform.read ();  // Copy results to host
+
+        // Produce reference transformed set
+        cl_float *refTM = new cl_float[m * d];
+        ICP::cpuICPTransformQ (transform.hPtrInM, refTM, transform.hPtrInT, m);
+
+        // Verify transformed set
+        float eps = 4200 * std::numeric_limits<float>::epsilon ();  // 0.000500679
+        for (uint i = 0; i < m; ++i)
+            for (uint k = 0; k < d; ++k)
+                ASSERT_LT (std::abs (refTM[i * d + k] - results[i * d + k]), eps);
+
+        delete[] refTM;
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the program indices that `addProgramCached` assigns on a cache hit.
+ *  \details The cached programs are swapped into the slots that a placeholder 
+ *           program reserves. The indices have to follow the order of the calls, 
+ *           among the programs added with `addProgram`, and the slots have to hold 
+ *           the cached programs, with none of the placeholder left in them.
+ */
+TEST (ICP, addProgramCached_Slots)
+{
+    try
+    {
+        const std::string cacheDir { "kernels/cache_tests" };
+
+        // Populate the cache
+        {
+            clutils::CLEnv clEnv;
+            clEnv.addContext (0);
+            clEnv.addQueue (0, 0);
+            cl_algo::ICP::addProgramCached (clEnv, 0, { kernel_filename_reduce }, nullptr, cacheDir);
+            cl_algo::ICP::addProgramCached (clEnv, 0, { kernel_filename_icp }, nullptr, cacheDir);
+        }
+
+        // Mix cached and uncached programs
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0);
+        cl::Program &p0 = clEnv.addProgram (0, { kernel_filename_scan });
+        cl::Program &p1 = cl_algo::ICP::addProgramCached (clEnv, 0, { kernel_filename_reduce }, nullptr, cacheDir);
+        cl::Program &p2 = cl_algo::ICP::addProgramCached (clEnv, 0, { kernel_filename_icp }, nullptr, cacheDir);
+
+        // The hits went through the placeholder
+        ASSERT_TRUE (std::ifstream (cacheDir + "/placeholder.cl").good ());
+
+        // The indices follow the order of the calls
+        ASSERT_EQ (p0 (), clEnv.getProgram (0) ());
+        ASSERT_EQ (p1 (), clEnv.getProgram (1) ());
+        ASSERT_EQ (p2 (), clEnv.getProgram (2) ());
+
+        // The slots hold the cached programs
+        cl::Kernel reduce (clEnv.getProgram (1), "reduce_sum_f");
+        cl::Kernel transform (clEnv.getProgram (2), "icpTransform_Quaternion");
+        ASSERT_THROW (cl::Kernel (clEnv.getProgram (1), "placeholder"), cl::Error);
+        ASSERT_THROW (cl::Kernel (clEnv.getProgram (2), "placeholder"), cl::Error);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+/*! \brief Tests the compile-time specialization of the ICP kernels.
+ *  \details The same pair of landmark sets is registered with a generic program 
+ *           and with a program built by `addProgramSpecialized`. The estimated 
+ *           transformations have to agree.
+ */
+TEST (ICP, addProgramSpecialized)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+        const float c = 1e-6f;
+
+        ASSERT_EQ (std::string ("-D ICP_M=16384 -D ICP_C=1.000000000e-06f -D ICP_WG=64"), 
+                   cl_algo::ICP::specializationOptions (m, c, 64));
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+        cl_algo::ICP::addProgramSpecialized (clEnv, 0, 
+            { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp }, m, c, 0, nullptr, "");
+
+        unsigned int sm; float sc;
+        cl_algo::ICP::getSpecialization (clEnv.getProgram (2), clEnv.devices[0][0], sm, sc);
+        ASSERT_EQ (m, sm);
+        ASSERT_EQ (c, sc);
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::POWER_METHOD, 
+                                  cl_algo::ICP::ICPStepConfigW::WEIGHTED> ICPT;
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+        clutils::CLEnvInfo<1> infoICPS (0, 0, 0, { 0 }, 2);
+        ICPT reg (clEnv, infoRBC, infoICP), regS (clEnv, infoRBC, infoICPS);
+        reg.init (m, nr, 1e2f, c, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        regS.init (m, nr, 1e2f, c, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        for (ICPT *r : { &reg, &regS })
+        {
+            r->write (ICPT::Memory::D_IN_F, fixed.data ());
+            r->write (ICPT::Memory::D_IN_M, moving.data ());
+            r->buildRBC ();
+            r->run ();
+        }
+
+        // Verify transformation
+        float eps = 1e-3f;
+        for (uint k = 0; k < 4; ++k)
+            ASSERT_LT (std::abs (reg.q.coeffs ()[k] - regS.q.coeffs ()[k]), eps);
+        for (uint k = 0; k < 3; ++k)
+            ASSERT_LT (std::abs (reg.t[k] - regS.t[k]), 10 * eps);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the auto-tuning of the kernel launch configurations.
+ *  \details The kernels are tuned into an empty directory, and the stored 
+ *           configurations are read back. Then, an `ICPS<ICPSConfig::WEIGHTED>` 
+ *           instance, which picks up its tuned configuration, is verified.
+ */
+TEST (ICP, tuneWorkGroups)
+{
+    try
+    {
+        const std::vector<std::string> kernel_files = { kernel_filename_reduce, 
+                                                        kernel_filename_scan, 
+                                                        kernel_filename_icp };
+
+        const std::string tuneDir { "kernels/tuning_tests" };
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int d = 4;
+        const float c = 1e-6f;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_files);
+
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl::Device &device = clEnv.devices[0][0];
+
+        // Tune, and verify that a stored tuning is reused
+        cl_algo::ICP::setTuningDir (tuneDir);
+        ASSERT_TRUE (cl_algo::ICP::tuneWorkGroups (clEnv, info, m, true, 2));
+        ASSERT_FALSE (cl_algo::ICP::tuneWorkGroups (clEnv, info, m));
+
+        cl_algo::ICP::WorkGroupConfig mean, sij;
+        ASSERT_TRUE (cl_algo::ICP::getTunedConfig ("icpMean", device, mean));
+        ASSERT_TRUE (cl_algo::ICP::getTunedConfig ("icpSijProducts_Weighted", device, sij));
+        ASSERT_NE (0u, sij.ept);
+
+        // Read the configurations back from the directory
+        cl_algo::ICP::setTuningDir (tuneDir);
+        cl_algo::ICP::WorkGroupConfig config;
+        ASSERT_TRUE (cl_algo::ICP::getTunedConfig ("icpMean", device, config));
+        ASSERT_EQ (mean.local, config.local);
+        ASSERT_TRUE (cl_algo::ICP::getTunedConfig ("icpSijProducts_Weighted", device, config));
+        ASSERT_EQ (sij.local, config.local);
+        ASSERT_EQ (sij.ept, config.ept);
+
+        cl::Kernel meanKernel (clEnv.getProgram (info.pgIdx), "icpMean");
+        ASSERT_EQ (mean.local, cl_algo::ICP::getWorkGroupMultiple (meanKernel, device));
+
+        // Configure kernel execution parameters
+        const cl_algo::ICP::ICPSConfig C = cl_algo::ICP::ICPSConfig::WEIGHTED;
+        cl_algo::ICP::ICPS<C> s (clEnv, info);
+        s.init (m, c);
+
+        // Initialize data (writes on staging buffer directly)
+        std::function<float ()> rNum_R__1000_1000 = std::bind (
+            std::uniform_real_distribution<float> (-1000.f, 1000.f), 
+            std::default_random_engine (std::chrono::system_clock::now ().time_since_epoch ().count ()));
+        std::generate (s.hPtrInDevM, s.hPtrInDevM + m * d, rNum_R__1000_1000);
+        std::generate (s.hPtrInDevF, s.hPtrInDevF + m * d, rNum_R__1000_1000);
+        std::generate (s.hPtrInW, s.hPtrInW + m, ICP::rNum_R_0_1);
+
+        // Copy data to device
+        s.write (cl_algo::ICP::ICPS<C>::Memory::D_IN_DEV_M);
+        s.write (cl_algo::ICP::ICPS<C>::Memory::D_IN_DEV_F);
+        s.write (cl_algo::ICP::ICPS<C>::Memory::D_IN_W);
+        
+        s.run ();  // Execute kernels
+        
+        cl_float *results = (cl_float *) s.read ();  // Copy results to host
+
+        // Produce reference S matrix
+        cl_float refS[11];
+        ICP::cpuICPSw (s.hPtrInDevM, s.hPtrInDevF, s.hPtrInW, refS, m, c);
+
+        // Verify S matrix
+        float eps = 4200 * std::numeric_limits<float>::epsilon ();  // 0.000500679
+        for (uint i = 0; i < 11; ++i)
+            ASSERT_LT (std::abs (refS[i] - results[i]), eps);
+
+        cl_algo::ICP::setTuningDir ("kernels/tuning");
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `PCFileWriter` and `PCFile` classes.
+ *  \details Writes a sequence of point clouds, maps it back, 
+ *           and uploads a frame through a `CL_MEM_USE_HOST_PTR` buffer.
+ */
+TEST (ICP, pcFile)
+{
+    try
+    {
+        const std::string path { "pc_file_tests.bin" };
+        const unsigned int width = 64, height = 48, n = width * height;
+        const unsigned int d = 8;
+        const unsigned int frames = 3;
+
+        // Write the sequence
+        std::vector<std::vector<cl_float>> pcs (frames, std::vector<cl_float> (n * d));
+        {
+            cl_algo::ICP::PCFileWriter writer (path, width, height, 580.f, 585.f);
+            for (unsigned int i = 0; i < frames; ++i)
+            {
+                std::generate (pcs[i].begin (), pcs[i].end (), ICP::rNum_0_10000);
+                writer.append ((cl_float8 *) pcs[i].data (), 1000 * i + 7);
+            }
+        }
+
+        // Map the sequence
+        cl_algo::ICP::PCFile file (path);
+        const cl_algo::ICP::PCFileHeader &header = file.getHeader ();
+
+        ASSERT_EQ (cl_algo::ICP::pcFileVersion, header.version);
+        ASSERT_EQ (width, header.width);
+        ASSERT_EQ (height, header.height);
+        ASSERT_EQ (580.f, header.fx);
+        ASSERT_EQ (585.f, header.fy);
+        ASSERT_EQ (frames, file.frames ());
+
+        // Verify the frames
+        for (unsigned int i = 0; i < frames; ++i)
+        {
+            ASSERT_EQ (1000 * i + 7, file.timestamp (i));
+            ASSERT_EQ (0U, (uintptr_t) file.frame (i) % cl_algo::ICP::pcFileAlignment);
+
+            cl_float *ptr = (cl_float *) file.frame (i);
+            for (unsigned int j = 0; j < n * d; ++j)
+                ASSERT_EQ (pcs[i][j], ptr[j]);
+        }
+
+        // Upload a frame straight from the mapped pages
+        clutils::CLEnv clEnv;
+        cl::Context &context = clEnv.addContext (0);
+        cl::CommandQueue &queue = clEnv.addQueue (0, 0);
+
+        cl::Buffer dBuffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float8));
+        queue.enqueueCopyBuffer (file.buffer (context, 1), dBuffer, 0, 0, n * sizeof (cl_float8));
+
+        std::vector<cl_float> results (n * d);
+        queue.enqueueReadBuffer (dBuffer, CL_TRUE, 0, n * sizeof (cl_float8), results.data ());
+
+        for (unsigned int j = 0; j < n * d; ++j)
+            ASSERT_EQ (pcs[1][j], results[j]);
+
+        // Raw dumps are accepted too
+        cl_algo::ICP::PCFile raw ("../data/kg_pc8d_1.bin");
+        ASSERT_EQ (0U, raw.getHeader ().version);
+        ASSERT_EQ (640U, raw.getHeader ().width);
+        ASSERT_EQ (480U, raw.getHeader ().height);
+        ASSERT_EQ (1U, raw.frames ());
+
+        std::remove (path.c_str ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+    catch (const char *error)
+    {
+        std::cerr << "Error[PCFile]: " << error << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **icpBackProject** kernel, and the `RGBD` layout of `PCFile`.
+ *  \details Writes a sequence of run-length encoded depth and RGB frames, 
+ *           maps it back, and back-projects a frame on the device.
+ */
+TEST (ICP, icpBackProject)
+{
+    try
+    {
+        const std::string path { "pc_file_rgbd_tests.bin" };
+        const unsigned int width = 640, height = 480, n = width * height;
+        const unsigned int d = 8;
+        const unsigned int frames = 2;
+        const float fx = 580.f, fy = 585.f;
+
+        // Depth frames with invalid regions and flat surfaces, 
+        // as well as noisy areas, to exercise both kinds of tokens
+        std::vector<std::vector<cl_ushort>> depth (frames, std::vector<cl_ushort> (n));
+        std::vector<std::vector<cl_uchar>> rgb (frames, std::vector<cl_uchar> (3 * n));
+        for (unsigned int i = 0; i < frames; ++i)
+        {
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                unsigned int x = j % width, y = j / width;
+                if (x < 40 || y < 20) depth[i][j] = 0;
+                else if (y < height / 2) depth[i][j] = 1000 + 100 * i + x / 64;
+                else depth[i][j] = ICP::rNum_0_10000 ();
+            }
+            std::generate (rgb[i].begin (), rgb[i].end (), ICP::rNum_0_255);
+        }
+
+        // Write the sequence
+        {
+            cl_algo::ICP::PCFileWriter writer (path, width, height, fx, fy, 
+                cl_algo::ICP::PCFileLayout::RGBD, cl_algo::ICP::PCFileCompression::RLE);
+            for (unsigned int i = 0; i < frames; ++i)
+                writer.append (depth[i].data (), rgb[i].data (), 1000 * i + 7);
+        }
+
+        // Map the sequence
+        cl_algo::ICP::PCFile file (path);
+        const cl_algo::ICP::PCFileHeader &header = file.getHeader ();
+
+        ASSERT_EQ (cl_algo::ICP::PCFileLayout::RGBD, header.layout);
+        ASSERT_EQ (cl_algo::ICP::PCFileCompression::RLE, header.compression);
+        ASSERT_EQ (frames, file.frames ());
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPBackProject bp (clEnv, info);
+        bp.init (width, height, fx, fy);
+
+        for (unsigned int i = 0; i < frames; ++i)
+        {
+            ASSERT_EQ (1000 * i + 7, file.timestamp (i));
+
+            // Decode the frames (writes on staging buffers directly)
+            file.readRGBD (i, bp.hPtrInD, bp.hPtrInRGB);
+            for (unsigned int j = 0; j < n; ++j)
+                ASSERT_EQ (depth[i][j], bp.hPtrInD[j]);
+            for (unsigned int j = 0; j < 3 * n; ++j)
+                ASSERT_EQ (rgb[i][j], bp.hPtrInRGB[j]);
+
+            bp.setIntrinsics (header.fx, header.fy, header.cx, header.cy);
+
+            bp.write (cl_algo::ICP::ICPBackProject::Memory::D_IN_D);  // Copy data to device
+            bp.write (cl_algo::ICP::ICPBackProject::Memory::D_IN_RGB);
+            
+            bp.run ();  // Execute kernels
+            
+            cl_float *results = (cl_float *) bp.read ();  // Copy results to host
+
+            // Produce reference point cloud
+            std::vector<cl_float> refPC (n * d);
+            ICP::cpuICPBackProject (depth[i].data (), rgb[i].data (), refPC.data (), 
+                                    width, height, header.fx, header.fy, header.cx, header.cy);
+
+            // Verify point cloud
+            for (unsigned int j = 0; j < n * d; ++j)
+                ASSERT_LT (std::abs (refPC[j] - results[j]), 1e-3f * std::max (1.f, std::abs (refPC[j])));
+        }
+
+        // The compressed file is smaller than the equivalent FLOAT8 one
+        std::ifstream f (path, std::ios::binary | std::ios::ate);
+        ASSERT_LT ((uint64_t) f.tellg (), (uint64_t) frames * n * sizeof (cl_float8) / 4);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            std::vector<cl_float> refPC (n * d);
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPBackProject (bp.hPtrInD, bp.hPtrInRGB, refPC.data (), 
+                                        width, height, header.fx, header.fy, header.cx, header.cy);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = bp.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPBackProject");
+        }
+
+        std::remove (path.c_str ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+    catch (const char *error)
+    {
+        std::cerr << "Error[PCFile]: " << error << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `StagingPool` class.
+ *  \details Two `ICPLMs` instances get their staging buffers from the same pool. 
+ *           A repeated `init` reuses the blocks, and a resizing one replaces them. 
+ *           The blocks return to the pool, when their class is destroyed.
+ */
+TEST (ICP, stagingPool)
+{
+    try
+    {
+        const unsigned int n = 640 * 480;  // 307200
+        const unsigned int m = 1 << 14;    //  16384
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        cl::Context &context = clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        cl_algo::ICP::StagingPool pool (context, clEnv.devices[0][0]);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPLMs glm1 (clEnv, info, &pool);
+        cl_algo::ICP::ICPLMs glm2 (clEnv, info, &pool);
+        glm1.init ();
+        glm2.init ();
+
+        const size_t bytes = 2 * (n + m) * sizeof (cl_float8);
+        ASSERT_GE (pool.used (), bytes);
+        ASSERT_LE (pool.used (), pool.capacity ());
+        ASSERT_LT (pool.slabs (), 4U);
+
+        // A repeated init keeps the same blocks
+        size_t used = pool.used (), capacity = pool.capacity ();
+        glm1.init ();
+        ASSERT_EQ (used, pool.used ());
+        ASSERT_EQ (capacity, pool.capacity ());
+
+        // A resizing init replaces them
+        glm2.init (320, 240, 4096);
+        ASSERT_LT (pool.used (), used);
+        ASSERT_EQ (capacity, pool.capacity ());
+
+        // The sub-allocated staging buffers work as usual
+        std::generate (glm1.hPtrIn, glm1.hPtrIn + n * d, ICP::rNum_0_10000);
+
+        glm1.write ();  // Copy data to device
+        
+        glm1.run ();  // Execute kernels
+        
+        cl_float *results = (cl_float *) glm1.read ();  // Copy results to host
+
+        // Produce reference landmarks
+        std::vector<cl_float> refLM (m * d);
+        ICP::cpuICPLMs (glm1.hPtrIn, refLM.data ());
+
+        // Verify landmarks
+        for (uint j = 0; j < m; ++j)
+            for (uint k = 0; k < d; ++k)
+                ASSERT_EQ (refLM[j * d + k], results[j * d + k]);
+
+        // Destroying a class returns its blocks to the pool
+        used = pool.used ();
+        {
+            cl_algo::ICP::ICPLMs glm3 (clEnv, info, &pool);
+            glm3.init ();
+            ASSERT_GT (pool.used (), used);
+        }
+        ASSERT_EQ (used, pool.used ());
+
+        // Moved instances keep their blocks, until the last one is destroyed
+        {
+            std::vector<cl_algo::ICP::ICPLMs> lms;
+            lms.emplace_back (clEnv, info, &pool);
+            lms.back ().init ();
+            size_t held = pool.used ();
+            lms.emplace_back (clEnv, info, &pool);  // Reallocates
+            ASSERT_EQ (held, pool.used ());
+        }
+        ASSERT_EQ (used, pool.used ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `ICPScheduler` class.
+ *  \details Two pipelines, on separate queues, register pairs of landmark sets 
+ *           that differ in their displacement. The results have to match a 
+ *           single `ICP` instance, and arrive in submission order.
+ */
+TEST (ICP, icpScheduler)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+        const unsigned int d = 8;
+        const unsigned int pairs = 6;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp }, 2);
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+
+        // Configure kernel execution parameters
+        std::vector< clutils::CLEnvInfo<1> > infoRBC { clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 0), 
+                                                       clutils::CLEnvInfo<1> (0, 0, 0, { 1 }, 0) };
+        std::vector< clutils::CLEnvInfo<1> > infoICP { clutils::CLEnvInfo<1> (0, 0, 0, { 0 }, 1), 
+                                                       clutils::CLEnvInfo<1> (0, 0, 0, { 1 }, 1) };
+        cl_algo::ICP::ICPScheduler<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                   cl_algo::ICP::ICPStepConfigW::REGULAR> scheduler (clEnv, infoRBC, infoICP);
+        scheduler.init (m, nr);
+        ASSERT_EQ (2U, scheduler.pipelines ());
+
+        // Initialize data
+        std::vector<cl_float> fixed (m * d);
+        ICP::randomLMs (fixed.data (), m);
+
+        std::vector< std::vector<cl_float> > moving (pairs, fixed);
+        for (uint i = 0; i < pairs; ++i)
+            for (uint j = 0; j < m; ++j)
+                moving[i][j * d] += 2.f * i;  // Displacement along x
+
+        for (uint i = 0; i < pairs; ++i)
+            ASSERT_EQ (i, scheduler.submit (fixed.data (), moving[i].data ()));
+        auto results = scheduler.collect ();
+        ASSERT_EQ (pairs, results.size ());
+
+        // Produce reference transformations
+        ICPT reg (clEnv, infoRBC[0], infoICP[0]);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+
+        float eps = 1e-3f;
+        for (uint i = 0; i < pairs; ++i)
+        {
+            reg.q = Eigen::Quaternionf::Identity ();
+            reg.t.setZero ();
+            reg.s = 1.f;
+            std::fill (reg.hPtrIOT, reg.hPtrIOT + 8, 0.f);
+            reg.hPtrIOT[3] = reg.hPtrIOT[7] = 1.f;
+
+            reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+            reg.write (ICPT::Memory::D_IN_M, moving[i].data ());
+            reg.write (ICPT::Memory::D_IO_T);
+            reg.buildRBC ();
+            reg.run ();
+
+            // Verify transformation
+            ASSERT_LT (results[i].pipeline, 2U);
+            ASSERT_EQ (reg.k, results[i].k);
+            ASSERT_LT (std::abs (reg.s - results[i].s), eps);
+            for (uint k = 0; k < 4; ++k)
+                ASSERT_LT (std::abs (reg.q.coeffs ()[k] - results[i].q.coeffs ()[k]), eps);
+            for (uint k = 0; k < 3; ++k)
+                ASSERT_LT (std::abs (reg.t[k] - results[i].t[k]), eps);
+        }
+
+        // The scheduler is reusable after a collect
+        ASSERT_EQ (0U, scheduler.submit (fixed.data (), moving[1].data ()));
+        ASSERT_EQ (1U, scheduler.collect ().size ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `ICPService` class.
+ *  \details Four sessions, driven from separate threads, register pairs of landmark 
+ *           sets that differ in their displacement. The results have to match a 
+ *           single `ICP` instance. A closed session hands its queue to the next one.
+ */
+TEST (ICP, icpService)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+        const unsigned int d = 8;
+        const unsigned int streams = 4;
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+        typedef cl_algo::ICP::ICPService<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                         cl_algo::ICP::ICPStepConfigW::REGULAR> Service;
+        typedef cl_algo::ICP::ICPSession<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                         cl_algo::ICP::ICPStepConfigW::REGULAR> Session;
+
+        Service service ({ "kernels/RBC/reduce_kernels.cl", 
+                           "kernels/RBC/scan_kernels.cl", 
+                           "kernels/RBC/rbc_kernels.cl" }, 
+                         { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        std::vector< std::unique_ptr<Session> > sessions;
+        for (uint i = 0; i < streams; ++i)
+            sessions.push_back (service.open (m, nr));
+        ASSERT_EQ (streams, service.sessions ());
+
+        // Initialize data
+        std::vector<cl_float> fixed (m * d);
+        ICP::randomLMs (fixed.data (), m);
+
+        std::vector< std::vector<cl_float> > moving (streams, fixed);
+        for (uint i = 0; i < streams; ++i)
+            for (uint j = 0; j < m; ++j)
+                moving[i][j * d] += 2.f * i;  // Displacement along x
+
+        // Drive every session from its own thread
+        std::vector< cl_algo::ICP::ICPSchedulerResult, 
+                     Eigen::aligned_allocator<cl_algo::ICP::ICPSchedulerResult> > results (streams);
+        std::vector<std::thread> threads;
+        for (uint i = 0; i < streams; ++i)
+            threads.emplace_back ([&, i] { results[i] = sessions[i]->align (fixed.data (), moving[i].data ()); });
+        for (auto &thread : threads)
+            thread.join ();
+
+        // Produce reference transformations
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { sessions[0]->index () }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { sessions[0]->index () }, 1);
+        ICPT reg (service.getEnv (), infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+
+        float eps = 1e-3f;
+        for (uint i = 0; i < streams; ++i)
+        {
+            reg.q = Eigen::Quaternionf::Identity ();
+            reg.t.setZero ();
+            reg.s = 1.f;
+            std::fill (reg.hPtrIOT, reg.hPtrIOT + 8, 0.f);
+            reg.hPtrIOT[3] = reg.hPtrIOT[7] = 1.f;
+
+            reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+            reg.write (ICPT::Memory::D_IN_M, moving[i].data ());
+            reg.write (ICPT::Memory::D_IO_T);
+            reg.buildRBC ();
+            reg.run ();
+
+            // Verify transformation, and that it became the pose of the session
+            cl_algo::ICP::ICPSchedulerResult pose = sessions[i]->getPose ();
+            ASSERT_EQ (sessions[i]->index (), results[i].pipeline);
+            ASSERT_EQ (reg.k, results[i].k);
+            ASSERT_LT (std::abs (reg.s - results[i].s), eps);
+            for (uint k = 0; k < 4; ++k)
+            {
+                ASSERT_LT (std::abs (reg.q.coeffs ()[k] - results[i].q.coeffs ()[k]), eps);
+                ASSERT_EQ (results[i].q.coeffs ()[k], pose.q.coeffs ()[k]);
+            }
+            for (uint k = 0; k < 3; ++k)
+            {
+                ASSERT_LT (std::abs (reg.t[k] - results[i].t[k]), eps);
+                ASSERT_EQ (results[i].t[k], pose.t[k]);
+            }
+        }
+
+        // A closed session hands its queue to the next one
+        unsigned int qIdx = sessions[1]->index ();
+        sessions[1].reset ();
+        ASSERT_EQ (streams - 1, service.sessions ());
+        sessions[1] = service.open (m, nr);
+        ASSERT_EQ (qIdx, sessions[1]->index ());
+        ASSERT_EQ (streams, service.sessions ());
+
+        sessions.clear ();
+        ASSERT_EQ (0U, service.sessions ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `ICPTrace` class.
+ *  \details Records more iterations than the ring buffer holds, and verifies 
+ *           the kept records and the statistics on the stage durations.
+ */
+TEST (ICP, icpTrace)
+{
+    try
+    {
+        const unsigned int capacity = 8;
+        const unsigned int nRegistrations = 3, nIterations = 5;  // 15 iterations
+        const unsigned int n = 1 << 18;
+
+        typedef cl_algo::ICP::ICPStage ST;
+        typedef cl_algo::ICP::ICPStamp SP;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        cl::Context &context = clEnv.getContext (0);
+        cl::CommandQueue &queue = clEnv.getQueue (0, 0);
+
+        std::vector<cl_float> data (n);
+        std::generate (data.begin (), data.end (), ICP::rNum_R_0_1);
+        cl::Buffer buffer (context, CL_MEM_READ_WRITE, n * sizeof (cl_float));
+
+        cl_algo::ICP::ICPTrace trace (capacity);
+        ASSERT_EQ (capacity, trace.capacity ());
+        ASSERT_EQ (0U, trace.size ());
+
+        // Record the iterations
+        for (uint r = 0; r < nRegistrations; ++r)
+        {
+            for (uint i = 0; i < nIterations; ++i)
+            {
+                trace.begin ();
+
+                // Single-command stage
+                queue.enqueueWriteBuffer (buffer, CL_FALSE, 0, n * sizeof (cl_float), data.data (), 
+                                          nullptr, cl_algo::ICP::traceEvent (&trace, ST::WRITE));
+
+                // Multi-command stage, started with a marker
+                cl::Event *event = cl_algo::ICP::traceEvent (&trace, ST::MEANS, queue);
+                queue.enqueueReadBuffer (buffer, CL_FALSE, 0, n * sizeof (cl_float), data.data ());
+                queue.enqueueReadBuffer (buffer, CL_FALSE, 0, n * sizeof (cl_float), data.data (), 
+                                         nullptr, event);
+
+                *trace.solverIterations () = r * nIterations + i;
+            }
+            queue.finish ();
+            trace.end (cl_algo::ICP::ICPConvergence::THRESHOLD, nIterations);
+        }
+
+        // Verify the ring buffer wrapped around
+        ASSERT_EQ (capacity, trace.size ());
+        ASSERT_EQ (nRegistrations, trace.getRegistrations ());
+        ASSERT_EQ (nIterations, trace.getIterations ());
+        ASSERT_EQ (cl_algo::ICP::ICPConvergence::THRESHOLD, trace.getConvergence ());
+
+        const unsigned int first = nRegistrations * nIterations - capacity;
+        for (uint j = 0; j < capacity; ++j)
+        {
+            const cl_algo::ICP::ICPTraceRecord &record = trace[j];
+            ASSERT_EQ ((first + j) / nIterations, record.registration);
+            ASSERT_EQ ((first + j) % nIterations, record.iteration);
+            ASSERT_EQ (first + j, record.solverIterations);
+
+            ASSERT_TRUE (record.recorded[(uint) ST::WRITE]);
+            ASSERT_TRUE (record.recorded[(uint) ST::MEANS]);
+            ASSERT_FALSE (record.recorded[(uint) ST::SEARCH]);
+
+            // The marker starts the stage before its last command
+            const std::array<cl_ulong, 4> &stamps = record.stamps[(uint) ST::MEANS];
+            ASSERT_LE (stamps[(uint) SP::START], stamps[(uint) SP::END]);
+            ASSERT_LE (record.stamps[(uint) ST::WRITE][(uint) SP::END], stamps[(uint) SP::END]);
+        }
+
+        // Verify the statistics (nearest-rank percentiles)
+        std::vector<double> durations;
+        for (uint j = 0; j < capacity; ++j)
+        {
+            const std::array<cl_ulong, 4> &stamps = trace[j].stamps[(uint) ST::WRITE];
+            durations.push_back ((stamps[(uint) SP::END] - stamps[(uint) SP::START]) * 1e-6);
+        }
+        std::sort (durations.begin (), durations.end ());
+        double mean = 0.0;
+        for (double d : durations) mean += d;
+        mean /= capacity;
+
+        cl_algo::ICP::ICPStageStats stats = trace.stats (ST::WRITE);
+        ASSERT_EQ (capacity, stats.samples);
+        ASSERT_DOUBLE_EQ (mean, stats.mean);
+        ASSERT_DOUBLE_EQ (durations[3], stats.p50);  // ceil (0.50 * 8) - 1
+        ASSERT_DOUBLE_EQ (durations[7], stats.p99);  // ceil (0.99 * 8) - 1
+        ASSERT_DOUBLE_EQ (durations[7], stats.max);
+
+        ASSERT_EQ (0U, trace.stats (ST::SEARCH).samples);
+
+        // Discard the records
+        trace.clear ();
+        ASSERT_EQ (0U, trace.size ());
+        ASSERT_EQ (0U, trace.getRegistrations ());
+        ASSERT_EQ (cl_algo::ICP::ICPConvergence::NONE, trace.getConvergence ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the reuse of correspondences in the `ICP` class.
+ *  \details The same pair of landmark sets is registered with and without 
+ *           reuse. The reuse iterations skip the `RBC search`, which the 
+ *           trace reveals, and the estimated transformations have to agree.
+ */
+TEST (ICP, icpReuse)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+        ICPT reg (clEnv, infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+
+        cl_algo::ICP::ICPTrace trace (64);
+        reg.setTrace (&trace);
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        // Registers the pair, and returns the number of iterations that searched
+        auto registration = [&] ()
+        {
+            reg.q = Eigen::Quaternionf::Identity ();
+            reg.R = Eigen::Matrix3f::Identity ();
+            reg.t.setZero ();
+            reg.s = 1.f;
+            std::fill (reg.hPtrIOT, reg.hPtrIOT + 8, 0.f);
+            reg.hPtrIOT[3] = reg.hPtrIOT[7] = 1.f;
+
+            trace.clear ();
+            reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+            reg.write (ICPT::Memory::D_IN_M, moving.data ());
+            reg.write (ICPT::Memory::D_IO_T);
+            reg.buildRBC ();
+            reg.run ();
+
+            return trace.stats (cl_algo::ICP::ICPStage::SEARCH, 
+                                cl_algo::ICP::ICPStamp::START, cl_algo::ICP::ICPStamp::END).samples;
+        };
+
+        // Produce reference transformation
+        unsigned int searches = registration ();
+        ASSERT_EQ (trace.size (), searches);
+        Eigen::Quaternionf q = reg.q;
+        Eigen::Vector3f t = reg.t;
+
+        // Reuse the correspondences in the convergence tail
+        reg.setReuseAngleThreshold (0.1);
+        reg.setReuseTranslationThreshold (1.0);
+        ASSERT_EQ (0.1, reg.getReuseAngleThreshold ());
+        ASSERT_EQ (1.0, reg.getReuseTranslationThreshold ());
+        searches = registration ();
+        ASSERT_LT (searches, trace.size ());
+
+        // Verify transformation
+        float eps = 1e-2f;
+        for (uint k = 0; k < 4; ++k)
+            ASSERT_LT (std::abs (q.coeffs ()[k] - reg.q.coeffs ()[k]), eps);
+        for (uint k = 0; k < 3; ++k)
+            ASSERT_LT (std::abs (t[k] - reg.t[k]), 10 * eps);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `resize` method of the `ICP` class.
+ *  \details An instance initialized at capacity registers smaller pairs of 
+ *           landmark sets, and then a pair at capacity again. The `RBC` classes 
+ *           are configured again through their `init`, on the buffers they 
+ *           already hold. The transformations have to match an instance 
+ *           initialized at each size, and the memory objects are retained.
+ */
+TEST (ICP, icpResize)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+        ICPT reg (clEnv, infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);  // Capacity
+
+        cl_mem dBufferInF = reg.get (ICPT::Memory::D_IN_F) ();
+        cl_mem dBufferInM = reg.get (ICPT::Memory::D_IN_M) ();
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        // Registers the leading points of the pair, as many as the instance is set up for
+        auto registration = [&] (ICPT &icp)
+        {
+            icp.q = Eigen::Quaternionf::Identity ();
+            icp.R = Eigen::Matrix3f::Identity ();
+            icp.t.setZero ();
+            icp.s = 1.f;
+            std::fill (icp.hPtrIOT, icp.hPtrIOT + 8, 0.f);
+            icp.hPtrIOT[3] = icp.hPtrIOT[7] = 1.f;
+
+            icp.write (ICPT::Memory::D_IN_F, fixed.data ());
+            icp.write (ICPT::Memory::D_IN_M, moving.data ());
+            icp.write (ICPT::Memory::D_IO_T);
+            icp.buildRBC ();
+            icp.run ();
+        };
+
+        float eps = 1e-3f;
+        for (auto size : { std::make_pair (m / 4, nr / 2), std::make_pair (m / 16, nr / 4), 
+                           std::make_pair (m, nr) })
+        {
+            reg.resize (size.first, size.second);
+            registration (reg);
+
+            // The memory objects are retained
+            ASSERT_EQ (dBufferInF, reg.get (ICPT::Memory::D_IN_F) ());
+            ASSERT_EQ (dBufferInM, reg.get (ICPT::Memory::D_IN_M) ());
+
+            // Produce reference transformation
+            ICPT ref (clEnv, infoRBC, infoICP);
+            ref.init (size.first, size.second, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+            registration (ref);
+
+            // Verify transformation
+            ASSERT_EQ (ref.k, reg.k);
+            ASSERT_LT (std::abs (ref.s - reg.s), eps);
+            for (uint k = 0; k < 4; ++k)
+                ASSERT_LT (std::abs (ref.q.coeffs ()[k] - reg.q.coeffs ()[k]), eps);
+            for (uint k = 0; k < 3; ++k)
+                ASSERT_LT (std::abs (ref.t[k] - reg.t[k]), eps);
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `ICPOdometry` class.
+ *  \details Processes a sequence of three frames, where every frame moves 
+ *           by the same transformation relative to the previous one. Both 
+ *           relative transformations have to match an `ICP` registration of 
+ *           the landmarks of the first two frames, and the global pose has to 
+ *           be their composition.
+ */
+TEST (ICP, icpOdometry)
+{
+    try
+    {
+        const unsigned int width = 640, height = 480, n = width * height;
+        const unsigned int m = 1 << 12;  // 4096
+        const unsigned int nr = 64;
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+        typedef cl_algo::ICP::ICPOdometry<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                          cl_algo::ICP::ICPStepConfigW::REGULAR> ICPOdometryT;
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+
+        // Initialize data
+        std::vector<std::vector<cl_float>> frames (3, std::vector<cl_float> (n * d));
+        ICP::randomLMs (frames[0].data (), n);
+        for (uint f = 1; f < 3; ++f)
+            ICP::moveLMs (frames[f - 1].data (), frames[f].data (), n);
+
+        // Produce reference transformation
+        std::vector<cl_float> fixed (m * d), moving (m * d);
+        ICP::cpuICPLMs (frames[0].data (), fixed.data (), width, height, m);
+        ICP::cpuICPLMs (frames[1].data (), moving.data (), width, height, m);
+
+        ICPT reg (clEnv, infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+        reg.write (ICPT::Memory::D_IN_M, moving.data ());
+        reg.buildRBC ();
+        reg.run ();
+
+        ICPOdometryT odometry (clEnv, infoRBC, infoICP);
+        odometry.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01);
+
+        // The first frame only initializes the sequence
+        odometry.write (ICPOdometryT::Memory::D_IN, frames[0].data (), CL_TRUE);
+        odometry.run ();
+        ASSERT_EQ (1U, odometry.frames);
+
+        float eps = 1e-2f;
+        unsigned int k = 0;
+        for (uint f = 1; f < 3; ++f)
+        {
+            odometry.write (ICPOdometryT::Memory::D_IN, frames[f].data (), CL_TRUE);
+            odometry.run ();
+            ASSERT_EQ (f + 1, odometry.frames);
+            ASSERT_LT (0U, odometry.k);
+
+            // Verify relative transformation
+            ASSERT_LT ((reg.R - odometry.Rr).cwiseAbs ().maxCoeff (), eps);
+            for (uint i = 0; i < 3; ++i)
+                ASSERT_LT (std::abs (reg.t[i] - odometry.tr[i]), 10 * eps);
+
+            // The second registration starts from the previous relative motion
+            if (f == 2)
+            {
+                ASSERT_LE (odometry.k, k);
+            }
+            k = odometry.k;
+        }
+
+        // Verify global pose
+        Eigen::Matrix3f R = reg.R * reg.R;
+        Eigen::Vector3f t = reg.R * reg.t + reg.t;
+        ASSERT_LT ((R - odometry.R).cwiseAbs ().maxCoeff (), eps);
+        for (uint i = 0; i < 3; ++i)
+            ASSERT_LT (std::abs (t[i] - odometry.t[i]), 20 * eps);
+
+        // A reset starts a new sequence
+        odometry.reset ();
+        ASSERT_EQ (0U, odometry.frames);
+        ASSERT_LT ((Eigen::Matrix3f::Identity () - odometry.R).cwiseAbs ().maxCoeff (), eps);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `ICPPyramid` class.
+ *  \details Registers a pair of point clouds over three levels of increasing 
+ *           density. The result has to match an `ICP` registration of the 
+ *           landmarks of the finest level, and the finest level has to need 
+ *           no more iterations than that registration, since it starts from 
+ *           the estimation of the coarser levels.
+ */
+TEST (ICP, icpPyramid)
+{
+    try
+    {
+        const unsigned int width = 640, height = 480, n = width * height;
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+        const unsigned int d = 8;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+        typedef cl_algo::ICP::ICPPyramid<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                         cl_algo::ICP::ICPStepConfigW::REGULAR> ICPPyramidT;
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+
+        // Initialize data
+        std::vector<cl_float> fixedPC, movingPC;
+        ICP::registrationPair (fixedPC, movingPC, n);
+
+        // Produce reference transformation
+        std::vector<cl_float> fixed (m * d), moving (m * d);
+        ICP::cpuICPLMs (fixedPC.data (), fixed.data (), width, height, m);
+        ICP::cpuICPLMs (movingPC.data (), moving.data (), width, height, m);
+
+        ICPT reg (clEnv, infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+        reg.write (ICPT::Memory::D_IN_M, moving.data ());
+        reg.buildRBC ();
+        reg.run ();
+
+        ICPPyramidT pyramid (clEnv, infoRBC, infoICP);
+        pyramid.init ({ { m / 16, nr / 4, 40, 0.01, 0.1 }, 
+                        { m / 4, nr / 2, 40, 0.001, 0.01 }, 
+                        { m, nr, 40, 0.001, 0.01 } });
+        ASSERT_EQ (3U, pyramid.getLevels ());
+
+        pyramid.write (ICPPyramidT::Memory::D_IN_F, fixedPC.data ());
+        pyramid.write (ICPPyramidT::Memory::D_IN_M, movingPC.data ());
+        pyramid.run ();
+
+        // Every level contributes to the registration
+        for (uint l = 0; l < 3; ++l)
+            ASSERT_LT (0U, pyramid.k[l]);
+        ASSERT_LE (pyramid.k[2], reg.k);
+
+        // Verify transformation
+        float eps = 1e-2f;
+        ASSERT_LT ((reg.R - pyramid.R).cwiseAbs ().maxCoeff (), eps);
+        for (uint k = 0; k < 3; ++k)
+            ASSERT_LT (std::abs (reg.t[k] - pyramid.t[k]), 10 * eps);
+
+        // A reset starts from the identity transformation
+        pyramid.reset ();
+        ASSERT_LT ((Eigen::Matrix3f::Identity () - pyramid.R).cwiseAbs ().maxCoeff (), eps);
+        pyramid.run ();
+        ASSERT_LT ((reg.R - pyramid.R).cwiseAbs ().maxCoeff (), eps);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the `ICPBatch` class.
+ *  \details Registers a batch of pairs of landmark sets, which differ in their 
+ *           transformation, at once. The results have to match independent 
+ *           registrations of the pairs with an `ICP` instance that uses the 
+ *           Power Method, and every pair has to report its convergence.
+ */
+TEST (ICP, icpBatch)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+        const unsigned int k = 4;
+        const unsigned int d = 8;
+        const unsigned int max_iterations = 40;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::POWER_METHOD, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+        cl_algo::ICP::ICPBatch batch (clEnv, infoRBC, infoICP);
+        batch.init (m, nr, k, 1e2f, 1e-6f, max_iterations, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+
+        // Initialize data
+        std::vector<cl_float> fixed (k * m * d), moving (k * m * d);
+        for (uint i = 0; i < k; ++i)
+        {
+            cl_float *F = fixed.data () + i * m * d;
+            cl_float *M = moving.data () + i * m * d;
+
+            // Each pair has its own rotation and translation
+            ICP::randomLMs (F, m);
+            ICP::moveLMs (F, M, m, 0.01f * (i + 1), 2.f * i, -1.f, 0.5f * i);
+        }
+
+        for (uint i = 0; i < k; ++i)
+        {
+            std::fill (batch.hPtrIOT + i * 8, batch.hPtrIOT + (i + 1) * 8, 0.f);
+            batch.hPtrIOT[i * 8 + 3] = batch.hPtrIOT[i * 8 + 7] = 1.f;
+        }
+
+        batch.write (cl_algo::ICP::ICPBatch::Memory::D_IN_F, fixed.data ());
+        batch.write (cl_algo::ICP::ICPBatch::Memory::D_IN_M, moving.data ());
+        batch.write (cl_algo::ICP::ICPBatch::Memory::D_IO_T);
+        batch.buildRBC ();
+        batch.run ();  // Reads back the transformations
+
+        cl_uint *states = (cl_uint *) batch.read (cl_algo::ICP::ICPBatch::Memory::H_IO_C);
+
+        // Produce reference transformations
+        ICPT reg (clEnv, infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, max_iterations, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        reg.setPowerTolerance (batch.getPowerTolerance ());
+        reg.setPowerMaxIterations (batch.getPowerMaxIterations ());
+        reg.setPowerWarmStart (batch.getPowerWarmStart ());
+
+        float eps = 1e-3f;
+        for (uint i = 0; i < k; ++i)
+        {
+            reg.q = Eigen::Quaternionf::Identity ();
+            reg.t.setZero ();
+            reg.s = 1.f;
+            std::fill (reg.hPtrIOT, reg.hPtrIOT + 8, 0.f);
+            reg.hPtrIOT[3] = reg.hPtrIOT[7] = 1.f;
+
+            reg.write (ICPT::Memory::D_IN_F, fixed.data () + i * m * d);
+            reg.write (ICPT::Memory::D_IN_M, moving.data () + i * m * d);
+            reg.write (ICPT::Memory::D_IO_T);
+            reg.buildRBC ();
+            reg.run ();
+
+            // Verify convergence state
+            ASSERT_NE (0U, states[i * 2]);
+            ASSERT_GT (states[i * 2 + 1], 0U);
+            ASSERT_LE (states[i * 2 + 1], max_iterations);
+
+            // Verify transformation
+            const cl_float *T = batch.hPtrIOT + i * 8;
+            for (uint c = 0; c < 4; ++c)
+                ASSERT_LT (std::abs (reg.q.coeffs ()[c] - T[c]), eps);
+            for (uint c = 0; c < 3; ++c)
+                ASSERT_LT (std::abs (reg.t[c] - T[4 + c]), eps);
+            ASSERT_LT (std::abs (reg.s - T[7]), eps);
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+/*! \brief Registers a pair of landmark sets with `ICP` and `ICPCPU`, and compares the transformations. */
+template <typename ICPT, typename ICPCPUT>
+void compareCPU (ICPT &reg, ICPCPUT &cpu, std::vector<cl_float> &fixed, std::vector<cl_float> &moving, 
+                 unsigned int m, unsigned int nr)
+{
+    reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+    reg.write (ICPT::Memory::D_IN_M, moving.data ());
+    reg.buildRBC ();
+    reg.run ();
+
+    cl_float T0[8] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
+    cpu.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    cpu.write (ICPCPUT::Memory::D_IN_F, fixed.data ());
+    cpu.write (ICPCPUT::Memory::D_IN_M, moving.data ());
+    cpu.write (ICPCPUT::Memory::D_IO_T, T0);
+    cpu.buildRBC ();
+    cpu.run ();
+
+    cl_float *T = (cl_float *) cpu.read ();
+    for (uint k = 0; k < 8; ++k)
+        ASSERT_EQ (cpu.hPtrIOT[k], T[k]);
+
+    // Verify transformation
+    float eps = 1e-2f;
+    for (uint k = 0; k < 4; ++k)
+        ASSERT_LT (std::abs (reg.q.coeffs ()[k] - cpu.q.coeffs ()[k]), eps);
+    for (uint k = 0; k < 3; ++k)
+        ASSERT_LT (std::abs (reg.t[k] - cpu.t[k]), 10 * eps);
+    ASSERT_LT (std::abs (reg.s - cpu.s), eps);
+}
+
+
+/*! \brief Tests the **ICPCPU** backend.
+ *  \details Registers a pair of landmark sets with the CPU backend and with `ICP`, 
+ *           for two configurations, and compares the transformations.
+ */
+TEST (ICP, icpCPU)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                          cl_algo::ICP::ICPStepConfigW::REGULAR> regER (clEnv, infoRBC, infoICP);
+        cl_algo::ICP::ICPCPU<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                             cl_algo::ICP::ICPStepConfigW::REGULAR> cpuER (4);
+        ASSERT_EQ (4, cpuER.getThreads ());
+        compareCPU (regER, cpuER, fixed, moving, m, nr);
+
+        cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::POWER_METHOD, 
+                          cl_algo::ICP::ICPStepConfigW::WEIGHTED> regPW (clEnv, infoRBC, infoICP);
+        cl_algo::ICP::ICPCPU<cl_algo::ICP::ICPStepConfigT::POWER_METHOD, 
+                             cl_algo::ICP::ICPStepConfigW::WEIGHTED> cpuPW;
+        compareCPU (regPW, cpuPW, fixed, moving, m, nr);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Registers a pair of landmark sets with `ICP`, with the rotation solved on the host 
+ *         and on the device, and compares the transformations. */
+template <typename ICPT>
+void compareDeviceSolve (ICPT &host, ICPT &device, std::vector<cl_float> &fixed, 
+                         std::vector<cl_float> &moving, unsigned int m, unsigned int nr)
+{
+    host.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    host.write (ICPT::Memory::D_IN_F, fixed.data ());
+    host.write (ICPT::Memory::D_IN_M, moving.data ());
+    host.buildRBC ();
+    host.run ();
+
+    device.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    device.setDeviceSolve (true);
+    ASSERT_TRUE (device.getDeviceSolve ());
+    device.write (ICPT::Memory::D_IN_F, fixed.data ());
+    device.write (ICPT::Memory::D_IN_M, moving.data ());
+    device.buildRBC ();
+    device.run ();
+    ASSERT_LT (0U, device.k);
+
+    // Verify transformation
+    float eps = 1e-2f;
+    for (uint k = 0; k < 4; ++k)
+        ASSERT_LT (std::abs (host.q.coeffs ()[k] - device.q.coeffs ()[k]), eps);
+    for (uint k = 0; k < 3; ++k)
+        ASSERT_LT (std::abs (host.t[k] - device.t[k]), 10 * eps);
+    ASSERT_LT (std::abs (host.s - device.s), eps);
+}
+
+
+/*! \brief Tests the `ICP` pipeline with the rotation solved on the device.
+ *  \details Registers a pair of landmark sets with `setDeviceSolve` on and off, 
+ *           for the regular and the weighted configurations, and compares the 
+ *           transformations.
+ */
+TEST (ICP, icpDeviceSolve)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPER;
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::WEIGHTED> ICPEW;
+
+        ICPER hostER (clEnv, infoRBC, infoICP), deviceER (clEnv, infoRBC, infoICP);
+        compareDeviceSolve (hostER, deviceER, fixed, moving, m, nr);
+
+        ICPEW hostEW (clEnv, infoRBC, infoICP), deviceEW (clEnv, infoRBC, infoICP);
+        compareDeviceSolve (hostEW, deviceEW, fixed, moving, m, nr);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Registers a pair of landmark sets with `ICP<POWER_METHOD>`, with batches of one and 
+ *         of many iterations, and compares the transformations with each other and with `ICP<EIGEN>`. */
+template <typename ICPPT, typename ICPET>
+void compareBatchSize (ICPPT &single, ICPPT &batched, ICPET &host, std::vector<cl_float> &fixed, 
+                       std::vector<cl_float> &moving, unsigned int m, unsigned int nr)
+{
+    single.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    single.setBatchSize (1);
+    single.write (ICPPT::Memory::D_IN_F, fixed.data ());
+    single.write (ICPPT::Memory::D_IN_M, moving.data ());
+    single.buildRBC ();
+    single.run ();
+
+    batched.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    batched.setBatchSize (8);
+    ASSERT_EQ (8U, batched.getBatchSize ());
+    batched.write (ICPPT::Memory::D_IN_F, fixed.data ());
+    batched.write (ICPPT::Memory::D_IN_M, moving.data ());
+    batched.buildRBC ();
+    batched.run ();
+
+    host.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+    host.write (ICPET::Memory::D_IN_F, fixed.data ());
+    host.write (ICPET::Memory::D_IN_M, moving.data ());
+    host.buildRBC ();
+    host.run ();
+
+    // The iterations after convergence don't change the transformation
+    ASSERT_LT (0U, batched.k);
+    ASSERT_EQ (single.k, batched.k);
+    for (uint k = 0; k < 8; ++k)
+        ASSERT_LT (std::abs (single.hPtrIOT[k] - batched.hPtrIOT[k]), 1e-5f);
+
+    // Verify transformation
+    float eps = 1e-2f;
+    for (uint k = 0; k < 4; ++k)
+        ASSERT_LT (std::abs (host.q.coeffs ()[k] - batched.q.coeffs ()[k]), eps);
+    for (uint k = 0; k < 3; ++k)
+        ASSERT_LT (std::abs (host.t[k] - batched.t[k]), 10 * eps);
+    ASSERT_LT (std::abs (host.s - batched.s), eps);
+}
+
+
+/*! \brief Tests the batched iterations of the `ICP` pipeline.
+ *  \details The `POWER_METHOD` configurations enqueue the iterations in batches, 
+ *           and check for convergence on the device. A registration has to give 
+ *           the same transformation, and take the same number of iterations, 
+ *           with batches of one and of eight iterations. The transformation has 
+ *           to match the one of the `EIGEN` configuration, which checks for 
+ *           convergence on the host.
+ */
+TEST (ICP, icpBatchSize)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::POWER_METHOD, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPPR;
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPER;
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::POWER_METHOD, 
+                                  cl_algo::ICP::ICPStepConfigW::WEIGHTED> ICPPW;
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::WEIGHTED> ICPEW;
+
+        ICPPR singlePR (clEnv, infoRBC, infoICP), batchedPR (clEnv, infoRBC, infoICP);
+        ICPER hostER (clEnv, infoRBC, infoICP);
+        compareBatchSize (singlePR, batchedPR, hostER, fixed, moving, m, nr);
+
+        ICPPW singlePW (clEnv, infoRBC, infoICP), batchedPW (clEnv, infoRBC, infoICP);
+        ICPEW hostEW (clEnv, infoRBC, infoICP);
+        compareBatchSize (singlePW, batchedPW, hostEW, fixed, moving, m, nr);
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Registers a pair of landmark sets with `ICPTiled`, and compares the transformation with `ICP`. */
+template <typename ICPT>
+void compareTiled (ICPT &reg, cl_algo::ICP::ICPTiled &tiled, std::vector<cl_float> &fixed, 
+                   std::vector<cl_float> &moving, unsigned int n)
+{
+    tiled.setFixed (fixed.data (), n);
+    tiled.setMoving (moving.data (), n);
+    tiled.run ();
+
+    // Verify transformation
+    float eps = 1e-2f;
+    for (uint k = 0; k < 4; ++k)
+        ASSERT_LT (std::abs (reg.q.coeffs ()[k] - tiled.q.coeffs ()[k]), eps);
+    for (uint k = 0; k < 3; ++k)
+        ASSERT_LT (std::abs (reg.t[k] - tiled.t[k]), 10 * eps);
+    ASSERT_LT (std::abs (reg.s - tiled.s), eps);
+}
+
+
+/*! \brief Tests the **ICPTiled** pipeline.
+ *  \details Registers a pair of landmark sets with `ICP`, and with `ICPTiled`, 
+ *           once in a single tile and once in four tiles, and compares the transformations.
+ */
+TEST (ICP, icpTiled)
+{
+    try
+    {
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp }, 2);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+        clutils::CLEnvInfo<1> infoIO (0, 0, 0, { 1 }, 1);
+
+        // Initialize data
+        std::vector<cl_float> fixed, moving;
+        ICP::registrationPair (fixed, moving, m);
+
+        // Produce reference transformation
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+
+        ICPT reg (clEnv, infoRBC, infoICP);
+        reg.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        reg.write (ICPT::Memory::D_IN_F, fixed.data ());
+        reg.write (ICPT::Memory::D_IN_M, moving.data ());
+        reg.buildRBC ();
+        reg.run ();
+
+        // A single tile holds the whole fixed set
+        cl_algo::ICP::ICPTiled whole (clEnv, infoRBC, infoICP, infoIO);
+        whole.init (m, nr);
+        compareTiled (reg, whole, fixed, moving, m);
+        ASSERT_EQ (1, whole.tiles ());
+        ASSERT_EQ (1, whole.chunks ());
+
+        // The fixed set is streamed in four tiles
+        cl_algo::ICP::ICPTiled tiled (clEnv, infoRBC, infoICP, infoIO);
+        tiled.init (m / 4, nr / 2);
+        compareTiled (reg, tiled, fixed, moving, m);
+        ASSERT_EQ (4, tiled.tiles ());
+        ASSERT_LE (4, tiled.chunks ());
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Renders an organized point cloud of the corner of a room (floor, left and back wall).
+ *  \details The camera is placed at \f$ t \f$ with orientation \f$ R \f$ relative to the 
+ *           room frame. So, the points of the cloud map to the room frame as \f$ Rp+t \f$.
+ */
+void renderRoom (std::vector<cl_float> &pc, const Eigen::Matrix3f &R, const Eigen::Vector3f &t, 
+                 unsigned int width, unsigned int height, float fx, float fy, float cx, float cy)
+{
+    pc.resize (8 * width * height);
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            Eigen::Vector3f dc ((x - cx) / fx, (y - cy) / fy, 1.f);
+            Eigen::Vector3f dw = R * dc;
+
+            float tau = (2000.f - t.z ()) / dw.z ();  // Back wall
+            if (dw.y () > 0.f) tau = std::min (tau, (400.f - t.y ()) / dw.y ());  // Floor
+            if (dw.x () < 0.f) tau = std::min (tau, (-600.f - t.x ()) / dw.x ());  // Left wall
+
+            cl_float *p = pc.data () + 8 * (y * width + x);
+            Eigen::Map<Eigen::Vector3f> (p, 3) = tau * dc;
+            p[3] = 1.f;
+            std::fill (p + 4, p + 7, 0.5f);
+            p[7] = 1.f;
+        }
+    }
+}
+
+
+/*! \brief Tests the **icpNormals** kernel.
+ *  \details The kernel estimates the surface normals of an organized point cloud.
+ */
+TEST (ICP, icpNormals)
+{
+    try
+    {
+        const unsigned int width = 640, height = 480, n = width * height;
+        const float fx = 595.f, fy = 595.f, cx = 319.5f, cy = 239.5f;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_icp);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::ICPNormals normals (clEnv, info);
+        normals.init (width, height, 0.05f);
+
+        // Initialize data
+        std::vector<cl_float> pc;
+        renderRoom (pc, Eigen::Matrix3f::Identity (), Eigen::Vector3f::Zero (), width, height, fx, fy, cx, cy);
+
+        normals.write (cl_algo::ICP::ICPNormals::Memory::D_IN, pc.data ());  // Copy data to device
+        
+        normals.run ();  // Execute kernels
+        
+        cl_float *results = (cl_float *) normals.read ();  // Copy results to host
+
+        // Produce reference normal map
+        std::vector<cl_float> refN (4 * n);
+        ICP::cpuICPNormals (pc.data (), refN.data (), width, height, 0.05f);
+
+        // Verify normal map
+        for (uint j = 0; j < 4 * n; ++j)
+            ASSERT_LT (std::abs (refN[j] - results[j]), 1e-3f);
+
+        // The normals of the back wall (center) and the floor (bottom) point towards the camera
+        unsigned int center = (height / 2) * width + width / 2;
+        unsigned int bottom = (height - 5) * width + width / 2;
+        ASSERT_LT (std::abs (results[4 * center + 2] + 1.f), 1e-3f);
+        ASSERT_LT (std::abs (results[4 * bottom + 1] + 1.f), 1e-3f);
+        ASSERT_EQ (0.f, results[0]);  // Border
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuICPNormals (pc.data (), refN.data (), width, height, 0.05f);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = normals.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "ICPNormals");
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **ICP** pipeline with the point-to-plane error.
+ *  \details Two views of a room, that sample the walls at different points, are registered 
+ *           with the point-to-plane and the point-to-point configurations. The point-to-plane 
+ *           one recovers the camera motion, in no more iterations than the point-to-point one.
+ */
+TEST (ICP, icpPointToPlane)
+{
+    try
+    {
+        const unsigned int width = 640, height = 480;
+        const unsigned int m = 1 << 14;  // 16384
+        const unsigned int nr = 128;
+        const unsigned int d = 8;
+        const float fx = 595.f, fy = 595.f, cx = 319.5f, cy = 239.5f;
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        ICP::registrationEnv (clEnv, { kernel_filename_reduce, kernel_filename_scan, kernel_filename_icp });
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> infoRBC (0, 0, 0, { 0 }, 0);
+        clutils::CLEnvInfo<1> infoICP (0, 0, 0, { 0 }, 1);
+
+        // Initialize data
+        Eigen::Matrix3f Rm = (Eigen::AngleAxisf (0.03f, Eigen::Vector3f::UnitY ()) * 
+                              Eigen::AngleAxisf (0.02f, Eigen::Vector3f::UnitX ())).toRotationMatrix ();
+        Eigen::Vector3f tm (30.f, -20.f, 25.f);
+
+        std::vector<cl_float> fixedPC, movingPC;
+        renderRoom (fixedPC, Eigen::Matrix3f::Identity (), Eigen::Vector3f::Zero (), width, height, fx, fy, cx, cy);
+        renderRoom (movingPC, Rm, tm, width, height, fx, fy, cx, cy);
+
+        std::vector<cl_float> fixed (m * d), moving (m * d);
+        ICP::cpuICPLMs (fixedPC.data (), fixed.data (), width, height, m);
+        ICP::cpuICPLMs (movingPC.data (), moving.data (), width, height, m);
+
+        // The normal map of the fixed frame is computed on the device
+        cl_algo::ICP::ICPNormals normals (clEnv, infoICP);
+        normals.init (width, height);
+        normals.write (cl_algo::ICP::ICPNormals::Memory::D_IN, fixedPC.data ());
+        normals.run ();
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::POINT_TO_PLANE, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPPT;
+
+        ICPPT plane (clEnv, infoRBC, infoICP);
+        plane.get (ICPPT::Memory::D_IN_N) = normals.get (cl_algo::ICP::ICPNormals::Memory::D_OUT);
+        plane.setFrameSize (width, height);
+        plane.init (m, nr, 1e2f, 1e-3f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        plane.setIntrinsics (fx, fy, cx, cy);
+        plane.write (ICPPT::Memory::D_IN_F, fixed.data ());
+        plane.write (ICPPT::Memory::D_IN_M, moving.data ());
+        plane.buildRBC ();
+        plane.run ();
+
+        typedef cl_algo::ICP::ICP<cl_algo::ICP::ICPStepConfigT::EIGEN, 
+                                  cl_algo::ICP::ICPStepConfigW::REGULAR> ICPT;
+
+        ICPT point (clEnv, infoRBC, infoICP);
+        point.init (m, nr, 1e2f, 1e-6f, 40, 0.001, 0.01, cl_algo::ICP::Staging::IO);
+        point.write (ICPT::Memory::D_IN_F, fixed.data ());
+        point.write (ICPT::Memory::D_IN_M, moving.data ());
+        point.buildRBC ();
+        point.run ();
+
+        // Verify transformation
+        Eigen::Quaternionf qm (Rm);
+        if (qm.w () * plane.q.w () < 0.f) qm.coeffs () *= -1.f;
+        for (uint k = 0; k < 4; ++k)
+            ASSERT_LT (std::abs (qm.coeffs ()[k] - plane.q.coeffs ()[k]), 2e-3f);
+        for (uint k = 0; k < 3; ++k)
+            ASSERT_LT (std::abs (tm[k] - plane.t[k]), 2.f);
+        ASSERT_EQ (1.f, plane.s);
+
+        ASSERT_LE (plane.k, point.k);
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+
+            plane.buildRBC ();
+            plane.run (gTimer);
+        }
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
 int main (int argc, char **argv)
 {
     profiling = ICP::setProfilingFlag (argc, argv);
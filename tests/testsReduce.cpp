@@ -300,6 +300,223 @@ TEST (Reduce, reduce_sum)
 }
 
 
+/*! \brief Tests the single-pass **reduce_sum_SP** kernel.
+ *  \details The kernel computes the sum of the elements of each row in an array, 
+ *           in a single launch. The results are compared against the two-pass reduction.
+ */
+TEST (Reduce, reduce_sum_SinglePass)
+{
+    try
+    {
+        const unsigned int rows = 1024;
+        const unsigned int cols = 4096;
+        const unsigned int bufferInSize = cols * rows * sizeof (cl_float);
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_reduce);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::Reduce<cl_algo::ICP::ReduceConfig::SUM, cl_float> rSum (clEnv, info);
+        rSum.init (cols, rows);
+        ASSERT_FALSE (rSum.getSinglePass ());  // Off by default
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (rSum.hPtrIn, rSum.hPtrIn + bufferInSize / sizeof (cl_float), ICP::rNum_R_0_1);
+
+        rSum.write ();  // Copy data to device
+
+        // Two-pass reduction
+        rSum.setSinglePass (false);
+        rSum.run ();
+        cl_float *results = (cl_float *) rSum.read ();
+        std::vector<cl_float> twoPass (results, results + rows);
+
+        // Produce reference array of sums
+        cl_float *refSum = new cl_float[rows];
+        ICP::cpuReduceSum (rSum.hPtrIn, refSum, cols, rows);
+
+        // Single-pass reduction, repeated to check that the counters get reset
+        rSum.setSinglePass (true);
+        float eps = 42000 * std::numeric_limits<float>::epsilon ();  // 0.00500679
+        for (int k = 0; k < 3; ++k)
+        {
+            rSum.run ();
+            results = (cl_float *) rSum.read ();
+
+            for (uint i = 0; i < rows; ++i)
+            {
+                ASSERT_LT (std::abs (refSum[i] - results[i]), 4 * eps);
+                ASSERT_LT (std::abs (twoPass[i] - results[i]), 4 * eps);
+            }
+        }
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+
+            // Two-pass
+            rSum.setSinglePass (false);
+            clutils::ProfilingInfo<nRepeat> pTP ("Two-pass");
+            for (int i = 0; i < nRepeat; ++i)
+                pTP[i] = rSum.run (gTimer);
+            
+            // Single-pass
+            rSum.setSinglePass (true);
+            clutils::ProfilingInfo<nRepeat> pSP ("Single-pass");
+            for (int i = 0; i < nRepeat; ++i)
+                pSP[i] = rSum.run (gTimer);
+
+            // Benchmark
+            pSP.print (pTP, "Reduce<Sum>");
+        }
+
+        delete[] refSum;
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the single-pass **reduce_min_f_SP** kernel.
+ *  \details The kernel computes the minimum element of each row in an array, 
+ *           in a single launch. The results are compared against the two-pass reduction.
+ */
+TEST (Reduce, reduce_min_SinglePass)
+{
+    try
+    {
+        const unsigned int rows = 1024;
+        const unsigned int cols = 4096;
+        const unsigned int bufferInSize = cols * rows * sizeof (cl_float);
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_reduce);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::Reduce<cl_algo::ICP::ReduceConfig::MIN, cl_float> rMin (clEnv, info);
+        rMin.init (cols, rows);
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (rMin.hPtrIn, rMin.hPtrIn + bufferInSize / sizeof (cl_float), ICP::rNum_R_0_1);
+
+        rMin.write ();  // Copy data to device
+
+        // Two-pass reduction
+        rMin.run ();
+        cl_float *results = (cl_float *) rMin.read ();
+        std::vector<cl_float> twoPass (results, results + rows);
+
+        // Produce reference array of minima
+        cl_float *refMin = new cl_float[rows];
+        auto func = [](cl_float a, cl_float b) -> bool { return a < b; };
+        ICP::cpuReduce<cl_float> (rMin.hPtrIn, refMin, cols, rows, func);
+
+        // Single-pass reduction, repeated to check that the counters get reset
+        rMin.setSinglePass (true);
+        for (int k = 0; k < 3; ++k)
+        {
+            rMin.run ();
+            results = (cl_float *) rMin.read ();
+
+            for (uint i = 0; i < rows; ++i)
+            {
+                ASSERT_EQ (refMin[i], results[i]);
+                ASSERT_EQ (twoPass[i], results[i]);
+            }
+        }
+
+        delete[] refMin;
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the single-pass **reduce_max_ui_SP** kernel.
+ *  \details The kernel computes the maximum element of each row in an array, 
+ *           in a single launch. The results are compared against the two-pass reduction.
+ */
+TEST (Reduce, reduce_max_SinglePass)
+{
+    try
+    {
+        const unsigned int rows = 1024;
+        const unsigned int cols = 4096;
+        const unsigned int bufferInSize = cols * rows * sizeof (cl_uint);
+
+        // Setup the OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_reduce);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        cl_algo::ICP::Reduce<cl_algo::ICP::ReduceConfig::MAX, cl_uint> rMax (clEnv, info);
+        rMax.init (cols, rows);
+
+        // Initialize data (writes on staging buffer directly)
+        std::generate (rMax.hPtrIn, rMax.hPtrIn + bufferInSize / sizeof (cl_uint), ICP::rNum_0_10000);
+
+        rMax.write ();  // Copy data to device
+
+        // Two-pass reduction
+        rMax.run ();
+        cl_uint *results = (cl_uint *) rMax.read ();
+        std::vector<cl_uint> twoPass (results, results + rows);
+
+        // Produce reference array of maxima
+        cl_uint *refMax = new cl_uint[rows];
+        auto func = [](cl_uint a, cl_uint b) -> bool { return a > b; };
+        ICP::cpuReduce<cl_uint> (rMax.hPtrIn, refMax, cols, rows, func);
+
+        // Single-pass reduction, repeated to check that the counters get reset
+        rMax.setSinglePass (true);
+        for (int k = 0; k < 3; ++k)
+        {
+            rMax.run ();
+            results = (cl_uint *) rMax.read ();
+
+            for (uint i = 0; i < rows; ++i)
+            {
+                ASSERT_EQ (refMax[i], results[i]);
+                ASSERT_EQ (twoPass[i], results[i]);
+            }
+        }
+
+        delete[] refMax;
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
 int main (int argc, char **argv)
 {
     profiling = ICP::setProfilingFlag (argc, argv);
@@ -34,6 +34,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <utility>
 #include <chrono>
 #include <random>
 #include <limits>
@@ -229,6 +230,174 @@ TEST (Scan, exclusiveScan)
 }
 
 
+/*! \brief Tests the single-pass **exclusiveScan_i_DLB** kernel.
+ *  \details The operation is an exclusive scan on the columns of an array, 
+ *           with rows of the size of a full frame `(640 x 480)`.
+ */
+TEST (Scan, exclusiveScan_SinglePass)
+{
+    try
+    {
+        const unsigned int cols = 640 * 480, rows = 2;
+        const unsigned int bufferSize = cols * rows * sizeof (cl_int);
+
+        // Set up OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_scan);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+        const cl_algo::ICP::ScanConfig C = cl_algo::ICP::ScanConfig::EXCLUSIVE;
+        cl_algo::ICP::Scan<C> scan (clEnv, info);
+        scan.init (cols, rows, cl_algo::ICP::Staging::IO, true);
+
+        // Produce reference scan array
+        cl_int *refScan = new cl_int[cols * rows];
+
+        // Repeated, to check that the block states of a launch don't leak into the next
+        for (int k = 0; k < 3; ++k)
+        {
+            // Initialize data (writes on staging buffer directly)
+            std::generate (scan.hPtrIn, scan.hPtrIn + bufferSize / sizeof (cl_int), ICP::rNum_0_255);
+
+            scan.write ();  // Copy data to device
+
+            scan.run ();  // Execute kernel
+            
+            cl_int *results = (cl_int *) scan.read ();  // Copy results to host
+
+            ICP::cpuExScan (scan.hPtrIn, refScan, cols, rows);
+
+            // Verify scan output
+            for (uint row = 0; row < rows; ++row)
+                for (uint col = 0; col < cols; ++col)
+                    ASSERT_EQ (refScan[row * cols + col], results[row * cols + col]);
+        }
+
+        // Profiling ===========================================================
+        if (profiling)
+        {
+            const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+            // CPU
+            clutils::CPUTimer<double, std::milli> cTimer;
+            clutils::ProfilingInfo<nRepeat> pCPU ("CPU");
+            for (int i = 0; i < nRepeat; ++i)
+            {
+                cTimer.start ();
+                ICP::cpuExScan (scan.hPtrIn, refScan, cols, rows);
+                pCPU[i] = cTimer.stop ();
+            }
+            
+            // GPU
+            clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+            clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+            for (int i = 0; i < nRepeat; ++i)
+                pGPU[i] = scan.run (gTimer);
+
+            // Benchmark
+            pGPU.print (pCPU, "Scan<EXCLUSIVE_INT> (single-pass)");
+        }
+
+        delete[] refScan;
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/*! \brief Tests the **compactFlag** and **compactScatter** kernels.
+ *  \details The operation moves the points with a non-zero depth 
+ *           to the front of an array, retaining their order. The flags of 
+ *           a small array are scanned with the three-pass scan, and those 
+ *           of a full frame with the single-pass scan.
+ */
+TEST (Scan, compact)
+{
+    try
+    {
+        const unsigned int d = 8;
+
+        // Set up OpenCL environment
+        clutils::CLEnv clEnv;
+        clEnv.addContext (0);
+        clEnv.addQueue (0, 0, CL_QUEUE_PROFILING_ENABLE);
+        clEnv.addProgram (0, kernel_filename_scan);
+
+        // Configure kernel execution parameters
+        clutils::CLEnvInfo<1> info (0, 0, 0, { 0 }, 0);
+
+        // Not multiples of 4
+        const std::vector<std::pair<unsigned int, bool>> configs = 
+            { { 16384 - 2, false }, { 640 * 480 - 2, true } };
+
+        for (const std::pair<unsigned int, bool> &config : configs)
+        {
+            const unsigned int n = config.first;
+
+            cl_algo::ICP::Compact compact (clEnv, info);
+            compact.setSinglePass (config.second);
+            ASSERT_EQ (config.second, compact.getSinglePass ());
+            compact.init (n);
+
+            // Initialize data (writes on staging buffer directly)
+            // About a quarter of the points have zero depth
+            std::generate (compact.hPtrIn, compact.hPtrIn + n * d, ICP::rNum_0_255);
+            for (uint i = 0; i < n; ++i)
+                if (compact.hPtrIn[i * d + 2] < 64.f) compact.hPtrIn[i * d + 2] = 0.f;
+
+            compact.write ();  // Copy data to device
+
+            compact.run ();  // Execute kernels
+
+            cl_float *results = (cl_float *) compact.read ();  // Copy results to host
+            cl_uint count = *((cl_uint *) compact.read (cl_algo::ICP::Compact::Memory::H_COUNT));
+
+            // Produce reference array
+            std::vector<cl_float> refOut;
+            for (uint i = 0; i < n; ++i)
+                if (compact.hPtrIn[i * d + 2] != 0.f)
+                    refOut.insert (refOut.end (), compact.hPtrIn + i * d, compact.hPtrIn + (i + 1) * d);
+
+            // Verify compacted output
+            ASSERT_EQ (refOut.size () / d, count);
+            for (uint i = 0; i < count * d; ++i)
+                ASSERT_EQ (refOut[i], results[i]);
+
+            // Profiling ===========================================================
+            if (profiling)
+            {
+                const int nRepeat = 1;  /* Number of times to perform the tests. */
+
+                // GPU
+                clutils::GPUTimer<std::milli> gTimer (clEnv.devices[0][0]);
+                clutils::ProfilingInfo<nRepeat> pGPU ("GPU");
+                for (int i = 0; i < nRepeat; ++i)
+                    pGPU[i] = compact.run (gTimer);
+
+                // Benchmark
+                pGPU.print (config.second ? "Compact (single-pass)" : "Compact");
+            }
+        }
+
+    }
+    catch (const cl::Error &error)
+    {
+        std::cerr << error.what ()
+                  << " (" << clutils::getOpenCLErrorCodeString (error.err ()) 
+                  << ")"  << std::endl;
+        exit (EXIT_FAILURE);
+    }
+}
+
+
 int main (int argc, char **argv)
 {
     profiling = ICP::setProfilingFlag (argc, argv);